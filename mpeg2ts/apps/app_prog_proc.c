@@ -185,6 +185,16 @@ typedef struct prog_proc_tsk_ctx_s {
 	 * structure.
 	 */
 	volatile int *ref_flag_exit_shared;
+	/**
+	 * Program Map Section slot, defined in shared memory by the parent
+	 * process (mapped only; should not be de-initialized when releasing
+	 * this structure).
+	 * The parent writes the raw section; changes are detected by comparing
+	 * the slot sequence number with the one of the last section applied
+	 * ('psi_slot_seq').
+	 */
+	prog_proc_shm_psi_slot_t *psi_slot_shared;
+	uint32_t psi_slot_seq;
 } prog_proc_tsk_ctx_t;
 
 /* **** Prototypes **** */
@@ -207,6 +217,27 @@ static void prog_proc_settings_ctx_deinit(
 
 static void* api_thr(void *t);
 
+/**
+ * Apply a new (raw) Program Map Section: the section is parsed and the
+ * Elementary Stream processors are updated accordingly (if already
+ * running).
+ * @param prog_proc_tsk_ctx
+ * @param buf Raw Program Map Section.
+ * @param size Raw Program Map Section size.
+ * @return Status code STAT_SUCCESS or STAT_ERROR.
+ */
+static int prog_proc_pms_apply(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx,
+		uint8_t *buf, size_t size);
+
+/**
+ * Check the shared-memory Program Map Section slot, and apply the section
+ * if it changed since the last check.
+ * @param prog_proc_tsk_ctx
+ * @return STAT_SUCCESS if a new section was applied, STAT_NOTMODIFIED if
+ * section did not change (or is being written), STAT_ERROR otherwise.
+ */
+static int prog_proc_psi_slot_poll(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx);
+
 /**
  * Open an Elementary Stream processor instance.
  * This is an auxiliary wrapper function to launch ES processors.
@@ -219,6 +250,22 @@ static void* api_thr(void *t);
 static int es_procs_post(procs_ctx_t *procs_ctx, const char *proc_name,
 		int proc_id_arg, log_ctx_t *log_ctx);
 
+/**
+ * Update the Elementary Stream processors to a new Program Map Section.
+ * Only the processors of the ES entries that were added, removed or which
+ * stream type changed are opened or deleted; processors of unchanged
+ * entries (or entries only differing in descriptors) keep running.
+ * @param procs_ctx ES processors module context structure.
+ * @param psi_pms_ctx_prev PMS currently used; NULL if no ES processor was
+ * registered yet.
+ * @param psi_pms_ctx New PMS.
+ * @param log_ctx
+ * @return Status code STAT_SUCCESS or STAT_ERROR.
+ */
+static int es_procs_update(procs_ctx_t *procs_ctx,
+		const psi_pms_ctx_t *psi_pms_ctx_prev, const psi_pms_ctx_t *psi_pms_ctx,
+		log_ctx_t *log_ctx);
+
 /* **** Implementations **** */
 
 static const prog_proc_brctrl_type_lu_ctx_t prog_proc_brctrl_type_lutable
@@ -258,7 +305,9 @@ static const proc_if_t *proc_if_supp_codecs[SUPP_CODECS_NUM]= {
  *     "cbr":number,
  *     "flag_clear_input_bitrate_peak":boolean,
  *     "flag_purge_disassociated_processors":boolean,
- *     "pmt_octet_stream":string, -base64 encoded Program Map Table binary-
+ *     "pmt_octet_stream":string, -base64 encoded Program Map Table binary;
+ *                                 ignored if the parent process hands the
+ *                                 raw section in the shared-memory slot-
  *     "max_ts_pcr_guard_msec":number,
  *     "min_stc_delay_output_msec":number
  * }
@@ -403,7 +452,6 @@ static prog_proc_tsk_ctx_t* prog_proc_tsk_open(const char *settings_str,
 	const size_t fifo_api_chunk_size_get= PROG_PROC_SHM_SIZE_CHUNK_GET;
 	char href[PROCS_HREF_MAX_LEN+ 32]= {0};
 	psi_pms_ctx_t *psi_pms_ctx= NULL; // Do not release
-	llist_t *n;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
@@ -436,10 +484,33 @@ static prog_proc_tsk_ctx_t* prog_proc_tsk_open(const char *settings_str,
 			LOG_CTX_GET());
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
+	/* Compose shared memory names prefix using 'href' */
+	CHECK_DO(href_arg_len< PROCS_HREF_MAX_LEN, goto end);
+	memcpy(href, href_arg, href_arg_len);
+	p= href;
+	while((p= strchr(p, '/'))!= NULL && (p< href+ PROCS_HREF_MAX_LEN)) {
+		*p= '-';
+	}
+	LOGD("href_arg-modified: '%s'\n", href);
+
+	/* Map the Program Map Section slot (before parsing the settings, as the
+	 * PMS is then taken from the slot).
+	 */
+	snprintf(&href[href_arg_len], sizeof(href)- href_arg_len, SUF_SH_PSI);
+	LOGD("href_arg-modified: '%s'\n", href); //comment-me
+	prog_proc_tsk_ctx->psi_slot_shared= prog_proc_shm_psi_slot_open(href, 0,
+			LOG_CTX_GET());
+	CHECK_DO(prog_proc_tsk_ctx->psi_slot_shared!= NULL, goto end);
+
 	/* Parse and put given settings */
 	ret_code= prog_proc_rest_put(prog_proc_tsk_ctx, settings_str);
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
+	/* Get initial Program Map Section */
+	ret_code= prog_proc_psi_slot_poll(prog_proc_tsk_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED,
+			goto end);
+
 	/* Elementary-stream processors module context structure */
 	prog_proc_tsk_ctx->procs_ctx_es= procs_open(LOG_CTX_GET(),
 			TS_MAX_PID_VAL+ 1, "es_processors", "FIXME!!"); //FIXME: href in 'procs_open()'
@@ -457,41 +528,15 @@ static prog_proc_tsk_ctx_t* prog_proc_tsk_open(const char *settings_str,
 	}
 
 	/* Register Elementary Stream (ES) processors */
+	CHECK_DO(prog_proc_settings_ctx->psi_section_ctx_pms!= NULL, goto end);
 	psi_pms_ctx= prog_proc_settings_ctx->psi_section_ctx_pms->data;
 	CHECK_DO(psi_pms_ctx!= NULL, goto end);
-	for(n= psi_pms_ctx->psi_pms_es_ctx_llist; n!= NULL; n= n->next) {
-		psi_pms_es_ctx_t *psi_pms_es_ctx;
-		uint16_t es_pid;
-
-		psi_pms_es_ctx= (psi_pms_es_ctx_t*)n->data;
-		CHECK_DO(psi_pms_es_ctx!= NULL, continue);
-		es_pid= psi_pms_es_ctx->elementary_PID;
-
-//		/* Get PID-processor type */ //FIXME!!: TODO
-//		if(type_id!= NULL) {
-//			free(type_id);
-//			type_id= NULL;
-//		}
-//		ret_code= pid_proc_module_opt(PID_PROC_MODULE_GUESS_PROC_U_TYPE,
-//				(const psi_pms_es_ctx_t*)psi_pms_es_ctx, &type_id);
-//		CHECK_DO(ret_code== SUCCESS && type_id!= NULL, goto end);
-
-		/* Register Elementary Stream processor */
-		CHECK_DO(es_procs_post(prog_proc_tsk_ctx->procs_ctx_es, "bypass",
-				es_pid, LOG_CTX_GET())== STAT_SUCCESS, goto end);
-	}
+	ret_code= es_procs_update(prog_proc_tsk_ctx->procs_ctx_es, NULL,
+			psi_pms_ctx, LOG_CTX_GET());
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
 	/* **** Open shared memory pointers/references to communicate **** */
 
-	/* Compose FIFO name prefix using 'href' */
-	CHECK_DO(href_arg_len< PROCS_HREF_MAX_LEN, goto end);
-	memcpy(href, href_arg, href_arg_len);
-	p= href;
-	while((p= strchr(p, '/'))!= NULL && (p< href+ PROCS_HREF_MAX_LEN)) {
-		*p= '-';
-	}
-	LOGD("href_arg-modified: '%s'\n", href);
-
 	/* We have to re-map i/o FIFOs on shared memory */
 	snprintf(&href[href_arg_len], sizeof(href)- href_arg_len, SUF_SH_I);
 	LOGD("href_arg-modified: '%s'\n", href); //comment-me
@@ -576,6 +621,7 @@ static void prog_proc_tsk_close(prog_proc_tsk_ctx_t **ref_prog_proc_tsk_ctx)
 		ASSERT(munmap((void*)prog_proc_tsk_ctx->ref_flag_exit_shared,
 				sizeof(int))== 0);
 	}
+	prog_proc_shm_psi_slot_close(&prog_proc_tsk_ctx->psi_slot_shared);
 
 	free(prog_proc_tsk_ctx);
 	*ref_prog_proc_tsk_ctx= NULL;
@@ -596,7 +642,6 @@ static int prog_proc_rest_put(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx,
 			*flag_purge_disassociated_processors_str= NULL, *pms_str= NULL,
 			*ts_pcr_guard_str= NULL, *stc_delay_output_str= NULL;
 	uint8_t *buf_pmt= NULL;
-	psi_section_ctx_t *psi_section_ctx_pmt= NULL;
 	LOG_CTX_INIT(NULL);
 
 	/* Check arguments */
@@ -711,8 +756,12 @@ static int prog_proc_rest_put(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx,
 			cjson_aux->valuedouble;
 	}
 
-	/* PMS */
-	if(flag_repres_type== STR_URL_QUERY) {
+	/* PMS (if the parent process hands the raw section in the shared-memory
+	 * slot, the base64 encoded one is ignored; see 'prog_proc_psi_slot_poll()')
+	 */
+	if(prog_proc_tsk_ctx->psi_slot_shared!= NULL) {
+		// PMS is taken from the slot
+	} else if(flag_repres_type== STR_URL_QUERY) {
 		pms_str= uri_parser_query_str_get_value("pmt_octet_stream", str);
 	} else if(flag_repres_type== STR_JSON_REST) {
 		cjson_aux= cJSON_GetObjectItem(cjson_rest, "pmt_octet_stream");
@@ -743,17 +792,9 @@ static int prog_proc_rest_put(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx,
 				(const unsigned char*)pms_str+ 1, pms_str_size);
 		CHECK_DO(ret_code== 0, goto end);
 
-		/* Parse binary PMT into specific context structure */
-		ret_code= psi_dec_section(buf_pmt, olen, prog_proc_tsk_ctx->proc_id,
-				LOG_CTX_GET(), &psi_section_ctx_pmt);
-		CHECK_DO(ret_code== STAT_SUCCESS && psi_section_ctx_pmt!= NULL,
-				goto end);
-
-		psi_section_ctx_release(&prog_proc_settings_ctx->psi_section_ctx_pms);
-		prog_proc_settings_ctx->psi_section_ctx_pms= psi_section_ctx_pmt;
-		psi_section_ctx_pmt= NULL; // Avoid double referencing
-		psi_section_ctx_trace(
-				prog_proc_settings_ctx->psi_section_ctx_pms); //comment-me
+		/* Parse and apply binary PMT */
+		ret_code= prog_proc_pms_apply(prog_proc_tsk_ctx, buf_pmt, olen);
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 	}
 
 	/* Flag to purge disassociated ES-processors */
@@ -795,11 +836,90 @@ end:
 		free(buf_pmt);
 		buf_pmt= NULL;
 	}
+	return end_code;
+}
+
+static int prog_proc_pms_apply(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx,
+		uint8_t *buf, size_t size)
+{
+	int ret_code, end_code= STAT_ERROR;
+	volatile prog_proc_settings_ctx_t *prog_proc_settings_ctx= NULL;
+	psi_section_ctx_t *psi_section_ctx_pmt= NULL;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(prog_proc_tsk_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(buf!= NULL && size> 0, return STAT_ERROR);
+
+	LOG_CTX_SET(prog_proc_tsk_ctx->log_ctx);
+
+	prog_proc_settings_ctx= &prog_proc_tsk_ctx->prog_proc_settings_ctx;
+
+	/* Parse binary PMT into specific context structure */
+	ret_code= psi_dec_section(buf, size, prog_proc_tsk_ctx->proc_id,
+			LOG_CTX_GET(), &psi_section_ctx_pmt);
+	CHECK_DO(ret_code== STAT_SUCCESS && psi_section_ctx_pmt!= NULL,
+			goto end);
+
+	/* If ES processors are already running, update only the ones
+	 * affected by the PMS changes (ES processors are registered when
+	 * opening the task otherwise).
+	 */
+	if(prog_proc_tsk_ctx->procs_ctx_es!= NULL &&
+			prog_proc_settings_ctx->psi_section_ctx_pms!= NULL) {
+		ret_code= es_procs_update(prog_proc_tsk_ctx->procs_ctx_es,
+				prog_proc_settings_ctx->psi_section_ctx_pms->data,
+				psi_section_ctx_pmt->data, LOG_CTX_GET());
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	}
+
+	psi_section_ctx_release(&prog_proc_settings_ctx->psi_section_ctx_pms);
+	prog_proc_settings_ctx->psi_section_ctx_pms= psi_section_ctx_pmt;
+	psi_section_ctx_pmt= NULL; // Avoid double referencing
+	psi_section_ctx_trace(
+			prog_proc_settings_ctx->psi_section_ctx_pms); //comment-me
+
+	end_code= STAT_SUCCESS;
+end:
 	if(psi_section_ctx_pmt!= NULL)
 		psi_section_ctx_release(&psi_section_ctx_pmt);
 	return end_code;
 }
 
+static int prog_proc_psi_slot_poll(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx)
+{
+	int ret_code;
+	size_t size= 0;
+	uint32_t seq;
+	uint8_t buf[PROG_PROC_SHM_PSI_SLOT_SIZE];
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(prog_proc_tsk_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(prog_proc_tsk_ctx->psi_slot_shared!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(prog_proc_tsk_ctx->log_ctx);
+
+	/* Copy section out of the slot only if sequence number changed */
+	seq= prog_proc_tsk_ctx->psi_slot_seq;
+	ret_code= prog_proc_shm_psi_slot_read(prog_proc_tsk_ctx->psi_slot_shared,
+			&seq, buf, &size);
+	if(ret_code== STAT_NOTMODIFIED || ret_code== STAT_EAGAIN)
+		return STAT_NOTMODIFIED;
+	CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+
+	/* Note that the sequence number is updated even if section is not
+	 * valid, to avoid parsing it again on each poll.
+	 */
+	prog_proc_tsk_ctx->psi_slot_seq= seq;
+	ret_code= prog_proc_pms_apply(prog_proc_tsk_ctx, buf, size);
+	CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+
+	/* Let the parent process know the new section is in use */
+	prog_proc_shm_psi_slot_ack(prog_proc_tsk_ctx->psi_slot_shared, seq);
+	return STAT_SUCCESS;
+}
+
 //FIXME!!:TODO !!
 static int prog_proc_rest_get(prog_proc_tsk_ctx_t *prog_proc_tsk_ctx,
 		const proc_if_rest_fmt_t rest_fmt, void **ref_reponse)
@@ -918,6 +1038,10 @@ static void* api_thr(void *t)
 			wrap_resp= NULL;
 		}
 
+		/* Pick-up Program Map Section changes */
+		ret_code= prog_proc_psi_slot_poll(prog_proc_tsk_ctx);
+		ASSERT(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED);
+
 #if 1
 		schedule();
 #else
@@ -1020,3 +1144,59 @@ end:
 		cJSON_Delete(cjson_rest);
 	return end_code;
 }
+
+static int es_procs_update(procs_ctx_t *procs_ctx,
+		const psi_pms_ctx_t *psi_pms_ctx_prev, const psi_pms_ctx_t *psi_pms_ctx,
+		log_ctx_t *log_ctx)
+{
+	llist_t *n;
+	int ret_code, end_code= STAT_ERROR;
+	psi_pms_diff_ctx_t *psi_pms_diff_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(procs_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_pms_ctx!= NULL, return STAT_ERROR);
+
+	/* Get PMS structural differences */
+	psi_pms_diff_ctx= psi_pms_ctx_diff(psi_pms_ctx_prev, psi_pms_ctx);
+	CHECK_DO(psi_pms_diff_ctx!= NULL, goto end);
+
+	/* Delete/open only the affected ES processors (note that removed
+	 * entries are listed first, thus PIDs are freed before re-used).
+	 */
+	for(n= psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist; n!= NULL;
+			n= n->next) {
+		uint32_t flags;
+		uint16_t es_pid;
+		psi_pms_es_diff_ctx_t *psi_pms_es_diff_ctx=
+				(psi_pms_es_diff_ctx_t*)n->data;
+		CHECK_DO(psi_pms_es_diff_ctx!= NULL, continue);
+
+		flags= psi_pms_es_diff_ctx->flags;
+		es_pid= psi_pms_es_diff_ctx->elementary_PID;
+
+		if(flags& (PSI_PMS_DIFF_ES_REMOVED| PSI_PMS_DIFF_ES_STREAM_TYPE)) {
+			LOGD("Deleting ES-processor; PID: %u\n", es_pid);
+			ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", es_pid);
+			CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_ENOTFOUND,
+					goto end);
+		}
+
+		if(flags& (PSI_PMS_DIFF_ES_ADDED| PSI_PMS_DIFF_ES_STREAM_TYPE)) {
+			/* Register Elementary Stream processor */
+			ret_code= es_procs_post(procs_ctx, "bypass", es_pid,
+					LOG_CTX_GET());
+			CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+		} else if(flags== PSI_PMS_DIFF_ES_DESC) {
+			/* ES processor is not affected by descriptors changes */
+			LOGD("ES descriptors changed, processor kept; PID: %u\n",
+					es_pid);
+		}
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	psi_pms_diff_ctx_release(&psi_pms_diff_ctx);
+	return end_code;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file app_psi_crc_bench.c
+ * @brief CRC-32/MPEG-2 kernels micro-benchmark.
+ * Reports the throughput (GB/s) of each CRC kernel supported by the
+ * running CPU, checking that all the kernels are bit-exact with the scalar
+ * reference.
+ * Usage: app_psi_crc_bench [buffer size in bytes] [total size in MB]
+ * @author Rafael Antoniello
+ */
+
+#include "../src/psi_crc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* **** Definitions **** */
+
+/**
+ * Default buffer size: maximum PSI private section size.
+ */
+#define BENCH_BUF_SIZE_DEFAULT 4096
+
+/**
+ * Default amount of data processed per kernel [MB].
+ */
+#define BENCH_TOTAL_MB_DEFAULT 1024
+
+/* **** Prototypes **** */
+
+static int64_t bench_get_nsec();
+
+/* **** Implementations **** */
+
+int main(int argc, char *argv[])
+{
+	int i, kernel, end_code= EXIT_FAILURE;
+	size_t buf_size= BENCH_BUF_SIZE_DEFAULT, iterations;
+	uint64_t total_size= (uint64_t)BENCH_TOTAL_MB_DEFAULT<< 20;
+	uint8_t *buf= NULL;
+	uint32_t crc_ref;
+
+	/* Check arguments */
+	if(argc> 3) {
+		printf("Usage: %s [buffer size in bytes] [total size in MB]\n",
+				argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	if(argc> 1 && (buf_size= strtoul(argv[1], NULL, 10))== 0) {
+		printf("Invalid buffer size '%s'\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	if(argc> 2 && (total_size= strtoull(argv[2], NULL, 10)<< 20)== 0) {
+		printf("Invalid total size '%s'\n", argv[2]);
+		exit(EXIT_FAILURE);
+	}
+	iterations= (size_t)(total_size/ buf_size)+ 1;
+
+	/* Initialize pseudo-random data buffer */
+	buf= (uint8_t*)malloc(buf_size);
+	if(buf== NULL) {
+		printf("Could not allocate %zu bytes\n", buf_size);
+		goto end;
+	}
+	srand(0);
+	for(i= 0; i< (int)buf_size; i++)
+		buf[i]= (uint8_t)rand();
+
+	crc_ref= psi_crc32_update_kernel(PSI_CRC32_KERNEL_SCALAR, PSI_CRC32_INIT,
+			buf, buf_size);
+	printf("Buffer size: %zu bytes; iterations: %zu; auto kernel: '%s'\n",
+			buf_size, iterations, psi_crc32_kernel_get_name(
+					psi_crc32_kernel_is_supported(PSI_CRC32_KERNEL_CLMUL)?
+					PSI_CRC32_KERNEL_CLMUL: PSI_CRC32_KERNEL_SLICE8));
+
+	/* Benchmark each supported kernel */
+	for(kernel= PSI_CRC32_KERNEL_SCALAR; kernel< PSI_CRC32_KERNEL_ENUM_MAX;
+			kernel++) {
+		size_t n;
+		int64_t t0, t1;
+		uint32_t crc= 0, crc_acc= 0;
+		double secs;
+
+		if(!psi_crc32_kernel_is_supported(kernel)) {
+			printf("%-8s: not supported by this CPU\n",
+					psi_crc32_kernel_get_name(kernel));
+			continue;
+		}
+
+		/* Bit-exactness */
+		crc= psi_crc32_update_kernel(kernel, PSI_CRC32_INIT, buf, buf_size);
+		if(crc!= crc_ref) {
+			printf("%-8s: CRC mismatch (0x%08x, expected 0x%08x)\n",
+					psi_crc32_kernel_get_name(kernel), crc, crc_ref);
+			goto end;
+		}
+
+		/* Throughput */
+		t0= bench_get_nsec();
+		for(n= 0; n< iterations; n++)
+			crc_acc^= psi_crc32_update_kernel(kernel, (uint32_t)n, buf,
+					buf_size);
+		t1= bench_get_nsec();
+		secs= (double)(t1- t0)/ 1000000000.0;
+		printf("%-8s: %8.3f GB/s (0x%08x)\n", psi_crc32_kernel_get_name(kernel),
+				secs> 0? ((double)iterations* buf_size)/ secs/ 1e9: 0.0,
+				crc_acc);
+	}
+
+	end_code= EXIT_SUCCESS;
+end:
+	if(buf!= NULL)
+		free(buf);
+	return end_code;
+}
+
+/**
+ * Get monotonic clock time in nanoseconds.
+ */
+static int64_t bench_get_nsec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec* 1000000000+ (int64_t)ts.tv_nsec;
+}
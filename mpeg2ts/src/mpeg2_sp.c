@@ -29,6 +29,7 @@
 #include <sys/types.h>
 #include <inttypes.h>
 #include <string.h>
+#include <time.h>
 #include <pthread.h>
 #include <sys/wait.h>
 
@@ -51,9 +52,18 @@
 #include <libmediaprocs/proc.h>
 #include "ts.h"
 #include "psi.h"
+#include "psi_crc.h"
+#include "psi_enc.h"
 #include "psi_table.h"
 #include "psi_dvb.h"
+#include "psi_eit.h"
 #include "psi_proc.h"
+#include "psi_filter.h"
+#include "psi_store.h"
+#include "obj_pool.h"
+#include "ts_timing.h"
+#include "stc.h"
+#include "prog_routes.h"
 
 /* **** Definitions **** */
 
@@ -72,13 +82,54 @@
 #define _CONFIG_FILE_DIR "./"
 #endif
 
+/**
+ * Persistent last-known PSI store directory default path (see
+ * 'psi_store.h'); can be changed using the 'stream_procs.psi_store_dir'
+ * configuration file setting (an empty path disables the store). The
+ * directory is created private to the user (see 'psi_store_dir_create()').
+ */
+#ifndef _PSI_STORE_DIR
+#define _PSI_STORE_DIR _INSTALL_DIR"/var/psi_store"
+#endif
+
 #define NUM_DEMUXERS_MAX_POW2 16
 #define NUM_DEMUXERS_MAX (1<< NUM_DEMUXERS_MAX_POW2)
 
 /**
- * PSI tracking and statistics thread period [usecs]
+ * PSI tracking and statistics thread safety refresh period [usecs].
+ * PSI changes are notified as events by the PSI processors (see
+ * 'psi_notify()'); the PAT and PMT are only recomposed periodically in the
+ * absence of events as a fall-back.
+ */
+#define PSI_THREAD_PERIOD_USECS (10* 1000* 1000)
+
+/**
+ * PSI version-change events queue size [events].
+ */
+#define PSI_EVENTS_FIFO_SIZE 256
+
+/**
+ * PSI demultiplexer processor Id. (a single PSI processor parses all the
+ * PSI PIDs; see 'proc_if_psi_demux_proc').
+ */
+#define PSI_DEMUX_PROC_ID 0
+
+/**
+ * PSI EIT processor Id. (EIT PID packets are sent to this processor; see
+ * 'proc_if_psi_eit_proc').
+ */
+#define PSI_EIT_PROC_ID PSI_DVB_EIT_PID_NUMBER
+
+/**
+ * Maximum number of section taps (see 'proc_if_psi_tap_proc'); section tap
+ * Ids. range from 0 to MPEG2_SP_TAPS_MAX- 1.
  */
-#define PSI_THREAD_PERIOD_USECS (1000* 1000)
+#define MPEG2_SP_TAPS_MAX 16
+
+/**
+ * Returns non-zero if 'tag' string is equal to given TAG string.
+ */
+#define TAG_IS(TAG) (strcmp(tag, TAG)== 0)
 
 /**
  * Period to wait to the next iteration when the input interface is closed.
@@ -99,6 +150,15 @@
 	#define DB_UPDATE(MPEG2_SP_CTX, LOG_CTX) (STAT_ERROR)
 #endif
 
+/**
+ * PSI version-change event (see 'psi_notify()').
+ */
+typedef struct psi_event_s {
+	uint16_t pid;
+	uint8_t table_id;
+	uint8_t version_number;
+} psi_event_t;
+
 /**
  * Type for processors registering and mapping.
  */
@@ -178,14 +238,82 @@ typedef struct mpeg2_sp_ctx_s {
 	 * SDT critical section MUTEX.
 	 */
 	pthread_mutex_t psi_table_ctx_sdt_mutex;
+	/**
+	 * Programs summary cache (see 'mpeg2_sp_rest_get_programs_summary()'):
+	 * pre-rendered summary array and the state it was rendered from, namely,
+	 * references to the PAT and SDT snapshots, the present/following events
+	 * of each program (two events per PAT program, in PAT order) and
+	 * program processors association bit-mask (bit set for each processor
+	 * Id.).
+	 */
+	cJSON *cjson_programs_summary;
+	psi_table_ctx_t *programs_summary_pat;
+	psi_table_ctx_t *programs_summary_sdt;
+	psi_eit_event_t *programs_summary_events;
+	int programs_summary_events_num;
+	uint8_t programs_summary_assoc[(TS_MAX_PID_VAL+ 1)/ 8];
+	/**
+	 * Programs summary cache critical section MUTEX.
+	 */
+	pthread_mutex_t programs_summary_mutex;
+	/**
+	 * Persistent last-known PSI (see 'psi_store.h'): store directory
+	 * (NULL if disabled), current input URL and store file path (NULL if no
+	 * input is set), CRC of the last saved (or loaded) PSI and number of
+	 * PAT sections received when the input was set; the PSI is only saved
+	 * once a PAT is received from the new input, so the tables of the
+	 * previous input are never saved as the ones of the new input.
+	 */
+	char *last_psi_dir;
+	char *last_psi_url;
+	char *last_psi_path;
+	uint32_t last_psi_crc;
+	uint64_t last_psi_pat_count;
+	/**
+	 * Persistent last-known PSI critical section MUTEX.
+	 */
+	pthread_mutex_t last_psi_mutex;
 	/**
 	 * PSI tracking/parsing and statistics thread.
 	 */
 	pthread_t psi_thread;
 	/**
-	 * Interruptible u-sleep for the PSI tracking and statistics thread.
+	 * PSI version-change events queue, fed by the PSI processors and
+	 * consumed by the PSI tracking and statistics thread.
+	 */
+	fifo_ctx_t *fifo_ctx_psi_events;
+	/**
+	 * Elementary streams timing metrics (PTS/DTS to PCR offsets), fed from
+	 * the distribution thread and refreshed with each new PMT.
 	 */
-	interr_usleep_ctx_t *interr_usleep_ctx_psi_stats;
+	ts_timing_ctx_t *ts_timing_ctx;
+	/**
+	 * Program packets routing snapshot (NULL if no PAT was parsed yet).
+	 * Replaced by the PSI thread holding 'prog_routes_mutex' (see
+	 * 'update_prog_routes()'); a stale snapshot may only make a packet be
+	 * sent to a non-existent program processor (ignored).
+	 */
+	prog_routes_t *prog_routes;
+	/**
+	 * Program packets routing snapshot critical section MUTEX.
+	 */
+	pthread_mutex_t prog_routes_mutex;
+	/**
+	 * Section taps routing table: for each PID, the bit-mask of the section
+	 * taps the PID packets are sent to (bit 'i' set for tap Id. 'i').
+	 * Written holding 'tap_mutex' and read by the distribution thread
+	 * without locking (a stale entry may only make a packet be sent to a
+	 * non-existent tap processor, which is ignored).
+	 */
+	volatile uint16_t tap_route_array[TS_MAX_PID_VAL+ 1];
+	/**
+	 * PID of each section tap (-1 if tap Id. is not used).
+	 */
+	int tap_pid_array[MPEG2_SP_TAPS_MAX];
+	/**
+	 * Section taps critical section MUTEX.
+	 */
+	pthread_mutex_t tap_mutex;
 
 	/* **** ----------------------- Processors ------------------------ **** */
 	/**
@@ -200,6 +328,10 @@ typedef struct mpeg2_sp_ctx_s {
 	 * Disassociated program processors module context structure.
 	 */
 	procs_ctx_t *procs_ctx_dis_prog;
+	/**
+	 * Section tap processors module context structure.
+	 */
+	procs_ctx_t *procs_ctx_tap;
 
 	/* **** --------------------- Input interface --------------------- **** */
 	/**
@@ -235,6 +367,7 @@ static proc_ctx_t* mpeg2_sp_open(const proc_if_t *proc_if,
 		const char *settings_str, const char* href, log_ctx_t *log_ctx,
 		va_list arg);
 static void mpeg2_sp_close(proc_ctx_t **ref_proc_ctx);
+static int mpeg2_sp_opt(proc_ctx_t *proc_ctx, const char *tag, va_list arg);
 static int mpeg2_sp_rest_put(proc_ctx_t *proc_ctx, const char *str);
 static int mpeg2_sp_rest_put2(proc_ctx_t *proc_ctx, const char *str);
 static int mpeg2_sp_rest_get(proc_ctx_t *proc_ctx,
@@ -242,8 +375,22 @@ static int mpeg2_sp_rest_get(proc_ctx_t *proc_ctx,
 static cJSON* mpeg2_sp_rest_get_settings(
 		volatile mpeg2_sp_settings_ctx_t *mpeg2_sp_settings_ctx,
 		log_ctx_t *log_ctx);
-static void mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
-		cJSON *cjson_programs, log_ctx_t *log_ctx);
+static cJSON* mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const cJSON *cjson_procs_array, log_ctx_t *log_ctx);
+static cJSON* mpeg2_sp_rest_get_programs_summary_render(
+		mpeg2_sp_ctx_t *mpeg2_sp_ctx, const psi_table_ctx_t *psi_table_ctx_pat,
+		const psi_table_ctx_t *psi_table_ctx_sdt, const uint8_t *assoc,
+		const psi_eit_event_t *events, int events_num, log_ctx_t *log_ctx);
+static int programs_summary_events_get(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pat, int64_t now,
+		psi_eit_event_t **ref_events, int *ref_events_num);
+static int programs_summary_events_equal(const psi_eit_event_t *events1,
+		int events_num1, const psi_eit_event_t *events2, int events_num2);
+static cJSON* mpeg2_sp_rest_get_eit_event(
+		const psi_eit_event_t *psi_eit_event, log_ctx_t *log_ctx);
+static cJSON* mpeg2_sp_rest_get_taps(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		log_ctx_t *log_ctx);
+static cJSON* mpeg2_sp_rest_get_obj_pools(log_ctx_t *log_ctx);
 
 static int mpeg2_sp_settings_ctx_init(
 		volatile mpeg2_sp_settings_ctx_t *mpeg2_sp_settings_ctx,
@@ -255,10 +402,40 @@ static void mpeg2_sp_settings_ctx_deinit(
 static void* distr_thr(void *t);
 
 static void* psi_thr(void *t);
-static void compose_pat_and_pmt(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+static void psi_notify(void *opaque, uint16_t pid, uint8_t table_id,
+		uint8_t version_number);
+static int psi_notify_register(mpeg2_sp_ctx_t *mpeg2_sp_ctx, int proc_id,
+		log_ctx_t *log_ctx);
+static int tap_add(mpeg2_sp_ctx_t *mpeg2_sp_ctx, int pid,
+		const char *tap_settings, int *ref_tap_id, log_ctx_t *log_ctx);
+static int tap_delete(mpeg2_sp_ctx_t *mpeg2_sp_ctx, int tap_id,
+		log_ctx_t *log_ctx);
+static int psi_pid_register(mpeg2_sp_ctx_t *mpeg2_sp_ctx, uint16_t pid,
+		psi_proc_pid_type_t pid_type, uint8_t table_id, log_ctx_t *log_ctx);
+static int last_psi_input_set(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const char *input_url, log_ctx_t *log_ctx);
+static void last_psi_preload(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
 		log_ctx_t *log_ctx);
+static void last_psi_save(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pat, log_ctx_t *log_ctx);
+static uint32_t last_psi_crc(const psi_store_rec_t *rec_array, int rec_num);
+static uint64_t last_psi_pat_count(mpeg2_sp_ctx_t *mpeg2_sp_ctx);
+static void compose_pat_and_pmt(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		int flag_psi_changed, log_ctx_t *log_ctx);
 static void compose_pmt_pms(mpeg2_sp_ctx_t *mpeg2_sp_ctx, uint16_t pms_pid,
 		psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx);
+static void update_es_timing(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx);
+static void update_prog_routes(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pat,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx);
+static prog_routes_t* prog_routes_get(mpeg2_sp_ctx_t *mpeg2_sp_ctx);
+static void prog_procs_psi_update(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const prog_routes_t *prog_routes_prev,
+		const prog_routes_t *prog_routes,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx);
+static int prog_proc_is_running(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		cJSON **ref_cjson_procs_rest, uint16_t pmt_pid, log_ctx_t *log_ctx);
 
 /**
  * Open a processor instance:
@@ -290,7 +467,7 @@ const proc_if_t proc_if_mpeg2_sp=
 	mpeg2_sp_rest_put,
 	mpeg2_sp_rest_get,
 	NULL, // No predefined 'process_frame()' function
-	NULL, // no extra options
+	mpeg2_sp_opt, // extra options
 	NULL, // 'iput_fifo_elem_opaque_dup()'
 	NULL, // 'iput_fifo_elem_opaque_release()'
 	NULL, // 'oput_fifo_elem_opaque_dup()'
@@ -306,7 +483,10 @@ static proc_ctx_t* mpeg2_sp_open(const proc_if_t *proc_if,
 {
 	config_t cfg;
 	const char *host_ipv4_addr; // Do not release
-	int ret_code, end_code= STAT_ERROR, proc_instance_index= -1, proc_id= -1;
+	const char *last_psi_dir= _PSI_STORE_DIR; // Do not release
+	int i, ret_code, end_code= STAT_ERROR, proc_instance_index= -1,
+			proc_id= -1, obj_pool_stats= 0;
+	char settings[32]= {0}; // reserve long enough array
 	mpeg2_sp_ctx_t *mpeg2_sp_ctx= NULL;
 	volatile mpeg2_sp_settings_ctx_t *mpeg2_sp_settings_ctx=
 			NULL; // Do not release
@@ -379,6 +559,28 @@ static proc_ctx_t* mpeg2_sp_open(const proc_if_t *proc_if,
 	ret_code= mpeg2_sp_settings_ctx_init(mpeg2_sp_settings_ctx, LOG_CTX_GET());
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
+	/* Persistent last-known PSI store (initialized before setting the input
+	 * URL; optional configuration setting).
+	 */
+	config_lookup_string(&cfg, "stream_procs.psi_store_dir", &last_psi_dir);
+	if(strlen(last_psi_dir)> 0) {
+		if(psi_store_dir_create(last_psi_dir, LOG_CTX_GET())== STAT_SUCCESS) {
+			mpeg2_sp_ctx->last_psi_dir= strdup(last_psi_dir);
+			CHECK_DO(mpeg2_sp_ctx->last_psi_dir!= NULL, goto end);
+		} else {
+			LOGW("Last-known PSI store disabled\n");
+		}
+	}
+	ret_code= pthread_mutex_init(&mpeg2_sp_ctx->last_psi_mutex, NULL);
+	CHECK_DO(ret_code== 0, goto end);
+
+	/* Object pools statistics (optional configuration setting; common to
+	 * all the processor instances, see 'obj_pool.h').
+	 */
+	if(config_lookup_bool(&cfg, "stream_procs.obj_pool_stats",
+			&obj_pool_stats)== CONFIG_TRUE)
+		obj_pool_stats_enable(obj_pool_stats);
+
 	/* Parse and put given settings */
 	ret_code= mpeg2_sp_rest_put((proc_ctx_t*)mpeg2_sp_ctx, settings_str);
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
@@ -406,6 +608,32 @@ static proc_ctx_t* mpeg2_sp_open(const proc_if_t *proc_if,
 	ret_code= pthread_mutex_init(&mpeg2_sp_ctx->psi_table_ctx_sdt_mutex, NULL);
 	CHECK_DO(ret_code== 0, goto end);
 
+	/* Programs summary cache (empty) and its critical section MUTEX */
+	mpeg2_sp_ctx->cjson_programs_summary= NULL;
+	mpeg2_sp_ctx->programs_summary_pat= NULL;
+	mpeg2_sp_ctx->programs_summary_sdt= NULL;
+	mpeg2_sp_ctx->programs_summary_events= NULL;
+	mpeg2_sp_ctx->programs_summary_events_num= 0;
+	ret_code= pthread_mutex_init(&mpeg2_sp_ctx->programs_summary_mutex, NULL);
+	CHECK_DO(ret_code== 0, goto end);
+
+	/* Elementary streams timing metrics */
+	mpeg2_sp_ctx->ts_timing_ctx= ts_timing_open(LOG_CTX_GET());
+	CHECK_DO(mpeg2_sp_ctx->ts_timing_ctx!= NULL, goto end);
+
+	/* Program packets routing (no program known yet) */
+	mpeg2_sp_ctx->prog_routes= NULL;
+	ret_code= pthread_mutex_init(&mpeg2_sp_ctx->prog_routes_mutex, NULL);
+	CHECK_DO(ret_code== 0, goto end);
+
+	/* Section taps (no tap registered yet) */
+	for(i= 0; i<= TS_MAX_PID_VAL; i++)
+		mpeg2_sp_ctx->tap_route_array[i]= 0;
+	for(i= 0; i< MPEG2_SP_TAPS_MAX; i++)
+		mpeg2_sp_ctx->tap_pid_array[i]= -1;
+	ret_code= pthread_mutex_init(&mpeg2_sp_ctx->tap_mutex, NULL);
+	CHECK_DO(ret_code== 0, goto end);
+
 	/* PSI processors module context structure */
 	mpeg2_sp_ctx->procs_ctx_psi= procs_open(LOG_CTX_GET(), TS_MAX_PID_VAL+ 1,
 			"psi_processors", mpeg2_sp_ctx->sys_id);
@@ -422,6 +650,11 @@ static proc_ctx_t* mpeg2_sp_open(const proc_if_t *proc_if,
 			mpeg2_sp_ctx->sys_id);
 	CHECK_DO(mpeg2_sp_ctx->procs_ctx_dis_prog!= NULL, goto end);
 
+	/* Section tap processors module context structure */
+	mpeg2_sp_ctx->procs_ctx_tap= procs_open(LOG_CTX_GET(), MPEG2_SP_TAPS_MAX,
+			"section_taps", mpeg2_sp_ctx->sys_id);
+	CHECK_DO(mpeg2_sp_ctx->procs_ctx_tap!= NULL, goto end);
+
 	/* Input COMM module instance context structure */
 	mpeg2_sp_ctx->comm_ctx_input= NULL; // Set by 'demuxer_opt()'
 
@@ -447,28 +680,61 @@ static proc_ctx_t* mpeg2_sp_open(const proc_if_t *proc_if,
 	 * Note that return value 'STAT_ECONFLICT' means that processor was
 	 * already registered, so for this case is also O.K.
 	 */
-	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_table_proc);
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_demux_proc);
 	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_ECONFLICT, goto end);
-	ret_code= procs_module_opt("PROCS_REGISTER_TYPE",
-			&proc_if_psi_section_proc);
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_eit_proc);
 	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_ECONFLICT, goto end);
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_tap_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_ECONFLICT, goto end);
+
+	/* PSI version-change events queue */
+	mpeg2_sp_ctx->fifo_ctx_psi_events= fifo_open(PSI_EVENTS_FIFO_SIZE,
+			sizeof(psi_event_t), 0, NULL);
+	CHECK_DO(mpeg2_sp_ctx->fifo_ctx_psi_events!= NULL, goto end);
+
+	/* PSI demultiplexer processor (parses all the PSI PIDs) */
+	snprintf(settings, sizeof(settings), "forced_proc_id=%d",
+			PSI_DEMUX_PROC_ID);
+	ret_code= procs_post(mpeg2_sp_ctx->procs_ctx_psi, "psi_demux_proc",
+			settings, &proc_id, LOG_CTX_GET());
+	CHECK_DO(ret_code== STAT_SUCCESS && proc_id== PSI_DEMUX_PROC_ID,
+			goto end);
+	ret_code= psi_notify_register(mpeg2_sp_ctx, proc_id, LOG_CTX_GET());
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
-	/* Program Association Table (PAT) processor (PID= 0) */
-	ret_code= procs_post(mpeg2_sp_ctx->procs_ctx_psi, "psi_table_proc",
-			"forced_proc_id=0", &proc_id, LOG_CTX_GET());
-	CHECK_DO(ret_code== STAT_SUCCESS && proc_id== PSI_PAT_PID_NUMBER, goto end);
+	/* Program Association Table (PAT) (PID= 0) */
+	ret_code= psi_pid_register(mpeg2_sp_ctx, PSI_PAT_PID_NUMBER,
+			PSI_PROC_PID_TABLE, PSI_TABLE_PROGRAM_ASSOCIATION_SECTION,
+			LOG_CTX_GET());
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Service Description Table (SDT) (PID= 17).
+	 * Note that this PID also carries the BAT and the SDT of other
+	 * transport streams, which are filtered out without being decoded.
+	 */
+	ret_code= psi_pid_register(mpeg2_sp_ctx, PSI_DVB_SDT_PID_NUMBER,
+			PSI_PROC_PID_TABLE, PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL,
+			LOG_CTX_GET());
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
-	/* Service Description Table (SDT) processor (PID= 17) */
-	ret_code= procs_post(mpeg2_sp_ctx->procs_ctx_psi, "psi_table_proc",
-			"forced_proc_id=17", &proc_id, LOG_CTX_GET());
-	CHECK_DO(ret_code== STAT_SUCCESS && proc_id== PSI_DVB_SDT_PID_NUMBER,
+	/* Event Information Table (EIT) (PID= 18); parsed into a bounded
+	 * present/following and schedule cache by its own processor.
+	 */
+	snprintf(settings, sizeof(settings), "forced_proc_id=%d",
+			PSI_EIT_PROC_ID);
+	ret_code= procs_post(mpeg2_sp_ctx->procs_ctx_psi, "psi_eit_proc",
+			settings, &proc_id, LOG_CTX_GET());
+	CHECK_DO(ret_code== STAT_SUCCESS && proc_id== PSI_EIT_PROC_ID,
 			goto end);
 
+	/* Preload the last-known PSI of the input (if any), so programs are
+	 * available before the input tables are received.
+	 */
+	last_psi_preload(mpeg2_sp_ctx, LOG_CTX_GET());
+
 	/* **** Finally, launch threads **** */
 
 	/* Launch PSI and statistics thread */
-	mpeg2_sp_ctx->interr_usleep_ctx_psi_stats= interr_usleep_open();
-	CHECK_DO(mpeg2_sp_ctx->interr_usleep_ctx_psi_stats!= NULL, goto end);
 	ret_code= pthread_create(&mpeg2_sp_ctx->psi_thread, NULL, psi_thr,
 			(void*)mpeg2_sp_ctx);
 	CHECK_DO(ret_code== 0, goto end);
@@ -534,6 +800,11 @@ static void mpeg2_sp_close(proc_ctx_t **ref_proc_ctx)
 					"PROCS_ID_DELETE", i);
 			ASSERT(ret_code== STAT_SUCCESS || ret_code== STAT_ENOTFOUND);
 		}
+		if(mpeg2_sp_ctx->procs_ctx_tap!= NULL && i< MPEG2_SP_TAPS_MAX) {
+			ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_tap,
+					"PROCS_ID_DELETE", i);
+			ASSERT(ret_code== STAT_SUCCESS || ret_code== STAT_ENOTFOUND);
+		}
 	}
 
 	LOGV("Waiting for distribution thread to join... "); //comment-me
@@ -546,11 +817,11 @@ static void mpeg2_sp_close(proc_ctx_t **ref_proc_ctx)
 	LOGV("thread joined O.K.\n"); //comment-me
 
 	/* Join PSI tracking and statistics thread.
-	 * - Unblock interruptible-sleep module instance;
+	 * - Unblock PSI events queue;
 	 * - Join the thread.
 	 */
-	if(mpeg2_sp_ctx->interr_usleep_ctx_psi_stats!= NULL)
-		interr_usleep_unblock(mpeg2_sp_ctx->interr_usleep_ctx_psi_stats);
+	if(mpeg2_sp_ctx->fifo_ctx_psi_events!= NULL)
+		fifo_set_blocking_mode(mpeg2_sp_ctx->fifo_ctx_psi_events, 0);
 	LOGV("Waiting for PSI/statistics thread to join... "); //comment-me
 	pthread_join(mpeg2_sp_ctx->psi_thread, &thread_end_code);
 	if(thread_end_code!= NULL) {
@@ -584,18 +855,60 @@ static void mpeg2_sp_close(proc_ctx_t **ref_proc_ctx)
 	/* Release SDT critical section MUTEX */
 	ASSERT(pthread_mutex_destroy(&mpeg2_sp_ctx->psi_table_ctx_sdt_mutex)== 0);
 
-	/* Release interruptible u-sleep module instance */
-	interr_usleep_close(&mpeg2_sp_ctx->interr_usleep_ctx_psi_stats);
+	/* Release programs summary cache and its critical section MUTEX */
+	if(mpeg2_sp_ctx->cjson_programs_summary!= NULL) {
+		cJSON_Delete(mpeg2_sp_ctx->cjson_programs_summary);
+		mpeg2_sp_ctx->cjson_programs_summary= NULL;
+	}
+	psi_table_ctx_release(&mpeg2_sp_ctx->programs_summary_pat);
+	psi_table_ctx_release(&mpeg2_sp_ctx->programs_summary_sdt);
+	if(mpeg2_sp_ctx->programs_summary_events!= NULL) {
+		free(mpeg2_sp_ctx->programs_summary_events);
+		mpeg2_sp_ctx->programs_summary_events= NULL;
+	}
+	ASSERT(pthread_mutex_destroy(&mpeg2_sp_ctx->programs_summary_mutex)== 0);
+
+	/* Release persistent last-known PSI store settings and MUTEX */
+	if(mpeg2_sp_ctx->last_psi_dir!= NULL) {
+		free(mpeg2_sp_ctx->last_psi_dir);
+		mpeg2_sp_ctx->last_psi_dir= NULL;
+	}
+	if(mpeg2_sp_ctx->last_psi_url!= NULL) {
+		free(mpeg2_sp_ctx->last_psi_url);
+		mpeg2_sp_ctx->last_psi_url= NULL;
+	}
+	if(mpeg2_sp_ctx->last_psi_path!= NULL) {
+		free(mpeg2_sp_ctx->last_psi_path);
+		mpeg2_sp_ctx->last_psi_path= NULL;
+	}
+	ASSERT(pthread_mutex_destroy(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+
+	/* Release elementary streams timing metrics */
+	ts_timing_close(&mpeg2_sp_ctx->ts_timing_ctx);
+
+	/* Release program packets routing snapshot and its MUTEX */
+	prog_routes_release(&mpeg2_sp_ctx->prog_routes,
+			&mpeg2_sp_ctx->prog_routes_mutex);
+	ASSERT(pthread_mutex_destroy(&mpeg2_sp_ctx->prog_routes_mutex)== 0);
 
 	/* Release PSI processors module context structure */
 	procs_close(&mpeg2_sp_ctx->procs_ctx_psi);
 
+	/* Release PSI events queue (once PSI processors are released) */
+	fifo_close(&mpeg2_sp_ctx->fifo_ctx_psi_events);
+
 	/* Release program processors module context structure */
 	procs_close(&mpeg2_sp_ctx->procs_ctx_prog);
 
 	/* Release disassociated program processors module context structure */
 	procs_close(&mpeg2_sp_ctx->procs_ctx_dis_prog);
 
+	/* Release section tap processors module context structure */
+	procs_close(&mpeg2_sp_ctx->procs_ctx_tap);
+
+	/* Release section taps critical section MUTEX */
+	ASSERT(pthread_mutex_destroy(&mpeg2_sp_ctx->tap_mutex)== 0);
+
 	/* Release input critical section MUTEX */
 	ASSERT(pthread_mutex_destroy(&mpeg2_sp_ctx->comm_ctx_input_mutex)== 0);
 
@@ -614,6 +927,38 @@ static void mpeg2_sp_close(proc_ctx_t **ref_proc_ctx)
 	*ref_proc_ctx= NULL;
 }
 
+/**
+ * Implements the proc_if_s::opt callback.
+ * See .proc_if.h for further details.
+ */
+static int mpeg2_sp_opt(proc_ctx_t *proc_ctx, const char *tag, va_list arg)
+{
+	int end_code= STAT_ERROR;
+	mpeg2_sp_ctx_t *mpeg2_sp_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(tag!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(proc_ctx->log_ctx);
+
+	mpeg2_sp_ctx= (mpeg2_sp_ctx_t*)proc_ctx;
+
+	if(TAG_IS("PROCS_ID_MPEG2_SP_TAP_ADD")) {
+		int pid= va_arg(arg, int);
+		const char *tap_settings= va_arg(arg, const char*);
+		end_code= tap_add(mpeg2_sp_ctx, pid, tap_settings,
+				va_arg(arg, int*), LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_MPEG2_SP_TAP_DELETE")) {
+		end_code= tap_delete(mpeg2_sp_ctx, va_arg(arg, int), LOG_CTX_GET());
+	} else {
+		LOGE("Unknown option\n");
+		end_code= STAT_ENOTFOUND;
+	}
+	return end_code;
+}
+
 /**
  * Implements the proc_if_s::rest_put callback.
  * See .proc_if.h for further details.
@@ -729,6 +1074,9 @@ static int mpeg2_sp_rest_put2(proc_ctx_t *proc_ctx, const char *str)
 					free(mpeg2_sp_settings_ctx->input_url);
 				mpeg2_sp_settings_ctx->input_url= input_url_str;
 				input_url_str= NULL; // Avoid double referencing
+				ret_code= last_psi_input_set(mpeg2_sp_ctx,
+						mpeg2_sp_settings_ctx->input_url, LOG_CTX_GET());
+				CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 			} else {
 				end_code= ret_code;
 				goto end;
@@ -777,6 +1125,9 @@ static int mpeg2_sp_rest_put2(proc_ctx_t *proc_ctx, const char *str)
 					free(mpeg2_sp_settings_ctx->input_url);
 				mpeg2_sp_settings_ctx->input_url= input_url_str;
 				input_url_str= NULL; // Avoid double referencing
+				ret_code= last_psi_input_set(mpeg2_sp_ctx,
+						mpeg2_sp_settings_ctx->input_url, LOG_CTX_GET());
+				CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 			} else {
 				end_code= ret_code;
 				goto end;
@@ -862,6 +1213,28 @@ end:
  *         ....
  *     ],
  *     "program_processors": [],
+ *     "es_timing": [], -see 'ts_timing_rest_get()'-
+ *     "section_taps":
+ *     [
+ *         {
+ *             "tap_id":number,
+ *             "pid":number,
+ *             "sections_tapped":number,
+ *             "sections_overwritten":number,
+ *             "sections_filtered":number
+ *         },
+ *         ....
+ *     ],
+ *     "obj_pools":
+ *     [
+ *         {
+ *             "object_size":number,
+ *             "objects_live":number,
+ *             "objects_live_max":number,
+ *             "slabs":number
+ *         },
+ *         ....
+ *     ],
  *     “links”:
  *     [
  *         {"rel":"self", "href":string}
@@ -873,6 +1246,9 @@ end:
  * - "hasBeenDisassociated": Refers to a program associated to a previous
  * version of the PAT and PMT, but no longer associated in current tables.
  * It is preserved only because is still being processed.
+ * - "obj_pools": Object pools statistics by size class (see 'obj_pool.h');
+ * only present if enabled by the 'stream_procs.obj_pool_stats' configuration
+ * file setting.
  */
 static int mpeg2_sp_rest_get(proc_ctx_t *proc_ctx,
 		const proc_if_rest_fmt_t rest_fmt, void **ref_reponse)
@@ -924,11 +1300,7 @@ static int mpeg2_sp_rest_get(proc_ctx_t *proc_ctx,
 	CHECK_DO(cjson_aux!= NULL, goto end);
 	cJSON_AddItemToObject(cjson_rest, "settings", cjson_aux);
 
-	cjson_programs= cJSON_CreateArray();
-	CHECK_DO(cjson_programs!= NULL, goto end);
-	cJSON_AddItemToObject(cjson_rest, "programs", cjson_programs);
-
-	/* Add program-processors information */
+	/* Get program-processors information */
 	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_prog, "PROCS_GET",
 			&procs_rest_str, NULL);
 	CHECK_DO(ret_code== STAT_SUCCESS && procs_rest_str!= NULL, goto end);
@@ -937,9 +1309,34 @@ static int mpeg2_sp_rest_get(proc_ctx_t *proc_ctx,
 	cjson_procs_array= cJSON_DetachItemFromObject(cjson_procs_rest,
 			"program_processors");
 	CHECK_DO(cjson_procs_array!= NULL, goto end);
+
+	/* **** Add program information to the representational state **** */
+	cjson_programs= mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx,
+			cjson_procs_array, LOG_CTX_GET());
+	CHECK_DO(cjson_programs!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_rest, "programs", cjson_programs);
+
+	/* Add program-processors information */
 	cJSON_AddItemToObject(cjson_rest, "program_processors", cjson_procs_array);
 	cjson_procs_array= NULL; // Avoid double referencing
 
+	/* Elementary streams timing metrics */
+	ret_code= ts_timing_rest_get(mpeg2_sp_ctx->ts_timing_ctx, &cjson_aux);
+	CHECK_DO(ret_code== STAT_SUCCESS && cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_rest, "es_timing", cjson_aux);
+
+	/* Section taps */
+	cjson_aux= mpeg2_sp_rest_get_taps(mpeg2_sp_ctx, LOG_CTX_GET());
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_rest, "section_taps", cjson_aux);
+
+	/* Object pools statistics */
+	if(obj_pool_stats_enabled()) {
+		cjson_aux= mpeg2_sp_rest_get_obj_pools(LOG_CTX_GET());
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_rest, "obj_pools", cjson_aux);
+	}
+
 	/* Links */
 	cjson_links= cJSON_CreateArray();
 	CHECK_DO(cjson_links!= NULL, goto end);
@@ -990,10 +1387,6 @@ static int mpeg2_sp_rest_get(proc_ctx_t *proc_ctx,
 				cjson_aux);
 	}
 
-	/* **** Add program information to the representational state **** */
-	mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx, cjson_programs,
-			LOG_CTX_GET());
-
 	// Reserved for future use: set other data values here...
 
 	/* Format response to be returned */
@@ -1101,12 +1494,19 @@ end:
 }
 
 /**
- * Update program REST summary array (reduced information):
+ * Get programs REST summary array (reduced information):
  * @code
  * [
  *     {
  *         "program_number":number,
  *         "service_name":string,
+ *         "event_now":{
+ *             "event_id":number,
+ *             "start_time":number, // Seconds since the Epoch (UTC)
+ *             "duration":number, // Seconds
+ *             "event_name":string
+ *         }, // null if not available
+ *         "event_next":{...}, // same as "event_now"
  *         "processor_associated":boolean,
  *         "links":
  *         [
@@ -1116,27 +1516,238 @@ end:
  *     ...
  * }
  * @endcode
+ * The summary is served from a pre-rendered cache; it is only re-rendered
+ * if the PAT or SDT snapshot changed, if the present/following event of
+ * any program changed (e.g. event ended, or was re-scheduled), or if the
+ * program processors association changed.
+ * @param mpeg2_sp_ctx
+ * @param cjson_procs_array Program processors array, as returned by the
+ * "PROCS_GET" option of the program processors module (used to know which
+ * programs have a processor associated).
+ * @param log_ctx
+ * @return Copy of the cached summary array; NULL if fails.
  */
-static void mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
-		cJSON *cjson_programs, log_ctx_t *log_ctx)
+static cJSON* mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const cJSON *cjson_procs_array, log_ctx_t *log_ctx)
 {
-	llist_t *n;
+	int i, ret_code, events_num= 0;
+	uint8_t assoc[(TS_MAX_PID_VAL+ 1)/ 8]= {0};
+	psi_eit_event_t *events= NULL;
+	psi_table_ctx_t *psi_table_ctx_pat= NULL, *psi_table_ctx_sdt= NULL;
+	cJSON *cjson_programs= NULL, *cjson_summary= NULL;
 	LOG_CTX_INIT(log_ctx);
-	cJSON *cjson_program= NULL;
-	psi_table_ctx_t *psi_table_ctx_pat= NULL,
-			*psi_table_ctx_sdt= NULL; // Do not release
-	char href[256]= {0};
 
 	/* Check arguments */
-	CHECK_DO(mpeg2_sp_ctx!= NULL, return);
-	CHECK_DO(cjson_programs!= NULL, return);
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return NULL);
+	// argument 'cjson_procs_array' is allowed to be NULL
 	// argument 'log_ctx' is allowed to be NULL
 
-	/* Lock PAT register critical section; fetch registered PAT */
+	/* Program processors association bit-mask (by processor Id.) */
+	for(i= 0; cjson_procs_array!= NULL &&
+			i< cJSON_GetArraySize((cJSON*)cjson_procs_array); i++) {
+		cJSON *cjson_proc_id= cJSON_GetObjectItem(cJSON_GetArrayItem(
+				(cJSON*)cjson_procs_array, i), "proc_id");
+		int proc_id;
+
+		if(cjson_proc_id== NULL)
+			continue;
+		proc_id= (int)cjson_proc_id->valuedouble;
+		if(proc_id>= 0 && proc_id<= TS_MAX_PID_VAL)
+			assoc[proc_id>> 3]|= (uint8_t)(1<< (proc_id& 7));
+	}
+
+	/* Get references to the registered PAT and SDT snapshots; the locks are
+	 * only held to take the references (snapshots are immutable).
+	 */
 	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->psi_table_ctx_pat_mutex)== 0);
-	psi_table_ctx_pat= mpeg2_sp_ctx->psi_table_ctx_pat;
+	if(mpeg2_sp_ctx->psi_table_ctx_pat!= NULL)
+		psi_table_ctx_pat= psi_table_ctx_ref(mpeg2_sp_ctx->psi_table_ctx_pat);
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->psi_table_ctx_pat_mutex)== 0);
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->psi_table_ctx_sdt_mutex)== 0);
+	if(mpeg2_sp_ctx->psi_table_ctx_sdt!= NULL)
+		psi_table_ctx_sdt= psi_table_ctx_ref(mpeg2_sp_ctx->psi_table_ctx_sdt);
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->psi_table_ctx_sdt_mutex)== 0);
+
+	/* Present and following events of each program (answered by the EIT
+	 * cache); these are the EIT part of the cache key, so unrelated EIT
+	 * sections (e.g. schedule or other services) do not invalidate it.
+	 */
+	ret_code= programs_summary_events_get(mpeg2_sp_ctx, psi_table_ctx_pat,
+			(int64_t)time(NULL), &events, &events_num);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->programs_summary_mutex)== 0);
+
+	/* Re-render summary if cached one is not valid */
+	if(mpeg2_sp_ctx->cjson_programs_summary== NULL ||
+			mpeg2_sp_ctx->programs_summary_pat!= psi_table_ctx_pat ||
+			mpeg2_sp_ctx->programs_summary_sdt!= psi_table_ctx_sdt ||
+			!programs_summary_events_equal(
+					mpeg2_sp_ctx->programs_summary_events,
+					mpeg2_sp_ctx->programs_summary_events_num, events,
+					events_num) ||
+			memcmp(mpeg2_sp_ctx->programs_summary_assoc, assoc,
+					sizeof(assoc))!= 0) {
+		cjson_programs= mpeg2_sp_rest_get_programs_summary_render(
+				mpeg2_sp_ctx, psi_table_ctx_pat, psi_table_ctx_sdt, assoc,
+				events, events_num, LOG_CTX_GET());
+		if(cjson_programs!= NULL) {
+			/* Substitute cache (references are moved to the cache) */
+			if(mpeg2_sp_ctx->cjson_programs_summary!= NULL)
+				cJSON_Delete(mpeg2_sp_ctx->cjson_programs_summary);
+			mpeg2_sp_ctx->cjson_programs_summary= cjson_programs;
+			cjson_programs= NULL; // Avoid double referencing
+			psi_table_ctx_release(&mpeg2_sp_ctx->programs_summary_pat);
+			mpeg2_sp_ctx->programs_summary_pat= psi_table_ctx_pat;
+			psi_table_ctx_pat= NULL; // Avoid double referencing
+			psi_table_ctx_release(&mpeg2_sp_ctx->programs_summary_sdt);
+			mpeg2_sp_ctx->programs_summary_sdt= psi_table_ctx_sdt;
+			psi_table_ctx_sdt= NULL; // Avoid double referencing
+			if(mpeg2_sp_ctx->programs_summary_events!= NULL)
+				free(mpeg2_sp_ctx->programs_summary_events);
+			mpeg2_sp_ctx->programs_summary_events= events;
+			mpeg2_sp_ctx->programs_summary_events_num= events_num;
+			events= NULL; // Avoid double referencing
+			memcpy(mpeg2_sp_ctx->programs_summary_assoc, assoc,
+					sizeof(assoc));
+		}
+	}
+
+	if(mpeg2_sp_ctx->cjson_programs_summary!= NULL)
+		cjson_summary= cJSON_Duplicate(mpeg2_sp_ctx->cjson_programs_summary,
+				1);
+
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->programs_summary_mutex)== 0);
+
+end:
+	if(events!= NULL)
+		free(events);
+	if(psi_table_ctx_pat!= NULL)
+		psi_table_ctx_release(&psi_table_ctx_pat);
+	if(psi_table_ctx_sdt!= NULL)
+		psi_table_ctx_release(&psi_table_ctx_sdt);
+	return cjson_summary;
+}
+
+/**
+ * Get the present and following events of each program listed in the
+ * given PAT (two events per program, in PAT order; network PID entries are
+ * skipped). Events not available have start time -1.
+ * @return Status code; '*ref_events' is set to NULL if there are no
+ * programs.
+ */
+static int programs_summary_events_get(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pat, int64_t now,
+		psi_eit_event_t **ref_events, int *ref_events_num)
+{
+	llist_t *n, *n2;
+	int i= 0, events_num= 0;
+	psi_eit_event_t *events= NULL;
+	LOG_CTX_INIT(NULL);
+
+	*ref_events= NULL;
+	*ref_events_num= 0;
 	if(psi_table_ctx_pat== NULL)
+		return STAT_SUCCESS; // PAT still not parsed
+
+	/* Count programs */
+	for(n= psi_table_ctx_pat->psi_section_ctx_llist; n!= NULL; n= n->next) {
+		psi_section_ctx_t *psi_section_ctx= (psi_section_ctx_t*)n->data;
+		if(psi_section_ctx== NULL || psi_section_ctx->data== NULL)
+			continue;
+		for(n2= ((psi_pas_ctx_t*)psi_section_ctx->data)->
+				psi_pas_prog_ctx_llist; n2!= NULL; n2= n2->next) {
+			if(((psi_pas_prog_ctx_t*)n2->data)->program_number!= 0)
+				events_num+= 2;
+		}
+	}
+	if(events_num== 0)
+		return STAT_SUCCESS;
+	events= (psi_eit_event_t*)calloc(events_num, sizeof(psi_eit_event_t));
+	CHECK_DO(events!= NULL, return STAT_ENOMEM);
+
+	/* Query the EIT cache */
+	for(n= psi_table_ctx_pat->psi_section_ctx_llist; n!= NULL; n= n->next) {
+		psi_section_ctx_t *psi_section_ctx= (psi_section_ctx_t*)n->data;
+		if(psi_section_ctx== NULL || psi_section_ctx->data== NULL)
+			continue;
+		for(n2= ((psi_pas_ctx_t*)psi_section_ctx->data)->
+				psi_pas_prog_ctx_llist; n2!= NULL; n2= n2->next) {
+			uint16_t program_number=
+					((psi_pas_prog_ctx_t*)n2->data)->program_number;
+			if(program_number== 0)
+				continue;
+			if(procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+					"PROCS_ID_PSI_EIT_GET_NOW_NEXT", PSI_EIT_PROC_ID,
+					(int)program_number, now, &events[i], &events[i+ 1])!=
+							STAT_SUCCESS) {
+				memset(&events[i], 0, 2* sizeof(psi_eit_event_t));
+				events[i].start_time= events[i+ 1].start_time= -1;
+			}
+			i+= 2;
+		}
+	}
+
+	*ref_events= events;
+	*ref_events_num= events_num;
+	return STAT_SUCCESS;
+}
+
+/**
+ * Compare the identity of two present/following events arrays (see
+ * 'programs_summary_events_get()').
+ * @return Non-zero if equal, zero otherwise.
+ */
+static int programs_summary_events_equal(const psi_eit_event_t *events1,
+		int events_num1, const psi_eit_event_t *events2, int events_num2)
+{
+	int i;
+
+	if(events_num1!= events_num2)
+		return 0;
+	for(i= 0; i< events_num1; i++) {
+		const psi_eit_event_t *event1= &events1[i], *event2= &events2[i];
+		if(event1->start_time!= event2->start_time)
+			return 0;
+		if(event1->start_time< 0)
+			continue; // Not available
+		if(event1->event_id!= event2->event_id ||
+				event1->duration!= event2->duration ||
+				strncmp(event1->event_name, event2->event_name,
+						PSI_EIT_EVENT_NAME_MAX)!= 0)
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * Render programs REST summary array (see
+ * 'mpeg2_sp_rest_get_programs_summary()') from the given PAT and SDT
+ * snapshots (both may be NULL if not parsed yet) and the present/following
+ * events of the PAT programs (see 'programs_summary_events_get()').
+ */
+static cJSON* mpeg2_sp_rest_get_programs_summary_render(
+		mpeg2_sp_ctx_t *mpeg2_sp_ctx, const psi_table_ctx_t *psi_table_ctx_pat,
+		const psi_table_ctx_t *psi_table_ctx_sdt, const uint8_t *assoc,
+		const psi_eit_event_t *events, int events_num, log_ctx_t *log_ctx)
+{
+	llist_t *n;
+	int end_code= STAT_ERROR, event_idx= 0;
+	cJSON *cjson_programs= NULL, *cjson_program= NULL;
+	char href[256]= {0};
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return NULL);
+	CHECK_DO(assoc!= NULL, return NULL);
+
+	cjson_programs= cJSON_CreateArray();
+	CHECK_DO(cjson_programs!= NULL, goto end);
+
+	if(psi_table_ctx_pat== NULL) {
+		end_code= STAT_SUCCESS;
 		goto end; // PAT still not parsed
+	}
 
 	/* Iterate over PAT sections to get program list */
 	for(n= psi_table_ctx_pat->psi_section_ctx_llist; n!= NULL; n= n->next) {
@@ -1151,13 +1762,11 @@ static void mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
 
 		/* Iterate over PAS programs */
 		for(n2= psi_pas_ctx->psi_pas_prog_ctx_llist; n2!= NULL; n2= n2->next) {
-			int ret_code;
 			psi_pas_prog_ctx_t *psi_pas_prog_ctx;
 			uint16_t program_number, prog_pid;
 			cJSON *cjson_aux= NULL, *cjson_links= NULL,
 					*cjson_link; // Do not release
 			const char *service_name= NULL; // Do not release
-			char *rest_str= NULL;
 
 			psi_pas_prog_ctx= (psi_pas_prog_ctx_t*)n2->data;
 			CHECK_DO(psi_section_ctx!= NULL, continue);
@@ -1189,12 +1798,22 @@ static void mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
 			CHECK_DO(cjson_aux!= NULL, goto end);
 			cJSON_AddItemToObject(cjson_program, "service_name", cjson_aux);
 
-			/* Check if there is a processor associated */
-			ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_prog, "PROCS_ID_GET",
-					prog_pid, &rest_str);
-			if(rest_str!= NULL)
-				free(rest_str);
-			if(ret_code== STAT_SUCCESS)
+			/* Present and following events */
+			CHECK_DO(events!= NULL && event_idx+ 1< events_num, goto end);
+			cjson_aux= mpeg2_sp_rest_get_eit_event(&events[event_idx],
+					LOG_CTX_GET());
+			CHECK_DO(cjson_aux!= NULL, goto end);
+			cJSON_AddItemToObject(cjson_program, "event_now", cjson_aux);
+			cjson_aux= mpeg2_sp_rest_get_eit_event(&events[event_idx+ 1],
+					LOG_CTX_GET());
+			event_idx+= 2;
+			CHECK_DO(cjson_aux!= NULL, goto end);
+			cJSON_AddItemToObject(cjson_program, "event_next", cjson_aux);
+
+			/* Check if there is a processor associated (processor Id. is
+			 * the program PID).
+			 */
+			if((assoc[prog_pid>> 3]& (1<< (prog_pid& 7)))!= 0)
 				cjson_aux= cJSON_CreateTrue();
 			else
 				cjson_aux= cJSON_CreateFalse();
@@ -1227,61 +1846,229 @@ static void mpeg2_sp_rest_get_programs_summary(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
 		}
 	}
 
+
+	end_code= STAT_SUCCESS;
 end:
-	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->psi_table_ctx_pat_mutex)== 0);
 	if(cjson_program!= NULL)
 		cJSON_Delete(cjson_program);
-	return;
+	if(end_code!= STAT_SUCCESS && cjson_programs!= NULL) {
+		cJSON_Delete(cjson_programs);
+		cjson_programs= NULL;
+	}
+	return cjson_programs;
 }
 
 /**
- * Initialize specific MPEG2 stream processor settings to defaults.
- * @param mpeg2_sp_settings_ctx
- * @param log_ctx
- * @return Status code (STAT_SUCCESS code in case of success, for other code
- * values please refer to .stat_codes.h).
+ * Get EIT event REST (see 'mpeg2_sp_rest_get_programs_summary()'); a JSON
+ * null is returned if the event is not available.
  */
-static int mpeg2_sp_settings_ctx_init(
-		volatile mpeg2_sp_settings_ctx_t *mpeg2_sp_settings_ctx,
-		log_ctx_t *log_ctx)
+static cJSON* mpeg2_sp_rest_get_eit_event(
+		const psi_eit_event_t *psi_eit_event, log_ctx_t *log_ctx)
 {
+	int end_code= STAT_ERROR;
+	cJSON *cjson_event= NULL;
+	cJSON *cjson_aux= NULL; // Do not release
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
-	CHECK_DO(mpeg2_sp_settings_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_eit_event!= NULL, return NULL);
 
-	/* Input URL */
-	mpeg2_sp_settings_ctx->input_url= NULL; // Set by 'demuxer_opt()'
+	if(psi_eit_event->start_time< 0)
+		return cJSON_CreateNull();
 
-	/* MPEG2 stream processor tag (user customizable textual identifier) */
-	mpeg2_sp_settings_ctx->tag= NULL; // Set by 'demuxer_opt()'
+	cjson_event= cJSON_CreateObject();
+	CHECK_DO(cjson_event!= NULL, goto end);
 
-	/* Flag to clear logs register */
-	mpeg2_sp_settings_ctx->flag_clear_logs= 0;
+	cjson_aux= cJSON_CreateNumber((double)psi_eit_event->event_id);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_event, "event_id", cjson_aux);
 
-	/* Flag to purge disassociated processors */
-	mpeg2_sp_settings_ctx->flag_purge_disassociated_processors= 0;
+	cjson_aux= cJSON_CreateNumber((double)psi_eit_event->start_time);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_event, "start_time", cjson_aux);
 
-	// Reserved for future use
+	cjson_aux= cJSON_CreateNumber((double)psi_eit_event->duration);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_event, "duration", cjson_aux);
 
-	return STAT_SUCCESS;
+	cjson_aux= cJSON_CreateString(psi_eit_event->event_name);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_event, "event_name", cjson_aux);
+
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code!= STAT_SUCCESS && cjson_event!= NULL) {
+		cJSON_Delete(cjson_event);
+		cjson_event= NULL;
+	}
+	return cjson_event;
 }
 
 /**
- * Release specific MPEG2 stream processor settings (allocated in heap memory).
- * @param mpeg2_sp_settings_ctx
- * @param log_ctx
+ * Get section taps REST (see 'mpeg2_sp_rest_get()').
  */
-static void mpeg2_sp_settings_ctx_deinit(
-		volatile mpeg2_sp_settings_ctx_t *mpeg2_sp_settings_ctx,
+static cJSON* mpeg2_sp_rest_get_taps(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
 		log_ctx_t *log_ctx)
 {
+	int i, ret_code, end_code= STAT_ERROR;
+	int tap_pid_array[MPEG2_SP_TAPS_MAX];
+	cJSON *cjson_taps= NULL;
+	cJSON *cjson_tap= NULL, *cjson_aux= NULL; // Do not release
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
-	CHECK_DO(mpeg2_sp_settings_ctx!= NULL, return);
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return NULL);
 
-	/* Release input URL */
+	cjson_taps= cJSON_CreateArray();
+	CHECK_DO(cjson_taps!= NULL, goto end);
+
+	/* Take a snapshot of the registered taps */
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->tap_mutex)== 0);
+	memcpy(tap_pid_array, mpeg2_sp_ctx->tap_pid_array, sizeof(tap_pid_array));
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->tap_mutex)== 0);
+
+	for(i= 0; i< MPEG2_SP_TAPS_MAX; i++) {
+		psi_proc_tap_stats_t psi_proc_tap_stats= {0};
+
+		if(tap_pid_array[i]< 0)
+			continue;
+		ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_tap,
+				"PROCS_ID_PSI_TAP_GET_STATS", i, &psi_proc_tap_stats);
+		if(ret_code!= STAT_SUCCESS)
+			continue; // Tap deleted meanwhile
+
+		cjson_tap= cJSON_CreateObject();
+		CHECK_DO(cjson_tap!= NULL, goto end);
+		cJSON_AddItemToArray(cjson_taps, cjson_tap);
+
+		cjson_aux= cJSON_CreateNumber((double)i);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_tap, "tap_id", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber((double)tap_pid_array[i]);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_tap, "pid", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber(
+				(double)psi_proc_tap_stats.sections_tapped);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_tap, "sections_tapped", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber(
+				(double)psi_proc_tap_stats.sections_overwritten);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_tap, "sections_overwritten", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber(
+				(double)psi_proc_tap_stats.sections_filtered);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_tap, "sections_filtered", cjson_aux);
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code!= STAT_SUCCESS && cjson_taps!= NULL) {
+		cJSON_Delete(cjson_taps);
+		cjson_taps= NULL;
+	}
+	return cjson_taps;
+}
+
+/**
+ * Get object pools statistics REST (see 'mpeg2_sp_rest_get()').
+ */
+static cJSON* mpeg2_sp_rest_get_obj_pools(log_ctx_t *log_ctx)
+{
+	int i, end_code= STAT_ERROR;
+	obj_pool_stats_t obj_pool_stats[OBJ_POOL_CLASS_NUM];
+	cJSON *cjson_pools= NULL;
+	cJSON *cjson_pool= NULL, *cjson_aux= NULL; // Do not release
+	LOG_CTX_INIT(log_ctx);
+
+	cjson_pools= cJSON_CreateArray();
+	CHECK_DO(cjson_pools!= NULL, goto end);
+
+	obj_pool_stats_get(obj_pool_stats);
+	for(i= 0; i< OBJ_POOL_CLASS_NUM; i++) {
+		cjson_pool= cJSON_CreateObject();
+		CHECK_DO(cjson_pool!= NULL, goto end);
+		cJSON_AddItemToArray(cjson_pools, cjson_pool);
+
+		cjson_aux= cJSON_CreateNumber((double)obj_pool_stats[i].object_size);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_pool, "object_size", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber((double)obj_pool_stats[i].objects_live);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_pool, "objects_live", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber(
+				(double)obj_pool_stats[i].objects_live_max);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_pool, "objects_live_max", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber((double)obj_pool_stats[i].slabs);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_pool, "slabs", cjson_aux);
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code!= STAT_SUCCESS && cjson_pools!= NULL) {
+		cJSON_Delete(cjson_pools);
+		cjson_pools= NULL;
+	}
+	return cjson_pools;
+}
+
+/**
+ * Initialize specific MPEG2 stream processor settings to defaults.
+ * @param mpeg2_sp_settings_ctx
+ * @param log_ctx
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+static int mpeg2_sp_settings_ctx_init(
+		volatile mpeg2_sp_settings_ctx_t *mpeg2_sp_settings_ctx,
+		log_ctx_t *log_ctx)
+{
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_settings_ctx!= NULL, return STAT_ERROR);
+
+	/* Input URL */
+	mpeg2_sp_settings_ctx->input_url= NULL; // Set by 'demuxer_opt()'
+
+	/* MPEG2 stream processor tag (user customizable textual identifier) */
+	mpeg2_sp_settings_ctx->tag= NULL; // Set by 'demuxer_opt()'
+
+	/* Flag to clear logs register */
+	mpeg2_sp_settings_ctx->flag_clear_logs= 0;
+
+	/* Flag to purge disassociated processors */
+	mpeg2_sp_settings_ctx->flag_purge_disassociated_processors= 0;
+
+	// Reserved for future use
+
+	return STAT_SUCCESS;
+}
+
+/**
+ * Release specific MPEG2 stream processor settings (allocated in heap memory).
+ * @param mpeg2_sp_settings_ctx
+ * @param log_ctx
+ */
+static void mpeg2_sp_settings_ctx_deinit(
+		volatile mpeg2_sp_settings_ctx_t *mpeg2_sp_settings_ctx,
+		log_ctx_t *log_ctx)
+{
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_settings_ctx!= NULL, return);
+
+	/* Release input URL */
 	if(mpeg2_sp_settings_ctx->input_url!= NULL) {
 		free(mpeg2_sp_settings_ctx->input_url);
 		mpeg2_sp_settings_ctx->input_url= NULL;
@@ -1307,11 +2094,14 @@ static void* distr_thr(void *t)
 	uint32_t average_counter= 0;
 	int64_t profile_nsec, average_nsecs= 0;
 #endif
-	uint16_t pid= 0;
+	int i;
+	uint32_t j;
+	uint16_t pid= 0, tap_mask;
 	mpeg2_sp_ctx_t *mpeg2_sp_ctx= (mpeg2_sp_ctx_t*)t; // Do not release
 	proc_ctx_t *proc_ctx= NULL; // Do not release (alias)
 	int *ref_end_code= NULL; // Do not release
 	uint8_t *recv_buf= NULL;
+	prog_routes_t *prog_routes= NULL;
 	LOG_CTX_INIT(NULL);
 
 	/* Allocate return context; initialize to a default 'STAT_ERROR' value */
@@ -1330,6 +2120,7 @@ static void* distr_thr(void *t)
 		int ret_code;
 		size_t recv_buf_size= 0;
 		uint8_t *pkt_p;
+		int64_t arrival_usec;
 
 		/* Receive new packet of data from input interface */
 		if(recv_buf!= NULL) {
@@ -1337,6 +2128,7 @@ static void* distr_thr(void *t)
 			recv_buf= NULL;
 			recv_buf_size= 0;
 		}
+		prog_routes_release(&prog_routes, &mpeg2_sp_ctx->prog_routes_mutex);
 		ret_code= comm_recv_external(&mpeg2_sp_ctx->comm_ctx_input_mutex,
 				&mpeg2_sp_ctx->comm_ctx_input, (void**)&recv_buf,
 				&recv_buf_size, NULL, NULL, LOG_CTX_GET());
@@ -1356,6 +2148,10 @@ static void* distr_thr(void *t)
 			continue;
 		}
 		CHECK_DO(recv_buf!= NULL, schedule(); continue);
+		arrival_usec= stc_monotonic_usec();
+
+		/* Take the current program routing snapshot for the whole buffer */
+		prog_routes= prog_routes_get(mpeg2_sp_ctx);
 
 		for(pkt_p= recv_buf; recv_buf_size>= TS_PKT_SIZE;
 				pkt_p+= TS_PKT_SIZE, recv_buf_size-= TS_PKT_SIZE) {
@@ -1387,6 +2183,11 @@ static void* distr_thr(void *t)
 			profile_nsec= (int64_t)monotime.tv_sec*1000000000+
 					(int64_t)monotime.tv_nsec;
 #endif
+			/* Peek elementary streams timing (few instructions per packet;
+			 * PES header is only inspected on PES start).
+			 */
+			ts_timing_packet(mpeg2_sp_ctx->ts_timing_ctx, pkt_p, arrival_usec);
+
 			proc_frame_ctx_t proc_frame_ctx= {0};
 			proc_frame_ctx.data= pkt_p;
 			proc_frame_ctx.p_data[0]= pkt_p;
@@ -1397,15 +2198,53 @@ static void* distr_thr(void *t)
 			proc_frame_ctx.pts= -1;
 			proc_frame_ctx.dts= -1;
 			proc_frame_ctx.es_id= pid; // pass PID as stream ID!.
-			ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_psi, pid,
-					&proc_frame_ctx);
-			ASSERT(ret_code!= STAT_ERROR);
-			ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_prog, pid,
-					&proc_frame_ctx);
+			ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_psi,
+					PSI_DEMUX_PROC_ID, &proc_frame_ctx);
 			ASSERT(ret_code!= STAT_ERROR);
+			if(pid== PSI_DVB_EIT_PID_NUMBER) {
+				ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_psi,
+						PSI_EIT_PROC_ID, &proc_frame_ctx);
+				ASSERT(ret_code!= STAT_ERROR);
+			}
+			if(prog_routes== NULL) {
+				ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_prog, pid,
+						&proc_frame_ctx);
+				ASSERT(ret_code!= STAT_ERROR);
+			} else if(pid== PSI_PAT_PID_NUMBER) {
+				/* PAT is needed by every program processor */
+				for(i= 0; i< prog_routes->pmt_pid_num; i++) {
+					ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_prog,
+							prog_routes->pmt_pid_array[i], &proc_frame_ctx);
+					ASSERT(ret_code!= STAT_ERROR);
+				}
+			} else if((j= prog_routes->pid_offset_array[pid])==
+					prog_routes->pid_offset_array[pid+ 1]) {
+				/* Unknown PIDs are sent using its own PID as processor Id. */
+				ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_prog, pid,
+						&proc_frame_ctx);
+				ASSERT(ret_code!= STAT_ERROR);
+			} else {
+				/* Send to the processors of every program the PID belongs
+				 * to.
+				 */
+				for(; j< prog_routes->pid_offset_array[pid+ 1]; j++) {
+					ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_prog,
+							prog_routes->pid_prog_array[j], &proc_frame_ctx);
+					ASSERT(ret_code!= STAT_ERROR);
+				}
+			}
 			ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_dis_prog, pid,
 					&proc_frame_ctx);
 			ASSERT(ret_code!= STAT_ERROR);
+			/* Send to the section taps registered for the PID (if any) */
+			for(i= 0, tap_mask= mpeg2_sp_ctx->tap_route_array[pid];
+					tap_mask!= 0; i++, tap_mask>>= 1) {
+				if((tap_mask& 1)== 0)
+					continue;
+				ret_code= procs_send_frame(mpeg2_sp_ctx->procs_ctx_tap, i,
+						&proc_frame_ctx);
+				ASSERT(ret_code!= STAT_ERROR);
+			}
 #ifdef PROFILE_DISTR_THR
 			clock_gettime(CLOCK_MONOTONIC, &monotime);
 			profile_nsec= (int64_t)monotime.tv_sec*1000000000+
@@ -1434,6 +2273,8 @@ static void* distr_thr(void *t)
 end:
 	if(recv_buf!= NULL)
 		free(recv_buf);
+	if(mpeg2_sp_ctx!= NULL)
+		prog_routes_release(&prog_routes, &mpeg2_sp_ctx->prog_routes_mutex);
 	return (void*)ref_end_code;
 }
 
@@ -1446,6 +2287,7 @@ static void* psi_thr(void *t)
 	mpeg2_sp_ctx_t *mpeg2_sp_ctx= (mpeg2_sp_ctx_t*)t; // Do not release
 	proc_ctx_t *proc_ctx= NULL; // Do not release (alias)
 	int *ref_end_code= NULL; // Do not release
+	int flag_psi_changed= 1; // First composition may find PSI already parsed
 	LOG_CTX_INIT(NULL);
 
 	/* Allocate return context; initialize to a default 'STAT_ERROR' value */
@@ -1462,18 +2304,39 @@ static void* psi_thr(void *t)
 
 	while(mpeg2_sp_ctx->distr_flag_exit== 0) {
 		int ret_code;
+		psi_event_t *psi_event= NULL;
+		size_t psi_event_size= 0;
 
 		/* Get PAT and PMT.
 		 * This function is also responsible for launching PMT processors if
 		 * applicable (PMT processors are in charge of parsing and generating
 		 * the Program Map Sections -PMS's-).
 		 */
-		compose_pat_and_pmt(mpeg2_sp_ctx, LOG_CTX_GET());
+		compose_pat_and_pmt(mpeg2_sp_ctx, flag_psi_changed, LOG_CTX_GET());
 
-		/* Periodic-sleep */
-		ret_code= interr_usleep(mpeg2_sp_ctx->interr_usleep_ctx_psi_stats,
-				PSI_THREAD_PERIOD_USECS);
-		ASSERT(ret_code!= STAT_ERROR);
+		/* Wait for the next PSI version-change event (or for the safety
+		 * refresh period to elapse).
+		 */
+		ret_code= fifo_timedget(mpeg2_sp_ctx->fifo_ctx_psi_events,
+				(void**)&psi_event, &psi_event_size, PSI_THREAD_PERIOD_USECS);
+		if(ret_code== STAT_EAGAIN) {
+			schedule(); // Queue unblocked; we are requested to exit
+			continue;
+		}
+		ASSERT(ret_code== STAT_SUCCESS || ret_code== STAT_ETIMEDOUT);
+		flag_psi_changed= (ret_code== STAT_SUCCESS);
+
+		/* Coalesce events already queued; PAT and PMT are recomposed once */
+		while(psi_event!= NULL) {
+			free(psi_event);
+			psi_event= NULL;
+			if(fifo_get_buffer_level(mpeg2_sp_ctx->fifo_ctx_psi_events)<= 0)
+				break;
+			ret_code= fifo_get(mpeg2_sp_ctx->fifo_ctx_psi_events,
+					(void**)&psi_event, &psi_event_size);
+			if(ret_code!= STAT_SUCCESS)
+				break;
+		}
 	}
 
 	*ref_end_code= STAT_SUCCESS;
@@ -1481,12 +2344,454 @@ end:
 	return (void*)ref_end_code;
 }
 
-static void compose_pat_and_pmt(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+/**
+ * PSI version-change notification callback (see 'psi_proc_notify_fxn_t').
+ * Called from the PSI processor thread; just queues the event.
+ */
+static void psi_notify(void *opaque, uint16_t pid, uint8_t table_id,
+		uint8_t version_number)
+{
+	int ret_code;
+	psi_event_t psi_event;
+	mpeg2_sp_ctx_t *mpeg2_sp_ctx= (mpeg2_sp_ctx_t*)opaque;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return);
+
+	LOG_CTX_SET(((proc_ctx_t*)mpeg2_sp_ctx)->log_ctx);
+
+	psi_event.pid= pid;
+	psi_event.table_id= table_id;
+	psi_event.version_number= version_number;
+	ret_code= fifo_put_dup(mpeg2_sp_ctx->fifo_ctx_psi_events, &psi_event,
+			sizeof(psi_event_t));
+	// If queue is full, an event is already pending: PAT and PMT will be
+	// recomposed anyway.
+	ASSERT(ret_code== STAT_SUCCESS || ret_code== STAT_ENOMEM);
+}
+
+/**
+ * Register PSI version-change notification callback in the given PSI
+ * processor.
+ */
+static int psi_notify_register(mpeg2_sp_ctx_t *mpeg2_sp_ctx, int proc_id,
+		log_ctx_t *log_ctx)
+{
+	int ret_code;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return STAT_ERROR);
+
+	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi, "PROCS_ID_PSI_SET_NOTIFY",
+			proc_id, (psi_proc_notify_fxn_t)psi_notify, (void*)mpeg2_sp_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+	return STAT_SUCCESS;
+}
+
+/**
+ * Register a PID to be parsed in the PSI demultiplexer processor.
+ * Only the sections with the given 'table_id' are decoded (section filter).
+ */
+static int psi_pid_register(mpeg2_sp_ctx_t *mpeg2_sp_ctx, uint16_t pid,
+		psi_proc_pid_type_t pid_type, uint8_t table_id, log_ctx_t *log_ctx)
+{
+	int ret_code;
+	psi_filter_t psi_filter;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return STAT_ERROR);
+
+	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi, "PROCS_ID_PSI_PID_ADD",
+			PSI_DEMUX_PROC_ID, pid, pid_type);
+	CHECK_DO(ret_code== STAT_SUCCESS, return ret_code);
+
+	psi_filter_init(&psi_filter);
+	psi_filter_set_table_id(&psi_filter, table_id);
+	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+			"PROCS_ID_PSI_PID_FILTER_ADD", PSI_DEMUX_PROC_ID, pid,
+			&psi_filter, NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS, return ret_code);
+	return STAT_SUCCESS;
+}
+
+/**
+ * Set the input URL the last-known PSI is saved for and, if the PSI
+ * processors are already running, preload the last-known PSI of the new
+ * input.
+ */
+static int last_psi_input_set(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const char *input_url, log_ctx_t *log_ctx)
+{
+	char *url= NULL, *path= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return STAT_ERROR);
+
+	if(mpeg2_sp_ctx->last_psi_dir!= NULL && input_url!= NULL &&
+			strlen(input_url)> 0) {
+		url= strdup(input_url);
+		CHECK_DO(url!= NULL, return STAT_ERROR);
+		path= psi_store_path(mpeg2_sp_ctx->last_psi_dir, input_url);
+		CHECK_DO(path!= NULL, free(url); return STAT_ERROR);
+	}
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	if(mpeg2_sp_ctx->last_psi_url!= NULL)
+		free(mpeg2_sp_ctx->last_psi_url);
+	mpeg2_sp_ctx->last_psi_url= url;
+	if(mpeg2_sp_ctx->last_psi_path!= NULL)
+		free(mpeg2_sp_ctx->last_psi_path);
+	mpeg2_sp_ctx->last_psi_path= path;
+	mpeg2_sp_ctx->last_psi_crc= 0;
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+
+	if(mpeg2_sp_ctx->procs_ctx_psi!= NULL)
+		last_psi_preload(mpeg2_sp_ctx, LOG_CTX_GET());
+	return STAT_SUCCESS;
+}
+
+/**
+ * Preload the last-known PSI of the current input (if saved) into the PSI
+ * demultiplexer processor as provisional tables: the program processors and
+ * packets routing are set up at once, and the tables received from the
+ * input then confirm (by CRC) or replace the preloaded ones.
+ * The PMS are preloaded before the PAT, so that the PAT version-change event
+ * finds the complete PMT.
+ */
+static void last_psi_preload(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		log_ctx_t *log_ctx)
+{
+	int i, pass, ret_code, rec_num= 0;
+	char *url= NULL, *path= NULL;
+	psi_store_rec_t *rec_array= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return);
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	if(mpeg2_sp_ctx->last_psi_path!= NULL) {
+		url= strdup(mpeg2_sp_ctx->last_psi_url);
+		path= strdup(mpeg2_sp_ctx->last_psi_path);
+	}
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	if(url== NULL || path== NULL)
+		goto end;
+
+	ret_code= psi_store_load(path, url, LOG_CTX_GET(), &rec_array, &rec_num);
+	if(ret_code!= STAT_SUCCESS)
+		goto end; // Nothing saved for this input (or invalid file)
+
+	for(pass= 0; pass< 2; pass++) {
+		for(i= 0; i< rec_num; i++) {
+			psi_proc_stats_t psi_proc_stats;
+			uint16_t pid= rec_array[i].pid;
+
+			if((pid== PSI_PAT_PID_NUMBER)!= (pass== 1) ||
+					pid> TS_MAX_PID_VAL)
+				continue;
+
+			/* Register PMS PID if not yet registered */
+			if(procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+					"PROCS_ID_PSI_PID_GET_STATS", PSI_DEMUX_PROC_ID, pid,
+					&psi_proc_stats)== STAT_ENOTFOUND) {
+				ret_code= psi_pid_register(mpeg2_sp_ctx, pid,
+						PSI_PROC_PID_SECTION,
+						PSI_TABLE_TS_PROGRAM_MAP_SECTION, LOG_CTX_GET());
+				CHECK_DO(ret_code== STAT_SUCCESS, continue);
+			}
+
+			ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+					"PROCS_ID_PSI_PID_PRELOAD", PSI_DEMUX_PROC_ID, pid,
+					(const void*)rec_array[i].buf, rec_array[i].buf_size);
+			CHECK_DO(ret_code== STAT_SUCCESS, continue);
+		}
+	}
+	LOGD("Last-known PSI preloaded (%d PIDs) for input '%s'\n", rec_num,
+			url);
+
+	/* Do not save again what was just loaded */
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	mpeg2_sp_ctx->last_psi_crc= last_psi_crc(rec_array, rec_num);
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+
+end:
+	/* PAT sections received from now on belong to the current input */
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	mpeg2_sp_ctx->last_psi_pat_count= last_psi_pat_count(mpeg2_sp_ctx);
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	psi_store_recs_release(&rec_array, rec_num);
+	if(url!= NULL)
+		free(url);
+	if(path!= NULL)
+		free(path);
+}
+
+/**
+ * Save the last-known PSI of the current input, namely, the raw sections of
+ * the given PAT, of the PMS of the programs it lists and of the SDT.
+ * The store file is only written if the PSI changed since it was last
+ * saved (or loaded).
+ */
+static void last_psi_save(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pat, log_ctx_t *log_ctx)
+{
+	llist_t *n;
+	int i, ret_code, rec_num= 0, rec_num_max= 2;
+	uint32_t crc_32, crc_32_prev= 0;
+	uint64_t pat_count_base= 0;
+	char *url= NULL, *path= NULL;
+	psi_store_rec_t *rec_array= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return);
+	CHECK_DO(psi_table_ctx_pat!= NULL, return);
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	if(mpeg2_sp_ctx->last_psi_path!= NULL) {
+		url= strdup(mpeg2_sp_ctx->last_psi_url);
+		path= strdup(mpeg2_sp_ctx->last_psi_path);
+		crc_32_prev= mpeg2_sp_ctx->last_psi_crc;
+		pat_count_base= mpeg2_sp_ctx->last_psi_pat_count;
+	}
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	if(url== NULL || path== NULL)
+		goto end;
+
+	/* Wait for a PAT to be received from the current input */
+	if(last_psi_pat_count(mpeg2_sp_ctx)<= pat_count_base)
+		goto end;
+
+	/* Get the raw sections: PAT first, PMS of each program and SDT */
+	for(n= psi_table_ctx_pat->psi_section_ctx_llist; n!= NULL; n= n->next) {
+		psi_section_ctx_t *psi_section_ctx_ith= (psi_section_ctx_t*)n->data;
+		if(psi_section_ctx_ith!= NULL && psi_section_ctx_ith->data!= NULL)
+			rec_num_max+= llist_len(((psi_pas_ctx_t*)
+					psi_section_ctx_ith->data)->psi_pas_prog_ctx_llist);
+	}
+	if(rec_num_max> PSI_STORE_RECS_MAX)
+		rec_num_max= PSI_STORE_RECS_MAX;
+	rec_array= (psi_store_rec_t*)calloc(rec_num_max, sizeof(psi_store_rec_t));
+	CHECK_DO(rec_array!= NULL, goto end);
+
+	rec_array[0].pid= PSI_PAT_PID_NUMBER;
+	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+			"PROCS_ID_PSI_PID_GET_RAW", PSI_DEMUX_PROC_ID, PSI_PAT_PID_NUMBER,
+			&rec_array[0].buf, &rec_array[0].buf_size);
+	if(ret_code!= STAT_SUCCESS || rec_array[0].buf== NULL)
+		goto end;
+	rec_num= 1;
+
+	for(n= psi_table_ctx_pat->psi_section_ctx_llist; n!= NULL; n= n->next) {
+		llist_t *n2;
+		psi_section_ctx_t *psi_section_ctx_ith= (psi_section_ctx_t*)n->data;
+		if(psi_section_ctx_ith== NULL || psi_section_ctx_ith->data== NULL)
+			continue;
+		for(n2= ((psi_pas_ctx_t*)psi_section_ctx_ith->data)->
+				psi_pas_prog_ctx_llist; n2!= NULL; n2= n2->next) {
+			psi_store_rec_t *psi_store_rec= &rec_array[rec_num];
+			psi_pas_prog_ctx_t *psi_pas_prog_ctx_jth=
+					(psi_pas_prog_ctx_t*)n2->data;
+			if(psi_pas_prog_ctx_jth== NULL ||
+					psi_pas_prog_ctx_jth->program_number== 0 ||
+					rec_num>= rec_num_max- 1)
+				continue;
+
+			/* Skip PMT PIDs shared by several programs */
+			for(i= 1; i< rec_num; i++) {
+				if(rec_array[i].pid== psi_pas_prog_ctx_jth->reference_pid)
+					break;
+			}
+			if(i< rec_num)
+				continue;
+
+			psi_store_rec->pid= psi_pas_prog_ctx_jth->reference_pid;
+			ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+					"PROCS_ID_PSI_PID_GET_RAW", PSI_DEMUX_PROC_ID,
+					psi_store_rec->pid, &psi_store_rec->buf,
+					&psi_store_rec->buf_size);
+			if(ret_code== STAT_SUCCESS && psi_store_rec->buf!= NULL)
+				rec_num++;
+		}
+	}
+
+	rec_array[rec_num].pid= PSI_DVB_SDT_PID_NUMBER;
+	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+			"PROCS_ID_PSI_PID_GET_RAW", PSI_DEMUX_PROC_ID,
+			PSI_DVB_SDT_PID_NUMBER, &rec_array[rec_num].buf,
+			&rec_array[rec_num].buf_size);
+	if(ret_code== STAT_SUCCESS && rec_array[rec_num].buf!= NULL)
+		rec_num++;
+
+	/* Save only if changed */
+	crc_32= last_psi_crc(rec_array, rec_num);
+	if(crc_32== crc_32_prev)
+		goto end;
+	ret_code= psi_store_save(path, url, rec_array, rec_num, LOG_CTX_GET());
+	if(ret_code!= STAT_SUCCESS)
+		goto end;
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+	if(mpeg2_sp_ctx->last_psi_path!= NULL &&
+			strcmp(mpeg2_sp_ctx->last_psi_path, path)== 0)
+		mpeg2_sp_ctx->last_psi_crc= crc_32;
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->last_psi_mutex)== 0);
+
+end:
+	psi_store_recs_release(&rec_array, rec_num_max);
+	if(url!= NULL)
+		free(url);
+	if(path!= NULL)
+		free(path);
+}
+
+/**
+ * CRC of the given last-known PSI records (PIDs and raw sections).
+ */
+static uint32_t last_psi_crc(const psi_store_rec_t *rec_array, int rec_num)
+{
+	int i;
+	uint32_t crc_32= PSI_CRC32_INIT;
+
+	for(i= 0; i< rec_num; i++) {
+		uint8_t pid_bytes[2]= {rec_array[i].pid>> 8, rec_array[i].pid& 0xFF};
+		crc_32= psi_crc32_update(crc_32, pid_bytes, 2);
+		crc_32= psi_crc32_update(crc_32, (const uint8_t*)rec_array[i].buf,
+				rec_array[i].buf_size);
+	}
+	return crc_32;
+}
+
+/**
+ * Number of PAT sections received (decoded or repeated) so far.
+ */
+static uint64_t last_psi_pat_count(mpeg2_sp_ctx_t *mpeg2_sp_ctx)
+{
+	psi_proc_stats_t psi_proc_stats;
+
+	if(mpeg2_sp_ctx->procs_ctx_psi== NULL ||
+			procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+					"PROCS_ID_PSI_PID_GET_STATS", PSI_DEMUX_PROC_ID,
+					PSI_PAT_PID_NUMBER, &psi_proc_stats)!= STAT_SUCCESS)
+		return 0;
+	return psi_proc_stats.sections_decoded+ psi_proc_stats.sections_repeated;
+}
+
+/**
+ * Add a section tap on the given PID: a section tap processor
+ * ('proc_if_psi_tap_proc') is instantiated with the given settings and the
+ * PID packets are routed to it.
+ */
+static int tap_add(mpeg2_sp_ctx_t *mpeg2_sp_ctx, int pid,
+		const char *tap_settings, int *ref_tap_id, log_ctx_t *log_ctx)
+{
+	int ret_code, end_code= STAT_ERROR, tap_id= -1, proc_id= -1;
+	size_t settings_size;
+	char *settings= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(pid>= 0 && pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+	CHECK_DO(tap_settings!= NULL, return STAT_ERROR);
+	// Parameter 'ref_tap_id' is allowed to be NULL
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->tap_mutex)== 0);
+
+	/* Get a free tap Id. */
+	for(tap_id= 0; tap_id< MPEG2_SP_TAPS_MAX; tap_id++) {
+		if(mpeg2_sp_ctx->tap_pid_array[tap_id]< 0)
+			break;
+	}
+	if(tap_id>= MPEG2_SP_TAPS_MAX) {
+		LOGE("Maximum number of section taps reached\n");
+		end_code= STAT_ENOMEM;
+		goto end;
+	}
+
+	/* Instantiate tap processor (tap Id. is used as processor Id.) */
+	settings_size= strlen(tap_settings)+ 32;
+	settings= (char*)calloc(1, settings_size);
+	CHECK_DO(settings!= NULL, goto end);
+	snprintf(settings, settings_size, "forced_proc_id=%d&%s", tap_id,
+			tap_settings);
+	ret_code= procs_post(mpeg2_sp_ctx->procs_ctx_tap, "psi_tap_proc",
+			settings, &proc_id, LOG_CTX_GET());
+	if(ret_code!= STAT_SUCCESS || proc_id!= tap_id) {
+		/* Do not leak a processor that was created with another Id. */
+		if(ret_code== STAT_SUCCESS && proc_id>= 0) {
+			ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_tap,
+					"PROCS_ID_DELETE", proc_id);
+			ASSERT(ret_code== STAT_SUCCESS);
+		}
+		end_code= STAT_EINVAL;
+		goto end;
+	}
+
+	/* Route PID packets to the new tap */
+	mpeg2_sp_ctx->tap_pid_array[tap_id]= pid;
+	mpeg2_sp_ctx->tap_route_array[pid]|= (uint16_t)(1<< tap_id);
+
+	if(ref_tap_id!= NULL)
+		*ref_tap_id= tap_id;
+	end_code= STAT_SUCCESS;
+end:
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->tap_mutex)== 0);
+	if(settings!= NULL)
+		free(settings);
+	return end_code;
+}
+
+/**
+ * Delete the section tap with the given Id. (see 'tap_add()').
+ */
+static int tap_delete(mpeg2_sp_ctx_t *mpeg2_sp_ctx, int tap_id,
 		log_ctx_t *log_ctx)
+{
+	int pid, ret_code;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(tap_id>= 0 && tap_id< MPEG2_SP_TAPS_MAX, return STAT_EINVAL);
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->tap_mutex)== 0);
+
+	if((pid= mpeg2_sp_ctx->tap_pid_array[tap_id])< 0) {
+		ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->tap_mutex)== 0);
+		return STAT_ENOTFOUND;
+	}
+
+	/* Stop routing first, then release the tap processor */
+	mpeg2_sp_ctx->tap_route_array[pid]&= (uint16_t)~(1<< tap_id);
+	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_tap, "PROCS_ID_DELETE",
+			tap_id);
+	ASSERT(ret_code== STAT_SUCCESS || ret_code== STAT_ENOTFOUND);
+	mpeg2_sp_ctx->tap_pid_array[tap_id]= -1;
+
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->tap_mutex)== 0);
+	return STAT_SUCCESS;
+}
+
+/**
+ * Compose PAT and PMT from the PSI demultiplexer tables, launch the program
+ * processors and update the packets routing.
+ * The last-known PSI is only saved if 'flag_psi_changed' is set (PSI
+ * version-change event received), not on the periodic safety refresh.
+ */
+static void compose_pat_and_pmt(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		int flag_psi_changed, log_ctx_t *log_ctx)
 {
 	llist_t *n;
 	int ret_code;
-	psi_table_ctx_t *psi_table_ctx_pat= NULL, *psi_table_ctx_pmt= NULL;
+	psi_table_ctx_t *psi_table_ctx_pat= NULL, *psi_table_ctx_pmt= NULL,
+			*psi_table_ctx_sdt= NULL;
+	psi_table_ctx_t *psi_table_ctx_prev= NULL;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check argument */
@@ -1498,8 +2803,8 @@ static void compose_pat_and_pmt(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
 
 	/* Get current Program Association Table (PAT) */
 	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
-			"PROCS_ID_GET_CSTRUCT_REST", PSI_PAT_PID_NUMBER,
-			&psi_table_ctx_pat);
+			"PROCS_ID_PSI_PID_GET_CSTRUCT_REST", PSI_DEMUX_PROC_ID,
+			PSI_PAT_PID_NUMBER, &psi_table_ctx_pat);
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 	if(psi_table_ctx_pat== NULL)
 		goto end; // We may not still have parsed a PAT table
@@ -1534,26 +2839,59 @@ static void compose_pat_and_pmt(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
 		}
 	}
 
-	/* Finally, update PAT and PMT register with the tables just parsed */
+	/* Index composed PMT (PMS by program number) before publishing it */
+	ret_code= psi_table_ctx_index(psi_table_ctx_pmt);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Update elementary streams tracked for timing metrics */
+	update_es_timing(mpeg2_sp_ctx, psi_table_ctx_pmt, LOG_CTX_GET());
+
+	/* Update program packets routing */
+	update_prog_routes(mpeg2_sp_ctx, psi_table_ctx_pat, psi_table_ctx_pmt,
+			LOG_CTX_GET());
+
+	/* Save the last-known PSI of the input (only if changed) */
+	if(flag_psi_changed!= 0)
+		last_psi_save(mpeg2_sp_ctx, psi_table_ctx_pat, LOG_CTX_GET());
+
+	/* Finally, update PAT and PMT register with the tables just parsed
+	 * (swap snapshots; the previous ones are released out of the lock).
+	 */
 	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->psi_table_ctx_pat_mutex)== 0);
-	if(mpeg2_sp_ctx->psi_table_ctx_pat!= NULL)
-		psi_table_ctx_release(&mpeg2_sp_ctx->psi_table_ctx_pat);
+	psi_table_ctx_prev= mpeg2_sp_ctx->psi_table_ctx_pat;
 	mpeg2_sp_ctx->psi_table_ctx_pat= psi_table_ctx_pat;
 	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->psi_table_ctx_pat_mutex)== 0);
 	psi_table_ctx_pat= NULL; // Avoid double referencing
+	psi_table_ctx_release(&psi_table_ctx_prev);
 
 	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->psi_table_ctx_pmt_mutex)== 0);
-	if(mpeg2_sp_ctx->psi_table_ctx_pmt!= NULL)
-		psi_table_ctx_release(&mpeg2_sp_ctx->psi_table_ctx_pmt);
+	psi_table_ctx_prev= mpeg2_sp_ctx->psi_table_ctx_pmt;
 	mpeg2_sp_ctx->psi_table_ctx_pmt= psi_table_ctx_pmt;
 	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->psi_table_ctx_pmt_mutex)== 0);
 	psi_table_ctx_pmt= NULL; // Avoid double referencing
+	psi_table_ctx_release(&psi_table_ctx_prev);
+
+	/* Register current SDT snapshot (if already parsed) */
+	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
+			"PROCS_ID_PSI_PID_GET_CSTRUCT_REST", PSI_DEMUX_PROC_ID,
+			PSI_DVB_SDT_PID_NUMBER, &psi_table_ctx_sdt);
+	if(ret_code== STAT_SUCCESS && psi_table_ctx_sdt!= NULL) {
+		ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->psi_table_ctx_sdt_mutex)== 0);
+		psi_table_ctx_prev= mpeg2_sp_ctx->psi_table_ctx_sdt;
+		mpeg2_sp_ctx->psi_table_ctx_sdt= psi_table_ctx_sdt;
+		ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->psi_table_ctx_sdt_mutex)==
+				0);
+		psi_table_ctx_sdt= NULL; // Avoid double referencing
+		psi_table_ctx_release(&psi_table_ctx_prev);
+	}
 
 end:
 	if(psi_table_ctx_pat!= NULL)
 		psi_table_ctx_release(&psi_table_ctx_pat);
 	if(psi_table_ctx_pmt!= NULL)
 		psi_table_ctx_release(&psi_table_ctx_pmt);
+	if(psi_table_ctx_sdt!= NULL)
+		psi_table_ctx_release(&psi_table_ctx_sdt);
 	return;
 }
 
@@ -1569,12 +2907,13 @@ static void compose_pmt_pms(mpeg2_sp_ctx_t *mpeg2_sp_ctx, uint16_t pms_pid,
 	CHECK_DO(pms_pid< TS_MAX_PID_VAL, return);
 	CHECK_DO(psi_table_ctx_pmt!= NULL, return);
 
-	/* Check if PMS parser/processor is already launched.
+	/* Check if PMS PID is already registered in the PSI processor.
 	 * If it is the case, we should be able to get corresponding PMS data.
-	 * Otherwise, we launch a new PMS processor and register it.
+	 * Otherwise, we register the PMS PID to be parsed.
 	 */
 	ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_psi,
-			"PROCS_ID_GET_CSTRUCT_REST", pms_pid, &psi_section_ctx_pms);
+			"PROCS_ID_PSI_PID_GET_CSTRUCT_REST", PSI_DEMUX_PROC_ID, pms_pid,
+			&psi_section_ctx_pms);
 	if(ret_code== STAT_SUCCESS) {
 		// Note that 'ret_code' can be success but not have PMS yet ...
 		if(psi_section_ctx_pms!= NULL) {
@@ -1585,15 +2924,14 @@ static void compose_pmt_pms(mpeg2_sp_ctx_t *mpeg2_sp_ctx, uint16_t pms_pid,
 			psi_section_ctx_pms= NULL; // Avoid double referencing
 		}
 	} else {
-		int proc_id= -1;
-		char settings[32]= {0}; // reserve long enough array
-
-		/* Launch PMS PSI-processor */
-		LOGV("Launching PMS PSI-processor %u\n", pms_pid); // comment-me
-		snprintf(settings, sizeof(settings), "forced_proc_id=%u", pms_pid);
-		ret_code= procs_post(mpeg2_sp_ctx->procs_ctx_psi, "psi_section_proc",
-				settings, &proc_id, LOG_CTX_GET());
-		CHECK_DO(ret_code== STAT_SUCCESS && proc_id== pms_pid, goto end);
+		/* Register PMS PID (version-changes are notified as for any other
+		 * PSI PID).
+		 */
+		LOGV("Registering PMS PID %u\n", pms_pid); // comment-me
+		ret_code= psi_pid_register(mpeg2_sp_ctx, pms_pid,
+				PSI_PROC_PID_SECTION, PSI_TABLE_TS_PROGRAM_MAP_SECTION,
+				LOG_CTX_GET());
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 	}
 
 end:
@@ -1602,6 +2940,247 @@ end:
 	return;
 }
 
+/**
+ * Register the elementary streams listed in the given PMT in the timing
+ * metrics module (elementary streams no longer listed are unregistered).
+ */
+static void update_es_timing(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx)
+{
+	llist_t *n;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return);
+	CHECK_DO(psi_table_ctx_pmt!= NULL, return);
+
+	ts_timing_es_update_begin(mpeg2_sp_ctx->ts_timing_ctx);
+
+	for(n= psi_table_ctx_pmt->psi_section_ctx_llist; n!= NULL; n= n->next) {
+		llist_t *n2;
+		psi_section_ctx_t *psi_section_ctx_ith;
+		psi_pms_ctx_t *psi_pms_ctx_ith;
+
+		psi_section_ctx_ith= (psi_section_ctx_t*)n->data;
+		CHECK_DO(psi_section_ctx_ith!= NULL, continue);
+
+		psi_pms_ctx_ith= (psi_pms_ctx_t*)psi_section_ctx_ith->data;
+		CHECK_DO(psi_pms_ctx_ith!= NULL, continue);
+
+		for(n2= psi_pms_ctx_ith->psi_pms_es_ctx_llist; n2!= NULL;
+				n2= n2->next) {
+			int ret_code;
+			psi_pms_es_ctx_t *psi_pms_es_ctx_jth;
+
+			psi_pms_es_ctx_jth= (psi_pms_es_ctx_t*)n2->data;
+			CHECK_DO(psi_pms_es_ctx_jth!= NULL, continue);
+
+			ret_code= ts_timing_es_register(mpeg2_sp_ctx->ts_timing_ctx,
+					psi_pms_es_ctx_jth->elementary_PID,
+					psi_pms_ctx_ith->pcr_pid,
+					psi_pms_es_ctx_jth->stream_type);
+			ASSERT(ret_code== STAT_SUCCESS);
+		}
+	}
+
+	ts_timing_es_update_end(mpeg2_sp_ctx->ts_timing_ctx);
+}
+
+/**
+ * Update the program packets routing from the given PAT and PMT: PMT, PCR
+ * and elementary streams PIDs of each program are routed to the program
+ * processor (identified by the PMT PID). A new snapshot is only published
+ * if routing changed. Program processors of the programs which PMS version
+ * (or the PAT transport stream identifier) changed are updated.
+ */
+static void update_prog_routes(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const psi_table_ctx_t *psi_table_ctx_pat,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx)
+{
+	prog_routes_t *prog_routes= NULL, *prog_routes_prev= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(mpeg2_sp_ctx!= NULL, return);
+	CHECK_DO(psi_table_ctx_pat!= NULL, return);
+	CHECK_DO(psi_table_ctx_pmt!= NULL, return);
+
+	/* Compose new routing snapshot */
+	prog_routes= prog_routes_compose(psi_table_ctx_pat, psi_table_ctx_pmt,
+			LOG_CTX_GET());
+	CHECK_DO(prog_routes!= NULL, return);
+
+	/* Only the PSI thread replaces the snapshot; no need to lock to read */
+	prog_routes_prev= mpeg2_sp_ctx->prog_routes;
+	if(prog_routes_equal(prog_routes_prev, prog_routes)) {
+		prog_routes_release(&prog_routes, &mpeg2_sp_ctx->prog_routes_mutex);
+		return;
+	}
+
+	/* Update the program processors which PMS or TSID changed */
+	prog_procs_psi_update(mpeg2_sp_ctx, prog_routes_prev, prog_routes,
+			psi_table_ctx_pmt, LOG_CTX_GET());
+
+	/* Publish new snapshot; previous one is released once the distribution
+	 * thread drops its reference (if any).
+	 */
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->prog_routes_mutex)== 0);
+	mpeg2_sp_ctx->prog_routes= prog_routes;
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->prog_routes_mutex)== 0);
+	prog_routes= NULL; // Avoid double referencing
+	prog_routes_release(&prog_routes_prev, &mpeg2_sp_ctx->prog_routes_mutex);
+}
+
+/**
+ * Get a new reference to the current program packets routing snapshot.
+ * @return The snapshot (to be released using 'prog_routes_release()'), or
+ * NULL if no snapshot was published yet.
+ */
+static prog_routes_t* prog_routes_get(mpeg2_sp_ctx_t *mpeg2_sp_ctx)
+{
+	prog_routes_t *prog_routes;
+
+	ASSERT(pthread_mutex_lock(&mpeg2_sp_ctx->prog_routes_mutex)== 0);
+	if((prog_routes= mpeg2_sp_ctx->prog_routes)!= NULL)
+		prog_routes->ref_cnt++;
+	ASSERT(pthread_mutex_unlock(&mpeg2_sp_ctx->prog_routes_mutex)== 0);
+	return prog_routes;
+}
+
+/**
+ * Hand the new PSI to the program processors:
+ * - the new PMS to the processors of the programs which PMS version changed
+ * with respect to the previous routing snapshot (the PMS is put in the
+ * processor's slot, or applied in place in passthrough mode);
+ * - the PAT transport stream identifier to every program processor if it
+ * changed (only used by the processors running in passthrough mode).
+ */
+static void prog_procs_psi_update(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		const prog_routes_t *prog_routes_prev,
+		const prog_routes_t *prog_routes,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx)
+{
+	int i, j, ret_code;
+	cJSON *cjson_procs_rest= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	if(prog_routes== NULL)
+		return;
+
+	/* Transport stream identifier (also applies to the processors opened
+	 * before the first routing snapshot)
+	 */
+	if(prog_routes->transport_stream_id>= 0 && (prog_routes_prev== NULL ||
+			prog_routes_prev->transport_stream_id!=
+					prog_routes->transport_stream_id)) {
+		for(i= 0; i< prog_routes->pmt_pid_num; i++) {
+			uint16_t pmt_pid= prog_routes->pmt_pid_array[i];
+			if(!prog_proc_is_running(mpeg2_sp_ctx, &cjson_procs_rest,
+					pmt_pid, LOG_CTX_GET()))
+				continue;
+			ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_prog,
+					"PROCS_ID_PROG_PROC_PUT_TSID", (int)pmt_pid,
+					prog_routes->transport_stream_id);
+			if(ret_code!= STAT_SUCCESS && ret_code!= STAT_ENOTFOUND)
+				LOGE("Could not update the TSID of program processor Id. "
+						"%u\n", pmt_pid);
+		}
+	}
+
+	if(prog_routes_prev== NULL)
+		goto end; // Program processors were opened with the current PMS
+
+	for(i= 0; i< prog_routes->prog_num; i++) {
+		const prog_route_t *prog_route= &prog_routes->prog_array[i];
+		void *buf_pms= NULL;
+		size_t buf_pms_size= 0;
+		psi_section_ctx_t *psi_section_ctx_pms;
+
+		if(prog_route->version_number< 0)
+			continue;
+
+		/* Check if PMS changed */
+		for(j= 0; j< prog_routes_prev->prog_num; j++) {
+			const prog_route_t *prog_route_prev=
+					&prog_routes_prev->prog_array[j];
+			if(prog_route_prev->program_number== prog_route->program_number &&
+					prog_route_prev->pmt_pid== prog_route->pmt_pid)
+				break;
+		}
+		if(j>= prog_routes_prev->prog_num ||
+				prog_routes_prev->prog_array[j].version_number< 0 ||
+				prog_routes_prev->prog_array[j].version_number==
+						prog_route->version_number)
+			continue;
+
+		/* Look for the program processor (if any) */
+		if(!prog_proc_is_running(mpeg2_sp_ctx, &cjson_procs_rest,
+				prog_route->pmt_pid, LOG_CTX_GET()))
+			continue;
+
+		/* Encode the new PMS */
+		psi_section_ctx_pms= psi_table_pmt_ctx_filter_program_num(
+				psi_table_ctx_pmt, prog_route->program_number);
+		CHECK_DO(psi_section_ctx_pms!= NULL, continue);
+		ret_code= psi_section_ctx_enc(psi_section_ctx_pms, prog_route->pmt_pid,
+				LOG_CTX_GET(), &buf_pms, &buf_pms_size);
+		CHECK_DO(ret_code== STAT_SUCCESS && buf_pms!= NULL, continue);
+
+		LOGD("Program %u (PMT PID %u) PMS version changed to %d\n",
+				prog_route->program_number, prog_route->pmt_pid,
+				prog_route->version_number);
+		ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_prog,
+				"PROCS_ID_PROG_PROC_PUT_PMS", (int)prog_route->pmt_pid,
+				(const uint8_t*)buf_pms, buf_pms_size);
+		if(ret_code!= STAT_SUCCESS)
+			LOGE("Could not update the PMS of program processor Id. %u\n",
+					prog_route->pmt_pid);
+		free(buf_pms);
+	}
+
+end:
+	if(cjson_procs_rest!= NULL)
+		cJSON_Delete(cjson_procs_rest);
+}
+
+/**
+ * Check if a program processor ("prog_proc" type) is running with the given
+ * Id. (PMT PID). The processors list is requested only once per caller
+ * (kept in '*ref_cjson_procs_rest', to be released by the caller).
+ * @return Non-zero if the program processor is running, zero otherwise.
+ */
+static int prog_proc_is_running(mpeg2_sp_ctx_t *mpeg2_sp_ctx,
+		cJSON **ref_cjson_procs_rest, uint16_t pmt_pid, log_ctx_t *log_ctx)
+{
+	int i, ret_code;
+	char *procs_rest_str= NULL;
+	cJSON *cjson_procs_array= NULL; // Do not release (alias)
+	LOG_CTX_INIT(log_ctx);
+
+	if(*ref_cjson_procs_rest== NULL) {
+		ret_code= procs_opt(mpeg2_sp_ctx->procs_ctx_prog, "PROCS_GET",
+				&procs_rest_str, NULL);
+		CHECK_DO(ret_code== STAT_SUCCESS && procs_rest_str!= NULL, return 0);
+		*ref_cjson_procs_rest= cJSON_Parse(procs_rest_str);
+		free(procs_rest_str);
+		CHECK_DO(*ref_cjson_procs_rest!= NULL, return 0);
+	}
+	cjson_procs_array= cJSON_GetObjectItem(*ref_cjson_procs_rest,
+			"program_processors");
+	CHECK_DO(cjson_procs_array!= NULL, return 0);
+
+	for(i= 0; i< cJSON_GetArraySize(cjson_procs_array); i++) {
+		cJSON *cjson_proc= cJSON_GetArrayItem(cjson_procs_array, i);
+		cJSON *cjson_aux= cJSON_GetObjectItem(cjson_proc, "proc_id");
+		if(cjson_aux== NULL || (int)cjson_aux->valuedouble!= pmt_pid)
+			continue;
+		cjson_aux= cJSON_GetObjectItem(cjson_proc, "proc_name");
+		return (cjson_aux!= NULL && cjson_aux->valuestring!= NULL &&
+				strcmp(cjson_aux->valuestring, "prog_proc")== 0);
+	}
+	return 0;
+}
+
 static int procs_post(procs_ctx_t *procs_ctx, const char *proc_name,
 		const char *proc_settings, int *ref_proc_id, log_ctx_t *log_ctx)
 {
@@ -47,6 +47,28 @@ typedef struct proc_if_s proc_if_t;
 
 /**
  * Processor interface implementing the MPEG2-SPTS/MPTS stream processor.
+ * Section taps (see 'proc_if_psi_tap_proc') can be added to any input PID
+ * using the following processor specific options; sections are then
+ * written to the named shared-memory FIFO given in the tap settings for
+ * external consumers (the taps are listed in the processor REST):
+ * @code
+ * // Add section tap (STAT_ENOMEM if no more taps can be added)
+ * procs_opt(procs_ctx, "PROCS_ID_MPEG2_SP_TAP_ADD", proc_id, (int)pid,
+ *         (const char*)"tap_name=my_tap&tap_filter_match=4e&"
+ *         "tap_filter_mask=ff", (int*)&tap_id);
+ * // Delete section tap (STAT_ENOTFOUND if tap does not exist)
+ * procs_opt(procs_ctx, "PROCS_ID_MPEG2_SP_TAP_DELETE", proc_id, tap_id);
+ * @endcode
+ * The last validated raw PAT, PMS and SDT sections of each input URL are
+ * saved in a binary file (see 'psi_store.h') in the directory given by the
+ * 'stream_procs.psi_store_dir' configuration file setting (/tmp by default;
+ * an empty path disables it). When the input URL is set, these are
+ * preloaded as provisional tables, so program processors can be attached
+ * before the input tables are received; the live tables then confirm (by
+ * CRC) or replace them.
+ * The 'stream_procs.obj_pool_stats' configuration file setting (boolean;
+ * false by default) enables the object pools statistics (see
+ * 'obj_pool.h'), listed in the processor REST.
  */
 extern const proc_if_t proc_if_mpeg2_sp;
 
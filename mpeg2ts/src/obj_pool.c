@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file obj_pool.c
+ * @author Rafael Antoniello
+ */
+
+#include "obj_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+
+/* **** Definitions **** */
+
+/**
+ * Number of objects moved at once between a thread cache and the depot.
+ */
+#define OBJ_POOL_BATCH 32
+
+/**
+ * Maximum number of free objects kept in a thread cache (per size class);
+ * the exceeding objects are spilled to the depot.
+ */
+#define OBJ_POOL_CACHE_MAX (2* OBJ_POOL_BATCH)
+
+#define OBJ_POOL_CLASS_SIZE(CLASS) (OBJ_POOL_OBJ_SIZE_MIN<< (CLASS))
+
+/**
+ * Free object: the link to the next free object is kept in the object
+ * memory itself.
+ */
+typedef struct obj_pool_obj_s {
+	struct obj_pool_obj_s *next;
+} obj_pool_obj_t;
+
+/**
+ * Global size class depot.
+ * The first object of each slab is reserved to link the slabs list (so
+ * the slabs are always reachable, e.g. for memory checkers).
+ */
+typedef struct obj_pool_depot_s {
+	pthread_mutex_t mutex;
+	obj_pool_obj_t *free_list;
+	obj_pool_obj_t *slab_list;
+	int64_t slabs;
+	/* Statistics (atomic access) */
+	int64_t objects_live;
+	int64_t objects_live_max;
+} obj_pool_depot_t;
+
+#define OBJ_POOL_DEPOT_INITIALIZER {PTHREAD_MUTEX_INITIALIZER, NULL, NULL, 0, \
+	0, 0}
+
+/**
+ * Thread-local size class cache of free objects.
+ */
+typedef struct obj_pool_cache_s {
+	obj_pool_obj_t *free_list;
+	int free_num;
+} obj_pool_cache_t;
+
+static obj_pool_depot_t obj_pool_depots[OBJ_POOL_CLASS_NUM]= {
+	OBJ_POOL_DEPOT_INITIALIZER, OBJ_POOL_DEPOT_INITIALIZER,
+	OBJ_POOL_DEPOT_INITIALIZER, OBJ_POOL_DEPOT_INITIALIZER,
+	OBJ_POOL_DEPOT_INITIALIZER, OBJ_POOL_DEPOT_INITIALIZER
+};
+
+static __thread obj_pool_cache_t obj_pool_caches[OBJ_POOL_CLASS_NUM];
+
+/**
+ * Set once the calling thread registered its caches to be flushed to the
+ * depots at thread exit (see 'obj_pool_caches_flush()').
+ */
+static __thread int obj_pool_caches_registered= 0;
+
+static pthread_key_t obj_pool_caches_key;
+static pthread_once_t obj_pool_caches_key_once= PTHREAD_ONCE_INIT;
+
+static int obj_pool_stats_flag= 0;
+
+/* **** Prototypes **** */
+
+static inline int obj_pool_class(size_t size);
+static int obj_pool_cache_refill(int class, obj_pool_cache_t *obj_pool_cache);
+static void obj_pool_cache_spill(int class, obj_pool_cache_t *obj_pool_cache,
+		int num);
+static void obj_pool_caches_register();
+static void obj_pool_caches_key_create();
+static void obj_pool_caches_flush(void *arg);
+
+/* **** Implementations **** */
+
+void* obj_pool_calloc(size_t size)
+{
+	int class;
+	obj_pool_obj_t *obj;
+	obj_pool_cache_t *obj_pool_cache;
+
+	if(size> OBJ_POOL_OBJ_SIZE_MAX)
+		return calloc(1, size);
+
+	class= obj_pool_class(size);
+	obj_pool_cache= &obj_pool_caches[class];
+
+	if(obj_pool_cache->free_list== NULL &&
+			obj_pool_cache_refill(class, obj_pool_cache)!= STAT_SUCCESS)
+		return NULL;
+
+	obj= obj_pool_cache->free_list;
+	obj_pool_cache->free_list= obj->next;
+	obj_pool_cache->free_num--;
+	memset(obj, 0, size);
+
+	if(__atomic_load_n(&obj_pool_stats_flag, __ATOMIC_RELAXED)) {
+		obj_pool_depot_t *obj_pool_depot= &obj_pool_depots[class];
+		int64_t live= __atomic_add_fetch(&obj_pool_depot->objects_live, 1,
+				__ATOMIC_RELAXED);
+		int64_t live_max= __atomic_load_n(&obj_pool_depot->objects_live_max,
+				__ATOMIC_RELAXED);
+		while(live> live_max && !__atomic_compare_exchange_n(
+				&obj_pool_depot->objects_live_max, &live_max, live, 1,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	}
+	return (void*)obj;
+}
+
+void obj_pool_free(void *p, size_t size)
+{
+	int class;
+	obj_pool_obj_t *obj= (obj_pool_obj_t*)p;
+	obj_pool_cache_t *obj_pool_cache;
+
+	if(p== NULL)
+		return;
+
+	if(size> OBJ_POOL_OBJ_SIZE_MAX) {
+		free(p);
+		return;
+	}
+
+	class= obj_pool_class(size);
+	obj_pool_cache= &obj_pool_caches[class];
+
+	if(!obj_pool_caches_registered)
+		obj_pool_caches_register();
+
+	obj->next= obj_pool_cache->free_list;
+	obj_pool_cache->free_list= obj;
+	if(++obj_pool_cache->free_num> OBJ_POOL_CACHE_MAX)
+		obj_pool_cache_spill(class, obj_pool_cache, OBJ_POOL_BATCH);
+
+	if(__atomic_load_n(&obj_pool_stats_flag, __ATOMIC_RELAXED))
+		__atomic_sub_fetch(&obj_pool_depots[class].objects_live, 1,
+				__ATOMIC_RELAXED);
+}
+
+void obj_pool_stats_enable(int enable)
+{
+	__atomic_store_n(&obj_pool_stats_flag, enable!= 0, __ATOMIC_RELAXED);
+}
+
+int obj_pool_stats_enabled()
+{
+	return __atomic_load_n(&obj_pool_stats_flag, __ATOMIC_RELAXED);
+}
+
+void obj_pool_stats_get(obj_pool_stats_t obj_pool_stats[OBJ_POOL_CLASS_NUM])
+{
+	int class;
+
+	CHECK_DO(obj_pool_stats!= NULL, return);
+
+	for(class= 0; class< OBJ_POOL_CLASS_NUM; class++) {
+		obj_pool_depot_t *obj_pool_depot= &obj_pool_depots[class];
+		int64_t live= __atomic_load_n(&obj_pool_depot->objects_live,
+				__ATOMIC_RELAXED);
+
+		obj_pool_stats[class].object_size= OBJ_POOL_CLASS_SIZE(class);
+		// Objects allocated before enabling the statistics may be released
+		obj_pool_stats[class].objects_live= live> 0? live: 0;
+		obj_pool_stats[class].objects_live_max= __atomic_load_n(
+				&obj_pool_depot->objects_live_max, __ATOMIC_RELAXED);
+		obj_pool_stats[class].slabs= __atomic_load_n(&obj_pool_depot->slabs,
+				__ATOMIC_RELAXED);
+	}
+}
+
+static inline int obj_pool_class(size_t size)
+{
+	int class= 0;
+
+	while(OBJ_POOL_CLASS_SIZE(class)< size)
+		class++;
+	return class;
+}
+
+/**
+ * Move a batch of free objects from the depot to the (empty) thread cache;
+ * a new slab is carved if the depot is empty.
+ */
+static int obj_pool_cache_refill(int class, obj_pool_cache_t *obj_pool_cache)
+{
+	int i;
+	obj_pool_depot_t *obj_pool_depot= &obj_pool_depots[class];
+	const size_t obj_size= OBJ_POOL_CLASS_SIZE(class);
+	int end_code= STAT_ERROR;
+
+	if(!obj_pool_caches_registered)
+		obj_pool_caches_register();
+
+	pthread_mutex_lock(&obj_pool_depot->mutex);
+
+	if(obj_pool_depot->free_list== NULL) {
+		uint8_t *slab, *p;
+
+		slab= (uint8_t*)malloc(OBJ_POOL_SLAB_SIZE);
+		CHECK_DO(slab!= NULL, goto end);
+		((obj_pool_obj_t*)slab)->next= obj_pool_depot->slab_list;
+		obj_pool_depot->slab_list= (obj_pool_obj_t*)slab;
+		__atomic_add_fetch(&obj_pool_depot->slabs, 1, __ATOMIC_RELAXED);
+
+		for(p= slab+ OBJ_POOL_SLAB_SIZE- obj_size; p> slab; p-= obj_size) {
+			((obj_pool_obj_t*)p)->next= obj_pool_depot->free_list;
+			obj_pool_depot->free_list= (obj_pool_obj_t*)p;
+		}
+	}
+
+	for(i= 0; i< OBJ_POOL_BATCH && obj_pool_depot->free_list!= NULL; i++) {
+		obj_pool_obj_t *obj= obj_pool_depot->free_list;
+
+		obj_pool_depot->free_list= obj->next;
+		obj->next= obj_pool_cache->free_list;
+		obj_pool_cache->free_list= obj;
+		obj_pool_cache->free_num++;
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	pthread_mutex_unlock(&obj_pool_depot->mutex);
+	return end_code;
+}
+
+/**
+ * Move 'num' free objects (or all of them if 'num' is negative) from the
+ * thread cache to the depot.
+ */
+static void obj_pool_cache_spill(int class, obj_pool_cache_t *obj_pool_cache,
+		int num)
+{
+	obj_pool_obj_t *head, *tail;
+	obj_pool_depot_t *obj_pool_depot= &obj_pool_depots[class];
+
+	if((head= obj_pool_cache->free_list)== NULL)
+		return;
+	if(num< 0 || num> obj_pool_cache->free_num)
+		num= obj_pool_cache->free_num;
+
+	/* Detach the batch from the cache out of the critical section */
+	for(tail= head; --num> 0 && tail->next!= NULL; tail= tail->next)
+		obj_pool_cache->free_num--;
+	obj_pool_cache->free_num--;
+	obj_pool_cache->free_list= tail->next;
+
+	pthread_mutex_lock(&obj_pool_depot->mutex);
+	tail->next= obj_pool_depot->free_list;
+	obj_pool_depot->free_list= head;
+	pthread_mutex_unlock(&obj_pool_depot->mutex);
+}
+
+static void obj_pool_caches_register()
+{
+	pthread_once(&obj_pool_caches_key_once, obj_pool_caches_key_create);
+	// The key value is only used to get the destructor called
+	pthread_setspecific(obj_pool_caches_key, (void*)obj_pool_caches);
+	obj_pool_caches_registered= 1;
+}
+
+static void obj_pool_caches_key_create()
+{
+	CHECK_DO(pthread_key_create(&obj_pool_caches_key,
+			obj_pool_caches_flush)== 0, return);
+}
+
+/**
+ * Thread exit: return the free objects of the thread caches to the
+ * depots, so they can be reused by other threads.
+ */
+static void obj_pool_caches_flush(void *arg)
+{
+	int class;
+
+	for(class= 0; class< OBJ_POOL_CLASS_NUM; class++)
+		obj_pool_cache_spill(class, &obj_pool_caches[class], -1);
+	obj_pool_caches_registered= 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file obj_pool.h
+ * @brief Size-class object pools for the small, short lived context
+ * structures allocated on the processing paths (TS packets, PSI sections,
+ * descriptors...).
+ * Objects are carved from fixed size slabs; each size class (power of two
+ * from OBJ_POOL_OBJ_SIZE_MIN to OBJ_POOL_OBJ_SIZE_MAX bytes) keeps a
+ * thread-local cache of free objects, refilled from (and spilled to) a
+ * global per-class depot in batches, so most allocations and releases do
+ * not lock. Slabs are never returned to the system: the pools memory is
+ * bounded by the high-water mark of live objects, and does not fragment
+ * the heap. Larger objects are just allocated using 'calloc()'.
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_OBJ_POOL_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_OBJ_POOL_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/**
+ * Smallest object size class [bytes].
+ */
+#define OBJ_POOL_OBJ_SIZE_MIN 16
+
+/**
+ * Largest object size class [bytes].
+ */
+#define OBJ_POOL_OBJ_SIZE_MAX 512
+
+/**
+ * Number of object size classes (OBJ_POOL_OBJ_SIZE_MIN...
+ * OBJ_POOL_OBJ_SIZE_MAX).
+ */
+#define OBJ_POOL_CLASS_NUM 6
+
+/**
+ * Slab size [bytes].
+ */
+#define OBJ_POOL_SLAB_SIZE (64* 1024)
+
+/**
+ * Object pool (size class) statistics.
+ */
+typedef struct obj_pool_stats_s {
+	/**
+	 * Size class object size [bytes].
+	 */
+	size_t object_size;
+	/**
+	 * Number of objects currently allocated.
+	 */
+	int64_t objects_live;
+	/**
+	 * High-water mark of allocated objects.
+	 */
+	int64_t objects_live_max;
+	/**
+	 * Number of slabs allocated (OBJ_POOL_SLAB_SIZE bytes each).
+	 */
+	int64_t slabs;
+} obj_pool_stats_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Allocate a zero-initialized object from the pool of its size class
+ * ('calloc()' is used for sizes greater than OBJ_POOL_OBJ_SIZE_MAX).
+ * @param size Object size in bytes.
+ * @return Pointer to the object (aligned to OBJ_POOL_OBJ_SIZE_MIN bytes),
+ * NULL if fails.
+ */
+void* obj_pool_calloc(size_t size);
+
+/**
+ * Release an object allocated using 'obj_pool_calloc()'. Objects may be
+ * released from any thread.
+ * @param p Pointer to the object (NULL is allowed).
+ * @param size Object size in bytes, as given to 'obj_pool_calloc()'.
+ */
+void obj_pool_free(void *p, size_t size);
+
+/**
+ * Enable or disable the live objects statistics (disabled by default, as
+ * counting shares a cache line among all the threads). Objects are
+ * counted from the moment the statistics are enabled.
+ * @param enable Non-zero value to enable.
+ */
+void obj_pool_stats_enable(int enable);
+
+/**
+ * Check if the live objects statistics are enabled.
+ * @return Non-zero value if enabled.
+ */
+int obj_pool_stats_enabled();
+
+/**
+ * Get the statistics of all the size classes.
+ * @param obj_pool_stats Array of OBJ_POOL_CLASS_NUM elements to be filled
+ * (ordered by object size).
+ */
+void obj_pool_stats_get(obj_pool_stats_t obj_pool_stats[OBJ_POOL_CLASS_NUM]);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_OBJ_POOL_H_ */
@@ -37,16 +37,31 @@
 #include <errno.h>
 
 #include <libcjson/cJSON.h>
+#include <libmbedtls_base64/base64.h>
 #define ENABLE_DEBUG_LOGS //uncomment to trace logs
 #include <libmediaprocsutils/log.h>
 #include <libmediaprocsutils/stat_codes.h>
 #include <libmediaprocsutils/check_utils.h>
+#include <libmediaprocsutils/uri_parser.h>
+#include <libmediaprocsutils/llist.h>
 #include <libmediaprocsutils/fifo.h>
 #include <libmediaprocs/proc_if.h>
 #include <libmediaprocs/proc.h>
+#include "ts.h"
+#include "psi.h"
+#include "psi_dec.h"
+#include "ts_remap.h"
 
 /* **** Definitions **** */
 
+#define STR_JSON_REST 	0
+#define STR_URL_QUERY 	1
+
+/**
+ * Returns non-zero if 'tag' string is equal to given TAG string.
+ */
+#define TAG_IS(TAG) (strcmp(tag, TAG)== 0)
+
 /**
  * Program processor context structure.
  */
@@ -62,7 +77,7 @@ typedef struct prog_proc_ctx_s {
 	pid_t child_pid;
 
 	/* **** ------------Inter-process communication (IPC) -------------- ****
-	 * We will use 4 FIFO's and 1 independent flag:
+	 * We will use 4 FIFO's, 1 independent flag and 1 PSI slot:
 	 * 1) proc_ctx_s::fifo_ctx_array[PROC_IPUT]
 	 * 2) proc_ctx_s::fifo_ctx_array[PROC_OPUT]
 	 * 3) prog_proc_ctx_s::fifo_ctx_api_array[PROC_IPUT]
@@ -70,6 +85,7 @@ typedef struct prog_proc_ctx_s {
 	 * 4) prog_proc_ctx_s::fifo_ctx_api_array[PROC_OPUT]
 	 * -defined immediately below-
 	 * 5) prog_proc_ctx_s::ref_flag_exit_shared
+	 * 6) prog_proc_ctx_s::psi_slot_shared
 	 */
 	/**
 	 * Input/output API buffers.
@@ -83,6 +99,47 @@ typedef struct prog_proc_ctx_s {
 	 * A pointer to this flag will be shared with the forked child task.
 	 */
 	volatile int *ref_flag_exit_shared;
+	/**
+	 * Program Map Section slot, defined in shared memory.
+	 * The raw (binary) section is written here and picked-up by the forked
+	 * child task by comparing the slot sequence number; no encoding nor API
+	 * FIFO round-trip is involved.
+	 */
+	prog_proc_shm_psi_slot_t *psi_slot_shared;
+
+	/* **** --------------------- Passthrough mode --------------------- ****
+	 * When every elementary stream of the program is bypassed and no
+	 * program-level processing is requested (bit-rate control, PCR guard,
+	 * STC output delay), packets are just re-mapped in the calling thread
+	 * and written to the (in-process) output FIFO as frames (to be received
+	 * using 'procs_recv_frame()'): no task is forked and no shared memory is
+	 * used.
+	 * Note that options are serialized by the PROCS module, thus the fields
+	 * below are only modified by one thread at a time.
+	 */
+	/**
+	 * Non-zero if processor is running in passthrough mode.
+	 */
+	int flag_passthrough;
+	/**
+	 * PID re-mapping module instance (passthrough mode only); re-writes the
+	 * PAT to only list this program and fixes-up continuity counters.
+	 */
+	ts_remap_ctx_t *ts_remap_ctx;
+	/**
+	 * PMT PID (processor Id.) of the program (passthrough mode only).
+	 */
+	uint16_t pmt_pid;
+	/**
+	 * Program Map Section currently applied (passthrough mode only); the PID
+	 * map is composed from it.
+	 */
+	psi_section_ctx_t *psi_section_ctx_pms;
+	/**
+	 * Transport stream identifier of the input PAT, used in the re-written
+	 * PAT (passthrough mode only).
+	 */
+	uint16_t transport_stream_id;
 
 } prog_proc_ctx_t;
 
@@ -96,6 +153,7 @@ static void prog_proc_close(proc_ctx_t **ref_proc_ctx);
 		fifo_ctx_t *iput_fifo_ctx, fifo_ctx_t *oput_fifo_ctx);
 */ //TODO
 static int prog_proc_unblock(proc_ctx_t *proc_ctx);
+static int prog_proc_opt(proc_ctx_t *proc_ctx, const char *tag, va_list arg);
 /*
 static int prog_proc_rest_put(proc_ctx_t *proc_ctx, const char *str);
 static int prog_proc_rest_get(proc_ctx_t *proc_ctx,
@@ -111,8 +169,23 @@ static int prog_proc_rest_get(proc_ctx_t *proc_ctx,
 static int prog_proc_open_tsk(prog_proc_ctx_t *prog_proc_ctx,
 		const char *settings_str, const char* href_arg);
 
+static uint8_t* prog_proc_settings_pms(const char *settings_str,
+		size_t *ref_size, log_ctx_t *log_ctx);
+static psi_section_ctx_t* prog_proc_passthrough_pms(const char *settings_str,
+		const char* href_arg, uint8_t *buf_pms, size_t buf_pms_size,
+		uint16_t *ref_pmt_pid, int *ref_transport_stream_id,
+		log_ctx_t *log_ctx);
+static int prog_proc_passthrough_open(prog_proc_ctx_t *prog_proc_ctx,
+		uint16_t pmt_pid, psi_section_ctx_t *psi_section_ctx_pms,
+		uint16_t transport_stream_id, log_ctx_t *log_ctx);
+static int prog_proc_passthrough_set(prog_proc_ctx_t *prog_proc_ctx,
+		psi_section_ctx_t *psi_section_ctx_pms, uint16_t transport_stream_id,
+		log_ctx_t *log_ctx);
+
 static int send_frame(proc_ctx_t *proc_ctx,
         const proc_frame_ctx_t *proc_frame_ctx);
+static int send_frame_passthrough(proc_ctx_t *proc_ctx,
+		const proc_frame_ctx_t *proc_frame_ctx);
 
 /* **** Implementations **** */
 
@@ -133,7 +206,7 @@ const proc_if_t proc_if_mpeg2_prog_proc= //FIXME!!
 	NULL, //prog_proc_rest_put, //TODO
 	NULL, //prog_proc_rest_get, //TODO
 	NULL, // no processing thread, we will use a fork()! 'prog_proc_open()'.
-	NULL, // no extra options
+	prog_proc_opt,
 	(void*(*)(const proc_frame_ctx_t*))proc_frame_ctx_dup,
 	(void(*)(void**))proc_frame_ctx_release,
 	(proc_frame_ctx_t*(*)(const void*))proc_frame_ctx_dup
@@ -150,6 +223,11 @@ static proc_ctx_t* prog_proc_open(const proc_if_t *proc_if,
 	int ret_code, end_code= STAT_ERROR, shm_fd= -1;
 	prog_proc_ctx_t *prog_proc_ctx= NULL;
 	proc_ctx_t *proc_ctx= NULL; // Do not release (alias)
+	psi_section_ctx_t *psi_section_ctx_pms= NULL;
+	uint8_t *buf_pms= NULL;
+	size_t buf_pms_size= 0;
+	uint16_t pmt_pid= 0;
+	int transport_stream_id= 0;
 	const size_t fifo_ctx_maxsize[PROC_IO_NUM]= {PROG_PROC_SHM_FIFO_SIZE_IPUT,
 			PROG_PROC_SHM_FIFO_SIZE_OPUT};
 	const size_t fifo_io_chunk_size= PROG_PROC_SHM_SIZE_IO_CHUNK; // [bytes]
@@ -170,6 +248,26 @@ static proc_ctx_t* prog_proc_open(const proc_if_t *proc_if,
 	CHECK_DO(prog_proc_ctx!= NULL, goto end);
 	proc_ctx= (proc_ctx_t*)prog_proc_ctx;
 
+	/* Decode the given Program Map Section (if any) into binary buffer;
+	 * this is done only once here, the forked task is handed the raw section
+	 * in shared memory.
+	 */
+	buf_pms= prog_proc_settings_pms(settings_str, &buf_pms_size,
+			LOG_CTX_GET());
+
+	/* Passthrough programs are processed in place (no fork, no IPC) */
+	psi_section_ctx_pms= prog_proc_passthrough_pms(settings_str, href_arg,
+			buf_pms, buf_pms_size, &pmt_pid, &transport_stream_id,
+			LOG_CTX_GET());
+	if(psi_section_ctx_pms!= NULL) {
+		ret_code= prog_proc_passthrough_open(prog_proc_ctx, pmt_pid,
+				psi_section_ctx_pms, (uint16_t)transport_stream_id,
+				LOG_CTX_GET());
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+		end_code= STAT_SUCCESS;
+		goto end;
+	}
+
 	/* Compose FIFO name prefix using 'href' */
 	if(href_arg!= NULL && (href_arg_len= strlen(href_arg))> 0) {
 		char *p= href;
@@ -227,6 +325,18 @@ static proc_ctx_t* prog_proc_open(const proc_if_t *proc_if,
 	ASSERT(close(shm_fd)== 0);
 	shm_fd= -1;
 
+	/* Allocate Program Map Section slot and write initial section (if any) */
+	snprintf(&href[href_arg_len], sizeof(href)- href_arg_len, SUF_SH_PSI);
+	LOGD("href_arg-modified: '%s'\n", href); //comment-me
+	prog_proc_ctx->psi_slot_shared= prog_proc_shm_psi_slot_open(href, 1,
+			LOG_CTX_GET());
+	CHECK_DO(prog_proc_ctx->psi_slot_shared!= NULL, goto end);
+	if(buf_pms!= NULL) {
+		ret_code= prog_proc_shm_psi_slot_write(prog_proc_ctx->psi_slot_shared,
+				buf_pms, buf_pms_size, LOG_CTX_GET());
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	}
+
 	/* Fork */
 	ret_code= prog_proc_open_tsk(prog_proc_ctx, settings_str, href_arg);
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
@@ -237,6 +347,10 @@ end:
 	if(shm_fd>= 0) {
 		ASSERT(close(shm_fd)== 0);
 	}
+	if(psi_section_ctx_pms!= NULL)
+		psi_section_ctx_release(&psi_section_ctx_pms);
+	if(buf_pms!= NULL)
+		free(buf_pms);
 	if(end_code!= STAT_SUCCESS)
 		prog_proc_close((proc_ctx_t**)&prog_proc_ctx);
 	return (proc_ctx_t*)prog_proc_ctx;
@@ -281,6 +395,13 @@ static void prog_proc_close(proc_ctx_t **ref_proc_ctx)
 		prog_proc_ctx->ref_flag_exit_shared= NULL;
 	}
 
+	/* Release Program Map Section slot */
+	prog_proc_shm_psi_slot_close(&prog_proc_ctx->psi_slot_shared);
+
+	/* Release passthrough PID re-mapping module instance and PMS */
+	ts_remap_close(&prog_proc_ctx->ts_remap_ctx);
+	psi_section_ctx_release(&prog_proc_ctx->psi_section_ctx_pms);
+
 	// Reserved for future use: release other new variables here...
 
 	/* Release context structure */
@@ -306,6 +427,12 @@ static int prog_proc_unblock(proc_ctx_t *proc_ctx)
 
 	LOGD(">>%s\n", __FUNCTION__);
 
+	/* In passthrough mode there is no task to join */
+	if(prog_proc_ctx->flag_passthrough!= 0) {
+		LOGD("<<%s (passthrough)\n", __FUNCTION__);
+		return STAT_SUCCESS;
+	}
+
 	if(*prog_proc_ctx->ref_flag_exit_shared!= 0) {
 		LOGD("<<%s (was already unlocked)\n", __FUNCTION__);
 		return STAT_SUCCESS;
@@ -356,6 +483,91 @@ static int prog_proc_unblock(proc_ctx_t *proc_ctx)
 	return STAT_SUCCESS;
 }
 
+/**
+ * Implements the proc_if_s::opt callback.
+ * See .proc_if.h for further details.
+ */
+static int prog_proc_opt(proc_ctx_t *proc_ctx, const char *tag, va_list arg)
+{
+	int end_code= STAT_ERROR;
+	prog_proc_ctx_t *prog_proc_ctx= (prog_proc_ctx_t*)proc_ctx;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(tag!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(proc_ctx->log_ctx);
+
+	if(TAG_IS("PROCS_ID_PROG_PROC_PUT_PMS")) {
+		const uint8_t *buf= va_arg(arg, const uint8_t*);
+		size_t size= va_arg(arg, size_t);
+		psi_section_ctx_t *psi_section_ctx_pms= NULL;
+
+		CHECK_DO(buf!= NULL && size> 0, goto end);
+
+		/* Passthrough programs are not forked; the PID map and the
+		 * re-written PSI are updated in place.
+		 */
+		if(prog_proc_ctx->flag_passthrough!= 0) {
+			int ret_code= psi_dec_section((uint8_t*)buf, size,
+					prog_proc_ctx->pmt_pid, LOG_CTX_GET(),
+					&psi_section_ctx_pms);
+			CHECK_DO(ret_code== STAT_SUCCESS && psi_section_ctx_pms!= NULL &&
+					psi_section_ctx_pms->table_id==
+							PSI_TABLE_TS_PROGRAM_MAP_SECTION,
+					psi_section_ctx_release(&psi_section_ctx_pms); goto end);
+			end_code= prog_proc_passthrough_set(prog_proc_ctx,
+					psi_section_ctx_pms, prog_proc_ctx->transport_stream_id,
+					LOG_CTX_GET());
+			psi_section_ctx_release(&psi_section_ctx_pms);
+			goto end;
+		}
+		CHECK_DO(prog_proc_ctx->psi_slot_shared!= NULL, goto end);
+		end_code= prog_proc_shm_psi_slot_write(prog_proc_ctx->psi_slot_shared,
+				buf, size, LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PROG_PROC_GET_PMS_ACKED")) {
+		int *ref_flag_acked= va_arg(arg, int*);
+
+		CHECK_DO(ref_flag_acked!= NULL, goto end);
+
+		/* In passthrough mode the PMS is applied when put */
+		if(prog_proc_ctx->flag_passthrough!= 0) {
+			*ref_flag_acked= 1;
+			end_code= STAT_SUCCESS;
+			goto end;
+		}
+		CHECK_DO(prog_proc_ctx->psi_slot_shared!= NULL, goto end);
+		*ref_flag_acked= prog_proc_shm_psi_slot_is_acked(
+				prog_proc_ctx->psi_slot_shared);
+		end_code= STAT_SUCCESS;
+	} else if(TAG_IS("PROCS_ID_PROG_PROC_PUT_TSID")) {
+		int transport_stream_id= va_arg(arg, int);
+
+		CHECK_DO(transport_stream_id>= 0 && transport_stream_id<= 0xFFFF,
+				goto end);
+
+		/* Only the passthrough mode re-writes the PAT */
+		if(prog_proc_ctx->flag_passthrough== 0) {
+			end_code= STAT_ENOTFOUND;
+			goto end;
+		}
+		if(prog_proc_ctx->transport_stream_id== transport_stream_id) {
+			end_code= STAT_SUCCESS;
+			goto end;
+		}
+		end_code= prog_proc_passthrough_set(prog_proc_ctx,
+				prog_proc_ctx->psi_section_ctx_pms,
+				(uint16_t)transport_stream_id, LOG_CTX_GET());
+	} else {
+		LOGE("Unknown option\n");
+		end_code= STAT_ENOTFOUND;
+	}
+
+end:
+	return end_code;
+}
+
 static int prog_proc_open_tsk(prog_proc_ctx_t *prog_proc_ctx,
 		const char *settings_str, const char* href_arg)
 {
@@ -452,6 +664,356 @@ static int send_frame(proc_ctx_t *proc_ctx,
 	 * implicitly included in the transport packet and should be parsed
 	 * internally by the program-processor.
 	 */
+	if(((prog_proc_ctx_t*)proc_ctx)->flag_passthrough!= 0)
+		return send_frame_passthrough(proc_ctx, proc_frame_ctx);
 	return fifo_put_dup(proc_ctx->fifo_ctx_array[PROC_IPUT],
 			proc_frame_ctx->data, proc_frame_ctx->linesize[0]);
 }
+
+/**
+ * Passthrough mode 'send_frame' implementation: the packet is re-mapped
+ * in the calling thread and the resulting packets (if any) are directly
+ * written to the output FIFO. Each output packet is wrapped in a frame
+ * context structure (initialized as the input frame, see 'send_frame()'),
+ * which is the type of the output FIFO elements; frames are received using
+ * 'procs_recv_frame()'.
+ */
+static int send_frame_passthrough(proc_ctx_t *proc_ctx,
+		const proc_frame_ctx_t *proc_frame_ctx)
+{
+	size_t oput_size= 0;
+	int ret_code;
+	const uint8_t *oput= NULL;
+	uint8_t pkt[TS_PKT_SIZE];
+	proc_frame_ctx_t proc_frame_ctx_oput= {0};
+	prog_proc_ctx_t *prog_proc_ctx= (prog_proc_ctx_t*)proc_ctx;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(proc_frame_ctx!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(proc_ctx->log_ctx);
+
+	CHECK_DO(proc_frame_ctx->data!= NULL &&
+			proc_frame_ctx->linesize[0]== TS_PKT_SIZE, return STAT_ERROR);
+
+	/* Input packet is shared with other processors; work on a copy */
+	memcpy(pkt, proc_frame_ctx->data, TS_PKT_SIZE);
+
+	ret_code= ts_remap_packet(prog_proc_ctx->ts_remap_ctx, pkt, &oput,
+			&oput_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, return ret_code);
+
+	proc_frame_ctx_oput.linesize[0]= TS_PKT_SIZE;
+	proc_frame_ctx_oput.width[0]= TS_PKT_SIZE;
+	proc_frame_ctx_oput.height[0]= 1;
+	proc_frame_ctx_oput.proc_sample_fmt= PROC_IF_FMT_UNDEF;
+	proc_frame_ctx_oput.pts= -1;
+	proc_frame_ctx_oput.dts= -1;
+	for(; oput_size>= TS_PKT_SIZE; oput+= TS_PKT_SIZE,
+			oput_size-= TS_PKT_SIZE) {
+		proc_frame_ctx_oput.data= (uint8_t*)oput;
+		proc_frame_ctx_oput.p_data[0]= oput;
+		proc_frame_ctx_oput.es_id= TS_BUF_GET_PID(oput);
+		ret_code= fifo_put_dup(proc_ctx->fifo_ctx_array[PROC_OPUT],
+				&proc_frame_ctx_oput, sizeof(void*));
+		CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_ENOMEM,
+				return ret_code);
+	}
+	return STAT_SUCCESS;
+}
+
+/**
+ * Get the Program Map Section given in the settings ("pmt_octet_stream",
+ * base64 encoded) decoded into a binary buffer.
+ * @param settings_str Settings string (JSON-REST or query-string format).
+ * @param ref_size Reference to the size of the returned buffer.
+ * @param log_ctx LOG module context structure.
+ * @return The raw Program Map Section (allocated; should be released by the
+ * calling function), or NULL if no (valid) PMS was given.
+ */
+static uint8_t* prog_proc_settings_pms(const char *settings_str,
+		size_t *ref_size, log_ctx_t *log_ctx)
+{
+	int ret_code, end_code= STAT_ERROR;
+	size_t olen= 0;
+	cJSON *cjson_rest= NULL, *cjson_aux= NULL;
+	char *pms_str= NULL;
+	uint8_t *buf_pms= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(settings_str!= NULL, return NULL);
+	CHECK_DO(ref_size!= NULL, return NULL);
+
+	*ref_size= 0;
+
+	/* Guess string representation format (JSON-REST or Query) */
+	if(strlen(settings_str)> 0 && settings_str[0]=='{' &&
+			settings_str[strlen(settings_str)-1]=='}') {
+		cjson_rest= cJSON_Parse(settings_str);
+		CHECK_DO(cjson_rest!= NULL, goto end);
+		cjson_aux= cJSON_GetObjectItem(cjson_rest, "pmt_octet_stream");
+		if(cjson_aux!= NULL && cjson_aux->valuestring!= NULL)
+			pms_str= strdup(cjson_aux->valuestring);
+	} else {
+		pms_str= uri_parser_query_str_get_value("pmt_octet_stream",
+				settings_str);
+	}
+	if(pms_str== NULL || strlen(pms_str)== 0)
+		goto end;
+
+	/* Decode PMT into binary buffer */
+	ret_code= mbedtls_base64_decode(NULL, 0, &olen,
+			(const unsigned char*)pms_str, strlen(pms_str));
+	CHECK_DO(ret_code== MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL && olen> 0,
+			goto end);
+	CHECK_DO(olen<= PROG_PROC_SHM_PSI_SLOT_SIZE, goto end);
+	buf_pms= (uint8_t*)malloc(olen);
+	CHECK_DO(buf_pms!= NULL, goto end);
+	ret_code= mbedtls_base64_decode(buf_pms, olen, &olen,
+			(const unsigned char*)pms_str, strlen(pms_str));
+	CHECK_DO(ret_code== 0, goto end);
+
+	*ref_size= olen;
+	end_code= STAT_SUCCESS;
+end:
+	if(cjson_rest!= NULL)
+		cJSON_Delete(cjson_rest);
+	if(pms_str!= NULL)
+		free(pms_str);
+	if(end_code!= STAT_SUCCESS && buf_pms!= NULL) {
+		free(buf_pms);
+		buf_pms= NULL;
+	}
+	return buf_pms;
+}
+
+/**
+ * Check if the given settings describe a passthrough program, that is, a
+ * program with no program-level processing requested (elementary streams
+ * are always initialized to "bypass" processors by the program task).
+ * If it is the case, the given Program Map Section (as decoded from the
+ * settings by 'prog_proc_settings_pms()') is parsed and returned.
+ * @param buf_pms Raw Program Map Section; NULL if none was given.
+ * @param buf_pms_size Raw Program Map Section size.
+ * @param ref_pmt_pid Reference to the PMT PID (processor Id.) to be
+ * returned.
+ * @param ref_transport_stream_id Reference to the transport stream
+ * identifier of the input PAT ("transport_stream_id" setting; zero if not
+ * given) to be returned.
+ * @return The Program Map Section if program is passthrough, NULL otherwise.
+ */
+static psi_section_ctx_t* prog_proc_passthrough_pms(const char *settings_str,
+		const char* href_arg, uint8_t *buf_pms, size_t buf_pms_size,
+		uint16_t *ref_pmt_pid, int *ref_transport_stream_id,
+		log_ctx_t *log_ctx)
+{
+	const char *p;
+	char *end_p;
+	int flag_repres_type, ret_code, pmt_pid, flag_passthrough= 1;
+	cJSON *cjson_rest= NULL, *cjson_aux= NULL;
+	char *brctrl_str= NULL, *ts_pcr_guard_str= NULL,
+			*stc_delay_output_str= NULL, *tsid_str= NULL;
+	psi_section_ctx_t *psi_section_ctx_pms= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(settings_str!= NULL, return NULL);
+	CHECK_DO(ref_pmt_pid!= NULL, return NULL);
+	CHECK_DO(ref_transport_stream_id!= NULL, return NULL);
+	if(buf_pms== NULL || buf_pms_size== 0)
+		return NULL; // No PMS given
+	if(href_arg== NULL)
+		return NULL; // Processor Id. (PMT PID) can not be known
+
+	/* Get processor identifier (PMT PID) from href */
+	p= strrchr(href_arg, '/');
+	if(p== NULL)
+		return NULL;
+	pmt_pid= strtol(++p, &end_p, 10);
+	if(end_p<= p || pmt_pid< 0 || pmt_pid> TS_MAX_PID_VAL)
+		return NULL;
+
+	/* Guess string representation format (JSON-REST or Query) */
+	flag_repres_type= (strlen(settings_str)> 0 && settings_str[0]=='{' &&
+			settings_str[strlen(settings_str)-1]=='}')?
+					STR_JSON_REST: STR_URL_QUERY;
+
+	if(flag_repres_type== STR_URL_QUERY) {
+		brctrl_str= uri_parser_query_str_get_value(
+				"selected_brctrl_type_value", settings_str);
+		if(brctrl_str!= NULL && atoi(brctrl_str)!= 0)
+			flag_passthrough= 0;
+		ts_pcr_guard_str= uri_parser_query_str_get_value(
+				"max_ts_pcr_guard_msec", settings_str);
+		if(ts_pcr_guard_str!= NULL && atoll(ts_pcr_guard_str)> 0)
+			flag_passthrough= 0;
+		stc_delay_output_str= uri_parser_query_str_get_value(
+				"min_stc_delay_output_msec", settings_str);
+		if(stc_delay_output_str!= NULL && atoll(stc_delay_output_str)> 0)
+			flag_passthrough= 0;
+		tsid_str= uri_parser_query_str_get_value("transport_stream_id",
+				settings_str);
+		if(tsid_str!= NULL)
+			*ref_transport_stream_id= atoi(tsid_str);
+	} else {
+		cjson_rest= cJSON_Parse(settings_str);
+		CHECK_DO(cjson_rest!= NULL, goto end);
+		cjson_aux= cJSON_GetObjectItem(cjson_rest,
+				"selected_brctrl_type_value");
+		if(cjson_aux!= NULL && cjson_aux->valueint!= 0)
+			flag_passthrough= 0;
+		cjson_aux= cJSON_GetObjectItem(cjson_rest, "max_ts_pcr_guard_msec");
+		if(cjson_aux!= NULL && cjson_aux->valuedouble> 0)
+			flag_passthrough= 0;
+		cjson_aux= cJSON_GetObjectItem(cjson_rest,
+				"min_stc_delay_output_msec");
+		if(cjson_aux!= NULL && cjson_aux->valuedouble> 0)
+			flag_passthrough= 0;
+		cjson_aux= cJSON_GetObjectItem(cjson_rest, "transport_stream_id");
+		if(cjson_aux!= NULL)
+			*ref_transport_stream_id= cjson_aux->valueint;
+	}
+	if(flag_passthrough== 0)
+		goto end;
+	CHECK_DO(*ref_transport_stream_id>= 0 && *ref_transport_stream_id<= 0xFFFF,
+			goto end);
+
+	/* Parse binary PMT into specific context structure */
+	ret_code= psi_dec_section(buf_pms, buf_pms_size, (uint16_t)pmt_pid,
+			LOG_CTX_GET(), &psi_section_ctx_pms);
+	if(ret_code!= STAT_SUCCESS || (psi_section_ctx_pms!= NULL &&
+			psi_section_ctx_pms->table_id!=
+					PSI_TABLE_TS_PROGRAM_MAP_SECTION))
+		psi_section_ctx_release(&psi_section_ctx_pms);
+	*ref_pmt_pid= (uint16_t)pmt_pid;
+
+end:
+	if(cjson_rest!= NULL)
+		cJSON_Delete(cjson_rest);
+	if(brctrl_str!= NULL)
+		free(brctrl_str);
+	if(ts_pcr_guard_str!= NULL)
+		free(ts_pcr_guard_str);
+	if(stc_delay_output_str!= NULL)
+		free(stc_delay_output_str);
+	if(tsid_str!= NULL)
+		free(tsid_str);
+	return psi_section_ctx_pms;
+}
+
+/**
+ * Initialize passthrough mode: program PIDs (PMT, PCR and elementary
+ * streams) are mapped to themselves and PSI is re-written so that the
+ * output PAT only lists this program. PCRs are forwarded untouched (no
+ * delay is introduced on this path).
+ */
+static int prog_proc_passthrough_open(prog_proc_ctx_t *prog_proc_ctx,
+		uint16_t pmt_pid, psi_section_ctx_t *psi_section_ctx_pms,
+		uint16_t transport_stream_id, log_ctx_t *log_ctx)
+{
+	int ret_code;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(prog_proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_section_ctx_pms!= NULL, return STAT_ERROR);
+
+	prog_proc_ctx->ts_remap_ctx= ts_remap_open(LOG_CTX_GET());
+	CHECK_DO(prog_proc_ctx->ts_remap_ctx!= NULL, return STAT_ERROR);
+	prog_proc_ctx->pmt_pid= pmt_pid;
+
+	ret_code= ts_remap_set_pid(prog_proc_ctx->ts_remap_ctx, pmt_pid, pmt_pid);
+	CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+
+	ret_code= prog_proc_passthrough_set(prog_proc_ctx, psi_section_ctx_pms,
+			transport_stream_id, LOG_CTX_GET());
+	CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+
+	LOGD("Program processor (PMT PID %u) running in passthrough mode\n",
+			pmt_pid);
+	prog_proc_ctx->flag_passthrough= 1;
+	return STAT_SUCCESS;
+}
+
+/**
+ * Apply a Program Map Section and a transport stream identifier in
+ * passthrough mode: the PIDs of the new PMS are mapped first, then the PIDs
+ * of the previous PMS not used anymore are dropped (thus a PID kept in both
+ * is never dropped in between), and the PSI is re-written.
+ * The given section is referenced (see 'psi_section_ctx_ref()').
+ */
+static int prog_proc_passthrough_set(prog_proc_ctx_t *prog_proc_ctx,
+		psi_section_ctx_t *psi_section_ctx_pms, uint16_t transport_stream_id,
+		log_ctx_t *log_ctx)
+{
+	llist_t *n;
+	int ret_code;
+	uint16_t pid;
+	uint8_t pid_set[(TS_MAX_PID_VAL+ 1)/ 8]= {0};
+	const psi_pms_ctx_t *psi_pms_ctx, *psi_pms_ctx_prev= NULL;
+	ts_remap_ctx_t *ts_remap_ctx;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(prog_proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_section_ctx_pms!= NULL, return STAT_ERROR);
+
+	ts_remap_ctx= prog_proc_ctx->ts_remap_ctx;
+	CHECK_DO(ts_remap_ctx!= NULL, return STAT_ERROR);
+
+	psi_pms_ctx= (const psi_pms_ctx_t*)psi_section_ctx_pms->data;
+	CHECK_DO(psi_pms_ctx!= NULL, return STAT_ERROR);
+
+	/* Map the PIDs of the new PMS */
+	if((pid= psi_pms_ctx->pcr_pid)< TS_MAX_PID_VAL) {
+		ret_code= ts_remap_set_pid(ts_remap_ctx, pid, pid);
+		CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+		pid_set[pid>> 3]|= (1<< (pid& 7));
+	}
+	for(n= psi_pms_ctx->psi_pms_es_ctx_llist; n!= NULL; n= n->next) {
+		psi_pms_es_ctx_t *psi_pms_es_ctx= (psi_pms_es_ctx_t*)n->data;
+		CHECK_DO(psi_pms_es_ctx!= NULL, continue);
+		if((pid= psi_pms_es_ctx->elementary_PID)>= TS_MAX_PID_VAL)
+			continue;
+		ret_code= ts_remap_set_pid(ts_remap_ctx, pid, pid);
+		CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+		pid_set[pid>> 3]|= (1<< (pid& 7));
+	}
+
+	/* Drop the PIDs of the previous PMS not used anymore */
+	if(prog_proc_ctx->psi_section_ctx_pms!= NULL)
+		psi_pms_ctx_prev= (const psi_pms_ctx_t*)
+				prog_proc_ctx->psi_section_ctx_pms->data;
+	if(psi_pms_ctx_prev!= NULL) {
+		if((pid= psi_pms_ctx_prev->pcr_pid)< TS_MAX_PID_VAL &&
+				pid!= prog_proc_ctx->pmt_pid &&
+				(pid_set[pid>> 3]& (1<< (pid& 7)))== 0)
+			ts_remap_set_pid(ts_remap_ctx, pid, TS_REMAP_PID_DROP);
+		for(n= psi_pms_ctx_prev->psi_pms_es_ctx_llist; n!= NULL;
+				n= n->next) {
+			psi_pms_es_ctx_t *psi_pms_es_ctx= (psi_pms_es_ctx_t*)n->data;
+			if(psi_pms_es_ctx== NULL ||
+					(pid= psi_pms_es_ctx->elementary_PID)>= TS_MAX_PID_VAL ||
+					pid== prog_proc_ctx->pmt_pid ||
+					(pid_set[pid>> 3]& (1<< (pid& 7)))!= 0)
+				continue;
+			ts_remap_set_pid(ts_remap_ctx, pid, TS_REMAP_PID_DROP);
+		}
+	}
+
+	/* Re-write PSI */
+	ret_code= ts_remap_set_pms(ts_remap_ctx, prog_proc_ctx->pmt_pid,
+			psi_section_ctx_pms, transport_stream_id);
+	CHECK_DO(ret_code== STAT_SUCCESS, return STAT_ERROR);
+
+	if(psi_section_ctx_pms!= prog_proc_ctx->psi_section_ctx_pms) {
+		psi_section_ctx_release(&prog_proc_ctx->psi_section_ctx_pms);
+		prog_proc_ctx->psi_section_ctx_pms= psi_section_ctx_ref(
+				psi_section_ctx_pms);
+	}
+	prog_proc_ctx->transport_stream_id= transport_stream_id;
+	return STAT_SUCCESS;
+}
@@ -35,6 +35,23 @@ typedef struct proc_if_s proc_if_t;
 
 /**
  * Processor interface implementing the program processor.
+ * The Program Map Section is handed to the forked program processor task
+ * as a raw section in a shared-memory slot (see 'prog_proc_shm.h'); it is
+ * initialized from the "pmt_octet_stream" setting (base64 encoded) and may
+ * be updated using the following option:
+ * - "PROCS_ID_PROG_PROC_PUT_PMS": arguments are the raw Program Map Section
+ * ('const uint8_t*') and its size ('size_t'). If the processor is running
+ * in passthrough mode (no task is forked), the PMS is applied in place;
+ * - "PROCS_ID_PROG_PROC_GET_PMS_ACKED": argument is a reference to an
+ * integer ('int*') set to non-zero if the task already applied the last
+ * Program Map Section put (always set in passthrough mode);
+ * - "PROCS_ID_PROG_PROC_PUT_TSID": argument is the transport stream
+ * identifier of the input PAT ('int'), used in the re-written PAT of the
+ * passthrough mode (initialized from the "transport_stream_id" setting).
+ * Returns STAT_ENOTFOUND if the processor is not running in passthrough
+ * mode.
+ * In passthrough mode, the output packets (re-written PAT and PMT, and the
+ * program packets) are received as frames using 'procs_recv_frame()'.
  */
 extern const proc_if_t proc_if_mpeg2_prog_proc;
 
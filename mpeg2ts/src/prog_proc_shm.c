@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file prog_proc_shm.c
+ * @author Rafael Antoniello
+ */
+
+#include "prog_proc_shm.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <string.h>
+#include <errno.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include <libmediaprocsutils/schedule.h>
+
+/* **** Implementations **** */
+
+prog_proc_shm_psi_slot_t* prog_proc_shm_psi_slot_open(const char *name,
+		int flag_create, log_ctx_t *log_ctx)
+{
+	int end_code= STAT_ERROR, shm_fd= -1;
+	prog_proc_shm_psi_slot_t *psi_slot= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(name!= NULL && strlen(name)> 0, return NULL);
+
+	/* Open (or create) the shared memory segment */
+	shm_fd= shm_open(name, (flag_create!= 0)? O_CREAT| O_RDWR: O_RDWR,
+			S_IRUSR | S_IWUSR);
+	CHECK_DO(shm_fd>= 0, LOGE("errno: %d\n", errno); goto end);
+	if(flag_create!= 0) {
+		CHECK_DO(ftruncate(shm_fd, sizeof(prog_proc_shm_psi_slot_t))== 0,
+				goto end);
+	}
+
+	/* Map the shared memory segment in the address space of the process */
+	psi_slot= (prog_proc_shm_psi_slot_t*)mmap(NULL,
+			sizeof(prog_proc_shm_psi_slot_t), PROT_READ|PROT_WRITE,
+			MAP_SHARED, shm_fd, 0);
+	if(psi_slot== MAP_FAILED)
+		psi_slot= NULL;
+	CHECK_DO(psi_slot!= NULL, goto end);
+
+	/* The creator initializes the slot (no section written yet) */
+	if(flag_create!= 0) {
+		psi_slot->size= 0;
+		__atomic_store_n(&psi_slot->seq_ack, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&psi_slot->seq, 0, __ATOMIC_RELEASE);
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	if(shm_fd>= 0) {
+		ASSERT(close(shm_fd)== 0);
+	}
+	if(end_code!= STAT_SUCCESS)
+		prog_proc_shm_psi_slot_close(&psi_slot);
+	return psi_slot;
+}
+
+void prog_proc_shm_psi_slot_close(prog_proc_shm_psi_slot_t **ref_psi_slot)
+{
+	prog_proc_shm_psi_slot_t *psi_slot= NULL;
+	LOG_CTX_INIT(NULL);
+
+	if(ref_psi_slot== NULL || (psi_slot= *ref_psi_slot)== NULL)
+		return;
+
+	ASSERT(munmap((void*)psi_slot, sizeof(prog_proc_shm_psi_slot_t))== 0);
+	*ref_psi_slot= NULL;
+}
+
+int prog_proc_shm_psi_slot_write(prog_proc_shm_psi_slot_t *psi_slot,
+		const uint8_t *buf, size_t size, log_ctx_t *log_ctx)
+{
+	uint32_t seq;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(psi_slot!= NULL, return STAT_ERROR);
+	CHECK_DO(buf!= NULL, return STAT_ERROR);
+	CHECK_DO(size> 0 && size<= PROG_PROC_SHM_PSI_SLOT_SIZE,
+			return STAT_ERROR);
+
+	/* Acquire the slot: set the sequence number to odd (writing). Note that
+	 * concurrent writers are serialized here.
+	 */
+	for(;;) {
+		seq= __atomic_load_n(&psi_slot->seq, __ATOMIC_RELAXED);
+		if((seq& 1)== 0 && __atomic_compare_exchange_n(&psi_slot->seq, &seq,
+				seq+ 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			break;
+		schedule();
+	}
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	memcpy(psi_slot->buf, buf, size);
+	psi_slot->size= (uint32_t)size;
+
+	/* Publish: next even sequence number (skip zero on wrap-around) */
+	seq+= 2;
+	if(seq== 0)
+		seq= 2;
+	__atomic_store_n(&psi_slot->seq, seq, __ATOMIC_RELEASE);
+	return STAT_SUCCESS;
+}
+
+int prog_proc_shm_psi_slot_read(prog_proc_shm_psi_slot_t *psi_slot,
+		uint32_t *ref_seq, uint8_t *buf, size_t *ref_size)
+{
+	uint32_t seq, size;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_slot!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_seq!= NULL, return STAT_ERROR);
+	CHECK_DO(buf!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_size!= NULL, return STAT_ERROR);
+
+	seq= __atomic_load_n(&psi_slot->seq, __ATOMIC_ACQUIRE);
+	if(seq== *ref_seq || seq== 0)
+		return STAT_NOTMODIFIED;
+	if((seq& 1)!= 0)
+		return STAT_EAGAIN;
+
+	size= psi_slot->size;
+	if(size== 0 || size> PROG_PROC_SHM_PSI_SLOT_SIZE)
+		return STAT_EAGAIN; // Torn read; sequence number check would fail
+	memcpy(buf, psi_slot->buf, size);
+
+	/* Discard the copy if the section was re-written meanwhile */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if(__atomic_load_n(&psi_slot->seq, __ATOMIC_RELAXED)!= seq)
+		return STAT_EAGAIN;
+
+	*ref_seq= seq;
+	*ref_size= (size_t)size;
+	return STAT_SUCCESS;
+}
+
+void prog_proc_shm_psi_slot_ack(prog_proc_shm_psi_slot_t *psi_slot,
+		uint32_t seq)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_slot!= NULL, return);
+
+	__atomic_store_n(&psi_slot->seq_ack, seq, __ATOMIC_RELEASE);
+}
+
+int prog_proc_shm_psi_slot_is_acked(prog_proc_shm_psi_slot_t *psi_slot)
+{
+	uint32_t seq;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_slot!= NULL, return 0);
+
+	seq= __atomic_load_n(&psi_slot->seq, __ATOMIC_ACQUIRE);
+	return seq== 0 || __atomic_load_n(&psi_slot->seq_ack,
+			__ATOMIC_ACQUIRE)== seq;
+}
@@ -26,8 +26,14 @@
 #ifndef STREAMPROCESSORS_MPEG2TS_SRC_PROG_PROC_SHM_H_
 #define STREAMPROCESSORS_MPEG2TS_SRC_PROG_PROC_SHM_H_
 
+#include <sys/types.h>
+#include <inttypes.h>
+
 /* **** Definitions **** */
 
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+
 /** Installation directory complete path */
 #ifndef _INSTALL_DIR //HACK: "fake" path for IDE
 #define _INSTALL_DIR "./"
@@ -38,6 +44,7 @@
 #define SUF_SH_API_I "-api-iput"
 #define SUF_SH_API_O "-api-oput"
 #define SUF_SH_FLG_EXIT "-flag-exit"
+#define SUF_SH_PSI "-psi-slot"
 
 #define PROG_PROC_SHM_FIFO_SIZE_IPUT 256
 #define PROG_PROC_SHM_FIFO_SIZE_OPUT 256
@@ -45,4 +52,98 @@
 #define PROG_PROC_SHM_SIZE_CHUNK_PUT 8192
 #define PROG_PROC_SHM_SIZE_CHUNK_GET (1024* 512)
 
+/**
+ * PSI slot buffer size: maximum size of an MPEG-2 PSI section (see
+ * PSI_TABLE_MPEG_MAX_SECTION_LEN) [bytes].
+ */
+#define PROG_PROC_SHM_PSI_SLOT_SIZE 1024
+
+/**
+ * PSI slot: shared-memory hand-off of a raw (binary) PSI section from the
+ * parent process to the program processor task (namely, the Program Map
+ * Section).
+ * The slot is versioned with a sequence number: the writer sets it to an
+ * odd value while the section is being copied, and to the next even value
+ * when done. Readers just compare the sequence number with the last one
+ * read to know if the section changed, and discard the copy if the
+ * sequence number changed meanwhile (see 'prog_proc_shm_psi_slot_read()').
+ * Sequence number zero means no section was written yet.
+ * Once the section is applied, the reader acknowledges it by copying its
+ * sequence number to 'seq_ack' (see 'prog_proc_shm_psi_slot_ack()').
+ */
+typedef struct prog_proc_shm_psi_slot_s {
+	volatile uint32_t seq;
+	volatile uint32_t seq_ack;
+	uint32_t size;
+	uint8_t buf[PROG_PROC_SHM_PSI_SLOT_SIZE];
+} prog_proc_shm_psi_slot_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Map the PSI slot with the given shared-memory name.
+ * @param name Shared-memory object name.
+ * @param flag_create Set to non-zero to create (and initialize) the slot;
+ * set to zero to map an already existing slot (e.g. in the forked task).
+ * @param log_ctx LOG module context structure.
+ * @return Pointer to the mapped PSI slot, NULL if fails.
+ */
+prog_proc_shm_psi_slot_t* prog_proc_shm_psi_slot_open(const char *name,
+		int flag_create, log_ctx_t *log_ctx);
+
+/**
+ * Un-map the given PSI slot (the shared-memory object is not removed).
+ * @param ref_psi_slot Reference to the pointer to the PSI slot to be
+ * un-mapped. Pointer is set to NULL on return.
+ */
+void prog_proc_shm_psi_slot_close(prog_proc_shm_psi_slot_t **ref_psi_slot);
+
+/**
+ * Write a raw PSI section in the slot and publish it with a new sequence
+ * number.
+ * @param psi_slot PSI slot.
+ * @param buf Raw section.
+ * @param size Raw section size; should not exceed
+ * PROG_PROC_SHM_PSI_SLOT_SIZE.
+ * @param log_ctx LOG module context structure.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int prog_proc_shm_psi_slot_write(prog_proc_shm_psi_slot_t *psi_slot,
+		const uint8_t *buf, size_t size, log_ctx_t *log_ctx);
+
+/**
+ * Read the raw PSI section in the slot if it changed since the last read.
+ * @param psi_slot PSI slot.
+ * @param ref_seq Reference to the sequence number of the last section read
+ * (zero if none); updated on success.
+ * @param buf Buffer to copy the section to (PROG_PROC_SHM_PSI_SLOT_SIZE
+ * bytes at least).
+ * @param ref_size Reference to the size of the section copied.
+ * @return STAT_SUCCESS if a new section was copied, STAT_NOTMODIFIED if the
+ * section did not change (or was never written), STAT_EAGAIN if the section
+ * is being written (should be retried later), STAT_ERROR otherwise.
+ */
+int prog_proc_shm_psi_slot_read(prog_proc_shm_psi_slot_t *psi_slot,
+		uint32_t *ref_seq, uint8_t *buf, size_t *ref_size);
+
+/**
+ * Acknowledge the section with the given sequence number as applied by the
+ * reader.
+ * @param psi_slot PSI slot.
+ * @param seq Sequence number of the applied section (as returned by
+ * 'prog_proc_shm_psi_slot_read()').
+ */
+void prog_proc_shm_psi_slot_ack(prog_proc_shm_psi_slot_t *psi_slot,
+		uint32_t seq);
+
+/**
+ * Check if the last section written in the slot was acknowledged by the
+ * reader.
+ * @param psi_slot PSI slot.
+ * @return Non-zero if the last section written (if any) was already applied
+ * by the reader, zero otherwise.
+ */
+int prog_proc_shm_psi_slot_is_acked(prog_proc_shm_psi_slot_t *psi_slot);
+
 #endif /* STREAMPROCESSORS_MPEG2TS_SRC_PROG_PROC_SHM_H_ */
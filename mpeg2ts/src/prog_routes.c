@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file prog_routes.c
+ * @author Rafael Antoniello
+ */
+
+#include "prog_routes.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include <libmediaprocsutils/llist.h>
+#include "ts.h"
+#include "psi.h"
+#include "psi_table.h"
+
+/* **** Prototypes **** */
+
+static int prog_routes_pair_cmp(const void *p1, const void *p2);
+
+/* **** Implementations **** */
+
+prog_routes_t* prog_routes_compose(const psi_table_ctx_t *psi_table_ctx_pat,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx)
+{
+	int i, pass, end_code= STAT_ERROR, prog_num= 0, pair_num= 0,
+			pair_num_max= 0;
+	llist_t *n, *n2, *n3;
+	uint32_t *pair_array= NULL;
+	uint8_t pmt_pid_set[(TS_MAX_PID_VAL+ 1)/ 8]= {0};
+	prog_routes_t *prog_routes= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(psi_table_ctx_pat!= NULL, return NULL);
+	CHECK_DO(psi_table_ctx_pmt!= NULL, return NULL);
+
+	prog_routes= (prog_routes_t*)calloc(1, sizeof(prog_routes_t));
+	CHECK_DO(prog_routes!= NULL, goto end);
+	prog_routes->ref_cnt= 1;
+	prog_routes->transport_stream_id= -1;
+	if(psi_table_ctx_pat->psi_section_ctx_llist!= NULL &&
+			psi_table_ctx_pat->psi_section_ctx_llist->data!= NULL)
+		prog_routes->transport_stream_id= ((psi_section_ctx_t*)
+				psi_table_ctx_pat->psi_section_ctx_llist->data)->
+						table_id_extension;
+
+	/* First pass counts the programs and the routing pairs, second pass
+	 * fills the arrays.
+	 */
+	for(pass= 0; pass< 2; pass++) {
+		if(pass== 1) {
+			if(prog_num> 0) {
+				prog_routes->prog_array= (prog_route_t*)calloc(prog_num,
+						sizeof(prog_route_t));
+				CHECK_DO(prog_routes->prog_array!= NULL, goto end);
+				prog_routes->pmt_pid_array= (uint16_t*)calloc(prog_num,
+						sizeof(uint16_t));
+				CHECK_DO(prog_routes->pmt_pid_array!= NULL, goto end);
+				pair_array= (uint32_t*)malloc(pair_num_max*
+						sizeof(uint32_t));
+				CHECK_DO(pair_array!= NULL, goto end);
+			}
+			prog_num= 0;
+		}
+
+		for(n= psi_table_ctx_pat->psi_section_ctx_llist; n!= NULL;
+				n= n->next) {
+			psi_section_ctx_t *psi_section_ctx_ith=
+					(psi_section_ctx_t*)n->data;
+			psi_pas_ctx_t *psi_pas_ctx_ith;
+
+			CHECK_DO(psi_section_ctx_ith!= NULL, continue);
+			psi_pas_ctx_ith= psi_section_ctx_ith->data;
+			CHECK_DO(psi_pas_ctx_ith!= NULL, continue);
+
+			for(n2= psi_pas_ctx_ith->psi_pas_prog_ctx_llist; n2!= NULL;
+					n2= n2->next) {
+				uint16_t pmt_pid;
+				prog_route_t *prog_route;
+				psi_pas_prog_ctx_t *psi_pas_prog_ctx_jth;
+				psi_section_ctx_t *psi_section_ctx_pms;
+				psi_pms_ctx_t *psi_pms_ctx;
+
+				psi_pas_prog_ctx_jth= (psi_pas_prog_ctx_t*)n2->data;
+				CHECK_DO(psi_pas_prog_ctx_jth!= NULL, continue);
+				if(psi_pas_prog_ctx_jth->program_number== 0)
+					continue; // Skip 'network_PID' value if present
+				pmt_pid= psi_pas_prog_ctx_jth->reference_pid;
+				CHECK_DO(pmt_pid<= TS_MAX_PID_VAL, continue);
+
+				/* Look for the corresponding PMS (program number) */
+				psi_section_ctx_pms= psi_table_pmt_ctx_filter_program_num(
+						psi_table_ctx_pmt,
+						psi_pas_prog_ctx_jth->program_number);
+				psi_pms_ctx= (psi_section_ctx_pms!= NULL)?
+						(psi_pms_ctx_t*)psi_section_ctx_pms->data: NULL;
+
+				if(pass== 0) {
+					prog_num++;
+					pair_num_max++; // PMT PID
+					if(psi_pms_ctx!= NULL)
+						pair_num_max+= 1+ llist_len(
+								psi_pms_ctx->psi_pms_es_ctx_llist);
+					continue;
+				}
+
+				prog_route= &prog_routes->prog_array[prog_num++];
+				prog_route->program_number=
+						psi_pas_prog_ctx_jth->program_number;
+				prog_route->pmt_pid= pmt_pid;
+				prog_route->version_number= (psi_pms_ctx!= NULL)?
+						psi_section_ctx_pms->version_number: -1;
+
+				/* Programs may share the PMT PID (same processor) */
+				if((pmt_pid_set[pmt_pid>> 3]& (1<< (pmt_pid& 7)))== 0) {
+					pmt_pid_set[pmt_pid>> 3]|= (1<< (pmt_pid& 7));
+					prog_routes->pmt_pid_array[
+							prog_routes->pmt_pid_num++]= pmt_pid;
+				}
+
+				pair_array[pair_num++]= ((uint32_t)pmt_pid<< 16)| pmt_pid;
+				if(psi_pms_ctx== NULL)
+					continue;
+				if(psi_pms_ctx->pcr_pid< TS_MAX_PID_VAL)
+					pair_array[pair_num++]=
+							((uint32_t)psi_pms_ctx->pcr_pid<< 16)| pmt_pid;
+				for(n3= psi_pms_ctx->psi_pms_es_ctx_llist; n3!= NULL;
+						n3= n3->next) {
+					psi_pms_es_ctx_t *psi_pms_es_ctx=
+							(psi_pms_es_ctx_t*)n3->data;
+					CHECK_DO(psi_pms_es_ctx!= NULL, continue);
+					if(psi_pms_es_ctx->elementary_PID< TS_MAX_PID_VAL)
+						pair_array[pair_num++]= ((uint32_t)
+								psi_pms_es_ctx->elementary_PID<< 16)|
+								pmt_pid;
+				}
+			}
+		}
+	}
+	prog_routes->prog_num= prog_num;
+
+	/* Sort routing pairs by PID and remove duplicates (e.g. PCR carried in
+	 * an elementary stream, or elementary streams shared by the programs
+	 * of the same PMT PID).
+	 */
+	if(pair_num> 0) {
+		int pair_num_unique= 1;
+
+		qsort(pair_array, pair_num, sizeof(uint32_t), prog_routes_pair_cmp);
+		for(i= 1; i< pair_num; i++) {
+			if(pair_array[i]!= pair_array[pair_num_unique- 1])
+				pair_array[pair_num_unique++]= pair_array[i];
+		}
+		pair_num= pair_num_unique;
+
+		prog_routes->pid_prog_array= (uint16_t*)malloc(pair_num*
+				sizeof(uint16_t));
+		CHECK_DO(prog_routes->pid_prog_array!= NULL, goto end);
+	}
+	for(i= 0; i< pair_num; i++) {
+		prog_routes->pid_prog_array[i]= (uint16_t)(pair_array[i]& 0xFFFF);
+		prog_routes->pid_offset_array[(pair_array[i]>> 16)+ 1]++;
+	}
+	for(i= 1; i<= TS_MAX_PID_VAL+ 1; i++)
+		prog_routes->pid_offset_array[i]+= prog_routes->pid_offset_array[i- 1];
+
+	end_code= STAT_SUCCESS;
+end:
+	if(pair_array!= NULL)
+		free(pair_array);
+	if(end_code!= STAT_SUCCESS)
+		prog_routes_release(&prog_routes, NULL);
+	return prog_routes;
+}
+
+int prog_routes_equal(const prog_routes_t *prog_routes1,
+		const prog_routes_t *prog_routes2)
+{
+	if(prog_routes1== NULL || prog_routes2== NULL)
+		return prog_routes1== prog_routes2;
+	if(prog_routes1->prog_num!= prog_routes2->prog_num ||
+			prog_routes1->pmt_pid_num!= prog_routes2->pmt_pid_num ||
+			prog_routes1->transport_stream_id!=
+					prog_routes2->transport_stream_id)
+		return 0;
+	if(memcmp(prog_routes1->pid_offset_array, prog_routes2->pid_offset_array,
+			sizeof(prog_routes1->pid_offset_array))!= 0)
+		return 0;
+	if(prog_routes1->prog_num> 0 && (memcmp(prog_routes1->prog_array,
+			prog_routes2->prog_array, prog_routes1->prog_num*
+			sizeof(prog_route_t))!= 0 || memcmp(prog_routes1->pmt_pid_array,
+			prog_routes2->pmt_pid_array, prog_routes1->pmt_pid_num*
+			sizeof(uint16_t))!= 0))
+		return 0;
+	if(prog_routes1->pid_offset_array[TS_MAX_PID_VAL+ 1]> 0 &&
+			memcmp(prog_routes1->pid_prog_array, prog_routes2->pid_prog_array,
+			prog_routes1->pid_offset_array[TS_MAX_PID_VAL+ 1]*
+			sizeof(uint16_t))!= 0)
+		return 0;
+	return 1;
+}
+
+void prog_routes_release(prog_routes_t **ref_prog_routes,
+		pthread_mutex_t *mutex)
+{
+	int ref_cnt;
+	prog_routes_t *prog_routes;
+
+	if(ref_prog_routes== NULL || (prog_routes= *ref_prog_routes)== NULL)
+		return;
+	*ref_prog_routes= NULL;
+
+	if(mutex!= NULL) {
+		ASSERT(pthread_mutex_lock(mutex)== 0);
+		ref_cnt= --prog_routes->ref_cnt;
+		ASSERT(pthread_mutex_unlock(mutex)== 0);
+	} else {
+		ref_cnt= --prog_routes->ref_cnt;
+	}
+	if(ref_cnt> 0)
+		return;
+
+	if(prog_routes->prog_array!= NULL)
+		free(prog_routes->prog_array);
+	if(prog_routes->pmt_pid_array!= NULL)
+		free(prog_routes->pmt_pid_array);
+	if(prog_routes->pid_prog_array!= NULL)
+		free(prog_routes->pid_prog_array);
+	free(prog_routes);
+}
+
+/**
+ * Compare function used to sort the (PID, PMT PID) routing pairs.
+ */
+static int prog_routes_pair_cmp(const void *p1, const void *p2)
+{
+	uint32_t pair1= *(const uint32_t*)p1, pair2= *(const uint32_t*)p2;
+	return (pair1> pair2)- (pair1< pair2);
+}
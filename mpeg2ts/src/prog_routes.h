@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file prog_routes.h
+ * @brief Program packets routing snapshot.
+ * Maps each input PID to the program processors (identified by the PMT PID)
+ * the packets of that PID are to be delivered to, as described by the PAT
+ * and the PMT.
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_PROG_ROUTES_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_PROG_ROUTES_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "ts.h"
+
+/* **** Definitions **** */
+
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+typedef struct psi_table_ctx_s psi_table_ctx_t;
+
+/**
+ * Program listed in the PAT (see 'prog_routes_t').
+ */
+typedef struct prog_route_s {
+	uint16_t program_number;
+	/**
+	 * PMT PID (that is, the program processor Id.).
+	 */
+	uint16_t pmt_pid;
+	/**
+	 * Program Map Section version; -1 if PMS was not received yet.
+	 */
+	int version_number;
+} prog_route_t;
+
+/**
+ * Program packets routing snapshot.
+ * Snapshots are immutable once composed; a snapshot may be shared by
+ * several threads, each holding a reference (see 'prog_routes_release()').
+ */
+typedef struct prog_routes_s {
+	/**
+	 * Reference counter (protected by the mutex of the owner of the
+	 * published snapshot, if shared).
+	 */
+	int ref_cnt;
+	/**
+	 * Programs listed in the PAT.
+	 */
+	prog_route_t *prog_array;
+	int prog_num;
+	/**
+	 * PMT PIDs of the programs listed in the PAT (each PID listed once); PAT
+	 * packets are routed to each of these program processors.
+	 */
+	uint16_t *pmt_pid_array;
+	int pmt_pid_num;
+	/**
+	 * For each PID, the PMT PIDs of the programs it belongs to (PMT, PCR and
+	 * elementary streams PIDs) are 'pid_prog_array[pid_offset_array[pid]]'
+	 * to 'pid_prog_array[pid_offset_array[pid+ 1]- 1]'. A PID may be shared
+	 * by several programs.
+	 */
+	uint32_t pid_offset_array[TS_MAX_PID_VAL+ 2];
+	uint16_t *pid_prog_array;
+	/**
+	 * Transport stream identifier of the PAT ('table_id_extension'); -1 if
+	 * the PAT has no sections.
+	 */
+	int transport_stream_id;
+} prog_routes_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Compose a program packets routing snapshot from the given PAT and PMT.
+ * @param psi_table_ctx_pat PAT.
+ * @param psi_table_ctx_pmt PMT (programs which PMS is not present are
+ * routed the PMT PID only).
+ * @param log_ctx Externally defined LOG module context structure instance.
+ * @return The snapshot, with a reference count of one, on success (to be
+ * released using 'prog_routes_release()'); NULL if fails.
+ */
+prog_routes_t* prog_routes_compose(const psi_table_ctx_t *psi_table_ctx_pat,
+		const psi_table_ctx_t *psi_table_ctx_pmt, log_ctx_t *log_ctx);
+
+/**
+ * Check if two program packets routing snapshots are equal (a NULL
+ * snapshot is only equal to a NULL snapshot).
+ * @param prog_routes1 Snapshot.
+ * @param prog_routes2 Snapshot.
+ * @return Non-zero if equal, zero otherwise.
+ */
+int prog_routes_equal(const prog_routes_t *prog_routes1,
+		const prog_routes_t *prog_routes2);
+
+/**
+ * Release a reference to a program packets routing snapshot; snapshot is
+ * freed when the last reference is released.
+ * @param ref_prog_routes Reference to the pointer to the snapshot. Pointer
+ * is set to NULL on return.
+ * @param mutex Mutex protecting the reference counter of a shared
+ * (published) snapshot; NULL if the snapshot is not shared.
+ */
+void prog_routes_release(prog_routes_t **ref_prog_routes,
+		pthread_mutex_t *mutex);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_PROG_ROUTES_H_ */
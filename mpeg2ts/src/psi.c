@@ -25,6 +25,7 @@
 #include "psi.h"
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 
 #define LOG_CTX_DEFULT
@@ -34,21 +35,135 @@
 #include <libmediaprocsutils/llist.h>
 #include "psi_desc.h"
 #include "psi_dvb.h"
+#include "obj_pool.h"
 #include "ts.h"
 
 /* **** Definitions **** */
 
+/**
+ * Relocate the given arena pointer by 'DELTA' bytes
+ * (see 'psi_section_ctx_dup()').
+ */
+#define ARENA_RELOCATE(P, DELTA) \
+	if((P)!= NULL) (P)= (void*)((uint8_t*)(P)+ (DELTA))
+
+/**
+ * Function applied to each descriptor of an arena allocated section
+ * (see 'psi_section_ctx_arena_walk()').
+ */
+typedef void (*psi_arena_desc_fxn_t)(psi_desc_ctx_t *psi_desc_ctx,
+		ptrdiff_t delta);
+
+/* **** Prototypes **** */
+
+static void psi_section_ctx_arena_walk(psi_section_ctx_t *psi_section_ctx,
+		ptrdiff_t delta, psi_arena_desc_fxn_t psi_arena_desc_fxn);
+static void psi_arena_llist_walk(llist_t **ref_llist, ptrdiff_t delta,
+		psi_arena_desc_fxn_t psi_arena_desc_fxn);
+static void psi_arena_desc_relocate(psi_desc_ctx_t *psi_desc_ctx,
+		ptrdiff_t delta);
+static void psi_arena_desc_release_data(psi_desc_ctx_t *psi_desc_ctx,
+		ptrdiff_t delta);
+
+static const llist_t* psi_desc_llist_seek_tag(const llist_t *psi_desc_ctx_llist,
+		uint8_t tag);
+static int psi_desc_llist_diff(const llist_t *psi_desc_ctx_llist_prev,
+		const llist_t *psi_desc_ctx_llist, uint64_t desc_tag_bitmap[4]);
+
 /* **** Implementations **** */
 
 psi_section_ctx_t* psi_section_ctx_allocate()
 {
-	return (psi_section_ctx_t*)calloc(1, sizeof(psi_section_ctx_t));
+	return (psi_section_ctx_t*)obj_pool_calloc(sizeof(psi_section_ctx_t));
+}
+
+psi_section_ctx_t* psi_section_ctx_allocate_arena(size_t arena_size)
+{
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	const size_t sect_size= PSI_SECTION_ARENA_SIZEOF(sizeof(psi_section_ctx_t));
+
+	/* Check arguments */
+	CHECK_DO(arena_size>= sect_size, return NULL);
+
+	arena_size= PSI_SECTION_ARENA_SIZEOF(arena_size);
+	CHECK_DO(posix_memalign((void**)&psi_section_ctx, PSI_SECTION_ARENA_ALIGN,
+			arena_size)== 0 && psi_section_ctx!= NULL, return NULL);
+	memset(psi_section_ctx, 0, sect_size);
+	psi_section_ctx->arena_size= arena_size;
+	psi_section_ctx->arena_used= sect_size;
+	return psi_section_ctx;
+}
+
+void* psi_section_ctx_arena_calloc(psi_section_ctx_t *psi_section_ctx,
+		size_t size)
+{
+	void *p;
+
+	/* Check arguments */
+	CHECK_DO(psi_section_ctx!= NULL && psi_section_ctx->arena_size> 0,
+			return NULL);
+
+	size= PSI_SECTION_ARENA_SIZEOF(size);
+	if(size> psi_section_ctx->arena_size- psi_section_ctx->arena_used) {
+		LOGE("PSI section arena exhausted (table id: %u)\n",
+				psi_section_ctx->table_id);
+		return NULL;
+	}
+	p= (uint8_t*)psi_section_ctx+ psi_section_ctx->arena_used;
+	psi_section_ctx->arena_used+= size;
+	memset(p, 0, size);
+	return p;
+}
+
+int psi_section_ctx_arena_llist_insert_nth(psi_section_ctx_t *psi_section_ctx,
+		llist_t **ref_llist, int nth, void *data)
+{
+	int i;
+	llist_t *node;
+
+	/* Check arguments */
+	CHECK_DO(ref_llist!= NULL, return STAT_ERROR);
+	CHECK_DO(nth>= 0, return STAT_ERROR);
+
+	node= (llist_t*)psi_section_ctx_arena_calloc(psi_section_ctx,
+			sizeof(llist_t));
+	CHECK_DO(node!= NULL, return STAT_ENOMEM);
+
+	for(i= 0; i< nth && *ref_llist!= NULL; i++)
+		ref_llist= &(*ref_llist)->next;
+	node->data= data;
+	node->next= *ref_llist;
+	*ref_llist= node;
+	return STAT_SUCCESS;
 }
 
 psi_section_ctx_t* psi_section_ctx_dup(
 		const psi_section_ctx_t* psi_section_ctx_arg)
 {
 	psi_section_ctx_t *psi_section_ctx= NULL;
+
+	/* Check arguments */
+	CHECK_DO(psi_section_ctx_arg!= NULL, return NULL);
+
+	if(psi_section_ctx_arg->arena_size== 0)
+		return psi_section_ctx_dup_nodes(psi_section_ctx_arg);
+
+	/* Copy the whole arena block and relocate its internal pointers */
+	CHECK_DO(posix_memalign((void**)&psi_section_ctx, PSI_SECTION_ARENA_ALIGN,
+			psi_section_ctx_arg->arena_size)== 0 && psi_section_ctx!= NULL,
+			return NULL);
+	memcpy(psi_section_ctx, psi_section_ctx_arg,
+			psi_section_ctx_arg->arena_used);
+	psi_section_ctx->refs= 0; // The copy has a single owner
+	psi_section_ctx_arena_walk(psi_section_ctx, (uint8_t*)psi_section_ctx-
+			(const uint8_t*)psi_section_ctx_arg, psi_arena_desc_relocate);
+	return psi_section_ctx;
+}
+
+psi_section_ctx_t* psi_section_ctx_dup_nodes(
+		const psi_section_ctx_t* psi_section_ctx_arg)
+{
+	psi_section_ctx_t *psi_section_ctx= NULL;
 	int end_code= STAT_ERROR;
 
 	/* Check arguments */
@@ -61,6 +176,8 @@ psi_section_ctx_t* psi_section_ctx_dup(
 	/* Copy all structure members at the exception of pointer values */
 	memcpy(psi_section_ctx, psi_section_ctx_arg, sizeof(psi_section_ctx_t));
 	psi_section_ctx->data= NULL;
+	psi_section_ctx->refs= 0; // The copy has a single owner
+	psi_section_ctx->arena_size= psi_section_ctx->arena_used= 0;
 
 	/* Duplicate PSI section specific data */
 	if(psi_section_ctx_arg->data!= NULL) {
@@ -94,6 +211,13 @@ end:
 	return psi_section_ctx;
 }
 
+psi_section_ctx_t* psi_section_ctx_ref(psi_section_ctx_t *psi_section_ctx)
+{
+	CHECK_DO(psi_section_ctx!= NULL, return NULL);
+	__atomic_add_fetch(&psi_section_ctx->refs, 1, __ATOMIC_RELAXED);
+	return psi_section_ctx;
+}
+
 int psi_section_ctx_cmp(const psi_section_ctx_t* psi_section_ctx1,
 		const psi_section_ctx_t* psi_section_ctx2)
 {
@@ -103,6 +227,10 @@ int psi_section_ctx_cmp(const psi_section_ctx_t* psi_section_ctx1,
 	CHECK_DO(psi_section_ctx1!= NULL, return 1);
 	CHECK_DO(psi_section_ctx2!= NULL, return 1);
 
+	/* Shared (immutable) section */
+	if(psi_section_ctx1== psi_section_ctx2)
+		return 0;
+
 	/* Compare representative fields of sections */
 	if(psi_section_ctx1->table_id!= psi_section_ctx2->table_id)
 		goto end;
@@ -131,7 +259,19 @@ void psi_section_ctx_release(psi_section_ctx_t **ref_psi_section_ctx)
 		return;
 
 	if((psi_section_ctx= *ref_psi_section_ctx)!= NULL) {
-		if(psi_section_ctx->data!= NULL) {
+		/* Release just this reference if others are held */
+		if(__atomic_fetch_sub(&psi_section_ctx->refs, 1, __ATOMIC_ACQ_REL)
+				> 0) {
+			*ref_psi_section_ctx= NULL;
+			return;
+		}
+		if(psi_section_ctx->arena_size> 0) {
+			/* Arena allocated section: only the descriptor data decoded on
+			 * demand is out of the arena block.
+			 */
+			psi_section_ctx_arena_walk(psi_section_ctx, 0,
+					psi_arena_desc_release_data);
+		} else if(psi_section_ctx->data!= NULL) {
 			void **ref_data= &psi_section_ctx->data;
 			uint8_t table_id= psi_section_ctx->table_id;
 
@@ -150,7 +290,10 @@ void psi_section_ctx_release(psi_section_ctx_t **ref_psi_section_ctx)
 				break;
 			}
 		}
-		free(psi_section_ctx);
+		if(psi_section_ctx->arena_size> 0)
+			free(psi_section_ctx);
+		else
+			obj_pool_free(psi_section_ctx, sizeof(psi_section_ctx_t));
 		*ref_psi_section_ctx= NULL;
 	}
 }
@@ -295,7 +438,7 @@ void psi_pas_ctx_trace(const psi_pas_ctx_t *psi_pas_ctx)
 
 psi_pas_prog_ctx_t* psi_pas_prog_ctx_allocate()
 {
-	return (psi_pas_prog_ctx_t*)calloc(1, sizeof(psi_pas_prog_ctx_t));
+	return (psi_pas_prog_ctx_t*)obj_pool_calloc(sizeof(psi_pas_prog_ctx_t));
 }
 
 psi_pas_prog_ctx_t* psi_pas_prog_ctx_dup(
@@ -313,7 +456,7 @@ void psi_pas_prog_ctx_release(psi_pas_prog_ctx_t **ref_psi_pas_prog_ctx)
 		return;
 
 	if((*ref_psi_pas_prog_ctx)!= NULL) {
-		free(*ref_psi_pas_prog_ctx);
+		obj_pool_free(*ref_psi_pas_prog_ctx, sizeof(psi_pas_prog_ctx_t));
 		*ref_psi_pas_prog_ctx= NULL;
 	}
 }
@@ -389,6 +532,129 @@ psi_pms_es_ctx_t* psi_pms_ctx_filter_es_pid(const psi_pms_ctx_t *psi_pms_ctx,
 	return NULL;
 }
 
+psi_pms_diff_ctx_t* psi_pms_ctx_diff(const psi_pms_ctx_t *psi_pms_ctx_prev,
+		const psi_pms_ctx_t *psi_pms_ctx)
+{
+	llist_t *n;
+	psi_pms_diff_ctx_t *psi_pms_diff_ctx= NULL;
+	psi_pms_es_diff_ctx_t *psi_pms_es_diff_ctx= NULL;
+	int ret_code, end_code= STAT_ERROR;
+
+	/* Check arguments */
+	CHECK_DO(psi_pms_ctx!= NULL, return NULL);
+
+	/* Allocate differences context structure */
+	psi_pms_diff_ctx= (psi_pms_diff_ctx_t*)calloc(1, sizeof(
+			psi_pms_diff_ctx_t));
+	CHECK_DO(psi_pms_diff_ctx!= NULL, goto end);
+
+	/* Program level differences */
+	if(psi_pms_ctx_prev== NULL ||
+			psi_pms_ctx_prev->pcr_pid!= psi_pms_ctx->pcr_pid)
+		psi_pms_diff_ctx->flags|= PSI_PMS_DIFF_PCR_PID;
+	if(psi_desc_llist_diff((psi_pms_ctx_prev!= NULL)?
+			psi_pms_ctx_prev->psi_desc_ctx_llist: NULL,
+			psi_pms_ctx->psi_desc_ctx_llist,
+			psi_pms_diff_ctx->desc_tag_bitmap)> 0)
+		psi_pms_diff_ctx->flags|= PSI_PMS_DIFF_PROGRAM_DESC;
+
+	/* Elementary stream entries added or modified */
+	for(n= psi_pms_ctx->psi_pms_es_ctx_llist; n!= NULL; n= n->next) {
+		psi_pms_es_diff_ctx_t psi_pms_es_diff_ctx_aux= {0};
+		const psi_pms_es_ctx_t *psi_pms_es_ctx_prev= NULL;
+		const psi_pms_es_ctx_t *psi_pms_es_ctx=
+				(const psi_pms_es_ctx_t*)n->data;
+		CHECK_DO(psi_pms_es_ctx!= NULL, continue);
+
+		psi_pms_es_diff_ctx_aux.elementary_PID=
+				psi_pms_es_ctx->elementary_PID;
+		psi_pms_es_diff_ctx_aux.stream_type= psi_pms_es_ctx->stream_type;
+
+		if(psi_pms_ctx_prev!= NULL)
+			psi_pms_es_ctx_prev= psi_pms_ctx_filter_es_pid(psi_pms_ctx_prev,
+					psi_pms_es_ctx->elementary_PID);
+		if(psi_pms_es_ctx_prev== NULL) {
+			psi_pms_es_diff_ctx_aux.flags= PSI_PMS_DIFF_ES_ADDED;
+		} else {
+			psi_pms_es_diff_ctx_aux.stream_type_prev=
+					psi_pms_es_ctx_prev->stream_type;
+			if(psi_pms_es_ctx_prev->stream_type!= psi_pms_es_ctx->stream_type)
+				psi_pms_es_diff_ctx_aux.flags|= PSI_PMS_DIFF_ES_STREAM_TYPE;
+			if(psi_desc_llist_diff(psi_pms_es_ctx_prev->psi_desc_ctx_llist,
+					psi_pms_es_ctx->psi_desc_ctx_llist,
+					psi_pms_es_diff_ctx_aux.desc_tag_bitmap)> 0)
+				psi_pms_es_diff_ctx_aux.flags|= PSI_PMS_DIFF_ES_DESC;
+		}
+		if(psi_pms_es_diff_ctx_aux.flags== 0)
+			continue; // Entry not changed
+
+		psi_pms_es_diff_ctx= (psi_pms_es_diff_ctx_t*)malloc(sizeof(
+				psi_pms_es_diff_ctx_t));
+		CHECK_DO(psi_pms_es_diff_ctx!= NULL, goto end);
+		memcpy(psi_pms_es_diff_ctx, &psi_pms_es_diff_ctx_aux,
+				sizeof(psi_pms_es_diff_ctx_t));
+		ret_code= llist_push(&psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist,
+				psi_pms_es_diff_ctx);
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+		psi_pms_es_diff_ctx= NULL; // Avoid double referencing
+		psi_pms_diff_ctx->flags|= psi_pms_es_diff_ctx_aux.flags;
+	}
+
+	/* Elementary stream entries removed (pushed last to be listed first) */
+	for(n= (psi_pms_ctx_prev!= NULL)? psi_pms_ctx_prev->psi_pms_es_ctx_llist:
+			NULL; n!= NULL; n= n->next) {
+		const psi_pms_es_ctx_t *psi_pms_es_ctx_prev=
+				(const psi_pms_es_ctx_t*)n->data;
+		CHECK_DO(psi_pms_es_ctx_prev!= NULL, continue);
+
+		if(psi_pms_ctx_filter_es_pid(psi_pms_ctx,
+				psi_pms_es_ctx_prev->elementary_PID)!= NULL)
+			continue;
+
+		psi_pms_es_diff_ctx= (psi_pms_es_diff_ctx_t*)calloc(1, sizeof(
+				psi_pms_es_diff_ctx_t));
+		CHECK_DO(psi_pms_es_diff_ctx!= NULL, goto end);
+		psi_pms_es_diff_ctx->elementary_PID=
+				psi_pms_es_ctx_prev->elementary_PID;
+		psi_pms_es_diff_ctx->flags= PSI_PMS_DIFF_ES_REMOVED;
+		psi_pms_es_diff_ctx->stream_type_prev=
+				psi_pms_es_ctx_prev->stream_type;
+		ret_code= llist_push(&psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist,
+				psi_pms_es_diff_ctx);
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+		psi_pms_es_diff_ctx= NULL; // Avoid double referencing
+		psi_pms_diff_ctx->flags|= PSI_PMS_DIFF_ES_REMOVED;
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	if(psi_pms_es_diff_ctx!= NULL)
+		free(psi_pms_es_diff_ctx);
+	if(end_code!= STAT_SUCCESS)
+		psi_pms_diff_ctx_release(&psi_pms_diff_ctx);
+	return psi_pms_diff_ctx;
+}
+
+void psi_pms_diff_ctx_release(psi_pms_diff_ctx_t **ref_psi_pms_diff_ctx)
+{
+	psi_pms_diff_ctx_t *psi_pms_diff_ctx;
+
+	if(ref_psi_pms_diff_ctx== NULL)
+		return;
+
+	if((psi_pms_diff_ctx= *ref_psi_pms_diff_ctx)!= NULL) {
+		/* Release list of elementary stream entries differences */
+		while(psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist!= NULL) {
+			psi_pms_es_diff_ctx_t *psi_pms_es_diff_ctx=
+					llist_pop(&psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist);
+			if(psi_pms_es_diff_ctx!= NULL)
+				free(psi_pms_es_diff_ctx);
+		}
+		free(psi_pms_diff_ctx);
+		*ref_psi_pms_diff_ctx= NULL;
+	}
+}
+
 void psi_pms_ctx_release(psi_pms_ctx_t **ref_psi_pms_ctx)
 {
 	psi_pms_ctx_t *psi_pms_ctx;
@@ -496,3 +762,162 @@ void psi_pms_es_ctx_trace(const psi_pms_es_ctx_t *psi_pms_es_ctx)
 	LOGV(">> ES_info_length: %u\n", psi_pms_es_ctx->es_info_length);
 	LOGV(">>\n");
 }
+
+/**
+ * Get the first node of the descriptors list, starting at the given node,
+ * holding a descriptor with the given tag.
+ */
+static const llist_t* psi_desc_llist_seek_tag(const llist_t *psi_desc_ctx_llist,
+		uint8_t tag)
+{
+	const llist_t *n;
+
+	for(n= psi_desc_ctx_llist; n!= NULL; n= n->next) {
+		const psi_desc_ctx_t *psi_desc_ctx= (const psi_desc_ctx_t*)n->data;
+		if(psi_desc_ctx!= NULL && psi_desc_ctx->descriptor_tag== tag)
+			return n;
+	}
+	return NULL;
+}
+
+/**
+ * Compare two descriptors lists tag by tag: descriptors with the same tag
+ * are compared in order of appearance, thus re-ordering descriptors of
+ * different tags is not considered a difference.
+ * The tags of the descriptors added, removed or modified are set in the
+ * given bitmap.
+ * @return Number of descriptor tags with differences.
+ */
+static int psi_desc_llist_diff(const llist_t *psi_desc_ctx_llist_prev,
+		const llist_t *psi_desc_ctx_llist, uint64_t desc_tag_bitmap[4])
+{
+	int i, diff_cnt= 0;
+	uint64_t tag_done_bitmap[4]= {0};
+	const llist_t *llist_array[2]= {psi_desc_ctx_llist_prev,
+			psi_desc_ctx_llist};
+
+	for(i= 0; i< 2; i++) {
+		const llist_t *n;
+
+		for(n= llist_array[i]; n!= NULL; n= n->next) {
+			const llist_t *n_prev, *n_curr;
+			const psi_desc_ctx_t *psi_desc_ctx=
+					(const psi_desc_ctx_t*)n->data;
+			uint8_t tag;
+			CHECK_DO(psi_desc_ctx!= NULL, continue);
+
+			tag= psi_desc_ctx->descriptor_tag;
+			if(tag_done_bitmap[tag>> 6]& ((uint64_t)1<< (tag& 63)))
+				continue;
+			tag_done_bitmap[tag>> 6]|= (uint64_t)1<< (tag& 63);
+
+			/* Compare, in order, the descriptors having this tag */
+			for(n_prev= psi_desc_ctx_llist_prev, n_curr= psi_desc_ctx_llist;;
+					n_prev= n_prev->next, n_curr= n_curr->next) {
+				n_prev= psi_desc_llist_seek_tag(n_prev, tag);
+				n_curr= psi_desc_llist_seek_tag(n_curr, tag);
+				if(n_prev== NULL || n_curr== NULL ||
+						psi_desc_ctx_cmp(n_prev->data, n_curr->data)!= 0)
+					break;
+			}
+			if(n_prev!= NULL || n_curr!= NULL) {
+				desc_tag_bitmap[tag>> 6]|= (uint64_t)1<< (tag& 63);
+				diff_cnt++;
+			}
+		}
+	}
+	return diff_cnt;
+}
+
+/**
+ * Walk the specific data of an arena allocated section (see
+ * 'psi_section_ctx_allocate_arena()'), applying the given function to each
+ * descriptor. If 'delta' is non-zero, the data and list pointers are
+ * relocated by 'delta' bytes on the way (block copy of the arena; see
+ * 'psi_section_ctx_dup()').
+ */
+static void psi_section_ctx_arena_walk(psi_section_ctx_t *psi_section_ctx,
+		ptrdiff_t delta, psi_arena_desc_fxn_t psi_arena_desc_fxn)
+{
+	llist_t *n;
+
+	ARENA_RELOCATE(psi_section_ctx->data, delta);
+	if(psi_section_ctx->data== NULL)
+		return;
+
+	switch(psi_section_ctx->table_id) {
+	case PSI_TABLE_PROGRAM_ASSOCIATION_SECTION:
+		psi_arena_llist_walk(&((psi_pas_ctx_t*)psi_section_ctx->data)->
+				psi_pas_prog_ctx_llist, delta, NULL);
+		break;
+	case PSI_TABLE_TS_PROGRAM_MAP_SECTION:
+	{
+		psi_pms_ctx_t *psi_pms_ctx= (psi_pms_ctx_t*)psi_section_ctx->data;
+		psi_arena_llist_walk(&psi_pms_ctx->psi_desc_ctx_llist, delta,
+				psi_arena_desc_fxn);
+		psi_arena_llist_walk(&psi_pms_ctx->psi_pms_es_ctx_llist, delta, NULL);
+		for(n= psi_pms_ctx->psi_pms_es_ctx_llist; n!= NULL; n= n->next)
+			psi_arena_llist_walk(&((psi_pms_es_ctx_t*)n->data)->
+					psi_desc_ctx_llist, delta, psi_arena_desc_fxn);
+		break;
+	}
+	case PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL:
+	{
+		psi_dvb_sds_ctx_t *psi_dvb_sds_ctx=
+				(psi_dvb_sds_ctx_t*)psi_section_ctx->data;
+		psi_arena_llist_walk(&psi_dvb_sds_ctx->psi_dvb_sds_prog_ctx_llist,
+				delta, NULL);
+		for(n= psi_dvb_sds_ctx->psi_dvb_sds_prog_ctx_llist; n!= NULL;
+				n= n->next)
+			psi_arena_llist_walk(&((psi_dvb_sds_prog_ctx_t*)n->data)->
+					psi_desc_ctx_llist, delta, psi_arena_desc_fxn);
+		break;
+	}
+	default:
+		LOGE("Unknown PSI section type (table id: %u)\n",
+				psi_section_ctx->table_id);
+		break;
+	}
+}
+
+/**
+ * Relocate the nodes and data pointers of an arena allocated list by
+ * 'delta' bytes (if non-zero), and apply the given function (if any) to
+ * each node data (descriptor).
+ */
+static void psi_arena_llist_walk(llist_t **ref_llist, ptrdiff_t delta,
+		psi_arena_desc_fxn_t psi_arena_desc_fxn)
+{
+	llist_t **ref_n;
+
+	for(ref_n= ref_llist; *ref_n!= NULL; ref_n= &(*ref_n)->next) {
+		ARENA_RELOCATE(*ref_n, delta);
+		ARENA_RELOCATE((*ref_n)->data, delta);
+		if(psi_arena_desc_fxn!= NULL)
+			psi_arena_desc_fxn((psi_desc_ctx_t*)(*ref_n)->data, delta);
+	}
+}
+
+/**
+ * Relocate the raw data of a copied arena descriptor. Data decoded on
+ * demand belongs to the original descriptor, thus it is not kept (it will
+ * be decoded again on demand).
+ */
+static void psi_arena_desc_relocate(psi_desc_ctx_t *psi_desc_ctx,
+		ptrdiff_t delta)
+{
+	const uint8_t *raw= psi_desc_ctx->raw;
+
+	psi_desc_ctx->data= (psi_desc_ctx->data!= NULL &&
+			psi_desc_ctx->data== (void*)raw)? (void*)(raw+ delta): NULL;
+	ARENA_RELOCATE(psi_desc_ctx->raw, delta);
+}
+
+/**
+ * Release the data decoded on demand of an arena descriptor.
+ */
+static void psi_arena_desc_release_data(psi_desc_ctx_t *psi_desc_ctx,
+		ptrdiff_t delta)
+{
+	psi_desc_ctx_release_data(psi_desc_ctx);
+}
@@ -82,6 +82,39 @@
 #define PSI_TABLE_MAX_SECTION_LEN 4096
 #define PSI_TABLE_MPEG_MAX_SECTION_LEN 1024
 
+/**
+ * Alignment of the section arena allocations in bytes
+ * (see 'psi_section_ctx_allocate_arena()').
+ */
+#define PSI_SECTION_ARENA_ALIGN 16 // CTX_S_BASE_ALIGN
+
+/**
+ * Size in bytes taken in a section arena by an object of the given size.
+ */
+#define PSI_SECTION_ARENA_SIZEOF(SIZE) ((((SIZE)+ PSI_SECTION_ARENA_ALIGN- 1)/ \
+		PSI_SECTION_ARENA_ALIGN)* PSI_SECTION_ARENA_ALIGN)
+
+/**
+ * Allocate a section specific data structure of type 'TYPE' from the given
+ * section arena, or using 'ALLOCATE_FXN()' if 'ARENA' is NULL.
+ */
+#define PSI_SECTION_ARENA_ALLOC(ARENA, TYPE, ALLOCATE_FXN) \
+	((ARENA)!= NULL? (TYPE*)psi_section_ctx_arena_calloc((ARENA), \
+			sizeof(TYPE)): ALLOCATE_FXN())
+
+/**
+ * 'llist_push()' and 'llist_insert_nth()' counterparts allocating the list
+ * node from the given section arena (the list API is used if 'ARENA' is
+ * NULL).
+ */
+#define PSI_SECTION_ARENA_LLIST_PUSH(ARENA, REF_LLIST, DATA) \
+	((ARENA)!= NULL? psi_section_ctx_arena_llist_insert_nth((ARENA), \
+			(REF_LLIST), 0, (DATA)): llist_push((REF_LLIST), (DATA)))
+#define PSI_SECTION_ARENA_LLIST_INSERT_NTH(ARENA, REF_LLIST, NTH, DATA) \
+	((ARENA)!= NULL? psi_section_ctx_arena_llist_insert_nth((ARENA), \
+			(REF_LLIST), (NTH), (DATA)): \
+			llist_insert_nth((REF_LLIST), (NTH), (DATA)))
+
 /* Forward declarations */
 typedef struct psi_desc_ctx_s psi_desc_ctx_t;
 typedef struct llist_s llist_t;
@@ -184,6 +217,25 @@ typedef struct psi_section_ctx_s {
 	 */
 	uint32_t crc_32;
 
+	/**
+	 * Number of extra references held on this section (zero if it has a
+	 * single owner); see 'psi_section_ctx_ref()'.
+	 * A section shared by means of references is immutable.
+	 */
+	volatile int refs;
+
+	/**
+	 * Size in bytes of the memory block (arena) holding this structure
+	 * followed by all the section specific data, or zero if the section
+	 * specific data is allocated node by node
+	 * (see 'psi_section_ctx_allocate_arena()').
+	 */
+	size_t arena_size;
+	/**
+	 * Number of arena bytes already in use.
+	 */
+	size_t arena_used;
+
 } psi_section_ctx_t;
 
 /**
@@ -292,6 +344,89 @@ typedef struct psi_pms_ctx_s {
 	uint32_t crc_32;
 } psi_pms_ctx_t;
 
+/**
+ * Program Map Section structural differences flags
+ * (see 'psi_pms_ctx_diff()').
+ */
+/**
+ * PCR_PID value changed.
+ */
+#define PSI_PMS_DIFF_PCR_PID (1<< 0)
+/**
+ * Program information descriptors changed.
+ */
+#define PSI_PMS_DIFF_PROGRAM_DESC (1<< 1)
+/**
+ * Elementary stream entry added.
+ */
+#define PSI_PMS_DIFF_ES_ADDED (1<< 2)
+/**
+ * Elementary stream entry removed.
+ */
+#define PSI_PMS_DIFF_ES_REMOVED (1<< 3)
+/**
+ * Elementary stream entry 'stream_type' changed.
+ */
+#define PSI_PMS_DIFF_ES_STREAM_TYPE (1<< 4)
+/**
+ * Elementary stream information descriptors changed.
+ */
+#define PSI_PMS_DIFF_ES_DESC (1<< 5)
+
+/**
+ * Difference of an elementary stream entry between two Program Map
+ * Sections (see 'psi_pms_ctx_diff()').
+ */
+typedef struct psi_pms_es_diff_ctx_s {
+	/**
+	 * Elementary stream PID (identifies the entry in both sections).
+	 */
+	uint16_t elementary_PID;
+	/**
+	 * Difference flags: 'PSI_PMS_DIFF_ES_ADDED', 'PSI_PMS_DIFF_ES_REMOVED'
+	 * or any combination of 'PSI_PMS_DIFF_ES_STREAM_TYPE' and
+	 * 'PSI_PMS_DIFF_ES_DESC' for modified entries.
+	 */
+	uint32_t flags;
+	/**
+	 * Stream type in the previous section (not valid if entry was added).
+	 */
+	uint8_t stream_type_prev;
+	/**
+	 * Stream type in the new section (not valid if entry was removed).
+	 */
+	uint8_t stream_type;
+	/**
+	 * Bitmap of descriptor tags for which descriptors were added, removed or
+	 * modified (bit 'tag' is set in 'desc_tag_bitmap[tag>> 6]').
+	 */
+	uint64_t desc_tag_bitmap[4];
+} psi_pms_es_diff_ctx_t;
+
+/**
+ * Structural differences between two Program Map Sections
+ * (see 'psi_pms_ctx_diff()').
+ */
+typedef struct psi_pms_diff_ctx_s {
+	/**
+	 * Combination of all the differences flags found
+	 * ('PSI_PMS_DIFF_XXX'); zero if sections are structurally equal.
+	 */
+	uint32_t flags;
+	/**
+	 * Bitmap of program information descriptor tags for which descriptors
+	 * were added, removed or modified (see
+	 * 'psi_pms_es_diff_ctx_t::desc_tag_bitmap').
+	 */
+	uint64_t desc_tag_bitmap[4];
+	/**
+	 * List of differences of elementary stream entries
+	 * (type 'psi_pms_es_diff_ctx_t'). Only added, removed or modified
+	 * entries are listed; removed entries are listed first.
+	 */
+	llist_t *psi_pms_es_diff_ctx_llist;
+} psi_pms_diff_ctx_t;
+
 /* **** Prototypes **** */
 
 /**
@@ -300,11 +435,76 @@ typedef struct psi_pms_ctx_s {
 psi_section_ctx_t* psi_section_ctx_allocate();
 
 /**
- * //TODO
+ * Allocate a section context structure at the beginning of a memory block
+ * (arena) of the given size. The section specific data (structures, list
+ * nodes and descriptors) is then allocated from the arena (see
+ * 'psi_section_ctx_arena_calloc()'), so the whole section is released with a
+ * single 'free()' and duplicated with a single block copy.
+ * The section decoder sizes the arena from the section layout
+ * (see 'psi_dec_section()').
+ * The lists of an arena allocated section can not be modified (nodes can
+ * not be added or removed); use 'psi_section_ctx_dup_nodes()' to get a
+ * modifiable copy.
+ * @param arena_size Arena size in bytes, including the section context
+ * structure itself.
+ * @return Section context structure, NULL if fails.
+ */
+psi_section_ctx_t* psi_section_ctx_allocate_arena(size_t arena_size);
+
+/**
+ * Allocate zeroed memory from the arena of the given section
+ * (see 'psi_section_ctx_allocate_arena()'). Arena memory is not released
+ * on its own, but with the section.
+ * @param psi_section_ctx Arena allocated section context structure.
+ * @param size Size in bytes.
+ * @return Pointer to the allocated memory, NULL if the arena is exhausted.
+ */
+void* psi_section_ctx_arena_calloc(psi_section_ctx_t *psi_section_ctx,
+		size_t size);
+
+/**
+ * Insert data in a list at the given position (as 'llist_insert_nth()'),
+ * allocating the list node from the arena of the given section
+ * (see 'psi_section_ctx_allocate_arena()').
+ * @param psi_section_ctx Arena allocated section context structure.
+ * @param ref_llist Reference to the list head pointer.
+ * @param nth Position (zero is the list head; the data is appended if the
+ * list is shorter).
+ * @param data Data to insert.
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
+ */
+int psi_section_ctx_arena_llist_insert_nth(psi_section_ctx_t *psi_section_ctx,
+		llist_t **ref_llist, int nth, void *data);
+
+/**
+ * Duplicate section. Arena allocated sections are duplicated with a single
+ * block copy (internal pointers are relocated), thus the copy is also arena
+ * allocated (see 'psi_section_ctx_allocate_arena()').
+ * @param psi_section_ctx PSI section context structure.
+ * @return Section copy, NULL if fails.
  */
 psi_section_ctx_t* psi_section_ctx_dup(
 		const psi_section_ctx_t* psi_section_ctx);
 
+/**
+ * Duplicate section node by node: the copy is not arena allocated, thus its
+ * lists can be modified.
+ * @param psi_section_ctx PSI section context structure.
+ * @return Section copy, NULL if fails.
+ */
+psi_section_ctx_t* psi_section_ctx_dup_nodes(
+		const psi_section_ctx_t* psi_section_ctx);
+
+/**
+ * Get a new reference to the given section (no copy is performed).
+ * The section must be treated as immutable from then on; each reference is
+ * released using 'psi_section_ctx_release()' (the section is actually freed
+ * when its last reference is released).
+ * @param psi_section_ctx PSI section context structure.
+ * @return The same pointer given as argument.
+ */
+psi_section_ctx_t* psi_section_ctx_ref(psi_section_ctx_t *psi_section_ctx);
+
 /**
  * //TODO
  */
@@ -378,6 +578,27 @@ psi_pms_ctx_t* psi_pms_ctx_dup(const psi_pms_ctx_t* psi_pms_ctx);
 psi_pms_es_ctx_t* psi_pms_ctx_filter_es_pid(const psi_pms_ctx_t *psi_pms_ctx,
 		uint16_t es_pid);
 
+/**
+ * Get the structural differences between two Program Map Sections:
+ * elementary stream entries added, removed or modified (stream type or
+ * descriptors), PCR_PID and program descriptors changes.
+ * Elementary stream entries are matched by their PID.
+ * @param psi_pms_ctx_prev Previous PMS context structure; may be NULL (all
+ * the elementary streams of the new section are reported as added).
+ * @param psi_pms_ctx New PMS context structure.
+ * @return Differences context structure (to be released using
+ * 'psi_pms_diff_ctx_release()'), NULL if fails.
+ */
+psi_pms_diff_ctx_t* psi_pms_ctx_diff(const psi_pms_ctx_t *psi_pms_ctx_prev,
+		const psi_pms_ctx_t *psi_pms_ctx);
+
+/**
+ * Release PMS differences context structure.
+ * @param ref_psi_pms_diff_ctx Reference to the pointer to the structure to
+ * be released. Pointer is set to NULL on return.
+ */
+void psi_pms_diff_ctx_release(psi_pms_diff_ctx_t **ref_psi_pms_diff_ctx);
+
 /**
  * //TODO
  */
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file psi_crc.c
+ * @author Rafael Antoniello
+ */
+
+#include "psi_crc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define PSI_CRC32_HAVE_CLMUL
+#endif
+
+/* **** Definitions **** */
+
+/**
+ * CRC-32/MPEG-2 generator polynomial (x^32 term implicit).
+ */
+#define PSI_CRC32_POLY 0x04C11DB7
+
+/**
+ * Minimum buffer size to use the carry-less multiplication kernel
+ * (four 16-byte folding accumulators).
+ */
+#define CLMUL_MIN_SIZE 64
+
+/**
+ * Type of the CRC kernel functions.
+ */
+typedef uint32_t (*crc32_kernel_fxn_t)(uint32_t crc, const uint8_t *buf,
+		size_t size);
+
+/**
+ * Slicing-by-8 tables; 'crc_table[0]' is the standard byte-by-byte table.
+ * Initialized once (see 'psi_crc32_init()').
+ */
+static uint32_t crc_table[8][256];
+
+/**
+ * Folding constants for the carry-less multiplication kernel: (x^n mod P)
+ * for n= 128+ 64, 128, 512+ 64 and 512.
+ */
+static uint64_t k_fold1_hi, k_fold1_lo, k_fold4_hi, k_fold4_lo;
+
+/**
+ * Fastest kernel supported by the running CPU.
+ */
+static psi_crc32_kernel_t crc32_kernel_auto= PSI_CRC32_KERNEL_SCALAR;
+
+static pthread_once_t crc32_init_once= PTHREAD_ONCE_INIT;
+
+/* **** Prototypes **** */
+
+static void psi_crc32_init();
+static uint32_t multmodp(uint32_t a, uint32_t b);
+static uint32_t xnmodp(uint64_t n);
+static uint32_t crc32_scalar(uint32_t crc, const uint8_t *buf, size_t size);
+static uint32_t crc32_slice8(uint32_t crc, const uint8_t *buf, size_t size);
+#ifdef PSI_CRC32_HAVE_CLMUL
+static uint32_t crc32_clmul(uint32_t crc, const uint8_t *buf, size_t size);
+#endif
+static crc32_kernel_fxn_t crc32_kernel_get(psi_crc32_kernel_t kernel);
+
+/* **** Implementations **** */
+
+uint32_t psi_crc32(const uint8_t *buf, size_t size)
+{
+	return psi_crc32_update(PSI_CRC32_INIT, buf, size);
+}
+
+uint32_t psi_crc32_update(uint32_t crc, const uint8_t *buf, size_t size)
+{
+	return psi_crc32_update_kernel(PSI_CRC32_KERNEL_AUTO, crc, buf, size);
+}
+
+uint32_t psi_crc32_update_kernel(psi_crc32_kernel_t kernel, uint32_t crc,
+		const uint8_t *buf, size_t size)
+{
+	if(buf== NULL || size== 0)
+		return crc;
+
+	pthread_once(&crc32_init_once, psi_crc32_init);
+
+	if(!psi_crc32_kernel_is_supported(kernel))
+		kernel= PSI_CRC32_KERNEL_SCALAR;
+	return crc32_kernel_get(kernel)(crc, buf, size);
+}
+
+int psi_crc32_kernel_is_supported(psi_crc32_kernel_t kernel)
+{
+	pthread_once(&crc32_init_once, psi_crc32_init);
+
+	switch(kernel) {
+	case PSI_CRC32_KERNEL_AUTO:
+	case PSI_CRC32_KERNEL_SCALAR:
+	case PSI_CRC32_KERNEL_SLICE8:
+		return 1;
+	case PSI_CRC32_KERNEL_CLMUL:
+		return crc32_kernel_auto== PSI_CRC32_KERNEL_CLMUL;
+	default:
+		break;
+	}
+	return 0;
+}
+
+const char* psi_crc32_kernel_get_name(psi_crc32_kernel_t kernel)
+{
+	switch(kernel) {
+	case PSI_CRC32_KERNEL_AUTO:
+		return "auto";
+	case PSI_CRC32_KERNEL_SCALAR:
+		return "scalar";
+	case PSI_CRC32_KERNEL_SLICE8:
+		return "slice8";
+	case PSI_CRC32_KERNEL_CLMUL:
+		return "clmul";
+	default:
+		break;
+	}
+	return "unknown";
+}
+
+uint32_t psi_crc32_patch(uint32_t crc, size_t size, size_t offset,
+		const uint8_t *old_buf, const uint8_t *new_buf, size_t count)
+{
+	size_t i;
+	uint32_t crc_delta= 0;
+
+	if(old_buf== NULL || new_buf== NULL || count== 0 ||
+			offset+ count> size)
+		return crc;
+
+	pthread_once(&crc32_init_once, psi_crc32_init);
+
+	/* The CRC is affine in the message bits: the CRC of the modified
+	 * message is the original CRC plus the (zero-initialized) CRC of the
+	 * difference, the latter being extended with the bytes that follow the
+	 * modified ones (multiplying by x^(8* n) modulo the polynomial).
+	 */
+	for(i= 0; i< count; i++)
+		crc_delta= (crc_delta<< 8)^ crc_table[0][(crc_delta>> 24)^
+				(old_buf[i]^ new_buf[i])];
+	return crc^ multmodp(crc_delta, xnmodp((uint64_t)(size- offset- count)*
+			8));
+}
+
+/**
+ * Initialize CRC tables, folding constants and kernel selection.
+ */
+static void psi_crc32_init()
+{
+	int i, k;
+
+	/* Byte-by-byte table */
+	for(i= 0; i< 256; i++) {
+		uint32_t c= (uint32_t)i<< 24;
+		for(k= 0; k< 8; k++)
+			c= (c& 0x80000000)? (c<< 1)^ PSI_CRC32_POLY: (c<< 1);
+		crc_table[0][i]= c;
+	}
+
+	/* Slicing-by-8 tables: 'crc_table[k][i]' is the CRC contribution of
+	 * byte 'i' followed by 'k' zero bytes.
+	 */
+	for(k= 1; k< 8; k++) {
+		for(i= 0; i< 256; i++) {
+			uint32_t c= crc_table[k- 1][i];
+			crc_table[k][i]= (c<< 8)^ crc_table[0][c>> 24];
+		}
+	}
+
+	/* Carry-less multiplication folding constants */
+	k_fold1_hi= xnmodp(128+ 64);
+	k_fold1_lo= xnmodp(128);
+	k_fold4_hi= xnmodp(512+ 64);
+	k_fold4_lo= xnmodp(512);
+
+	/* Select fastest kernel supported */
+	crc32_kernel_auto= PSI_CRC32_KERNEL_SLICE8;
+#ifdef PSI_CRC32_HAVE_CLMUL
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3"))
+		crc32_kernel_auto= PSI_CRC32_KERNEL_CLMUL;
+#endif
+}
+
+/**
+ * Multiply polynomials 'a' and 'b' modulo the CRC polynomial (bit n is the
+ * coefficient of x^n).
+ */
+static uint32_t multmodp(uint32_t a, uint32_t b)
+{
+	int i;
+	uint32_t p= 0;
+
+	for(i= 31; i>= 0; i--) {
+		p= (p& 0x80000000)? (p<< 1)^ PSI_CRC32_POLY: (p<< 1);
+		if(a& ((uint32_t)1<< i))
+			p^= b;
+	}
+	return p;
+}
+
+/**
+ * Compute x^n modulo the CRC polynomial.
+ */
+static uint32_t xnmodp(uint64_t n)
+{
+	uint32_t p= 1, x2k= 2; // x^0 and x^(2^0)
+
+	for(; n!= 0; n>>= 1) {
+		if(n& 1)
+			p= multmodp(p, x2k);
+		x2k= multmodp(x2k, x2k);
+	}
+	return p;
+}
+
+/**
+ * Scalar reference kernel (byte-by-byte table).
+ */
+static uint32_t crc32_scalar(uint32_t crc, const uint8_t *buf, size_t size)
+{
+	while(size--> 0)
+		crc= (crc<< 8)^ crc_table[0][(crc>> 24)^ *buf++];
+	return crc;
+}
+
+/**
+ * Slicing-by-8 kernel.
+ */
+static uint32_t crc32_slice8(uint32_t crc, const uint8_t *buf, size_t size)
+{
+	while(size>= 8) {
+		uint32_t a= crc^ (((uint32_t)buf[0]<< 24)| ((uint32_t)buf[1]<< 16)|
+				((uint32_t)buf[2]<< 8)| (uint32_t)buf[3]);
+		crc= crc_table[7][a>> 24]^ crc_table[6][(a>> 16)& 0xFF]^
+				crc_table[5][(a>> 8)& 0xFF]^ crc_table[4][a& 0xFF]^
+				crc_table[3][buf[4]]^ crc_table[2][buf[5]]^
+				crc_table[1][buf[6]]^ crc_table[0][buf[7]];
+		buf+= 8;
+		size-= 8;
+	}
+	return crc32_scalar(crc, buf, size);
+}
+
+#ifdef PSI_CRC32_HAVE_CLMUL
+/**
+ * Fold 128-bit remainder 'r' over next 128 bits: r* x^(n) + 'next', being
+ * 'k' the pair of constants {x^(n+ 64) mod P, x^n mod P}.
+ */
+#define CLMUL_FOLD(r, k, next) \
+	_mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128((r), (k), 0x11), \
+			_mm_clmulepi64_si128((r), (k), 0x00)), (next))
+
+/**
+ * Carry-less multiplication (PCLMULQDQ) folding kernel.
+ * Message blocks of 16 bytes are loaded byte-reversed, so the 128-bit
+ * register holds the block polynomial with the first message bit as the
+ * highest degree coefficient. Four accumulators are folded in parallel
+ * over 64-byte strides, then combined into one; the final 128-bit remainder
+ * (congruent to the message polynomial) is reduced using the table kernel.
+ */
+__attribute__((target("pclmul,ssse3")))
+static uint32_t crc32_clmul(uint32_t crc, const uint8_t *buf, size_t size)
+{
+	int i;
+	__m128i x0, x1, x2, x3, k;
+	uint8_t rem[16];
+	const __m128i bswap= _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+			12, 13, 14, 15);
+
+	if(size< CLMUL_MIN_SIZE)
+		return crc32_slice8(crc, buf, size);
+
+	/* Load first 64 bytes; the initial CRC value is added to the first 32
+	 * message bits.
+	 */
+	x0= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf+ 0)), bswap);
+	x1= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf+ 16)), bswap);
+	x2= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf+ 32)), bswap);
+	x3= _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf+ 48)), bswap);
+	x0= _mm_xor_si128(x0, _mm_set_epi32((int)crc, 0, 0, 0));
+	buf+= 64;
+	size-= 64;
+
+	/* Fold by 4 */
+	k= _mm_set_epi64x((long long)k_fold4_hi, (long long)k_fold4_lo);
+	while(size>= 64) {
+		x0= CLMUL_FOLD(x0, k, _mm_shuffle_epi8(_mm_loadu_si128(
+				(const __m128i*)(buf+ 0)), bswap));
+		x1= CLMUL_FOLD(x1, k, _mm_shuffle_epi8(_mm_loadu_si128(
+				(const __m128i*)(buf+ 16)), bswap));
+		x2= CLMUL_FOLD(x2, k, _mm_shuffle_epi8(_mm_loadu_si128(
+				(const __m128i*)(buf+ 32)), bswap));
+		x3= CLMUL_FOLD(x3, k, _mm_shuffle_epi8(_mm_loadu_si128(
+				(const __m128i*)(buf+ 48)), bswap));
+		buf+= 64;
+		size-= 64;
+	}
+
+	/* Combine accumulators and fold by 1 the remaining 16-byte blocks */
+	k= _mm_set_epi64x((long long)k_fold1_hi, (long long)k_fold1_lo);
+	x0= CLMUL_FOLD(x0, k, x1);
+	x0= CLMUL_FOLD(x0, k, x2);
+	x0= CLMUL_FOLD(x0, k, x3);
+	while(size>= 16) {
+		x0= CLMUL_FOLD(x0, k, _mm_shuffle_epi8(_mm_loadu_si128(
+				(const __m128i*)buf), bswap));
+		buf+= 16;
+		size-= 16;
+	}
+
+	/* Reduce the 128-bit remainder and process the tail bytes */
+	_mm_storeu_si128((__m128i*)rem, _mm_shuffle_epi8(x0, bswap));
+	crc= 0;
+	for(i= 0; i< 16; i+= 8)
+		crc= crc32_slice8(crc, &rem[i], 8);
+	return crc32_slice8(crc, buf, size);
+}
+#endif
+
+/**
+ * Get kernel function.
+ */
+static crc32_kernel_fxn_t crc32_kernel_get(psi_crc32_kernel_t kernel)
+{
+	if(kernel== PSI_CRC32_KERNEL_AUTO)
+		kernel= crc32_kernel_auto;
+
+	switch(kernel) {
+	case PSI_CRC32_KERNEL_SLICE8:
+		return crc32_slice8;
+#ifdef PSI_CRC32_HAVE_CLMUL
+	case PSI_CRC32_KERNEL_CLMUL:
+		return crc32_clmul;
+#endif
+	default:
+		break;
+	}
+	return crc32_scalar;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file psi_crc.h
+ * @brief CRC-32/MPEG-2 computation module (ISO/IEC 13818-1, Annex B).
+ * Polynomial 0x04C11DB7, initial value 0xFFFFFFFF, non-reflected input and
+ * output and no final XOR. A PSI section including its 'CRC_32' field
+ * yields a zero CRC.
+ * <br>
+ * Several kernels are provided: a bit-exact scalar reference
+ * (byte-by-byte table), a slicing-by-8 kernel and, on x86-64 CPUs
+ * supporting it, a carry-less multiplication (PCLMULQDQ) folding kernel.
+ * The fastest kernel supported by the running CPU is selected at run-time.
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_PSI_CRC_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_PSI_CRC_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/**
+ * CRC-32/MPEG-2 initial value.
+ */
+#define PSI_CRC32_INIT 0xFFFFFFFF
+
+/**
+ * CRC-32 kernels enumeration.
+ */
+typedef enum psi_crc32_kernel_enum {
+	PSI_CRC32_KERNEL_AUTO= 0, ///< Fastest kernel supported by the CPU
+	PSI_CRC32_KERNEL_SCALAR, ///< Byte-by-byte table (reference)
+	PSI_CRC32_KERNEL_SLICE8, ///< Slicing-by-8 tables
+	PSI_CRC32_KERNEL_CLMUL, ///< Carry-less multiplication folding (x86-64)
+	PSI_CRC32_KERNEL_ENUM_MAX
+} psi_crc32_kernel_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Compute the CRC-32/MPEG-2 of the given buffer using the fastest kernel.
+ * @param buf Data buffer.
+ * @param size Size of the data buffer in bytes.
+ * @return The CRC-32 value.
+ */
+uint32_t psi_crc32(const uint8_t *buf, size_t size);
+
+/**
+ * Incremental CRC-32/MPEG-2 computation: continue computing the CRC of a
+ * message given the CRC of the previous part of it.
+ * 'psi_crc32_update(PSI_CRC32_INIT, buf, size)' is equivalent to
+ * 'psi_crc32(buf, size)'.
+ * @param crc CRC value of the previous part of the message.
+ * @param buf Data buffer (next part of the message).
+ * @param size Size of the data buffer in bytes.
+ * @return The updated CRC-32 value.
+ */
+uint32_t psi_crc32_update(uint32_t crc, const uint8_t *buf, size_t size);
+
+/**
+ * Same as 'psi_crc32_update()' but using the specified kernel.
+ * @param kernel Kernel to be used (should be supported by the CPU; see
+ * 'psi_crc32_kernel_is_supported()'). If the kernel is not supported, the
+ * scalar reference is used.
+ * @param crc CRC value of the previous part of the message.
+ * @param buf Data buffer.
+ * @param size Size of the data buffer in bytes.
+ * @return The updated CRC-32 value.
+ */
+uint32_t psi_crc32_update_kernel(psi_crc32_kernel_t kernel, uint32_t crc,
+		const uint8_t *buf, size_t size);
+
+/**
+ * Check if given kernel is supported by the running CPU.
+ * @param kernel Kernel identifier.
+ * @return Non-zero if supported, zero otherwise.
+ */
+int psi_crc32_kernel_is_supported(psi_crc32_kernel_t kernel);
+
+/**
+ * Get kernel name string (e.g. for tracing purposes).
+ * @param kernel Kernel identifier.
+ * @return Kernel name; "unknown" if the identifier is not valid.
+ */
+const char* psi_crc32_kernel_get_name(psi_crc32_kernel_t kernel);
+
+/**
+ * Patch the CRC-32/MPEG-2 of a message when some of its bytes are modified
+ * (e.g. a PSI section version bump), without recomputing the whole CRC.
+ * The cost is proportional to the number of modified bytes (plus a
+ * logarithmic term in the message size).
+ * @param crc CRC value of the original message.
+ * @param size Size of the whole message in bytes.
+ * @param offset Offset of the modified bytes within the message.
+ * @param old_buf Original bytes.
+ * @param new_buf New bytes.
+ * @param count Number of modified bytes.
+ * @return The CRC-32 of the modified message.
+ */
+uint32_t psi_crc32_patch(uint32_t crc, size_t size, size_t offset,
+		const uint8_t *old_buf, const uint8_t *new_buf, size_t count);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_PSI_CRC_H_ */
@@ -33,8 +33,9 @@
 #include <libmediaprocsutils/bitparser.h>
 #include <libmediaprocsutils/fifo.h>
 #include <libmediaprocsutils/llist.h>
-#include <libmediaprocsutils/crc_32_mpeg2.h>
 #include "psi.h"
+#include "psi_crc.h"
+#include "psi_filter.h"
 #include "psi_dvb.h"
 #include "psi_dvb_dec.h"
 #include "psi_desc.h"
@@ -49,61 +50,146 @@
 
 /* **** Prototypes **** */
 
+static psi_dec_fp_t* psi_dec_fp_lookup(psi_dec_fp_ctx_t *psi_dec_fp_ctx,
+		const uint8_t *buf, size_t buf_size);
+static void psi_dec_fp_register(psi_dec_fp_ctx_t *psi_dec_fp_ctx,
+		psi_section_ctx_t *psi_section_ctx);
+static int psi_dec_sect_feed(psi_dec_sect_ctx_t *psi_dec_sect_ctx,
+		const uint8_t *data, size_t data_size, log_ctx_t *log_ctx);
+static size_t psi_dec_ts_payload(const uint8_t *pkt,
+		const uint8_t **ref_payload);
+static size_t psi_dec_arena_size(const uint8_t *buf, size_t buf_size);
+static size_t psi_dec_arena_size_desc(const uint8_t *p, size_t size);
+
 /* PAS specific data */
 static psi_pas_ctx_t* psi_dec_pas(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, size_t size);
+		bitparser_ctx_t *bitparser_ctx, size_t size,
+		psi_section_ctx_t *psi_section_ctx_arena);
 
 /* PMS specific */
 static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size);
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size,
+		psi_section_ctx_t *psi_section_ctx_arena);
 
 /* **** Implementations **** */
 
-int psi_dec_get_next_section(fifo_ctx_t* ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_tscc, uint16_t pid,
+int psi_dec_sect_ctx_init(psi_dec_sect_ctx_t *psi_dec_sect_ctx)
+{
+	const size_t buf_size= EXTEND_SIZE_TO_MULTIPLE(PSI_TABLE_MAX_SECTION_LEN,
+			CTX_S_BASE_ALIGN);
+	LOG_CTX_INIT(NULL);
+
+	CHECK_DO(psi_dec_sect_ctx!= NULL, return STAT_ERROR);
+
+	memset(psi_dec_sect_ctx, 0, sizeof(psi_dec_sect_ctx_t));
+
+	/* Allocate reassembly buffer.
+	 * NOTE: Due to parsing performance reasons, the bit-parser works with
+	 * buffer sizes multiple of sizeof(WORD_T) bytes, and may overrun the
+	 * section end (see 'psi_dec_section()').
+	 */
+	CHECK_DO(SIZE_IS_MULTIPLE(buf_size, sizeof(WORD_T)), return STAT_ERROR);
+	CHECK_DO(posix_memalign((void**)&psi_dec_sect_ctx->buf, CTX_S_BASE_ALIGN,
+			buf_size)== 0 && psi_dec_sect_ctx->buf!= NULL, return STAT_ENOMEM);
+	memset(psi_dec_sect_ctx->buf, 0xFF, buf_size);
+	return STAT_SUCCESS;
+}
+
+void psi_dec_sect_ctx_deinit(psi_dec_sect_ctx_t *psi_dec_sect_ctx)
+{
+	if(psi_dec_sect_ctx== NULL)
+		return;
+
+	if(psi_dec_sect_ctx->buf!= NULL) {
+		free(psi_dec_sect_ctx->buf);
+		psi_dec_sect_ctx->buf= NULL;
+	}
+	psi_dec_sect_ctx->size= 0;
+	psi_dec_sect_ctx->flag_sync= 0;
+	psi_dec_sect_ctx->remainder_size= 0;
+	psi_dec_sect_ctx->pkt= NULL;
+	psi_dec_sect_ctx->filter_list= NULL;
+}
+
+void psi_dec_fp_ctx_init(psi_dec_fp_ctx_t *psi_dec_fp_ctx)
+{
+	if(psi_dec_fp_ctx== NULL)
+		return;
+	memset(psi_dec_fp_ctx, 0, sizeof(psi_dec_fp_ctx_t));
+}
+
+void psi_dec_fp_ctx_deinit(psi_dec_fp_ctx_t *psi_dec_fp_ctx)
+{
+	int i;
+
+	if(psi_dec_fp_ctx== NULL)
+		return;
+
+	for(i= 0; i< PSI_DEC_FP_CACHE_SIZE; i++)
+		psi_section_ctx_release(&psi_dec_fp_ctx->fp_array[i].psi_section_ctx);
+	psi_dec_fp_ctx_init(psi_dec_fp_ctx);
+}
+
+int psi_dec_section_fp(uint8_t *buf, size_t buf_size, uint16_t pid,
+		psi_dec_fp_ctx_t *ref_fp_ctx, log_ctx_t *log_ctx,
 		psi_section_ctx_t **ref_psi_section_ctx)
 {
 	int ret_code, end_code= STAT_ERROR;
-	void *sect_buf= NULL;
-	size_t sect_buf_size= 0;
 	psi_section_ctx_t *psi_section_ctx= NULL;
+	psi_dec_fp_t *psi_dec_fp= NULL; // Do not release (alias)
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments.
-	 * Note: argument 'log_ctx' is allowed to be 'NULL'.
+	 * Note: arguments 'ref_fp_ctx' and 'log_ctx' are allowed to be 'NULL'.
 	 */
-	CHECK_DO(ififo_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(buf!= NULL, return STAT_ERROR);
 	CHECK_DO(ref_psi_section_ctx!= NULL, return STAT_ERROR);
 
 	*ref_psi_section_ctx= NULL;
 
-	/* Get complete section in buffer */
-	ret_code= psi_dec_read_next_section(ififo_ctx, log_ctx, ref_tscc,
-			&sect_buf, &sect_buf_size);
-	if(ret_code!= STAT_SUCCESS) {
-		if(ret_code== STAT_EOF) end_code= ret_code;
+	/* Sections not applicable yet ('current_next_indicator'== 0) are
+	 * skipped before fingerprinting and decoding: they are not accepted
+	 * (and thus never registered as fingerprint) and should not be
+	 * decoded again each time they are re-sent.
+	 */
+	if(buf_size> 5 && (buf[1]& 0x80)!= 0 && (buf[5]& 0x01)== 0) {
+		end_code= STAT_ENODATA;
+		goto end;
+	}
+
+	/* Check raw section fingerprint: if this section is a repetition of the
+	 * last accepted one, skip decoding and return the already decoded
+	 * section.
+	 */
+	if(ref_fp_ctx!= NULL && (psi_dec_fp= psi_dec_fp_lookup(ref_fp_ctx,
+			buf, buf_size))!= NULL) {
+		ref_fp_ctx->repetitions_count++;
+		*ref_psi_section_ctx= psi_section_ctx_ref(psi_dec_fp->psi_section_ctx);
+		end_code= STAT_SUCCESS;
 		goto end;
 	}
 
 	/* Parse (decode) section */
-	ret_code= psi_dec_section((uint8_t*)sect_buf, sect_buf_size, pid,
-			LOG_CTX_GET(), &psi_section_ctx);
+	ret_code= psi_dec_section(buf, buf_size, pid, LOG_CTX_GET(),
+			&psi_section_ctx);
 	if(ret_code== STAT_ENODATA || psi_section_ctx== NULL) {
 		end_code= STAT_ENODATA;
 		goto end;
 	}
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
+	/* Register fingerprint of the new accepted section */
+	if(ref_fp_ctx!= NULL) {
+		ref_fp_ctx->decoded_count++;
+		psi_dec_fp_register(ref_fp_ctx, psi_section_ctx);
+	}
+
 	*ref_psi_section_ctx= psi_section_ctx;
 	psi_section_ctx= NULL; // Avoid double referencing
 	end_code= STAT_SUCCESS;
 end:
 	if(psi_section_ctx!= NULL)
 		psi_section_ctx_release(&psi_section_ctx);
-	if(sect_buf!= NULL) {
-		free(sect_buf);
-		sect_buf= NULL;
-	}
 	return end_code;
 }
 
@@ -117,9 +203,10 @@ int psi_dec_section(uint8_t *buf, size_t buf_size, uint16_t pid,
 	register uint8_t section_number;
 	register uint8_t last_section_number;
 	psi_section_ctx_t *psi_section_ctx= NULL;
+	psi_section_ctx_t *psi_section_ctx_arena= NULL; // Do not release (alias)
 	bitparser_ctx_t *bitparser_ctx= NULL;
 	void **sect_data= NULL;
-	size_t sect_data_size= 0;
+	size_t sect_data_size= 0, arena_size;
 	int end_code= STAT_ERROR;
 	LOG_CTX_INIT(log_ctx);
 
@@ -134,8 +221,16 @@ int psi_dec_section(uint8_t *buf, size_t buf_size, uint16_t pid,
 
 	*ref_psi_section_ctx= NULL;
 
-	/* Allocate PSI section context structure */
-	psi_section_ctx= psi_section_ctx_allocate();
+	/* Allocate PSI section context structure. If the section specific data
+	 * is to be decoded, the whole section is allocated in a single memory
+	 * block (arena) sized from the section layout.
+	 */
+	if((arena_size= psi_dec_arena_size(buf, buf_size))> 0) {
+		psi_section_ctx= psi_section_ctx_allocate_arena(arena_size);
+		psi_section_ctx_arena= psi_section_ctx;
+	} else {
+		psi_section_ctx= psi_section_ctx_allocate();
+	}
 	CHECK_DO(psi_section_ctx!= NULL, goto end);
 
 	/* Initialize bit-parser.
@@ -177,10 +272,13 @@ int psi_dec_section(uint8_t *buf, size_t buf_size, uint16_t pid,
 		goto end;
 	}
 
-	/* Check compliance: 'current_next_indicator' */
+	/* Check compliance: 'current_next_indicator'. A section that is not yet
+	 * applicable is not an error; it is skipped as a not decoded section.
+	 */
 	if(psi_section_ctx->current_next_indicator== 0) {
 		//LOGW("We skip this section and continue parsing until field "
 		//		"'current_next_indicator'== '1'.\n"); //comment-me
+		end_code= STAT_ENODATA;
 		goto end;
 	}
 
@@ -198,15 +296,16 @@ int psi_dec_section(uint8_t *buf, size_t buf_size, uint16_t pid,
 	/* Parse specific section data */
 	switch(table_id) {
 	case PSI_TABLE_PROGRAM_ASSOCIATION_SECTION:
-		*sect_data= (void*)psi_dec_pas(log_ctx, bitparser_ctx, sect_data_size);
+		*sect_data= (void*)psi_dec_pas(log_ctx, bitparser_ctx, sect_data_size,
+				psi_section_ctx_arena);
 		break;
 	case PSI_TABLE_TS_PROGRAM_MAP_SECTION:
 		*sect_data= (void*)psi_dec_pms(log_ctx, bitparser_ctx, pid,
-				sect_data_size);
+				sect_data_size, psi_section_ctx_arena);
 		break;
 	case PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL:
 		*sect_data= (void*)psi_dvb_dec_sds(log_ctx, bitparser_ctx, pid,
-				sect_data_size);
+				sect_data_size, psi_section_ctx_arena);
 		break;
 	default:
 		//LOGV("Unknown PSI table identifier %u (0x%0x). PID= %u (0x%0x).\n",
@@ -236,38 +335,79 @@ end:
 }
 
 int psi_dec_read_next_section(fifo_ctx_t* ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_tscc, void **buf, size_t *count)
+		ts_dec_cc_ctx_t *ref_tscc, psi_dec_sect_ctx_t *ref_sect_ctx,
+		uint8_t **ref_buf, size_t *count)
 {
-	uint8_t *payload;
-	uint8_t payload_size;
-	uint8_t pointer_field;
-	uint8_t table_id;
-	int i, ret_code, end_code= STAT_ERROR;
-	ts_ctx_t* ts_ctx= NULL;
-	uint8_t *section_data= NULL;
-	size_t section_size= 0; // Parsed size
-	int flag_section_length_parsed= 0, flag_section_completed= 0;
-	uint16_t section_length= 0; // Set to "not specified"; update below.
-	uint16_t psi_pid= 0xFFFF; // Initialize to invalid.
-	const size_t psi_table_max_section_len_aligned= EXTEND_SIZE_TO_MULTIPLE(
-			PSI_TABLE_MAX_SECTION_LEN, CTX_S_BASE_ALIGN);
+	int ret_code, end_code= STAT_ERROR;
+	uint8_t *pkt= NULL;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
 	CHECK_DO(ififo_ctx!= NULL, return STAT_ERROR);
 	CHECK_DO(ref_tscc!= NULL, return STAT_ERROR);
-	CHECK_DO(buf!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_sect_ctx!= NULL && ref_sect_ctx->buf!= NULL,
+			return STAT_ERROR);
+	CHECK_DO(ref_buf!= NULL, return STAT_ERROR);
+	CHECK_DO(count!= NULL, return STAT_ERROR);
+
+	/* Pull next complete section (skipping filtered sections); read and push
+	 * new packets as needed.
+	 */
+	while((ret_code= psi_dec_sect_pull(ref_sect_ctx, LOG_CTX_GET(), ref_buf,
+			count))== STAT_EAGAIN || ret_code== STAT_ENODATA) {
+		if(ret_code== STAT_ENODATA)
+			continue;
+		if(pkt!= NULL) {
+			free(pkt);
+			pkt= NULL;
+		}
+		ret_code= ts_dec_get_next_packet_raw(ififo_ctx, LOG_CTX_GET(),
+				ref_tscc, &pkt);
+		if(ret_code!= STAT_SUCCESS) {
+			if(ret_code== STAT_EOF) end_code= STAT_EOF;
+			goto end;
+		}
+		psi_dec_sect_push_packet(ref_sect_ctx, pkt);
+	}
+	end_code= ret_code;
+end:
+	if(pkt!= NULL)
+		free(pkt);
+	return end_code;
+}
+
+void psi_dec_sect_push_packet(psi_dec_sect_ctx_t *ref_sect_ctx,
+		const uint8_t *pkt)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ref_sect_ctx!= NULL, return);
+	CHECK_DO(pkt!= NULL, return);
+
+	/* Previous packet should be completely processed */
+	ASSERT(ref_sect_ctx->pkt== NULL);
+
+	ref_sect_ctx->pkt= pkt;
+	ref_sect_ctx->pid= TS_BUF_GET_PID(pkt);
+}
+
+int psi_dec_sect_pull(psi_dec_sect_ctx_t *ref_sect_ctx, log_ctx_t *log_ctx,
+		uint8_t **ref_buf, size_t *count)
+{
+	const uint8_t *pkt;
+	uint16_t section_length;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(ref_sect_ctx!= NULL && ref_sect_ctx->buf!= NULL,
+			return STAT_ERROR);
+	CHECK_DO(ref_buf!= NULL, return STAT_ERROR);
 	CHECK_DO(count!= NULL, return STAT_ERROR);
 
-	*buf= NULL;
+	*ref_buf= NULL;
 	*count= 0;
 
-	/* Synchronize section.
-	 * Get next mpeg2-TS packet such:
-	 * - payload unit start indicator is set
-	 * - payload is effectively present
-	 * Note that input FIFO provide packet with a single PID value.
-	 */
 	/* When the payload of the transport stream packet contains transport
 	 * stream section data, the 'payload_unit_start_indicator' has the
 	 * following significance: if the transport stream packet carries the
@@ -280,226 +420,205 @@ int psi_dec_read_next_section(fifo_ctx_t* ififo_ctx, log_ctx_t *log_ctx,
 	 * It is important to note that a PSI section start may be found at any
 	 * point of the TS packet payload, so it is possible that the
 	 * 'section_length' field -or any other- may "fall" in the next TS packet.
+	 * Also note that a new section may start right after the end of the
+	 * previous one in the same packet; otherwise, packet stuffing bytes
+	 * (0xFF) fill the rest of the packet payload.
 	 */
-	while(ts_ctx== NULL ||
-			!ts_ctx->payload_unit_start_indicator ||
-			!ts_ctx->contains_payload) {
-		ts_ctx_release(&ts_ctx);
-		ret_code= ts_dec_get_next_packet(ififo_ctx, log_ctx, ref_tscc, &ts_ctx);
-		if(ret_code!= STAT_SUCCESS) {
-			if(ret_code== STAT_EOF) end_code= STAT_EOF;
-			goto end;
+	while(1) {
+		const uint8_t *payload;
+		size_t payload_size;
+		int flag_completed;
+
+		/* Resume reassembly from the remainder of the last packet, if any */
+		if(ref_sect_ctx->remainder_size> 0) {
+			payload_size= ref_sect_ctx->remainder_size;
+			ref_sect_ctx->remainder_size= 0;
+			if(ref_sect_ctx->remainder[0]== 0xFF)
+				continue; // Stuffing till the end of packet
+			ref_sect_ctx->flag_sync= 1;
+			ref_sect_ctx->size= 0;
+			flag_completed= psi_dec_sect_feed(ref_sect_ctx,
+					ref_sect_ctx->remainder, payload_size, LOG_CTX_GET());
+			if(flag_completed> 0)
+				break;
+			if(flag_completed< 0)
+				ref_sect_ctx->flag_sync= 0;
+			continue;
 		}
-	}
 
-	psi_pid= ts_ctx->pid;
-	payload= ts_ctx->payload;
-	payload_size= ts_ctx->payload_size;
-	CHECK_DO(payload!= NULL && payload_size> 0, goto end);
-
-	/* First 8-bits of payload are the so-called 'pointer_field' */
-	pointer_field= payload[0];
-	CHECK_DO(payload_size>= pointer_field+ 1, goto end);
-	//LOGV("Pointer field value: %d\n", pointer_field); //comment-me
-
-	/* Check first byte ('table_id' field) of section */
-	if((1+ pointer_field)>= payload_size) {
-		LOGE("Invalid pointer field value while synchronising next PSI "
-				"table. Pointer field out of bounds (pointer: %u, "
-				"payload size: %u). PID= %u (0x%0x).\n", pointer_field,
-				payload_size, psi_pid, psi_pid);
-		goto end;
-	}
-	table_id= payload[1+ pointer_field];
-	if(table_id== 0xFF) {
-		/* 'table_id value 0xFF is forbidden'; discard */
-		LOGE("Forbidden 'table_id' value 0xFF parsed in PSI section. PID= %u "
-				"(0x%0x).\n", psi_pid, psi_pid);
-		goto end;
-	}
-
-	/* Copy first bytes of PSI section taking into account 'pointer_field' */
-	section_size+= (payload_size- 1- pointer_field);
-	CHECK_DO(section_size<= PSI_TABLE_MAX_SECTION_LEN, goto end);
-	CHECK_DO(SIZE_IS_MULTIPLE(PSI_TABLE_MAX_SECTION_LEN, sizeof(WORD_T)),
-			goto end);
-	section_data= (uint8_t*)malloc(psi_table_max_section_len_aligned);
-	CHECK_DO(section_data!= NULL, goto end);
-	memset(section_data, 0xFF, psi_table_max_section_len_aligned);
-	memcpy(section_data, &payload[1+ pointer_field], section_size);
-
-	/* Check if we have parsed enough bytes to get 'section_length' */
-	if(flag_section_length_parsed== 0 && section_size>= 3) {
-		section_length = (uint16_t)section_data[2];
-		section_length|= (((uint16_t)section_data[1])& 0x000F)<< 8;
-		flag_section_length_parsed= 1;
-	}
-
-	/* Check if section is completed based on specified length */
-	if(flag_section_length_parsed!= 0 && (section_length+ 3)<= section_size) {
-		flag_section_completed= 1;
-	}
-
-	/* Copy rest of the section */
-	while(flag_section_completed== 0) {
-		uint8_t payload_unit_start_indicator;
-		uint8_t *ts_pkt;
-		size_t ts_pkt_size;
+		/* Get next pushed TS packet (consumed in this iteration) */
+		if((pkt= ref_sect_ctx->pkt)== NULL)
+			return STAT_EAGAIN;
+		ref_sect_ctx->pkt= NULL;
+		if((payload_size= psi_dec_ts_payload(pkt, &payload))== 0)
+			continue;
 
-		/* Show (but do not flush from FIFO) next TS-packet to check only if
-		 * 'payload_unit_start_indicator' flag is set.
-		 */
-		ret_code= fifo_show(ififo_ctx, (void**)&ts_pkt, &ts_pkt_size);
-		if(ret_code!= STAT_SUCCESS) {
-			if(ret_code== STAT_EAGAIN)
-				end_code= STAT_EOF; // FIFO unblocked; we are requested to exit.
-			goto end;
-		}
-		CHECK_DO(ts_pkt!= NULL && ts_pkt[0]== 0x47&& ts_pkt_size== TS_PKT_SIZE,
-				goto end);
-
-		/* If new section is detected in next TS; exit loop. */
-		if((payload_unit_start_indicator= ts_pkt[1]& 0x40)!= 0) {
-			if(ts_ctx!= NULL)
-				ts_ctx_release(&ts_ctx);
-			ret_code= ts_dec_packet(ts_pkt, log_ctx, &ts_ctx);
-			if(ret_code!= STAT_SUCCESS)
-				goto end;
-
-			if(ts_ctx->payload== NULL || ts_ctx->payload_size== 0) {
-				LOGE("Payload unit start expected, but transport packet does "
-						"not carry payload. PID= %u (0x%0x).\n",
-						psi_pid, psi_pid);
-				goto end;
-			}
-			payload= &ts_ctx->payload[1]; // skip 'pointer_field'
-			payload_size= ts_ctx->payload[0]; // value of 'pointer_field'
-			CHECK_DO(payload!= NULL && payload_size>= 0, goto end);
-			if((1+ payload_size)>= ts_ctx->payload_size) {
-				LOGE("Invalid pointer field value while synchronising next PSI "
-						"table. Pointer field out of bounds (pointer: %u, "
-						"payload size: %u). PID= %u (0x%0x).\n", payload_size,
-						ts_ctx->payload_size, psi_pid, psi_pid);
-				goto end;
+		if(TS_BUF_GET_START_INDICATOR(pkt)) {
+			uint8_t pointer_field= payload[0];
+
+			/* Check 'pointer_field' */
+			if((size_t)1+ pointer_field>= payload_size) {
+				uint16_t pid= TS_BUF_GET_PID(pkt);
+				LOGE("Invalid pointer field value while synchronising next "
+						"PSI table. Pointer field out of bounds (pointer: %u, "
+						"payload size: %u). PID= %u (0x%0x).\n", pointer_field,
+						(unsigned)payload_size, pid, pid);
+				ref_sect_ctx->flag_sync= 0;
+				continue;
 			}
 
-			/* Reallocate section buffer and copy section remainder. */
-			if(payload_size> 0) {
-				CHECK_DO(section_size+ payload_size<= PSI_TABLE_MAX_SECTION_LEN,
-						goto end);
-				memcpy(&section_data[section_size], payload, payload_size);
-				section_size+= payload_size;
+			/* The bytes preceding the new section end the current one */
+			if(ref_sect_ctx->flag_sync!= 0) {
+				flag_completed= (pointer_field== 0)? 0: psi_dec_sect_feed(
+						ref_sect_ctx, &payload[1], pointer_field,
+						LOG_CTX_GET());
+				if(flag_completed> 0) {
+					/* Keep the new section start for the next call */
+					ref_sect_ctx->remainder_size= payload_size- 1-
+							pointer_field;
+					memcpy(ref_sect_ctx->remainder, &payload[1+ pointer_field],
+							ref_sect_ctx->remainder_size);
+					break;
+				}
+				if(flag_completed== 0) {
+					uint16_t pid= TS_BUF_GET_PID(pkt);
+					LOGW("PSI section could not be completed (new section "
+							"start found). PID= %u (0x%0x).\n", pid, pid);
+				}
 			}
 
-			/* Get/check 'section_length' */
-			CHECK_DO(section_size>= 3, goto end);
-			if(flag_section_length_parsed== 0) {
-				section_length = (uint16_t)section_data[2];
-				section_length|= (((uint16_t)section_data[1])& 0x000F)<< 8;
-				flag_section_length_parsed= 1;
+			/* Start new section */
+			payload+= 1+ pointer_field;
+			payload_size-= 1+ pointer_field;
+			if(payload[0]== 0xFF) {
+				ref_sect_ctx->flag_sync= 0;
+				continue; // Stuffing till the end of packet
 			}
-
-			flag_section_completed= 1;
-			break; // Exit loop.
-		}
-
-		/* Get (flushing from buffer) the new TS packet. */
-		if(ts_ctx!= NULL)
-			ts_ctx_release(&ts_ctx);
-		ret_code= ts_dec_get_next_packet(ififo_ctx, log_ctx, ref_tscc, &ts_ctx);
-		if(ret_code!= STAT_SUCCESS) {
-			if(ret_code== STAT_EOF) end_code= STAT_EOF;
-			goto end;
-		}
-		if(ts_ctx== NULL || !ts_ctx->contains_payload) {
-			continue;
+			ref_sect_ctx->flag_sync= 1;
+			ref_sect_ctx->size= 0;
+		} else if(ref_sect_ctx->flag_sync== 0) {
+			continue; // Still not synchronized; skip packet
 		}
 
-		payload= ts_ctx->payload;
-		payload_size= ts_ctx->payload_size;
-		CHECK_DO(payload!= NULL && payload_size> 0, goto end);
-
-		/* Reallocate section buffer and copy TS packet payload. */
-		CHECK_DO(section_size+ payload_size<= PSI_TABLE_MAX_SECTION_LEN,
-				goto end);
-		memcpy(&section_data[section_size], payload, payload_size);
-		section_size+= payload_size;
-
+		/* Append payload to the section being reassembled */
+		flag_completed= psi_dec_sect_feed(ref_sect_ctx, payload, payload_size,
+				LOG_CTX_GET());
+		if(flag_completed> 0)
+			break;
+		if(flag_completed< 0)
+			ref_sect_ctx->flag_sync= 0;
+	}
 
-		/* Check if we have parsed enough bytes to get 'section_length' */
-		if(flag_section_length_parsed== 0 && section_size>= 3) {
-			section_length = (uint16_t)section_data[2];
-			section_length|= (((uint16_t)section_data[1])& 0x000F)<< 8;
-			flag_section_length_parsed= 1;
-		}
+	/* Section completed */
+	ref_sect_ctx->flag_sync= 0;
+	section_length= ref_sect_ctx->size- 3;
 
-		/* Check if section is completed based on specified length */
-		if(flag_section_length_parsed!= 0 &&
-				(section_length+ 3)<= section_size) {
-			flag_section_completed= 1;
-		}
-	}
-	ASSERT(flag_section_completed== 1);
-
-	/* Check compliance: 'section_size'. and stuffing bytes. */
-	CHECK_DO(section_size<= PSI_TABLE_MAX_SECTION_LEN &&
-			(section_length+ 3)<= section_size, goto end);
-	if((section_length+ 3)< section_size) {
-		/* Stuffing bytes should exist at the end of the section. */
-		/* Check compliance: stuffing bytes:
-		 * Within a Transport Stream, packet stuffing bytes of value 0xFF may
-		 * be found in the payload of Transport Stream packets carrying PSI
-		 * and/or private_sections only after the last byte of a section. In
-		 * this case all bytes until the end of the Transport Stream packet
-		 * shall also be stuffing bytes of value 0xFF. In such a case, the
-		 * payload of the next Transport Stream packet with the same PID value
-		 * shall begin with a pointer_field of value 0x00 indicating that the
-		 * next section starts immediately thereafter.
-		 * If the value 0xFF was present, then the following TS Packet of
-		 * the same PID either:
-		 * (1) consists only of adaptation_field, or
-		 * (2) has the payload_unit_start_indicator set to '1', has the
-		 * pointer_field set to ‘0’ and then starts a new section.
-		 */
-		for(i= (section_length+ 3); i< section_size; i++) {
-			if(section_data[i]!= 0xFF) {
-				LOGEV("Unexpected PSI section padding conditions: "
-						"illegal padding bytes not set to value 0xFF or parsed "
-						"PSI section is longer than declared. "
-						"PID= %u (0x%0x).\n", psi_pid, psi_pid);
-				break;
-			}
-		}
-		// TODO: Check conditions (1) and (2) mentioned above.
+	/* Apply section filters (if any) before going any further */
+	if(ref_sect_ctx->filter_list!= NULL && !psi_filter_list_match(
+			ref_sect_ctx->filter_list, ref_sect_ctx->buf, section_length+ 3)) {
+		ref_sect_ctx->filtered_count++;
+		return STAT_ENODATA;
 	}
 
 	/* Check compliance: CRC-32. */
-	if(crc_32_mpeg2(section_data, section_length+ 3)!= 0) {
+	if(psi_crc32(ref_sect_ctx->buf, section_length+ 3)!= 0) {
 		LOGEV("Check compliance: Inconsistent CRC-32 in PSI section. "
-				"PID= %u (0x%0x).\n", psi_pid, psi_pid);
-		goto end;
+				"PID= %u (0x%0x).\n", ref_sect_ctx->pid, ref_sect_ctx->pid);
+		return STAT_ERROR;
 	}
 
 	*count= section_length+ 3; // We do not report stuffing size
-	*buf= (void*)section_data;
-	section_data= NULL; // Avoid double referencing
-	end_code= STAT_SUCCESS;
+	*ref_buf= ref_sect_ctx->buf;
 	//LOGV("New PSI section read (length: %d)\n", (int)*count); //comment-me
-end:
-	ts_ctx_release(&ts_ctx);
-	if(section_data!= NULL)
-		free(section_data);
-	if(end_code!= STAT_SUCCESS) {
-		if(*buf!= NULL) {
-			free(*buf);
-			*buf= NULL;
+	return STAT_SUCCESS;
+}
+
+/**
+ * Append data to the section being reassembled; only the bytes belonging
+ * to the section (as specified by the 'section_length' field) are appended.
+ * The rest of the data (if any) is saved as remainder, as a new section may
+ * start right after.
+ * @return 1 if the section is completed, 0 if more data is needed, and -1
+ * if the section is not valid (should be discarded).
+ */
+static int psi_dec_sect_feed(psi_dec_sect_ctx_t *psi_dec_sect_ctx,
+		const uint8_t *data, size_t data_size, log_ctx_t *log_ctx)
+{
+	size_t n, total_size;
+	uint8_t *buf= psi_dec_sect_ctx->buf;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Get the section header bytes up to the 'section_length' field */
+	if(psi_dec_sect_ctx->size< 3) {
+		n= 3- psi_dec_sect_ctx->size;
+		if(n> data_size)
+			n= data_size;
+		memcpy(&buf[psi_dec_sect_ctx->size], data, n);
+		psi_dec_sect_ctx->size+= n;
+		data+= n;
+		data_size-= n;
+		if(psi_dec_sect_ctx->size< 3)
+			return 0;
+
+		/* Check first byte ('table_id' field) of section */
+		if(buf[0]== 0xFF) {
+			/* 'table_id value 0xFF is forbidden'; discard */
+			LOGE("Forbidden 'table_id' value 0xFF parsed in PSI section. "
+					"PID= %u (0x%0x).\n", psi_dec_sect_ctx->pid,
+					psi_dec_sect_ctx->pid);
+			return -1;
 		}
 	}
-	return end_code;
+
+	total_size= 3+ ((((uint16_t)buf[1])& 0x0F)<< 8)+ buf[2];
+	if(total_size> PSI_TABLE_MAX_SECTION_LEN) {
+		LOGE("Invalid PSI 'section_length' value (%u). PID= %u (0x%0x).\n",
+				(unsigned)total_size- 3, psi_dec_sect_ctx->pid,
+				psi_dec_sect_ctx->pid);
+		return -1;
+	}
+
+	/* Append section bytes */
+	n= total_size- psi_dec_sect_ctx->size;
+	if(n> data_size)
+		n= data_size;
+	memcpy(&buf[psi_dec_sect_ctx->size], data, n);
+	psi_dec_sect_ctx->size+= n;
+	data+= n;
+	data_size-= n;
+	if(psi_dec_sect_ctx->size< total_size)
+		return 0;
+
+	/* Save the rest of the payload (note that 'data' may point to the
+	 * remainder buffer itself).
+	 */
+	memmove(psi_dec_sect_ctx->remainder, data, data_size);
+	psi_dec_sect_ctx->remainder_size= data_size;
+	return 1;
+}
+
+/**
+ * Get the payload of the given binary MPEG2-TS packet.
+ * @return Payload size (zero if the packet does not carry payload).
+ */
+static size_t psi_dec_ts_payload(const uint8_t *pkt,
+		const uint8_t **ref_payload)
+{
+	size_t offset= TS_PKT_PREFIX_LEN;
+
+	if(!TS_BUF_GET_PAYLOAD_FLAG(pkt))
+		return 0;
+	if(pkt[3]& 0x20) // Adaptation field exists
+		offset+= 1+ pkt[4];
+	if(offset>= TS_PKT_SIZE)
+		return 0;
+	*ref_payload= &pkt[offset];
+	return TS_PKT_SIZE- offset;
 }
 
 static psi_pas_ctx_t* psi_dec_pas(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, size_t size)
+		bitparser_ctx_t *bitparser_ctx, size_t size,
+		psi_section_ctx_t *psi_section_ctx_arena)
 {
 	psi_pas_ctx_t *psi_pas_ctx= NULL;
 	psi_pas_prog_ctx_t *psi_pas_prog_ctx_nth= NULL;
@@ -511,13 +630,15 @@ static psi_pas_ctx_t* psi_dec_pas(log_ctx_t *log_ctx,
 	CHECK_DO(size> 0, return NULL);
 
 	/* Allocate PMS context structure */
-	psi_pas_ctx= psi_pas_ctx_allocate();
+	psi_pas_ctx= PSI_SECTION_ARENA_ALLOC(psi_section_ctx_arena, psi_pas_ctx_t,
+			psi_pas_ctx_allocate);
 	CHECK_DO(psi_pas_ctx!= NULL, goto end);
 
 	/* Loop through the 'N' programs fields (32-bit per loop) */
 	for(i= 0; i< (size>> 2); i++) {
 		/* Allocate PAS specific data context structure */
-		psi_pas_prog_ctx_nth= psi_pas_prog_ctx_allocate();
+		psi_pas_prog_ctx_nth= PSI_SECTION_ARENA_ALLOC(psi_section_ctx_arena,
+				psi_pas_prog_ctx_t, psi_pas_prog_ctx_allocate);
 		CHECK_DO(psi_pas_prog_ctx_nth!= NULL, goto end);
 
 		/* Parse specific data */
@@ -526,24 +647,30 @@ static psi_pas_ctx_t* psi_dec_pas(log_ctx_t *log_ctx,
 		psi_pas_prog_ctx_nth->reference_pid= GET_BITS(13);
 
 		/* Insert node in list of PAS specific data context structures */
-		ret_code= llist_insert_nth(&psi_pas_ctx->psi_pas_prog_ctx_llist, i,
-				psi_pas_prog_ctx_nth);
+		ret_code= PSI_SECTION_ARENA_LLIST_INSERT_NTH(psi_section_ctx_arena,
+				&psi_pas_ctx->psi_pas_prog_ctx_llist, i, psi_pas_prog_ctx_nth);
 		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 		psi_pas_prog_ctx_nth= NULL; // avoid freeing at the end of function.
 	}
 
 	end_code= STAT_SUCCESS;
 end:
-	psi_pas_prog_ctx_release(&psi_pas_prog_ctx_nth);
+	/* Arena memory is released with the section */
+	if(psi_section_ctx_arena== NULL)
+		psi_pas_prog_ctx_release(&psi_pas_prog_ctx_nth);
 
-	if(end_code!= STAT_SUCCESS)
-		psi_pas_ctx_release(&psi_pas_ctx);
+	if(end_code!= STAT_SUCCESS) {
+		if(psi_section_ctx_arena== NULL)
+			psi_pas_ctx_release(&psi_pas_ctx);
+		psi_pas_ctx= NULL;
+	}
 
 	return psi_pas_ctx;
 }
 
 static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size)
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size,
+		psi_section_ctx_t *psi_section_ctx_arena)
 {
 	psi_pms_ctx_t *psi_pms_ctx= NULL;
 	psi_pms_es_ctx_t *psi_pms_es_ctx_nth= NULL;
@@ -556,7 +683,8 @@ static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
 	CHECK_DO(size> 0, return NULL);
 
 	/* Allocate Program Map Section specific data context structure */
-	psi_pms_ctx= psi_pms_ctx_allocate();
+	psi_pms_ctx= PSI_SECTION_ARENA_ALLOC(psi_section_ctx_arena, psi_pms_ctx_t,
+			psi_pms_ctx_allocate);
 	CHECK_DO(psi_pms_ctx!= NULL, goto end);
 
 	/* Parse fields */
@@ -568,13 +696,13 @@ static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
 	/* Get 'N' program descriptors data (type 'psi_desc_ctx_t'). */
 	while(program_info_length> 0) {
 		psi_desc_ctx_t *psi_desc_ctx= psi_desc_dec(log_ctx, bitparser_ctx,
-				pid, program_info_length);
+				pid, program_info_length, psi_section_ctx_arena);
 		if(psi_desc_ctx== NULL) {
 			//LOGE("Illegal program information descriptor found.\n");
 			goto end;
 		}
-		ret_code= llist_push(&psi_pms_ctx->psi_desc_ctx_llist,
-				(void*)psi_desc_ctx);
+		ret_code= PSI_SECTION_ARENA_LLIST_PUSH(psi_section_ctx_arena,
+				&psi_pms_ctx->psi_desc_ctx_llist, (void*)psi_desc_ctx);
 		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 		program_info_length-=
 				PSI_DESC_FIXED_LEN+ psi_desc_ctx->descriptor_length;
@@ -587,7 +715,8 @@ static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
 	for(i= 0; es_data_length> 0; i++) {
 
 		/* Allocate program ES context structure */
-		psi_pms_es_ctx_nth= psi_pms_es_ctx_allocate();
+		psi_pms_es_ctx_nth= PSI_SECTION_ARENA_ALLOC(psi_section_ctx_arena,
+				psi_pms_es_ctx_t, psi_pms_es_ctx_allocate);
 		CHECK_DO(psi_pms_es_ctx_nth!= NULL, goto end);
 
 		/* Parse fields */
@@ -610,7 +739,7 @@ static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
 		//		psi_pms_es_ctx_nth->elementary_PID); //comment-me
 		while(es_info_length> 0) {
 			psi_desc_ctx_t *psi_desc_ctx= psi_desc_dec(log_ctx, bitparser_ctx,
-					pid, es_info_length);
+					pid, es_info_length, psi_section_ctx_arena);
 			if(psi_desc_ctx== NULL) {
 				//LOGEV("Illegal ES information descriptor found "
 				//		"(PID: %u). Rest of ES descriptors can not be parsed "
@@ -624,10 +753,13 @@ static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
 				es_info_length= 0;
 				break;
 			}
-			ret_code= llist_push(&psi_pms_es_ctx_nth->psi_desc_ctx_llist,
+			ret_code= PSI_SECTION_ARENA_LLIST_PUSH(psi_section_ctx_arena,
+					&psi_pms_es_ctx_nth->psi_desc_ctx_llist,
 					(void*)psi_desc_ctx);
 			CHECK_DO(ret_code== STAT_SUCCESS,
-					psi_desc_ctx_release(&psi_desc_ctx); goto end);
+					if(psi_section_ctx_arena== NULL)
+						psi_desc_ctx_release(&psi_desc_ctx);
+					goto end);
 			es_info_length-= PSI_DESC_FIXED_LEN+
 					psi_desc_ctx->descriptor_length;
 		}
@@ -639,8 +771,8 @@ static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
 		/* Insert node in list of elementary stream information context
 		 * structures.
 		 */
-		ret_code= llist_insert_nth(&psi_pms_ctx->psi_pms_es_ctx_llist, i,
-				psi_pms_es_ctx_nth);
+		ret_code= PSI_SECTION_ARENA_LLIST_INSERT_NTH(psi_section_ctx_arena,
+				&psi_pms_ctx->psi_pms_es_ctx_llist, i, psi_pms_es_ctx_nth);
 		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 		psi_pms_es_ctx_nth= NULL; // avoid freeing at the end of function.
 	}
@@ -650,9 +782,197 @@ static psi_pms_ctx_t* psi_dec_pms(log_ctx_t *log_ctx,
 
 	end_code= STAT_SUCCESS;
 end:
-	if(psi_pms_es_ctx_nth!= NULL)
+	/* Arena memory is released with the section */
+	if(psi_pms_es_ctx_nth!= NULL && psi_section_ctx_arena== NULL)
 		psi_pms_es_ctx_release(&psi_pms_es_ctx_nth);
-	if(end_code!= STAT_SUCCESS)
-		psi_pms_ctx_release(&psi_pms_ctx);
+	if(end_code!= STAT_SUCCESS) {
+		if(psi_section_ctx_arena== NULL)
+			psi_pms_ctx_release(&psi_pms_ctx);
+		psi_pms_ctx= NULL;
+	}
 	return psi_pms_ctx;
 }
+
+/**
+ * Compute the arena size needed to decode the given raw section (see
+ * 'psi_section_ctx_allocate_arena()'). The section layout (loops and
+ * descriptor lengths) is walked without decoding it, so the arena is sized
+ * for the exact number of structures, list nodes and descriptors the
+ * section decoder will allocate.
+ * Returns zero if the section specific data is not decoded or if the
+ * section layout is inconsistent (the section is then decoded node by node,
+ * letting the decoder report the error).
+ */
+static size_t psi_dec_arena_size(const uint8_t *buf, size_t buf_size)
+{
+	const uint8_t *p, *p_end;
+	size_t section_length, len, arena_size;
+	const size_t node_size= PSI_SECTION_ARENA_SIZEOF(sizeof(llist_t));
+
+	if(buf_size< PSI_SECTION_FIXED_LEN || (buf[1]& 0x80)== 0)
+		return 0;
+	section_length= (((size_t)buf[1]& 0x0F)<< 8)| buf[2];
+	if(section_length< 9 || section_length+ 3> buf_size)
+		return 0;
+
+	/* Section specific data (CRC excluded) */
+	p= buf+ PSI_SECTION_FIXED_LEN- 4;
+	p_end= buf+ 3+ section_length- 4;
+	arena_size= PSI_SECTION_ARENA_SIZEOF(sizeof(psi_section_ctx_t));
+
+	switch(buf[0]) {
+	case PSI_TABLE_PROGRAM_ASSOCIATION_SECTION:
+		arena_size+= PSI_SECTION_ARENA_SIZEOF(sizeof(psi_pas_ctx_t))+
+				((p_end- p)/ PSI_PAS_PROG_LEN)* (node_size+
+						PSI_SECTION_ARENA_SIZEOF(sizeof(psi_pas_prog_ctx_t)));
+		break;
+	case PSI_TABLE_TS_PROGRAM_MAP_SECTION:
+		arena_size+= PSI_SECTION_ARENA_SIZEOF(sizeof(psi_pms_ctx_t));
+		if(p_end- p< 4)
+			return 0;
+		len= (((size_t)p[2]& 0x0F)<< 8)| p[3]; // 'program_info_length'
+		p+= 4;
+		if(len> (size_t)(p_end- p))
+			return 0;
+		arena_size+= psi_dec_arena_size_desc(p, len);
+		for(p+= len; p< p_end; p+= len) {
+			if(p_end- p< 5)
+				return 0;
+			len= (((size_t)p[3]& 0x0F)<< 8)| p[4]; // 'ES_info_length'
+			p+= 5;
+			if(len> (size_t)(p_end- p))
+				return 0;
+			arena_size+= PSI_SECTION_ARENA_SIZEOF(sizeof(psi_pms_es_ctx_t))+
+					node_size+ psi_dec_arena_size_desc(p, len);
+		}
+		break;
+	case PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL:
+		arena_size+= PSI_SECTION_ARENA_SIZEOF(sizeof(psi_dvb_sds_ctx_t));
+		if(p_end- p< 3)
+			return 0;
+		for(p+= 3; p< p_end; p+= len) {
+			if(p_end- p< PSI_DVB_SDS_PROG_FIXED_LEN)
+				return 0;
+			len= (((size_t)p[3]& 0x0F)<< 8)| p[4]; // 'descriptors_loop_length'
+			p+= PSI_DVB_SDS_PROG_FIXED_LEN;
+			if(len> (size_t)(p_end- p))
+				return 0;
+			arena_size+= PSI_SECTION_ARENA_SIZEOF(sizeof(
+					psi_dvb_sds_prog_ctx_t))+ node_size+
+					psi_dec_arena_size_desc(p, len);
+		}
+		break;
+	default:
+		return 0;
+	}
+	return arena_size;
+}
+
+/**
+ * Compute the arena size taken by the descriptors (and their list nodes) of
+ * the given descriptors loop (see 'psi_dec_arena_size()').
+ */
+static size_t psi_dec_arena_size_desc(const uint8_t *p, size_t size)
+{
+	size_t arena_size= 0;
+	const size_t node_size= PSI_SECTION_ARENA_SIZEOF(sizeof(llist_t));
+
+	while(size>= PSI_DESC_FIXED_LEN &&
+			(size_t)PSI_DESC_FIXED_LEN+ p[1]<= size) {
+		arena_size+= PSI_SECTION_ARENA_SIZEOF(psi_desc_ctx_raw_size(p[1]))+
+				node_size;
+		size-= PSI_DESC_FIXED_LEN+ p[1];
+		p+= PSI_DESC_FIXED_LEN+ p[1];
+	}
+	return arena_size;
+}
+
+/**
+ * Look for the fingerprint matching the given raw section.
+ * The raw section is not decoded: only the fields identifying the section
+ * ('table_id', 'table_id_extension' and 'section_number') and the fields
+ * fingerprinting it ('section_length' and 'CRC_32') are read.
+ * Returns the fingerprint entry if the section is a repetition of the last
+ * accepted one, NULL otherwise.
+ */
+static psi_dec_fp_t* psi_dec_fp_lookup(psi_dec_fp_ctx_t *psi_dec_fp_ctx,
+		const uint8_t *buf, size_t buf_size)
+{
+	int i;
+	uint8_t table_id, section_number;
+	uint16_t section_length, table_id_extension;
+	uint32_t crc_32;
+
+	/* Only sections with 'section_syntax_indicator' set are fingerprinted */
+	if(buf_size< PSI_SECTION_FIXED_LEN || (buf[1]& 0x80)== 0)
+		return NULL;
+
+	section_length= (((uint16_t)buf[1]& 0x0F)<< 8)| buf[2];
+	if((size_t)section_length+ 3> buf_size || section_length< 9)
+		return NULL;
+
+	table_id= buf[0];
+	table_id_extension= ((uint16_t)buf[3]<< 8)| buf[4];
+	section_number= buf[6];
+	crc_32= ((uint32_t)buf[section_length- 1]<< 24)|
+			((uint32_t)buf[section_length]<< 16)|
+			((uint32_t)buf[section_length+ 1]<< 8)|
+			(uint32_t)buf[section_length+ 2];
+
+	for(i= 0; i< PSI_DEC_FP_CACHE_SIZE; i++) {
+		psi_dec_fp_t *psi_dec_fp= &psi_dec_fp_ctx->fp_array[i];
+
+		if(psi_dec_fp->psi_section_ctx== NULL ||
+				psi_dec_fp->table_id!= table_id ||
+				psi_dec_fp->table_id_extension!= table_id_extension ||
+				psi_dec_fp->section_number!= section_number)
+			continue;
+		if(psi_dec_fp->section_length== section_length &&
+				psi_dec_fp->crc_32== crc_32)
+			return psi_dec_fp;
+		return NULL; // Same section, but changed
+	}
+	return NULL;
+}
+
+/**
+ * Register the fingerprint of a new accepted (decoded) section.
+ * The fingerprint of the same table identifier, extension and section number
+ * is substituted if it exists; otherwise a free entry is used or, if the
+ * array is full, entries are replaced in a round-robin fashion.
+ */
+static void psi_dec_fp_register(psi_dec_fp_ctx_t *psi_dec_fp_ctx,
+		psi_section_ctx_t *psi_section_ctx)
+{
+	int i, idx= -1;
+	psi_dec_fp_t *psi_dec_fp;
+
+	for(i= 0; i< PSI_DEC_FP_CACHE_SIZE; i++) {
+		psi_dec_fp= &psi_dec_fp_ctx->fp_array[i];
+		if(psi_dec_fp->psi_section_ctx== NULL) {
+			if(idx< 0)
+				idx= i;
+			continue;
+		}
+		if(psi_dec_fp->table_id== psi_section_ctx->table_id &&
+				psi_dec_fp->table_id_extension==
+						psi_section_ctx->table_id_extension &&
+				psi_dec_fp->section_number== psi_section_ctx->section_number) {
+			idx= i;
+			break;
+		}
+	}
+	if(idx< 0) {
+		idx= psi_dec_fp_ctx->fp_next;
+		psi_dec_fp_ctx->fp_next= (idx+ 1)% PSI_DEC_FP_CACHE_SIZE;
+	}
+
+	psi_dec_fp= &psi_dec_fp_ctx->fp_array[idx];
+	psi_section_ctx_release(&psi_dec_fp->psi_section_ctx);
+	psi_dec_fp->table_id= psi_section_ctx->table_id;
+	psi_dec_fp->table_id_extension= psi_section_ctx->table_id_extension;
+	psi_dec_fp->section_number= psi_section_ctx->section_number;
+	psi_dec_fp->section_length= psi_section_ctx->section_length;
+	psi_dec_fp->crc_32= psi_section_ctx->crc_32;
+	psi_dec_fp->psi_section_ctx= psi_section_ctx_ref(psi_section_ctx);
+}
@@ -29,21 +29,142 @@
 #include <sys/types.h>
 #include <inttypes.h>
 
+#include "ts.h"
+
 /* **** Definitions **** */
 
 typedef struct fifo_ctx_s fifo_ctx_t;
 typedef struct log_ctx_s log_ctx_t;
 typedef struct psi_section_ctx_s psi_section_ctx_t;
+typedef struct ts_dec_cc_ctx_s ts_dec_cc_ctx_t;
+typedef struct psi_filter_list_s psi_filter_list_t;
+
+/**
+ * Section reassembly context structure.
+ * Keeps the state of the reassembly of the sections carried in the
+ * transport packets of a PID: the (persistent) reassembly buffer, and the
+ * payload remaining in the last packet after the last section completed
+ * (as several sections may be carried in the same packet).
+ * Should be initialized using 'psi_dec_sect_ctx_init()' and released using
+ * 'psi_dec_sect_ctx_deinit()'.
+ */
+typedef struct psi_dec_sect_ctx_s {
+	/**
+	 * Reassembly buffer (aligned; allocated once at initialization).
+	 * Sections are handed to the decoder directly in this buffer.
+	 */
+	uint8_t *buf;
+	/**
+	 * Number of bytes of the current section already reassembled.
+	 */
+	size_t size;
+	/**
+	 * Non-zero while a section is being reassembled.
+	 */
+	int flag_sync;
+	/**
+	 * Payload bytes following the last completed section in the same
+	 * transport packet (either the start of a new section or stuffing).
+	 */
+	uint8_t remainder[TS_PKT_SIZE];
+	size_t remainder_size;
+	/**
+	 * Transport packet pushed and still not processed (not owned; see
+	 * 'psi_dec_sect_push_packet()'); NULL if none.
+	 */
+	const uint8_t *pkt;
+	/**
+	 * PID of the last transport packet pushed (logging purposes).
+	 */
+	uint16_t pid;
+	/**
+	 * Section filters (not owned); NULL if all the sections are accepted.
+	 * Filters are evaluated on the completed raw section, before the CRC
+	 * check; non-matching sections are skipped.
+	 */
+	const psi_filter_list_t *filter_list;
+	/**
+	 * Number of sections skipped by the section filters.
+	 */
+	uint64_t filtered_count;
+} psi_dec_sect_ctx_t;
+
+/**
+ * Maximum number of section fingerprints kept by the section reader.
+ */
+#define PSI_DEC_FP_CACHE_SIZE 16
+
+/**
+ * Raw section fingerprint: identifies the last accepted (decoded) section
+ * for a given table identifier, table identifier extension and section
+ * number. The section 'CRC_32' and 'section_length' are read from the raw
+ * (still not decoded) section and compared against the fingerprint.
+ */
+typedef struct psi_dec_fp_s {
+	uint8_t table_id;
+	uint16_t table_id_extension;
+	uint8_t section_number;
+	uint16_t section_length;
+	uint32_t crc_32;
+	/**
+	 * Decoded section corresponding to this fingerprint (we hold a
+	 * reference); NULL if this fingerprint entry is not used.
+	 */
+	psi_section_ctx_t *psi_section_ctx;
+} psi_dec_fp_t;
+
+/**
+ * Section fingerprint context structure.
+ * Keeps the fingerprints of the last accepted sections of a PID, so
+ * repeated sections (which are most of them, as PSI tables are periodically
+ * re-sent) can be recognized without being decoded again.
+ * Should be initialized using 'psi_dec_fp_ctx_init()' and released using
+ * 'psi_dec_fp_ctx_deinit()'.
+ */
+typedef struct psi_dec_fp_ctx_s {
+	psi_dec_fp_t fp_array[PSI_DEC_FP_CACHE_SIZE];
+	/**
+	 * Next entry to be replaced when the fingerprint array is full.
+	 */
+	int fp_next;
+	/**
+	 * Number of sections fully decoded.
+	 */
+	uint64_t decoded_count;
+	/**
+	 * Number of repeated sections (fingerprint matches; decoding skipped).
+	 */
+	uint64_t repetitions_count;
+} psi_dec_fp_ctx_t;
 
 /* **** Prototypes **** */
 
 /**
- * Get next PSI section.
- * //TODO
+ * Initialize section reassembly context structure (the reassembly buffer
+ * is allocated).
+ * @param psi_dec_sect_ctx Pointer to the reassembly context structure.
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
  */
-int psi_dec_get_next_section(fifo_ctx_t* ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_tscc, uint16_t pid,
-		psi_section_ctx_t **ref_psi_section_ctx);
+int psi_dec_sect_ctx_init(psi_dec_sect_ctx_t *psi_dec_sect_ctx);
+
+/**
+ * Release the resources of the section reassembly context structure.
+ * @param psi_dec_sect_ctx Pointer to the reassembly context structure.
+ */
+void psi_dec_sect_ctx_deinit(psi_dec_sect_ctx_t *psi_dec_sect_ctx);
+
+/**
+ * Initialize section fingerprint context structure.
+ * @param psi_dec_fp_ctx Pointer to the fingerprint context structure.
+ */
+void psi_dec_fp_ctx_init(psi_dec_fp_ctx_t *psi_dec_fp_ctx);
+
+/**
+ * Release the sections referenced by the section fingerprint context
+ * structure (the structure is left initialized).
+ * @param psi_dec_fp_ctx Pointer to the fingerprint context structure.
+ */
+void psi_dec_fp_ctx_deinit(psi_dec_fp_ctx_t *psi_dec_fp_ctx);
 
 /**
  * //TODO
@@ -52,9 +173,79 @@ int psi_dec_section(uint8_t *buf, size_t buf_size, uint16_t pid,
 		log_ctx_t *log_ctx, psi_section_ctx_t **ref_psi_section_ctx);
 
 /**
- * //TODO
+ * Decode the given (complete) raw PSI section, unless it matches the
+ * fingerprint of an already decoded section.
+ * If a fingerprint context is given ('ref_fp_ctx' non-NULL), and the raw
+ * section matches the fingerprint of the last accepted section with the
+ * same table identifier, extension and section number, decoding is skipped
+ * and a new reference to the already decoded section is returned (sections
+ * are immutable once decoded; see 'psi_section_ctx_ref()').
+ * Sections not applicable yet ('current_next_indicator'== 0) are silently
+ * skipped (STAT_ENODATA is returned), without being decoded.
+ * @param buf Raw section buffer (e.g. as returned by 'psi_dec_sect_pull()').
+ * @param buf_size Raw section size.
+ * @param pid Packet identifier of the section.
+ * @param ref_fp_ctx Section fingerprint context structure (may be NULL).
+ * @param log_ctx LOG module context structure.
+ * @param ref_psi_section_ctx Reference to the pointer to the section
+ * returned.
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
+ */
+int psi_dec_section_fp(uint8_t *buf, size_t buf_size, uint16_t pid,
+		psi_dec_fp_ctx_t *ref_fp_ctx, log_ctx_t *log_ctx,
+		psi_section_ctx_t **ref_psi_section_ctx);
+
+/**
+ * Push the given transport packet into the section reassembly context.
+ * The packet is not copied, and should be kept valid until it is fully
+ * processed, namely, until 'psi_dec_sect_pull()' returns STAT_EAGAIN.
+ * Continuity checking is not performed (see 'ts_dec_cc_check_packet()').
+ * @param ref_sect_ctx Section reassembly context structure.
+ * @param pkt Transport packet (TS_PKT_SIZE bytes).
+ */
+void psi_dec_sect_push_packet(psi_dec_sect_ctx_t *ref_sect_ctx,
+		const uint8_t *pkt);
+
+/**
+ * Pull next complete PSI section from the section reassembly context.
+ * This function should be called repeatedly (after each packet push) until
+ * STAT_EAGAIN is returned, as several sections may be carried in the same
+ * packet.
+ * No copy is performed: the section is returned in the reassembly buffer
+ * of the given context, which is recycled in the next call.
+ * @param ref_sect_ctx Section reassembly context structure.
+ * @param log_ctx LOG module context structure.
+ * @param ref_buf Reference to the pointer to the section returned
+ * (do not release).
+ * @param count Reference to the section size returned
+ * ('section_length'+ 3 bytes, stuffing not included).
+ * @return STAT_SUCCESS if a section is returned, STAT_EAGAIN if a new packet
+ * should be pushed to continue the reassembly, STAT_ENODATA if the section
+ * completed does not match the section filters (section is skipped),
+ * STAT_ERROR if the section completed is not valid (e.g. CRC error; section
+ * is discarded).
+ */
+int psi_dec_sect_pull(psi_dec_sect_ctx_t *ref_sect_ctx, log_ctx_t *log_ctx,
+		uint8_t **ref_buf, size_t *count);
+
+/**
+ * Read (reassemble) next complete PSI section.
+ * Sections may start at any point of the transport packet payload, and
+ * several sections may be carried in the same packet.
+ * No copy is performed: the section is returned in the reassembly buffer
+ * of the given context, which is recycled in the next call.
+ * @param ififo_ctx Input packet FIFO buffer context structure.
+ * @param log_ctx LOG module context structure.
+ * @param ref_tscc Continuity checking context structure.
+ * @param ref_sect_ctx Section reassembly context structure.
+ * @param ref_buf Reference to the pointer to the section returned
+ * (do not release).
+ * @param count Reference to the section size returned
+ * ('section_length'+ 3 bytes, stuffing not included).
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
  */
 int psi_dec_read_next_section(fifo_ctx_t* ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_tscc, void **buf, size_t *count);
+		ts_dec_cc_ctx_t *ref_tscc, psi_dec_sect_ctx_t *ref_sect_ctx,
+		uint8_t **ref_buf, size_t *count);
 
 #endif /* SPMPEG2TS_SRC_PSI_DEC_H_ */
@@ -33,16 +33,87 @@
 #include <libmediaprocsutils/stat_codes.h>
 #include <libmediaprocsutils/check_utils.h>
 #include <libmediaprocsutils/llist.h>
+#include <libmediaprocsutils/bitparser.h>
+#include "psi.h"
+#include "obj_pool.h"
+#include "psi_desc_dec.h"
+#include "psi_desc_enc.h"
 
 /* **** Definitions **** */
 
+/**
+ * Offset of the raw descriptor data bytes in the descriptor memory block
+ * (see 'psi_desc_ctx_allocate_raw()').
+ */
+#define PSI_DESC_RAW_OFFSET EXTEND_SIZE_TO_MULTIPLE(sizeof(psi_desc_ctx_t), \
+		CTX_S_BASE_ALIGN)
+
 /* **** Prototypes **** */
 
+static void psi_desc_data_release(const psi_desc_ctx_t *psi_desc_ctx,
+		void **ref_data);
+
 /* **** Implementations **** */
 
 psi_desc_ctx_t* psi_desc_ctx_allocate()
 {
-	return (psi_desc_ctx_t*)calloc(1, sizeof(psi_desc_ctx_t));
+	return (psi_desc_ctx_t*)obj_pool_calloc(sizeof(psi_desc_ctx_t));
+}
+
+psi_desc_ctx_t* psi_desc_ctx_allocate_raw(uint8_t descriptor_tag,
+		uint8_t descriptor_length, const uint8_t *raw)
+{
+	return psi_desc_ctx_allocate_raw_arena(NULL, descriptor_tag,
+			descriptor_length, raw);
+}
+
+psi_desc_ctx_t* psi_desc_ctx_allocate_raw_arena(
+		psi_section_ctx_t *psi_section_ctx_arena, uint8_t descriptor_tag,
+		uint8_t descriptor_length, const uint8_t *raw)
+{
+	uint8_t *raw_dst;
+	psi_desc_ctx_t *psi_desc_ctx= NULL;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments.
+	 * Note: Argument 'psi_section_ctx_arena' is allowed to be 'NULL'.
+	 */
+	CHECK_DO(raw!= NULL || descriptor_length== 0, return NULL);
+
+	/* Allocate descriptor context structure and raw data in the same memory
+	 * block.
+	 * NOTE: Due to parsing performance reasons, the bit-parser works with
+	 * buffer sizes multiple of sizeof(WORD_T) bytes, and may overrun the
+	 * raw data end (see 'psi_desc_dec_data()').
+	 */
+	if(psi_section_ctx_arena!= NULL)
+		psi_desc_ctx= (psi_desc_ctx_t*)psi_section_ctx_arena_calloc(
+				psi_section_ctx_arena,
+				psi_desc_ctx_raw_size(descriptor_length));
+	else
+		psi_desc_ctx= (psi_desc_ctx_t*)obj_pool_calloc(psi_desc_ctx_raw_size(
+				descriptor_length));
+	CHECK_DO(psi_desc_ctx!= NULL, return NULL);
+
+	psi_desc_ctx->descriptor_tag= descriptor_tag;
+	psi_desc_ctx->descriptor_length= descriptor_length;
+	raw_dst= (uint8_t*)psi_desc_ctx+ PSI_DESC_RAW_OFFSET;
+	if(descriptor_length> 0)
+		memcpy(raw_dst, raw, descriptor_length);
+	psi_desc_ctx->raw= raw_dst;
+
+	/* Not supported descriptors data fields are just the raw data bytes */
+	if(descriptor_tag!= PSI_DESC_TAG_DVB_SERVICE &&
+			descriptor_tag!= PSI_DESC_TAG_DVB_SUBT && descriptor_length> 0)
+		psi_desc_ctx->data= (void*)raw_dst;
+
+	return psi_desc_ctx;
+}
+
+size_t psi_desc_ctx_raw_size(uint8_t descriptor_length)
+{
+	return PSI_DESC_RAW_OFFSET+ EXTEND_SIZE_TO_MULTIPLE(descriptor_length+ 1,
+			sizeof(WORD_T));
 }
 
 psi_desc_ctx_t* psi_desc_ctx_dup(const psi_desc_ctx_t* psi_desc_ctx_arg)
@@ -54,6 +125,13 @@ psi_desc_ctx_t* psi_desc_ctx_dup(const psi_desc_ctx_t* psi_desc_ctx_arg)
 	/* CHeck arguments */
 	CHECK_DO(psi_desc_ctx_arg!= NULL, return NULL);
 
+	/* Parsed descriptors: just copy raw data (specific data fields are
+	 * decoded on demand).
+	 */
+	if(psi_desc_ctx_arg->raw!= NULL)
+		return psi_desc_ctx_allocate_raw(psi_desc_ctx_arg->descriptor_tag,
+				psi_desc_ctx_arg->descriptor_length, psi_desc_ctx_arg->raw);
+
 	/* Allocate descriptor context structure */
 	psi_desc_ctx= psi_desc_ctx_allocate();
 	CHECK_DO(psi_desc_ctx!= NULL, goto end);
@@ -102,37 +180,92 @@ void psi_desc_ctx_release(psi_desc_ctx_t **ref_psi_desc_ctx)
 		return;
 
 	if((psi_desc_ctx= *ref_psi_desc_ctx)!= NULL) {
-		/* Release specific descriptor data */
-		switch(psi_desc_ctx->descriptor_tag) {
-		case PSI_DESC_TAG_DVB_SERVICE: {
-			psi_desc_dvb_service_ctx_t *psi_desc_dvb_service_ctx=
-					(psi_desc_dvb_service_ctx_t*)psi_desc_ctx->data;
-			psi_desc_dvb_service_ctx_release(&psi_desc_dvb_service_ctx);
-			break;
-		}
-		case PSI_DESC_TAG_DVB_SUBT: {
-			psi_desc_dvb_subt_ctx_t *psi_desc_dvb_subt_ctx=
-					(psi_desc_dvb_subt_ctx_t*)psi_desc_ctx->data;
-			psi_desc_dvb_subt_ctx_release(&psi_desc_dvb_subt_ctx);
-			break;
-		}
-		default:
-			//LOGV("Unknown descriptor type\n"); //comment-me
-			if(psi_desc_ctx->data!= NULL)
-				free(psi_desc_ctx->data);
-			break;
-		}
-		psi_desc_ctx->data= NULL;
-
-		free(*ref_psi_desc_ctx);
+		/* Release specific descriptor data (raw data is released with the
+		 * descriptor context structure memory block).
+		 */
+		psi_desc_data_release(psi_desc_ctx, &psi_desc_ctx->data);
+
+		obj_pool_free(psi_desc_ctx, psi_desc_ctx->raw!= NULL?
+				psi_desc_ctx_raw_size(psi_desc_ctx->descriptor_length):
+				sizeof(psi_desc_ctx_t));
 		*ref_psi_desc_ctx= NULL;
 	}
 }
 
+void psi_desc_ctx_release_data(psi_desc_ctx_t *psi_desc_ctx)
+{
+	if(psi_desc_ctx== NULL)
+		return;
+	psi_desc_data_release(psi_desc_ctx, &psi_desc_ctx->data);
+}
+
+int psi_desc_ctx_cmp(const psi_desc_ctx_t *psi_desc_ctx1,
+		const psi_desc_ctx_t *psi_desc_ctx2)
+{
+	uint8_t buf1[2+ 255], buf2[2+ 255];
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_desc_ctx1!= NULL, return 1);
+	CHECK_DO(psi_desc_ctx2!= NULL, return 1);
+
+	/* Shared (immutable) descriptor */
+	if(psi_desc_ctx1== psi_desc_ctx2)
+		return 0;
+
+	if(psi_desc_ctx1->descriptor_tag!= psi_desc_ctx2->descriptor_tag ||
+			psi_desc_ctx1->descriptor_length!=
+					psi_desc_ctx2->descriptor_length)
+		return 1;
+
+	/* Parsed descriptors: compare raw data bytes */
+	if(psi_desc_ctx1->raw!= NULL && psi_desc_ctx2->raw!= NULL)
+		return memcmp(psi_desc_ctx1->raw, psi_desc_ctx2->raw,
+				psi_desc_ctx1->descriptor_length);
+
+	/* Otherwise compare encoded descriptors */
+	CHECK_DO(psi_desc_enc(LOG_CTX_GET(), psi_desc_ctx1, buf1)== STAT_SUCCESS,
+			return 1);
+	CHECK_DO(psi_desc_enc(LOG_CTX_GET(), psi_desc_ctx2, buf2)== STAT_SUCCESS,
+			return 1);
+	return memcmp(buf1, buf2, 2+ psi_desc_ctx1->descriptor_length);
+}
+
+void* psi_desc_ctx_get_data(const psi_desc_ctx_t *psi_desc_ctx)
+{
+	void *data, *data_curr= NULL;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_desc_ctx!= NULL, return NULL);
+
+	/* Check if data is already available */
+	data= __atomic_load_n(&psi_desc_ctx->data, __ATOMIC_ACQUIRE);
+	if(data!= NULL || psi_desc_ctx->raw== NULL)
+		return data;
+
+	/* Decode specific data fields from raw data */
+	data= psi_desc_dec_data(NULL, psi_desc_ctx->descriptor_tag,
+			psi_desc_ctx->raw, psi_desc_ctx->descriptor_length);
+	if(data== NULL)
+		return NULL;
+
+	/* Memoize decoded data. Descriptors of shared (immutable) tables may be
+	 * accessed concurrently; if other thread was first, use its data.
+	 */
+	if(!__atomic_compare_exchange_n((void**)&psi_desc_ctx->data, &data_curr,
+			data, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		psi_desc_data_release(psi_desc_ctx, &data);
+		data= data_curr;
+	}
+	return data;
+}
+
 psi_desc_ctx_t* psi_desc_ctx_filter_tag(llist_t *psi_desc_ctx_llist,
 		int *ret_index, int tag)
 {
 	int i;
+	llist_t *n;
 	LOG_CTX_INIT(NULL);
 
 	/* Check arguments.
@@ -140,14 +273,17 @@ psi_desc_ctx_t* psi_desc_ctx_filter_tag(llist_t *psi_desc_ctx_llist,
 	 */
 	CHECK_DO(psi_desc_ctx_llist!= NULL, return NULL);
 
-	for(i= 0;; i++) {
-		psi_desc_ctx_t *psi_desc_ctx= (psi_desc_ctx_t*)llist_get_nth(
-				psi_desc_ctx_llist, i);
+	/* Walk the list nodes (a linear scan; 'llist_get_nth()' would walk the
+	 * list from the head for each position).
+	 */
+	for(n= psi_desc_ctx_llist, i= 0; n!= NULL; n= n->next, i++) {
+		psi_desc_ctx_t *psi_desc_ctx= (psi_desc_ctx_t*)n->data;
 		if(psi_desc_ctx== NULL)
-			break; // end of list reached
+			continue;
 		if(psi_desc_ctx->descriptor_tag== (uint8_t)tag) {
 			if(ret_index!= NULL)
 				*ret_index= i;
+			psi_desc_ctx_get_data(psi_desc_ctx); // Decode on demand
 			return psi_desc_ctx;
 		}
 	}
@@ -270,7 +406,8 @@ int psi_desc_dvb_subt_rest_get(const psi_desc_ctx_t *psi_desc_ctx_subt,
 		goto end;
 	}
 
-	psi_desc_dvb_subt_ctx= (psi_desc_dvb_subt_ctx_t*)psi_desc_ctx_subt->data;
+	psi_desc_dvb_subt_ctx= (psi_desc_dvb_subt_ctx_t*)psi_desc_ctx_get_data(
+			psi_desc_ctx_subt);
 	CHECK_DO(psi_desc_dvb_subt_ctx!= NULL, goto end);
 
 	/* JSON structure for DVB-subtitling descriptor is as follows:
@@ -798,3 +935,36 @@ const const psi_desc_lu_ctx_t psi_desc_lutable[256]=
 		{0xfe, "user_defined"},
 		{0xFF, "forbidden"}
 };
+
+/**
+ * Release descriptor specific data fields (given by reference), according
+ * to the descriptor tag. Raw data bytes are not released.
+ */
+static void psi_desc_data_release(const psi_desc_ctx_t *psi_desc_ctx,
+		void **ref_data)
+{
+	if(*ref_data== NULL || *ref_data== (void*)psi_desc_ctx->raw) {
+		*ref_data= NULL;
+		return;
+	}
+
+	switch(psi_desc_ctx->descriptor_tag) {
+	case PSI_DESC_TAG_DVB_SERVICE: {
+		psi_desc_dvb_service_ctx_t *psi_desc_dvb_service_ctx=
+				(psi_desc_dvb_service_ctx_t*)*ref_data;
+		psi_desc_dvb_service_ctx_release(&psi_desc_dvb_service_ctx);
+		break;
+	}
+	case PSI_DESC_TAG_DVB_SUBT: {
+		psi_desc_dvb_subt_ctx_t *psi_desc_dvb_subt_ctx=
+				(psi_desc_dvb_subt_ctx_t*)*ref_data;
+		psi_desc_dvb_subt_ctx_release(&psi_desc_dvb_subt_ctx);
+		break;
+	}
+	default:
+		//LOGV("Unknown descriptor type\n"); //comment-me
+		free(*ref_data);
+		break;
+	}
+	*ref_data= NULL;
+}
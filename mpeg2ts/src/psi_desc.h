@@ -41,6 +41,7 @@
 typedef struct llist_s llist_t;
 typedef struct log_ctx_s log_ctx_t;
 typedef struct cJSON cJSON;
+typedef struct psi_section_ctx_s psi_section_ctx_t;
 
 typedef struct psi_desc_lu_ctx_s {
 	uint8_t descriptor_tag;
@@ -69,8 +70,21 @@ typedef struct psi_desc_ctx_s {
 	uint8_t descriptor_length;
 	/**
 	 * Descriptor data fields.
+	 * For descriptors parsed from a section, the descriptor specific data is
+	 * decoded on demand from the raw data bytes (see 'raw' field), thus this
+	 * field may be NULL until it is accessed using 'psi_desc_ctx_get_data()'
+	 * or 'psi_desc_ctx_filter_tag()'. For not supported descriptors, the
+	 * data fields are just the raw data bytes.
 	 */
 	void *data;
+	/**
+	 * Raw descriptor data bytes (the 'descriptor_length' bytes following the
+	 * 'descriptor_length' field) as parsed from the section. Allocated in
+	 * the same memory block as this structure; NULL if the descriptor was
+	 * not parsed (e.g. composed using the REST API).
+	 * Parsed descriptors should be treated as read-only.
+	 */
+	const uint8_t *raw;
 } psi_desc_ctx_t;
 
 /**
@@ -142,6 +156,43 @@ typedef struct psi_desc_dvb_subt_ctx_s {
  */
 psi_desc_ctx_t* psi_desc_ctx_allocate();
 
+/**
+ * Allocate a descriptor context structure holding a copy of the given raw
+ * descriptor data bytes (see 'psi_desc_ctx_t::raw'). The descriptor
+ * specific data is not decoded until it is accessed.
+ * @param descriptor_tag Descriptor tag.
+ * @param descriptor_length Size of the raw descriptor data in bytes.
+ * @param raw Raw descriptor data bytes (may be NULL if 'descriptor_length'
+ * is zero).
+ * @return Descriptor context structure, NULL if fails.
+ */
+psi_desc_ctx_t* psi_desc_ctx_allocate_raw(uint8_t descriptor_tag,
+		uint8_t descriptor_length, const uint8_t *raw);
+
+/**
+ * Same as 'psi_desc_ctx_allocate_raw()', but the descriptor is allocated
+ * from the arena of the given section (see
+ * 'psi_section_ctx_allocate_arena()'); it is then released with the section
+ * and not using 'psi_desc_ctx_release()'.
+ * @param psi_section_ctx_arena Arena allocated section context structure;
+ * if NULL, the descriptor is allocated as in 'psi_desc_ctx_allocate_raw()'.
+ * @param descriptor_tag Descriptor tag.
+ * @param descriptor_length Size of the raw descriptor data in bytes.
+ * @param raw Raw descriptor data bytes.
+ * @return Descriptor context structure, NULL if fails.
+ */
+psi_desc_ctx_t* psi_desc_ctx_allocate_raw_arena(
+		psi_section_ctx_t *psi_section_ctx_arena, uint8_t descriptor_tag,
+		uint8_t descriptor_length, const uint8_t *raw);
+
+/**
+ * Get the size in bytes of the memory block holding a descriptor context
+ * structure and its raw data (see 'psi_desc_ctx_allocate_raw()').
+ * @param descriptor_length Size of the raw descriptor data in bytes.
+ * @return Memory block size in bytes.
+ */
+size_t psi_desc_ctx_raw_size(uint8_t descriptor_length);
+
 /**
  * //TODO
  */
@@ -153,7 +204,38 @@ psi_desc_ctx_t* psi_desc_ctx_dup(const psi_desc_ctx_t* psi_desc_ctx);
 void psi_desc_ctx_release(psi_desc_ctx_t **ref_psi_desc_ctx);
 
 /**
- * //TODO
+ * Release the descriptor specific data decoded on demand (see
+ * 'psi_desc_ctx_get_data()'), keeping the descriptor and its raw data.
+ * Used to release the descriptors allocated from a section arena (see
+ * 'psi_desc_ctx_allocate_raw_arena()').
+ * @param psi_desc_ctx Descriptor context structure.
+ */
+void psi_desc_ctx_release_data(psi_desc_ctx_t *psi_desc_ctx);
+
+/**
+ * Compare two descriptors by their encoded representation (tag, length and
+ * descriptor data bytes). Parsed descriptors are compared using their raw
+ * data bytes, thus descriptor specific data is not decoded.
+ * @param psi_desc_ctx1 Descriptor context structure.
+ * @param psi_desc_ctx2 Descriptor context structure.
+ * @return 0 if descriptors are equal, non-zero otherwise.
+ */
+int psi_desc_ctx_cmp(const psi_desc_ctx_t *psi_desc_ctx1,
+		const psi_desc_ctx_t *psi_desc_ctx2);
+
+/**
+ * Get descriptor specific data fields, decoding them from the raw data bytes
+ * if not done yet (decoded data is kept in the descriptor for next calls).
+ * Thread-safe: descriptors of shared tables may be accessed concurrently.
+ * @param psi_desc_ctx Descriptor context structure.
+ * @return Pointer to the descriptor data fields (do not release), NULL if
+ * the descriptor has no data or can not be decoded.
+ */
+void* psi_desc_ctx_get_data(const psi_desc_ctx_t *psi_desc_ctx);
+
+/**
+ * Get the first descriptor with the given tag in the list (descriptor data
+ * fields are decoded on demand; see 'psi_desc_ctx_get_data()').
  */
 psi_desc_ctx_t* psi_desc_ctx_filter_tag(llist_t *psi_desc_ctx_llist,
 		int *ret_index, int tag);
@@ -38,7 +38,6 @@
 
 #define GET_BITS(b) bitparser_get(bitparser_ctx, (b))
 #define FLUSH_BITS(b) bitparser_flush(bitparser_ctx, (b))
-#define COPY_BYTES(B) bitparser_copy_bytes(bitparser_ctx, (B))
 
 /* **** Prototypes **** */
 
@@ -46,68 +45,90 @@ static psi_desc_dvb_service_ctx_t* psi_desc_dec_dvb_service(log_ctx_t *log_ctx,
 		bitparser_ctx_t *bitparser_ctx, size_t size);
 
 static psi_desc_dvb_subt_ctx_t* psi_desc_dec_dvb_subt(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size);
+		bitparser_ctx_t *bitparser_ctx, size_t size);
 
 /* **** Implementations **** */
 
 psi_desc_ctx_t* psi_desc_dec(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t max_size)
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t max_size,
+		psi_section_ctx_t *psi_section_ctx_arena)
 {
-	void **data;
-	size_t desc_length= 0;
-	psi_desc_ctx_t *psi_desc_ctx= NULL;
-	int end_code= STAT_ERROR;
+	size_t i;
+	uint8_t descriptor_tag, descriptor_length;
+	uint8_t raw[256];
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments.
-	 * Note: Argument 'log_ctx' is allowed to be 'NULL'.
+	 * Note: Arguments 'log_ctx' and 'psi_section_ctx_arena' are allowed to
+	 * be 'NULL'.
 	 */
 	CHECK_DO(bitparser_ctx!= NULL, return NULL);
 	//CHECK_DO(max_size> 2, return NULL);
 
-	/* Allocate generic descriptor context structure */
-	psi_desc_ctx= psi_desc_ctx_allocate();
-	CHECK_DO(psi_desc_ctx!= NULL, goto end);
-
 	/* Parse fields */
-	psi_desc_ctx->descriptor_tag= GET_BITS(8);
-	desc_length= psi_desc_ctx->descriptor_length= GET_BITS(8);
-	if((desc_length+ 2)> max_size) {
+	descriptor_tag= GET_BITS(8);
+	descriptor_length= GET_BITS(8);
+	if(((size_t)descriptor_length+ 2)> max_size) {
 		LOGEV("Inconsistent descriptor size: the sum of the sizes of "
 				"descriptors is greater than the size declared in stream. "
 				"PID= %u (0x%0x).\n", pid, pid);
-		goto end;
+		return NULL;
+	}
+	//LOGV("Found descriptor; tag is: '0x%0x'\n", descriptor_tag); //comment-me
+
+	/* Keep raw descriptor data; specific data fields are decoded on demand
+	 * (see 'psi_desc_ctx_get_data()').
+	 */
+	for(i= 0; i+ 4<= descriptor_length; i+= 4) {
+		uint32_t word= GET_BITS(32);
+		raw[i]= (uint8_t)(word>> 24);
+		raw[i+ 1]= (uint8_t)(word>> 16);
+		raw[i+ 2]= (uint8_t)(word>> 8);
+		raw[i+ 3]= (uint8_t)word;
 	}
-	data= &psi_desc_ctx->data;
-	//LOGV("Found descriptor; tag is: '0x%0x'\n",
-	//		psi_desc_ctx->descriptor_tag); //comment-me
-	switch(psi_desc_ctx->descriptor_tag) {
+	for(; i< descriptor_length; i++)
+		raw[i]= GET_BITS(8);
+
+	return psi_desc_ctx_allocate_raw_arena(psi_section_ctx_arena,
+			descriptor_tag, descriptor_length, raw);
+}
+
+void* psi_desc_dec_data(log_ctx_t *log_ctx, uint8_t descriptor_tag,
+		const uint8_t *raw, size_t size)
+{
+	void *data= NULL;
+	bitparser_ctx_t *bitparser_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments.
+	 * Note: Argument 'log_ctx' is allowed to be 'NULL'.
+	 */
+	CHECK_DO(raw!= NULL, return NULL);
+
+	if(descriptor_tag!= PSI_DESC_TAG_DVB_SERVICE &&
+			descriptor_tag!= PSI_DESC_TAG_DVB_SUBT)
+		return NULL; // Not supported
+
+	/* Initialize bit-parser (see note on buffer size in function
+	 * 'psi_dec_section()').
+	 */
+	bitparser_ctx= bitparser_open((void*)raw, EXTEND_SIZE_TO_MULTIPLE(size,
+			sizeof(WORD_T)));
+	CHECK_DO(bitparser_ctx!= NULL, return NULL);
+
+	switch(descriptor_tag) {
 	case PSI_DESC_TAG_DVB_SERVICE:
-		*data= (void*)psi_desc_dec_dvb_service(log_ctx, bitparser_ctx,
-				desc_length);
+		data= (void*)psi_desc_dec_dvb_service(log_ctx, bitparser_ctx, size);
 		break;
 	case PSI_DESC_TAG_DVB_SUBT:
-		*data= (void*)psi_desc_dec_dvb_subt(log_ctx, bitparser_ctx, pid,
-				desc_length);
+		data= (void*)psi_desc_dec_dvb_subt(log_ctx, bitparser_ctx, size);
 		break;
 	default:
-		//LOGV("Unknown descriptor type (tag: %u, length: %u)\n",
-		//		psi_desc_ctx->descriptor_tag,
-		//		desc_length); // comment-me
-		if(desc_length> 0)
-			*data= COPY_BYTES(desc_length);
-		else
-			*data= NULL;
-		end_code= STAT_ENOTFOUND;
-		goto end;
+		break;
 	}
-	if(psi_desc_ctx->data== NULL) goto end;
 
-	end_code= STAT_SUCCESS;
-end:
-	if(end_code!= STAT_SUCCESS && end_code!= STAT_ENOTFOUND)
-		psi_desc_ctx_release(&psi_desc_ctx);
-	return psi_desc_ctx;
+	bitparser_close(&bitparser_ctx);
+	return data;
 }
 
 static psi_desc_dvb_service_ctx_t* psi_desc_dec_dvb_service(log_ctx_t *log_ctx,
@@ -147,7 +168,7 @@ end:
 }
 
 static psi_desc_dvb_subt_ctx_t* psi_desc_dec_dvb_subt(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size)
+		bitparser_ctx_t *bitparser_ctx, size_t size)
 {
 	int i, ret_code, end_code= STAT_ERROR;
 	psi_desc_dvb_subt_nth_ctx_t *psi_desc_dvb_subt_nth_ctx= NULL;
@@ -164,8 +185,8 @@ static psi_desc_dvb_subt_ctx_t* psi_desc_dec_dvb_subt(log_ctx_t *log_ctx,
 	/* Check compliance: descriptor loop size. */
 	if((size& 7)!= 0) {
 		LOGEV("Illegal DVB subtitling descriptor: descriptor size "
-				"should be multiple of 8 bytes (declared size is %d). "
-				"PID= %u (0x%0x).\n", (int)size, pid, pid);
+				"should be multiple of 8 bytes (declared size is %d).\n",
+				(int)size);
 		goto end;
 	}
 
@@ -34,13 +34,35 @@
 typedef struct bitparser_ctx_s bitparser_ctx_t;
 typedef struct log_ctx_s log_ctx_t;
 typedef struct psi_desc_ctx_s psi_desc_ctx_t;
+typedef struct psi_section_ctx_s psi_section_ctx_t;
 
 /* **** Prototypes **** */
 
 /**
- * //TODO
+ * Parse descriptor: only the descriptor header is parsed and the raw
+ * descriptor data bytes are kept; specific data fields are decoded on
+ * demand (see 'psi_desc_ctx_get_data()').
+ * The descriptor is allocated from the arena of the section
+ * 'psi_section_ctx_arena' if not NULL (see
+ * 'psi_desc_ctx_allocate_raw_arena()').
  */
 psi_desc_ctx_t* psi_desc_dec(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t max_size);
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t max_size,
+		psi_section_ctx_t *psi_section_ctx_arena);
+
+/**
+ * Decode descriptor specific data fields from the given raw descriptor data.
+ * @param log_ctx LOG module context structure (may be NULL).
+ * @param descriptor_tag Descriptor tag.
+ * @param raw Raw descriptor data bytes. The buffer should be allocated
+ * rounding-up its size to a multiple of sizeof(WORD_T) bytes (bit-parser
+ * may overrun).
+ * @param size Size of the raw descriptor data in bytes.
+ * @return Descriptor specific data structure (e.g.
+ * 'psi_desc_dvb_service_ctx_t'); NULL if the descriptor is not supported or
+ * the data is not valid.
+ */
+void* psi_desc_dec_data(log_ctx_t *log_ctx, uint8_t descriptor_tag,
+		const uint8_t *raw, size_t size);
 
 #endif /* SPMPEG2TS_SRC_PSI_DESC_DEC_H_ */
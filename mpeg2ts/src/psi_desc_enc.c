@@ -71,6 +71,15 @@ int psi_desc_enc(log_ctx_t *log_ctx, const psi_desc_ctx_t *psi_desc_ctx,
 	((uint8_t*)buf)[0]= descriptor_tag= psi_desc_ctx->descriptor_tag;
 	((uint8_t*)buf)[1]= descriptor_length= psi_desc_ctx->descriptor_length;
 	data_buf= &((uint8_t*)buf)[2];
+
+	/* Parsed descriptors: just copy raw data bytes (no need to decode and
+	 * re-encode specific data fields).
+	 */
+	if(psi_desc_ctx->raw!= NULL) {
+		memcpy(data_buf, psi_desc_ctx->raw, descriptor_length);
+		end_code= STAT_SUCCESS;
+		goto end;
+	}
 	data= psi_desc_ctx->data;
 
 	/* Check if we have specific data to process */
@@ -38,6 +38,7 @@
  */
 #define PSI_DVB_NIT_PID_NUMBER 0x10
 #define PSI_DVB_SDT_PID_NUMBER 0x11
+#define PSI_DVB_EIT_PID_NUMBER 0x12
 
 /**
  * Allocation of table_id values.
@@ -45,6 +46,9 @@
  */
 #define PSI_DVB_NETWORK_INFO_SECTION_ACTUAL  0x40
 #define PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL 0x42
+#define PSI_DVB_EVENT_INFO_SECTION_PF_ACTUAL 0x4E
+#define PSI_DVB_EVENT_INFO_SECTION_SCHED_ACTUAL_MIN 0x50
+#define PSI_DVB_EVENT_INFO_SECTION_SCHED_ACTUAL_MAX 0x5F
 
 /* Forward declarations */
 typedef struct psi_desc_ctx_s psi_desc_ctx_t;
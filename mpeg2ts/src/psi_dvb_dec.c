@@ -45,25 +45,29 @@
 /* **** Prototypes **** */
 
 static psi_dvb_sds_prog_ctx_t* psi_dvb_sds_prog(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid);
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid,
+		psi_section_ctx_t *psi_section_ctx_arena);
 
 /* **** Implementations **** */
 
 psi_dvb_sds_ctx_t* psi_dvb_dec_sds(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size)
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size,
+		psi_section_ctx_t *psi_section_ctx_arena)
 {
 	psi_dvb_sds_ctx_t *psi_dvb_sds_ctx= NULL;
 	int service_data_len, ret_code, end_code= STAT_ERROR;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments.
-	 * Note: Argument 'log_ctx' is allowed to be 'NULL'.
+	 * Note: Arguments 'log_ctx' and 'psi_section_ctx_arena' are allowed to
+	 * be 'NULL'.
 	 */
 	CHECK_DO(bitparser_ctx!= NULL, return NULL);
 	CHECK_DO(size> 0, return NULL);
 
 	/* Allocate SDS context structure */
-	psi_dvb_sds_ctx= psi_dvb_sds_ctx_allocate();
+	psi_dvb_sds_ctx= PSI_SECTION_ARENA_ALLOC(psi_section_ctx_arena,
+			psi_dvb_sds_ctx_t, psi_dvb_sds_ctx_allocate);
 	CHECK_DO(psi_dvb_sds_ctx!= NULL, goto end);
 
 	/* Parse fields */
@@ -75,8 +79,10 @@ psi_dvb_sds_ctx_t* psi_dvb_dec_sds(log_ctx_t *log_ctx,
 	CHECK_DO(service_data_len<= PSI_TABLE_MPEG_MAX_SECTION_LEN, goto end);
 	while(service_data_len> 0) {
 		psi_dvb_sds_prog_ctx_t *psi_dvb_sds_prog_ctx= psi_dvb_sds_prog(log_ctx,
-				bitparser_ctx, pid);
-		ret_code= llist_push(&psi_dvb_sds_ctx->psi_dvb_sds_prog_ctx_llist,
+				bitparser_ctx, pid, psi_section_ctx_arena);
+		CHECK_DO(psi_dvb_sds_prog_ctx!= NULL, goto end);
+		ret_code= PSI_SECTION_ARENA_LLIST_PUSH(psi_section_ctx_arena,
+				&psi_dvb_sds_ctx->psi_dvb_sds_prog_ctx_llist,
 				(void*)psi_dvb_sds_prog_ctx);
 		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 		service_data_len-= PSI_DVB_SDS_PROG_FIXED_LEN+
@@ -87,13 +93,17 @@ psi_dvb_sds_ctx_t* psi_dvb_dec_sds(log_ctx_t *log_ctx,
 	end_code= STAT_SUCCESS;
 
 end:
-	if(end_code!= STAT_SUCCESS)
-		psi_dvb_sds_ctx_release(&psi_dvb_sds_ctx);
+	if(end_code!= STAT_SUCCESS) {
+		if(psi_section_ctx_arena== NULL)
+			psi_dvb_sds_ctx_release(&psi_dvb_sds_ctx);
+		psi_dvb_sds_ctx= NULL; // Arena memory is released with the section
+	}
 	return psi_dvb_sds_ctx;
 }
 
 static psi_dvb_sds_prog_ctx_t* psi_dvb_sds_prog(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid)
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid,
+		psi_section_ctx_t *psi_section_ctx_arena)
 {
 	psi_dvb_sds_prog_ctx_t *psi_dvb_sds_prog_ctx= NULL;
 	int desc_loop_length, ret_code, end_code= STAT_ERROR;
@@ -103,7 +113,8 @@ static psi_dvb_sds_prog_ctx_t* psi_dvb_sds_prog(log_ctx_t *log_ctx,
 	CHECK_DO(bitparser_ctx!= NULL, return NULL);
 
 	/* Allocate "single service description information" context structure */
-	psi_dvb_sds_prog_ctx= psi_dvb_sds_prog_ctx_allocate();
+	psi_dvb_sds_prog_ctx= PSI_SECTION_ARENA_ALLOC(psi_section_ctx_arena,
+			psi_dvb_sds_prog_ctx_t, psi_dvb_sds_prog_ctx_allocate);
 	CHECK_DO(psi_dvb_sds_prog_ctx!= NULL, goto end);
 
 	/* Parse fields */
@@ -120,10 +131,10 @@ static psi_dvb_sds_prog_ctx_t* psi_dvb_sds_prog(log_ctx_t *log_ctx,
 	CHECK_DO(desc_loop_length<= PSI_TABLE_MPEG_MAX_SECTION_LEN, goto end);
 	while(desc_loop_length> 0) {
 		psi_desc_ctx_t *psi_desc_ctx= psi_desc_dec(log_ctx, bitparser_ctx, pid,
-				desc_loop_length);
+				desc_loop_length, psi_section_ctx_arena);
 		CHECK_DO(psi_desc_ctx!= NULL, goto end);
-		ret_code= llist_push(&psi_dvb_sds_prog_ctx->psi_desc_ctx_llist,
-				(void*)psi_desc_ctx);
+		ret_code= PSI_SECTION_ARENA_LLIST_PUSH(psi_section_ctx_arena,
+				&psi_dvb_sds_prog_ctx->psi_desc_ctx_llist, (void*)psi_desc_ctx);
 		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 		desc_loop_length-= PSI_DESC_FIXED_LEN+ psi_desc_ctx->descriptor_length;
 	}
@@ -132,7 +143,10 @@ static psi_dvb_sds_prog_ctx_t* psi_dvb_sds_prog(log_ctx_t *log_ctx,
 	end_code= STAT_SUCCESS;
 
 end:
-	if(end_code!= STAT_SUCCESS)
-		psi_dvb_sds_prog_ctx_release(&psi_dvb_sds_prog_ctx);
+	if(end_code!= STAT_SUCCESS) {
+		if(psi_section_ctx_arena== NULL)
+			psi_dvb_sds_prog_ctx_release(&psi_dvb_sds_prog_ctx);
+		psi_dvb_sds_prog_ctx= NULL; // Arena memory is released with the section
+	}
 	return psi_dvb_sds_prog_ctx;
 }
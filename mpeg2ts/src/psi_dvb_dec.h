@@ -36,14 +36,19 @@
 typedef struct psi_dvb_sds_ctx_s psi_dvb_sds_ctx_t;
 typedef struct log_ctx_s log_ctx_t;
 typedef struct bitparser_ctx_s bitparser_ctx_t;
+typedef struct psi_section_ctx_s psi_section_ctx_t;
 
 /* **** Prototypes **** */
 
 /**
  * Decode Service Description section.
+ * The section specific data is allocated from the arena of the section
+ * 'psi_section_ctx_arena' if not NULL (see
+ * 'psi_section_ctx_allocate_arena()').
  * //TODO
  */
 psi_dvb_sds_ctx_t* psi_dvb_dec_sds(log_ctx_t *log_ctx,
-		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size);
+		bitparser_ctx_t *bitparser_ctx, uint16_t pid, size_t size,
+		psi_section_ctx_t *psi_section_ctx_arena);
 
 #endif /* SPMPEG2TS_SRC_PSI_DVB_DEC_H_ */
@@ -0,0 +1,594 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file psi_eit.c
+ * @author Rafael Antoniello
+ */
+
+#include "psi_eit.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include "psi_dvb.h"
+
+/* **** Definitions **** */
+
+/**
+ * EIT section fixed header length (from 'table_id' to 'last_table_id').
+ * (ETSI EN 300 468 V1.14.1 (2014-05))
+ */
+#define PSI_EIT_SECTION_HEADER_LEN 14 // (8+1+1+2+12+16+2+5+1+8+8+16+16+8+8)/8
+
+/**
+ * EIT event loop entry fixed length.
+ */
+#define PSI_EIT_EVENT_FIXED_LEN 12 // (16+ 40+ 24+ 3+ 1+ 12)/8 [bytes]
+
+/**
+ * DVB short event descriptor tag.
+ */
+#define PSI_EIT_SHORT_EVENT_DESC_TAG 0x4D
+
+/**
+ * Number of section fingerprints kept per service (power of two).
+ * Fingerprints are direct-mapped by table identifier and section number; a
+ * collision just makes the colliding section be parsed again.
+ */
+#define PSI_EIT_FP_CACHE_SIZE 32
+
+/**
+ * Modified Julian Date of the Epoch (1970-01-01).
+ */
+#define PSI_EIT_MJD_EPOCH 40587
+
+/**
+ * Returns the event at the given (logical) position of the service ring.
+ */
+#define RING_AT(SVC, I) \
+	(&(SVC)->event_ring[((SVC)->ring_start+ (I))% PSI_EIT_SERVICE_EVENTS_MAX])
+
+/**
+ * Present/following event state.
+ */
+typedef enum psi_eit_pf_state_enum {
+	PSI_EIT_PF_UNKNOWN= 0, // Present/following table not received
+	PSI_EIT_PF_EMPTY, // Received, without event
+	PSI_EIT_PF_EVENT // Received, with event
+} psi_eit_pf_state_t;
+
+/**
+ * Raw section fingerprint.
+ */
+typedef struct psi_eit_fp_s {
+	/**
+	 * 'table_id'<< 8| 'section_number'; zero if the entry is not used (EIT
+	 * table identifiers are never zero).
+	 */
+	uint16_t key;
+	uint32_t crc_32;
+} psi_eit_fp_t;
+
+/**
+ * Service context structure.
+ */
+typedef struct psi_eit_service_s {
+	uint16_t service_id;
+	/**
+	 * Present (index 0) and following (index 1) events.
+	 */
+	psi_eit_pf_state_t pf_state[2];
+	psi_eit_event_t pf_event[2];
+	/**
+	 * Schedule events ring, sorted by start time.
+	 */
+	psi_eit_event_t event_ring[PSI_EIT_SERVICE_EVENTS_MAX];
+	int ring_start;
+	int ring_count;
+	/**
+	 * Fingerprints of the last sections parsed.
+	 */
+	psi_eit_fp_t fp_array[PSI_EIT_FP_CACHE_SIZE];
+} psi_eit_service_t;
+
+/**
+ * EIT cache context structure.
+ */
+typedef struct psi_eit_ctx_s {
+	/**
+	 * Externally defined LOG module context structure instance.
+	 */
+	log_ctx_t *log_ctx;
+	/**
+	 * Schedule time horizon [seconds].
+	 */
+	int horizon_sec;
+	/**
+	 * Services array (allocated at opening; services are added in order of
+	 * appearance and never removed).
+	 */
+	psi_eit_service_t *service_array;
+	int services_num;
+	int services_max;
+	/**
+	 * Statistics.
+	 */
+	psi_eit_stats_t stats;
+} psi_eit_ctx_t;
+
+/* **** Prototypes **** */
+
+static psi_eit_service_t* psi_eit_service_get(psi_eit_ctx_t *psi_eit_ctx,
+		uint16_t service_id, int flag_add);
+static int psi_eit_event_parse(const uint8_t *buf, size_t buf_size,
+		psi_eit_event_t *psi_eit_event, size_t *ref_event_size);
+static void psi_eit_event_name(const uint8_t *buf, size_t buf_size,
+		char *event_name);
+static int psi_eit_ring_put(psi_eit_ctx_t *psi_eit_ctx,
+		psi_eit_service_t *psi_eit_service,
+		const psi_eit_event_t *psi_eit_event, int64_t now);
+static void psi_eit_ring_remove(psi_eit_service_t *psi_eit_service, int i);
+static void psi_eit_fp_sched_reset(psi_eit_service_t *psi_eit_service);
+static int64_t psi_eit_mjd_utc_to_time(const uint8_t *buf);
+static uint32_t psi_eit_bcd_to_sec(const uint8_t *buf);
+
+/* **** Implementations **** */
+
+psi_eit_ctx_t* psi_eit_open(size_t mem_budget, int horizon_sec,
+		log_ctx_t *log_ctx)
+{
+	int end_code= STAT_ERROR;
+	psi_eit_ctx_t *psi_eit_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(horizon_sec> 0, return NULL);
+
+	/* Allocate context structure */
+	psi_eit_ctx= (psi_eit_ctx_t*)calloc(1, sizeof(psi_eit_ctx_t));
+	CHECK_DO(psi_eit_ctx!= NULL, goto end);
+
+	psi_eit_ctx->log_ctx= log_ctx;
+	psi_eit_ctx->horizon_sec= horizon_sec;
+
+	/* Allocate services array (fixed footprint) */
+	psi_eit_ctx->services_max= mem_budget/ sizeof(psi_eit_service_t);
+	if(psi_eit_ctx->services_max< 1)
+		psi_eit_ctx->services_max= 1;
+	psi_eit_ctx->service_array= (psi_eit_service_t*)calloc(
+			psi_eit_ctx->services_max, sizeof(psi_eit_service_t));
+	CHECK_DO(psi_eit_ctx->service_array!= NULL, goto end);
+	psi_eit_ctx->services_num= 0;
+
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code!= STAT_SUCCESS)
+		psi_eit_close(&psi_eit_ctx);
+	return psi_eit_ctx;
+}
+
+void psi_eit_close(psi_eit_ctx_t **ref_psi_eit_ctx)
+{
+	psi_eit_ctx_t *psi_eit_ctx;
+
+	if(ref_psi_eit_ctx== NULL || (psi_eit_ctx= *ref_psi_eit_ctx)== NULL)
+		return;
+
+	if(psi_eit_ctx->service_array!= NULL)
+		free(psi_eit_ctx->service_array);
+
+	free(psi_eit_ctx);
+	*ref_psi_eit_ctx= NULL;
+}
+
+int psi_eit_section(psi_eit_ctx_t *psi_eit_ctx, const uint8_t *buf,
+		size_t buf_size, int64_t now)
+{
+	int flag_retry= 0;
+	uint8_t table_id, section_number;
+	uint16_t service_id, section_length, key;
+	uint32_t crc_32;
+	const uint8_t *p, *p_end;
+	psi_eit_service_t *psi_eit_service;
+	psi_eit_fp_t *psi_eit_fp;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_eit_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(buf!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(psi_eit_ctx->log_ctx);
+
+	/* Only the tables of the actual transport stream are cached */
+	table_id= buf_size> 0? buf[0]: 0;
+	if(table_id!= PSI_DVB_EVENT_INFO_SECTION_PF_ACTUAL &&
+			(table_id< PSI_DVB_EVENT_INFO_SECTION_SCHED_ACTUAL_MIN ||
+			table_id> PSI_DVB_EVENT_INFO_SECTION_SCHED_ACTUAL_MAX)) {
+		psi_eit_ctx->stats.sections_ignored++;
+		return STAT_NOTMODIFIED;
+	}
+
+	/* Check section length */
+	section_length= buf_size>= 3? ((buf[1]& 0x0F)<< 8)| buf[2]: 0;
+	if(section_length+ 3< PSI_EIT_SECTION_HEADER_LEN+ 4 ||
+			section_length+ 3> buf_size) {
+		LOGE("Malformed EIT section (section_length: %u)\n", section_length);
+		return STAT_ERROR;
+	}
+
+	/* Skip sections not yet applicable ('current_next_indicator') */
+	if((buf[5]& 0x01)== 0) {
+		psi_eit_ctx->stats.sections_ignored++;
+		return STAT_NOTMODIFIED;
+	}
+
+	service_id= (buf[3]<< 8)| buf[4];
+	section_number= buf[6];
+	p_end= buf+ section_length+ 3- 4;
+	crc_32= ((uint32_t)p_end[0]<< 24)| ((uint32_t)p_end[1]<< 16)|
+			((uint32_t)p_end[2]<< 8)| (uint32_t)p_end[3];
+
+	/* Get service (services not fitting in the memory budget are ignored) */
+	psi_eit_service= psi_eit_service_get(psi_eit_ctx, service_id, 1);
+	if(psi_eit_service== NULL) {
+		psi_eit_ctx->stats.sections_ignored++;
+		return STAT_NOTMODIFIED;
+	}
+
+	/* Skip unchanged sections; note that the CRC covers the version number */
+	key= (table_id<< 8)| section_number;
+	psi_eit_fp= &psi_eit_service->fp_array[
+			((uint32_t)key* 2654435761u)>> 27& (PSI_EIT_FP_CACHE_SIZE- 1)];
+	if(psi_eit_fp->key== key && psi_eit_fp->crc_32== crc_32) {
+		psi_eit_ctx->stats.sections_unchanged++;
+		return STAT_NOTMODIFIED;
+	}
+	psi_eit_fp->key= 0; // Recorded once parsed (see below)
+
+	/* Present/following table: section 0 carries the present event and
+	 * section 1 the following one (at most one event each).
+	 */
+	if(table_id== PSI_DVB_EVENT_INFO_SECTION_PF_ACTUAL && section_number> 1) {
+		psi_eit_ctx->stats.sections_ignored++;
+		return STAT_NOTMODIFIED;
+	}
+	if(table_id== PSI_DVB_EVENT_INFO_SECTION_PF_ACTUAL)
+		psi_eit_service->pf_state[section_number]= PSI_EIT_PF_EMPTY;
+
+	/* Parse events loop */
+	for(p= buf+ PSI_EIT_SECTION_HEADER_LEN; p< p_end;) {
+		int ret_code;
+		size_t event_size= 0;
+		psi_eit_event_t psi_eit_event;
+
+		ret_code= psi_eit_event_parse(p, p_end- p, &psi_eit_event,
+				&event_size);
+		if(ret_code!= STAT_SUCCESS) {
+			LOGE("Malformed EIT event (service_id: %u)\n", service_id);
+			flag_retry= 1;
+			break;
+		}
+		p+= event_size;
+
+		if(table_id== PSI_DVB_EVENT_INFO_SECTION_PF_ACTUAL) {
+			if(psi_eit_event.start_time< 0)
+				continue;
+			psi_eit_service->pf_event[section_number]= psi_eit_event;
+			psi_eit_service->pf_state[section_number]= PSI_EIT_PF_EVENT;
+			break;
+		}
+		if(psi_eit_ring_put(psi_eit_ctx, psi_eit_service, &psi_eit_event,
+				now)!= STAT_SUCCESS)
+			flag_retry= 1;
+	}
+
+	/* Record the fingerprint only if all the events were kept: events
+	 * dropped beyond the time horizon (or for lack of room) should be
+	 * taken when the section is received again.
+	 */
+	if(!flag_retry) {
+		psi_eit_fp->key= key;
+		psi_eit_fp->crc_32= crc_32;
+	}
+
+	psi_eit_ctx->stats.sections_parsed++;
+	return STAT_SUCCESS;
+}
+
+int psi_eit_get_now_next(psi_eit_ctx_t *psi_eit_ctx, uint16_t service_id,
+		int64_t now, psi_eit_event_t *ref_event_now,
+		psi_eit_event_t *ref_event_next)
+{
+	int i;
+	psi_eit_service_t *psi_eit_service;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_eit_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_event_now!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_event_next!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(psi_eit_ctx->log_ctx);
+
+	memset(ref_event_now, 0, sizeof(psi_eit_event_t));
+	memset(ref_event_next, 0, sizeof(psi_eit_event_t));
+	ref_event_now->start_time= ref_event_next->start_time= -1;
+
+	psi_eit_service= psi_eit_service_get(psi_eit_ctx, service_id, 0);
+	if(psi_eit_service== NULL)
+		return STAT_ENOTFOUND;
+
+	if(psi_eit_service->pf_state[0]!= PSI_EIT_PF_UNKNOWN ||
+			psi_eit_service->pf_state[1]!= PSI_EIT_PF_UNKNOWN) {
+		/* Present/following table is authoritative */
+		if(psi_eit_service->pf_state[0]== PSI_EIT_PF_EVENT)
+			*ref_event_now= psi_eit_service->pf_event[0];
+		if(psi_eit_service->pf_state[1]== PSI_EIT_PF_EVENT)
+			*ref_event_next= psi_eit_service->pf_event[1];
+	} else {
+		/* Look-up schedule ring (sorted by start time) */
+		for(i= 0; i< psi_eit_service->ring_count; i++) {
+			psi_eit_event_t *psi_eit_event= RING_AT(psi_eit_service, i);
+
+			if(psi_eit_event->start_time+ psi_eit_event->duration<= now)
+				continue; // Finished
+			if(psi_eit_event->start_time<= now &&
+					ref_event_now->start_time< 0) {
+				*ref_event_now= *psi_eit_event;
+				continue;
+			}
+			*ref_event_next= *psi_eit_event;
+			break;
+		}
+	}
+
+	return (ref_event_now->start_time>= 0 ||
+			ref_event_next->start_time>= 0)? STAT_SUCCESS: STAT_ENOTFOUND;
+}
+
+int psi_eit_get_stats(psi_eit_ctx_t *psi_eit_ctx,
+		psi_eit_stats_t *ref_psi_eit_stats)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_eit_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_psi_eit_stats!= NULL, return STAT_ERROR);
+
+	*ref_psi_eit_stats= psi_eit_ctx->stats;
+	ref_psi_eit_stats->services_num= psi_eit_ctx->services_num;
+	ref_psi_eit_stats->services_max= psi_eit_ctx->services_max;
+	return STAT_SUCCESS;
+}
+
+/**
+ * Find service in the services array; if not found and 'flag_add' is
+ * non-zero, the service is added if it fits in the memory budget.
+ */
+static psi_eit_service_t* psi_eit_service_get(psi_eit_ctx_t *psi_eit_ctx,
+		uint16_t service_id, int flag_add)
+{
+	int i;
+	psi_eit_service_t *psi_eit_service;
+
+	for(i= 0; i< psi_eit_ctx->services_num; i++) {
+		if(psi_eit_ctx->service_array[i].service_id== service_id)
+			return &psi_eit_ctx->service_array[i];
+	}
+	if(flag_add== 0 || psi_eit_ctx->services_num>= psi_eit_ctx->services_max)
+		return NULL;
+
+	psi_eit_service= &psi_eit_ctx->service_array[psi_eit_ctx->services_num++];
+	psi_eit_service->service_id= service_id;
+	return psi_eit_service;
+}
+
+/**
+ * Parse an event of the EIT events loop.
+ */
+static int psi_eit_event_parse(const uint8_t *buf, size_t buf_size,
+		psi_eit_event_t *psi_eit_event, size_t *ref_event_size)
+{
+	size_t descriptors_loop_length;
+
+	if(buf_size< PSI_EIT_EVENT_FIXED_LEN)
+		return STAT_ERROR;
+	descriptors_loop_length= ((buf[10]& 0x0F)<< 8)| buf[11];
+	if(PSI_EIT_EVENT_FIXED_LEN+ descriptors_loop_length> buf_size)
+		return STAT_ERROR;
+
+	psi_eit_event->event_id= (buf[0]<< 8)| buf[1];
+	psi_eit_event->start_time= psi_eit_mjd_utc_to_time(&buf[2]);
+	psi_eit_event->duration= psi_eit_bcd_to_sec(&buf[7]);
+	psi_eit_event->running_status= buf[10]>> 5;
+	psi_eit_event->free_CA_mode= (buf[10]>> 4)& 0x01;
+	psi_eit_event_name(&buf[PSI_EIT_EVENT_FIXED_LEN], descriptors_loop_length,
+			psi_eit_event->event_name);
+
+	*ref_event_size= PSI_EIT_EVENT_FIXED_LEN+ descriptors_loop_length;
+	return STAT_SUCCESS;
+}
+
+/**
+ * Get event name from the short event descriptor (empty string if not
+ * present). Only printable characters are kept.
+ */
+static void psi_eit_event_name(const uint8_t *buf, size_t buf_size,
+		char *event_name)
+{
+	const uint8_t *p, *p_end;
+	size_t i, name_len= 0;
+
+	event_name[0]= '\0';
+
+	/* Seek short event descriptor */
+	for(p= buf, p_end= buf+ buf_size; p+ 2<= p_end; p+= 2+ p[1]) {
+		if(p[0]== PSI_EIT_SHORT_EVENT_DESC_TAG && p[1]>= 4 &&
+				p+ 2+ p[1]<= p_end)
+			break;
+	}
+	if(p+ 2> p_end || p[0]!= PSI_EIT_SHORT_EVENT_DESC_TAG)
+		return;
+
+	/* Descriptor: tag, length, 'ISO_639_language_code' (3 bytes),
+	 * 'event_name_length' and 'event_name_char'.
+	 */
+	name_len= p[5];
+	if(name_len> (size_t)p[1]- 4)
+		name_len= p[1]- 4;
+	p+= 6;
+
+	/* Skip character table selection (ETSI EN 300 468, annex A) */
+	if(name_len> 0 && p[0]< 0x20) {
+		size_t skip= p[0]== 0x10? 3: (p[0]== 0x1F? 2: 1);
+		if(skip> name_len)
+			skip= name_len;
+		p+= skip;
+		name_len-= skip;
+	}
+
+	for(i= 0; name_len> 0 && i< PSI_EIT_EVENT_NAME_MAX- 1; p++, name_len--) {
+		if(p[0]>= 0x20 && p[0]!= 0x7F)
+			event_name[i++]= (char)p[0];
+	}
+	event_name[i]= '\0';
+}
+
+/**
+ * Put a schedule event in the service ring.
+ * Finished events are evicted first; an event with the same identifier or
+ * start time is replaced. If the ring is full, the latest event is dropped
+ * (the schedule fingerprints of the service are reset, as the section of the
+ * dropped event is not known).
+ * @return STAT_SUCCESS if the event is kept or is already finished;
+ * STAT_EAGAIN if the event or another one was dropped, but may be kept if
+ * the section is parsed again later (beyond the time horizon, ring full).
+ */
+static int psi_eit_ring_put(psi_eit_ctx_t *psi_eit_ctx,
+		psi_eit_service_t *psi_eit_service,
+		const psi_eit_event_t *psi_eit_event, int64_t now)
+{
+	int i, ret_code= STAT_SUCCESS;
+
+	/* Apply time horizon */
+	if(psi_eit_event->start_time< 0 ||
+			psi_eit_event->start_time+ psi_eit_event->duration<= now) {
+		psi_eit_ctx->stats.events_dropped++;
+		return STAT_SUCCESS; // Never to be kept
+	}
+	if(psi_eit_event->start_time> now+ psi_eit_ctx->horizon_sec) {
+		psi_eit_ctx->stats.events_dropped++;
+		return STAT_EAGAIN;
+	}
+
+	/* Evict finished events (at the head of the ring) */
+	while(psi_eit_service->ring_count> 0 &&
+			RING_AT(psi_eit_service, 0)->start_time+
+			RING_AT(psi_eit_service, 0)->duration<= now) {
+		psi_eit_service->ring_start= (psi_eit_service->ring_start+ 1)%
+				PSI_EIT_SERVICE_EVENTS_MAX;
+		psi_eit_service->ring_count--;
+	}
+
+	/* Remove replaced event (event may have been re-scheduled) */
+	for(i= 0; i< psi_eit_service->ring_count; i++) {
+		psi_eit_event_t *psi_eit_event_nth= RING_AT(psi_eit_service, i);
+		if(psi_eit_event_nth->event_id== psi_eit_event->event_id ||
+				psi_eit_event_nth->start_time== psi_eit_event->start_time)
+			psi_eit_ring_remove(psi_eit_service, i--);
+	}
+
+	/* Get position (ring is sorted by start time) */
+	for(i= 0; i< psi_eit_service->ring_count; i++) {
+		if(RING_AT(psi_eit_service, i)->start_time> psi_eit_event->start_time)
+			break;
+	}
+	if(psi_eit_service->ring_count== PSI_EIT_SERVICE_EVENTS_MAX) {
+		psi_eit_ctx->stats.events_dropped++;
+		if(i== psi_eit_service->ring_count)
+			return STAT_EAGAIN; // New event is the latest one
+		psi_eit_service->ring_count--; // Drop latest event
+		psi_eit_fp_sched_reset(psi_eit_service);
+		ret_code= STAT_EAGAIN;
+	}
+
+	/* Insert event */
+	for(i= psi_eit_service->ring_count; i> 0 &&
+			RING_AT(psi_eit_service, i- 1)->start_time>
+			psi_eit_event->start_time; i--)
+		*RING_AT(psi_eit_service, i)= *RING_AT(psi_eit_service, i- 1);
+	*RING_AT(psi_eit_service, i)= *psi_eit_event;
+	psi_eit_service->ring_count++;
+	return ret_code;
+}
+
+/**
+ * Remove the event at the given (logical) position of the service ring.
+ */
+static void psi_eit_ring_remove(psi_eit_service_t *psi_eit_service, int i)
+{
+	for(; i< psi_eit_service->ring_count- 1; i++)
+		*RING_AT(psi_eit_service, i)= *RING_AT(psi_eit_service, i+ 1);
+	psi_eit_service->ring_count--;
+}
+
+/**
+ * Reset the schedule section fingerprints of the service (present/following
+ * fingerprints are kept).
+ */
+static void psi_eit_fp_sched_reset(psi_eit_service_t *psi_eit_service)
+{
+	int i;
+
+	for(i= 0; i< PSI_EIT_FP_CACHE_SIZE; i++) {
+		if((psi_eit_service->fp_array[i].key>> 8)!=
+				PSI_DVB_EVENT_INFO_SECTION_PF_ACTUAL)
+			psi_eit_service->fp_array[i].key= 0;
+	}
+}
+
+/**
+ * Convert 40-bit 'start_time' field (16 LSBs of the Modified Julian Date
+ * followed by 6 BCD digits of UTC time) to seconds since the Epoch.
+ * Returns -1 if the start time is undefined (all bits set).
+ */
+static int64_t psi_eit_mjd_utc_to_time(const uint8_t *buf)
+{
+	int64_t mjd;
+
+	if(buf[0]== 0xFF && buf[1]== 0xFF && buf[2]== 0xFF && buf[3]== 0xFF &&
+			buf[4]== 0xFF)
+		return -1;
+	mjd= (buf[0]<< 8)| buf[1];
+	return (mjd- PSI_EIT_MJD_EPOCH)* 86400+ psi_eit_bcd_to_sec(&buf[2]);
+}
+
+/**
+ * Convert 24-bit (6 BCD digits) 'hhmmss' field to seconds.
+ */
+static uint32_t psi_eit_bcd_to_sec(const uint8_t *buf)
+{
+#define BCD(B) ((((B)>> 4)* 10)+ ((B)& 0x0F))
+	return BCD(buf[0])* 3600+ BCD(buf[1])* 60+ BCD(buf[2]);
+#undef BCD
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file psi_eit.h
+ * @brief DVB Event Information Table (EIT) streaming parser and schedule
+ * cache.
+ * EIT sections (present/following and schedule tables of the actual
+ * transport stream) are parsed incrementally, directly from the raw
+ * section, into a compact per-service ring of events; no table is built.
+ * The cache has a fixed memory footprint: the number of services is bounded
+ * by a memory budget, and each service keeps at most
+ * PSI_EIT_SERVICE_EVENTS_MAX events within a time horizon.
+ * Unchanged sections (which are most of them, as EIT sections are
+ * periodically re-sent) are recognized by their CRC and skipped.
+ * <br>
+ * This module is not thread safe; callers should use their own mutual
+ * exclusion (see 'proc_if_psi_eit_proc').
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_PSI_EIT_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_PSI_EIT_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+typedef struct psi_eit_ctx_s psi_eit_ctx_t;
+
+/**
+ * Maximum number of schedule events kept per service.
+ */
+#define PSI_EIT_SERVICE_EVENTS_MAX 32
+
+/**
+ * Maximum length of the event name kept (including the terminating null
+ * character) [bytes].
+ */
+#define PSI_EIT_EVENT_NAME_MAX 48
+
+/**
+ * Default memory budget for the services cache [bytes].
+ */
+#define PSI_EIT_MEM_BUDGET_DEFAULT (256* 1024)
+
+/**
+ * Default schedule time horizon (events starting later are not cached)
+ * [seconds].
+ */
+#define PSI_EIT_HORIZON_SEC_DEFAULT (24* 3600)
+
+/**
+ * Compact EIT event.
+ */
+typedef struct psi_eit_event_s {
+	/**
+	 * Event start time, in seconds since the Epoch (UTC); -1 if the event is
+	 * not available (events with undefined start time are not cached).
+	 */
+	int64_t start_time;
+	/**
+	 * Event duration [seconds].
+	 */
+	uint32_t duration;
+	/**
+	 * (16 bits) Event identifier.
+	 */
+	uint16_t event_id;
+	/**
+	 * (3 bits) Running status.
+	 */
+	uint8_t running_status;
+	/**
+	 * (1 bit) Free CA mode.
+	 */
+	uint8_t free_CA_mode;
+	/**
+	 * Event name (from the short event descriptor; null-terminated, possibly
+	 * truncated; character table selection bytes are skipped).
+	 */
+	char event_name[PSI_EIT_EVENT_NAME_MAX];
+} psi_eit_event_t;
+
+/**
+ * EIT cache statistics.
+ */
+typedef struct psi_eit_stats_s {
+	/**
+	 * Number of sections parsed.
+	 */
+	uint64_t sections_parsed;
+	/**
+	 * Number of unchanged sections skipped (CRC match).
+	 */
+	uint64_t sections_unchanged;
+	/**
+	 * Number of sections ignored (other transport stream tables, not yet
+	 * applicable sections or sections of services not fitting in the memory
+	 * budget).
+	 */
+	uint64_t sections_ignored;
+	/**
+	 * Number of schedule events dropped (out of the time horizon or ring
+	 * full).
+	 */
+	uint64_t events_dropped;
+	/**
+	 * Number of services cached and maximum number of services fitting in
+	 * the memory budget.
+	 */
+	int services_num;
+	int services_max;
+} psi_eit_stats_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Open EIT cache.
+ * All the memory is allocated at opening.
+ * @param mem_budget Memory budget for the services cache [bytes]; at least
+ * one service is always cached.
+ * @param horizon_sec Schedule time horizon [seconds].
+ * @param log_ctx LOG module context structure.
+ * @return Pointer to the EIT cache context structure; NULL if fails.
+ */
+psi_eit_ctx_t* psi_eit_open(size_t mem_budget, int horizon_sec,
+		log_ctx_t *log_ctx);
+
+/**
+ * Close EIT cache.
+ * @param ref_psi_eit_ctx Reference to the pointer to the context structure
+ * to be released; pointer is set to NULL.
+ */
+void psi_eit_close(psi_eit_ctx_t **ref_psi_eit_ctx);
+
+/**
+ * Parse raw EIT section into the cache.
+ * The section is expected to be complete and CRC-checked (e.g. as returned
+ * by 'psi_dec_read_next_section()').
+ * @param psi_eit_ctx EIT cache context structure.
+ * @param buf Raw section buffer.
+ * @param buf_size Raw section size.
+ * @param now Current time, in seconds since the Epoch (UTC); used to evict
+ * finished events and to apply the time horizon.
+ * @return STAT_SUCCESS if the section was parsed, STAT_NOTMODIFIED if the
+ * section is unchanged or ignored; STAT_ERROR if the section is malformed.
+ */
+int psi_eit_section(psi_eit_ctx_t *psi_eit_ctx, const uint8_t *buf,
+		size_t buf_size, int64_t now);
+
+/**
+ * Get the present and following events of a service.
+ * The present/following table is used if received; otherwise the events are
+ * looked-up in the schedule ring. Events not available are returned with
+ * 'start_time' set to -1.
+ * @param psi_eit_ctx EIT cache context structure.
+ * @param service_id Service identifier (program number).
+ * @param now Current time, in seconds since the Epoch (UTC).
+ * @param ref_event_now Reference to the present event returned.
+ * @param ref_event_next Reference to the following event returned.
+ * @return STAT_SUCCESS if any of the events is available, STAT_ENOTFOUND
+ * otherwise.
+ */
+int psi_eit_get_now_next(psi_eit_ctx_t *psi_eit_ctx, uint16_t service_id,
+		int64_t now, psi_eit_event_t *ref_event_now,
+		psi_eit_event_t *ref_event_next);
+
+/**
+ * Get EIT cache statistics.
+ * @param psi_eit_ctx EIT cache context structure.
+ * @param ref_psi_eit_stats Reference to the statistics structure returned.
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
+ */
+int psi_eit_get_stats(psi_eit_ctx_t *psi_eit_ctx,
+		psi_eit_stats_t *ref_psi_eit_stats);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_PSI_EIT_H_ */
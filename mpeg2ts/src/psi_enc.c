@@ -30,9 +30,9 @@
 #include <libmediaprocsutils/stat_codes.h>
 #include <libmediaprocsutils/check_utils.h>
 #include <libmediaprocsutils/llist.h>
-#include <libmediaprocsutils/crc_32_mpeg2.h>
 
 #include "psi.h"
+#include "psi_crc.h"
 #include "psi_desc.h"
 #include "psi_desc_enc.h"
 #include "ts.h"
@@ -158,7 +158,7 @@ int psi_section_ctx_enc(const psi_section_ctx_t *psi_section_ctx_arg,
 	}
 	CHECK_DO(section_length+ 3<= sizeof(sect_buf), goto end);
 
-	psi_section_ctx.crc_32= crc_32= crc_32_mpeg2(sect_buf,
+	psi_section_ctx.crc_32= crc_32= psi_crc32(sect_buf,
 			section_length+ 3- 4); // include all bytes except CRC
 	sect_buf[sect_data_size+ 8   ]= (crc_32                      )>> 24;
 	sect_buf[sect_data_size+ 8+ 1]= (crc_32& (uint32_t)0x00FF0000)>> 16;
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file psi_filter.c
+ * @author Rafael Antoniello
+ */
+
+#include "psi_filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+
+/* **** Implementations **** */
+
+void psi_filter_init(psi_filter_t *psi_filter)
+{
+	if(psi_filter== NULL)
+		return;
+	memset(psi_filter, 0, sizeof(psi_filter_t));
+}
+
+void psi_filter_set_table_id(psi_filter_t *psi_filter, uint8_t table_id)
+{
+	if(psi_filter== NULL)
+		return;
+	psi_filter->match[0]= table_id;
+	psi_filter->mask[0]= 0xFF;
+}
+
+void psi_filter_set_table_id_extension(psi_filter_t *psi_filter,
+		uint16_t table_id_extension)
+{
+	if(psi_filter== NULL)
+		return;
+	psi_filter->match[3]= (uint8_t)(table_id_extension>> 8);
+	psi_filter->match[4]= (uint8_t)table_id_extension;
+	psi_filter->mask[3]= psi_filter->mask[4]= 0xFF;
+}
+
+void psi_filter_set_version_neq(psi_filter_t *psi_filter,
+		uint8_t version_number)
+{
+	if(psi_filter== NULL)
+		return;
+	/* 'reserved' (2 bits), 'version_number' (5), 'current_next_indicator' */
+	psi_filter->match[5]= (psi_filter->match[5]& ~0x3E)|
+			((version_number& 0x1F)<< 1);
+	psi_filter->neq_mask[5]= 0x3E;
+}
+
+int psi_filter_match(const psi_filter_t *psi_filter, const uint8_t *buf,
+		size_t buf_size)
+{
+	int i;
+	uint8_t neq_mask_all= 0, neq_diff= 0;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_filter!= NULL, return 0);
+	CHECK_DO(buf!= NULL, return 0);
+
+	for(i= 0; i< PSI_FILTER_LEN; i++) {
+		const uint8_t mask= psi_filter->mask[i];
+		const uint8_t neq_mask= psi_filter->neq_mask[i];
+		uint8_t diff;
+
+		if((mask| neq_mask)== 0)
+			continue; // "Don't care" byte
+		if((size_t)i>= buf_size)
+			return 0;
+
+		diff= buf[i]^ psi_filter->match[i];
+		if((diff& mask)!= 0)
+			return 0;
+		neq_mask_all|= neq_mask;
+		neq_diff|= diff& neq_mask;
+	}
+	return (neq_mask_all== 0 || neq_diff!= 0);
+}
+
+void psi_filter_list_init(psi_filter_list_t *psi_filter_list)
+{
+	if(psi_filter_list== NULL)
+		return;
+	memset(psi_filter_list, 0, sizeof(psi_filter_list_t));
+}
+
+int psi_filter_list_add(psi_filter_list_t *psi_filter_list,
+		const psi_filter_t *psi_filter, int *ref_filter_id)
+{
+	int filter_id;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_filter_list!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_filter!= NULL, return STAT_ERROR);
+
+	/* Get first free entry */
+	for(filter_id= 0; filter_id< PSI_FILTER_LIST_MAX_NUM; filter_id++) {
+		if((psi_filter_list->used_mask& (1U<< filter_id))== 0)
+			break;
+	}
+	if(filter_id>= PSI_FILTER_LIST_MAX_NUM)
+		return STAT_ENOMEM;
+
+	memcpy(&psi_filter_list->filter_array[filter_id], psi_filter,
+			sizeof(psi_filter_t));
+	psi_filter_list->used_mask|= 1U<< filter_id;
+
+	if(ref_filter_id!= NULL)
+		*ref_filter_id= filter_id;
+	return STAT_SUCCESS;
+}
+
+int psi_filter_list_delete(psi_filter_list_t *psi_filter_list,
+		int filter_id)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_filter_list!= NULL, return STAT_ERROR);
+
+	if(filter_id< 0 || filter_id>= PSI_FILTER_LIST_MAX_NUM ||
+			(psi_filter_list->used_mask& (1U<< filter_id))== 0)
+		return STAT_ENOTFOUND;
+
+	psi_filter_list->used_mask&= ~(1U<< filter_id);
+	return STAT_SUCCESS;
+}
+
+int psi_filter_list_match(const psi_filter_list_t *psi_filter_list,
+		const uint8_t *buf, size_t buf_size)
+{
+	uint32_t used_mask;
+
+	if(psi_filter_list== NULL || (used_mask= psi_filter_list->used_mask)== 0)
+		return 1; // No filters; all sections accepted
+
+	while(used_mask!= 0) {
+		int filter_id= __builtin_ctz(used_mask);
+
+		if(psi_filter_match(&psi_filter_list->filter_array[filter_id], buf,
+				buf_size))
+			return 1;
+		used_mask&= used_mask- 1;
+	}
+	return 0;
+}
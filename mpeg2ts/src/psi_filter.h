@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file psi_filter.h
+ * @brief PSI section filters.
+ * Section filters are modeled on hardware demultiplexer filters: a section
+ * matches a filter when the masked bits of the first PSI_FILTER_LEN bytes
+ * of the raw section ('table_id' to 'last_section_number') are equal to
+ * the filter match bytes. Additionally, a "not-equal" mask may be
+ * specified, in which case at least one of the bits selected by it should
+ * differ (e.g. to get only the sections with a version number different
+ * from the current one).
+ * Filters are evaluated on the raw reassembled section, before any
+ * decoding (and before the CRC check).
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_PSI_FILTER_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_PSI_FILTER_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/**
+ * Number of section header bytes covered by a filter.
+ */
+#define PSI_FILTER_LEN 8
+
+/**
+ * Maximum number of filters in a filter list.
+ */
+#define PSI_FILTER_LIST_MAX_NUM 16
+
+/**
+ * PSI section filter.
+ * A zeroed filter (see 'psi_filter_init()') matches any section.
+ */
+typedef struct psi_filter_s {
+	/**
+	 * Match bytes.
+	 */
+	uint8_t match[PSI_FILTER_LEN];
+	/**
+	 * Mask of the bits that should be equal to the match bytes.
+	 */
+	uint8_t mask[PSI_FILTER_LEN];
+	/**
+	 * Mask of the bits that should differ from the match bytes (at least one
+	 * of them); ignored if all zero.
+	 */
+	uint8_t neq_mask[PSI_FILTER_LEN];
+} psi_filter_t;
+
+/**
+ * PSI section filter list.
+ * A section is accepted if it matches any of the filters of the list, or
+ * if the list is empty.
+ * Should be initialized using 'psi_filter_list_init()'.
+ */
+typedef struct psi_filter_list_s {
+	psi_filter_t filter_array[PSI_FILTER_LIST_MAX_NUM];
+	/**
+	 * Bit-mask of the filter array entries in use (bit 'i' set if entry 'i'
+	 * is used).
+	 */
+	uint32_t used_mask;
+} psi_filter_list_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Initialize filter (matches any section).
+ * @param psi_filter Pointer to the filter structure.
+ */
+void psi_filter_init(psi_filter_t *psi_filter);
+
+/**
+ * Set filter to match only the sections with the given 'table_id'.
+ * @param psi_filter Pointer to the filter structure.
+ * @param table_id Table identifier.
+ */
+void psi_filter_set_table_id(psi_filter_t *psi_filter, uint8_t table_id);
+
+/**
+ * Set filter to match only the sections with the given
+ * 'table_id_extension' (e.g. 'program_number' in PMT sections).
+ * @param psi_filter Pointer to the filter structure.
+ * @param table_id_extension Table identifier extension.
+ */
+void psi_filter_set_table_id_extension(psi_filter_t *psi_filter,
+		uint16_t table_id_extension);
+
+/**
+ * Set filter to match only the sections with a 'version_number' different
+ * from the given one ("not-equal" mode).
+ * @param psi_filter Pointer to the filter structure.
+ * @param version_number Version number to be skipped.
+ */
+void psi_filter_set_version_neq(psi_filter_t *psi_filter,
+		uint8_t version_number);
+
+/**
+ * Check if the given raw section matches the filter.
+ * Filter bits falling beyond the section size (e.g. short sections of
+ * less than PSI_FILTER_LEN bytes) never match.
+ * @param psi_filter Pointer to the filter structure.
+ * @param buf Raw section buffer.
+ * @param buf_size Raw section size in bytes.
+ * @return Non-zero if the section matches, zero otherwise.
+ */
+int psi_filter_match(const psi_filter_t *psi_filter, const uint8_t *buf,
+		size_t buf_size);
+
+/**
+ * Initialize filter list (empty list; all sections accepted).
+ * @param psi_filter_list Pointer to the filter list structure.
+ */
+void psi_filter_list_init(psi_filter_list_t *psi_filter_list);
+
+/**
+ * Add a copy of the given filter to the filter list.
+ * @param psi_filter_list Pointer to the filter list structure.
+ * @param psi_filter Pointer to the filter structure.
+ * @param ref_filter_id Reference to the filter Id. returned (to be used
+ * with 'psi_filter_list_delete()'). May be NULL.
+ * @return Status code (STAT_ENOMEM if the list is full).
+ */
+int psi_filter_list_add(psi_filter_list_t *psi_filter_list,
+		const psi_filter_t *psi_filter, int *ref_filter_id);
+
+/**
+ * Delete filter from the filter list.
+ * @param psi_filter_list Pointer to the filter list structure.
+ * @param filter_id Filter Id. (as returned by 'psi_filter_list_add()').
+ * @return Status code (STAT_ENOTFOUND if the filter is not in the list).
+ */
+int psi_filter_list_delete(psi_filter_list_t *psi_filter_list,
+		int filter_id);
+
+/**
+ * Check if the given raw section is accepted by the filter list.
+ * @param psi_filter_list Pointer to the filter list structure.
+ * @param buf Raw section buffer.
+ * @param buf_size Raw section size in bytes.
+ * @return Non-zero if the section matches any of the filters (or the list
+ * is empty), zero otherwise.
+ */
+int psi_filter_list_match(const psi_filter_list_t *psi_filter_list,
+		const uint8_t *buf, size_t buf_size);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_PSI_FILTER_H_ */
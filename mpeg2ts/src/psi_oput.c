@@ -0,0 +1,689 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file psi_oput.c
+ * @author Rafael Antoniello
+ */
+
+#include "psi_oput.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include "ts.h"
+#include "psi.h"
+#include "psi_enc.h"
+
+/* **** Definitions **** */
+
+/**
+ * Number of slots of the timer wheel (power of two). A revolution of the
+ * wheel covers PSI_OPUT_WHEEL_SLOTS* PSI_OPUT_SCHED_TICK_USEC microseconds;
+ * timers with longer intervals just stay in their slot for more than one
+ * revolution.
+ */
+#define PSI_OPUT_WHEEL_SLOTS 256
+#define PSI_OPUT_WHEEL_MASK (PSI_OPUT_WHEEL_SLOTS- 1)
+
+/**
+ * Timer wheel entry (one per section).
+ */
+typedef struct psi_oput_timer_s {
+	struct psi_oput_timer_s *prev;
+	struct psi_oput_timer_s *next;
+	/**
+	 * Absolute expiry tick.
+	 */
+	uint64_t expiry_tick;
+	/**
+	 * Repetition interval in ticks; zero if timer is not linked to the
+	 * wheel.
+	 */
+	uint64_t interval_ticks;
+	/**
+	 * Set by the wheel when the timer expires; cleared by the output
+	 * instance when the section is pulled.
+	 */
+	volatile int flag_due;
+} psi_oput_timer_t;
+
+/**
+ * Timer wheel shared by all the output instances.
+ */
+typedef struct psi_oput_wheel_s {
+	/**
+	 * Wheel critical section MUTEX.
+	 */
+	pthread_mutex_t mutex;
+	/**
+	 * Monotonic time corresponding to tick zero; -1 until the first pull.
+	 */
+	volatile int64_t origin_usec;
+	/**
+	 * Last tick processed.
+	 */
+	volatile uint64_t tick_curr;
+	/**
+	 * Slots: doubly linked lists of timers (indexed by
+	 * 'expiry_tick& PSI_OPUT_WHEEL_MASK').
+	 */
+	psi_oput_timer_t *slot_array[PSI_OPUT_WHEEL_SLOTS];
+} psi_oput_wheel_t;
+
+/**
+ * Cached (pre-packetized) section context structure.
+ */
+typedef struct psi_oput_section_s {
+	/**
+	 * Set to non-zero if this entry is in use.
+	 */
+	int flag_used;
+	/**
+	 * Section identification.
+	 */
+	uint16_t pid;
+	uint8_t table_id;
+	uint16_t table_id_extension;
+	uint8_t section_number;
+	/**
+	 * Transport packets carrying the section (continuity counter is set on
+	 * output).
+	 */
+	uint8_t *pkts;
+	int pkts_num;
+	/**
+	 * Repetition timer.
+	 */
+	psi_oput_timer_t timer;
+} psi_oput_section_t;
+
+/**
+ * Output PSI generator instance context structure.
+ */
+typedef struct psi_oput_ctx_s {
+	/**
+	 * Externally defined LOG module context structure instance.
+	 */
+	log_ctx_t *log_ctx;
+	/**
+	 * Instance critical section MUTEX.
+	 * Note that the wheel MUTEX may be taken while holding this one, never
+	 * the opposite.
+	 */
+	pthread_mutex_t mutex;
+	/**
+	 * Cached sections.
+	 */
+	psi_oput_section_t section_array[PSI_OPUT_SECTIONS_MAX];
+	/**
+	 * Next continuity counter of each output PID.
+	 */
+	uint8_t cc_next[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Statistics.
+	 */
+	psi_oput_stats_t psi_oput_stats;
+} psi_oput_ctx_t;
+
+/**
+ * Process-wide timer wheel.
+ */
+static psi_oput_wheel_t psi_oput_wheel= {
+	PTHREAD_MUTEX_INITIALIZER, -1, 0, {NULL}
+};
+
+/* **** Prototypes **** */
+
+static void psi_oput_wheel_link(psi_oput_timer_t *psi_oput_timer);
+static void psi_oput_wheel_unlink(psi_oput_timer_t *psi_oput_timer);
+static void psi_oput_wheel_schedule(psi_oput_timer_t *psi_oput_timer,
+		uint64_t interval_ticks);
+static void psi_oput_wheel_advance(int64_t now_usec);
+static int psi_oput_packetize(const uint8_t *sect_buf, size_t sect_size,
+		uint16_t pid, uint8_t **ref_pkts, int *ref_pkts_num,
+		log_ctx_t *log_ctx);
+static size_t psi_oput_section_copy(psi_oput_ctx_t *psi_oput_ctx,
+		psi_oput_section_t *psi_oput_section, uint8_t *buf);
+
+/* **** Implementations **** */
+
+psi_oput_ctx_t* psi_oput_open(log_ctx_t *log_ctx)
+{
+	int ret_code;
+	psi_oput_ctx_t *psi_oput_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Allocate context structure */
+	psi_oput_ctx= (psi_oput_ctx_t*)calloc(1, sizeof(psi_oput_ctx_t));
+	CHECK_DO(psi_oput_ctx!= NULL, return NULL);
+
+	psi_oput_ctx->log_ctx= log_ctx;
+
+	/* Initialize MUTEX (on failure we can not use 'psi_oput_close()') */
+	ret_code= pthread_mutex_init(&psi_oput_ctx->mutex, NULL);
+	CHECK_DO(ret_code== 0, free(psi_oput_ctx); return NULL);
+
+	return psi_oput_ctx;
+}
+
+void psi_oput_close(psi_oput_ctx_t **ref_psi_oput_ctx)
+{
+	int i;
+	psi_oput_ctx_t *psi_oput_ctx;
+	LOG_CTX_INIT(NULL);
+
+	if(ref_psi_oput_ctx== NULL || (psi_oput_ctx= *ref_psi_oput_ctx)== NULL)
+		return;
+
+	/* Unschedule and release sections */
+	ASSERT(pthread_mutex_lock(&psi_oput_wheel.mutex)== 0);
+	for(i= 0; i< PSI_OPUT_SECTIONS_MAX; i++) {
+		if(psi_oput_ctx->section_array[i].flag_used)
+			psi_oput_wheel_schedule(&psi_oput_ctx->section_array[i].timer, 0);
+	}
+	ASSERT(pthread_mutex_unlock(&psi_oput_wheel.mutex)== 0);
+	for(i= 0; i< PSI_OPUT_SECTIONS_MAX; i++) {
+		if(psi_oput_ctx->section_array[i].pkts!= NULL)
+			free(psi_oput_ctx->section_array[i].pkts);
+	}
+
+	ASSERT(pthread_mutex_destroy(&psi_oput_ctx->mutex)== 0);
+
+	free(psi_oput_ctx);
+	*ref_psi_oput_ctx= NULL;
+}
+
+int psi_oput_section_set(psi_oput_ctx_t *psi_oput_ctx,
+		const psi_section_ctx_t *psi_section_ctx, uint16_t pid,
+		int interval_msec)
+{
+	int ret_code, end_code= STAT_ERROR;
+	void *sect_buf= NULL;
+	size_t sect_size= 0;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_oput_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_section_ctx!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(psi_oput_ctx->log_ctx);
+
+	/* Encode section (CRC is computed by the encoder) */
+	ret_code= psi_section_ctx_enc(psi_section_ctx, pid, LOG_CTX_GET(),
+			&sect_buf, &sect_size);
+	CHECK_DO(ret_code== STAT_SUCCESS && sect_buf!= NULL, goto end);
+
+	end_code= psi_oput_section_set_raw(psi_oput_ctx, (const uint8_t*)sect_buf,
+			sect_size, pid, interval_msec);
+end:
+	if(sect_buf!= NULL)
+		free(sect_buf);
+	return end_code;
+}
+
+int psi_oput_section_set_raw(psi_oput_ctx_t *psi_oput_ctx,
+		const uint8_t *sect_buf, size_t sect_size, uint16_t pid,
+		int interval_msec)
+{
+	int i, idx= -1, idx_free= -1, pkts_num= 0, flag_changed,
+			end_code= STAT_ERROR;
+	uint8_t table_id, section_number= 0;
+	uint16_t table_id_extension= 0;
+	uint64_t interval_ticks;
+	uint8_t *pkts= NULL;
+	psi_oput_section_t *psi_oput_section;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_oput_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(sect_buf!= NULL, return STAT_ERROR);
+	CHECK_DO(sect_size>= 3 && sect_size<= PSI_TABLE_MAX_SECTION_LEN,
+			return STAT_ERROR);
+	CHECK_DO(pid< TS_MAX_PID_VAL, return STAT_ERROR);
+	CHECK_DO(interval_msec>= 0, return STAT_ERROR);
+
+	LOG_CTX_SET(psi_oput_ctx->log_ctx);
+
+	/* Get section identification (long-form sections) */
+	table_id= sect_buf[0];
+	if((sect_buf[1]& 0x80) && sect_size>= 8) {
+		table_id_extension= ((uint16_t)sect_buf[3]<< 8)| sect_buf[4];
+		section_number= sect_buf[6];
+	}
+	interval_ticks= ((uint64_t)interval_msec* 1000+
+			PSI_OPUT_SCHED_TICK_USEC- 1)/ PSI_OPUT_SCHED_TICK_USEC;
+
+	/* Packetize section (out of the critical section) */
+	end_code= psi_oput_packetize(sect_buf, sect_size, pid, &pkts, &pkts_num,
+			LOG_CTX_GET());
+	CHECK_DO(end_code== STAT_SUCCESS, return end_code);
+
+	ASSERT(pthread_mutex_lock(&psi_oput_ctx->mutex)== 0);
+
+	/* Look for the section entry (or a free one) */
+	for(i= 0; i< PSI_OPUT_SECTIONS_MAX; i++) {
+		psi_oput_section= &psi_oput_ctx->section_array[i];
+		if(!psi_oput_section->flag_used) {
+			if(idx_free< 0)
+				idx_free= i;
+			continue;
+		}
+		if(psi_oput_section->pid== pid &&
+				psi_oput_section->table_id== table_id &&
+				psi_oput_section->table_id_extension== table_id_extension &&
+				psi_oput_section->section_number== section_number) {
+			idx= i;
+			break;
+		}
+	}
+	if(idx< 0) {
+		if(idx_free< 0) {
+			LOGE("Maximum number of output PSI sections reached\n");
+			end_code= STAT_ENOMEM;
+			goto end;
+		}
+		idx= idx_free;
+		psi_oput_section= &psi_oput_ctx->section_array[idx];
+		psi_oput_section->flag_used= 1;
+		psi_oput_section->pid= pid;
+		psi_oput_section->table_id= table_id;
+		psi_oput_section->table_id_extension= table_id_extension;
+		psi_oput_section->section_number= section_number;
+	}
+	psi_oput_section= &psi_oput_ctx->section_array[idx];
+
+	/* Update cached packets only if contents changed */
+	flag_changed= (psi_oput_section->pkts_num!= pkts_num ||
+			memcmp(psi_oput_section->pkts, pkts, pkts_num* TS_PKT_SIZE)!= 0);
+	if(flag_changed) {
+		uint8_t *pkts_prev= psi_oput_section->pkts;
+		psi_oput_section->pkts= pkts;
+		psi_oput_section->pkts_num= pkts_num;
+		pkts= pkts_prev; // released below
+		psi_oput_ctx->psi_oput_stats.sections_packetized++;
+	}
+
+	/* (Re-)schedule repetition */
+	if(psi_oput_section->timer.interval_ticks!= interval_ticks) {
+		ASSERT(pthread_mutex_lock(&psi_oput_wheel.mutex)== 0);
+		psi_oput_wheel_schedule(&psi_oput_section->timer, interval_ticks);
+		ASSERT(pthread_mutex_unlock(&psi_oput_wheel.mutex)== 0);
+	}
+
+	/* New or changed sections are output on next pull */
+	if(flag_changed && interval_ticks> 0)
+		__atomic_store_n(&psi_oput_section->timer.flag_due, 1,
+				__ATOMIC_RELEASE);
+
+	end_code= STAT_SUCCESS;
+end:
+	ASSERT(pthread_mutex_unlock(&psi_oput_ctx->mutex)== 0);
+	if(pkts!= NULL)
+		free(pkts);
+	return end_code;
+}
+
+int psi_oput_section_unset(psi_oput_ctx_t *psi_oput_ctx, uint16_t pid,
+		uint8_t table_id, uint16_t table_id_extension)
+{
+	int i, end_code= STAT_ENOTFOUND;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_oput_ctx!= NULL, return STAT_ERROR);
+
+	ASSERT(pthread_mutex_lock(&psi_oput_ctx->mutex)== 0);
+	for(i= 0; i< PSI_OPUT_SECTIONS_MAX; i++) {
+		psi_oput_section_t *psi_oput_section=
+				&psi_oput_ctx->section_array[i];
+		if(!psi_oput_section->flag_used || psi_oput_section->pid!= pid ||
+				psi_oput_section->table_id!= table_id ||
+				psi_oput_section->table_id_extension!= table_id_extension)
+			continue;
+
+		ASSERT(pthread_mutex_lock(&psi_oput_wheel.mutex)== 0);
+		psi_oput_wheel_schedule(&psi_oput_section->timer, 0);
+		ASSERT(pthread_mutex_unlock(&psi_oput_wheel.mutex)== 0);
+		if(psi_oput_section->pkts!= NULL)
+			free(psi_oput_section->pkts);
+		psi_oput_section->pkts= NULL;
+		psi_oput_section->pkts_num= 0;
+		psi_oput_section->flag_used= 0;
+		// Due flag is read lock-free on the packet path
+		__atomic_store_n(&psi_oput_section->timer.flag_due, 0,
+				__ATOMIC_RELEASE);
+		end_code= STAT_SUCCESS;
+	}
+	ASSERT(pthread_mutex_unlock(&psi_oput_ctx->mutex)== 0);
+	return end_code;
+}
+
+int psi_oput_section_emit(psi_oput_ctx_t *psi_oput_ctx, uint16_t pid,
+		uint8_t table_id, uint16_t table_id_extension, uint8_t *buf,
+		size_t buf_size, size_t *ref_size)
+{
+	int i, end_code= STAT_ERROR;
+	size_t size= 0;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_oput_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(buf!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_size!= NULL, return STAT_ERROR);
+
+	*ref_size= 0;
+
+	ASSERT(pthread_mutex_lock(&psi_oput_ctx->mutex)== 0);
+
+	/* Check output buffer size */
+	for(i= 0; i< PSI_OPUT_SECTIONS_MAX; i++) {
+		psi_oput_section_t *psi_oput_section=
+				&psi_oput_ctx->section_array[i];
+		if(psi_oput_section->flag_used && psi_oput_section->pid== pid &&
+				psi_oput_section->table_id== table_id &&
+				psi_oput_section->table_id_extension== table_id_extension)
+			size+= psi_oput_section->pkts_num* TS_PKT_SIZE;
+	}
+	if(size> buf_size) {
+		end_code= STAT_ENOMEM;
+		goto end;
+	}
+
+	/* Output table sections */
+	for(i= 0, size= 0; i< PSI_OPUT_SECTIONS_MAX; i++) {
+		psi_oput_section_t *psi_oput_section=
+				&psi_oput_ctx->section_array[i];
+		if(psi_oput_section->flag_used && psi_oput_section->pid== pid &&
+				psi_oput_section->table_id== table_id &&
+				psi_oput_section->table_id_extension== table_id_extension)
+			size+= psi_oput_section_copy(psi_oput_ctx, psi_oput_section,
+					&buf[size]);
+	}
+	*ref_size= size;
+
+	end_code= STAT_SUCCESS;
+end:
+	ASSERT(pthread_mutex_unlock(&psi_oput_ctx->mutex)== 0);
+	return end_code;
+}
+
+int psi_oput_pull(psi_oput_ctx_t *psi_oput_ctx, int64_t now_usec,
+		uint8_t *buf, size_t buf_size, size_t *ref_size)
+{
+	int i, flag_due= 0;
+	size_t size= 0;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_oput_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(buf!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_size!= NULL, return STAT_ERROR);
+
+	*ref_size= 0;
+
+	/* Advance shared timer wheel */
+	psi_oput_wheel_advance(now_usec);
+
+	/* Lock-free check for due sections (most of the calls) */
+	for(i= 0; i< PSI_OPUT_SECTIONS_MAX && !flag_due; i++)
+		flag_due= __atomic_load_n(&psi_oput_ctx->section_array[i].timer.
+				flag_due, __ATOMIC_ACQUIRE);
+	if(!flag_due)
+		return STAT_SUCCESS;
+
+	ASSERT(pthread_mutex_lock(&psi_oput_ctx->mutex)== 0);
+	for(i= 0; i< PSI_OPUT_SECTIONS_MAX; i++) {
+		psi_oput_section_t *psi_oput_section=
+				&psi_oput_ctx->section_array[i];
+
+		if(!psi_oput_section->flag_used || !__atomic_exchange_n(
+				&psi_oput_section->timer.flag_due, 0, __ATOMIC_ACQ_REL))
+			continue;
+
+		/* Keep section due if it does not fit in the output buffer */
+		if(size+ psi_oput_section->pkts_num* TS_PKT_SIZE> buf_size) {
+			__atomic_store_n(&psi_oput_section->timer.flag_due, 1,
+					__ATOMIC_RELEASE);
+			continue;
+		}
+		size+= psi_oput_section_copy(psi_oput_ctx, psi_oput_section,
+				&buf[size]);
+	}
+	ASSERT(pthread_mutex_unlock(&psi_oput_ctx->mutex)== 0);
+
+	*ref_size= size;
+	return STAT_SUCCESS;
+}
+
+int psi_oput_get_stats(psi_oput_ctx_t *psi_oput_ctx,
+		psi_oput_stats_t *psi_oput_stats)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_oput_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_oput_stats!= NULL, return STAT_ERROR);
+
+	ASSERT(pthread_mutex_lock(&psi_oput_ctx->mutex)== 0);
+	memcpy(psi_oput_stats, &psi_oput_ctx->psi_oput_stats,
+			sizeof(psi_oput_stats_t));
+	ASSERT(pthread_mutex_unlock(&psi_oput_ctx->mutex)== 0);
+	return STAT_SUCCESS;
+}
+
+/**
+ * Link timer to the wheel slot corresponding to its expiry tick.
+ * Wheel MUTEX should be locked by the caller.
+ */
+static void psi_oput_wheel_link(psi_oput_timer_t *psi_oput_timer)
+{
+	psi_oput_timer_t **ref_head= &psi_oput_wheel.slot_array[
+			psi_oput_timer->expiry_tick& PSI_OPUT_WHEEL_MASK];
+
+	psi_oput_timer->prev= NULL;
+	psi_oput_timer->next= *ref_head;
+	if(*ref_head!= NULL)
+		(*ref_head)->prev= psi_oput_timer;
+	*ref_head= psi_oput_timer;
+}
+
+/**
+ * Unlink timer from its wheel slot.
+ * Wheel MUTEX should be locked by the caller.
+ */
+static void psi_oput_wheel_unlink(psi_oput_timer_t *psi_oput_timer)
+{
+	if(psi_oput_timer->prev!= NULL)
+		psi_oput_timer->prev->next= psi_oput_timer->next;
+	else
+		psi_oput_wheel.slot_array[psi_oput_timer->expiry_tick&
+				PSI_OPUT_WHEEL_MASK]= psi_oput_timer->next;
+	if(psi_oput_timer->next!= NULL)
+		psi_oput_timer->next->prev= psi_oput_timer->prev;
+	psi_oput_timer->prev= psi_oput_timer->next= NULL;
+}
+
+/**
+ * Set timer interval (zero to unschedule); first expiry is one interval
+ * after the current tick.
+ * Wheel MUTEX should be locked by the caller.
+ */
+static void psi_oput_wheel_schedule(psi_oput_timer_t *psi_oput_timer,
+		uint64_t interval_ticks)
+{
+	if(psi_oput_timer->interval_ticks> 0)
+		psi_oput_wheel_unlink(psi_oput_timer);
+	psi_oput_timer->interval_ticks= interval_ticks;
+	if(interval_ticks> 0) {
+		psi_oput_timer->expiry_tick= psi_oput_wheel.tick_curr+ interval_ticks;
+		psi_oput_wheel_link(psi_oput_timer);
+	}
+}
+
+/**
+ * Advance the timer wheel up to the given time, flagging the expired timers
+ * as due and re-linking them one interval ahead.
+ * The wheel is advanced by only one caller at a time; concurrent callers
+ * just return (their due sections are pulled on their next call).
+ */
+static void psi_oput_wheel_advance(int64_t now_usec)
+{
+	int64_t origin_usec;
+	uint64_t tick_curr, tick_target;
+	psi_oput_wheel_t *psi_oput_wheel_p= &psi_oput_wheel;
+
+	/* Lock-free check: nothing to do if no tick elapsed */
+	origin_usec= __atomic_load_n(&psi_oput_wheel_p->origin_usec,
+			__ATOMIC_ACQUIRE);
+	if(origin_usec>= 0) {
+		if(now_usec< origin_usec)
+			return;
+		tick_target= (uint64_t)(now_usec- origin_usec)/
+				PSI_OPUT_SCHED_TICK_USEC;
+		if(tick_target<= __atomic_load_n(&psi_oput_wheel_p->tick_curr,
+				__ATOMIC_ACQUIRE))
+			return;
+	}
+
+	if(pthread_mutex_trylock(&psi_oput_wheel_p->mutex)!= 0)
+		return;
+
+	/* Set time origin on first call */
+	if(psi_oput_wheel_p->origin_usec< 0) {
+		__atomic_store_n(&psi_oput_wheel_p->origin_usec, now_usec-
+				(int64_t)psi_oput_wheel_p->tick_curr* PSI_OPUT_SCHED_TICK_USEC,
+				__ATOMIC_RELEASE);
+		goto end;
+	}
+	if(now_usec< psi_oput_wheel_p->origin_usec)
+		goto end;
+	tick_target= (uint64_t)(now_usec- psi_oput_wheel_p->origin_usec)/
+			PSI_OPUT_SCHED_TICK_USEC;
+	tick_curr= psi_oput_wheel_p->tick_curr;
+
+	/* If we are late more than a revolution, visiting each slot once is
+	 * enough (all the overdue timers are found).
+	 */
+	if(tick_target> tick_curr+ PSI_OPUT_WHEEL_SLOTS)
+		tick_curr= tick_target- PSI_OPUT_WHEEL_SLOTS;
+
+	while(tick_curr< tick_target) {
+		psi_oput_timer_t *psi_oput_timer, *psi_oput_timer_next;
+		psi_oput_timer_t **ref_head;
+
+		tick_curr++;
+
+		/* Detach slot list and re-link its timers one by one */
+		ref_head= &psi_oput_wheel_p->slot_array[tick_curr&
+				PSI_OPUT_WHEEL_MASK];
+		psi_oput_timer= *ref_head;
+		*ref_head= NULL;
+		for(; psi_oput_timer!= NULL; psi_oput_timer= psi_oput_timer_next) {
+			psi_oput_timer_next= psi_oput_timer->next;
+			if(psi_oput_timer->expiry_tick<= tick_curr) {
+				__atomic_store_n(&psi_oput_timer->flag_due, 1,
+						__ATOMIC_RELEASE);
+				psi_oput_timer->expiry_tick= tick_curr+
+						psi_oput_timer->interval_ticks;
+			}
+			psi_oput_wheel_link(psi_oput_timer);
+		}
+	}
+	__atomic_store_n(&psi_oput_wheel_p->tick_curr, tick_curr,
+			__ATOMIC_RELEASE);
+
+end:
+	ASSERT(pthread_mutex_unlock(&psi_oput_wheel_p->mutex)== 0);
+}
+
+/**
+ * Packetize binary section (continuity counter is left to zero).
+ */
+static int psi_oput_packetize(const uint8_t *sect_buf, size_t sect_size,
+		uint16_t pid, uint8_t **ref_pkts, int *ref_pkts_num,
+		log_ctx_t *log_ctx)
+{
+	int i, pkts_num;
+	size_t offset= 0;
+	uint8_t *pkts= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	*ref_pkts= NULL;
+	*ref_pkts_num= 0;
+
+	pkts_num= (sect_size+ 1+ (TS_PKT_SIZE- TS_PKT_PREFIX_LEN)- 1)/
+			(TS_PKT_SIZE- TS_PKT_PREFIX_LEN); // '+1' for 'pointer_field'
+	pkts= (uint8_t*)malloc(pkts_num* TS_PKT_SIZE);
+	CHECK_DO(pkts!= NULL, return STAT_ENOMEM);
+
+	for(i= 0; i< pkts_num; i++) {
+		size_t byte_idx= TS_PKT_PREFIX_LEN, chunk_size;
+		uint8_t *pkt= &pkts[i* TS_PKT_SIZE];
+
+		pkt[0]= 0x47;
+		pkt[1]= (i== 0? 0x40: 0)| ((pid>> 8)& 0x1F);
+		pkt[2]= pid& 0xFF;
+		pkt[3]= 0x10; // payload only; CC is set on output
+		if(i== 0)
+			pkt[byte_idx++]= 0; // 'pointer_field'
+		chunk_size= TS_PKT_SIZE- byte_idx;
+		if(chunk_size> sect_size- offset)
+			chunk_size= sect_size- offset;
+		memcpy(&pkt[byte_idx], sect_buf+ offset, chunk_size);
+		memset(&pkt[byte_idx+ chunk_size], 0xFF, TS_PKT_SIZE- byte_idx-
+				chunk_size);
+		offset+= chunk_size;
+	}
+
+	*ref_pkts= pkts;
+	*ref_pkts_num= pkts_num;
+	return STAT_SUCCESS;
+}
+
+/**
+ * Copy the cached section packets to the output buffer patching the
+ * continuity counters.
+ * Instance MUTEX should be locked by the caller.
+ * @return Number of bytes copied.
+ */
+static size_t psi_oput_section_copy(psi_oput_ctx_t *psi_oput_ctx,
+		psi_oput_section_t *psi_oput_section, uint8_t *buf)
+{
+	int i;
+	const int pkts_num= psi_oput_section->pkts_num;
+	uint8_t cc= psi_oput_ctx->cc_next[psi_oput_section->pid];
+
+	memcpy(buf, psi_oput_section->pkts, pkts_num* TS_PKT_SIZE);
+	for(i= 0; i< pkts_num; i++) {
+		uint8_t *pkt= &buf[i* TS_PKT_SIZE];
+		pkt[3]= (pkt[3]& 0xF0)| cc;
+		cc= (cc+ 1)& 0x0F;
+	}
+	psi_oput_ctx->cc_next[psi_oput_section->pid]= cc;
+
+	psi_oput_ctx->psi_oput_stats.sections_output++;
+	psi_oput_ctx->psi_oput_stats.packets_output+= pkts_num;
+	return pkts_num* TS_PKT_SIZE;
+}
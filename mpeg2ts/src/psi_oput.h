@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file psi_oput.h
+ * @brief Output PSI generator module.
+ * The PSI sections to be inserted in an output (e.g. PAT, PMT, SDT) are
+ * encoded and packetized only once each time their contents change, and are
+ * kept in a per-output cache of transport packets. On emission, cached
+ * packets are just copied and the continuity counter bytes patched.
+ * Repetition of each section is scheduled, with its own interval, by a timer
+ * wheel shared by all the output instances of the process; thus the PSI
+ * insertion cost of each output is a copy of a few packets.
+ * <br>
+ * Threading model: sections are pulled/emitted from the output packet
+ * thread; sections may be set or unset from any other thread.
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_PSI_OPUT_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_PSI_OPUT_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+typedef struct psi_section_ctx_s psi_section_ctx_t;
+typedef struct psi_oput_ctx_s psi_oput_ctx_t;
+
+/**
+ * Maximum number of sections that can be set in an output instance.
+ */
+#define PSI_OPUT_SECTIONS_MAX 16
+
+/**
+ * Timer wheel resolution (repetition intervals are rounded up to a multiple
+ * of this value) [microseconds].
+ */
+#define PSI_OPUT_SCHED_TICK_USEC 10000
+
+/**
+ * Output PSI generator statistics.
+ */
+typedef struct psi_oput_stats_s {
+	/**
+	 * Number of sections packetized (new or changed sections).
+	 */
+	uint64_t sections_packetized;
+	/**
+	 * Number of sections output (repetitions).
+	 */
+	uint64_t sections_output;
+	/**
+	 * Number of transport packets output.
+	 */
+	uint64_t packets_output;
+} psi_oput_stats_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Open (allocate and initialize) an output PSI generator instance.
+ * @param log_ctx Externally defined LOG module context structure instance.
+ * @return Pointer to the instance context structure on success, NULL if
+ * fails.
+ */
+psi_oput_ctx_t* psi_oput_open(log_ctx_t *log_ctx);
+
+/**
+ * Close (release) an output PSI generator instance (all its sections are
+ * unscheduled).
+ * @param ref_psi_oput_ctx Reference to the pointer to the instance context
+ * structure to be released. Pointer is set to NULL on return.
+ */
+void psi_oput_close(psi_oput_ctx_t **ref_psi_oput_ctx);
+
+/**
+ * Set (add or update) a section to be output.
+ * The section is encoded using 'psi_section_ctx_enc()' (thus only the
+ * sections supported by the encoder can be set using this function; see
+ * 'psi_oput_section_set_raw()' otherwise).
+ * @param psi_oput_ctx Output PSI generator instance context structure.
+ * @param psi_section_ctx PSI section context structure.
+ * @param pid Output PID.
+ * @param interval_msec Repetition interval in milliseconds; zero for not
+ * scheduling the section (it is then only output using
+ * 'psi_oput_section_emit()').
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int psi_oput_section_set(psi_oput_ctx_t *psi_oput_ctx,
+		const psi_section_ctx_t *psi_section_ctx, uint16_t pid,
+		int interval_msec);
+
+/**
+ * Set (add or update) a section to be output, given the binary section.
+ * Sections are identified by the PID, the 'table_id', the
+ * 'table_id_extension' and the 'section_number'. If the section was already
+ * set with the same binary contents, the cached packets are kept (only the
+ * interval is updated); otherwise the section is packetized and scheduled
+ * to be output on the next pull.
+ * @param psi_oput_ctx Output PSI generator instance context structure.
+ * @param sect_buf Binary PSI section (CRC included).
+ * @param sect_size Size of the binary PSI section in bytes.
+ * @param pid Output PID.
+ * @param interval_msec Repetition interval in milliseconds (see
+ * 'psi_oput_section_set()').
+ * @return Status code (STAT_SUCCESS code in case of success, STAT_ENOMEM if
+ * the maximum number of sections is reached; for other code values please
+ * refer to .stat_codes.h).
+ */
+int psi_oput_section_set_raw(psi_oput_ctx_t *psi_oput_ctx,
+		const uint8_t *sect_buf, size_t sect_size, uint16_t pid,
+		int interval_msec);
+
+/**
+ * Unset all the sections of a table.
+ * @param psi_oput_ctx Output PSI generator instance context structure.
+ * @param pid Output PID.
+ * @param table_id Table identifier.
+ * @param table_id_extension Table identifier extension.
+ * @return Status code (STAT_SUCCESS code in case of success, STAT_ENOTFOUND
+ * if no section was set for the table).
+ */
+int psi_oput_section_unset(psi_oput_ctx_t *psi_oput_ctx, uint16_t pid,
+		uint8_t table_id, uint16_t table_id_extension);
+
+/**
+ * Output now all the sections of a table (regardless of their scheduling).
+ * @param psi_oput_ctx Output PSI generator instance context structure.
+ * @param pid Output PID.
+ * @param table_id Table identifier.
+ * @param table_id_extension Table identifier extension.
+ * @param buf Output buffer (transport packets are copied to it).
+ * @param buf_size Output buffer size in bytes.
+ * @param ref_size Reference to the size of the output data (a multiple of
+ * 188 bytes; zero if table is not set).
+ * @return Status code (STAT_SUCCESS code in case of success, STAT_ENOMEM if
+ * the output buffer is too small).
+ */
+int psi_oput_section_emit(psi_oput_ctx_t *psi_oput_ctx, uint16_t pid,
+		uint8_t table_id, uint16_t table_id_extension, uint8_t *buf,
+		size_t buf_size, size_t *ref_size);
+
+/**
+ * Pull the sections which repetition is due.
+ * The shared timer wheel is advanced up to the given time (by whatever
+ * output instance is pulling first), then the due sections of this instance
+ * are copied to the output buffer. Sections not fitting in the buffer are
+ * kept due for the next pull.
+ * @param psi_oput_ctx Output PSI generator instance context structure.
+ * @param now_usec Current monotonic time (see 'stc_monotonic_usec()').
+ * @param buf Output buffer (transport packets are copied to it).
+ * @param buf_size Output buffer size in bytes.
+ * @param ref_size Reference to the size of the output data (a multiple of
+ * 188 bytes; zero if no section is due).
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int psi_oput_pull(psi_oput_ctx_t *psi_oput_ctx, int64_t now_usec,
+		uint8_t *buf, size_t buf_size, size_t *ref_size);
+
+/**
+ * Get output PSI generator statistics.
+ * @param psi_oput_ctx Output PSI generator instance context structure.
+ * @param psi_oput_stats Statistics structure to be filled.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int psi_oput_get_stats(psi_oput_ctx_t *psi_oput_ctx,
+		psi_oput_stats_t *psi_oput_stats);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_PSI_OPUT_H_ */
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
 #include <pthread.h>
 
 #include "psi_proc.h"
@@ -35,12 +36,17 @@
 #include <libmediaprocsutils/schedule.h>
 #include <libmediaprocsutils/llist.h>
 #include <libmediaprocsutils/fifo.h>
+#include <libmediaprocsutils/uri_parser.h>
 #include <libmediaprocs/proc_if.h>
 #include <libmediaprocs/proc.h>
 #include "ts.h"
-//#include "ts_dec.h"
+#include "ts_dec.h"
 #include "psi.h"
+#include "psi_crc.h"
 #include "psi_dec.h"
+#include "psi_dvb.h"
+#include "psi_eit.h"
+#include "psi_filter.h"
 #include "psi_table.h"
 #include "psi_table_dec.h"
 
@@ -65,15 +71,118 @@ typedef struct psi_proc_ctx_s {
 	 */
 	pthread_mutex_t psi_opaque_ctx_mutex;
 	/**
-	 * MPEG2-TS Continuity Counter (CC) for input PSI stream.
+	 * MPEG2-TS continuity checking context for input PSI stream.
 	 */
-	uint8_t tscc_input;
+	ts_dec_cc_ctx_t tscc_input;
+	/**
+	 * Section reassembly context for input PSI stream.
+	 */
+	psi_dec_sect_ctx_t sect_input;
+	/**
+	 * Raw section fingerprints of the input PSI stream (used to skip
+	 * decoding of repeated sections).
+	 * Statistic counters are only written by the processing thread; other
+	 * threads may read slightly outdated values.
+	 */
+	psi_dec_fp_ctx_t fp_input;
 } psi_proc_ctx_t;
 
 /**
- * PSI table processor context structure.
+ * PSI demultiplexer processor: PID specific context structure.
  */
-typedef struct psi_table_proc_ctx_s {
+typedef struct psi_demux_pid_ctx_s {
+	/**
+	 * Packet identifier.
+	 */
+	uint16_t pid;
+	/**
+	 * PID parsing type (complete tables or single sections).
+	 */
+	psi_proc_pid_type_t pid_type;
+	/**
+	 * MPEG2-TS continuity checking context for the PID.
+	 */
+	ts_dec_cc_ctx_t tscc_input;
+	/**
+	 * Section reassembly context for the PID.
+	 */
+	psi_dec_sect_ctx_t sect_input;
+	/**
+	 * Section filters of the PID (applied by the section reassembly
+	 * context). Modified holding 'pid_ctx_array_mutex'.
+	 */
+	psi_filter_list_t filter_list;
+	/**
+	 * Raw section fingerprints of the PID (see 'psi_proc_ctx_t').
+	 */
+	psi_dec_fp_ctx_t fp_input;
+	/**
+	 * Table assembly map (PSI_PROC_PID_TABLE type only).
+	 */
+	psi_table_dec_map_t table_input;
+	/**
+	 * Current table (PSI_PROC_PID_TABLE type) or section
+	 * (PSI_PROC_PID_SECTION type) snapshot (last actualized version).
+	 * Accessed concurrently (use 'psi_opaque_ctx_mutex').
+	 */
+	psi_table_ctx_t *psi_table_ctx;
+	psi_section_ctx_t *psi_section_ctx;
+	/**
+	 * Raw copy of the last decoded section of each section number
+	 * (PSI_PROC_PID_TABLE type; only the first entry is used for the
+	 * PSI_PROC_PID_SECTION type). Used by the processing thread to compose
+	 * 'raw_buf'.
+	 */
+	uint8_t *raw_input_array[PSI_TABLE_DEC_MAX_SECTIONS];
+	/**
+	 * Raw sections (concatenated, as received) of the current snapshot;
+	 * NULL if not available.
+	 * Accessed concurrently (use 'psi_opaque_ctx_mutex').
+	 */
+	uint8_t *raw_buf;
+	size_t raw_buf_size;
+} psi_demux_pid_ctx_t;
+
+/**
+ * PSI demultiplexer processor context structure.
+ * A single processing thread parses all the registered PSI PIDs, which are
+ * received in the same input FIFO buffer and demultiplexed internally.
+ */
+typedef struct psi_demux_proc_ctx_s {
+	/**
+	 * Generic processor context structure.
+	 * *MUST* be the first field in order to be able to cast to proc_ctx_t.
+	 */
+	struct proc_ctx_s proc_ctx;
+	/**
+	 * PID contexts array mutual exclusion lock.
+	 * It is held by the processing thread while a packet is processed, thus
+	 * PID contexts are not released while in use.
+	 */
+	pthread_mutex_t pid_ctx_array_mutex;
+	/**
+	 * Snapshots and notification callback mutual exclusion lock (only held
+	 * to take references or swap pointers).
+	 * Lock order: 'pid_ctx_array_mutex' first.
+	 */
+	pthread_mutex_t psi_opaque_ctx_mutex;
+	/**
+	 * PID contexts, indexed by PID (NULL if the PID is not registered).
+	 * Entries are only modified holding both locks.
+	 */
+	psi_demux_pid_ctx_t *pid_ctx_array[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Version-change notification callback (NULL if not registered) and its
+	 * opaque argument. Accessed using 'psi_opaque_ctx_mutex'.
+	 */
+	psi_proc_notify_fxn_t notify_fxn;
+	void *notify_opaque;
+} psi_demux_proc_ctx_t;
+
+/**
+ * PSI EIT processor context structure.
+ */
+typedef struct psi_eit_proc_ctx_s {
 	/**
 	 * PSI common processor context structure.
 	 * *MUST* be the first field in order to be able to cast to both
@@ -81,16 +190,21 @@ typedef struct psi_table_proc_ctx_s {
 	 */
 	struct psi_proc_ctx_s psi_proc_ctx;
 	/**
-	 * Current table context structure (last actualized version).
-	 * This table will be accessed concurrently (use mutual exclusion).
+	 * Section filters: only the EIT tables of the actual transport stream
+	 * are reassembled (the other tables are skipped before the CRC check).
 	 */
-	psi_table_ctx_t *psi_table_ctx;
-} psi_table_proc_ctx_t;
+	psi_filter_list_t filter_list;
+	/**
+	 * EIT cache.
+	 * Accessed concurrently (use 'psi_opaque_ctx_mutex').
+	 */
+	psi_eit_ctx_t *psi_eit_ctx;
+} psi_eit_proc_ctx_t;
 
 /**
- * PSI section processor context structure.
+ * PSI section tap processor context structure.
  */
-typedef struct psi_section_proc_ctx_s {
+typedef struct psi_tap_proc_ctx_s {
 	/**
 	 * PSI common processor context structure.
 	 * *MUST* be the first field in order to be able to cast to both
@@ -98,11 +212,19 @@ typedef struct psi_section_proc_ctx_s {
 	 */
 	struct psi_proc_ctx_s psi_proc_ctx;
 	/**
-	 * Current section context structure (last actualized version).
-	 * This section will be accessed concurrently (use mutual exclusion).
+	 * Tap section filter (empty list if all the sections are tapped).
 	 */
-	psi_section_ctx_t *psi_section_ctx;
-} psi_section_proc_ctx_t;
+	psi_filter_list_t filter_list;
+	/**
+	 * Shared-memory FIFO the sections are written to.
+	 */
+	fifo_ctx_t *fifo_ctx_tap;
+	/**
+	 * Tap statistic counters; only written by the processing thread.
+	 */
+	volatile uint64_t sections_tapped;
+	volatile uint64_t sections_overwritten;
+} psi_tap_proc_ctx_t;
 
 /* **** Prototypes **** */
 
@@ -114,68 +236,139 @@ static int psi_proc_ctx_init(psi_proc_ctx_t *psi_proc_ctx,
 static void psi_proc_ctx_deinit(psi_proc_ctx_t *psi_proc_ctx);
 static int proc_send_frame_with_tspkt(proc_ctx_t *proc_ctx,
 		const proc_frame_ctx_t *proc_frame_ctx);
+static int psi_proc_get_stats(psi_proc_ctx_t *psi_proc_ctx,
+		psi_proc_stats_t *psi_proc_stats);
 
-/* **** PSI table processor **** */
+/* **** PSI demultiplexer processor **** */
 
-static proc_ctx_t* psi_table_proc_open(const proc_if_t *proc_if,
+static proc_ctx_t* psi_demux_proc_open(const proc_if_t *proc_if,
+		const char *settings_str, const char* href, log_ctx_t *log_ctx,
+		va_list arg);
+static void psi_demux_proc_close(proc_ctx_t **ref_proc_ctx);
+static int psi_demux_proc_send_frame(proc_ctx_t *proc_ctx,
+		const proc_frame_ctx_t *proc_frame_ctx);
+static int psi_demux_proc_process_frame(proc_ctx_t *proc_ctx,
+		fifo_ctx_t *iput_fifo_ctx, fifo_ctx_t *oput_fifo_ctx);
+static int psi_demux_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
+		va_list arg);
+static void psi_demux_proc_section(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		psi_demux_pid_ctx_t *psi_demux_pid_ctx, uint8_t *sect_buf,
+		size_t sect_buf_size, log_ctx_t *log_ctx);
+static void psi_demux_proc_notify(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		uint16_t pid, const psi_section_ctx_t *psi_section_ctx);
+static void psi_demux_proc_raw_put(psi_demux_pid_ctx_t *psi_demux_pid_ctx,
+		const uint8_t *sect_buf, size_t sect_buf_size, uint8_t section_number,
+		log_ctx_t *log_ctx);
+static void psi_demux_proc_raw_publish(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		psi_demux_pid_ctx_t *psi_demux_pid_ctx,
+		const psi_section_ctx_t *psi_section_ctx, int sections_num,
+		log_ctx_t *log_ctx);
+static int psi_demux_proc_pid_add(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		uint16_t pid, psi_proc_pid_type_t pid_type, log_ctx_t *log_ctx);
+static int psi_demux_proc_pid_delete(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		uint16_t pid, log_ctx_t *log_ctx);
+static int psi_demux_proc_pid_rest_get(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		void **ref_reponse, log_ctx_t *log_ctx);
+static int psi_demux_proc_pid_get_stats(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		psi_proc_stats_t *psi_proc_stats, log_ctx_t *log_ctx);
+static int psi_demux_proc_pid_get_raw(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		void **ref_buf, size_t *ref_buf_size, log_ctx_t *log_ctx);
+static int psi_demux_proc_pid_preload(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		const void *buf, size_t buf_size, log_ctx_t *log_ctx);
+static int psi_demux_proc_set_notify(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		psi_proc_notify_fxn_t notify_fxn, void *notify_opaque);
+static int psi_demux_proc_pid_filter_add(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		const psi_filter_t *psi_filter, int *ref_filter_id,
+		log_ctx_t *log_ctx);
+static int psi_demux_proc_pid_filter_delete(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		int filter_id, log_ctx_t *log_ctx);
+static void psi_demux_pid_ctx_release(
+		psi_demux_pid_ctx_t **ref_psi_demux_pid_ctx);
+
+/* **** PSI EIT processor **** */
+
+static proc_ctx_t* psi_eit_proc_open(const proc_if_t *proc_if,
 		const char *settings_str, const char* href, log_ctx_t *log_ctx,
 		va_list arg);
-static void psi_table_proc_close(proc_ctx_t **ref_proc_ctx);
-static int psi_table_proc_process_frame(proc_ctx_t *proc_ctx,
+static void psi_eit_proc_close(proc_ctx_t **ref_proc_ctx);
+static int psi_eit_proc_process_frame(proc_ctx_t *proc_ctx,
 		fifo_ctx_t *iput_fifo_ctx, fifo_ctx_t *oput_fifo_ctx);
-static int psi_table_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
+static int psi_eit_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 		va_list arg);
-static int psi_table_proc_rest_get(proc_ctx_t *proc_ctx,
-		const proc_if_rest_fmt_t rest_fmt, void **ref_reponse);
 
-/* **** PSI section processor **** */
+/* **** PSI section tap processor **** */
 
-static proc_ctx_t* psi_section_proc_open(const proc_if_t *proc_if,
+static proc_ctx_t* psi_tap_proc_open(const proc_if_t *proc_if,
 		const char *settings_str, const char* href, log_ctx_t *log_ctx,
 		va_list arg);
-static void psi_section_proc_close(proc_ctx_t **ref_proc_ctx);
-static int psi_section_proc_process_frame(proc_ctx_t *proc_ctx,
+static void psi_tap_proc_close(proc_ctx_t **ref_proc_ctx);
+static int psi_tap_proc_process_frame(proc_ctx_t *proc_ctx,
 		fifo_ctx_t *iput_fifo_ctx, fifo_ctx_t *oput_fifo_ctx);
-static int psi_section_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
+static int psi_tap_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 		va_list arg);
-static int psi_section_proc_rest_get(proc_ctx_t *proc_ctx,
-		const proc_if_rest_fmt_t rest_fmt, void **ref_reponse);
+static int psi_tap_hex_parse(const char *str, uint8_t *buf, size_t buf_size);
 
 /* **** Implementations **** */
 
-const proc_if_t proc_if_psi_table_proc=
+const proc_if_t proc_if_psi_demux_proc=
+{
+	"psi_demux_proc", "parser", "n/a",
+	(uint64_t)0,
+	psi_demux_proc_open,
+	psi_demux_proc_close,
+	psi_demux_proc_send_frame,
+	NULL, // send-no-dup
+	NULL, // proc_recv_frame
+	NULL, // no specific unblock function extension
+	NULL, // 'proc_rest_put()'
+	NULL, // PID specific REST implemented in 'psi_demux_proc_opt()'
+	psi_demux_proc_process_frame,
+	psi_demux_proc_opt,
+	NULL, // 'iput_fifo_elem_opaque_dup()'
+	NULL, // 'iput_fifo_elem_opaque_release()'
+	NULL, // 'oput_fifo_elem_opaque_dup()'
+};
+
+const proc_if_t proc_if_psi_eit_proc=
 {
-	"psi_table_proc", "parser", "n/a",
+	"psi_eit_proc", "parser", "n/a",
 	(uint64_t)0,
-	psi_table_proc_open,
-	psi_table_proc_close,
+	psi_eit_proc_open,
+	psi_eit_proc_close,
 	proc_send_frame_with_tspkt,
 	NULL, // send-no-dup
 	NULL, // proc_recv_frame
 	NULL, // no specific unblock function extension
 	NULL, // 'proc_rest_put()'
-	NULL, // Implemented indirectly in 'psi_table_proc_opt()'
-	psi_table_proc_process_frame,
-	psi_table_proc_opt, // indirectly calls 'psi_table_proc_rest_get()'
+	NULL, // Now/next events are got using 'psi_eit_proc_opt()'
+	psi_eit_proc_process_frame,
+	psi_eit_proc_opt,
 	NULL, // 'iput_fifo_elem_opaque_dup()'
 	NULL, // 'iput_fifo_elem_opaque_release()'
 	NULL, // 'oput_fifo_elem_opaque_dup()'
 };
 
-const proc_if_t proc_if_psi_section_proc=
+const proc_if_t proc_if_psi_tap_proc=
 {
-	"psi_section_proc", "parser", "n/a",
+	"psi_tap_proc", "parser", "n/a",
 	(uint64_t)0,
-	psi_section_proc_open,
-	psi_section_proc_close,
+	psi_tap_proc_open,
+	psi_tap_proc_close,
 	proc_send_frame_with_tspkt,
 	NULL, // send-no-dup
 	NULL, // proc_recv_frame
 	NULL, // no specific unblock function extension
 	NULL, // 'proc_rest_put()'
-	NULL, // Implemented indirectly in 'psi_section_proc_opt()'
-	psi_section_proc_process_frame,
-	psi_section_proc_opt, // indirectly calls 'psi_section_proc_rest_get()'
+	NULL, // Statistics are got using 'psi_tap_proc_opt()'
+	psi_tap_proc_process_frame,
+	psi_tap_proc_opt,
 	NULL, // 'iput_fifo_elem_opaque_dup()'
 	NULL, // 'iput_fifo_elem_opaque_release()'
 	NULL, // 'oput_fifo_elem_opaque_dup()'
@@ -199,7 +392,10 @@ static int psi_proc_ctx_init(psi_proc_ctx_t *psi_proc_ctx,
 	ret_code= pthread_mutex_init(&psi_proc_ctx->psi_opaque_ctx_mutex, NULL);
 	CHECK_DO(ret_code== 0, goto end);
 
-	psi_proc_ctx->tscc_input= TS_CC_UNDEF;
+	ts_dec_cc_ctx_init(&psi_proc_ctx->tscc_input);
+	psi_dec_fp_ctx_init(&psi_proc_ctx->fp_input);
+	ret_code= psi_dec_sect_ctx_init(&psi_proc_ctx->sect_input);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
 	// Reserved for future use: initialize other new variables here...
 
@@ -222,9 +418,39 @@ static void psi_proc_ctx_deinit(psi_proc_ctx_t *psi_proc_ctx)
 	/* Release mutex */
 	ASSERT(pthread_mutex_destroy(&psi_proc_ctx->psi_opaque_ctx_mutex)== 0);
 
+	/* Release section reassembly buffer */
+	psi_dec_sect_ctx_deinit(&psi_proc_ctx->sect_input);
+
+	/* Release sections referenced by fingerprints */
+	psi_dec_fp_ctx_deinit(&psi_proc_ctx->fp_input);
+
 	// Reserved for future use: release other new variables here...
 }
 
+/**
+ * Get processor input statistics.
+ */
+static int psi_proc_get_stats(psi_proc_ctx_t *psi_proc_ctx,
+		psi_proc_stats_t *psi_proc_stats)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(psi_proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_proc_stats!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(((proc_ctx_t*)psi_proc_ctx)->log_ctx);
+
+	psi_proc_stats->sections_decoded= psi_proc_ctx->fp_input.decoded_count;
+	psi_proc_stats->sections_repeated=
+			psi_proc_ctx->fp_input.repetitions_count;
+	psi_proc_stats->sections_filtered=
+			psi_proc_ctx->sect_input.filtered_count;
+	psi_proc_stats->ts_duplicates= psi_proc_ctx->tscc_input.duplicates_count;
+	psi_proc_stats->ts_cc_errors= psi_proc_ctx->tscc_input.cc_errors_count;
+	return STAT_SUCCESS;
+}
+
 static int proc_send_frame_with_tspkt(proc_ctx_t *proc_ctx,
 		const proc_frame_ctx_t *proc_frame_ctx)
 {
@@ -255,18 +481,18 @@ end:
 	return end_code;
 }
 
-/* **** PSI table processor **** */
+/* **** PSI demultiplexer processor **** */
 
 /**
  * Implements the proc_if_s::open callback.
  * See .proc_if.h for further details.
  */
-static proc_ctx_t* psi_table_proc_open(const proc_if_t *proc_if,
+static proc_ctx_t* psi_demux_proc_open(const proc_if_t *proc_if,
 		const char *settings_str, const char* href, log_ctx_t *log_ctx,
 		va_list arg)
 {
 	int ret_code, end_code= STAT_ERROR;
-	psi_table_proc_ctx_t *psi_table_proc_ctx= NULL;
+	psi_demux_proc_ctx_t *psi_demux_proc_ctx= NULL;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
@@ -275,65 +501,122 @@ static proc_ctx_t* psi_table_proc_open(const proc_if_t *proc_if,
 	// Parameter 'href' is allowed to be NULL
 	// Parameter 'log_ctx' is allowed to be NULL
 
-	/* Allocate context structure */
-	psi_table_proc_ctx= (psi_table_proc_ctx_t*)calloc(1, sizeof(
-			psi_table_proc_ctx_t));
-	CHECK_DO(psi_table_proc_ctx!= NULL, goto end);
+	/* Allocate context structure (all PIDs unregistered) */
+	psi_demux_proc_ctx= (psi_demux_proc_ctx_t*)calloc(1, sizeof(
+			psi_demux_proc_ctx_t));
+	CHECK_DO(psi_demux_proc_ctx!= NULL, goto end);
 
 	/* **** Initialize context structure **** */
 
-	/* Initialize PSI processors common structure */
-	ret_code= psi_proc_ctx_init((psi_proc_ctx_t*)psi_table_proc_ctx, proc_if,
-			settings_str, LOG_CTX_GET(), arg);
-	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= pthread_mutex_init(&psi_demux_proc_ctx->pid_ctx_array_mutex,
+			NULL);
+	CHECK_DO(ret_code== 0, goto end);
+
+	ret_code= pthread_mutex_init(&psi_demux_proc_ctx->psi_opaque_ctx_mutex,
+			NULL);
+	CHECK_DO(ret_code== 0, goto end);
 
-	psi_table_proc_ctx->psi_table_ctx= NULL;
+	psi_demux_proc_ctx->notify_fxn= NULL;
+	psi_demux_proc_ctx->notify_opaque= NULL;
 
 	end_code= STAT_SUCCESS;
 end:
 	if(end_code!= STAT_SUCCESS)
-		psi_table_proc_close((proc_ctx_t**)&psi_table_proc_ctx);
-	return (proc_ctx_t*)psi_table_proc_ctx;
+		psi_demux_proc_close((proc_ctx_t**)&psi_demux_proc_ctx);
+	return (proc_ctx_t*)psi_demux_proc_ctx;
 }
 
 /**
  * Implements the proc_if_s::close callback.
  * See .proc_if.h for further details.
  */
-static void psi_table_proc_close(proc_ctx_t **ref_proc_ctx)
+static void psi_demux_proc_close(proc_ctx_t **ref_proc_ctx)
 {
-	psi_table_proc_ctx_t *psi_table_proc_ctx;
-	//LOG_CTX_INIT(NULL);
+	int pid;
+	psi_demux_proc_ctx_t *psi_demux_proc_ctx;
+	LOG_CTX_INIT(NULL);
 
 	if(ref_proc_ctx== NULL ||
-			(psi_table_proc_ctx= (psi_table_proc_ctx_t*)*ref_proc_ctx)== NULL)
+			(psi_demux_proc_ctx= (psi_demux_proc_ctx_t*)*ref_proc_ctx)== NULL)
 		return;
 
-	//LOG_CTX_SET(((proc_ctx_t*)psi_table_proc_ctx)->log_ctx);
+	LOG_CTX_SET(((proc_ctx_t*)psi_demux_proc_ctx)->log_ctx);
 
-	/* De-initialize PSI processors common structure */
-	psi_proc_ctx_deinit((psi_proc_ctx_t*)psi_table_proc_ctx);
+	/* Release PID contexts */
+	for(pid= 0; pid<= TS_MAX_PID_VAL; pid++)
+		psi_demux_pid_ctx_release(&psi_demux_proc_ctx->pid_ctx_array[pid]);
 
-	/* Release parsed table */
-	psi_table_ctx_release(&psi_table_proc_ctx->psi_table_ctx);
+	/* Release mutexes */
+	ASSERT(pthread_mutex_destroy(&psi_demux_proc_ctx->pid_ctx_array_mutex)==
+			0);
+	ASSERT(pthread_mutex_destroy(&psi_demux_proc_ctx->psi_opaque_ctx_mutex)==
+			0);
 
 	/* Release context structure */
-	free(psi_table_proc_ctx);
+	free(psi_demux_proc_ctx);
 	*ref_proc_ctx= NULL;
 }
 
+/**
+ * Implements the proc_if_s::send_frame callback.
+ * See .proc_if.h for further details.
+ * Packets of non-registered PIDs are silently discarded (without being
+ * queued).
+ */
+static int psi_demux_proc_send_frame(proc_ctx_t *proc_ctx,
+		const proc_frame_ctx_t *proc_frame_ctx)
+{
+	uint16_t pid;
+	int ret_code, end_code= STAT_ERROR;
+	psi_demux_proc_ctx_t *psi_demux_proc_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(proc_frame_ctx!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(proc_ctx->log_ctx);
+
+	psi_demux_proc_ctx= (psi_demux_proc_ctx_t*)proc_ctx;
+
+	/* Perform some sanity checks */
+	CHECK_DO(proc_frame_ctx->data!= NULL, goto end);
+	CHECK_DO(proc_frame_ctx->data[0]== 0x47, goto end);
+	CHECK_DO(proc_frame_ctx->width[0]== TS_PKT_SIZE, goto end);
+
+	/* Filter PID (the PID context is checked again when processed) */
+	pid= TS_BUF_GET_PID(proc_frame_ctx->data);
+	if(__atomic_load_n(&psi_demux_proc_ctx->pid_ctx_array[pid],
+			__ATOMIC_RELAXED)== NULL) {
+		end_code= STAT_SUCCESS;
+		goto end;
+	}
+
+	/* Write frame to input FIFO */
+	ret_code= fifo_put_dup(proc_ctx->fifo_ctx_array[PROC_IPUT],
+			proc_frame_ctx->data, TS_PKT_SIZE);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_ENOMEM, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	return end_code;
+}
+
 /**
  * Implements the proc_if_s::process_frame callback.
  * See .proc_if.h for further details.
  */
-static int psi_table_proc_process_frame(proc_ctx_t *proc_ctx,
+static int psi_demux_proc_process_frame(proc_ctx_t *proc_ctx,
 		fifo_ctx_t* iput_fifo_ctx, fifo_ctx_t* oput_fifo_ctx)
 {
-	int new_table_version_found, ret_code, end_code= STAT_ERROR;
-	psi_table_proc_ctx_t *psi_table_proc_ctx= NULL; // Do not release (alias)
-	psi_proc_ctx_t *psi_proc_ctx= NULL; // Do not release (alias)
-	pthread_mutex_t *psi_table_ctx_mutex_p= NULL; // Do not release
-	psi_table_ctx_t *psi_table_ctx= NULL;
+	uint16_t pid;
+	int ret_code, end_code= STAT_ERROR, flag_locked= 0;
+	uint8_t *pkt= NULL;
+	size_t pkt_size= 0;
+	uint8_t *sect_buf= NULL; // Do not release (reassembly buffer)
+	size_t sect_buf_size= 0;
+	psi_demux_proc_ctx_t *psi_demux_proc_ctx= NULL; // Do not release (alias)
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL; // Do not release (alias)
 	LOG_CTX_INIT(NULL);
 
 	/* Check arguments */
@@ -343,56 +626,52 @@ static int psi_table_proc_process_frame(proc_ctx_t *proc_ctx,
 
 	LOG_CTX_SET(proc_ctx->log_ctx);
 
-	/* Get PSI table processor context structure and related fields */
-	psi_table_proc_ctx= (psi_table_proc_ctx_t*)proc_ctx;
-	psi_proc_ctx= (psi_proc_ctx_t*)proc_ctx;
-	psi_table_ctx_mutex_p= &psi_proc_ctx->psi_opaque_ctx_mutex;
+	psi_demux_proc_ctx= (psi_demux_proc_ctx_t*)proc_ctx;
 
-	/* Get next table from input stream */
-	ret_code= psi_table_dec_get_next_table(iput_fifo_ctx, LOG_CTX_GET(),
-			&psi_proc_ctx->tscc_input, proc_ctx->proc_instance_index/*PID*/,
-			&psi_table_ctx);
+	/* Get next TS packet (of any of the registered PIDs) */
+	ret_code= fifo_get(iput_fifo_ctx, (void**)&pkt, &pkt_size);
 	if(ret_code!= STAT_SUCCESS) {
-		end_code= ret_code;
+		if(ret_code== STAT_EAGAIN)
+			end_code= STAT_EOF; // FIFO unblocked; requested to exit.
 		goto end;
 	}
-	CHECK_DO(psi_table_ctx!= NULL, goto end);
-
-	/* **** Update stored table copy **** */
-
-	/* Check if table has changed */
-	new_table_version_found= psi_table_proc_ctx->psi_table_ctx== NULL ||
-			psi_table_ctx_cmp(psi_table_ctx,
-					psi_table_proc_ctx->psi_table_ctx)!= 0;
-
-	/* If new table version found, store into context
-	 * (manage context members in mutual exclusion)
-	 */
-	if(new_table_version_found!= 0) {
-		uint8_t version_number;
-		psi_section_ctx_t *psi_section_ctx_nth;
-		uint16_t pid= proc_ctx->proc_instance_index;
-
-		/* Release previous stored table and update with the new one */
-		pthread_mutex_lock(psi_table_ctx_mutex_p);
-		psi_table_ctx_release(&psi_table_proc_ctx->psi_table_ctx);
-		psi_table_proc_ctx->psi_table_ctx= psi_table_ctx_dup(psi_table_ctx);
-		pthread_mutex_unlock(psi_table_ctx_mutex_p);
-		CHECK_DO(psi_table_proc_ctx->psi_table_ctx!= NULL, goto end);
-
-		/* Trace the new table type and PID */
-		psi_section_ctx_nth= (psi_section_ctx_t*)llist_get_nth(
-				psi_table_ctx->psi_section_ctx_llist, 0);
-		version_number= psi_section_ctx_nth->version_number;
-		LOGW("New %s table parsed: PID= %u (0x%0x); version %u (0x%0x)\n",
-				pid== 0? "PAT": "PSI",
-						pid, pid, version_number, version_number);
+	CHECK_DO(pkt!= NULL && pkt[0]== 0x47 && pkt_size== TS_PKT_SIZE,
+			goto end);
+	pid= TS_BUF_GET_PID(pkt);
+
+	/* Demultiplex: get the context of the packet PID (the PID may have been
+	 * unregistered after the packet was queued).
+	 */
+	pthread_mutex_lock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	flag_locked= 1;
+	if((psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid])== NULL) {
+		end_code= STAT_SUCCESS;
+		goto end;
+	}
+
+	/* Drop duplicated packets and check continuity */
+	if(ts_dec_cc_check_packet(&psi_demux_pid_ctx->tscc_input, pkt,
+			LOG_CTX_GET())== STAT_ENODATA) {
+		end_code= STAT_SUCCESS;
+		goto end;
+	}
+
+	/* Reassemble and process all the sections completed with this packet */
+	psi_dec_sect_push_packet(&psi_demux_pid_ctx->sect_input, pkt);
+	while((ret_code= psi_dec_sect_pull(&psi_demux_pid_ctx->sect_input,
+			LOG_CTX_GET(), &sect_buf, &sect_buf_size))!= STAT_EAGAIN) {
+		if(ret_code!= STAT_SUCCESS)
+			continue; // Section discarded
+		psi_demux_proc_section(psi_demux_proc_ctx, psi_demux_pid_ctx,
+				sect_buf, sect_buf_size, LOG_CTX_GET());
 	}
 
 	end_code= STAT_SUCCESS;
 end:
-	if(psi_table_ctx!= NULL)
-		psi_table_ctx_release(&psi_table_ctx);
+	if(flag_locked!= 0)
+		pthread_mutex_unlock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	if(pkt!= NULL)
+		free(pkt);
 	return end_code;
 }
 
@@ -400,10 +679,11 @@ end:
  * Implements the proc_if_s::opt callback.
  * See .proc_if.h for further details.
  */
-static int psi_table_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
+static int psi_demux_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 		va_list arg)
 {
 	int end_code= STAT_ERROR;
+	psi_demux_proc_ctx_t *psi_demux_proc_ctx= NULL; // Do not release (alias)
 	LOG_CTX_INIT(NULL);
 
 	/* Check arguments */
@@ -412,9 +692,49 @@ static int psi_table_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 
 	LOG_CTX_SET(proc_ctx->log_ctx);
 
-	if(TAG_IS("PROCS_ID_GET_CSTRUCT_REST")) {
-		end_code= psi_table_proc_rest_get(proc_ctx, PROC_IF_REST_FMT_BINARY,
-				va_arg(arg, void**));
+	psi_demux_proc_ctx= (psi_demux_proc_ctx_t*)proc_ctx;
+
+	if(TAG_IS("PROCS_ID_PSI_PID_ADD")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		psi_proc_pid_type_t pid_type= va_arg(arg, psi_proc_pid_type_t);
+		end_code= psi_demux_proc_pid_add(psi_demux_proc_ctx, pid, pid_type,
+				LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_PID_DELETE")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		end_code= psi_demux_proc_pid_delete(psi_demux_proc_ctx, pid,
+				LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_PID_GET_CSTRUCT_REST")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		end_code= psi_demux_proc_pid_rest_get(psi_demux_proc_ctx, pid,
+				va_arg(arg, void**), LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_PID_GET_STATS")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		end_code= psi_demux_proc_pid_get_stats(psi_demux_proc_ctx, pid,
+				va_arg(arg, psi_proc_stats_t*), LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_PID_FILTER_ADD")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		const psi_filter_t *psi_filter= va_arg(arg, const psi_filter_t*);
+		end_code= psi_demux_proc_pid_filter_add(psi_demux_proc_ctx, pid,
+				psi_filter, va_arg(arg, int*), LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_PID_FILTER_DELETE")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		end_code= psi_demux_proc_pid_filter_delete(psi_demux_proc_ctx, pid,
+				va_arg(arg, int), LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_PID_GET_RAW")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		void **ref_buf= va_arg(arg, void**);
+		end_code= psi_demux_proc_pid_get_raw(psi_demux_proc_ctx, pid, ref_buf,
+				va_arg(arg, size_t*), LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_PID_PRELOAD")) {
+		uint16_t pid= (uint16_t)va_arg(arg, int);
+		const void *buf= va_arg(arg, const void*);
+		end_code= psi_demux_proc_pid_preload(psi_demux_proc_ctx, pid, buf,
+				va_arg(arg, size_t), LOG_CTX_GET());
+	} else if(TAG_IS("PROCS_ID_PSI_SET_NOTIFY")) {
+		psi_proc_notify_fxn_t notify_fxn= va_arg(arg, psi_proc_notify_fxn_t);
+		void *notify_opaque= va_arg(arg, void*);
+		end_code= psi_demux_proc_set_notify(psi_demux_proc_ctx, notify_fxn,
+				notify_opaque);
 	} else {
 		LOGE("Unknown option\n");
 		end_code= STAT_ENOTFOUND;
@@ -423,74 +743,555 @@ static int psi_table_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 }
 
 /**
- * Implements the proc_if_s::rest_get callback.
- * See .proc_if.h for further details.
- * NOTE: will be used indirectly by calling 'psi_table_proc_opt()'.
+ * Decode the given raw section of the given PID and publish the new table
+ * or section snapshot if a new version is found.
+ * Called from the processing thread ('pid_ctx_array_mutex' locked).
+ */
+static void psi_demux_proc_section(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		psi_demux_pid_ctx_t *psi_demux_pid_ctx, uint8_t *sect_buf,
+		size_t sect_buf_size, log_ctx_t *log_ctx)
+{
+	int ret_code;
+	uint16_t pid= psi_demux_pid_ctx->pid;
+	uint64_t decoded_count= psi_demux_pid_ctx->fp_input.decoded_count;
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	psi_table_ctx_t *psi_table_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Decode section (unless it is a repetition of an accepted one) */
+	ret_code= psi_dec_section_fp(sect_buf, sect_buf_size, pid,
+			&psi_demux_pid_ctx->fp_input, LOG_CTX_GET(), &psi_section_ctx);
+	if(ret_code!= STAT_SUCCESS || psi_section_ctx== NULL)
+		goto end;
+
+	/* Keep a raw copy of the sections actually decoded (repetitions are
+	 * byte-identical to an already kept one).
+	 */
+	if(psi_demux_pid_ctx->fp_input.decoded_count!= decoded_count)
+		psi_demux_proc_raw_put(psi_demux_pid_ctx, sect_buf, sect_buf_size,
+				psi_demux_pid_ctx->pid_type== PSI_PROC_PID_TABLE?
+						psi_section_ctx->section_number: 0, LOG_CTX_GET());
+
+	/* Publish new (immutable) snapshot if a new version is found: only the
+	 * pointer swap is performed in mutual exclusion; readers holding a
+	 * reference to the previous snapshot keep it alive.
+	 */
+	if(psi_demux_pid_ctx->pid_type== PSI_PROC_PID_TABLE) {
+		psi_table_ctx_t *psi_table_ctx_prev= NULL;
+		psi_section_ctx_t *psi_section_ctx_0;
+
+		/* Add section to the table it belongs to */
+		ret_code= psi_table_dec_map_put_section(
+				&psi_demux_pid_ctx->table_input, LOG_CTX_GET(),
+				&psi_section_ctx, &psi_table_ctx);
+		if(ret_code!= STAT_SUCCESS)
+			goto end; // Table not completed yet
+
+		if(psi_demux_pid_ctx->psi_table_ctx!= NULL &&
+				psi_table_ctx_cmp(psi_table_ctx,
+						psi_demux_pid_ctx->psi_table_ctx)== 0)
+			goto end; // Same version
+
+		pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+		psi_table_ctx_prev= psi_demux_pid_ctx->psi_table_ctx;
+		psi_demux_pid_ctx->psi_table_ctx= psi_table_ctx_ref(psi_table_ctx);
+		pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+		psi_table_ctx_release(&psi_table_ctx_prev);
+
+		psi_section_ctx_0= psi_table_ctx_get_section(psi_table_ctx, 0);
+		psi_demux_proc_raw_publish(psi_demux_proc_ctx, psi_demux_pid_ctx,
+				psi_section_ctx_0, psi_section_ctx_0->last_section_number+ 1,
+				LOG_CTX_GET());
+		LOGW("New %s table parsed: PID= %u (0x%0x); version %u (0x%0x)\n",
+				pid== 0? "PAT": "PSI", pid, pid,
+				psi_section_ctx_0->version_number,
+				psi_section_ctx_0->version_number);
+		psi_demux_proc_notify(psi_demux_proc_ctx, pid, psi_section_ctx_0);
+	} else {
+		psi_section_ctx_t *psi_section_ctx_prev= NULL;
+
+		if(psi_demux_pid_ctx->psi_section_ctx!= NULL &&
+				psi_section_ctx_cmp(psi_section_ctx,
+						psi_demux_pid_ctx->psi_section_ctx)== 0)
+			goto end; // Same version
+
+		pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+		psi_section_ctx_prev= psi_demux_pid_ctx->psi_section_ctx;
+		psi_demux_pid_ctx->psi_section_ctx= psi_section_ctx_ref(
+				psi_section_ctx);
+		pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+		psi_section_ctx_release(&psi_section_ctx_prev);
+		psi_demux_proc_raw_publish(psi_demux_proc_ctx, psi_demux_pid_ctx,
+				psi_section_ctx, 1, LOG_CTX_GET());
+
+		LOGW("New PSI-section parsed: PID= %u (0x%0x); version %u (0x%0x)\n",
+				pid, pid, psi_section_ctx->version_number,
+				psi_section_ctx->version_number);
+		psi_demux_proc_notify(psi_demux_proc_ctx, pid, psi_section_ctx);
+	}
+
+end:
+	if(psi_section_ctx!= NULL)
+		psi_section_ctx_release(&psi_section_ctx);
+	if(psi_table_ctx!= NULL)
+		psi_table_ctx_release(&psi_table_ctx);
+}
+
+/**
+ * Keep a raw copy of the given (decoded) section in the slot of its section
+ * number.
+ * Called from the processing thread ('pid_ctx_array_mutex' locked).
+ */
+static void psi_demux_proc_raw_put(psi_demux_pid_ctx_t *psi_demux_pid_ctx,
+		const uint8_t *sect_buf, size_t sect_buf_size, uint8_t section_number,
+		log_ctx_t *log_ctx)
+{
+	size_t sect_size;
+	uint8_t *raw_input;
+	LOG_CTX_INIT(log_ctx);
+
+	CHECK_DO(sect_buf_size>= 3, return);
+	sect_size= 3+ (((sect_buf[1]& 0x0F)<< 8)| sect_buf[2]);
+	CHECK_DO(sect_size<= sect_buf_size, return);
+
+	raw_input= (uint8_t*)realloc(
+			psi_demux_pid_ctx->raw_input_array[section_number], sect_size);
+	CHECK_DO(raw_input!= NULL, return);
+	memcpy(raw_input, sect_buf, sect_size);
+	psi_demux_pid_ctx->raw_input_array[section_number]= raw_input;
+}
+
+/**
+ * Compose the raw sections buffer of the snapshot just published (the
+ * given section and its 'sections_num' sibling sections). If any of the
+ * kept raw sections does not match the snapshot (e.g. a repetition of an
+ * older version was accepted by fingerprint), no raw buffer is published.
+ * Called from the processing thread ('pid_ctx_array_mutex' locked).
+ */
+static void psi_demux_proc_raw_publish(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		psi_demux_pid_ctx_t *psi_demux_pid_ctx,
+		const psi_section_ctx_t *psi_section_ctx, int sections_num,
+		log_ctx_t *log_ctx)
+{
+	int i;
+	size_t raw_buf_size= 0;
+	uint8_t *raw_buf= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	for(i= 0; i< sections_num; i++) {
+		const uint8_t *raw_input= psi_demux_pid_ctx->raw_input_array[i];
+		size_t sect_size;
+		uint8_t *p;
+
+		if(raw_input== NULL || raw_input[0]!= psi_section_ctx->table_id ||
+				((raw_input[3]<< 8)| raw_input[4])!=
+						psi_section_ctx->table_id_extension ||
+				((raw_input[5]>> 1)& 0x1F)!=
+						psi_section_ctx->version_number) {
+			free(raw_buf);
+			raw_buf= NULL;
+			raw_buf_size= 0;
+			break;
+		}
+		sect_size= 3+ (((raw_input[1]& 0x0F)<< 8)| raw_input[2]);
+		p= (uint8_t*)realloc(raw_buf, raw_buf_size+ sect_size);
+		CHECK_DO(p!= NULL, free(raw_buf); raw_buf= NULL; raw_buf_size= 0;
+				break);
+		memcpy(p+ raw_buf_size, raw_input, sect_size);
+		raw_buf= p;
+		raw_buf_size+= sect_size;
+	}
+
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	if(psi_demux_pid_ctx->raw_buf!= NULL)
+		free(psi_demux_pid_ctx->raw_buf);
+	psi_demux_pid_ctx->raw_buf= raw_buf;
+	psi_demux_pid_ctx->raw_buf_size= raw_buf_size;
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+}
+
+/**
+ * Notify new PSI version to the registered callback (if any).
+ */
+static void psi_demux_proc_notify(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		uint16_t pid, const psi_section_ctx_t *psi_section_ctx)
+{
+	if(psi_section_ctx== NULL)
+		return;
+
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	if(psi_demux_proc_ctx->notify_fxn!= NULL)
+		psi_demux_proc_ctx->notify_fxn(psi_demux_proc_ctx->notify_opaque, pid,
+				psi_section_ctx->table_id, psi_section_ctx->version_number);
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+}
+
+/**
+ * Register a new PID to be parsed.
+ */
+static int psi_demux_proc_pid_add(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		uint16_t pid, psi_proc_pid_type_t pid_type, log_ctx_t *log_ctx)
+{
+	int ret_code, end_code= STAT_ERROR;
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+	CHECK_DO(pid_type< PSI_PROC_PID_TYPE_ENUM_MAX, return STAT_EINVAL);
+
+	/* Allocate and initialize PID context structure */
+	psi_demux_pid_ctx= (psi_demux_pid_ctx_t*)calloc(1, sizeof(
+			psi_demux_pid_ctx_t));
+	CHECK_DO(psi_demux_pid_ctx!= NULL, goto end);
+
+	psi_demux_pid_ctx->pid= pid;
+	psi_demux_pid_ctx->pid_type= pid_type;
+	ts_dec_cc_ctx_init(&psi_demux_pid_ctx->tscc_input);
+	psi_dec_fp_ctx_init(&psi_demux_pid_ctx->fp_input);
+	psi_table_dec_map_init(&psi_demux_pid_ctx->table_input);
+	psi_filter_list_init(&psi_demux_pid_ctx->filter_list);
+	ret_code= psi_dec_sect_ctx_init(&psi_demux_pid_ctx->sect_input);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	psi_demux_pid_ctx->sect_input.filter_list=
+			&psi_demux_pid_ctx->filter_list;
+
+	/* Register PID context */
+	pthread_mutex_lock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	if(psi_demux_proc_ctx->pid_ctx_array[pid]== NULL) {
+		__atomic_store_n(&psi_demux_proc_ctx->pid_ctx_array[pid],
+				psi_demux_pid_ctx, __ATOMIC_RELAXED);
+		psi_demux_pid_ctx= NULL; // Avoid double referencing
+		end_code= STAT_SUCCESS;
+	} else {
+		end_code= STAT_ECONFLICT; // PID already registered
+	}
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	pthread_mutex_unlock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+
+end:
+	psi_demux_pid_ctx_release(&psi_demux_pid_ctx);
+	return end_code;
+}
+
+/**
+ * Unregister a PID (its table or section snapshot is released).
+ */
+static int psi_demux_proc_pid_delete(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		uint16_t pid, log_ctx_t *log_ctx)
+{
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+
+	/* Unregister PID context */
+	pthread_mutex_lock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid];
+	__atomic_store_n(&psi_demux_proc_ctx->pid_ctx_array[pid], NULL,
+			__ATOMIC_RELAXED);
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	pthread_mutex_unlock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+
+	if(psi_demux_pid_ctx== NULL)
+		return STAT_ENOTFOUND;
+
+	psi_demux_pid_ctx_release(&psi_demux_pid_ctx);
+	return STAT_SUCCESS;
+}
+
+/**
+ * Get a reference to the current table (or section) snapshot of the given
+ * PID (NULL if not parsed yet).
  */
-static int psi_table_proc_rest_get(proc_ctx_t *proc_ctx,
-		const proc_if_rest_fmt_t rest_fmt, void **ref_reponse)
+static int psi_demux_proc_pid_rest_get(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		void **ref_reponse, log_ctx_t *log_ctx)
 {
 	int end_code= STAT_ERROR;
-	psi_table_proc_ctx_t *psi_table_proc_ctx= NULL;  // Do no release (alias)
-	psi_proc_ctx_t *psi_proc_ctx= NULL; // Do not release (alias)
-	pthread_mutex_t *psi_table_ctx_mutex_p= NULL; // Do no release
-	psi_table_ctx_t *psi_table_ctx_ret= NULL;
-	LOG_CTX_INIT(NULL);
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
-	CHECK_DO(proc_ctx!= NULL, return STAT_ERROR);
-	CHECK_DO(rest_fmt< PROC_IF_REST_FMT_ENUM_MAX, return STAT_ERROR);
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
 	CHECK_DO(ref_reponse!= NULL, return STAT_ERROR);
 
-	LOG_CTX_SET(proc_ctx->log_ctx);
-
 	*ref_reponse= NULL;
 
-	/* Get PSI table processor context structure and related fields */
-	psi_table_proc_ctx= (psi_table_proc_ctx_t*)proc_ctx;
-	psi_proc_ctx= (psi_proc_ctx_t*)proc_ctx;
-	psi_table_ctx_mutex_p= &psi_proc_ctx->psi_opaque_ctx_mutex;
-
-	/* **** Attach data to REST response **** */
-
-	/* PSI table */
-	pthread_mutex_lock(psi_table_ctx_mutex_p);
-	if(psi_table_proc_ctx->psi_table_ctx!= NULL)
-		psi_table_ctx_ret= psi_table_ctx_dup(psi_table_proc_ctx->psi_table_ctx);
-	pthread_mutex_unlock(psi_table_ctx_mutex_p);
-
-	// Reserved for future use: set other data values here...
-
-	/* Format response to be returned */
-	switch(rest_fmt) {
-	case PROC_IF_REST_FMT_BINARY:
-		*ref_reponse= (void*)psi_table_ctx_ret;
-		psi_table_ctx_ret= NULL; // Avoid double referencing
-		break;
-	default:
-		LOGE("Unknown format requested for processor REST\n");
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	if((psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid])== NULL) {
+		end_code= STAT_ENOTFOUND;
+	} else {
+		if(psi_demux_pid_ctx->pid_type== PSI_PROC_PID_TABLE &&
+				psi_demux_pid_ctx->psi_table_ctx!= NULL)
+			*ref_reponse= (void*)psi_table_ctx_ref(
+					psi_demux_pid_ctx->psi_table_ctx);
+		else if(psi_demux_pid_ctx->pid_type== PSI_PROC_PID_SECTION &&
+				psi_demux_pid_ctx->psi_section_ctx!= NULL)
+			*ref_reponse= (void*)psi_section_ctx_ref(
+					psi_demux_pid_ctx->psi_section_ctx);
+		end_code= STAT_SUCCESS;
+	}
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	return end_code;
+}
+
+/**
+ * Get input statistics of the given PID.
+ * Counters are only written by the processing thread; slightly outdated
+ * values may be read.
+ */
+static int psi_demux_proc_pid_get_stats(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		psi_proc_stats_t *psi_proc_stats, log_ctx_t *log_ctx)
+{
+	int end_code= STAT_ENOTFOUND;
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+	CHECK_DO(psi_proc_stats!= NULL, return STAT_ERROR);
+
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	if((psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid])!= NULL) {
+		psi_proc_stats->sections_decoded=
+				psi_demux_pid_ctx->fp_input.decoded_count;
+		psi_proc_stats->sections_repeated=
+				psi_demux_pid_ctx->fp_input.repetitions_count;
+		psi_proc_stats->sections_filtered=
+				psi_demux_pid_ctx->sect_input.filtered_count;
+		psi_proc_stats->ts_duplicates=
+				psi_demux_pid_ctx->tscc_input.duplicates_count;
+		psi_proc_stats->ts_cc_errors=
+				psi_demux_pid_ctx->tscc_input.cc_errors_count;
+		end_code= STAT_SUCCESS;
+	}
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	return end_code;
+}
+
+/**
+ * Get a copy of the raw sections of the current table (or section)
+ * snapshot of the given PID (NULL if not available).
+ */
+static int psi_demux_proc_pid_get_raw(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		void **ref_buf, size_t *ref_buf_size, log_ctx_t *log_ctx)
+{
+	int end_code= STAT_ERROR;
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+	CHECK_DO(ref_buf!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_buf_size!= NULL, return STAT_ERROR);
+
+	*ref_buf= NULL;
+	*ref_buf_size= 0;
+
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	if((psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid])== NULL) {
+		end_code= STAT_ENOTFOUND;
+	} else if(psi_demux_pid_ctx->raw_buf!= NULL) {
+		*ref_buf= malloc(psi_demux_pid_ctx->raw_buf_size);
+		CHECK_DO(*ref_buf!= NULL, goto end);
+		memcpy(*ref_buf, psi_demux_pid_ctx->raw_buf,
+				psi_demux_pid_ctx->raw_buf_size);
+		*ref_buf_size= psi_demux_pid_ctx->raw_buf_size;
+		end_code= STAT_SUCCESS;
+	} else {
+		end_code= STAT_SUCCESS;
+	}
+end:
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	return end_code;
+}
+
+/**
+ * Preload the given raw sections (concatenated) into the given PID, as if
+ * they were received in the input stream: the tables (or sections) are
+ * published as provisional snapshots, which are confirmed (by fingerprint)
+ * or replaced by the sections received afterwards.
+ * Sections failing the CRC check are skipped.
+ */
+static int psi_demux_proc_pid_preload(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		const void *buf, size_t buf_size, log_ctx_t *log_ctx)
+{
+	int end_code= STAT_SUCCESS;
+	const uint8_t *p, *p_end;
+	uint8_t sect_buf[PSI_TABLE_MAX_SECTION_LEN];
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+	CHECK_DO(buf!= NULL, return STAT_ERROR);
+
+	pthread_mutex_lock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	if((psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid])== NULL) {
+		end_code= STAT_ENOTFOUND;
 		goto end;
 	}
 
-	end_code= STAT_SUCCESS;
+	for(p= (const uint8_t*)buf, p_end= p+ buf_size; p_end- p>= 3; ) {
+		size_t sect_size= 3+ (((p[1]& 0x0F)<< 8)| p[2]);
+
+		if(sect_size> (size_t)(p_end- p) || sect_size> sizeof(sect_buf)) {
+			end_code= STAT_EINVAL;
+			break;
+		}
+		if(psi_crc32(p, sect_size)!= 0) {
+			LOGW("Preloaded section with bad CRC discarded (PID %u)\n", pid);
+			p+= sect_size;
+			continue;
+		}
+		/* The decoder takes a modifiable buffer */
+		memcpy(sect_buf, p, sect_size);
+		psi_demux_proc_section(psi_demux_proc_ctx, psi_demux_pid_ctx,
+				sect_buf, sect_size, LOG_CTX_GET());
+		p+= sect_size;
+	}
+
 end:
-	if(psi_table_ctx_ret!= NULL)
-		psi_table_ctx_release(&psi_table_ctx_ret);
+	pthread_mutex_unlock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	return end_code;
+}
+
+/**
+ * Register version-change notification callback (common to all PIDs).
+ * The callback is immediately called for each PID already parsed, so that
+ * no version is missed.
+ */
+static int psi_demux_proc_set_notify(psi_demux_proc_ctx_t *psi_demux_proc_ctx,
+		psi_proc_notify_fxn_t notify_fxn, void *notify_opaque)
+{
+	int pid;
+
+	pthread_mutex_lock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	psi_demux_proc_ctx->notify_fxn= notify_fxn;
+	psi_demux_proc_ctx->notify_opaque= notify_opaque;
+	for(pid= 0; pid<= TS_MAX_PID_VAL && notify_fxn!= NULL; pid++) {
+		const psi_section_ctx_t *psi_section_ctx_curr= NULL;
+		psi_demux_pid_ctx_t *psi_demux_pid_ctx=
+				psi_demux_proc_ctx->pid_ctx_array[pid];
+
+		if(psi_demux_pid_ctx== NULL)
+			continue;
+		if(psi_demux_pid_ctx->psi_table_ctx!= NULL)
+			psi_section_ctx_curr= psi_table_ctx_get_section(
+					psi_demux_pid_ctx->psi_table_ctx, 0);
+		else
+			psi_section_ctx_curr= psi_demux_pid_ctx->psi_section_ctx;
+		if(psi_section_ctx_curr!= NULL)
+			notify_fxn(notify_opaque, (uint16_t)pid,
+					psi_section_ctx_curr->table_id,
+					psi_section_ctx_curr->version_number);
+	}
+	pthread_mutex_unlock(&psi_demux_proc_ctx->psi_opaque_ctx_mutex);
+	return STAT_SUCCESS;
+}
+
+/**
+ * Add section filter to the given PID.
+ */
+static int psi_demux_proc_pid_filter_add(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		const psi_filter_t *psi_filter, int *ref_filter_id,
+		log_ctx_t *log_ctx)
+{
+	int end_code= STAT_ENOTFOUND;
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+	CHECK_DO(psi_filter!= NULL, return STAT_ERROR);
+
+	/* Filters are applied by the processing thread holding the PID contexts
+	 * array lock.
+	 */
+	pthread_mutex_lock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	if((psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid])!= NULL)
+		end_code= psi_filter_list_add(&psi_demux_pid_ctx->filter_list,
+				psi_filter, ref_filter_id);
+	pthread_mutex_unlock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	return end_code;
+}
+
+/**
+ * Delete section filter from the given PID.
+ */
+static int psi_demux_proc_pid_filter_delete(
+		psi_demux_proc_ctx_t *psi_demux_proc_ctx, uint16_t pid,
+		int filter_id, log_ctx_t *log_ctx)
+{
+	int end_code= STAT_ENOTFOUND;
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(pid<= TS_MAX_PID_VAL, return STAT_EINVAL);
+
+	pthread_mutex_lock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
+	if((psi_demux_pid_ctx= psi_demux_proc_ctx->pid_ctx_array[pid])!= NULL)
+		end_code= psi_filter_list_delete(&psi_demux_pid_ctx->filter_list,
+				filter_id);
+	pthread_mutex_unlock(&psi_demux_proc_ctx->pid_ctx_array_mutex);
 	return end_code;
 }
 
-/* **** PSI section processor **** */
+/**
+ * Release PID context structure.
+ */
+static void psi_demux_pid_ctx_release(
+		psi_demux_pid_ctx_t **ref_psi_demux_pid_ctx)
+{
+	int i;
+	psi_demux_pid_ctx_t *psi_demux_pid_ctx;
+
+	if(ref_psi_demux_pid_ctx== NULL ||
+			(psi_demux_pid_ctx= *ref_psi_demux_pid_ctx)== NULL)
+		return;
+
+	psi_dec_sect_ctx_deinit(&psi_demux_pid_ctx->sect_input);
+	psi_dec_fp_ctx_deinit(&psi_demux_pid_ctx->fp_input);
+	psi_table_dec_map_deinit(&psi_demux_pid_ctx->table_input);
+	psi_table_ctx_release(&psi_demux_pid_ctx->psi_table_ctx);
+	psi_section_ctx_release(&psi_demux_pid_ctx->psi_section_ctx);
+	for(i= 0; i< PSI_TABLE_DEC_MAX_SECTIONS; i++) {
+		if(psi_demux_pid_ctx->raw_input_array[i]!= NULL)
+			free(psi_demux_pid_ctx->raw_input_array[i]);
+	}
+	if(psi_demux_pid_ctx->raw_buf!= NULL)
+		free(psi_demux_pid_ctx->raw_buf);
+
+	free(psi_demux_pid_ctx);
+	*ref_psi_demux_pid_ctx= NULL;
+}
+
+/* **** PSI EIT processor **** */
 
 /**
  * Implements the proc_if_s::open callback.
  * See .proc_if.h for further details.
  */
-static proc_ctx_t* psi_section_proc_open(const proc_if_t *proc_if,
+static proc_ctx_t* psi_eit_proc_open(const proc_if_t *proc_if,
 		const char *settings_str, const char* href, log_ctx_t *log_ctx,
 		va_list arg)
 {
 	int ret_code, end_code= STAT_ERROR;
-	psi_section_proc_ctx_t *psi_section_proc_ctx= NULL;
+	size_t mem_budget= PSI_EIT_MEM_BUDGET_DEFAULT;
+	int horizon_sec= PSI_EIT_HORIZON_SEC_DEFAULT;
+	psi_filter_t psi_filter;
+	psi_eit_proc_ctx_t *psi_eit_proc_ctx= NULL;
+	char *mem_budget_str= NULL, *horizon_sec_str= NULL;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
@@ -500,67 +1301,99 @@ static proc_ctx_t* psi_section_proc_open(const proc_if_t *proc_if,
 	// Parameter 'log_ctx' is allowed to be NULL
 
 	/* Allocate context structure */
-	psi_section_proc_ctx= (psi_section_proc_ctx_t*)calloc(1, sizeof(
-			psi_section_proc_ctx_t));
-	CHECK_DO(psi_section_proc_ctx!= NULL, goto end);
+	psi_eit_proc_ctx= (psi_eit_proc_ctx_t*)calloc(1, sizeof(
+			psi_eit_proc_ctx_t));
+	CHECK_DO(psi_eit_proc_ctx!= NULL, goto end);
 
 	/* **** Initialize context structure **** */
 
 	/* Initialize PSI processors common structure */
-	ret_code= psi_proc_ctx_init((psi_proc_ctx_t*)psi_section_proc_ctx, proc_if,
+	ret_code= psi_proc_ctx_init((psi_proc_ctx_t*)psi_eit_proc_ctx, proc_if,
 			settings_str, LOG_CTX_GET(), arg);
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
-	psi_section_proc_ctx->psi_section_ctx= NULL;
+	/* Section filters: present/following (0x4E) and schedule (0x50 to 0x5F)
+	 * tables of the actual transport stream.
+	 */
+	psi_filter_list_init(&psi_eit_proc_ctx->filter_list);
+	psi_filter_init(&psi_filter);
+	psi_filter_set_table_id(&psi_filter,
+			PSI_DVB_EVENT_INFO_SECTION_PF_ACTUAL);
+	ret_code= psi_filter_list_add(&psi_eit_proc_ctx->filter_list,
+			&psi_filter, NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	psi_filter_init(&psi_filter);
+	psi_filter.match[0]= PSI_DVB_EVENT_INFO_SECTION_SCHED_ACTUAL_MIN;
+	psi_filter.mask[0]= 0xF0;
+	ret_code= psi_filter_list_add(&psi_eit_proc_ctx->filter_list,
+			&psi_filter, NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	((psi_proc_ctx_t*)psi_eit_proc_ctx)->sect_input.filter_list=
+			&psi_eit_proc_ctx->filter_list;
+
+	/* EIT cache (memory budget and time horizon may be given in the
+	 * settings).
+	 */
+	mem_budget_str= uri_parser_query_str_get_value("eit_mem_budget",
+			settings_str);
+	if(mem_budget_str!= NULL && atoi(mem_budget_str)> 0)
+		mem_budget= (size_t)atoi(mem_budget_str);
+	horizon_sec_str= uri_parser_query_str_get_value("eit_horizon_sec",
+			settings_str);
+	if(horizon_sec_str!= NULL && atoi(horizon_sec_str)> 0)
+		horizon_sec= atoi(horizon_sec_str);
+	psi_eit_proc_ctx->psi_eit_ctx= psi_eit_open(mem_budget, horizon_sec,
+			LOG_CTX_GET());
+	CHECK_DO(psi_eit_proc_ctx->psi_eit_ctx!= NULL, goto end);
 
 	end_code= STAT_SUCCESS;
 end:
+	if(mem_budget_str!= NULL)
+		free(mem_budget_str);
+	if(horizon_sec_str!= NULL)
+		free(horizon_sec_str);
 	if(end_code!= STAT_SUCCESS)
-		psi_section_proc_close((proc_ctx_t**)&psi_section_proc_ctx);
-	return (proc_ctx_t*)psi_section_proc_ctx;
+		psi_eit_proc_close((proc_ctx_t**)&psi_eit_proc_ctx);
+	return (proc_ctx_t*)psi_eit_proc_ctx;
 }
 
 /**
  * Implements the proc_if_s::close callback.
  * See .proc_if.h for further details.
  */
-static void psi_section_proc_close(proc_ctx_t **ref_proc_ctx)
+static void psi_eit_proc_close(proc_ctx_t **ref_proc_ctx)
 {
-	psi_section_proc_ctx_t *psi_section_proc_ctx;
-	//LOG_CTX_INIT(NULL);
+	psi_eit_proc_ctx_t *psi_eit_proc_ctx;
 
 	if(ref_proc_ctx== NULL ||
-			(psi_section_proc_ctx= (psi_section_proc_ctx_t*)*ref_proc_ctx)
-			== NULL)
+			(psi_eit_proc_ctx= (psi_eit_proc_ctx_t*)*ref_proc_ctx)== NULL)
 		return;
 
-	//LOG_CTX_SET(((proc_ctx_t*)psi_section_proc_ctx)->log_ctx);
-
 	/* De-initialize PSI processors common structure */
-	psi_proc_ctx_deinit((psi_proc_ctx_t*)psi_section_proc_ctx);
+	psi_proc_ctx_deinit((psi_proc_ctx_t*)psi_eit_proc_ctx);
 
-	/* Release parsed section */
-	psi_section_ctx_release(&psi_section_proc_ctx->psi_section_ctx);
+	/* Release EIT cache */
+	psi_eit_close(&psi_eit_proc_ctx->psi_eit_ctx);
 
 	/* Release context structure */
-	free(psi_section_proc_ctx);
+	free(psi_eit_proc_ctx);
 	*ref_proc_ctx= NULL;
 }
 
 /**
  * Implements the proc_if_s::process_frame callback.
  * See .proc_if.h for further details.
+ * Sections are parsed directly from the reassembly buffer into the EIT
+ * cache (no section or table structure is built).
  */
-static int psi_section_proc_process_frame(proc_ctx_t *proc_ctx,
+static int psi_eit_proc_process_frame(proc_ctx_t *proc_ctx,
 		fifo_ctx_t* iput_fifo_ctx, fifo_ctx_t* oput_fifo_ctx)
 {
-	uint16_t pid;
-	int new_table_version_found, ret_code, end_code= STAT_ERROR;
-	psi_section_proc_ctx_t *psi_section_proc_ctx=
-			NULL; // Do not release (alias)
+	int ret_code, end_code= STAT_ERROR;
+	psi_eit_proc_ctx_t *psi_eit_proc_ctx= NULL; // Do not release (alias)
 	psi_proc_ctx_t *psi_proc_ctx= NULL; // Do not release (alias)
-	pthread_mutex_t *psi_section_ctx_mutex_p= NULL; // Do not release
-	psi_section_ctx_t *psi_section_ctx= NULL;
+	uint8_t *sect_buf= NULL; // Do not release
+	size_t sect_size= 0;
 	LOG_CTX_INIT(NULL);
 
 	/* Check arguments */
@@ -570,53 +1403,31 @@ static int psi_section_proc_process_frame(proc_ctx_t *proc_ctx,
 
 	LOG_CTX_SET(proc_ctx->log_ctx);
 
-	pid= proc_ctx->proc_instance_index;
-
-	/* Get PSI section processor context structure and related fields */
-	psi_section_proc_ctx= (psi_section_proc_ctx_t*)proc_ctx;
+	psi_eit_proc_ctx= (psi_eit_proc_ctx_t*)proc_ctx;
 	psi_proc_ctx= (psi_proc_ctx_t*)proc_ctx;
-	psi_section_ctx_mutex_p= &psi_proc_ctx->psi_opaque_ctx_mutex;
 
-	/* Get next PSI section from input stream */
-	ret_code= psi_dec_get_next_section(iput_fifo_ctx, LOG_CTX_GET(),
-			&psi_proc_ctx->tscc_input, pid, &psi_section_ctx);
+	/* Read next (filtered and CRC-checked) raw section */
+	ret_code= psi_dec_read_next_section(iput_fifo_ctx, LOG_CTX_GET(),
+			&psi_proc_ctx->tscc_input, &psi_proc_ctx->sect_input, &sect_buf,
+			&sect_size);
 	if(ret_code!= STAT_SUCCESS) {
 		end_code= ret_code;
 		goto end;
 	}
-	CHECK_DO(psi_section_ctx!= NULL, goto end);
-
-	/* **** Update stored table copy **** */
-
-	/* Check if table has changed */
-	new_table_version_found= psi_section_proc_ctx->psi_section_ctx== NULL ||
-			psi_section_ctx_cmp(psi_section_ctx,
-					psi_section_proc_ctx->psi_section_ctx)!= 0;
-
-	/* If new table version found, store into context
-	 * (manage context members in mutual exclusion)
-	 */
-	if(new_table_version_found!= 0) {
-		uint8_t version_number;
-
-		/* Release previous stored section and update with the new one */
-		pthread_mutex_lock(psi_section_ctx_mutex_p);
-		psi_section_ctx_release(&psi_section_proc_ctx->psi_section_ctx);
-		psi_section_proc_ctx->psi_section_ctx= psi_section_ctx_dup(
-				psi_section_ctx);
-		pthread_mutex_unlock(psi_section_ctx_mutex_p);
-		CHECK_DO(psi_section_proc_ctx->psi_section_ctx!= NULL, goto end);
-
-		/* Trace the new section version and PID */
-		version_number= psi_section_ctx->version_number;
-		LOGW("New PSI-section parsed: PID= %u (0x%0x); version %u (0x%0x)\n",
-				pid, pid, version_number, version_number);
-	}
+	CHECK_DO(sect_buf!= NULL, goto end);
+
+	/* Parse section into the EIT cache */
+	pthread_mutex_lock(&psi_proc_ctx->psi_opaque_ctx_mutex);
+	ret_code= psi_eit_section(psi_eit_proc_ctx->psi_eit_ctx, sect_buf,
+			sect_size, (int64_t)time(NULL));
+	pthread_mutex_unlock(&psi_proc_ctx->psi_opaque_ctx_mutex);
+	if(ret_code== STAT_SUCCESS)
+		psi_proc_ctx->fp_input.decoded_count++;
+	else if(ret_code== STAT_NOTMODIFIED)
+		psi_proc_ctx->fp_input.repetitions_count++;
 
 	end_code= STAT_SUCCESS;
 end:
-	if(psi_section_ctx!= NULL)
-		psi_section_ctx_release(&psi_section_ctx);
 	return end_code;
 }
 
@@ -624,10 +1435,12 @@ end:
  * Implements the proc_if_s::opt callback.
  * See .proc_if.h for further details.
  */
-static int psi_section_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
+static int psi_eit_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 		va_list arg)
 {
 	int end_code= STAT_ERROR;
+	psi_eit_proc_ctx_t *psi_eit_proc_ctx= NULL; // Do not release (alias)
+	pthread_mutex_t *psi_eit_ctx_mutex_p= NULL; // Do not release
 	LOG_CTX_INIT(NULL);
 
 	/* Check arguments */
@@ -636,9 +1449,30 @@ static int psi_section_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 
 	LOG_CTX_SET(proc_ctx->log_ctx);
 
-	if(TAG_IS("PROCS_ID_GET_CSTRUCT_REST")) {
-		end_code= psi_section_proc_rest_get(proc_ctx, PROC_IF_REST_FMT_BINARY,
-				va_arg(arg, void**));
+	psi_eit_proc_ctx= (psi_eit_proc_ctx_t*)proc_ctx;
+	psi_eit_ctx_mutex_p=
+			&((psi_proc_ctx_t*)proc_ctx)->psi_opaque_ctx_mutex;
+
+	if(TAG_IS("PROCS_ID_PSI_EIT_GET_NOW_NEXT")) {
+		uint16_t service_id= (uint16_t)va_arg(arg, int);
+		int64_t now= va_arg(arg, int64_t);
+		psi_eit_event_t *event_now= va_arg(arg, psi_eit_event_t*);
+		psi_eit_event_t *event_next= va_arg(arg, psi_eit_event_t*);
+
+		pthread_mutex_lock(psi_eit_ctx_mutex_p);
+		end_code= psi_eit_get_now_next(psi_eit_proc_ctx->psi_eit_ctx,
+				service_id, now, event_now, event_next);
+		pthread_mutex_unlock(psi_eit_ctx_mutex_p);
+	} else if(TAG_IS("PROCS_ID_PSI_EIT_GET_STATS")) {
+		psi_eit_stats_t *psi_eit_stats= va_arg(arg, psi_eit_stats_t*);
+
+		pthread_mutex_lock(psi_eit_ctx_mutex_p);
+		end_code= psi_eit_get_stats(psi_eit_proc_ctx->psi_eit_ctx,
+				psi_eit_stats);
+		pthread_mutex_unlock(psi_eit_ctx_mutex_p);
+	} else if(TAG_IS("PROCS_ID_PSI_GET_STATS")) {
+		end_code= psi_proc_get_stats((psi_proc_ctx_t*)proc_ctx,
+				va_arg(arg, psi_proc_stats_t*));
 	} else {
 		LOGE("Unknown option\n");
 		end_code= STAT_ENOTFOUND;
@@ -646,60 +1480,240 @@ static int psi_section_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
 	return end_code;
 }
 
+/* **** PSI section tap processor **** */
+
 /**
- * Implements the proc_if_s::rest_get callback.
+ * Implements the proc_if_s::open callback.
  * See .proc_if.h for further details.
  */
-static int psi_section_proc_rest_get(proc_ctx_t *proc_ctx,
-		const proc_if_rest_fmt_t rest_fmt, void **ref_reponse)
+static proc_ctx_t* psi_tap_proc_open(const proc_if_t *proc_if,
+		const char *settings_str, const char* href, log_ctx_t *log_ctx,
+		va_list arg)
 {
-	int end_code= STAT_ERROR;
-	psi_section_proc_ctx_t *psi_section_proc_ctx=
-			NULL; // Do not release (alias)
+	int ret_code, end_code= STAT_ERROR;
+	int tap_size= PSI_PROC_TAP_FIFO_SIZE_DEFAULT;
+	psi_filter_t psi_filter;
+	psi_tap_proc_ctx_t *psi_tap_proc_ctx= NULL;
+	char *tap_name_str= NULL, *tap_size_str= NULL, *filter_match_str= NULL,
+			*filter_mask_str= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(proc_if!= NULL, return NULL);
+	CHECK_DO(settings_str!= NULL, return NULL);
+	// Parameter 'href' is allowed to be NULL
+	// Parameter 'log_ctx' is allowed to be NULL
+
+	/* Allocate context structure */
+	psi_tap_proc_ctx= (psi_tap_proc_ctx_t*)calloc(1, sizeof(
+			psi_tap_proc_ctx_t));
+	CHECK_DO(psi_tap_proc_ctx!= NULL, goto end);
+
+	/* **** Initialize context structure **** */
+
+	/* Initialize PSI processors common structure */
+	ret_code= psi_proc_ctx_init((psi_proc_ctx_t*)psi_tap_proc_ctx, proc_if,
+			settings_str, LOG_CTX_GET(), arg);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Section filter (if given) */
+	psi_filter_list_init(&psi_tap_proc_ctx->filter_list);
+	filter_match_str= uri_parser_query_str_get_value("tap_filter_match",
+			settings_str);
+	filter_mask_str= uri_parser_query_str_get_value("tap_filter_mask",
+			settings_str);
+	if(filter_mask_str!= NULL) {
+		psi_filter_init(&psi_filter);
+		CHECK_DO(psi_tap_hex_parse(filter_mask_str, psi_filter.mask,
+				sizeof(psi_filter.mask))== STAT_SUCCESS, goto end);
+		if(filter_match_str!= NULL) {
+			CHECK_DO(psi_tap_hex_parse(filter_match_str, psi_filter.match,
+					sizeof(psi_filter.match))== STAT_SUCCESS, goto end);
+		}
+		ret_code= psi_filter_list_add(&psi_tap_proc_ctx->filter_list,
+				&psi_filter, NULL);
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	}
+	((psi_proc_ctx_t*)psi_tap_proc_ctx)->sect_input.filter_list=
+			&psi_tap_proc_ctx->filter_list;
+
+	/* Shared-memory FIFO */
+	tap_name_str= uri_parser_query_str_get_value("tap_name", settings_str);
+	CHECK_DO(tap_name_str!= NULL && strlen(tap_name_str)> 0,
+			LOGE("A section tap name should be given\n"); goto end);
+	tap_size_str= uri_parser_query_str_get_value("tap_size", settings_str);
+	if(tap_size_str!= NULL && atoi(tap_size_str)> 0)
+		tap_size= atoi(tap_size_str);
+	psi_tap_proc_ctx->fifo_ctx_tap= fifo_shm_open(tap_size,
+			PSI_PROC_TAP_CHUNK_SIZE, FIFO_O_NONBLOCK, tap_name_str);
+	CHECK_DO(psi_tap_proc_ctx->fifo_ctx_tap!= NULL, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	if(tap_name_str!= NULL)
+		free(tap_name_str);
+	if(tap_size_str!= NULL)
+		free(tap_size_str);
+	if(filter_match_str!= NULL)
+		free(filter_match_str);
+	if(filter_mask_str!= NULL)
+		free(filter_mask_str);
+	if(end_code!= STAT_SUCCESS)
+		psi_tap_proc_close((proc_ctx_t**)&psi_tap_proc_ctx);
+	return (proc_ctx_t*)psi_tap_proc_ctx;
+}
+
+/**
+ * Implements the proc_if_s::close callback.
+ * See .proc_if.h for further details.
+ */
+static void psi_tap_proc_close(proc_ctx_t **ref_proc_ctx)
+{
+	psi_tap_proc_ctx_t *psi_tap_proc_ctx;
+
+	if(ref_proc_ctx== NULL ||
+			(psi_tap_proc_ctx= (psi_tap_proc_ctx_t*)*ref_proc_ctx)== NULL)
+		return;
+
+	/* De-initialize PSI processors common structure */
+	psi_proc_ctx_deinit((psi_proc_ctx_t*)psi_tap_proc_ctx);
+
+	/* Release shared-memory FIFO */
+	fifo_close(&psi_tap_proc_ctx->fifo_ctx_tap);
+
+	/* Release context structure */
+	free(psi_tap_proc_ctx);
+	*ref_proc_ctx= NULL;
+}
+
+/**
+ * Implements the proc_if_s::process_frame callback.
+ * See .proc_if.h for further details.
+ * Sections are copied once, directly from the reassembly buffer to the
+ * shared-memory FIFO (no section structure is built).
+ */
+static int psi_tap_proc_process_frame(proc_ctx_t *proc_ctx,
+		fifo_ctx_t* iput_fifo_ctx, fifo_ctx_t* oput_fifo_ctx)
+{
+	int ret_code, end_code= STAT_ERROR;
+	psi_tap_proc_ctx_t *psi_tap_proc_ctx= NULL; // Do not release (alias)
 	psi_proc_ctx_t *psi_proc_ctx= NULL; // Do not release (alias)
-	pthread_mutex_t *psi_section_ctx_mutex_p= NULL; // Do no release
-	psi_section_ctx_t *psi_section_ctx_ret= NULL;
+	uint8_t *sect_buf= NULL; // Do not release
+	size_t sect_size= 0;
 	LOG_CTX_INIT(NULL);
 
 	/* Check arguments */
 	CHECK_DO(proc_ctx!= NULL, return STAT_ERROR);
-	CHECK_DO(rest_fmt< PROC_IF_REST_FMT_ENUM_MAX, return STAT_ERROR);
-	CHECK_DO(ref_reponse!= NULL, return STAT_ERROR);
+	CHECK_DO(iput_fifo_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(oput_fifo_ctx!= NULL, return STAT_ERROR);
 
 	LOG_CTX_SET(proc_ctx->log_ctx);
 
-	*ref_reponse= NULL;
-
-	/* Get PSI section processor context structure and related fields */
-	psi_section_proc_ctx= (psi_section_proc_ctx_t*)proc_ctx;
+	psi_tap_proc_ctx= (psi_tap_proc_ctx_t*)proc_ctx;
 	psi_proc_ctx= (psi_proc_ctx_t*)proc_ctx;
-	psi_section_ctx_mutex_p= &psi_proc_ctx->psi_opaque_ctx_mutex;
-
-	/* **** Attach data to REST response **** */
-
-	/* PSI section */
-	pthread_mutex_lock(psi_section_ctx_mutex_p);
-	if(psi_section_proc_ctx->psi_section_ctx!= NULL)
-		psi_section_ctx_ret= psi_section_ctx_dup(
-				psi_section_proc_ctx->psi_section_ctx);
-	pthread_mutex_unlock(psi_section_ctx_mutex_p);
-
-	// Reserved for future use: set other data values here...
-
-	/* Format response to be returned */
-	switch(rest_fmt) {
-	case PROC_IF_REST_FMT_BINARY:
-		*ref_reponse= (void*)psi_section_ctx_ret;
-		psi_section_ctx_ret= NULL; // Avoid double referencing
-		break;
-	default:
-		LOGE("Unknown format requested for processor REST\n");
+
+	/* Read next (filtered and CRC-checked) raw section */
+	ret_code= psi_dec_read_next_section(iput_fifo_ctx, LOG_CTX_GET(),
+			&psi_proc_ctx->tscc_input, &psi_proc_ctx->sect_input, &sect_buf,
+			&sect_size);
+	if(ret_code!= STAT_SUCCESS) {
+		end_code= ret_code;
 		goto end;
 	}
+	CHECK_DO(sect_buf!= NULL && sect_size<= PSI_PROC_TAP_CHUNK_SIZE,
+			goto end);
+
+	/* Write section to the shared-memory FIFO; if full, discard the oldest
+	 * section (consumers are never waited for).
+	 */
+	ret_code= fifo_put_dup(psi_tap_proc_ctx->fifo_ctx_tap, sect_buf,
+			sect_size);
+	if(ret_code== STAT_ENOMEM) {
+		void *elem= NULL;
+		size_t elem_size= 0;
+		if(fifo_get(psi_tap_proc_ctx->fifo_ctx_tap, &elem, &elem_size)==
+				STAT_SUCCESS)
+			psi_tap_proc_ctx->sections_overwritten++;
+		if(elem!= NULL)
+			free(elem);
+		ret_code= fifo_put_dup(psi_tap_proc_ctx->fifo_ctx_tap, sect_buf,
+				sect_size);
+	}
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	psi_tap_proc_ctx->sections_tapped++;
 
 	end_code= STAT_SUCCESS;
 end:
-	if(psi_section_ctx_ret!= NULL)
-		psi_section_ctx_release(&psi_section_ctx_ret);
 	return end_code;
 }
+
+/**
+ * Implements the proc_if_s::opt callback.
+ * See .proc_if.h for further details.
+ */
+static int psi_tap_proc_opt(proc_ctx_t *proc_ctx, const char *tag,
+		va_list arg)
+{
+	int end_code= STAT_ERROR;
+	psi_tap_proc_ctx_t *psi_tap_proc_ctx= NULL; // Do not release (alias)
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(proc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(tag!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(proc_ctx->log_ctx);
+
+	psi_tap_proc_ctx= (psi_tap_proc_ctx_t*)proc_ctx;
+
+	if(TAG_IS("PROCS_ID_PSI_TAP_GET_STATS")) {
+		psi_proc_tap_stats_t *psi_proc_tap_stats= va_arg(arg,
+				psi_proc_tap_stats_t*);
+		CHECK_DO(psi_proc_tap_stats!= NULL, return STAT_ERROR);
+
+		psi_proc_tap_stats->sections_tapped=
+				psi_tap_proc_ctx->sections_tapped;
+		psi_proc_tap_stats->sections_overwritten=
+				psi_tap_proc_ctx->sections_overwritten;
+		psi_proc_tap_stats->sections_filtered=
+				((psi_proc_ctx_t*)proc_ctx)->sect_input.filtered_count;
+		end_code= STAT_SUCCESS;
+	} else if(TAG_IS("PROCS_ID_PSI_GET_STATS")) {
+		end_code= psi_proc_get_stats((psi_proc_ctx_t*)proc_ctx,
+				va_arg(arg, psi_proc_stats_t*));
+	} else {
+		LOGE("Unknown option\n");
+		end_code= STAT_ENOTFOUND;
+	}
+	return end_code;
+}
+
+/**
+ * Parse an hexadecimal string (e.g. "4eff") into the given buffer; the
+ * buffer bytes not given in the string are set to zero.
+ * @return Status code (STAT_EINVAL if the string is not valid or too long).
+ */
+static int psi_tap_hex_parse(const char *str, uint8_t *buf, size_t buf_size)
+{
+	size_t i, str_len;
+
+	if(str== NULL || buf== NULL || (str_len= strlen(str))== 0 ||
+			(str_len& 1)!= 0 || str_len/ 2> buf_size)
+		return STAT_EINVAL;
+
+	memset(buf, 0, buf_size);
+	for(i= 0; i< str_len; i++) {
+		int nibble;
+		char c= str[i];
+		if(c>= '0' && c<= '9')
+			nibble= c- '0';
+		else if(c>= 'a' && c<= 'f')
+			nibble= c- 'a'+ 10;
+		else if(c>= 'A' && c<= 'F')
+			nibble= c- 'A'+ 10;
+		else
+			return STAT_EINVAL;
+		buf[i/ 2]|= (uint8_t)(nibble<< ((i& 1)? 0: 4));
+	}
+	return STAT_SUCCESS;
+}
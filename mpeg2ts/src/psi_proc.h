@@ -26,23 +26,217 @@
 #ifndef STREAMPROCESSORS_MPEG2TS_SRC_PSI_PROC_H_
 #define STREAMPROCESSORS_MPEG2TS_SRC_PSI_PROC_H_
 
+#include <inttypes.h>
+
 /* **** Definitions **** */
 
 /* Forward definitions */
 typedef struct proc_if_s proc_if_t;
 
+/**
+ * PSI version-change notification callback.
+ * Called from the PSI processor's processing thread each time a new table
+ * (or section) version is parsed. The callback should not block.
+ * To register a callback in a PSI processor use the processor specific
+ * option "PROCS_ID_PSI_SET_NOTIFY" as follows:
+ * @code
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_SET_NOTIFY", pid,
+ *         (psi_proc_notify_fxn_t)notify_fxn, (void*)opaque);
+ * @endcode
+ * Passing a NULL callback unregisters notifications. If a table was already
+ * parsed when registering, the callback is immediately called once.
+ * @param opaque Opaque pointer given when registering the callback.
+ * @param pid PSI processor PID.
+ * @param table_id Table identifier of the new table (section) version.
+ * @param version_number New version number.
+ */
+typedef void (*psi_proc_notify_fxn_t)(void *opaque, uint16_t pid,
+		uint8_t table_id, uint8_t version_number);
+
+/**
+ * PSI processor input statistics.
+ * To get the statistics of a PSI processor use the processor specific
+ * option "PROCS_ID_PSI_GET_STATS" as follows:
+ * @code
+ * psi_proc_stats_t psi_proc_stats;
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_GET_STATS", pid, &psi_proc_stats);
+ * @endcode
+ */
+typedef struct psi_proc_stats_s {
+	/**
+	 * Number of sections fully decoded.
+	 */
+	uint64_t sections_decoded;
+	/**
+	 * Number of repeated sections (detected by raw section fingerprint;
+	 * decoding skipped).
+	 */
+	uint64_t sections_repeated;
+	/**
+	 * Number of sections skipped by the section filters (see
+	 * 'proc_if_psi_demux_proc'; decoding skipped).
+	 */
+	uint64_t sections_filtered;
+	/**
+	 * Number of duplicated TS packets dropped.
+	 */
+	uint64_t ts_duplicates;
+	/**
+	 * Number of TS continuity counter errors.
+	 */
+	uint64_t ts_cc_errors;
+} psi_proc_stats_t;
+
+/**
+ * Section tap shared-memory FIFO element (chunk) size: maximum section
+ * size (see 'proc_if_psi_tap_proc').
+ */
+#define PSI_PROC_TAP_CHUNK_SIZE 4096 // PSI_TABLE_MAX_SECTION_LEN
+
+/**
+ * Default section tap shared-memory FIFO size (number of sections).
+ */
+#define PSI_PROC_TAP_FIFO_SIZE_DEFAULT 64
+
+/**
+ * Section tap statistics (see 'proc_if_psi_tap_proc').
+ */
+typedef struct psi_proc_tap_stats_s {
+	/**
+	 * Number of sections written to the shared-memory FIFO.
+	 */
+	uint64_t sections_tapped;
+	/**
+	 * Number of sections discarded unread, as the FIFO was full (oldest
+	 * sections are discarded first).
+	 */
+	uint64_t sections_overwritten;
+	/**
+	 * Number of sections skipped by the tap section filter.
+	 */
+	uint64_t sections_filtered;
+} psi_proc_tap_stats_t;
+
+/**
+ * PID parsing type of the PSI demultiplexer processor
+ * (see 'proc_if_psi_demux_proc').
+ */
+typedef enum psi_proc_pid_type_enum {
+	/**
+	 * Complete tables are parsed (e.g. PAT, SDT).
+	 */
+	PSI_PROC_PID_TABLE= 0,
+	/**
+	 * Single sections are parsed (e.g. PMS).
+	 */
+	PSI_PROC_PID_SECTION,
+	PSI_PROC_PID_TYPE_ENUM_MAX
+} psi_proc_pid_type_t;
+
 /* **** prototypes **** */
 
 /**
  * Processor interface implementing the
- * MPEG2-TS Program Specific Information (PSI) table decoder/parser.
+ * MPEG2-TS Program Specific Information (PSI) demultiplexer/parser.
+ * A single processor instance (and processing thread) parses all the
+ * registered PSI PIDs: the packets of all PIDs are sent to the same
+ * processor, and demultiplexed internally (packets of non-registered PIDs
+ * are discarded).
+ * The PID specific surface is provided by the following processor specific
+ * options (being 'proc_id' the PSI demultiplexer processor Id.):
+ * @code
+ * // Register PID (STAT_ECONFLICT if already registered)
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id, pid,
+ *         (psi_proc_pid_type_t)pid_type);
+ * // Unregister PID (STAT_ENOTFOUND if not registered)
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_DELETE", proc_id, pid);
+ * // Get a reference to the current table ('psi_table_ctx_t') or section
+ * // ('psi_section_ctx_t'), as with "PROCS_ID_GET_CSTRUCT_REST" for the
+ * // PID specific processors (STAT_ENOTFOUND if PID is not registered)
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_CSTRUCT_REST", proc_id, pid,
+ *         &ref);
+ * // Get PID input statistics
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_STATS", proc_id, pid,
+ *         &psi_proc_stats);
+ * // Add section filter to PID (see 'psi_filter_t'); only the sections
+ * // matching any of the filters of the PID are decoded (all the sections
+ * // are decoded if no filter is added). STAT_ENOMEM if no more filters can
+ * // be added to the PID.
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_FILTER_ADD", proc_id, pid,
+ *         (const psi_filter_t*)psi_filter, (int*)&filter_id);
+ * // Delete section filter from PID
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_FILTER_DELETE", proc_id, pid,
+ *         filter_id);
+ * // Register version-change notification callback (common to all PIDs)
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_SET_NOTIFY", proc_id,
+ *         (psi_proc_notify_fxn_t)notify_fxn, (void*)opaque);
+ * // Get a copy of the raw sections (concatenated, as received) of the
+ * // current table or section of the PID; 'buf' is to be released using
+ * // 'free()' (NULL if not available)
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_RAW", proc_id, pid,
+ *         (void**)&buf, (size_t*)&buf_size);
+ * // Preload raw sections (concatenated) into the PID, as if they were
+ * // received: they are published as provisional table or section, which
+ * // the sections received afterwards confirm (by CRC) or replace
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_PID_PRELOAD", proc_id, pid,
+ *         (const void*)buf, (size_t)buf_size);
+ * @endcode
+ */
+extern const proc_if_t proc_if_psi_demux_proc;
+
+/**
+ * Processor interface implementing the
+ * DVB Event Information Table (EIT) streaming parser (see 'psi_eit.h').
+ * The processor is fed with the EIT PID packets; the present/following and
+ * schedule sections of the actual transport stream are parsed into a
+ * bounded EIT cache. Optional settings (query string format):
+ * "eit_mem_budget" (memory budget in bytes; default
+ * PSI_EIT_MEM_BUDGET_DEFAULT) and "eit_horizon_sec" (schedule time horizon
+ * in seconds; default PSI_EIT_HORIZON_SEC_DEFAULT).
+ * The processor specific options are the following:
+ * @code
+ * // Get present and following events of a service (STAT_ENOTFOUND if not
+ * // available); 'now' is the current time in seconds since the Epoch
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_EIT_GET_NOW_NEXT", proc_id,
+ *         (int)service_id, (int64_t)now, (psi_eit_event_t*)&event_now,
+ *         (psi_eit_event_t*)&event_next);
+ * // Get EIT cache statistics
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_EIT_GET_STATS", proc_id,
+ *         (psi_eit_stats_t*)&psi_eit_stats);
+ * // Get input statistics
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_GET_STATS", proc_id, &psi_proc_stats);
+ * @endcode
  */
-extern const proc_if_t proc_if_psi_table_proc;
+extern const proc_if_t proc_if_psi_eit_proc;
 
 /**
  * Processor interface implementing the
- * MPEG2-TS Program Specific Information (PSI) section decoder/parser.
+ * MPEG2-TS section tap: complete (filtered and CRC-checked) raw sections of
+ * the PID the processor is fed with are written to a named shared-memory
+ * FIFO, so other local processes can get them without receiving and
+ * demultiplexing the stream again.
+ * The FIFO is created by the processor and behaves as a ring: if it is
+ * full, the oldest section is discarded. Sections are written as is (one
+ * section per FIFO element of at most PSI_PROC_TAP_CHUNK_SIZE bytes).
+ * Consumers open the FIFO as follows:
+ * @code
+ * fifo_ctx= fifo_shm_exec_open(tap_size, PSI_PROC_TAP_CHUNK_SIZE, 0,
+ *         tap_name);
+ * @endcode
+ * Settings (query string format):
+ * "tap_name" (shared-memory FIFO name; mandatory), "tap_size" (FIFO size
+ * in sections; default PSI_PROC_TAP_FIFO_SIZE_DEFAULT) and
+ * "tap_filter_match", "tap_filter_mask" (section filter match and mask
+ * bytes as hexadecimal strings of up to PSI_FILTER_LEN bytes, e.g.
+ * "tap_filter_match=4e&tap_filter_mask=ff"; see 'psi_filter_t'. All the
+ * sections are tapped if no filter is given).
+ * The processor specific options are the following:
+ * @code
+ * // Get tap statistics
+ * procs_opt(procs_ctx, "PROCS_ID_PSI_TAP_GET_STATS", proc_id,
+ *         (psi_proc_tap_stats_t*)&psi_proc_tap_stats);
+ * @endcode
  */
-extern const proc_if_t proc_if_psi_section_proc;
+extern const proc_if_t proc_if_psi_tap_proc;
 
 #endif /* STREAMPROCESSORS_MPEG2TS_SRC_PSI_PROC_H_ */
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file psi_store.c
+ * @author Rafael Antoniello
+ */
+
+#include "psi_store.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include "psi_crc.h"
+
+/* **** Definitions **** */
+
+/**
+ * PSI store file magic word.
+ */
+#define PSI_STORE_MAGIC "PSIS"
+
+/**
+ * Size of the fixed part of the file header (magic word, version, reserved
+ * byte and URL length) and of each record header (PID and size).
+ */
+#define PSI_STORE_HDR_SIZE 8
+#define PSI_STORE_REC_HDR_SIZE 6
+
+/**
+ * Maximum PSI store file size accepted when loading [bytes].
+ */
+#define PSI_STORE_FILE_SIZE_MAX (4* 1024* 1024)
+
+#define PUT_16(P, V) \
+	(P)[0]= (uint8_t)((V)>> 8); (P)[1]= (uint8_t)(V); (P)+= 2;
+#define PUT_32(P, V) \
+	(P)[0]= (uint8_t)((V)>> 24); (P)[1]= (uint8_t)((V)>> 16);\
+	(P)[2]= (uint8_t)((V)>> 8); (P)[3]= (uint8_t)(V); (P)+= 4;
+#define GET_16(P) (((uint16_t)(P)[0]<< 8)| (P)[1])
+#define GET_32(P) (((uint32_t)(P)[0]<< 24)| ((uint32_t)(P)[1]<< 16)|\
+		((uint32_t)(P)[2]<< 8)| (P)[3])
+
+/* **** Implementations **** */
+
+int psi_store_dir_create(const char *dir, log_ctx_t *log_ctx)
+{
+	struct stat st;
+	char *path= NULL, *p;
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(dir!= NULL && strlen(dir)> 0, return STAT_ERROR);
+
+	/* Create missing path components (private to the user) */
+	path= strdup(dir);
+	CHECK_DO(path!= NULL, goto end);
+	for(p= strchr(path+ 1, '/'); ; p= strchr(p+ 1, '/')) {
+		if(p!= NULL)
+			*p= '\0';
+		if(mkdir(path, S_IRWXU)!= 0 && errno!= EEXIST) {
+			LOGE("Could not create PSI store directory '%s': %s\n", path,
+					strerror(errno));
+			end_code= STAT_EINVAL;
+			goto end;
+		}
+		if(p== NULL)
+			break;
+		*p= '/';
+	}
+
+	/* Check the directory itself is ours and private */
+	if(lstat(dir, &st)!= 0 || !S_ISDIR(st.st_mode) ||
+			st.st_uid!= geteuid()) {
+		LOGE("PSI store directory '%s' is not a directory owned by the "
+				"user\n", dir);
+		end_code= STAT_EINVAL;
+		goto end;
+	}
+	if((st.st_mode& (S_IRWXG| S_IRWXO))!= 0 && chmod(dir, S_IRWXU)!= 0) {
+		LOGE("Could not make PSI store directory '%s' private: %s\n", dir,
+				strerror(errno));
+		end_code= STAT_EINVAL;
+		goto end;
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	if(path!= NULL)
+		free(path);
+	return end_code;
+}
+
+char* psi_store_path(const char *dir, const char *input_url)
+{
+	uint64_t hash= 0xcbf29ce484222325ULL; // FNV-1a offset basis
+	const char *p;
+	char *path;
+	size_t path_size;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(dir!= NULL, return NULL);
+	CHECK_DO(input_url!= NULL, return NULL);
+
+	for(p= input_url; *p!= '\0'; p++) {
+		hash^= (uint8_t)*p;
+		hash*= 0x100000001b3ULL; // FNV-1a prime
+	}
+
+	path_size= strlen(dir)+ strlen("/psi_.bin")+ 16+ 1;
+	path= (char*)malloc(path_size);
+	CHECK_DO(path!= NULL, return NULL);
+	snprintf(path, path_size, "%s/psi_%016"PRIx64".bin", dir, hash);
+	return path;
+}
+
+int psi_store_save(const char *path, const char *input_url,
+		const psi_store_rec_t *rec_array, int rec_num, log_ctx_t *log_ctx)
+{
+	int i, fd= -1, end_code= STAT_ERROR;
+	size_t url_len, buf_size, written;
+	uint8_t *buf= NULL, *p;
+	uint32_t crc_32;
+	char *path_tmp= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(path!= NULL, return STAT_ERROR);
+	CHECK_DO(input_url!= NULL, return STAT_ERROR);
+	CHECK_DO(rec_array!= NULL || rec_num== 0, return STAT_ERROR);
+	CHECK_DO(rec_num>= 0 && rec_num<= PSI_STORE_RECS_MAX, return STAT_ERROR);
+
+	url_len= strlen(input_url);
+	CHECK_DO(url_len<= 0xFFFF, return STAT_EINVAL);
+
+	/* Serialize into a single buffer */
+	buf_size= PSI_STORE_HDR_SIZE+ url_len+ 2+ 4;
+	for(i= 0; i< rec_num; i++)
+		buf_size+= PSI_STORE_REC_HDR_SIZE+ rec_array[i].buf_size;
+	CHECK_DO(buf_size<= PSI_STORE_FILE_SIZE_MAX, return STAT_EINVAL);
+	buf= (uint8_t*)malloc(buf_size);
+	CHECK_DO(buf!= NULL, goto end);
+
+	p= buf;
+	memcpy(p, PSI_STORE_MAGIC, 4);
+	p+= 4;
+	*p++= PSI_STORE_VERSION;
+	*p++= 0; // reserved
+	PUT_16(p, url_len);
+	memcpy(p, input_url, url_len);
+	p+= url_len;
+	PUT_16(p, rec_num);
+	for(i= 0; i< rec_num; i++) {
+		const psi_store_rec_t *psi_store_rec= &rec_array[i];
+		PUT_16(p, psi_store_rec->pid);
+		PUT_32(p, psi_store_rec->buf_size);
+		if(psi_store_rec->buf_size> 0) {
+			memcpy(p, psi_store_rec->buf, psi_store_rec->buf_size);
+			p+= psi_store_rec->buf_size;
+		}
+	}
+	crc_32= psi_crc32(buf, p- buf);
+	PUT_32(p, crc_32);
+	ASSERT((size_t)(p- buf)== buf_size);
+
+	/* Write a new temporary file (never an existing one; 'mkstemp()'
+	 * creates it exclusively with mode 0600), flush it to disk and rename
+	 * it.
+	 */
+	path_tmp= (char*)malloc(strlen(path)+ strlen(".XXXXXX")+ 1);
+	CHECK_DO(path_tmp!= NULL, goto end);
+	sprintf(path_tmp, "%s.XXXXXX", path);
+	if((fd= mkstemp(path_tmp))< 0) {
+		LOGE("Could not create PSI store file '%s': %s\n", path_tmp,
+				strerror(errno));
+		free(path_tmp);
+		path_tmp= NULL; // Not created; do not remove
+		goto end;
+	}
+	for(written= 0; written< buf_size; ) {
+		ssize_t ret= write(fd, buf+ written, buf_size- written);
+		if(ret< 0 && errno== EINTR)
+			continue;
+		if(ret<= 0) {
+			LOGE("Could not write PSI store file '%s': %s\n", path_tmp,
+					strerror(errno));
+			goto end;
+		}
+		written+= (size_t)ret;
+	}
+	if(fsync(fd)!= 0) {
+		LOGE("Could not flush PSI store file '%s': %s\n", path_tmp,
+				strerror(errno));
+		goto end;
+	}
+	CHECK_DO(close(fd)== 0, fd= -1; goto end);
+	fd= -1;
+	if(rename(path_tmp, path)!= 0) {
+		LOGE("Could not rename PSI store file '%s': %s\n", path_tmp,
+				strerror(errno));
+		goto end;
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	if(fd>= 0)
+		close(fd);
+	if(end_code!= STAT_SUCCESS && path_tmp!= NULL)
+		remove(path_tmp);
+	if(path_tmp!= NULL)
+		free(path_tmp);
+	if(buf!= NULL)
+		free(buf);
+	return end_code;
+}
+
+int psi_store_load(const char *path, const char *input_url,
+		log_ctx_t *log_ctx, psi_store_rec_t **ref_rec_array,
+		int *ref_rec_num)
+{
+	struct stat st;
+	int i, rec_num= 0, end_code= STAT_ERROR;
+	size_t url_len, buf_size= 0;
+	uint8_t *buf= NULL, *p, *p_end;
+	psi_store_rec_t *rec_array= NULL;
+	FILE *file= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments */
+	CHECK_DO(path!= NULL, return STAT_ERROR);
+	CHECK_DO(input_url!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_rec_array!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_rec_num!= NULL, return STAT_ERROR);
+
+	*ref_rec_array= NULL;
+	*ref_rec_num= 0;
+
+	/* Read the whole file */
+	if((file= fopen(path, "rb"))== NULL) {
+		end_code= STAT_ENOTFOUND;
+		goto end;
+	}
+	CHECK_DO(fstat(fileno(file), &st)== 0, goto end);
+	if(st.st_size< PSI_STORE_HDR_SIZE+ 2+ 4 ||
+			st.st_size> PSI_STORE_FILE_SIZE_MAX) {
+		end_code= STAT_EINVAL;
+		goto end;
+	}
+	buf_size= (size_t)st.st_size;
+	buf= (uint8_t*)malloc(buf_size);
+	CHECK_DO(buf!= NULL, goto end);
+	CHECK_DO(fread(buf, 1, buf_size, file)== buf_size, goto end);
+
+	/* Check header, URL and file CRC */
+	end_code= STAT_EINVAL;
+	p= buf;
+	p_end= buf+ buf_size- 4;
+	if(memcmp(p, PSI_STORE_MAGIC, 4)!= 0 || p[4]!= PSI_STORE_VERSION)
+		goto end;
+	if(psi_crc32(buf, buf_size- 4)!= GET_32(p_end))
+		goto end;
+	url_len= GET_16(p+ 6);
+	p+= PSI_STORE_HDR_SIZE;
+	if(url_len+ 2> (size_t)(p_end- p))
+		goto end;
+	if(url_len!= strlen(input_url) || memcmp(p, input_url, url_len)!= 0) {
+		end_code= STAT_ENOTFOUND; // Hash collision
+		goto end;
+	}
+	p+= url_len;
+
+	/* Parse records */
+	rec_num= GET_16(p);
+	p+= 2;
+	if(rec_num> PSI_STORE_RECS_MAX)
+		goto end;
+	if(rec_num> 0) {
+		rec_array= (psi_store_rec_t*)calloc(rec_num, sizeof(psi_store_rec_t));
+		CHECK_DO(rec_array!= NULL, end_code= STAT_ERROR; goto end);
+	}
+	for(i= 0; i< rec_num; i++) {
+		psi_store_rec_t *psi_store_rec= &rec_array[i];
+		if(PSI_STORE_REC_HDR_SIZE> p_end- p)
+			goto end;
+		psi_store_rec->pid= GET_16(p);
+		psi_store_rec->buf_size= GET_32(p+ 2);
+		p+= PSI_STORE_REC_HDR_SIZE;
+		if(psi_store_rec->buf_size> (size_t)(p_end- p))
+			goto end;
+		if(psi_store_rec->buf_size> 0) {
+			psi_store_rec->buf= malloc(psi_store_rec->buf_size);
+			CHECK_DO(psi_store_rec->buf!= NULL, end_code= STAT_ERROR;
+					goto end);
+			memcpy(psi_store_rec->buf, p, psi_store_rec->buf_size);
+			p+= psi_store_rec->buf_size;
+		}
+	}
+	if(p!= p_end)
+		goto end;
+
+	*ref_rec_array= rec_array;
+	rec_array= NULL; // Avoid double referencing
+	*ref_rec_num= rec_num;
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code== STAT_EINVAL)
+		LOGW("Discarding invalid PSI store file '%s'\n", path);
+	if(file!= NULL)
+		fclose(file);
+	if(buf!= NULL)
+		free(buf);
+	psi_store_recs_release(&rec_array, rec_num);
+	return end_code;
+}
+
+void psi_store_recs_release(psi_store_rec_t **ref_rec_array, int rec_num)
+{
+	int i;
+	psi_store_rec_t *rec_array;
+
+	if(ref_rec_array== NULL || (rec_array= *ref_rec_array)== NULL)
+		return;
+
+	for(i= 0; i< rec_num; i++) {
+		if(rec_array[i].buf!= NULL)
+			free(rec_array[i].buf);
+	}
+	free(rec_array);
+	*ref_rec_array= NULL;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file psi_store.h
+ * @brief Persistent last-known PSI store.
+ * The last validated raw PSI sections of an input (e.g. PAT, PMS and SDT
+ * sections) are kept in a compact binary file named after the input URL,
+ * so they can be preloaded as provisional tables when the input is opened
+ * again (the live stream then confirms or replaces them).
+ * File layout (multi-byte fields in network byte order):
+ * @code
+ * "PSIS" | version (1 byte) | reserved (1 byte) | URL length (2 bytes) |
+ * URL | number of records (2 bytes) |
+ * { PID (2 bytes) | size (4 bytes) | raw sections (size bytes) }... |
+ * CRC-32/MPEG-2 of all the preceding bytes (4 bytes)
+ * @endcode
+ * Each record carries the raw sections of a PID as they were received
+ * (sections are concatenated; each one is delimited by its own
+ * 'section_length' field and checked by its own CRC when decoded).
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_PSI_STORE_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_PSI_STORE_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+
+/**
+ * PSI store file format version.
+ */
+#define PSI_STORE_VERSION 1
+
+/**
+ * Maximum number of records (PIDs) of a PSI store file.
+ */
+#define PSI_STORE_RECS_MAX 1024
+
+/**
+ * PSI store record: raw sections of a PID.
+ */
+typedef struct psi_store_rec_s {
+	/**
+	 * Packet identifier.
+	 */
+	uint16_t pid;
+	/**
+	 * Raw sections (concatenated).
+	 */
+	void *buf;
+	/**
+	 * Size of the raw sections buffer in bytes.
+	 */
+	size_t buf_size;
+} psi_store_rec_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Create the PSI store directory (and its missing parents) private to the
+ * effective user (mode 0700); an already existing directory owned by the
+ * user is made private. Store files hold the PSI of the user's inputs, so
+ * a directory owned by other user (or a symbolic link) is refused.
+ * @param dir Directory path.
+ * @param log_ctx LOG module context structure.
+ * @return Status code (STAT_EINVAL if the directory is not usable; refer to
+ * 'stat_codes_ctx_t' type).
+ */
+int psi_store_dir_create(const char *dir, log_ctx_t *log_ctx);
+
+/**
+ * Compose the path of the PSI store file of the given input URL.
+ * The file name is derived from a hash of the URL; the URL itself is also
+ * kept in the file to discard hash collisions (see 'psi_store_load()').
+ * @param dir Directory path.
+ * @param input_url Input URL.
+ * @return The file path string (to be released using 'free()'), or NULL
+ * if fails.
+ */
+char* psi_store_path(const char *dir, const char *input_url);
+
+/**
+ * Save the given records to the PSI store file.
+ * The file is written to a new, exclusively created, temporary file which
+ * is flushed to disk and then renamed, so a complete file is always found
+ * (the previous one or the new one).
+ * @param path PSI store file path (see 'psi_store_path()').
+ * @param input_url Input URL the records belong to.
+ * @param rec_array Array of records.
+ * @param rec_num Number of records in the array.
+ * @param log_ctx LOG module context structure.
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
+ */
+int psi_store_save(const char *path, const char *input_url,
+		const psi_store_rec_t *rec_array, int rec_num, log_ctx_t *log_ctx);
+
+/**
+ * Load the records of the PSI store file.
+ * @param path PSI store file path (see 'psi_store_path()').
+ * @param input_url Input URL the records should belong to.
+ * @param log_ctx LOG module context structure.
+ * @param ref_rec_array Reference to the pointer to the array of records
+ * returned (to be released using 'psi_store_recs_release()').
+ * @param ref_rec_num Reference to the number of records returned.
+ * @return Status code: STAT_ENOTFOUND if the file does not exist or it
+ * belongs to other URL, STAT_EINVAL if the file is corrupted or of other
+ * version (refer to 'stat_codes_ctx_t' type).
+ */
+int psi_store_load(const char *path, const char *input_url,
+		log_ctx_t *log_ctx, psi_store_rec_t **ref_rec_array,
+		int *ref_rec_num);
+
+/**
+ * Release an array of records.
+ * @param ref_rec_array Reference to the pointer to the array of records;
+ * pointer is set to NULL on return.
+ * @param rec_num Number of records in the array.
+ */
+void psi_store_recs_release(psi_store_rec_t **ref_rec_array, int rec_num);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_PSI_STORE_H_ */
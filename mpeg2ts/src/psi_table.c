@@ -36,6 +36,76 @@
 #include "psi_dvb.h"
 #include "psi_desc.h"
 
+/* **** Definitions **** */
+
+/**
+ * Minimum number of slots of the index hash tables (power of 2).
+ */
+#define PSI_TABLE_IDX_HASH_MIN 8
+
+/**
+ * Index hash table slot (open addressing, linear probing).
+ */
+typedef struct psi_table_idx_slot_s {
+	int used;
+	uint16_t key;
+	void *data;
+	/**
+	 * Auxiliary data resolved when indexing (see 'psi_table_idx_t').
+	 */
+	void *aux;
+} psi_table_idx_slot_t;
+
+/**
+ * PSI table lookup index.
+ * The whole structure (including the arrays) is allocated in a single block.
+ * Indexed data is referenced (not owned): the index is only valid as long as
+ * the indexed sections list is not modified.
+ */
+typedef struct psi_table_idx_s {
+	/**
+	 * Table identifier of the indexed sections (first section).
+	 */
+	uint8_t table_id;
+	/**
+	 * Sections array (in the sections list order).
+	 */
+	int sections_num;
+	psi_section_ctx_t **sections;
+	/**
+	 * Hash tables size (number of slots, power of 2; zero if the table type
+	 * has no programs to index).
+	 */
+	size_t hash_size;
+	/**
+	 * Program number hash table. Data type depends on the table type:
+	 * - PAT: 'psi_pas_prog_ctx_t';
+	 * - PMT: 'psi_section_ctx_t' (PMS);
+	 * - SDT: 'psi_dvb_sds_prog_ctx_t' (auxiliary data: service name,
+	 * 'const char*', or NULL if not signaled).
+	 */
+	psi_table_idx_slot_t *hash_program_num;
+	/**
+	 * PID hash table. Data type depends on the table type:
+	 * - PAT: 'psi_pas_prog_ctx_t' (program map PID);
+	 * - PMT: 'psi_section_ctx_t' (PMS the elementary stream or PCR PID
+	 * belongs to; auxiliary data: 'psi_pms_es_ctx_t', or NULL for a PCR PID
+	 * not carrying an elementary stream of the program).
+	 */
+	psi_table_idx_slot_t *hash_pid;
+} psi_table_idx_t;
+
+/* **** Prototypes **** */
+
+static const char* psi_table_dvb_sds_prog_service_name(
+		const psi_dvb_sds_prog_ctx_t *psi_dvb_sds_prog_ctx);
+static void psi_table_idx_hash_put(psi_table_idx_slot_t *hash,
+		size_t hash_size, uint16_t key, void *data, void *aux);
+static void* psi_table_idx_hash_get(const psi_table_idx_slot_t *hash,
+		size_t hash_size, uint16_t key);
+static const psi_table_idx_slot_t* psi_table_idx_hash_slot(
+		const psi_table_idx_slot_t *hash, size_t hash_size, uint16_t key);
+
 /* **** Implementations **** */
 
 psi_table_ctx_t* psi_table_ctx_allocate()
@@ -64,6 +134,12 @@ psi_table_ctx_t* psi_table_ctx_dup(const psi_table_ctx_t *psi_table_ctx_arg)
 			psi_section_ctx_t, ret_code);
 	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
 
+	/* Re-build index if the source table was indexed */
+	if(psi_table_ctx_arg->psi_table_idx!= NULL) {
+		ret_code= psi_table_ctx_index(psi_table_ctx);
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	}
+
 	end_code= STAT_SUCCESS;
 end:
 	if(end_code!= STAT_SUCCESS)
@@ -71,10 +147,176 @@ end:
 	return psi_table_ctx;
 }
 
+psi_table_ctx_t* psi_table_ctx_ref(psi_table_ctx_t *psi_table_ctx)
+{
+	CHECK_DO(psi_table_ctx!= NULL, return NULL);
+	__atomic_add_fetch(&psi_table_ctx->refs, 1, __ATOMIC_RELAXED);
+	return psi_table_ctx;
+}
+
+int psi_table_ctx_index(psi_table_ctx_t *psi_table_ctx)
+{
+	llist_t *n;
+	size_t hash_size, idx_size;
+	int i, sections_num= 0, programs_num= 0, pids_num= 0;
+	uint8_t table_id= 0xFF;
+	psi_table_idx_t *psi_table_idx= NULL;
+
+	/* Check arguments */
+	CHECK_DO(psi_table_ctx!= NULL, return STAT_ERROR);
+
+	/* Count sections and programs to index */
+	for(n= psi_table_ctx->psi_section_ctx_llist; n!= NULL; n= n->next) {
+		psi_section_ctx_t *psi_section_ctx_nth= (psi_section_ctx_t*)n->data;
+
+		CHECK_DO(psi_section_ctx_nth!= NULL, return STAT_ERROR);
+		if(sections_num++== 0)
+			table_id= psi_section_ctx_nth->table_id;
+		if(psi_section_ctx_nth->data== NULL)
+			continue;
+		switch(table_id) {
+		case PSI_TABLE_PROGRAM_ASSOCIATION_SECTION:
+			programs_num+= llist_len(((psi_pas_ctx_t*)
+					psi_section_ctx_nth->data)->psi_pas_prog_ctx_llist);
+			break;
+		case PSI_TABLE_TS_PROGRAM_MAP_SECTION:
+			programs_num++;
+			pids_num+= 1+ llist_len(((psi_pms_ctx_t*)
+					psi_section_ctx_nth->data)->psi_pms_es_ctx_llist);
+			break;
+		case PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL:
+			programs_num+= llist_len(((psi_dvb_sds_ctx_t*)
+					psi_section_ctx_nth->data)->psi_dvb_sds_prog_ctx_llist);
+			break;
+		default:
+			break;
+		}
+	}
+
+	/* Hash tables are kept at most half full */
+	if(pids_num> programs_num)
+		programs_num= pids_num;
+	hash_size= 0;
+	if(programs_num> 0)
+		for(hash_size= PSI_TABLE_IDX_HASH_MIN;
+				hash_size< (size_t)programs_num* 2; hash_size<<= 1);
+
+	/* Allocate index (single block) */
+	idx_size= sizeof(psi_table_idx_t)+
+			sections_num* sizeof(psi_section_ctx_t*)+
+			2* hash_size* sizeof(psi_table_idx_slot_t);
+	psi_table_idx= (psi_table_idx_t*)calloc(1, idx_size);
+	CHECK_DO(psi_table_idx!= NULL, return STAT_ENOMEM);
+	psi_table_idx->table_id= table_id;
+	psi_table_idx->sections_num= sections_num;
+	psi_table_idx->hash_size= hash_size;
+	psi_table_idx->hash_program_num= (psi_table_idx_slot_t*)&psi_table_idx[1];
+	psi_table_idx->hash_pid= psi_table_idx->hash_program_num+ hash_size;
+	psi_table_idx->sections= (psi_section_ctx_t**)(psi_table_idx->hash_pid+
+			hash_size);
+
+	/* Index sections and programs (first occurrence of a key prevails, as
+	 * it does with the linear traversal).
+	 */
+	for(n= psi_table_ctx->psi_section_ctx_llist, i= 0; n!= NULL;
+			n= n->next, i++) {
+		llist_t *n2;
+		psi_section_ctx_t *psi_section_ctx_nth= (psi_section_ctx_t*)n->data;
+
+		psi_table_idx->sections[i]= psi_section_ctx_nth;
+		if(psi_section_ctx_nth->data== NULL || hash_size== 0)
+			continue;
+		switch(table_id) {
+		case PSI_TABLE_PROGRAM_ASSOCIATION_SECTION:
+			for(n2= ((psi_pas_ctx_t*)psi_section_ctx_nth->data)->
+					psi_pas_prog_ctx_llist; n2!= NULL; n2= n2->next) {
+				psi_pas_prog_ctx_t *psi_pas_prog_ctx=
+						(psi_pas_prog_ctx_t*)n2->data;
+				CHECK_DO(psi_pas_prog_ctx!= NULL, continue);
+				psi_table_idx_hash_put(psi_table_idx->hash_program_num,
+						hash_size, psi_pas_prog_ctx->program_number,
+						psi_pas_prog_ctx, NULL);
+				psi_table_idx_hash_put(psi_table_idx->hash_pid, hash_size,
+						psi_pas_prog_ctx->reference_pid, psi_pas_prog_ctx,
+						NULL);
+			}
+			break;
+		case PSI_TABLE_TS_PROGRAM_MAP_SECTION:
+			/* For a PMS, 'table_id_extension' is the 'program_number' */
+			psi_table_idx_hash_put(psi_table_idx->hash_program_num, hash_size,
+					psi_section_ctx_nth->table_id_extension,
+					psi_section_ctx_nth, NULL);
+			/* Elementary stream PIDs (PCR PIDs are indexed afterwards, so
+			 * that an ES PID always prevails over a PCR PID).
+			 */
+			for(n2= ((psi_pms_ctx_t*)psi_section_ctx_nth->data)->
+					psi_pms_es_ctx_llist; n2!= NULL; n2= n2->next) {
+				psi_pms_es_ctx_t *psi_pms_es_ctx= (psi_pms_es_ctx_t*)n2->data;
+				CHECK_DO(psi_pms_es_ctx!= NULL, continue);
+				psi_table_idx_hash_put(psi_table_idx->hash_pid, hash_size,
+						psi_pms_es_ctx->elementary_PID, psi_section_ctx_nth,
+						psi_pms_es_ctx);
+			}
+			break;
+		case PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL:
+			for(n2= ((psi_dvb_sds_ctx_t*)psi_section_ctx_nth->data)->
+					psi_dvb_sds_prog_ctx_llist; n2!= NULL; n2= n2->next) {
+				psi_dvb_sds_prog_ctx_t *psi_dvb_sds_prog_ctx=
+						(psi_dvb_sds_prog_ctx_t*)n2->data;
+				CHECK_DO(psi_dvb_sds_prog_ctx!= NULL, continue);
+				psi_table_idx_hash_put(psi_table_idx->hash_program_num,
+						hash_size, psi_dvb_sds_prog_ctx->service_id,
+						psi_dvb_sds_prog_ctx,
+						(void*)psi_table_dvb_sds_prog_service_name(
+								psi_dvb_sds_prog_ctx));
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	/* PCR PIDs not carrying an elementary stream */
+	if(table_id== PSI_TABLE_TS_PROGRAM_MAP_SECTION && hash_size> 0) {
+		for(i= 0; i< sections_num; i++) {
+			psi_section_ctx_t *psi_section_ctx_nth= psi_table_idx->sections[i];
+			if(psi_section_ctx_nth->data== NULL)
+				continue;
+			psi_table_idx_hash_put(psi_table_idx->hash_pid, hash_size,
+					((psi_pms_ctx_t*)psi_section_ctx_nth->data)->pcr_pid,
+					psi_section_ctx_nth, NULL);
+		}
+	}
+
+	/* Substitute previous index if any */
+	if(psi_table_ctx->psi_table_idx!= NULL)
+		free(psi_table_ctx->psi_table_idx);
+	psi_table_ctx->psi_table_idx= psi_table_idx;
+	return STAT_SUCCESS;
+}
+
+psi_section_ctx_t* psi_table_ctx_get_section(
+		const psi_table_ctx_t *psi_table_ctx, int nth)
+{
+	const psi_table_idx_t *psi_table_idx;
+
+	/* Check arguments */
+	CHECK_DO(psi_table_ctx!= NULL, return NULL);
+
+	if((psi_table_idx= psi_table_ctx->psi_table_idx)== NULL)
+		return (psi_section_ctx_t*)llist_get_nth(
+				psi_table_ctx->psi_section_ctx_llist, nth);
+
+	if(nth< 0 || nth>= psi_table_idx->sections_num)
+		return NULL;
+	return psi_table_idx->sections[nth];
+}
+
 int psi_table_ctx_cmp(psi_table_ctx_t *psi_table_ctx1,
 		psi_table_ctx_t *psi_table_ctx2)
 {
-	int i, sections_cnt1, sections_cnt2;
+	llist_t *n1, *n2;
+	int sections_cnt1, sections_cnt2;
 
 	/* Check arguments */
 	CHECK_DO(psi_table_ctx1!= NULL, return 1);
@@ -86,18 +328,12 @@ int psi_table_ctx_cmp(psi_table_ctx_t *psi_table_ctx1,
 	if(sections_cnt1!= sections_cnt2)
 		return 1;
 
-	/* Compare section by section */
-	for(i= 0;; i++) {
-		psi_section_ctx_t *s1, *s2;
-
-		/* Get sections */
-		s1= (psi_section_ctx_t*)llist_get_nth(
-				psi_table_ctx1->psi_section_ctx_llist, i);
-		s2= (psi_section_ctx_t*)llist_get_nth(
-				psi_table_ctx2->psi_section_ctx_llist, i);
-		if(s1== NULL && s2== NULL)
-			break; // end of lists reached.
-		if(psi_section_ctx_cmp(s1, s2)!= 0)
+	/* Compare section by section (traverse both lists at once) */
+	for(n1= psi_table_ctx1->psi_section_ctx_llist,
+			n2= psi_table_ctx2->psi_section_ctx_llist; n1!= NULL && n2!= NULL;
+			n1= n1->next, n2= n2->next) {
+		if(psi_section_ctx_cmp((psi_section_ctx_t*)n1->data,
+				(psi_section_ctx_t*)n2->data)!= 0)
 			return 1;
 	}
 	return 0;
@@ -111,6 +347,11 @@ void psi_table_ctx_release(psi_table_ctx_t **ref_psi_table_ctx)
 		return;
 
 	if((psi_table_ctx= *ref_psi_table_ctx)!= NULL) {
+		/* Release just this reference if others are held */
+		if(__atomic_fetch_sub(&psi_table_ctx->refs, 1, __ATOMIC_ACQ_REL)> 0) {
+			*ref_psi_table_ctx= NULL;
+			return;
+		}
 		if(psi_table_ctx->psi_section_ctx_llist!= NULL) {
 			/* Release table sections list */
 		    while(psi_table_ctx->psi_section_ctx_llist!= NULL) {
@@ -119,6 +360,8 @@ void psi_table_ctx_release(psi_table_ctx_t **ref_psi_table_ctx)
 		    	psi_section_ctx_release(&psi_section_ctx);
 		    }
 		}
+		if(psi_table_ctx->psi_table_idx!= NULL)
+			free(psi_table_ctx->psi_table_idx);
 		free(*ref_psi_table_ctx);
 		*ref_psi_table_ctx= NULL;
 	}
@@ -159,6 +402,15 @@ static inline psi_pas_prog_ctx_t* psi_table_pat_ctx_filter_id(
 	/* Check arguments */
 	CHECK_DO(psi_table_pat_ctx!= NULL, return NULL);
 
+	/* Use index if available */
+	if(psi_table_pat_ctx->psi_table_idx!= NULL) {
+		const psi_table_idx_t *psi_table_idx= psi_table_pat_ctx->psi_table_idx;
+		return (psi_pas_prog_ctx_t*)psi_table_idx_hash_get(
+				filter_id== FILTER_ID_PID? psi_table_idx->hash_pid:
+						psi_table_idx->hash_program_num,
+				psi_table_idx->hash_size, reference_id);
+	}
+
 	/* Iterate over PAT and get service specific data for this PID */
 	for(n= psi_table_pat_ctx->psi_section_ctx_llist; n!= NULL; n= n->next) {
 		llist_t *n2;
@@ -214,7 +466,6 @@ psi_section_ctx_t* psi_table_pmt_ctx_filter_program_pid(
 		const psi_table_pat_ctx_t* psi_table_pat_ctx,
 		const psi_table_pmt_ctx_t* psi_table_pmt_ctx, uint16_t reference_pid)
 {
-	llist_t *n;
 	uint16_t program_number;
 	psi_pas_prog_ctx_t *psi_pas_prog_ctx;
 
@@ -230,21 +481,8 @@ psi_section_ctx_t* psi_table_pmt_ctx_filter_program_pid(
 
 	program_number= psi_pas_prog_ctx->program_number;
 
-	/* Iterate over PMT and get service specific data for this program */
-	for(n= psi_table_pmt_ctx->psi_section_ctx_llist; n!= NULL; n= n->next) {
-		psi_section_ctx_t *psi_section_ctx_nth= NULL;
-
-		psi_section_ctx_nth= (psi_section_ctx_t*)n->data;
-		CHECK_DO(psi_section_ctx_nth!= NULL, continue);
-
-		/* Check if this PMS has the required program description
-		 * (Note that for the case of a PMS, 'table_id_extension' is assigned
-		 * to 'program_number').
-		 */
-		if(psi_section_ctx_nth->table_id_extension== program_number)
-			return psi_section_ctx_nth;
-	}
-	return NULL;
+	return psi_table_pmt_ctx_filter_program_num(psi_table_pmt_ctx,
+			program_number);
 }
 
 psi_pms_es_ctx_t* psi_table_pmt_ctx_filter_program_pid_es_pid(
@@ -275,6 +513,12 @@ psi_section_ctx_t* psi_table_pmt_ctx_filter_program_num(
 	/* Check arguments */
 	CHECK_DO(psi_table_pmt_ctx!= NULL, return NULL);
 
+	/* Use index if available */
+	if(psi_table_pmt_ctx->psi_table_idx!= NULL)
+		return (psi_section_ctx_t*)psi_table_idx_hash_get(
+				psi_table_pmt_ctx->psi_table_idx->hash_program_num,
+				psi_table_pmt_ctx->psi_table_idx->hash_size, program_number);
+
 	/* Iterate over PMT and get service specific data for this program */
 	for(n= psi_table_pmt_ctx->psi_section_ctx_llist; n!= NULL; n= n->next) {
 		psi_section_ctx_t *psi_section_ctx_nth= NULL;
@@ -292,6 +536,54 @@ psi_section_ctx_t* psi_table_pmt_ctx_filter_program_num(
 	return NULL;
 }
 
+psi_pms_es_ctx_t* psi_table_pmt_ctx_filter_es_pid(
+		const psi_table_pmt_ctx_t* psi_table_pmt_ctx, uint16_t es_pid,
+		psi_section_ctx_t **ref_psi_section_ctx_pms)
+{
+	llist_t *n;
+
+	/* Check arguments */
+	CHECK_DO(psi_table_pmt_ctx!= NULL, return NULL);
+	// Parameter 'ref_psi_section_ctx_pms' is allowed to be NULL
+
+	if(ref_psi_section_ctx_pms!= NULL)
+		*ref_psi_section_ctx_pms= NULL;
+
+	/* Use index if available */
+	if(psi_table_pmt_ctx->psi_table_idx!= NULL) {
+		const psi_table_idx_slot_t *psi_table_idx_slot=
+				psi_table_idx_hash_slot(
+						psi_table_pmt_ctx->psi_table_idx->hash_pid,
+						psi_table_pmt_ctx->psi_table_idx->hash_size, es_pid);
+		if(psi_table_idx_slot== NULL || psi_table_idx_slot->aux== NULL)
+			return NULL;
+		if(ref_psi_section_ctx_pms!= NULL)
+			*ref_psi_section_ctx_pms=
+					(psi_section_ctx_t*)psi_table_idx_slot->data;
+		return (psi_pms_es_ctx_t*)psi_table_idx_slot->aux;
+	}
+
+	/* Iterate over PMT and look for the elementary stream in each PMS */
+	for(n= psi_table_pmt_ctx->psi_section_ctx_llist; n!= NULL; n= n->next) {
+		psi_section_ctx_t *psi_section_ctx_nth= NULL;
+		psi_pms_es_ctx_t *psi_pms_es_ctx= NULL;
+
+		psi_section_ctx_nth= (psi_section_ctx_t*)n->data;
+		CHECK_DO(psi_section_ctx_nth!= NULL, continue);
+		if(psi_section_ctx_nth->data== NULL)
+			continue;
+
+		psi_pms_es_ctx= psi_pms_ctx_filter_es_pid(
+				(const psi_pms_ctx_t*)psi_section_ctx_nth->data, es_pid);
+		if(psi_pms_es_ctx!= NULL) {
+			if(ref_psi_section_ctx_pms!= NULL)
+				*ref_psi_section_ctx_pms= psi_section_ctx_nth;
+			return psi_pms_es_ctx;
+		}
+	}
+	return NULL;
+}
+
 psi_table_dvb_sdt_ctx_t* psi_table_dvb_sdt_ctx_allocate()
 {
 	return (psi_table_dvb_sdt_ctx_t*)psi_table_ctx_allocate();
@@ -319,6 +611,13 @@ psi_dvb_sds_prog_ctx_t* psi_table_dvb_sdt_ctx_filter_program_num(
 	/* Check arguments */
 	CHECK_DO(psi_table_dvb_sdt_ctx!= NULL, return NULL);
 
+	/* Use index if available */
+	if(psi_table_dvb_sdt_ctx->psi_table_idx!= NULL)
+		return (psi_dvb_sds_prog_ctx_t*)psi_table_idx_hash_get(
+				psi_table_dvb_sdt_ctx->psi_table_idx->hash_program_num,
+				psi_table_dvb_sdt_ctx->psi_table_idx->hash_size,
+				program_number);
+
 	/* Iterate over SDT and get service specific data for this program */
 	for(n= psi_table_dvb_sdt_ctx->psi_section_ctx_llist; n!= NULL; n= n->next) {
 		psi_section_ctx_t *psi_section_ctx_nth= NULL;
@@ -343,14 +642,36 @@ const char* psi_table_dvb_sdt_ctx_filter_service_name_by_program_num(
 		uint16_t program_number)
 {
 	psi_dvb_sds_prog_ctx_t *psi_dvb_sds_prog_ctx;
-	psi_desc_ctx_t *psi_desc_ctx;
-	psi_desc_dvb_service_ctx_t *psi_desc_dvb_service_ctx;
 
 	/* Check arguments */
 	CHECK_DO(psi_table_dvb_sdt_ctx!= NULL, return NULL);
 
+	/* Use index if available (service name resolved when indexing) */
+	if(psi_table_dvb_sdt_ctx->psi_table_idx!= NULL) {
+		const psi_table_idx_slot_t *psi_table_idx_slot=
+				psi_table_idx_hash_slot(
+						psi_table_dvb_sdt_ctx->psi_table_idx->hash_program_num,
+						psi_table_dvb_sdt_ctx->psi_table_idx->hash_size,
+						program_number);
+		return psi_table_idx_slot!= NULL?
+				(const char*)psi_table_idx_slot->aux: NULL;
+	}
+
 	psi_dvb_sds_prog_ctx= psi_table_dvb_sdt_ctx_filter_program_num(
 			psi_table_dvb_sdt_ctx, program_number);
+	return psi_table_dvb_sds_prog_service_name(psi_dvb_sds_prog_ctx);
+}
+
+/**
+ * Get the service name signaled in the DVB service descriptor of the given
+ * SDS service (NULL if not available).
+ */
+static const char* psi_table_dvb_sds_prog_service_name(
+		const psi_dvb_sds_prog_ctx_t *psi_dvb_sds_prog_ctx)
+{
+	psi_desc_ctx_t *psi_desc_ctx;
+	psi_desc_dvb_service_ctx_t *psi_desc_dvb_service_ctx;
+
 	if(psi_dvb_sds_prog_ctx== NULL ||
 			psi_dvb_sds_prog_ctx->psi_desc_ctx_llist== NULL)
 		return NULL;
@@ -367,3 +688,44 @@ const char* psi_table_dvb_sdt_ctx_filter_service_name_by_program_num(
 
 	return psi_desc_dvb_service_ctx->service_name;
 }
+
+static void psi_table_idx_hash_put(psi_table_idx_slot_t *hash,
+		size_t hash_size, uint16_t key, void *data, void *aux)
+{
+	size_t i;
+
+	/* Multiplicative hashing + linear probing (never full: see index) */
+	for(i= ((uint32_t)key* 2654435761U)& (hash_size- 1); hash[i].used!= 0;
+			i= (i+ 1)& (hash_size- 1)) {
+		if(hash[i].key== key)
+			return; // First occurrence prevails
+	}
+	hash[i].used= 1;
+	hash[i].key= key;
+	hash[i].data= data;
+	hash[i].aux= aux;
+}
+
+static void* psi_table_idx_hash_get(const psi_table_idx_slot_t *hash,
+		size_t hash_size, uint16_t key)
+{
+	const psi_table_idx_slot_t *psi_table_idx_slot= psi_table_idx_hash_slot(
+			hash, hash_size, key);
+	return psi_table_idx_slot!= NULL? psi_table_idx_slot->data: NULL;
+}
+
+static const psi_table_idx_slot_t* psi_table_idx_hash_slot(
+		const psi_table_idx_slot_t *hash, size_t hash_size, uint16_t key)
+{
+	size_t i;
+
+	if(hash_size== 0)
+		return NULL;
+
+	for(i= ((uint32_t)key* 2654435761U)& (hash_size- 1); hash[i].used!= 0;
+			i= (i+ 1)& (hash_size- 1)) {
+		if(hash[i].key== key)
+			return &hash[i];
+	}
+	return NULL;
+}
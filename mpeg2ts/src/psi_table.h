@@ -36,6 +36,7 @@ typedef struct llist_s llist_t;
 typedef struct psi_pas_prog_ctx_s psi_pas_prog_ctx_t;
 typedef struct psi_dvb_sds_prog_ctx_s psi_dvb_sds_prog_ctx_t;
 typedef struct psi_pms_es_ctx_s psi_pms_es_ctx_t;
+typedef struct psi_table_idx_s psi_table_idx_t;
 
 /**
  * Generic Program Specific Information (PSI) table context structure.
@@ -46,6 +47,19 @@ typedef struct psi_table_ctx_s {
 	 * @see 'psi_dvb.h'
 	 */
 	llist_t *psi_section_ctx_llist;
+	/**
+	 * Lookup index (opaque): sections array and program number/ PID hash
+	 * indexes; NULL if not built. Lookups fall back to the sections list
+	 * traversal if the index is not built.
+	 * @see psi_table_ctx_index()
+	 */
+	psi_table_idx_t *psi_table_idx;
+	/**
+	 * Number of extra references held on this table (zero if it has a
+	 * single owner); see 'psi_table_ctx_ref()'.
+	 * A table shared by means of references is immutable.
+	 */
+	volatile int refs;
 } psi_table_ctx_t;
 
 /**
@@ -76,6 +90,41 @@ psi_table_ctx_t* psi_table_ctx_allocate();
  */
 psi_table_ctx_t* psi_table_ctx_dup(const psi_table_ctx_t *psi_table_ctx);
 
+/**
+ * Get a new reference to the given table (no copy is performed).
+ * The table must be treated as immutable from then on; each reference is
+ * released using 'psi_table_ctx_release()' (the table is actually freed
+ * when its last reference is released).
+ * @param psi_table_ctx PSI table context structure.
+ * @return The same pointer given as argument.
+ */
+psi_table_ctx_t* psi_table_ctx_ref(psi_table_ctx_t *psi_table_ctx);
+
+/**
+ * Build (or re-build) the lookup index of the given table: sections are
+ * indexed by position (namely, by 'section_number' for a decoded table),
+ * programs are indexed by program number, and PIDs are indexed to their
+ * program (program map PIDs in the case of the PAT, elementary stream PIDs
+ * in the case of the PMT), so the 'psi_table_xxx_filter_yyy()' functions
+ * perform in constant time. SDT service names are resolved once when
+ * indexing.
+ * The index is a view of the sections list: it should be (re-)built after
+ * the table is completed or modified, and before it is shared.
+ * @param psi_table_ctx PSI table context structure.
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
+ */
+int psi_table_ctx_index(psi_table_ctx_t *psi_table_ctx);
+
+/**
+ * Get the n-th section of the table (constant time if the table is
+ * indexed; see 'psi_table_ctx_index()').
+ * @param psi_table_ctx PSI table context structure.
+ * @param nth Section position.
+ * @return The section, or NULL if it does not exist.
+ */
+psi_section_ctx_t* psi_table_ctx_get_section(
+		const psi_table_ctx_t *psi_table_ctx, int nth);
+
 /**
  * //TODO
  */
@@ -142,6 +191,21 @@ psi_pms_es_ctx_t* psi_table_pmt_ctx_filter_program_pid_es_pid(
 psi_section_ctx_t* psi_table_pmt_ctx_filter_program_num(
 		const psi_table_pmt_ctx_t* psi_table_pmt_ctx, uint16_t program_number);
 
+/**
+ * Look for the elementary stream with the given PID in the PMT, and the
+ * program (PMS) it belongs to (constant time if the table is indexed; see
+ * 'psi_table_ctx_index()').
+ * @param psi_table_pmt_ctx PMT context structure.
+ * @param es_pid Elementary stream PID.
+ * @param ref_psi_section_ctx_pms Reference to the PMS returned (set to NULL
+ * if not found); may be NULL.
+ * @return The elementary stream, or NULL if not found. If the PID is listed
+ * in more than one program, the first program in the table prevails.
+ */
+psi_pms_es_ctx_t* psi_table_pmt_ctx_filter_es_pid(
+		const psi_table_pmt_ctx_t* psi_table_pmt_ctx, uint16_t es_pid,
+		psi_section_ctx_t **ref_psi_section_ctx_pms);
+
 /**
  * //TODO
  */
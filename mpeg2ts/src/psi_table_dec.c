@@ -31,7 +31,6 @@
 #include <libmediaprocsutils/stat_codes.h>
 #include <libmediaprocsutils/check_utils.h>
 #include <libmediaprocsutils/llist.h>
-#include <libmediaprocsutils/fifo.h>
 #include "psi.h"
 #include "psi_dec.h"
 #include "psi_dvb.h"
@@ -43,100 +42,104 @@
 
 /* **** Prototypes **** */
 
-/**
- * Auxiliary in-line function: check if table is complete; namely, if all
- * sections that compose the table are already parsed.
- */
-static inline int is_table_complete(llist_t *psi_section_ctx_llist,
-		log_ctx_t *log_ctx);
+/* **** Implementations **** */
 
-static int psi_table_dec_get_table_sections(fifo_ctx_t *ififo_ctx,
-		log_ctx_t *log_ctx, uint8_t *ref_tscc, uint16_t pid,
-		llist_t **ref_psi_section_ctx_llist);
+void psi_table_dec_ctx_init(psi_table_dec_ctx_t *psi_table_dec_ctx)
+{
+	LOG_CTX_INIT(NULL);
 
-/* **** Implementations **** */
+	CHECK_DO(psi_table_dec_ctx!= NULL, return);
 
-int psi_table_dec_get_next_table(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_tscc, uint16_t pid, psi_table_ctx_t **ref_psi_table_ctx)
+	memset(psi_table_dec_ctx, 0, sizeof(psi_table_dec_ctx_t));
+}
+
+void psi_table_dec_ctx_deinit(psi_table_dec_ctx_t *psi_table_dec_ctx)
 {
+	int i;
+
+	if(psi_table_dec_ctx== NULL || psi_table_dec_ctx->received_count== 0)
+		return;
+
+	/* Release sections of the table being assembled */
+	for(i= 0; i<= psi_table_dec_ctx->last_section_number; i++)
+		psi_section_ctx_release(&psi_table_dec_ctx->psi_section_ctx_array[i]);
+	memset(psi_table_dec_ctx->received_bitmap, 0,
+			sizeof(psi_table_dec_ctx->received_bitmap));
+	psi_table_dec_ctx->received_count= 0;
+}
+
+int psi_table_dec_put_section(psi_table_dec_ctx_t *psi_table_dec_ctx,
+		log_ctx_t *log_ctx, psi_section_ctx_t **ref_psi_section_ctx,
+		psi_table_ctx_t **ref_psi_table_ctx)
+{
+	int i, ret_code, end_code= STAT_ERROR;
+	uint8_t section_number;
+	uint64_t section_bit;
+	psi_section_ctx_t *psi_section_ctx= NULL;
 	psi_table_ctx_t *psi_table_ctx= NULL;
-	int ret_code, end_code= STAT_ERROR;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments */
-	CHECK_DO(ififo_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(psi_table_dec_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_psi_section_ctx!= NULL && *ref_psi_section_ctx!= NULL,
+			return STAT_ERROR);
 	CHECK_DO(ref_psi_table_ctx!= NULL, return STAT_ERROR);
 
 	*ref_psi_table_ctx= NULL;
 
-	/* Allocate generic table context structure */
-	psi_table_ctx= psi_table_ctx_allocate();
-	CHECK_DO(psi_table_ctx!= NULL, goto end);
-
-	/* Get list of sections */
-	ret_code= psi_table_dec_get_table_sections(ififo_ctx, log_ctx, ref_tscc,
-			pid, &psi_table_ctx->psi_section_ctx_llist);
-	if(ret_code!= STAT_SUCCESS) {
-		if(ret_code== STAT_EOF)
-			end_code= ret_code;
+	/* Take the section */
+	psi_section_ctx= *ref_psi_section_ctx;
+	*ref_psi_section_ctx= NULL;
+	section_number= psi_section_ctx->section_number;
+
+	/* Check section number consistency */
+	if(section_number> psi_section_ctx->last_section_number) {
+		LOGEV("Check compliance: 'section_number' (%u) greater than "
+				"'last_section_number' (%u)\n", section_number,
+				psi_section_ctx->last_section_number);
+		end_code= STAT_EAGAIN; // Section discarded
 		goto end;
 	}
 
-	/* Trace table */
-	// TODO: trace specific information (add to "pci.h" ...)
-
-	*ref_psi_table_ctx= psi_table_ctx;
-	end_code= STAT_SUCCESS;
-end:
-	if(end_code!= STAT_SUCCESS)
-		psi_table_ctx_release(&psi_table_ctx);
-
-	return end_code;
-}
-
-static int psi_table_dec_get_table_sections(fifo_ctx_t *ififo_ctx,
-		log_ctx_t *log_ctx, uint8_t *ref_tscc, uint16_t pid,
-		llist_t **ref_psi_section_ctx_llist)
-{
-	uint8_t  curr_table_id, curr_version_number;
-	uint16_t curr_table_id_extension;
-	int ret_code, end_code= STAT_ERROR;
-	psi_section_ctx_t* psi_section_ctx_curr= NULL;
-	LOG_CTX_INIT(log_ctx);
+	/* Check section belongs to the table being assembled; otherwise, the
+	 * table could not be completed and a new one is started with this
+	 * section.
+	 */
+	if(psi_table_dec_ctx->received_count> 0 &&
+			(psi_table_dec_ctx->table_id!= psi_section_ctx->table_id ||
+			psi_table_dec_ctx->table_id_extension!=
+					psi_section_ctx->table_id_extension ||
+			psi_table_dec_ctx->version_number!=
+					psi_section_ctx->version_number ||
+			psi_table_dec_ctx->last_section_number!=
+					psi_section_ctx->last_section_number)) {
+		LOGW("The table could not be completed; parsing new version\n");
+		psi_table_dec_ctx_deinit(psi_table_dec_ctx);
+	}
 
-	/* Check arguments */
-	CHECK_DO(ififo_ctx!= NULL, return STAT_ERROR);
-	CHECK_DO(ref_psi_section_ctx_llist!= NULL, return STAT_ERROR);
-
-	/* Get next PSI section */
-	while(psi_section_ctx_curr== NULL) {
-		int ret_code= psi_dec_get_next_section(ififo_ctx, log_ctx,
-				ref_tscc, pid, &psi_section_ctx_curr);
-		if(ret_code== STAT_EOF) {
-			end_code= ret_code;
-			goto end; // We are requested to exit.
-		}
+	/* Set current parameters if a new table is started */
+	if(psi_table_dec_ctx->received_count== 0) {
+		psi_table_dec_ctx->table_id= psi_section_ctx->table_id;
+		psi_table_dec_ctx->table_id_extension=
+				psi_section_ctx->table_id_extension;
+		psi_table_dec_ctx->version_number= psi_section_ctx->version_number;
+		psi_table_dec_ctx->last_section_number=
+				psi_section_ctx->last_section_number;
 	}
 
-	/* Set current parameters */
-	curr_table_id= psi_section_ctx_curr->table_id;
-	curr_table_id_extension= psi_section_ctx_curr->table_id_extension;
-	curr_version_number= psi_section_ctx_curr->version_number;
-
-	/* We insert the new section in the list's position 'section_number'. In
-	 * the case we complete the list, we will have the sections ordered by the
-	 * 'section_number' field as follows:
-	 * ['0', ..., 'last_section_number'].
-	 * Note that function 'llist_insert_nth()' will append the new element at
-	 * the end of list in case the given index exceeds current list size.
+	/* Skip section if already received (sections are periodically
+	 * repeated, thus a section may be received again before the table is
+	 * completed).
 	 */
-	ret_code= llist_insert_nth(ref_psi_section_ctx_llist,
-			psi_section_ctx_curr->section_number, (void*)psi_section_ctx_curr);
-	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
-	psi_section_ctx_curr= NULL; // avoid double referencing / freeing.
+	section_bit= (uint64_t)1<< (section_number& 63);
+	if((psi_table_dec_ctx->received_bitmap[section_number>> 6]&
+			section_bit)!= 0) {
+		end_code= STAT_EAGAIN;
+		goto end;
+	}
 
-	/* Get rest of the sections that compose the table:
-	 * - The table may be partitioned into up to 255 sections before it is
+	/* Place the new section in its 'section_number' slot.
+	 * - The table may be partitioned into up to 256 sections before it is
 	 * mapped into TS packets. Each section carries a part of the overall table
 	 * (e.g. refer to Rec. ITU-T H.222.0 (10/2014), Annex C.9.1.)
 	 * - The section_number field allows the sections of a particular table to
@@ -144,62 +147,143 @@ static int psi_table_dec_get_table_sections(fifo_ctx_t *ififo_ctx,
 	 * obligation that sections must be transmitted in numerical order
 	 * (see Rec. ITU-T H.222.0 (10/2014), Annex C.3.)
 	 */
-	while(is_table_complete(*ref_psi_section_ctx_llist, LOG_CTX_GET())!=
-			STAT_SUCCESS) {
-
-		/* Get next PSI section */
-		while(psi_section_ctx_curr== NULL) {
-			int ret_code= psi_dec_get_next_section(ififo_ctx, LOG_CTX_GET(),
-					ref_tscc, pid, &psi_section_ctx_curr);
-			if(ret_code== STAT_EOF) {
-				end_code= ret_code;
-				goto end; // We are requested to exit.
-			}
-		}
+	psi_table_dec_ctx->psi_section_ctx_array[section_number]= psi_section_ctx;
+	psi_section_ctx= NULL; // avoid double referencing / freeing.
+	psi_table_dec_ctx->received_bitmap[section_number>> 6]|= section_bit;
+	psi_table_dec_ctx->received_count++;
 
-		/* Check section belongs to the table being parsed */
-		if(curr_table_id!= psi_section_ctx_curr->table_id ||
-		   curr_table_id_extension!= psi_section_ctx_curr->table_id_extension ||
-		   curr_version_number!= psi_section_ctx_curr->version_number) {
-			LOGW("The table could not be completed; parsing new version\n");
-			goto end;
-		}
+	/* Check if the rest of the sections that compose the table are already
+	 * received.
+	 */
+	if(psi_table_dec_ctx->received_count<
+			(int)psi_table_dec_ctx->last_section_number+ 1) {
+		end_code= STAT_EAGAIN;
+		goto end;
+	}
 
-		/* Store new section in table context structure */
-		ret_code= llist_insert_nth(ref_psi_section_ctx_llist,
-				psi_section_ctx_curr->section_number,
-				(void*)psi_section_ctx_curr);
+	/* Table completed: allocate generic table context structure and move
+	 * the sections to it (ordered by 'section_number':
+	 * ['0', ..., 'last_section_number']).
+	 */
+	psi_table_ctx= psi_table_ctx_allocate();
+	CHECK_DO(psi_table_ctx!= NULL, goto end);
+	for(i= psi_table_dec_ctx->last_section_number; i>= 0; i--) {
+		ret_code= llist_insert_nth(&psi_table_ctx->psi_section_ctx_llist, 0,
+				(void*)psi_table_dec_ctx->psi_section_ctx_array[i]);
 		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
-		psi_section_ctx_curr= NULL; // avoid double referencing / freeing
+		psi_table_dec_ctx->psi_section_ctx_array[i]= NULL;
 	}
+	psi_table_dec_ctx_deinit(psi_table_dec_ctx);
 
+	/* Index sections and programs for the table lookups */
+	ret_code= psi_table_ctx_index(psi_table_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Trace table */
+	// TODO: trace specific information (add to "pci.h" ...)
+
+	*ref_psi_table_ctx= psi_table_ctx;
+	psi_table_ctx= NULL; // Avoid double referencing
 	end_code= STAT_SUCCESS;
 end:
-	/* Release temporal section context structure */
-	psi_section_ctx_release(&psi_section_ctx_curr);
+	if(psi_section_ctx!= NULL)
+		psi_section_ctx_release(&psi_section_ctx);
+	if(psi_table_ctx!= NULL)
+		psi_table_ctx_release(&psi_table_ctx);
 	return end_code;
 }
 
-static inline int is_table_complete(llist_t *psi_section_ctx_llist,
-		log_ctx_t *log_ctx)
+void psi_table_dec_map_init(psi_table_dec_map_t *psi_table_dec_map)
+{
+	LOG_CTX_INIT(NULL);
+
+	CHECK_DO(psi_table_dec_map!= NULL, return);
+
+	memset(psi_table_dec_map, 0, sizeof(psi_table_dec_map_t));
+}
+
+void psi_table_dec_map_deinit(psi_table_dec_map_t *psi_table_dec_map)
+{
+	int i;
+
+	if(psi_table_dec_map== NULL)
+		return;
+
+	for(i= 0; i< PSI_TABLE_DEC_MAP_SIZE; i++)
+		psi_table_dec_ctx_deinit(
+				&psi_table_dec_map->psi_table_dec_ctx_array[i]);
+	memset(psi_table_dec_map->update_seq_array, 0,
+			sizeof(psi_table_dec_map->update_seq_array));
+	psi_table_dec_map->update_seq= 0;
+}
+
+int psi_table_dec_map_put_section(psi_table_dec_map_t *psi_table_dec_map,
+		log_ctx_t *log_ctx, psi_section_ctx_t **ref_psi_section_ctx,
+		psi_table_ctx_t **ref_psi_table_ctx)
 {
-	psi_section_ctx_t *psi_section_ctx_0;
+	int i, ret_code, entry= -1, entry_lru= 0;
+	uint8_t table_id;
+	uint16_t table_id_extension;
+	psi_table_dec_ctx_t *psi_table_dec_ctx;
+	const psi_section_ctx_t *psi_section_ctx; // Do not release (alias)
 	LOG_CTX_INIT(log_ctx);
 
-	if(psi_section_ctx_llist== NULL)
-		return STAT_ERROR; // empty list
+	/* Check arguments */
+	CHECK_DO(psi_table_dec_map!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_psi_section_ctx!= NULL && *ref_psi_section_ctx!= NULL,
+			return STAT_ERROR);
+	CHECK_DO(ref_psi_table_ctx!= NULL, return STAT_ERROR);
 
-	/* Get the first section (at least one section should exist). */
-	psi_section_ctx_0=
-			(psi_section_ctx_t*)llist_get_nth(psi_section_ctx_llist, 0);
-	CHECK_DO(psi_section_ctx_0!= NULL, return STAT_ERROR);
+	psi_section_ctx= *ref_psi_section_ctx;
+	table_id= psi_section_ctx->table_id;
+	table_id_extension= psi_section_ctx->table_id_extension;
 
-	/* Check that the sections list size is equal to 'last_section_number'
-	 * field plus one (that means all sections were obtained).
+	/* Look for the table the section belongs to; otherwise take a free
+	 * entry or, if none, the least recently updated one.
 	 */
-	if(llist_len(psi_section_ctx_llist)!=
-			(int)psi_section_ctx_0->last_section_number+ 1)
-		return STAT_ERROR;
-
+	for(i= 0; i< PSI_TABLE_DEC_MAP_SIZE; i++) {
+		psi_table_dec_ctx= &psi_table_dec_map->psi_table_dec_ctx_array[i];
+		if(psi_table_dec_ctx->received_count== 0) {
+			if(entry< 0)
+				entry= i;
+			continue;
+		}
+		if(psi_table_dec_ctx->table_id== table_id &&
+				psi_table_dec_ctx->table_id_extension== table_id_extension &&
+				psi_table_dec_ctx->version_number==
+						psi_section_ctx->version_number) {
+			entry= i;
+			break;
+		}
+		if(psi_table_dec_map->update_seq_array[i]<
+				psi_table_dec_map->update_seq_array[entry_lru])
+			entry_lru= i;
+	}
+	if(entry< 0) {
+		psi_table_dec_ctx=
+				&psi_table_dec_map->psi_table_dec_ctx_array[entry_lru];
+		LOGW("Too many tables being assembled; table 0x%0x (extension "
+				"%u) could not be completed\n", psi_table_dec_ctx->table_id,
+				psi_table_dec_ctx->table_id_extension);
+		psi_table_dec_ctx_deinit(psi_table_dec_ctx);
+		entry= entry_lru;
+	}
+	psi_table_dec_map->update_seq_array[entry]=
+			++psi_table_dec_map->update_seq;
+
+	ret_code= psi_table_dec_put_section(
+			&psi_table_dec_map->psi_table_dec_ctx_array[entry], LOG_CTX_GET(),
+			ref_psi_section_ctx, ref_psi_table_ctx);
+	if(ret_code!= STAT_SUCCESS)
+		return ret_code;
+
+	/* Table completed: other versions being assembled are outdated */
+	for(i= 0; i< PSI_TABLE_DEC_MAP_SIZE; i++) {
+		psi_table_dec_ctx= &psi_table_dec_map->psi_table_dec_ctx_array[i];
+		if(psi_table_dec_ctx->received_count> 0 &&
+				psi_table_dec_ctx->table_id== table_id &&
+				psi_table_dec_ctx->table_id_extension== table_id_extension)
+			psi_table_dec_ctx_deinit(psi_table_dec_ctx);
+	}
 	return STAT_SUCCESS;
 }
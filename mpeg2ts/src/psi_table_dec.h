@@ -31,17 +31,142 @@
 
 /* **** Definitions **** */
 
-typedef struct fifo_ctx_s fifo_ctx_t;
 typedef struct log_ctx_s log_ctx_t;
 typedef struct psi_table_ctx_s psi_table_ctx_t;
+typedef struct psi_section_ctx_s psi_section_ctx_t;
+
+/**
+ * Maximum number of sections of a table ('section_number' is 8 bits wide).
+ */
+#define PSI_TABLE_DEC_MAX_SECTIONS 256
+
+/**
+ * Table assembly context structure.
+ * Keeps the sections of the table being assembled between calls to
+ * 'psi_table_dec_put_section()' (e.g. while the sections are received
+ * interleaved with the packets of other PIDs).
+ * Sections are directly placed in the slot given by their 'section_number'
+ * (sections may be received in any order), and a bitmap of the received
+ * sections is kept, so repeated sections are skipped and table completion
+ * is checked in constant time.
+ * Should be initialized using 'psi_table_dec_ctx_init()' and released using
+ * 'psi_table_dec_ctx_deinit()'.
+ */
+typedef struct psi_table_dec_ctx_s {
+	/**
+	 * Sections of the table being assembled, indexed by 'section_number'
+	 * (NULL if the section was not received yet).
+	 */
+	psi_section_ctx_t *psi_section_ctx_array[PSI_TABLE_DEC_MAX_SECTIONS];
+	/**
+	 * Received sections bitmap: bit 'n% 64' of word 'n/ 64' is set if the
+	 * section number 'n' was received.
+	 */
+	uint64_t received_bitmap[PSI_TABLE_DEC_MAX_SECTIONS/ 64];
+	/**
+	 * Number of sections received (zero if no table is being assembled).
+	 */
+	int received_count;
+	/**
+	 * Identification of the table being assembled.
+	 */
+	uint8_t table_id;
+	uint16_t table_id_extension;
+	uint8_t version_number;
+	uint8_t last_section_number;
+} psi_table_dec_ctx_t;
+
+/**
+ * Maximum number of tables assembled concurrently in a table assembly map.
+ */
+#define PSI_TABLE_DEC_MAP_SIZE 4
+
+/**
+ * Table assembly map structure.
+ * Keeps a table assembly context per table being assembled, keyed by
+ * 'table_id', 'table_id_extension' and 'version_number', so the sections of
+ * different tables carried in the same PID (e.g. the sub-tables of several
+ * extensions, or a new version while the previous one is still repeated)
+ * may be interleaved without resetting each other. When the map is full,
+ * the least recently updated table is discarded.
+ * Should be initialized using 'psi_table_dec_map_init()' and released using
+ * 'psi_table_dec_map_deinit()'.
+ */
+typedef struct psi_table_dec_map_s {
+	psi_table_dec_ctx_t psi_table_dec_ctx_array[PSI_TABLE_DEC_MAP_SIZE];
+	/**
+	 * Sequence number of the last update of each entry (replacement
+	 * policy).
+	 */
+	uint64_t update_seq_array[PSI_TABLE_DEC_MAP_SIZE];
+	uint64_t update_seq;
+} psi_table_dec_map_t;
 
 /* **** Prototypes **** */
 
 /**
- * Get next Program Specific Information (PSI) table.
- * //TODO
+ * Initialize table assembly context structure.
+ * @param psi_table_dec_ctx Pointer to the table assembly context structure.
+ */
+void psi_table_dec_ctx_init(psi_table_dec_ctx_t *psi_table_dec_ctx);
+
+/**
+ * Release the sections kept in the table assembly context structure (the
+ * structure is left initialized).
+ * @param psi_table_dec_ctx Pointer to the table assembly context structure.
+ */
+void psi_table_dec_ctx_deinit(psi_table_dec_ctx_t *psi_table_dec_ctx);
+
+/**
+ * Put a decoded section into the table being assembled.
+ * If the section does not belong to the table being assembled (different
+ * table identifier, extension, version or last section number), the
+ * incomplete table is discarded and a new one is started. Sections already
+ * received are skipped.
+ * @param psi_table_dec_ctx Table assembly context structure.
+ * @param log_ctx LOG module context structure.
+ * @param ref_psi_section_ctx Reference to the pointer to the section; the
+ * section is handed over (the pointer is set to NULL).
+ * @param ref_psi_table_ctx Reference to the pointer to the table returned
+ * when completed (indexed; see 'psi_table_ctx_index()').
+ * @return STAT_SUCCESS if the table is completed, STAT_EAGAIN if more
+ * sections are needed, or other status code in case of error (refer to
+ * 'stat_codes_ctx_t' type).
+ */
+int psi_table_dec_put_section(psi_table_dec_ctx_t *psi_table_dec_ctx,
+		log_ctx_t *log_ctx, psi_section_ctx_t **ref_psi_section_ctx,
+		psi_table_ctx_t **ref_psi_table_ctx);
+
+/**
+ * Initialize table assembly map structure.
+ * @param psi_table_dec_map Pointer to the table assembly map structure.
+ */
+void psi_table_dec_map_init(psi_table_dec_map_t *psi_table_dec_map);
+
+/**
+ * Release the sections kept in the table assembly map structure (the
+ * structure is left initialized).
+ * @param psi_table_dec_map Pointer to the table assembly map structure.
+ */
+void psi_table_dec_map_deinit(psi_table_dec_map_t *psi_table_dec_map);
+
+/**
+ * Put a decoded section into the table it belongs to (see
+ * 'psi_table_dec_map_t' and 'psi_table_dec_put_section()').
+ * When a table is completed, the incomplete tables with the same
+ * 'table_id' and 'table_id_extension' (other versions) are discarded.
+ * @param psi_table_dec_map Table assembly map structure.
+ * @param log_ctx LOG module context structure.
+ * @param ref_psi_section_ctx Reference to the pointer to the section; the
+ * section is handed over (the pointer is set to NULL).
+ * @param ref_psi_table_ctx Reference to the pointer to the table returned
+ * when completed (indexed; see 'psi_table_ctx_index()').
+ * @return STAT_SUCCESS if a table is completed, STAT_EAGAIN if more
+ * sections are needed, or other status code in case of error (refer to
+ * 'stat_codes_ctx_t' type).
  */
-int psi_table_dec_get_next_table(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_tscc, uint16_t pid, psi_table_ctx_t **ref_psi_table_ctx);
+int psi_table_dec_map_put_section(psi_table_dec_map_t *psi_table_dec_map,
+		log_ctx_t *log_ctx, psi_section_ctx_t **ref_psi_section_ctx,
+		psi_table_ctx_t **ref_psi_table_ctx);
 
 #endif /* SPMPEG2TS_PSI_TABLE_DEC_H_ */
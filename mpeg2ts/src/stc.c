@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file stc.c
+ * @author Rafael Antoniello
+ */
+
+#include "stc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+
+/* **** Definitions **** */
+
+/**
+ * Nominal STC slope: 27MHz ticks per microsecond.
+ */
+#define STC_NOMINAL_SLOPE ((double)STC_CLOCK_FREQ/ 1000000.0)
+
+/**
+ * Size of the sliding window of PCR samples used for the linear fit.
+ */
+#define STC_FIT_WINDOW 128
+
+/**
+ * Minimum number of accepted samples to consider the estimator locked.
+ */
+#define STC_MIN_SAMPLES 4
+
+/**
+ * Maximum drift considered for the fitted slope [ppm]; ISO/IEC 13818-1
+ * specifies a tolerance of 30 ppm for the system clock, we allow for a wider
+ * margin as the arrival times are jittered by the network.
+ */
+#define STC_MAX_DRIFT_PPM 1000.0
+
+/**
+ * Outlier rejection: a sample is rejected if its residual (difference to
+ * the model prediction) is above 'STC_OUTLIER_RMS_FACTOR' times the RMS of
+ * the residuals, and also above 'STC_OUTLIER_MIN_TICKS' (1 msec).
+ */
+#define STC_OUTLIER_RMS_FACTOR 4.0
+#define STC_OUTLIER_MIN_TICKS ((double)STC_CLOCK_FREQ/ 1000.0)
+
+/**
+ * Number of consecutive outliers after which we assume the clock has
+ * changed (non-signaled discontinuity) and restart estimation.
+ */
+#define STC_OUTLIER_MAX_CONSECUTIVE 8
+
+/**
+ * Residual above which a sample is considered to be a non-signaled
+ * discontinuity (100 msec), so that estimation restarts immediately.
+ */
+#define STC_DISCONTINUITY_TICKS ((double)STC_CLOCK_FREQ/ 10.0)
+
+/**
+ * STC model; published to readers using a sequence lock.
+ */
+typedef struct stc_model_s {
+	/**
+	 * Local time anchor [microseconds].
+	 */
+	int64_t anchor_usec;
+	/**
+	 * Unwrapped STC value at the local time anchor [27MHz units].
+	 */
+	int64_t anchor_stc;
+	/**
+	 * Model slope [27MHz ticks per microsecond].
+	 */
+	double slope;
+	/**
+	 * Statistics (published together with the model).
+	 */
+	stc_stats_ctx_t stc_stats_ctx;
+} stc_model_t;
+
+/**
+ * STC estimator context structure.
+ */
+typedef struct stc_ctx_s {
+	/**
+	 * Externally defined LOG module context structure instance.
+	 */
+	log_ctx_t *log_ctx;
+	/**
+	 * Sequence lock counter (odd while the writer is updating the model).
+	 */
+	volatile uint32_t seq;
+	/**
+	 * Published model (read by any thread; see 'seq').
+	 */
+	volatile stc_model_t model;
+
+	/* **** Writer private state **** */
+	/**
+	 * Current model (private copy of the writer).
+	 */
+	stc_model_t model_wr;
+	/**
+	 * Reference point of the current estimation period (used to compute
+	 * the fit in relative, double precision, coordinates).
+	 */
+	int64_t ref_usec;
+	int64_t ref_pcr;
+	/**
+	 * Sliding window of accepted samples (relative coordinates).
+	 */
+	double x_usec[STC_FIT_WINDOW];
+	double y_ticks[STC_FIT_WINDOW];
+	int samples_num;
+	int samples_idx;
+	/**
+	 * Last accepted unwrapped PCR value; TS_TIMESTAMP_INVALID-like (-1) if
+	 * undefined.
+	 */
+	int64_t pcr_ext_last;
+	/**
+	 * Mean square of the residuals [27MHz ticks^2].
+	 */
+	double residual_ms;
+	/**
+	 * Number of consecutive outliers.
+	 */
+	int outliers_consecutive;
+} stc_ctx_t;
+
+/* **** Prototypes **** */
+
+static void stc_restart(stc_ctx_t *stc_ctx);
+static void stc_fit(stc_ctx_t *stc_ctx, int64_t arrival_usec);
+static void stc_model_publish(stc_ctx_t *stc_ctx);
+static void stc_model_read(stc_ctx_t *stc_ctx, stc_model_t *stc_model);
+
+/* **** Implementations **** */
+
+stc_ctx_t* stc_open(log_ctx_t *log_ctx)
+{
+	stc_ctx_t *stc_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Allocate context structure */
+	stc_ctx= (stc_ctx_t*)calloc(1, sizeof(stc_ctx_t));
+	CHECK_DO(stc_ctx!= NULL, return NULL);
+
+	stc_ctx->log_ctx= log_ctx;
+	stc_reset(stc_ctx);
+
+	return stc_ctx;
+}
+
+void stc_close(stc_ctx_t **ref_stc_ctx)
+{
+	stc_ctx_t *stc_ctx;
+
+	if(ref_stc_ctx== NULL || (stc_ctx= *ref_stc_ctx)== NULL)
+		return;
+
+	free(stc_ctx);
+	*ref_stc_ctx= NULL;
+}
+
+void stc_reset(stc_ctx_t *stc_ctx)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(stc_ctx!= NULL, return);
+
+	memset(&stc_ctx->model_wr.stc_stats_ctx, 0, sizeof(stc_stats_ctx_t));
+	stc_restart(stc_ctx);
+	stc_model_publish(stc_ctx);
+}
+
+int stc_put_pcr(stc_ctx_t *stc_ctx, int64_t pcr, int64_t arrival_usec,
+		int flag_discontinuity)
+{
+	int64_t pcr_ext;
+	stc_stats_ctx_t *stc_stats_ctx;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(stc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(pcr>= 0 && pcr< STC_PCR_WRAP, return STAT_ERROR);
+
+	LOG_CTX_SET(stc_ctx->log_ctx);
+
+	stc_stats_ctx= &stc_ctx->model_wr.stc_stats_ctx;
+
+	/* Signaled discontinuity: restart estimation */
+	if(flag_discontinuity && stc_ctx->samples_num> 0) {
+		stc_stats_ctx->discontinuities_count++;
+		stc_restart(stc_ctx);
+	}
+
+	/* Unwrap PCR (33-bit base wrap-around) */
+	if(stc_ctx->pcr_ext_last< 0) {
+		pcr_ext= pcr;
+	} else {
+		int64_t diff= (pcr- (stc_ctx->pcr_ext_last% STC_PCR_WRAP))%
+				STC_PCR_WRAP;
+		if(diff< 0)
+			diff+= STC_PCR_WRAP;
+		if(diff>= STC_PCR_WRAP/ 2)
+			diff-= STC_PCR_WRAP;
+		pcr_ext= stc_ctx->pcr_ext_last+ diff;
+	}
+
+	/* Outliers rejection */
+	if(stc_ctx->samples_num>= STC_MIN_SAMPLES) {
+		double residual, threshold;
+		stc_model_t *stc_model= &stc_ctx->model_wr;
+
+		residual= (double)(pcr_ext- stc_model->anchor_stc)- stc_model->slope*
+				(double)(arrival_usec- stc_model->anchor_usec);
+		threshold= STC_OUTLIER_RMS_FACTOR* sqrt(stc_ctx->residual_ms);
+		if(threshold< STC_OUTLIER_MIN_TICKS)
+			threshold= STC_OUTLIER_MIN_TICKS;
+
+		if(fabs(residual)> STC_DISCONTINUITY_TICKS ||
+				(fabs(residual)> threshold && ++stc_ctx->outliers_consecutive>=
+						STC_OUTLIER_MAX_CONSECUTIVE)) {
+			/* Non-signaled discontinuity; restart with this sample */
+			LOGW("STC discontinuity detected (residual: %.0f usecs)\n",
+					residual/ STC_NOMINAL_SLOPE);
+			stc_stats_ctx->discontinuities_count++;
+			stc_restart(stc_ctx);
+			pcr_ext= pcr;
+		} else if(fabs(residual)> threshold) {
+			stc_stats_ctx->outliers_count++;
+			stc_model_publish(stc_ctx);
+			return STAT_EAGAIN;
+		} else {
+			stc_ctx->outliers_consecutive= 0;
+			stc_ctx->residual_ms+= (residual* residual-
+					stc_ctx->residual_ms)/ 16.0;
+		}
+	}
+
+	/* Set reference point if this is the first sample of the period */
+	if(stc_ctx->samples_num== 0) {
+		stc_ctx->ref_usec= arrival_usec;
+		stc_ctx->ref_pcr= pcr_ext;
+	}
+
+	/* Add sample to the sliding window */
+	stc_ctx->x_usec[stc_ctx->samples_idx]= (double)(arrival_usec-
+			stc_ctx->ref_usec);
+	stc_ctx->y_ticks[stc_ctx->samples_idx]= (double)(pcr_ext-
+			stc_ctx->ref_pcr);
+	stc_ctx->samples_idx= (stc_ctx->samples_idx+ 1)% STC_FIT_WINDOW;
+	if(stc_ctx->samples_num< STC_FIT_WINDOW)
+		stc_ctx->samples_num++;
+	stc_ctx->pcr_ext_last= pcr_ext;
+	stc_stats_ctx->samples_count++;
+
+	/* Fit model and publish */
+	stc_fit(stc_ctx, arrival_usec);
+	stc_model_publish(stc_ctx);
+	return STAT_SUCCESS;
+}
+
+int stc_get(stc_ctx_t *stc_ctx, int64_t now_usec, int64_t *ref_stc)
+{
+	int64_t stc;
+	stc_model_t stc_model;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(stc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_stc!= NULL, return STAT_ERROR);
+
+	stc_model_read(stc_ctx, &stc_model);
+	if(!stc_model.stc_stats_ctx.flag_locked)
+		return STAT_ENODATA;
+
+	if(now_usec== STC_NOW)
+		now_usec= stc_monotonic_usec();
+
+	stc= stc_model.anchor_stc+ (int64_t)(stc_model.slope*
+			(double)(now_usec- stc_model.anchor_usec));
+	stc%= STC_PCR_WRAP;
+	if(stc< 0)
+		stc+= STC_PCR_WRAP;
+	*ref_stc= stc;
+	return STAT_SUCCESS;
+}
+
+int stc_get_stats(stc_ctx_t *stc_ctx, stc_stats_ctx_t *stc_stats_ctx)
+{
+	stc_model_t stc_model;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(stc_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(stc_stats_ctx!= NULL, return STAT_ERROR);
+
+	stc_model_read(stc_ctx, &stc_model);
+	memcpy(stc_stats_ctx, &stc_model.stc_stats_ctx, sizeof(stc_stats_ctx_t));
+	return STAT_SUCCESS;
+}
+
+int64_t stc_monotonic_usec()
+{
+	struct timespec monotime;
+
+	clock_gettime(CLOCK_MONOTONIC, &monotime);
+	return (int64_t)monotime.tv_sec* 1000000+
+			(int64_t)monotime.tv_nsec/ 1000;
+}
+
+/**
+ * Restart estimation period (statistics counters are preserved).
+ */
+static void stc_restart(stc_ctx_t *stc_ctx)
+{
+	stc_model_t *stc_model= &stc_ctx->model_wr;
+
+	stc_model->anchor_usec= 0;
+	stc_model->anchor_stc= 0;
+	stc_model->slope= STC_NOMINAL_SLOPE;
+	stc_model->stc_stats_ctx.flag_locked= 0;
+	stc_model->stc_stats_ctx.drift_ppm= 0;
+	stc_model->stc_stats_ctx.jitter_rms_usec= 0;
+
+	stc_ctx->ref_usec= 0;
+	stc_ctx->ref_pcr= 0;
+	stc_ctx->samples_num= 0;
+	stc_ctx->samples_idx= 0;
+	stc_ctx->pcr_ext_last= -1;
+	stc_ctx->residual_ms= 0;
+	stc_ctx->outliers_consecutive= 0;
+}
+
+/**
+ * Least squares linear fit over the sliding window of samples.
+ * The model is anchored at the last sample arrival time.
+ */
+static void stc_fit(stc_ctx_t *stc_ctx, int64_t arrival_usec)
+{
+	int i;
+	double mean_x= 0, mean_y= 0, sxx= 0, sxy= 0, slope, x_last;
+	const int n= stc_ctx->samples_num;
+	const double slope_max= STC_NOMINAL_SLOPE* (1.0+ STC_MAX_DRIFT_PPM/ 1e6);
+	const double slope_min= STC_NOMINAL_SLOPE* (1.0- STC_MAX_DRIFT_PPM/ 1e6);
+	stc_model_t *stc_model= &stc_ctx->model_wr;
+
+	for(i= 0; i< n; i++) {
+		mean_x+= stc_ctx->x_usec[i];
+		mean_y+= stc_ctx->y_ticks[i];
+	}
+	mean_x/= n;
+	mean_y/= n;
+	for(i= 0; i< n; i++) {
+		double dx= stc_ctx->x_usec[i]- mean_x;
+		sxx+= dx* dx;
+		sxy+= dx* (stc_ctx->y_ticks[i]- mean_y);
+	}
+
+	slope= (n> 1 && sxx> 0)? sxy/ sxx: STC_NOMINAL_SLOPE;
+	if(slope> slope_max)
+		slope= slope_max;
+	else if(slope< slope_min)
+		slope= slope_min;
+
+	x_last= (double)(arrival_usec- stc_ctx->ref_usec);
+	stc_model->slope= slope;
+	stc_model->anchor_usec= arrival_usec;
+	stc_model->anchor_stc= stc_ctx->ref_pcr+ (int64_t)(mean_y+ slope*
+			(x_last- mean_x));
+	stc_model->stc_stats_ctx.flag_locked= (n>= STC_MIN_SAMPLES);
+	stc_model->stc_stats_ctx.drift_ppm= (slope/ STC_NOMINAL_SLOPE- 1.0)* 1e6;
+	stc_model->stc_stats_ctx.jitter_rms_usec= sqrt(stc_ctx->residual_ms)/
+			STC_NOMINAL_SLOPE;
+}
+
+/**
+ * Publish writer's model to readers (sequence lock, writer side).
+ */
+static void stc_model_publish(stc_ctx_t *stc_ctx)
+{
+	uint32_t seq= stc_ctx->seq;
+
+	__atomic_store_n(&stc_ctx->seq, seq+ 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy((void*)&stc_ctx->model, &stc_ctx->model_wr, sizeof(stc_model_t));
+	__atomic_store_n(&stc_ctx->seq, seq+ 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * Read published model (sequence lock, reader side).
+ */
+static void stc_model_read(stc_ctx_t *stc_ctx, stc_model_t *stc_model)
+{
+	uint32_t seq1, seq2;
+
+	do {
+		seq1= __atomic_load_n(&stc_ctx->seq, __ATOMIC_ACQUIRE);
+		memcpy(stc_model, (const void*)&stc_ctx->model, sizeof(stc_model_t));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq2= __atomic_load_n(&stc_ctx->seq, __ATOMIC_RELAXED);
+	} while((seq1& 1)!= 0 || seq1!= seq2);
+}
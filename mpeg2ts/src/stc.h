@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file stc.h
+ * @brief System Time Clock (STC) estimator.
+ * The STC of a program is recovered from the Program Clock Reference (PCR)
+ * samples received, each associated with its local arrival time. A linear
+ * model 'STC(t)= PCR_0+ slope* (t- t_0)' is fitted (least squares over a
+ * sliding window of samples) compensating the drift between the encoder
+ * clock and the local clock; outliers (e.g. network jitter peaks) are
+ * rejected, and PCR 33-bit base wraps and discontinuities are handled.
+ * <br>
+ * Threading model: a single writer thread feeds PCR samples
+ * ('stc_put_pcr()'), while any number of threads may query the STC
+ * ('stc_get()') in constant time and without locking (the model is
+ * published using a sequence lock).
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_STC_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_STC_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+typedef struct stc_ctx_s stc_ctx_t;
+
+/**
+ * System clock frequency [Hz] (PCR and STC units).
+ */
+#define STC_CLOCK_FREQ 27000000
+
+/**
+ * PCR wrap-around value in 27MHz units (33-bit base times 300).
+ */
+#define STC_PCR_WRAP (((int64_t)1<< 33)* 300)
+
+/**
+ * Use this value as the 'now_usec' argument of 'stc_get()' to use the
+ * current monotonic clock time.
+ */
+#define STC_NOW (-1)
+
+/**
+ * STC estimator statistics context structure.
+ */
+typedef struct stc_stats_ctx_s {
+	/**
+	 * Set to non-zero if the estimator is locked (model is valid).
+	 */
+	int flag_locked;
+	/**
+	 * Estimated drift of the encoder clock relative to the local clock
+	 * [parts per million].
+	 */
+	double drift_ppm;
+	/**
+	 * Root mean square of the residual of the accepted samples (PCR arrival
+	 * jitter estimation) [microseconds].
+	 */
+	double jitter_rms_usec;
+	/**
+	 * Number of PCR samples accepted.
+	 */
+	uint64_t samples_count;
+	/**
+	 * Number of PCR samples rejected as outliers.
+	 */
+	uint64_t outliers_count;
+	/**
+	 * Number of discontinuities (signaled or detected) that made the
+	 * estimator reset.
+	 */
+	uint64_t discontinuities_count;
+} stc_stats_ctx_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Open (allocate and initialize) an STC estimator instance.
+ * @param log_ctx Externally defined LOG module context structure instance.
+ * @return Pointer to the STC estimator context structure on success, NULL
+ * if fails.
+ */
+stc_ctx_t* stc_open(log_ctx_t *log_ctx);
+
+/**
+ * Close (release) an STC estimator instance.
+ * @param ref_stc_ctx Reference to the pointer to the STC estimator context
+ * structure to be released. Pointer is set to NULL on return.
+ */
+void stc_close(stc_ctx_t **ref_stc_ctx);
+
+/**
+ * Reset STC estimator (model is unlocked until new samples are received).
+ * Should only be called from the writer thread.
+ * @param stc_ctx STC estimator context structure.
+ */
+void stc_reset(stc_ctx_t *stc_ctx);
+
+/**
+ * Feed a new PCR sample to the STC estimator.
+ * Should only be called from the writer thread.
+ * @param stc_ctx STC estimator context structure.
+ * @param pcr PCR value in 27MHz units (base* 300+ extension).
+ * @param arrival_usec Local (monotonic) arrival time of the packet carrying
+ * the PCR [microseconds].
+ * @param flag_discontinuity Set to non-zero if the packet carrying the PCR
+ * has the 'discontinuity_indicator' set.
+ * @return Status code STAT_SUCCESS if sample was accepted, STAT_EAGAIN if
+ * sample was rejected as an outlier, STAT_ERROR in case of bad arguments.
+ */
+int stc_put_pcr(stc_ctx_t *stc_ctx, int64_t pcr, int64_t arrival_usec,
+		int flag_discontinuity);
+
+/**
+ * Get STC value at the given local time.
+ * This function is lock-free and runs in constant time.
+ * @param stc_ctx STC estimator context structure.
+ * @param now_usec Local (monotonic) time [microseconds] at which STC is
+ * evaluated, or STC_NOW to use the current time.
+ * @param ref_stc Reference to the STC value to be returned, in 27MHz units
+ * and wrapped to the PCR range [0, STC_PCR_WRAP).
+ * @return Status code STAT_SUCCESS, STAT_ENODATA if the estimator is not
+ * locked yet, or STAT_ERROR in case of bad arguments.
+ */
+int stc_get(stc_ctx_t *stc_ctx, int64_t now_usec, int64_t *ref_stc);
+
+/**
+ * Get STC estimator statistics.
+ * This function is lock-free.
+ * @param stc_ctx STC estimator context structure.
+ * @param stc_stats_ctx Statistics context structure to be filled.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int stc_get_stats(stc_ctx_t *stc_ctx, stc_stats_ctx_t *stc_stats_ctx);
+
+/**
+ * Get local (monotonic) time in microseconds.
+ * @return Current monotonic time [microseconds].
+ */
+int64_t stc_monotonic_usec();
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_STC_H_ */
@@ -30,6 +30,7 @@
 #include <libmediaprocsutils/log.h>
 #include <libmediaprocsutils/stat_codes.h>
 #include <libmediaprocsutils/check_utils.h>
+#include "obj_pool.h"
 
 /* **** Definitions **** */
 
@@ -37,7 +38,7 @@
 
 ts_ctx_t* ts_ctx_allocate()
 {
-	return (ts_ctx_t*)calloc(1, sizeof(ts_ctx_t));
+	return (ts_ctx_t*)obj_pool_calloc(sizeof(ts_ctx_t));
 }
 
 ts_ctx_t* ts_ctx_dup(const ts_ctx_t* ts_ctx_arg)
@@ -140,13 +141,13 @@ void ts_ctx_release(ts_ctx_t **ref_ts_ctx)
 		ts_ctx->payload= NULL;
 	}
 
-	free(ts_ctx);
+	obj_pool_free(ts_ctx, sizeof(ts_ctx_t));
 	*ref_ts_ctx= NULL;
 }
 
 ts_af_ctx_t* ts_af_ctx_allocate()
 {
-	return (ts_af_ctx_t*)calloc(1, sizeof(ts_af_ctx_t));
+	return (ts_af_ctx_t*)obj_pool_calloc(sizeof(ts_af_ctx_t));
 }
 
 ts_af_ctx_t* ts_af_ctx_dup(const ts_af_ctx_t* ts_af_ctx_arg)
@@ -203,7 +204,7 @@ void ts_af_ctx_release(ts_af_ctx_t **ref_ts_af_ctx)
 		ts_af_ctx->af_remaining= NULL;
 	}
 
-	free(ts_af_ctx);
+	obj_pool_free(ts_af_ctx, sizeof(ts_af_ctx_t));
 	*ref_ts_af_ctx= NULL;
 }
 
@@ -40,64 +40,191 @@
 #define FLUSH_BITS(b) bitparser_flush(bitparser_ctx, (b))
 #define COPY_BYTES(B) bitparser_copy_bytes(bitparser_ctx, (B))
 
+/**
+ * Parse a 33-bit PES time-stamp (PTS or DTS) coded in 5 bytes with its
+ * corresponding marker bits (ISO/IEC 13818-1, 2.4.3.7).
+ */
+#define PES_PARSE_TIMESTAMP(BUF) ((int64_t)\
+		((((uint64_t)(((const uint8_t*)BUF)[0]>> 1)& 0x07)<< 30)|\
+		 (((uint64_t)((const uint8_t*)BUF)[1])<< 22)|\
+		 (((uint64_t)(((const uint8_t*)BUF)[2]>> 1))<< 15)|\
+		 (((uint64_t)((const uint8_t*)BUF)[3])<< 7)|\
+		 (((uint64_t)((const uint8_t*)BUF)[4])>> 1))\
+		)
+
+/**
+ * Returns non-zero if the PES 'stream_id' given carries the optional PES
+ * header (that is, the one including the PTS/DTS fields).
+ * Streams without optional header: program_stream_map (0xBC),
+ * padding_stream (0xBE), private_stream_2 (0xBF), ECM (0xF0), EMM (0xF1),
+ * DSMCC_stream (0xF2), ITU-T Rec. H.222.1 type E (0xF8) and
+ * program_stream_directory (0xFF).
+ */
+#define PES_HAS_OPTIONAL_HEADER(STREAM_ID) \
+	((STREAM_ID)!= 0xBC && (STREAM_ID)!= 0xBE && (STREAM_ID)!= 0xBF &&\
+	 (STREAM_ID)!= 0xF0 && (STREAM_ID)!= 0xF1 && (STREAM_ID)!= 0xF2 &&\
+	 (STREAM_ID)!= 0xF8 && (STREAM_ID)!= 0xFF)
+
+/**
+ * Offset and size of the PCR fields in the MPEG2-TS packet (when present).
+ */
+#define PCR_OFFSET 6
+#define PCR_SIZE 6
+
+/**
+ * Returns non-zero if the given MPEG2-TS packet carries a PCR.
+ */
+#define TS_PKT_HAS_PCR(PKT) \
+	((((const uint8_t*)(PKT))[3]& 0x20) && ((const uint8_t*)(PKT))[4]!= 0 &&\
+	 (((const uint8_t*)(PKT))[5]& 0x10))
+
+/**
+ * 64-bit FNV-1a hash parameters.
+ */
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A_64_PRIME 0x100000001b3ULL
+
 /* **** Prototypes **** */
 
+static int ts_dec_is_duplicate(ts_dec_cc_ctx_t *ts_dec_cc_ctx,
+		const uint8_t *pkt);
+static uint64_t ts_dec_pkt_hash(const uint8_t *pkt);
+
 static int ts_dec_adaptation_field(log_ctx_t *log_ctx,
 		bitparser_ctx_t *bitparser_ctx, uint8_t contains_payload, uint16_t pid,
 		ts_af_ctx_t **ref_ts_af_ctx);
 
 /* **** Implementations **** */
 
+void ts_dec_cc_ctx_init(ts_dec_cc_ctx_t *ts_dec_cc_ctx)
+{
+	if(ts_dec_cc_ctx== NULL)
+		return;
+	memset(ts_dec_cc_ctx, 0, sizeof(ts_dec_cc_ctx_t));
+	ts_dec_cc_ctx->cc= TS_CC_UNDEF;
+}
+
 int ts_dec_get_next_packet(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_cc, ts_ctx_t **ref_ts_ctx)
+		ts_dec_cc_ctx_t *ts_dec_cc_ctx, ts_ctx_t **ref_ts_ctx)
 {
-	ts_ctx_t *ts_ctx;
-	uint16_t pid;
 	int ret_code, end_code= STAT_ERROR;
-	uint8_t curr_cc= TS_CC_UNDEF, prev_cc= TS_CC_UNDEF;
 	uint8_t *pkt= NULL;
-	size_t pkt_size= 0;
 	LOG_CTX_INIT(log_ctx);
 
 	/* Check arguments.
-	 * Arguments 'log_ctx' and 'ref_cc' are allowed to be NULL.
+	 * Arguments 'log_ctx' and 'ts_dec_cc_ctx' are allowed to be NULL.
 	 */
 	CHECK_DO(ififo_ctx!= NULL, return STAT_ERROR);
 	CHECK_DO(ref_ts_ctx!= NULL, return STAT_ERROR);
 
 	*ref_ts_ctx= NULL;
 
-	/* Get (flush) next TS packet byte buffer */
-	ret_code= fifo_get(ififo_ctx, (void**)&pkt, &pkt_size);
+	/* Get next TS packet byte buffer (continuity checked) */
+	ret_code= ts_dec_get_next_packet_raw(ififo_ctx, LOG_CTX_GET(),
+			ts_dec_cc_ctx, &pkt);
 	if(ret_code!= STAT_SUCCESS) {
-		if(ret_code== STAT_EAGAIN)
-			end_code= STAT_EOF; // FIFO unblocked; we are requested to exit.
+		end_code= ret_code;
 		goto end;
 	}
-	CHECK_DO(pkt!= NULL && pkt[0]== 0x47 && pkt_size== TS_PKT_SIZE, goto end);
 
 	/* Decode TS packet buffer into context structure */
 	ret_code= ts_dec_packet(pkt, LOG_CTX_GET(), ref_ts_ctx);
-	CHECK_DO(ret_code== STAT_SUCCESS && (ts_ctx= *ref_ts_ctx)!= NULL, goto end);
+	CHECK_DO(ret_code== STAT_SUCCESS && *ref_ts_ctx!= NULL, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code== STAT_ERROR)
+		ts_ctx_release(ref_ts_ctx);
+	if(pkt!= NULL)
+		free(pkt);
+	return end_code;
+}
+
+int ts_dec_get_next_packet_raw(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
+		ts_dec_cc_ctx_t *ts_dec_cc_ctx, uint8_t **ref_pkt)
+{
+	int ret_code, end_code= STAT_ERROR;
+	uint8_t *pkt= NULL;
+	size_t pkt_size= 0;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments.
+	 * Arguments 'log_ctx' and 'ts_dec_cc_ctx' are allowed to be NULL.
+	 */
+	CHECK_DO(ififo_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_pkt!= NULL, return STAT_ERROR);
+
+	*ref_pkt= NULL;
+
+	/* Get (flush) next TS packet byte buffer; duplicate packets are
+	 * silently dropped (see ISO/IEC 13818-1, 2.4.3.3).
+	 */
+	do {
+		if(pkt!= NULL) {
+			free(pkt);
+			pkt= NULL;
+		}
+		ret_code= fifo_get(ififo_ctx, (void**)&pkt, &pkt_size);
+		if(ret_code!= STAT_SUCCESS) {
+			if(ret_code== STAT_EAGAIN)
+				end_code= STAT_EOF; // FIFO unblocked; requested to exit.
+			goto end;
+		}
+		CHECK_DO(pkt!= NULL && pkt[0]== 0x47 && pkt_size== TS_PKT_SIZE,
+				goto end);
+	} while(ts_dec_cc_check_packet(ts_dec_cc_ctx, pkt, LOG_CTX_GET())==
+			STAT_ENODATA);
+
+	*ref_pkt= pkt;
+	pkt= NULL; // Avoid double referencing
+	end_code= STAT_SUCCESS;
+end:
+	if(pkt!= NULL)
+		free(pkt);
+	return end_code;
+}
+
+int ts_dec_cc_check_packet(ts_dec_cc_ctx_t *ts_dec_cc_ctx,
+		const uint8_t *pkt, log_ctx_t *log_ctx)
+{
+	uint16_t pid;
+	int adaptation_field_exist, contains_payload;
+	uint8_t curr_cc= TS_CC_UNDEF, prev_cc= TS_CC_UNDEF;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Check arguments.
+	 * Arguments 'log_ctx' and 'ts_dec_cc_ctx' are allowed to be NULL.
+	 */
+	CHECK_DO(pkt!= NULL, return STAT_ERROR);
+
+	if(ts_dec_cc_ctx== NULL)
+		return STAT_SUCCESS;
+
+	/* Duplicate packets are dropped (see ISO/IEC 13818-1, 2.4.3.3) */
+	if(ts_dec_is_duplicate(ts_dec_cc_ctx, pkt))
+		return STAT_ENODATA;
+
+	pid= TS_BUF_GET_PID(pkt);
+	adaptation_field_exist= (pkt[3]& 0x20)!= 0;
+	contains_payload= TS_BUF_GET_PAYLOAD_FLAG(pkt)!= 0;
 
 	/* Update continuity counter registers */
 	/* Note that in the case of a null packet, the value of the
 	 * continuity_counter is undefined (do not update).
 	 */
-	pid= ts_ctx->pid;
-	if(pid!= 0x1FFF) {
-		curr_cc= ts_ctx->continuity_counter;
-		ASSERT(curr_cc<= 0x0F);
-	}
-	if(ref_cc!= NULL) {
-		prev_cc= *ref_cc;
-		if(curr_cc!= TS_CC_UNDEF)
-			*ref_cc= curr_cc; // Update continuity counter external register
+	if(pid!= 0x1FFF)
+		curr_cc= TS_BUF_GET_CC(pkt);
+	prev_cc= ts_dec_cc_ctx->cc;
+	if(curr_cc!= TS_CC_UNDEF) {
+		/* Update continuity checking external register */
+		ts_dec_cc_ctx->cc= curr_cc;
+		memcpy(ts_dec_cc_ctx->pkt, pkt, TS_PKT_SIZE);
+		ts_dec_cc_ctx->flag_hash_valid= 0;
+		ts_dec_cc_ctx->flag_duplicated= 0;
 	}
 
 	/* **** Check compliance: Continuity counter. **** */
-	/* Note that this function ('ts_dec_get_next_packet()') parses packets
-	 * extracted from an input FIFO buffer corresponding to a stream carrying a
+	/* Note that the continuity checking context structure corresponds to a
 	 * single packet identifier (PID).
 	 * We can not use the next packet of the FIFO to check continuity because
 	 * in that case we may be introducing a delay (we should wait for the
@@ -110,10 +237,8 @@ int ts_dec_get_next_packet(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
 	/* In the case previous or current packet continuity counter are not
 	 * defined, we are done.
 	 */
-	if(prev_cc== TS_CC_UNDEF || curr_cc== TS_CC_UNDEF) {
-		end_code= STAT_SUCCESS;
-		goto end;
-	}
+	if(prev_cc== TS_CC_UNDEF || curr_cc== TS_CC_UNDEF)
+		return STAT_SUCCESS;
 
 	/* The continuity_counter in a particular Transport Stream packet is
 	 * continuous when it differs by a positive value of one from the
@@ -130,17 +255,18 @@ int ts_dec_get_next_packet(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
 		 * - Discontinuity is not explicitly set.
 		 */
 		int discontinuity_flag= (((prev_cc+ 1)& 0xF)!= curr_cc);
-		int explicit_disc_set_flag= (ts_ctx->adaptation_field_exist &&
-				ts_ctx->adaptation_field &&
-				ts_ctx->adaptation_field->discontinuity_indicator!= 0);
+		int explicit_disc_set_flag= (adaptation_field_exist &&
+				pkt[4]!= 0 && (pkt[5]& 0x80)!= 0);
 		if(discontinuity_flag && !explicit_disc_set_flag) {
 			/* Continuity error detected */
+			ts_dec_cc_ctx->cc_errors_count++;
 			LOGE("Continuity error detected at input TS: illegal "
 					"incrementing condition (%u to %u). PID= %u (0x%0x).\n",
 					prev_cc, curr_cc, pid, pid);
 			//goto end; // Do not return error, just report.
 		}
-		if(ts_ctx->contains_payload== 0) {
+		if(contains_payload== 0) {
+			ts_dec_cc_ctx->cc_errors_count++;
 			LOGE("Continuity error detected (TS packet without payload does "
 					"not met the non-incrementing conditions). "
 					"PID= %u (0x%0x).\n", pid, pid);
@@ -148,22 +274,11 @@ int ts_dec_get_next_packet(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
 	} else {
 		/* Check if we met the non-incrementing conditions */
 		/* Check 'adaptation_field_control' */
-		if(ts_ctx->contains_payload!= 0) {
-			/* Check if we have a packet duplication or discontinuity error */
-			/* In Transport Streams, duplicate packets may be sent as two,
-			 * and only two, consecutive Transport Stream packets of the same
-			 * PID. The duplicate packets shall have the same
-			 * continuity_counter value as the original packet and the
-			 * adaptation_field_control field shall be equal to '01' or '11'.
-			 * In duplicate packets each byte of the original packet shall be
-			 * duplicated, with the exception that in the program clock
-			 * reference fields, if present.
+		if(contains_payload!= 0) {
+			/* Duplicate packets were already dropped above (see
+			 * 'ts_dec_is_duplicate()'); thus, this is a discontinuity.
 			 */
-			//TODO: Check duplication at byte level:
-			// - If duplicated, continue to
-			// next packet ignoring this one, and check strictly incrementing
-			// conditions.
-			// - Else, report discontinuity.
+			ts_dec_cc_ctx->cc_errors_count++;
 			LOGE("Continuity error detected (TS packet with payload does "
 					"not met the non-incrementing conditions). "
 					"PID= %u (0x%0x).\n", pid, pid);
@@ -171,13 +286,80 @@ int ts_dec_get_next_packet(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
 		}
 	}
 
-	end_code= STAT_SUCCESS;
-end:
-	if(end_code== STAT_ERROR)
-		ts_ctx_release(ref_ts_ctx);
-	if(pkt!= NULL)
-		free(pkt);
-	return end_code;
+	return STAT_SUCCESS;
+}
+
+/**
+ * Check if the given packet is a duplicate of the last packet registered in
+ * the continuity checking context structure.
+ * In Transport Streams, duplicate packets may be sent as two, and only two,
+ * consecutive Transport Stream packets of the same PID. The duplicate
+ * packets shall have the same continuity_counter value as the original
+ * packet and the adaptation_field_control field shall be equal to '01' or
+ * '11'. In duplicate packets each byte of the original packet shall be
+ * duplicated, with the exception that in the program clock reference
+ * fields, if present.
+ * The (cached) hash of the packets is compared first; byte comparison is
+ * only performed if hashes are equal.
+ * @return Non-zero if packet is a duplicate (duplicates counter is
+ * incremented), zero otherwise.
+ */
+static int ts_dec_is_duplicate(ts_dec_cc_ctx_t *ts_dec_cc_ctx,
+		const uint8_t *pkt)
+{
+	int pcr_flag;
+
+	/* Fast checks on packet header */
+	if(ts_dec_cc_ctx->cc== TS_CC_UNDEF || ts_dec_cc_ctx->flag_duplicated ||
+			TS_BUF_GET_CC(pkt)!= ts_dec_cc_ctx->cc ||
+			!TS_BUF_GET_PAYLOAD_FLAG(pkt) ||
+			TS_BUF_GET_PID(pkt)!= TS_BUF_GET_PID(ts_dec_cc_ctx->pkt) ||
+			TS_BUF_GET_PID(pkt)== 0x1FFF)
+		return 0;
+
+	/* Compare hashes (hash of the last packet is cached) */
+	if(!ts_dec_cc_ctx->flag_hash_valid) {
+		ts_dec_cc_ctx->hash= ts_dec_pkt_hash(ts_dec_cc_ctx->pkt);
+		ts_dec_cc_ctx->flag_hash_valid= 1;
+	}
+	if(ts_dec_pkt_hash(pkt)!= ts_dec_cc_ctx->hash)
+		return 0;
+
+	/* Confirm comparing bytes (PCR fields excluded) */
+	pcr_flag= TS_PKT_HAS_PCR(pkt);
+	if(pcr_flag!= TS_PKT_HAS_PCR(ts_dec_cc_ctx->pkt))
+		return 0;
+	if(pcr_flag) {
+		if(memcmp(pkt, ts_dec_cc_ctx->pkt, PCR_OFFSET)!= 0 ||
+				memcmp(&pkt[PCR_OFFSET+ PCR_SIZE],
+						&ts_dec_cc_ctx->pkt[PCR_OFFSET+ PCR_SIZE],
+						TS_PKT_SIZE- PCR_OFFSET- PCR_SIZE)!= 0)
+			return 0;
+	} else if(memcmp(pkt, ts_dec_cc_ctx->pkt, TS_PKT_SIZE)!= 0) {
+		return 0;
+	}
+
+	ts_dec_cc_ctx->flag_duplicated= 1;
+	ts_dec_cc_ctx->duplicates_count++;
+	return 1;
+}
+
+/**
+ * Compute 64-bit FNV-1a hash of the given packet (PCR fields excluded).
+ */
+static uint64_t ts_dec_pkt_hash(const uint8_t *pkt)
+{
+	register int i;
+	register uint64_t hash= FNV1A_64_OFFSET_BASIS;
+	const int pcr_flag= TS_PKT_HAS_PCR(pkt);
+
+	for(i= 0; i< TS_PKT_SIZE; i++) {
+		if(pcr_flag && i== PCR_OFFSET)
+			i+= PCR_SIZE;
+		hash^= (uint64_t)pkt[i];
+		hash*= FNV1A_64_PRIME;
+	}
+	return hash;
 }
 
 static int ts_dec_adaptation_field(log_ctx_t *log_ctx,
@@ -417,3 +599,68 @@ end:
 		ts_ctx_release(&ts_ctx);
 	return end_code;
 }
+
+int ts_dec_pes_peek_timestamps(const uint8_t *pkt, int64_t *ref_pts,
+		int64_t *ref_dts)
+{
+	const uint8_t *pes;
+	int payload_offset, ts_len;
+	uint8_t pts_dts_flags;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(pkt!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_pts!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_dts!= NULL, return STAT_ERROR);
+
+	*ref_pts= *ref_dts= TS_TIMESTAMP_INVALID;
+
+	/* The PES header can only start in a packet with payload and the
+	 * 'payload_unit_start_indicator' set.
+	 */
+	if(!TS_BUF_GET_START_INDICATOR(pkt) || !TS_BUF_GET_PAYLOAD_FLAG(pkt))
+		return STAT_ENOTFOUND;
+
+	/* Skip adaptation field if present */
+	payload_offset= TS_PKT_PREFIX_LEN;
+	if(pkt[3]& 0x20)
+		payload_offset+= 1+ pkt[4];
+
+	/* We need at least the fixed PES header (9 bytes) plus the PTS field
+	 * (5 bytes) in this packet (the DTS field is checked below).
+	 */
+	if(payload_offset+ 9+ 5> TS_PKT_SIZE)
+		return STAT_ENOTFOUND;
+	pes= &pkt[payload_offset];
+
+	/* Check 'packet_start_code_prefix' (0x000001) and 'stream_id' */
+	if(pes[0]!= 0x00 || pes[1]!= 0x00 || pes[2]!= 0x01 ||
+			!PES_HAS_OPTIONAL_HEADER(pes[3]))
+		return STAT_ENOTFOUND;
+
+	/* Optional PES header should start with the '10' marker bits */
+	if((pes[6]& 0xC0)!= 0x80)
+		return STAT_ENOTFOUND;
+
+	/* 'PTS_DTS_flags': '10'-> PTS only; '11'-> PTS and DTS ('01' is
+	 * forbidden).
+	 */
+	pts_dts_flags= (pes[7]>> 6)& 0x03;
+	if((pts_dts_flags& 0x02)== 0)
+		return STAT_ENOTFOUND;
+
+	/* 'PES_header_data_length' should account for the signaled time-stamp
+	 * fields (5 bytes per time-stamp); and these should fit in this packet.
+	 */
+	ts_len= (pts_dts_flags== 0x03)? 10: 5;
+	if(pes[8]< ts_len || payload_offset+ 9+ ts_len> TS_PKT_SIZE)
+		return STAT_ENOTFOUND;
+
+	*ref_pts= PES_PARSE_TIMESTAMP(&pes[9]);
+	if(pts_dts_flags== 0x03)
+		*ref_dts= PES_PARSE_TIMESTAMP(&pes[14]);
+	else
+		*ref_dts= *ref_pts;
+
+	return STAT_SUCCESS;
+}
@@ -29,12 +29,52 @@
 #include <sys/types.h>
 #include <inttypes.h>
 
+#include "ts.h"
+
 /* **** Definitions **** */
 
 typedef struct fifo_ctx_s fifo_ctx_t;
 typedef struct log_ctx_s log_ctx_t;
 typedef struct ts_ctx_s ts_ctx_t;
 
+/**
+ * Continuity checking context structure.
+ * Keeps track of the last packet decoded for a given PID in order to check
+ * the continuity counter and to detect duplicate packets (ISO/IEC 13818-1,
+ * 2.4.3.3). Should be initialized using 'ts_dec_cc_ctx_init()'.
+ */
+typedef struct ts_dec_cc_ctx_s {
+	/**
+	 * Continuity counter of the last packet; TS_CC_UNDEF if not known.
+	 */
+	uint8_t cc;
+	/**
+	 * Set to non-zero if the last packet was already duplicated (duplicate
+	 * packets may only be sent as two consecutive packets).
+	 */
+	int flag_duplicated;
+	/**
+	 * Set to non-zero if 'hash' is computed for the last packet.
+	 */
+	int flag_hash_valid;
+	/**
+	 * Cached hash of the last packet (PCR fields excluded).
+	 */
+	uint64_t hash;
+	/**
+	 * Copy of the last packet.
+	 */
+	uint8_t pkt[TS_PKT_SIZE];
+	/**
+	 * Number of duplicate packets detected (and dropped).
+	 */
+	uint64_t duplicates_count;
+	/**
+	 * Number of continuity errors detected.
+	 */
+	uint64_t cc_errors_count;
+} ts_dec_cc_ctx_t;
+
 #define TS_DEC_GET_PCR_BASE(PCR) ((((int64_t)(PCR))/300)&(int64_t)0x1FFFFFFFF)
 #define TS_DEC_GET_PCR_EXT(PCR) (((int64_t)(PCR))%300)
 
@@ -58,22 +98,91 @@ typedef struct ts_ctx_s ts_ctx_t;
 
 /* **** Prototypes **** */
 
+/**
+ * Initialize continuity checking context structure.
+ * @param ts_dec_cc_ctx Continuity checking context structure.
+ */
+void ts_dec_cc_ctx_init(ts_dec_cc_ctx_t *ts_dec_cc_ctx);
+
 /**
  * Get next MPEG2-TS packet. Allocate the packet in an MPEG-2 TS context
  * structure (type 'ts_ctx_t').
+ * Duplicate packets (same continuity counter and same bytes, PCR fields
+ * excepted) are silently dropped and accounted in the continuity checking
+ * context structure.
  * @param ififo_ctx Input packet FIFO buffer context structure.
  * @param log_ctx LOG module context structure.
+ * @param ts_dec_cc_ctx Continuity checking context structure of the
+ * PID being decoded (may be NULL to skip continuity checking).
  * @param ref_ts_ctx Reference to the pointer to the MPEG-2 TS context
  * structure to be allocated and initialized.
  * @return Status code (refer to 'stat_codes_ctx_t' type).
  * @see stat_codes_ctx_t
  */
 int ts_dec_get_next_packet(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
-		uint8_t *ref_cc, ts_ctx_t **ref_ts_ctx);
+		ts_dec_cc_ctx_t *ts_dec_cc_ctx, ts_ctx_t **ref_ts_ctx);
+
+/**
+ * Get next MPEG2-TS packet as a binary buffer (the packet is not decoded
+ * into a context structure).
+ * Duplicate packets are dropped and continuity is checked as in
+ * 'ts_dec_get_next_packet()'; only the packet header (and the adaptation
+ * field discontinuity indicator) is inspected.
+ * @param ififo_ctx Input packet FIFO buffer context structure.
+ * @param log_ctx LOG module context structure.
+ * @param ts_dec_cc_ctx Continuity checking context structure of the
+ * PID being decoded (may be NULL to skip continuity checking).
+ * @param ref_pkt Reference to the pointer to the packet buffer
+ * (TS_PKT_SIZE bytes) returned. The buffer should be released by the
+ * caller using 'free()'.
+ * @return Status code (refer to 'stat_codes_ctx_t' type).
+ * @see stat_codes_ctx_t
+ */
+int ts_dec_get_next_packet_raw(fifo_ctx_t *ififo_ctx, log_ctx_t *log_ctx,
+		ts_dec_cc_ctx_t *ts_dec_cc_ctx, uint8_t **ref_pkt);
+
+/**
+ * Check the given MPEG2-TS packet (binary buffer) against the last packet
+ * registered in the continuity checking context structure: duplicate
+ * packets are detected and the continuity counter is checked (errors are
+ * reported and accounted, but the packet is not discarded).
+ * This is the check performed by 'ts_dec_get_next_packet_raw()' on each
+ * packet read; it may be used when packets are not read from a FIFO
+ * buffer dedicated to a single PID.
+ * @param ts_dec_cc_ctx Continuity checking context structure of the PID of
+ * the packet (if NULL, the packet is just accepted).
+ * @param pkt Packet buffer (TS_PKT_SIZE bytes).
+ * @param log_ctx LOG module context structure.
+ * @return STAT_SUCCESS if the packet is accepted, STAT_ENODATA if it is a
+ * duplicate packet that should be dropped.
+ */
+int ts_dec_cc_check_packet(ts_dec_cc_ctx_t *ts_dec_cc_ctx,
+		const uint8_t *pkt, log_ctx_t *log_ctx);
 
 /**
  * //TODO
  */
 int ts_dec_packet(uint8_t *pkt, log_ctx_t *log_ctx, ts_ctx_t **ref_ts_ctx);
 
+/**
+ * Peek the Presentation and Decoding time-stamps (PTS/DTS) of a Packetized
+ * Elementary Stream (PES) header starting in the given MPEG2-TS packet.
+ * The PES header is read in place (no allocation, no bit-parser); only the
+ * fixed part of the header and the PTS/DTS fields are inspected.
+ * @param pkt Binary MPEG2-TS packet (188 bytes), which should have the
+ * 'payload_unit_start_indicator' set.
+ * @param ref_pts Reference to the PTS value to be returned (33 bits, 90KHz
+ * units). Set to TS_TIMESTAMP_INVALID if not present.
+ * @param ref_dts Reference to the DTS value to be returned (33 bits, 90KHz
+ * units). If only the PTS is signaled ('PTS_DTS_flags' set to '10'), it is
+ * set to the PTS value (as stated in ISO/IEC 13818-1); set to
+ * TS_TIMESTAMP_INVALID if no time-stamp is returned.
+ * @return Status code STAT_SUCCESS if the signaled time-stamps were found,
+ * STAT_ENOTFOUND if packet does not start a PES header carrying time-stamps
+ * or if the signaled time-stamps do not fit in the 'PES_header_data_length'
+ * or in the packet, or STAT_ERROR in case of bad arguments.
+ */
+int ts_dec_pes_peek_timestamps(const uint8_t *pkt, int64_t *ref_pts,
+		int64_t *ref_dts);
+
 #endif /* STREAMPROCESSORS_MPEG2TS_SRC_TS_DEC_H_ */
@@ -0,0 +1,701 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file ts_remap.c
+ * @author Rafael Antoniello
+ */
+
+#include "ts_remap.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <libcjson/cJSON.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include <libmediaprocsutils/llist.h>
+#include "ts.h"
+#include "psi.h"
+#include "psi_oput.h"
+#include "stc.h"
+
+/* **** Definitions **** */
+
+/**
+ * Maximum number of transport packets needed to carry a PSI section
+ * (including the 'pointer_field').
+ */
+#define TS_REMAP_PSI_MAX_PKTS \
+	((PSI_TABLE_MPEG_MAX_SECTION_LEN+ 1+ (TS_PKT_SIZE- TS_PKT_PREFIX_LEN)- 1)/\
+			(TS_PKT_SIZE- TS_PKT_PREFIX_LEN))
+
+/**
+ * PSI PID flags used for the packet path look-up table.
+ */
+#define TS_REMAP_PSI_FLAG_PAT 	(1<< 0)
+#define TS_REMAP_PSI_FLAG_PMT 	(1<< 1)
+
+/**
+ * PID re-mapping module instance context structure.
+ */
+typedef struct ts_remap_ctx_s {
+	/**
+	 * Externally defined LOG module context structure instance.
+	 */
+	log_ctx_t *log_ctx;
+	/**
+	 * Module instance critical section MUTEX.
+	 * Note that the PID map and the PSI look-up table are read without
+	 * locking on the packet path; MUTEX is only taken to output the
+	 * pre-packetized PSI.
+	 */
+	pthread_mutex_t mutex;
+	/**
+	 * PID map (indexed by input PID; TS_REMAP_PID_DROP if unmapped).
+	 */
+	volatile uint16_t pid_map[TS_MAX_PID_VAL+ 1];
+	/**
+	 * PSI look-up table (see TS_REMAP_PSI_FLAG_* flags).
+	 */
+	volatile uint8_t psi_flags[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Last continuity counter received for each input PID.
+	 */
+	uint8_t cc_iput[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Last continuity counter output for each output PID.
+	 */
+	uint8_t cc_oput[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Input PMT PID; -1 if PSI re-writing is not set.
+	 */
+	int pmt_pid;
+	/**
+	 * Output PSI generator holding the re-written PAT and PMT
+	 * (pre-packetized).
+	 */
+	psi_oput_ctx_t *psi_oput_ctx;
+	/**
+	 * PSI repetition interval in milliseconds; zero to output the PSI at the
+	 * input rate (see 'ts_remap_set_psi_interval()').
+	 */
+	int psi_interval_msec;
+	/**
+	 * PSI repetition interval applied to the current output PSI (set on
+	 * 'ts_remap_set_pms()'; read on the packet path).
+	 */
+	volatile int psi_interval_msec_oput;
+	/**
+	 * Output PAT contents and version; version is incremented each time
+	 * contents change ('pat_version' is -1 if PAT was never composed).
+	 */
+	uint16_t pat_program_number;
+	uint16_t pat_pmt_pid;
+	uint16_t pat_transport_stream_id;
+	int pat_version;
+	/**
+	 * Output PMT contents (last re-written section) and version; version is
+	 * incremented each time contents change ('pmt_version' is -1 if PMT was
+	 * never composed).
+	 */
+	psi_section_ctx_t *pmt_section_oput;
+	int pmt_version;
+	/**
+	 * Output buffer for the PSI packets, followed by the processed packet
+	 * (see 'ts_remap_packet()').
+	 */
+	uint8_t oput_buf[(2* TS_REMAP_PSI_MAX_PKTS+ 1)* TS_PKT_SIZE];
+	/**
+	 * Statistics.
+	 */
+	volatile uint64_t packets_output;
+	volatile uint64_t packets_dropped;
+	volatile uint64_t psi_packets_output;
+} ts_remap_ctx_t;
+
+/* **** Prototypes **** */
+
+static uint8_t ts_remap_cc_next(ts_remap_ctx_t *ts_remap_ctx,
+		uint16_t pid_out, uint8_t cc_delta, uint8_t cc_iput);
+static psi_section_ctx_t* ts_remap_compose_pms(ts_remap_ctx_t *ts_remap_ctx,
+		const psi_section_ctx_t *psi_section_ctx_pms, log_ctx_t *log_ctx);
+static int ts_remap_pms_cmp(const psi_section_ctx_t *psi_section_ctx1,
+		const psi_section_ctx_t *psi_section_ctx2);
+static psi_section_ctx_t* ts_remap_compose_pas(uint16_t program_number,
+		uint16_t pmt_pid, uint16_t transport_stream_id, uint8_t version,
+		log_ctx_t *log_ctx);
+static void ts_remap_psi_unset(ts_remap_ctx_t *ts_remap_ctx);
+
+/* **** Implementations **** */
+
+ts_remap_ctx_t* ts_remap_open(log_ctx_t *log_ctx)
+{
+	int i, ret_code;
+	ts_remap_ctx_t *ts_remap_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Allocate context structure */
+	ts_remap_ctx= (ts_remap_ctx_t*)calloc(1, sizeof(ts_remap_ctx_t));
+	CHECK_DO(ts_remap_ctx!= NULL, return NULL);
+
+	ts_remap_ctx->log_ctx= log_ctx;
+
+	/* Open output PSI generator */
+	ts_remap_ctx->psi_oput_ctx= psi_oput_open(LOG_CTX_GET());
+	CHECK_DO(ts_remap_ctx->psi_oput_ctx!= NULL, free(ts_remap_ctx);
+			return NULL);
+
+	/* Initialize MUTEX (on failure we can not use 'ts_remap_close()') */
+	ret_code= pthread_mutex_init(&ts_remap_ctx->mutex, NULL);
+	CHECK_DO(ret_code== 0, psi_oput_close(&ts_remap_ctx->psi_oput_ctx);
+			free(ts_remap_ctx); return NULL);
+
+	for(i= 0; i<= TS_MAX_PID_VAL; i++) {
+		ts_remap_ctx->pid_map[i]= TS_REMAP_PID_DROP;
+		ts_remap_ctx->cc_iput[i]= TS_CC_UNDEF;
+		ts_remap_ctx->cc_oput[i]= TS_CC_UNDEF;
+	}
+	ts_remap_ctx->pmt_pid= -1;
+	ts_remap_ctx->pat_version= -1;
+	ts_remap_ctx->pmt_version= -1;
+
+	return ts_remap_ctx;
+}
+
+void ts_remap_close(ts_remap_ctx_t **ref_ts_remap_ctx)
+{
+	ts_remap_ctx_t *ts_remap_ctx;
+
+	if(ref_ts_remap_ctx== NULL || (ts_remap_ctx= *ref_ts_remap_ctx)== NULL)
+		return;
+
+	ASSERT(pthread_mutex_destroy(&ts_remap_ctx->mutex)== 0);
+
+	psi_oput_close(&ts_remap_ctx->psi_oput_ctx);
+
+	psi_section_ctx_release(&ts_remap_ctx->pmt_section_oput);
+
+	free(ts_remap_ctx);
+	*ref_ts_remap_ctx= NULL;
+}
+
+int ts_remap_set_pid(ts_remap_ctx_t *ts_remap_ctx, uint16_t pid_in,
+		uint16_t pid_out)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_remap_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(pid_in<= TS_MAX_PID_VAL, return STAT_ERROR);
+	CHECK_DO(pid_out<= TS_MAX_PID_VAL || pid_out== TS_REMAP_PID_DROP,
+			return STAT_ERROR);
+
+	ts_remap_ctx->pid_map[pid_in]= pid_out;
+	return STAT_SUCCESS;
+}
+
+uint16_t ts_remap_get_pid(ts_remap_ctx_t *ts_remap_ctx, uint16_t pid_in)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_remap_ctx!= NULL, return TS_REMAP_PID_DROP);
+	CHECK_DO(pid_in<= TS_MAX_PID_VAL, return TS_REMAP_PID_DROP);
+
+	return ts_remap_ctx->pid_map[pid_in];
+}
+
+int ts_remap_set_psi_interval(ts_remap_ctx_t *ts_remap_ctx,
+		int interval_msec)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_remap_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(interval_msec>= 0, return STAT_ERROR);
+
+	ts_remap_ctx->psi_interval_msec= interval_msec;
+	return STAT_SUCCESS;
+}
+
+int ts_remap_set_pms(ts_remap_ctx_t *ts_remap_ctx, uint16_t pmt_pid,
+		const psi_section_ctx_t *psi_section_ctx_pms,
+		uint16_t transport_stream_id)
+{
+	int ret_code, end_code= STAT_ERROR, pat_version, pmt_version,
+			interval_msec;
+	uint16_t pmt_pid_out, program_number;
+	psi_section_ctx_t *psi_section_ctx_pmt_out= NULL,
+			*psi_section_ctx_pat_out= NULL;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_remap_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(pmt_pid> PSI_PAT_PID_NUMBER && pmt_pid< TS_MAX_PID_VAL,
+			return STAT_ERROR);
+	// Parameter 'psi_section_ctx_pms' is allowed to be NULL
+
+	LOG_CTX_SET(ts_remap_ctx->log_ctx);
+
+	/* Unset PSI re-writing if applicable */
+	if(psi_section_ctx_pms== NULL) {
+		ASSERT(pthread_mutex_lock(&ts_remap_ctx->mutex)== 0);
+		if(ts_remap_ctx->pmt_pid>= 0) {
+			ts_remap_ctx->psi_flags[ts_remap_ctx->pmt_pid]= 0;
+			ts_remap_ctx->psi_flags[PSI_PAT_PID_NUMBER]= 0;
+			ts_remap_ctx->pmt_pid= -1;
+			ts_remap_psi_unset(ts_remap_ctx);
+		}
+		ASSERT(pthread_mutex_unlock(&ts_remap_ctx->mutex)== 0);
+		return STAT_SUCCESS;
+	}
+	CHECK_DO(psi_section_ctx_pms->table_id== PSI_TABLE_TS_PROGRAM_MAP_SECTION,
+			return STAT_ERROR);
+
+	pmt_pid_out= ts_remap_ctx->pid_map[pmt_pid];
+	if(pmt_pid_out== TS_REMAP_PID_DROP) {
+		LOGE("PMT PID %u (0x%0x) should be mapped to re-write PSI\n",
+				pmt_pid, pmt_pid);
+		return STAT_EINVAL;
+	}
+	program_number= psi_section_ctx_pms->table_id_extension;
+	interval_msec= ts_remap_ctx->psi_interval_msec;
+
+	/* Re-write PMT */
+	psi_section_ctx_pmt_out= ts_remap_compose_pms(ts_remap_ctx,
+			psi_section_ctx_pms, LOG_CTX_GET());
+	CHECK_DO(psi_section_ctx_pmt_out!= NULL, goto end);
+
+	/* Set PMT version: the input version is not kept as the output contents
+	 * also depend on the PID map (version is incremented only if contents
+	 * changed).
+	 */
+	pmt_version= ts_remap_ctx->pmt_version;
+	if(pmt_version< 0)
+		pmt_version= 0;
+	else if(ts_remap_pms_cmp(ts_remap_ctx->pmt_section_oput,
+			psi_section_ctx_pmt_out)!= 0)
+		pmt_version= (pmt_version+ 1)& 0x1F;
+	psi_section_ctx_pmt_out->version_number= (uint8_t)pmt_version;
+
+	/* Compose PAT (version is incremented only if contents changed) */
+	pat_version= ts_remap_ctx->pat_version;
+	if(pat_version< 0)
+		pat_version= 0;
+	else if(ts_remap_ctx->pat_program_number!= program_number ||
+			ts_remap_ctx->pat_pmt_pid!= pmt_pid_out ||
+			ts_remap_ctx->pat_transport_stream_id!= transport_stream_id)
+		pat_version= (pat_version+ 1)& 0x1F;
+	psi_section_ctx_pat_out= ts_remap_compose_pas(program_number, pmt_pid_out,
+			transport_stream_id, (uint8_t)pat_version, LOG_CTX_GET());
+	CHECK_DO(psi_section_ctx_pat_out!= NULL, goto end);
+
+	/* Update output PSI generator cache: sections are encoded and
+	 * packetized once here (only if contents changed), and just copied on
+	 * output.
+	 */
+	ASSERT(pthread_mutex_lock(&ts_remap_ctx->mutex)== 0);
+	if(ts_remap_ctx->pmt_pid>= 0 && (ts_remap_ctx->pat_pmt_pid!= pmt_pid_out ||
+			ts_remap_ctx->pat_program_number!= program_number ||
+			ts_remap_ctx->pat_transport_stream_id!= transport_stream_id))
+		ts_remap_psi_unset(ts_remap_ctx);
+	ret_code= psi_oput_section_set(ts_remap_ctx->psi_oput_ctx,
+			psi_section_ctx_pmt_out, pmt_pid_out, interval_msec);
+	if(ret_code== STAT_SUCCESS)
+		ret_code= psi_oput_section_set(ts_remap_ctx->psi_oput_ctx,
+				psi_section_ctx_pat_out, PSI_PAT_PID_NUMBER, interval_msec);
+	if(ret_code!= STAT_SUCCESS) {
+		ASSERT(pthread_mutex_unlock(&ts_remap_ctx->mutex)== 0);
+		LOGE("Could not set re-written PSI\n");
+		goto end;
+	}
+	ts_remap_ctx->psi_interval_msec_oput= interval_msec;
+	ts_remap_ctx->pat_program_number= program_number;
+	ts_remap_ctx->pat_pmt_pid= pmt_pid_out;
+	ts_remap_ctx->pat_transport_stream_id= transport_stream_id;
+	ts_remap_ctx->pat_version= pat_version;
+	psi_section_ctx_release(&ts_remap_ctx->pmt_section_oput);
+	ts_remap_ctx->pmt_section_oput= psi_section_ctx_pmt_out;
+	psi_section_ctx_pmt_out= NULL; // Avoid double referencing
+	ts_remap_ctx->pmt_version= pmt_version;
+	if(ts_remap_ctx->pmt_pid>= 0)
+		ts_remap_ctx->psi_flags[ts_remap_ctx->pmt_pid]= 0;
+	ts_remap_ctx->pmt_pid= pmt_pid;
+	ts_remap_ctx->psi_flags[pmt_pid]= TS_REMAP_PSI_FLAG_PMT;
+	ts_remap_ctx->psi_flags[PSI_PAT_PID_NUMBER]= TS_REMAP_PSI_FLAG_PAT;
+	ASSERT(pthread_mutex_unlock(&ts_remap_ctx->mutex)== 0);
+
+	end_code= STAT_SUCCESS;
+end:
+	psi_section_ctx_release(&psi_section_ctx_pmt_out);
+	psi_section_ctx_release(&psi_section_ctx_pat_out);
+	return end_code;
+}
+
+int ts_remap_packet(ts_remap_ctx_t *ts_remap_ctx, uint8_t *pkt,
+		const uint8_t **ref_oput, size_t *ref_oput_size)
+{
+	uint16_t pid_in, pid_out;
+	uint8_t psi_flags, cc_in, cc_delta;
+	size_t psi_size= 0;
+	int ret_code;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_remap_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(pkt!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_oput!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_oput_size!= NULL, return STAT_ERROR);
+
+	*ref_oput= NULL;
+	*ref_oput_size= 0;
+
+	pid_in= TS_BUF_GET_PID(pkt);
+
+	/* Timed PSI insertion: the re-written sections which repetition is due
+	 * are output ahead of the packet.
+	 */
+	if(ts_remap_ctx->psi_interval_msec_oput> 0 && ts_remap_ctx->pmt_pid>= 0) {
+		ret_code= psi_oput_pull(ts_remap_ctx->psi_oput_ctx,
+				stc_monotonic_usec(), ts_remap_ctx->oput_buf,
+				sizeof(ts_remap_ctx->oput_buf)- TS_PKT_SIZE, &psi_size);
+		CHECK_DO(ret_code== STAT_SUCCESS, psi_size= 0);
+		ts_remap_ctx->psi_packets_output+= psi_size/ TS_PKT_SIZE;
+	}
+
+	/* PSI being re-written: input packets are dropped. If no repetition
+	 * interval is set, input packets are substituted by the pre-packetized
+	 * re-written section on each input section start (thus the input
+	 * repetition rate is kept).
+	 */
+	if((psi_flags= ts_remap_ctx->psi_flags[pid_in])!= 0) {
+		if(ts_remap_ctx->psi_interval_msec_oput> 0 ||
+				!TS_BUF_GET_START_INDICATOR(pkt))
+			goto end;
+
+		ASSERT(pthread_mutex_lock(&ts_remap_ctx->mutex)== 0);
+		if(psi_flags& TS_REMAP_PSI_FLAG_PAT)
+			ret_code= psi_oput_section_emit(ts_remap_ctx->psi_oput_ctx,
+					PSI_PAT_PID_NUMBER, PSI_TABLE_PROGRAM_ASSOCIATION_SECTION,
+					ts_remap_ctx->pat_transport_stream_id,
+					ts_remap_ctx->oput_buf, sizeof(ts_remap_ctx->oput_buf),
+					&psi_size);
+		else
+			ret_code= psi_oput_section_emit(ts_remap_ctx->psi_oput_ctx,
+					ts_remap_ctx->pat_pmt_pid,
+					PSI_TABLE_TS_PROGRAM_MAP_SECTION,
+					ts_remap_ctx->pat_program_number, ts_remap_ctx->oput_buf,
+					sizeof(ts_remap_ctx->oput_buf), &psi_size);
+		ASSERT(pthread_mutex_unlock(&ts_remap_ctx->mutex)== 0);
+		CHECK_DO(ret_code== STAT_SUCCESS, psi_size= 0);
+		ts_remap_ctx->psi_packets_output+= psi_size/ TS_PKT_SIZE;
+		goto end;
+	}
+
+	/* Drop unmapped PIDs */
+	if((pid_out= ts_remap_ctx->pid_map[pid_in])== TS_REMAP_PID_DROP) {
+		ts_remap_ctx->packets_dropped++;
+		goto end;
+	}
+
+	/* Fix-up continuity counter: keep input increments (so that duplicated
+	 * packets and discontinuities are preserved) but apply these to the
+	 * output PID counter.
+	 */
+	cc_in= TS_BUF_GET_CC(pkt);
+	cc_delta= 0;
+	if(TS_BUF_GET_PAYLOAD_FLAG(pkt)) {
+		cc_delta= (ts_remap_ctx->cc_iput[pid_in]== TS_CC_UNDEF)? 1:
+				(cc_in- ts_remap_ctx->cc_iput[pid_in])& 0x0F;
+		ts_remap_ctx->cc_iput[pid_in]= cc_in;
+	}
+
+	/* Re-write packet in place */
+	pkt[1]= (pkt[1]& 0xE0)| ((pid_out>> 8)& 0x1F);
+	pkt[2]= pid_out& 0xFF;
+	pkt[3]= (pkt[3]& 0xF0)| ts_remap_cc_next(ts_remap_ctx, pid_out, cc_delta,
+			cc_in);
+
+	ts_remap_ctx->packets_output++;
+
+	/* Output packet (appended to the PSI packets if any) */
+	if(psi_size== 0) {
+		*ref_oput= pkt;
+		*ref_oput_size= TS_PKT_SIZE;
+		return STAT_SUCCESS;
+	}
+	memcpy(&ts_remap_ctx->oput_buf[psi_size], pkt, TS_PKT_SIZE);
+	psi_size+= TS_PKT_SIZE;
+end:
+	if(psi_size> 0) {
+		*ref_oput= ts_remap_ctx->oput_buf;
+		*ref_oput_size= psi_size;
+	}
+	return STAT_SUCCESS;
+}
+
+int ts_remap_rest_get(ts_remap_ctx_t *ts_remap_ctx, cJSON **ref_cjson_remap)
+{
+	int i, end_code= STAT_ERROR;
+	cJSON *cjson_remap= NULL;
+	cJSON *cjson_aux= NULL, *cjson_pid_map= NULL,
+			*cjson_entry= NULL; // Do not release
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_remap_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_cjson_remap!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(ts_remap_ctx->log_ctx);
+
+	*ref_cjson_remap= NULL;
+
+	cjson_remap= cJSON_CreateObject();
+	CHECK_DO(cjson_remap!= NULL, goto end);
+
+	cjson_pid_map= cJSON_CreateArray();
+	CHECK_DO(cjson_pid_map!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_remap, "pid_map", cjson_pid_map);
+
+	for(i= 0; i<= TS_MAX_PID_VAL; i++) {
+		uint16_t pid_out= ts_remap_ctx->pid_map[i];
+		if(pid_out== TS_REMAP_PID_DROP)
+			continue;
+
+		cjson_entry= cJSON_CreateObject();
+		CHECK_DO(cjson_entry!= NULL, goto end);
+		cJSON_AddItemToArray(cjson_pid_map, cjson_entry);
+
+		cjson_aux= cJSON_CreateNumber((double)i);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_entry, "pid_in", cjson_aux);
+
+		cjson_aux= cJSON_CreateNumber((double)pid_out);
+		CHECK_DO(cjson_aux!= NULL, goto end);
+		cJSON_AddItemToObject(cjson_entry, "pid_out", cjson_aux);
+	}
+
+	cjson_aux= cJSON_CreateNumber((double)ts_remap_ctx->pmt_pid);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_remap, "pmt_pid", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_remap_ctx->packets_output);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_remap, "packets_output", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_remap_ctx->packets_dropped);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_remap, "packets_dropped", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_remap_ctx->psi_packets_output);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_remap, "psi_packets_output", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_remap_ctx->psi_interval_msec);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_remap, "psi_interval_msec", cjson_aux);
+
+	*ref_cjson_remap= cjson_remap;
+	cjson_remap= NULL; // Avoid double referencing
+	end_code= STAT_SUCCESS;
+end:
+	if(cjson_remap!= NULL)
+		cJSON_Delete(cjson_remap);
+	return end_code;
+}
+
+/**
+ * Compute the next continuity counter of the given output PID.
+ * If the output PID counter is still undefined, the input counter is used
+ * (if defined).
+ */
+static uint8_t ts_remap_cc_next(ts_remap_ctx_t *ts_remap_ctx,
+		uint16_t pid_out, uint8_t cc_delta, uint8_t cc_iput)
+{
+	uint8_t cc= ts_remap_ctx->cc_oput[pid_out];
+
+	if(cc== TS_CC_UNDEF)
+		cc= (cc_iput!= TS_CC_UNDEF)? cc_iput: 0;
+	else
+		cc= (cc+ cc_delta)& 0x0F;
+	ts_remap_ctx->cc_oput[pid_out]= cc;
+	return cc;
+}
+
+/**
+ * Compose the re-written Program Map Section: PCR and elementary stream PIDs
+ * are translated, and elementary streams which PID is dropped are removed.
+ */
+static psi_section_ctx_t* ts_remap_compose_pms(ts_remap_ctx_t *ts_remap_ctx,
+		const psi_section_ctx_t *psi_section_ctx_pms, log_ctx_t *log_ctx)
+{
+	int i, end_code= STAT_ERROR;
+	psi_pms_ctx_t *psi_pms_ctx; // Do not release (alias)
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Node-wise copy: elementary stream entries may be removed */
+	psi_section_ctx= psi_section_ctx_dup_nodes(psi_section_ctx_pms);
+	CHECK_DO(psi_section_ctx!= NULL, goto end);
+	psi_pms_ctx= (psi_pms_ctx_t*)psi_section_ctx->data;
+	CHECK_DO(psi_pms_ctx!= NULL, goto end);
+
+	/* PCR PID ('0x1FFF' if PCR is dropped) */
+	if(psi_pms_ctx->pcr_pid< TS_MAX_PID_VAL) {
+		uint16_t pcr_pid_out= ts_remap_ctx->pid_map[psi_pms_ctx->pcr_pid];
+		psi_pms_ctx->pcr_pid= (pcr_pid_out!= TS_REMAP_PID_DROP)? pcr_pid_out:
+				TS_MAX_PID_VAL;
+	}
+
+	/* Elementary streams */
+	for(i= 0; i< llist_len(psi_pms_ctx->psi_pms_es_ctx_llist);) {
+		uint16_t pid_out;
+		psi_pms_es_ctx_t *psi_pms_es_ctx= (psi_pms_es_ctx_t*)llist_get_nth(
+				psi_pms_ctx->psi_pms_es_ctx_llist, i);
+		CHECK_DO(psi_pms_es_ctx!= NULL, goto end);
+
+		pid_out= ts_remap_ctx->pid_map[psi_pms_es_ctx->elementary_PID];
+		if(pid_out!= TS_REMAP_PID_DROP) {
+			psi_pms_es_ctx->elementary_PID= pid_out;
+			i++;
+			continue;
+		}
+		psi_section_ctx->section_length-= 5+ psi_pms_es_ctx->es_info_length;
+		psi_pms_es_ctx= (psi_pms_es_ctx_t*)llist_remove_nth(
+				&psi_pms_ctx->psi_pms_es_ctx_llist, i);
+		psi_pms_es_ctx_release(&psi_pms_es_ctx);
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code!= STAT_SUCCESS)
+		psi_section_ctx_release(&psi_section_ctx);
+	return psi_section_ctx;
+}
+
+/**
+ * Compare two re-written Program Map Sections; the version is not compared.
+ * The input section contents are represented by the CRC (kept by
+ * 'ts_remap_compose_pms()'), and the re-mapped PIDs are compared one by one.
+ * @return Zero if sections are equal, non-zero otherwise.
+ */
+static int ts_remap_pms_cmp(const psi_section_ctx_t *psi_section_ctx1,
+		const psi_section_ctx_t *psi_section_ctx2)
+{
+	const llist_t *n1, *n2;
+	const psi_pms_ctx_t *psi_pms_ctx1, *psi_pms_ctx2;
+
+	if(psi_section_ctx1== NULL || psi_section_ctx2== NULL)
+		return 1;
+	if(psi_section_ctx1->table_id_extension!=
+			psi_section_ctx2->table_id_extension ||
+			psi_section_ctx1->section_length!=
+					psi_section_ctx2->section_length ||
+			psi_section_ctx1->crc_32!= psi_section_ctx2->crc_32)
+		return 1;
+
+	psi_pms_ctx1= (const psi_pms_ctx_t*)psi_section_ctx1->data;
+	psi_pms_ctx2= (const psi_pms_ctx_t*)psi_section_ctx2->data;
+	if(psi_pms_ctx1== NULL || psi_pms_ctx2== NULL ||
+			psi_pms_ctx1->pcr_pid!= psi_pms_ctx2->pcr_pid ||
+			psi_pms_ctx1->program_info_length!=
+					psi_pms_ctx2->program_info_length)
+		return 1;
+
+	for(n1= psi_pms_ctx1->psi_pms_es_ctx_llist,
+			n2= psi_pms_ctx2->psi_pms_es_ctx_llist; n1!= NULL && n2!= NULL;
+			n1= n1->next, n2= n2->next) {
+		const psi_pms_es_ctx_t *psi_pms_es_ctx1=
+				(const psi_pms_es_ctx_t*)n1->data;
+		const psi_pms_es_ctx_t *psi_pms_es_ctx2=
+				(const psi_pms_es_ctx_t*)n2->data;
+		if(psi_pms_es_ctx1->stream_type!= psi_pms_es_ctx2->stream_type ||
+				psi_pms_es_ctx1->elementary_PID!=
+						psi_pms_es_ctx2->elementary_PID ||
+				psi_pms_es_ctx1->es_info_length!=
+						psi_pms_es_ctx2->es_info_length)
+			return 1;
+	}
+	return (n1!= NULL || n2!= NULL);
+}
+
+/**
+ * Compose a Program Association Section with a single program.
+ */
+static psi_section_ctx_t* ts_remap_compose_pas(uint16_t program_number,
+		uint16_t pmt_pid, uint16_t transport_stream_id, uint8_t version,
+		log_ctx_t *log_ctx)
+{
+	int ret_code, end_code= STAT_ERROR;
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	psi_pas_ctx_t *psi_pas_ctx= NULL; // Do not release (alias)
+	psi_pas_prog_ctx_t *psi_pas_prog_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	psi_section_ctx= psi_section_ctx_allocate();
+	CHECK_DO(psi_section_ctx!= NULL, goto end);
+	psi_section_ctx->table_id= PSI_TABLE_PROGRAM_ASSOCIATION_SECTION;
+	psi_section_ctx->section_syntax_indicator= 1;
+	psi_section_ctx->section_length= (PSI_SECTION_FIXED_LEN- 3)+
+			PSI_PAS_PROG_LEN;
+	psi_section_ctx->table_id_extension= transport_stream_id;
+	psi_section_ctx->version_number= version;
+	psi_section_ctx->current_next_indicator= 1;
+	psi_section_ctx->section_number= 0;
+	psi_section_ctx->last_section_number= 0;
+
+	psi_section_ctx->data= psi_pas_ctx= psi_pas_ctx_allocate();
+	CHECK_DO(psi_pas_ctx!= NULL, goto end);
+
+	psi_pas_prog_ctx= psi_pas_prog_ctx_allocate();
+	CHECK_DO(psi_pas_prog_ctx!= NULL, goto end);
+	psi_pas_prog_ctx->program_number= program_number;
+	psi_pas_prog_ctx->reference_pid= pmt_pid;
+	ret_code= llist_push(&psi_pas_ctx->psi_pas_prog_ctx_llist,
+			psi_pas_prog_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	psi_pas_prog_ctx= NULL; // Avoid double referencing
+
+	end_code= STAT_SUCCESS;
+end:
+	if(psi_pas_prog_ctx!= NULL)
+		psi_pas_prog_ctx_release(&psi_pas_prog_ctx);
+	if(end_code!= STAT_SUCCESS)
+		psi_section_ctx_release(&psi_section_ctx);
+	return psi_section_ctx;
+}
+
+/**
+ * Unset the re-written PAT and PMT from the output PSI generator.
+ * Module instance MUTEX should be locked by the caller.
+ */
+static void ts_remap_psi_unset(ts_remap_ctx_t *ts_remap_ctx)
+{
+	psi_oput_section_unset(ts_remap_ctx->psi_oput_ctx,
+			ts_remap_ctx->pat_pmt_pid, PSI_TABLE_TS_PROGRAM_MAP_SECTION,
+			ts_remap_ctx->pat_program_number);
+	psi_oput_section_unset(ts_remap_ctx->psi_oput_ctx, PSI_PAT_PID_NUMBER,
+			PSI_TABLE_PROGRAM_ASSOCIATION_SECTION,
+			ts_remap_ctx->pat_transport_stream_id);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file ts_remap.h
+ * @brief MPEG2-TS PID re-mapping and filtering module.
+ * Transport packets are processed in place, one at a time: the PID is
+ * re-written according to a 8192-entry map (packets of unmapped PIDs are
+ * dropped) and the continuity counter is fixed-up per output PID. If a
+ * Program Map Section is set, the PAT and the PMT are substituted by
+ * re-written versions (PIDs translated, dropped elementary streams removed)
+ * that are encoded only once using 'psi_section_ctx_enc()' (CRC updated) and
+ * kept pre-packetized in a cache (see 'psi_oput.h'). The re-written PSI is
+ * output either at the input rate or at a fixed repetition interval.
+ * <br>
+ * Threading model: packets should always be processed from the same thread;
+ * the map and the PSI may be updated from any other thread.
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_TS_REMAP_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_TS_REMAP_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+typedef struct cJSON cJSON;
+typedef struct psi_section_ctx_s psi_section_ctx_t;
+typedef struct ts_remap_ctx_s ts_remap_ctx_t;
+
+/**
+ * PID map value used to signal that packets are to be dropped.
+ */
+#define TS_REMAP_PID_DROP 0xFFFF
+
+/* **** Prototypes **** */
+
+/**
+ * Open (allocate and initialize) a PID re-mapping module instance.
+ * All the PIDs are initially unmapped (that is, dropped).
+ * @param log_ctx Externally defined LOG module context structure instance.
+ * @return Pointer to the PID re-mapping module instance context structure
+ * on success, NULL if fails.
+ */
+ts_remap_ctx_t* ts_remap_open(log_ctx_t *log_ctx);
+
+/**
+ * Close (release) a PID re-mapping module instance.
+ * @param ref_ts_remap_ctx Reference to the pointer to the PID re-mapping
+ * module instance context structure to be released. Pointer is set to NULL
+ * on return.
+ */
+void ts_remap_close(ts_remap_ctx_t **ref_ts_remap_ctx);
+
+/**
+ * Set PID map entry.
+ * Note that the PSI (if set) is not updated by this function; call
+ * 'ts_remap_set_pms()' after modifying the map to re-compose it.
+ * @param ts_remap_ctx PID re-mapping module instance context structure.
+ * @param pid_in Input PID.
+ * @param pid_out Output PID, or TS_REMAP_PID_DROP to drop the input PID.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int ts_remap_set_pid(ts_remap_ctx_t *ts_remap_ctx, uint16_t pid_in,
+		uint16_t pid_out);
+
+/**
+ * Get PID map entry.
+ * @param ts_remap_ctx PID re-mapping module instance context structure.
+ * @param pid_in Input PID.
+ * @return Output PID, or TS_REMAP_PID_DROP if input PID is dropped.
+ */
+uint16_t ts_remap_get_pid(ts_remap_ctx_t *ts_remap_ctx, uint16_t pid_in);
+
+/**
+ * Set the repetition interval of the re-written PSI.
+ * If zero (default), input PAT and PMT packets are substituted by the
+ * re-written sections on each input section start (the input repetition
+ * rate is kept); otherwise the input PAT and PMT are dropped and the
+ * re-written sections are inserted with the given interval.
+ * The interval takes effect on the next call to 'ts_remap_set_pms()'.
+ * @param ts_remap_ctx PID re-mapping module instance context structure.
+ * @param interval_msec Repetition interval in milliseconds.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int ts_remap_set_psi_interval(ts_remap_ctx_t *ts_remap_ctx,
+		int interval_msec);
+
+/**
+ * Set the Program Map Section of the program being re-mapped.
+ * The PMT is re-written translating the PCR and elementary stream PIDs (the
+ * elementary streams which PID is dropped are removed) and a PAT with the
+ * only re-mapped program is composed; both are encoded and packetized once,
+ * and output in place of the input PAT and PMT packets respectively.
+ * @param ts_remap_ctx PID re-mapping module instance context structure.
+ * @param pmt_pid Input PMT PID.
+ * @param psi_section_ctx_pms Program Map Section; NULL to unset PSI
+ * re-writing (input PAT and PMT are then re-mapped as any other PID).
+ * @param transport_stream_id Transport stream identifier of the output PAT.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int ts_remap_set_pms(ts_remap_ctx_t *ts_remap_ctx, uint16_t pmt_pid,
+		const psi_section_ctx_t *psi_section_ctx_pms,
+		uint16_t transport_stream_id);
+
+/**
+ * Process an input MPEG2-TS packet.
+ * @param ts_remap_ctx PID re-mapping module instance context structure.
+ * @param pkt Binary MPEG2-TS packet (188 bytes). PID and continuity counter
+ * are re-written in place.
+ * @param ref_oput Reference to the pointer to the output data to be
+ * returned: either 'pkt', or the re-written PSI packets (followed by the
+ * re-written packet if the PSI is inserted with a repetition interval; in
+ * this last case the buffer belongs to the module instance and is valid
+ * until the next call to this function).
+ * @param ref_oput_size Reference to the size of the output data to be
+ * returned (a multiple of 188 bytes); zero if packet is dropped.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int ts_remap_packet(ts_remap_ctx_t *ts_remap_ctx, uint8_t *pkt,
+		const uint8_t **ref_oput, size_t *ref_oput_size);
+
+/**
+ * Get PID re-mapping representational state.
+ * The cJSON object returned has the following structure:
+ * @code
+ * {
+ *     "pid_map":[{"pid_in":number, "pid_out":number}, ...],
+ *     "pmt_pid":number, -input PMT PID; -1 if PSI re-writing is not set-
+ *     "packets_output":number,
+ *     "packets_dropped":number,
+ *     "psi_packets_output":number,
+ *     "psi_interval_msec":number
+ * }
+ * @endcode
+ * @param ts_remap_ctx PID re-mapping module instance context structure.
+ * @param ref_cjson_remap Reference to the pointer to the cJSON object to be
+ * returned.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int ts_remap_rest_get(ts_remap_ctx_t *ts_remap_ctx, cJSON **ref_cjson_remap);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_TS_REMAP_H_ */
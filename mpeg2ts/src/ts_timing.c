@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file ts_timing.c
+ * @author Rafael Antoniello
+ */
+
+#include "ts_timing.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <libcjson/cJSON.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include "ts.h"
+#include "ts_dec.h"
+#include "stc.h"
+
+/* **** Definitions **** */
+
+/**
+ * PID flags used for the packet path look-up table.
+ */
+#define TS_TIMING_PID_FLAG_ES 	(1<< 0)
+#define TS_TIMING_PID_FLAG_PCR 	(1<< 1)
+
+/**
+ * Time-stamp (33 bits) difference, taking wrap-around into account.
+ * Result is in the range [-2^32, 2^32).
+ */
+#define TS_TIMING_33BIT_MASK ((int64_t)0x1FFFFFFFF)
+#define TS_TIMING_33BIT_DIFF(A, B) \
+	((((A)- (B))& TS_TIMING_33BIT_MASK)>= ((int64_t)1<< 32)?\
+	 (((A)- (B))& TS_TIMING_33BIT_MASK)- ((int64_t)1<< 33):\
+	 (((A)- (B))& TS_TIMING_33BIT_MASK))
+
+/**
+ * Elementary stream timing context structure.
+ */
+typedef struct ts_timing_es_ctx_s {
+	/**
+	 * PCR PID of the program this elementary stream belongs to.
+	 */
+	uint16_t pcr_pid;
+	/**
+	 * Elementary stream type (as signaled in the PMT).
+	 */
+	uint8_t stream_type;
+	/**
+	 * Registering cycle in which this elementary stream was last registered.
+	 */
+	uint32_t update_cycle;
+	/**
+	 * Number of PES headers carrying time-stamps parsed.
+	 */
+	uint64_t pes_count;
+	/**
+	 * Last PTS and DTS parsed (90KHz units).
+	 */
+	int64_t last_pts;
+	int64_t last_dts;
+	/**
+	 * Set to non-zero when at least one time-stamp to PCR offset was
+	 * computed (that is, offsets fields below are valid).
+	 */
+	int flag_offsets_valid;
+	/**
+	 * Last time-stamps to PCR offsets (90KHz units).
+	 */
+	int64_t pts_pcr_offset;
+	int64_t dts_pcr_offset;
+	/**
+	 * Minimum and maximum DTS to PCR offsets registered (90KHz units).
+	 */
+	int64_t dts_pcr_offset_min;
+	int64_t dts_pcr_offset_max;
+} ts_timing_es_ctx_t;
+
+/**
+ * Timing module instance context structure.
+ */
+typedef struct ts_timing_ctx_s {
+	/**
+	 * Externally defined LOG module context structure instance.
+	 */
+	log_ctx_t *log_ctx;
+	/**
+	 * Module instance critical section MUTEX.
+	 * Note that the packet path look-up table ('pid_flags') is read without
+	 * locking; MUTEX is only taken for PCR and PES-start packets of tracked
+	 * PIDs.
+	 */
+	pthread_mutex_t mutex;
+	/**
+	 * Packet path look-up table (see TS_TIMING_PID_FLAG_* flags).
+	 */
+	volatile uint8_t pid_flags[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Last PCR base (90KHz units) received on each PCR PID.
+	 */
+	int64_t last_pcr_base[TS_MAX_PID_VAL+ 1];
+	/**
+	 * STC estimators of each PCR PID (allocated on the first PCR received;
+	 * released when PID is no longer referenced as PCR PID).
+	 */
+	stc_ctx_t *stc_ctx_array[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Registered elementary streams (indexed by PID).
+	 */
+	ts_timing_es_ctx_t *ts_timing_es_ctx_array[TS_MAX_PID_VAL+ 1];
+	/**
+	 * Current registering cycle.
+	 */
+	uint32_t update_cycle;
+} ts_timing_ctx_t;
+
+/* **** Prototypes **** */
+
+static void ts_timing_es_ctx_reset(ts_timing_es_ctx_t *ts_timing_es_ctx,
+		uint16_t pcr_pid, uint8_t stream_type);
+static cJSON* ts_timing_es_rest_get(const ts_timing_es_ctx_t *ts_timing_es_ctx,
+		uint16_t pid, stc_ctx_t *stc_ctx, log_ctx_t *log_ctx);
+
+/* **** Implementations **** */
+
+ts_timing_ctx_t* ts_timing_open(log_ctx_t *log_ctx)
+{
+	int i, ret_code;
+	ts_timing_ctx_t *ts_timing_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Allocate context structure */
+	ts_timing_ctx= (ts_timing_ctx_t*)calloc(1, sizeof(ts_timing_ctx_t));
+	CHECK_DO(ts_timing_ctx!= NULL, return NULL);
+
+	ts_timing_ctx->log_ctx= log_ctx;
+
+	/* Initialize MUTEX (on failure we can not use 'ts_timing_close()') */
+	ret_code= pthread_mutex_init(&ts_timing_ctx->mutex, NULL);
+	CHECK_DO(ret_code== 0, free(ts_timing_ctx); return NULL);
+
+	for(i= 0; i<= TS_MAX_PID_VAL; i++)
+		ts_timing_ctx->last_pcr_base[i]= TS_TIMESTAMP_INVALID;
+
+	return ts_timing_ctx;
+}
+
+void ts_timing_close(ts_timing_ctx_t **ref_ts_timing_ctx)
+{
+	int i;
+	ts_timing_ctx_t *ts_timing_ctx;
+
+	if(ref_ts_timing_ctx== NULL ||
+			(ts_timing_ctx= *ref_ts_timing_ctx)== NULL)
+		return;
+
+	for(i= 0; i<= TS_MAX_PID_VAL; i++) {
+		if(ts_timing_ctx->ts_timing_es_ctx_array[i]!= NULL) {
+			free(ts_timing_ctx->ts_timing_es_ctx_array[i]);
+			ts_timing_ctx->ts_timing_es_ctx_array[i]= NULL;
+		}
+		stc_close(&ts_timing_ctx->stc_ctx_array[i]);
+	}
+
+	ASSERT(pthread_mutex_destroy(&ts_timing_ctx->mutex)== 0);
+
+	free(ts_timing_ctx);
+	*ref_ts_timing_ctx= NULL;
+}
+
+void ts_timing_es_update_begin(ts_timing_ctx_t *ts_timing_ctx)
+{
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_timing_ctx!= NULL, return);
+
+	ASSERT(pthread_mutex_lock(&ts_timing_ctx->mutex)== 0);
+	ts_timing_ctx->update_cycle++;
+	ASSERT(pthread_mutex_unlock(&ts_timing_ctx->mutex)== 0);
+}
+
+int ts_timing_es_register(ts_timing_ctx_t *ts_timing_ctx, uint16_t es_pid,
+		uint16_t pcr_pid, uint8_t stream_type)
+{
+	ts_timing_es_ctx_t *ts_timing_es_ctx;
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_timing_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(es_pid< TS_MAX_PID_VAL, return STAT_ERROR);
+	CHECK_DO(pcr_pid<= TS_MAX_PID_VAL, return STAT_ERROR);
+
+	LOG_CTX_SET(ts_timing_ctx->log_ctx);
+
+	ASSERT(pthread_mutex_lock(&ts_timing_ctx->mutex)== 0);
+
+	ts_timing_es_ctx= ts_timing_ctx->ts_timing_es_ctx_array[es_pid];
+	if(ts_timing_es_ctx== NULL) {
+		ts_timing_es_ctx= (ts_timing_es_ctx_t*)calloc(1, sizeof(
+				ts_timing_es_ctx_t));
+		CHECK_DO(ts_timing_es_ctx!= NULL, goto end);
+		ts_timing_es_ctx_reset(ts_timing_es_ctx, pcr_pid, stream_type);
+		ts_timing_ctx->ts_timing_es_ctx_array[es_pid]= ts_timing_es_ctx;
+	} else if(ts_timing_es_ctx->pcr_pid!= pcr_pid ||
+			ts_timing_es_ctx->stream_type!= stream_type) {
+		/* Elementary stream was re-assigned; reset statistics */
+		ts_timing_es_ctx_reset(ts_timing_es_ctx, pcr_pid, stream_type);
+	}
+	ts_timing_es_ctx->update_cycle= ts_timing_ctx->update_cycle;
+
+	/* Update packet path look-up table */
+	ts_timing_ctx->pid_flags[es_pid]|= TS_TIMING_PID_FLAG_ES;
+	ts_timing_ctx->pid_flags[pcr_pid]|= TS_TIMING_PID_FLAG_PCR;
+
+	end_code= STAT_SUCCESS;
+end:
+	ASSERT(pthread_mutex_unlock(&ts_timing_ctx->mutex)== 0);
+	return end_code;
+}
+
+void ts_timing_es_update_end(ts_timing_ctx_t *ts_timing_ctx)
+{
+	int i;
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_timing_ctx!= NULL, return);
+
+	ASSERT(pthread_mutex_lock(&ts_timing_ctx->mutex)== 0);
+
+	/* Clear PCR flags; we recompute these from the registered ES's */
+	for(i= 0; i<= TS_MAX_PID_VAL; i++)
+		ts_timing_ctx->pid_flags[i]&= ~TS_TIMING_PID_FLAG_PCR;
+
+	/* Unregister elementary streams not registered in this cycle */
+	for(i= 0; i<= TS_MAX_PID_VAL; i++) {
+		ts_timing_es_ctx_t *ts_timing_es_ctx=
+				ts_timing_ctx->ts_timing_es_ctx_array[i];
+		if(ts_timing_es_ctx== NULL)
+			continue;
+		if(ts_timing_es_ctx->update_cycle!= ts_timing_ctx->update_cycle) {
+			ts_timing_ctx->pid_flags[i]&= ~TS_TIMING_PID_FLAG_ES;
+			free(ts_timing_es_ctx);
+			ts_timing_ctx->ts_timing_es_ctx_array[i]= NULL;
+			continue;
+		}
+		ts_timing_ctx->pid_flags[ts_timing_es_ctx->pcr_pid]|=
+				TS_TIMING_PID_FLAG_PCR;
+	}
+
+	/* Release STC estimators of the PIDs no longer used as PCR PIDs */
+	for(i= 0; i<= TS_MAX_PID_VAL; i++) {
+		if(ts_timing_ctx->stc_ctx_array[i]!= NULL &&
+				!(ts_timing_ctx->pid_flags[i]& TS_TIMING_PID_FLAG_PCR)) {
+			stc_close(&ts_timing_ctx->stc_ctx_array[i]);
+			ts_timing_ctx->last_pcr_base[i]= TS_TIMESTAMP_INVALID;
+		}
+	}
+
+	ASSERT(pthread_mutex_unlock(&ts_timing_ctx->mutex)== 0);
+}
+
+void ts_timing_packet(ts_timing_ctx_t *ts_timing_ctx, const uint8_t *pkt,
+		int64_t arrival_usec)
+{
+	uint16_t pid;
+	uint8_t pid_flags;
+	int64_t pts, dts, pcr;
+	ts_timing_es_ctx_t *ts_timing_es_ctx;
+	LOG_CTX_INIT(NULL);
+
+	if(ts_timing_ctx== NULL || pkt== NULL)
+		return;
+
+	/* Fast path: packet of a PID not being tracked */
+	pid= TS_BUF_GET_PID(pkt);
+	if((pid_flags= ts_timing_ctx->pid_flags[pid])== 0)
+		return;
+
+	LOG_CTX_SET(ts_timing_ctx->log_ctx);
+
+	/* Register PCR if applicable (and feed the program STC estimator) */
+	if(pid_flags& TS_TIMING_PID_FLAG_PCR) {
+		pcr= TS_DEC_GET_PCR(pkt)
+		if(pcr!= TS_TIMESTAMP_INVALID) {
+			/* Note that PCR flag being set implies that the adaptation field
+			 * is present and its length is non-zero.
+			 */
+			const int flag_discontinuity= (pkt[5]& 0x80)!= 0;
+
+			ASSERT(pthread_mutex_lock(&ts_timing_ctx->mutex)== 0);
+			ts_timing_ctx->last_pcr_base[pid]= pcr/ 300;
+			if(ts_timing_ctx->stc_ctx_array[pid]== NULL)
+				ts_timing_ctx->stc_ctx_array[pid]= stc_open(LOG_CTX_GET());
+			if(ts_timing_ctx->stc_ctx_array[pid]!= NULL)
+				stc_put_pcr(ts_timing_ctx->stc_ctx_array[pid], pcr,
+						arrival_usec, flag_discontinuity);
+			ASSERT(pthread_mutex_unlock(&ts_timing_ctx->mutex)== 0);
+		}
+	}
+
+	/* Peek PES time-stamps if applicable */
+	if(!(pid_flags& TS_TIMING_PID_FLAG_ES) || !TS_BUF_GET_START_INDICATOR(pkt))
+		return;
+	if(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)!= STAT_SUCCESS)
+		return;
+
+	ASSERT(pthread_mutex_lock(&ts_timing_ctx->mutex)== 0);
+	ts_timing_es_ctx= ts_timing_ctx->ts_timing_es_ctx_array[pid];
+	if(ts_timing_es_ctx!= NULL) {
+		int64_t stc;
+		const uint16_t pcr_pid= ts_timing_es_ctx->pcr_pid;
+		int64_t last_pcr_base= ts_timing_ctx->last_pcr_base[pcr_pid];
+
+		/* Use the STC at packet arrival time if the estimator is locked;
+		 * otherwise fall-back to the last PCR received.
+		 */
+		if(ts_timing_ctx->stc_ctx_array[pcr_pid]!= NULL &&
+				stc_get(ts_timing_ctx->stc_ctx_array[pcr_pid], arrival_usec,
+						&stc)== STAT_SUCCESS)
+			last_pcr_base= stc/ 300;
+
+		ts_timing_es_ctx->pes_count++;
+		ts_timing_es_ctx->last_pts= pts;
+		ts_timing_es_ctx->last_dts= dts;
+		if(last_pcr_base!= TS_TIMESTAMP_INVALID) {
+			int64_t dts_pcr_offset= TS_TIMING_33BIT_DIFF(dts, last_pcr_base);
+
+			ts_timing_es_ctx->pts_pcr_offset= TS_TIMING_33BIT_DIFF(pts,
+					last_pcr_base);
+			ts_timing_es_ctx->dts_pcr_offset= dts_pcr_offset;
+			if(!ts_timing_es_ctx->flag_offsets_valid ||
+					dts_pcr_offset< ts_timing_es_ctx->dts_pcr_offset_min)
+				ts_timing_es_ctx->dts_pcr_offset_min= dts_pcr_offset;
+			if(!ts_timing_es_ctx->flag_offsets_valid ||
+					dts_pcr_offset> ts_timing_es_ctx->dts_pcr_offset_max)
+				ts_timing_es_ctx->dts_pcr_offset_max= dts_pcr_offset;
+			ts_timing_es_ctx->flag_offsets_valid= 1;
+		}
+	}
+	ASSERT(pthread_mutex_unlock(&ts_timing_ctx->mutex)== 0);
+}
+
+int ts_timing_rest_get(ts_timing_ctx_t *ts_timing_ctx,
+		cJSON **ref_cjson_es_timing)
+{
+	int i, end_code= STAT_ERROR;
+	cJSON *cjson_es_timing= NULL;
+	cJSON *cjson_es= NULL; // Do not release
+	LOG_CTX_INIT(NULL);
+
+	/* Check arguments */
+	CHECK_DO(ts_timing_ctx!= NULL, return STAT_ERROR);
+	CHECK_DO(ref_cjson_es_timing!= NULL, return STAT_ERROR);
+
+	LOG_CTX_SET(ts_timing_ctx->log_ctx);
+
+	*ref_cjson_es_timing= NULL;
+
+	cjson_es_timing= cJSON_CreateArray();
+	CHECK_DO(cjson_es_timing!= NULL, return STAT_ERROR);
+
+	ASSERT(pthread_mutex_lock(&ts_timing_ctx->mutex)== 0);
+	for(i= 0; i<= TS_MAX_PID_VAL; i++) {
+		const ts_timing_es_ctx_t *ts_timing_es_ctx=
+				ts_timing_ctx->ts_timing_es_ctx_array[i];
+		if(ts_timing_es_ctx== NULL)
+			continue;
+		cjson_es= ts_timing_es_rest_get(ts_timing_es_ctx, (uint16_t)i,
+				ts_timing_ctx->stc_ctx_array[ts_timing_es_ctx->pcr_pid],
+				LOG_CTX_GET());
+		CHECK_DO(cjson_es!= NULL, goto end);
+		cJSON_AddItemToArray(cjson_es_timing, cjson_es);
+	}
+
+	*ref_cjson_es_timing= cjson_es_timing;
+	cjson_es_timing= NULL; // Avoid double referencing
+	end_code= STAT_SUCCESS;
+end:
+	ASSERT(pthread_mutex_unlock(&ts_timing_ctx->mutex)== 0);
+	if(cjson_es_timing!= NULL)
+		cJSON_Delete(cjson_es_timing);
+	return end_code;
+}
+
+static void ts_timing_es_ctx_reset(ts_timing_es_ctx_t *ts_timing_es_ctx,
+		uint16_t pcr_pid, uint8_t stream_type)
+{
+	ts_timing_es_ctx->pcr_pid= pcr_pid;
+	ts_timing_es_ctx->stream_type= stream_type;
+	ts_timing_es_ctx->pes_count= 0;
+	ts_timing_es_ctx->last_pts= TS_TIMESTAMP_INVALID;
+	ts_timing_es_ctx->last_dts= TS_TIMESTAMP_INVALID;
+	ts_timing_es_ctx->flag_offsets_valid= 0;
+	ts_timing_es_ctx->pts_pcr_offset= 0;
+	ts_timing_es_ctx->dts_pcr_offset= 0;
+	ts_timing_es_ctx->dts_pcr_offset_min= 0;
+	ts_timing_es_ctx->dts_pcr_offset_max= 0;
+}
+
+static cJSON* ts_timing_es_rest_get(const ts_timing_es_ctx_t *ts_timing_es_ctx,
+		uint16_t pid, stc_ctx_t *stc_ctx, log_ctx_t *log_ctx)
+{
+	int end_code= STAT_ERROR;
+	cJSON *cjson_es= NULL;
+	cJSON *cjson_aux= NULL; // Do not release
+	stc_stats_ctx_t stc_stats_ctx= {0};
+	const int flag_has_offsets= ts_timing_es_ctx->flag_offsets_valid;
+	LOG_CTX_INIT(log_ctx);
+
+	if(stc_ctx!= NULL)
+		CHECK_DO(stc_get_stats(stc_ctx, &stc_stats_ctx)== STAT_SUCCESS,
+				goto end);
+
+	cjson_es= cJSON_CreateObject();
+	CHECK_DO(cjson_es!= NULL, goto end);
+
+	cjson_aux= cJSON_CreateNumber((double)pid);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "pid", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_timing_es_ctx->pcr_pid);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "pcr_pid", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_timing_es_ctx->stream_type);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "stream_type", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_timing_es_ctx->pes_count);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "pes_count", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_timing_es_ctx->last_pts);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "last_pts", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)ts_timing_es_ctx->last_dts);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "last_dts", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber(!flag_has_offsets? 0:
+			(double)ts_timing_es_ctx->pts_pcr_offset/ 90.0);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "pts_pcr_offset_msec", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber(!flag_has_offsets? 0:
+			(double)ts_timing_es_ctx->dts_pcr_offset/ 90.0);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "dts_pcr_offset_msec", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber(!flag_has_offsets? 0:
+			(double)ts_timing_es_ctx->dts_pcr_offset_min/ 90.0);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "dts_pcr_offset_min_msec", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber(!flag_has_offsets? 0:
+			(double)ts_timing_es_ctx->dts_pcr_offset_max/ 90.0);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "dts_pcr_offset_max_msec", cjson_aux);
+
+	cjson_aux= cJSON_CreateBool(stc_stats_ctx.flag_locked);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "stc_locked", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber(stc_stats_ctx.drift_ppm);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "stc_drift_ppm", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber(stc_stats_ctx.jitter_rms_usec);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "pcr_jitter_rms_usec", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)stc_stats_ctx.outliers_count);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "pcr_outliers_count", cjson_aux);
+
+	cjson_aux= cJSON_CreateNumber((double)stc_stats_ctx.discontinuities_count);
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	cJSON_AddItemToObject(cjson_es, "pcr_discontinuities_count", cjson_aux);
+
+	end_code= STAT_SUCCESS;
+end:
+	if(end_code!= STAT_SUCCESS && cjson_es!= NULL) {
+		cJSON_Delete(cjson_es);
+		cjson_es= NULL;
+	}
+	return cjson_es;
+}
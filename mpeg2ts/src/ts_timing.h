@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file ts_timing.h
+ * @brief Lightweight elementary stream timing metrics module.
+ * Time-stamps (PTS/DTS) are peeked from the PES headers at the transport
+ * stream layer (no PES re-assembly nor ES processing is performed) and are
+ * recorded against the System Time Clock (STC) of the program the elementary
+ * stream belongs to (see 'stc.h'; the last PCR received is used until the
+ * STC estimator locks).
+ * @author Rafael Antoniello
+ */
+
+#ifndef STREAMPROCESSORS_MPEG2TS_SRC_TS_TIMING_H_
+#define STREAMPROCESSORS_MPEG2TS_SRC_TS_TIMING_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/* **** Definitions **** */
+
+/* Forward declarations */
+typedef struct log_ctx_s log_ctx_t;
+typedef struct cJSON cJSON;
+typedef struct ts_timing_ctx_s ts_timing_ctx_t;
+
+/* **** Prototypes **** */
+
+/**
+ * Open (allocate and initialize) a timing metrics module instance.
+ * @param log_ctx Externally defined LOG module context structure instance.
+ * @return Pointer to the timing module instance context structure on
+ * success, NULL if fails.
+ */
+ts_timing_ctx_t* ts_timing_open(log_ctx_t *log_ctx);
+
+/**
+ * Close (release) a timing metrics module instance.
+ * @param ref_ts_timing_ctx Reference to the pointer to the timing module
+ * instance context structure to be released. Pointer is set to NULL on
+ * return.
+ */
+void ts_timing_close(ts_timing_ctx_t **ref_ts_timing_ctx);
+
+/**
+ * Start a new registering cycle of elementary streams.
+ * All the elementary streams not registered again (using
+ * 'ts_timing_es_register()') before calling 'ts_timing_es_update_end()' will
+ * be unregistered at the end of the cycle.
+ * @param ts_timing_ctx Timing module instance context structure.
+ */
+void ts_timing_es_update_begin(ts_timing_ctx_t *ts_timing_ctx);
+
+/**
+ * Register an elementary stream (ES) to be tracked.
+ * If ES was already registered with the same PCR PID and stream type, its
+ * statistics are preserved; otherwise statistics are reset.
+ * @param ts_timing_ctx Timing module instance context structure.
+ * @param es_pid Elementary stream PID.
+ * @param pcr_pid PCR PID of the program the elementary stream belongs to.
+ * @param stream_type Elementary stream type (as signaled in the PMT).
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int ts_timing_es_register(ts_timing_ctx_t *ts_timing_ctx, uint16_t es_pid,
+		uint16_t pcr_pid, uint8_t stream_type);
+
+/**
+ * End registering cycle of elementary streams.
+ * @see ts_timing_es_update_begin
+ * @param ts_timing_ctx Timing module instance context structure.
+ */
+void ts_timing_es_update_end(ts_timing_ctx_t *ts_timing_ctx);
+
+/**
+ * Process an input MPEG2-TS packet: register the PCR if the packet belongs
+ * to a tracked PCR PID, and peek the PES time-stamps if the packet belongs to
+ * a registered elementary stream and starts a new PES.
+ * This function is intended to be called on the packet path, thus costs
+ * just a table look-up for the packets not concerned. It should always be
+ * called from the same thread (single writer of the STC estimators).
+ * @param ts_timing_ctx Timing module instance context structure.
+ * @param pkt Binary MPEG2-TS packet (188 bytes).
+ * @param arrival_usec Local (monotonic) arrival time of the packet
+ * [microseconds] (see 'stc_monotonic_usec()').
+ */
+void ts_timing_packet(ts_timing_ctx_t *ts_timing_ctx, const uint8_t *pkt,
+		int64_t arrival_usec);
+
+/**
+ * Get timing metrics representational state.
+ * The cJSON array returned has the following structure:
+ * @code
+ * [
+ *     {
+ *         "pid":number,
+ *         "pcr_pid":number,
+ *         "stream_type":number,
+ *         "pes_count":number,
+ *         "last_pts":number, -90KHz units; -1 if undefined-
+ *         "last_dts":number, -90KHz units; -1 if undefined-
+ *         "pts_pcr_offset_msec":number,
+ *         "dts_pcr_offset_msec":number,
+ *         "dts_pcr_offset_min_msec":number,
+ *         "dts_pcr_offset_max_msec":number,
+ *         "stc_locked":boolean,
+ *         "stc_drift_ppm":number,
+ *         "pcr_jitter_rms_usec":number,
+ *         "pcr_outliers_count":number,
+ *         "pcr_discontinuities_count":number
+ *     },
+ *     ...
+ * ]
+ * @endcode
+ * Offsets are computed as the time-stamp minus the STC of the program at the
+ * PES arrival time; the DTS to PCR offset is a good estimation of the elementary
+ * stream buffering, while the difference of the PTS to PCR offsets of two
+ * elementary streams of the same program gives the A/V offset.
+ * @param ts_timing_ctx Timing module instance context structure.
+ * @param ref_cjson_es_timing Reference to the pointer to the cJSON array to
+ * be returned.
+ * @return Status code (STAT_SUCCESS code in case of success, for other code
+ * values please refer to .stat_codes.h).
+ */
+int ts_timing_rest_get(ts_timing_ctx_t *ts_timing_ctx,
+		cJSON **ref_cjson_es_timing);
+
+#endif /* STREAMPROCESSORS_MPEG2TS_SRC_TS_TIMING_H_ */
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_obj_pool.cpp
+ * @brief Object pools unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/obj_pool.h>
+}
+
+#define OBJ_NUM 1000
+
+static void* obj_pool_thr(void *t)
+{
+	int i;
+	void *obj_array[OBJ_NUM];
+
+	for(i= 0; i< OBJ_NUM; i++)
+		obj_array[i]= obj_pool_calloc(48);
+	for(i= 0; i< OBJ_NUM; i++)
+		obj_pool_free(obj_array[i], 48);
+	return NULL; // Thread caches are flushed at exit
+}
+
+TEST(OBJ_POOL_ALLOC_RELEASE)
+{
+	int i;
+	uint8_t *obj, *obj_prev;
+	void *obj_array[OBJ_NUM];
+	obj_pool_stats_t obj_pool_stats[OBJ_POOL_CLASS_NUM];
+	obj_pool_stats_t *stats_64= &obj_pool_stats[2]; // 64 bytes class
+	int64_t slabs;
+	pthread_t thread;
+
+	obj_pool_stats_enable(1);
+	CHECK(obj_pool_stats_enabled());
+
+	/* Released objects are reused and zeroed */
+	obj_prev= (uint8_t*)obj_pool_calloc(40);
+	CHECK(obj_prev!= NULL && ((uintptr_t)obj_prev% OBJ_POOL_OBJ_SIZE_MIN)== 0);
+	memset(obj_prev, 0xA5, 40);
+	obj_pool_free(obj_prev, 40);
+	obj= (uint8_t*)obj_pool_calloc(64); // Same size class
+	CHECK(obj== obj_prev);
+	for(i= 0; i< 64; i++)
+		CHECK(obj[i]== 0);
+
+	obj_pool_stats_get(obj_pool_stats);
+	CHECK(stats_64->object_size== 64);
+	CHECK(stats_64->objects_live== 1 && stats_64->objects_live_max>= 1);
+	CHECK(stats_64->slabs>= 1);
+	obj_pool_free(obj, 64);
+
+	/* High-water mark */
+	for(i= 0; i< OBJ_NUM; i++) {
+		obj_array[i]= obj_pool_calloc(64);
+		CHECK(obj_array[i]!= NULL);
+	}
+	for(i= 0; i< OBJ_NUM; i++)
+		obj_pool_free(obj_array[i], 64);
+	obj_pool_stats_get(obj_pool_stats);
+	CHECK(stats_64->objects_live== 0);
+	CHECK(stats_64->objects_live_max>= OBJ_NUM);
+	slabs= stats_64->slabs;
+	CHECK(slabs>= (OBJ_NUM* 64)/ OBJ_POOL_SLAB_SIZE+ 1);
+
+	/* Slabs are reused (no new slab for the same number of objects) */
+	for(i= 0; i< OBJ_NUM; i++)
+		obj_array[i]= obj_pool_calloc(64);
+	for(i= 0; i< OBJ_NUM; i++)
+		obj_pool_free(obj_array[i], 64);
+	obj_pool_stats_get(obj_pool_stats);
+	CHECK(stats_64->slabs== slabs);
+
+	/* Objects of other threads (released at thread exit) are reused */
+	CHECK(pthread_create(&thread, NULL, obj_pool_thr, NULL)== 0);
+	pthread_join(thread, NULL);
+	obj_pool_stats_get(obj_pool_stats);
+	CHECK(stats_64->objects_live== 0);
+	slabs= stats_64->slabs;
+	CHECK(pthread_create(&thread, NULL, obj_pool_thr, NULL)== 0);
+	pthread_join(thread, NULL);
+	obj_pool_stats_get(obj_pool_stats);
+	CHECK(stats_64->slabs== slabs);
+
+	/* Objects larger than the largest size class are not pooled */
+	obj= (uint8_t*)obj_pool_calloc(OBJ_POOL_OBJ_SIZE_MAX+ 1);
+	CHECK(obj!= NULL && obj[OBJ_POOL_OBJ_SIZE_MAX]== 0);
+	obj_pool_free(obj, OBJ_POOL_OBJ_SIZE_MAX+ 1);
+	obj_pool_free(NULL, 64);
+
+	obj_pool_stats_enable(0);
+	CHECK(!obj_pool_stats_enabled());
+}
@@ -31,6 +31,7 @@ extern "C" {
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <string.h>
 
 #include <libcjson/cJSON.h>
@@ -49,15 +50,23 @@ extern "C" {
 #include <libstreamprocsmpeg2ts/ts.h>
 #include <libstreamprocsmpeg2ts/ts_enc.h>
 #include <libstreamprocsmpeg2ts/prog_proc.h>
+#include <libstreamprocsmpeg2ts/prog_proc_shm.h>
 #include <libstreamprocsmpeg2ts/psi.h>
 #include <libstreamprocsmpeg2ts/psi_enc.h>
+#include <libstreamprocsmpeg2ts/psi_dec.h>
+#include <libstreamprocsmpeg2ts/psi_crc.h>
 }
 
 #define PMT_PID 99
 #define PCR_PID 100
 #define ES1_PID 100
+#define ES2_PID 101
 #define NUMBER_OF_FRAMES_IN_TEST 10
 #define FPS_IN_TEST 2
+#define PMS_ACK_TIMEOUT_MSEC 5000
+#define PROGRAM_NUMBER 12
+#define OTHER_PMT_PID 0x40
+#define TSID 0x1234
 
 TEST(PROGRAM_PROC_POST_DELETE)
 {
@@ -255,3 +264,687 @@ end:
 		free(ts_buf);
 	log_module_close();
 }
+
+TEST(PROGRAM_PROC_SHM_PSI_SLOT)
+{
+	int ret_code;
+	size_t size= 0;
+	uint32_t seq= 0, seq_prev;
+	uint8_t buf[PROG_PROC_SHM_PSI_SLOT_SIZE], section[16];
+	const char *name= "/utests-prog-proc"SUF_SH_PSI;
+	prog_proc_shm_psi_slot_t *psi_slot_parent= NULL, *psi_slot_child= NULL;
+
+	/* Parent creates the slot; child maps the same shared memory */
+	psi_slot_parent= prog_proc_shm_psi_slot_open(name, 1, NULL);
+	CHECK(psi_slot_parent!= NULL);
+	psi_slot_child= prog_proc_shm_psi_slot_open(name, 0, NULL);
+	CHECK(psi_slot_child!= NULL);
+	if(psi_slot_parent== NULL || psi_slot_child== NULL)
+		goto end;
+
+	/* Nothing written yet */
+	ret_code= prog_proc_shm_psi_slot_read(psi_slot_child, &seq, buf, &size);
+	CHECK(ret_code== STAT_NOTMODIFIED);
+
+	/* Write and read-back once */
+	memset(section, 0x02, sizeof(section));
+	ret_code= prog_proc_shm_psi_slot_write(psi_slot_parent, section,
+			sizeof(section), NULL);
+	CHECK(ret_code== STAT_SUCCESS);
+	ret_code= prog_proc_shm_psi_slot_read(psi_slot_child, &seq, buf, &size);
+	CHECK(ret_code== STAT_SUCCESS);
+	CHECK(seq!= 0 && (seq& 1)== 0);
+	CHECK(size== sizeof(section) && memcmp(buf, section, size)== 0);
+	ret_code= prog_proc_shm_psi_slot_read(psi_slot_child, &seq, buf, &size);
+	CHECK(ret_code== STAT_NOTMODIFIED);
+
+	/* Parent knows when the child applied the section */
+	CHECK(prog_proc_shm_psi_slot_is_acked(psi_slot_parent)== 0);
+	prog_proc_shm_psi_slot_ack(psi_slot_child, seq);
+	CHECK(prog_proc_shm_psi_slot_is_acked(psi_slot_parent)!= 0);
+
+	/* A new version is picked-up by comparing the sequence number */
+	seq_prev= seq;
+	section[8]= 0xFF;
+	ret_code= prog_proc_shm_psi_slot_write(psi_slot_parent, section, 12,
+			NULL);
+	CHECK(ret_code== STAT_SUCCESS);
+	ret_code= prog_proc_shm_psi_slot_read(psi_slot_child, &seq, buf, &size);
+	CHECK(ret_code== STAT_SUCCESS);
+	CHECK(seq!= seq_prev);
+	CHECK(size== 12 && buf[8]== 0xFF);
+	CHECK(prog_proc_shm_psi_slot_is_acked(psi_slot_parent)== 0);
+
+	/* Oversized sections are rejected */
+	ret_code= prog_proc_shm_psi_slot_write(psi_slot_parent, buf,
+			PROG_PROC_SHM_PSI_SLOT_SIZE+ 1, NULL);
+	CHECK(ret_code== STAT_ERROR);
+
+end:
+	prog_proc_shm_psi_slot_close(&psi_slot_child);
+	CHECK(psi_slot_child== NULL);
+	prog_proc_shm_psi_slot_close(&psi_slot_parent);
+	shm_unlink(name);
+}
+
+/**
+ * Encode a Program Map Section with the given version number and
+ * 'es_num' elementary streams (PIDs ES1_PID, ES1_PID+ 1, ...).
+ */
+static int pms_enc(uint8_t version_number, int es_num, log_ctx_t *log_ctx,
+		void **ref_buf, size_t *ref_size)
+{
+	int i, ret_code, end_code= STAT_ERROR;
+	psi_pms_es_ctx_t *psi_pms_es_ctx= NULL;
+	psi_pms_ctx_t *psi_pms_ctx=
+			NULL; // released within 'psi_section_ctx_release()'
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	LOG_CTX_INIT(log_ctx);
+
+	/* Create PMS */
+	psi_section_ctx= psi_section_ctx_allocate();
+	CHECK_DO(psi_section_ctx!= NULL, goto end);
+	psi_pms_ctx= psi_pms_ctx_allocate();
+	CHECK_DO(psi_pms_ctx!= NULL, goto end);
+	psi_section_ctx->data= psi_pms_ctx;
+	psi_pms_ctx->pcr_pid= PCR_PID;
+	psi_pms_ctx->program_info_length= 0;
+	psi_pms_ctx->psi_desc_ctx_llist= NULL;
+	psi_pms_ctx->psi_pms_es_ctx_llist= NULL;
+	psi_pms_ctx->crc_32= 0;
+	for(i= 0; i< es_num; i++) {
+		psi_pms_es_ctx= psi_pms_es_ctx_allocate();
+		CHECK_DO(psi_pms_es_ctx!= NULL, goto end);
+		psi_pms_es_ctx->stream_type= 0;
+		psi_pms_es_ctx->elementary_PID= ES1_PID+ i;
+		psi_pms_es_ctx->es_info_length= 0;
+		psi_pms_es_ctx->psi_desc_ctx_llist= NULL;
+		ret_code= llist_push(&psi_pms_ctx->psi_pms_es_ctx_llist,
+				psi_pms_es_ctx);
+		CHECK_DO(ret_code== STAT_SUCCESS, psi_pms_es_ctx_release(
+				&psi_pms_es_ctx); goto end);
+	}
+
+	/* Encode PSI section */
+	psi_section_ctx->table_id= PSI_TABLE_TS_PROGRAM_MAP_SECTION;
+	psi_section_ctx->section_syntax_indicator= 1;
+	psi_section_ctx->indicator_1= 0;
+	psi_section_ctx->reserved_1= 0;
+	psi_section_ctx->section_length= 4+ 5* es_num+ (PSI_SECTION_FIXED_LEN- 3);
+	psi_section_ctx->table_id_extension= 12;
+	psi_section_ctx->reserved_2= 0;
+	psi_section_ctx->version_number= version_number;
+	psi_section_ctx->current_next_indicator= 1;
+	psi_section_ctx->section_number= 0;
+	psi_section_ctx->last_section_number= 0;
+	psi_section_ctx->crc_32= 0; // computed within 'psi_section_ctx_enc()'
+	ret_code= psi_section_ctx_enc(psi_section_ctx, PMT_PID, LOG_CTX_GET(),
+			ref_buf, ref_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	psi_section_ctx_release(&psi_section_ctx);
+	return end_code;
+}
+
+/**
+ * Wait for the program processor task to apply the last PMS put.
+ */
+static int pms_wait_acked(procs_ctx_t *procs_ctx, int proc_id)
+{
+	int i, flag_acked= 0;
+
+	for(i= 0; i< PMS_ACK_TIMEOUT_MSEC/ 10 && flag_acked== 0; i++) {
+		if(procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_GET_PMS_ACKED", proc_id,
+				&flag_acked)!= STAT_SUCCESS)
+			return 0;
+		if(flag_acked== 0)
+			usleep(10* 1000);
+	}
+	return flag_acked;
+}
+
+TEST(PROGRAM_PROC_PUT_PMS)
+{
+	int ret_code, flag_acked= 0, proc_id= -1;
+	procs_ctx_t *procs_ctx= NULL;
+	char *rest_str= NULL;
+	cJSON *cjson_rest= NULL, *cjson_aux= NULL;
+	void *psi_buf= NULL;
+	size_t psi_buf_size= 0, olen_base64= 0;
+	unsigned char *dst_base64= NULL;
+	uint8_t oversized_buf[PROG_PROC_SHM_PSI_SLOT_SIZE+ 1]= {0};
+	int end_code= STAT_ERROR;
+	const char *settings_fmt=  "{"
+		 "\"output_url\":\"234.5.5.5:2000\","
+		 "\"selected_brctrl_type_value\":0,"
+		 "\"cbr\":10000,"
+		 "\"pmt_octet_stream\":\"%s\","
+		 "\"max_ts_pcr_guard_msec\":200,"
+		 "\"min_stc_delay_output_msec\":200"
+		 "}";
+	const int settings_buf_len= 4096;
+	char settings_buf[settings_buf_len];
+	LOG_CTX_INIT(NULL);
+
+	/* Open LOG module */
+	ret_code= log_module_open();
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Open PROCS module */
+	ret_code= procs_module_open(NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED, goto end);
+
+	/* Register MPEG2-TS program processor */
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_mpeg2_prog_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Get PROCS module's instance */
+	procs_ctx= procs_open(NULL, 16, NULL, NULL);
+	CHECK_DO(procs_ctx!= NULL, goto end);
+
+	/* Compose settings with the initial PMS (version 2, one ES) */
+	ret_code= pms_enc(2, 1, LOG_CTX_GET(), &psi_buf, &psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= mbedtls_base64_encode(dst_base64, 0 /* to get length */,
+			&olen_base64, (const unsigned char*)psi_buf, psi_buf_size);
+	CHECK_DO(ret_code== MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL && olen_base64> 0,
+			goto end);
+	dst_base64= (unsigned char*)calloc(1, olen_base64+ 1);
+	CHECK_DO(dst_base64!= NULL, goto end);
+	ret_code= mbedtls_base64_encode(dst_base64, olen_base64, &olen_base64,
+			(const unsigned char*)psi_buf, psi_buf_size);
+	CHECK_DO(ret_code== 0, goto end);
+	CHECK_DO(snprintf(settings_buf, settings_buf_len, settings_fmt,
+			dst_base64)< settings_buf_len, goto end);
+	free(psi_buf);
+	psi_buf= NULL;
+
+	/* Create program-processor instance (forked task) */
+	ret_code= procs_opt(procs_ctx, "PROCS_POST", "prog_proc", settings_buf,
+			&rest_str);
+	CHECK_DO(ret_code== STAT_SUCCESS && rest_str!= NULL, goto end);
+	cjson_rest= cJSON_Parse(rest_str);
+	CHECK_DO(cjson_rest!= NULL, goto end);
+	cjson_aux= cJSON_GetObjectItem(cjson_rest, "proc_id");
+	CHECK_DO(cjson_aux!= NULL && (proc_id= cjson_aux->valuedouble)>= 0,
+			goto end);
+
+	/* The running task picks-up the initial PMS */
+	CHECK_DO(pms_wait_acked(procs_ctx, proc_id)!= 0, goto end);
+
+	/* Put a new PMS version (one ES added); the running task applies it */
+	ret_code= pms_enc(3, 2, LOG_CTX_GET(), &psi_buf, &psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_PUT_PMS", proc_id,
+			(const uint8_t*)psi_buf, psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(pms_wait_acked(procs_ctx, proc_id)!= 0, goto end);
+
+	/* Oversized sections are rejected (last PMS is kept) */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_PUT_PMS", proc_id,
+			(const uint8_t*)oversized_buf, sizeof(oversized_buf));
+	CHECK_DO(ret_code== STAT_ERROR, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_GET_PMS_ACKED",
+			proc_id, &flag_acked);
+	CHECK_DO(ret_code== STAT_SUCCESS && flag_acked!= 0, goto end);
+
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= -1;
+
+	ret_code= procs_module_opt("PROCS_UNREGISTER_TYPE", "prog_proc");
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	CHECK(end_code== STAT_SUCCESS);
+	if(procs_ctx!= NULL && proc_id>= 0)
+		procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	if(procs_ctx!= NULL)
+		procs_close(&procs_ctx);
+	procs_module_close();
+	if(rest_str!= NULL)
+		free(rest_str);
+	if(cjson_rest!= NULL)
+		cJSON_Delete(cjson_rest);
+	if(psi_buf!= NULL)
+		free(psi_buf);
+	if(dst_base64!= NULL)
+		free(dst_base64);
+	log_module_close();
+}
+
+/**
+ * Compose a TS packet carrying the given (single packet) PSI section; if
+ * 'section' is NULL, a packet with a non-PSI payload is composed.
+ */
+static void pkt_compose(uint8_t *pkt, uint16_t pid, uint8_t cc,
+		const void *section, size_t section_size)
+{
+	memset(pkt, 0xFF, TS_PKT_SIZE);
+	pkt[0]= 0x47;
+	pkt[1]= (section!= NULL? 0x40: 0x00)| ((pid>> 8)& 0x1F);
+	pkt[2]= pid& 0xFF;
+	pkt[3]= 0x10| (cc& 0x0F);
+	if(section== NULL) {
+		pkt[TS_PKT_PREFIX_LEN]= cc; // we use the first byte as a counter
+		return;
+	}
+	pkt[TS_PKT_PREFIX_LEN]= 0; // 'pointer_field'
+	memcpy(&pkt[TS_PKT_PREFIX_LEN+ 1], section, section_size);
+}
+
+/**
+ * Compose the input PAT packet: two programs, the one under test
+ * (PROGRAM_NUMBER, PMT_PID) and another one (OTHER_PMT_PID).
+ */
+static void pat_pkt_compose(uint8_t *pkt, uint8_t cc)
+{
+	uint32_t crc;
+	uint8_t pas[]= {
+		0x00, 0xB0, 0x11, (TSID>> 8)& 0xFF, TSID& 0xFF, 0xC1, 0x00, 0x00,
+		0x00, PROGRAM_NUMBER, 0xE0| (PMT_PID>> 8), PMT_PID& 0xFF,
+		0x00, PROGRAM_NUMBER+ 1, 0xE0| (OTHER_PMT_PID>> 8),
+		OTHER_PMT_PID& 0xFF,
+		0x00, 0x00, 0x00, 0x00
+	};
+
+	crc= psi_crc32(pas, sizeof(pas)- 4);
+	pas[sizeof(pas)- 4]= (uint8_t)(crc>> 24);
+	pas[sizeof(pas)- 3]= (uint8_t)(crc>> 16);
+	pas[sizeof(pas)- 2]= (uint8_t)(crc>> 8);
+	pas[sizeof(pas)- 1]= (uint8_t)crc;
+	pkt_compose(pkt, 0, cc, pas, sizeof(pas));
+}
+
+/**
+ * Create a program-processor instance (Id. PMT_PID) running in passthrough
+ * mode (no bit-rate control, PCR guard nor STC delay is requested) with the
+ * given PMS and transport stream identifier.
+ */
+static int prog_proc_passthrough_post(procs_ctx_t *procs_ctx,
+		const void *psi_buf, size_t psi_buf_size, int transport_stream_id,
+		log_ctx_t *log_ctx)
+{
+	int ret_code, proc_id= -1;
+	size_t olen_base64= 0;
+	unsigned char *dst_base64= NULL;
+	char *rest_str= NULL;
+	cJSON *cjson_rest= NULL, *cjson_aux= NULL;
+	char settings_buf[1024];
+	LOG_CTX_INIT(log_ctx);
+
+	ret_code= mbedtls_base64_encode(dst_base64, 0 /* to get length */,
+			&olen_base64, (const unsigned char*)psi_buf, psi_buf_size);
+	CHECK_DO(ret_code== MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL && olen_base64> 0,
+			goto end);
+	dst_base64= (unsigned char*)calloc(1, olen_base64+ 1);
+	CHECK_DO(dst_base64!= NULL, goto end);
+	ret_code= mbedtls_base64_encode(dst_base64, olen_base64, &olen_base64,
+			(const unsigned char*)psi_buf, psi_buf_size);
+	CHECK_DO(ret_code== 0, goto end);
+	CHECK_DO(snprintf(settings_buf, sizeof(settings_buf),
+			"forced_proc_id=%d&pmt_octet_stream=%s&transport_stream_id=%d",
+			PMT_PID, dst_base64, transport_stream_id)<
+					(int)sizeof(settings_buf), goto end);
+
+	ret_code= procs_opt(procs_ctx, "PROCS_POST", "prog_proc", settings_buf,
+			&rest_str);
+	CHECK_DO(ret_code== STAT_SUCCESS && rest_str!= NULL, goto end);
+	cjson_rest= cJSON_Parse(rest_str);
+	CHECK_DO(cjson_rest!= NULL, goto end);
+	cjson_aux= cJSON_GetObjectItem(cjson_rest, "proc_id");
+	CHECK_DO(cjson_aux!= NULL, goto end);
+	proc_id= cjson_aux->valuedouble;
+end:
+	if(dst_base64!= NULL)
+		free(dst_base64);
+	if(rest_str!= NULL)
+		free(rest_str);
+	if(cjson_rest!= NULL)
+		cJSON_Delete(cjson_rest);
+	return proc_id;
+}
+
+/**
+ * Send one packet to the program processor.
+ */
+static int pkt_send(procs_ctx_t *procs_ctx, int proc_id, const uint8_t *pkt)
+{
+	proc_frame_ctx_t proc_frame_ctx= {0};
+
+	proc_frame_ctx.data= (uint8_t*)pkt;
+	proc_frame_ctx.p_data[0]= pkt;
+	proc_frame_ctx.linesize[0]= TS_PKT_SIZE;
+	proc_frame_ctx.width[0]= TS_PKT_SIZE;
+	proc_frame_ctx.height[0]= 1;
+	proc_frame_ctx.proc_sample_fmt= PROC_IF_FMT_UNDEF;
+	proc_frame_ctx.pts= -1;
+	proc_frame_ctx.dts= -1;
+	proc_frame_ctx.es_id= proc_id;
+	return procs_send_frame(procs_ctx, proc_id, &proc_frame_ctx);
+}
+
+/**
+ * Receive one output packet from the program processor.
+ */
+static int pkt_recv(procs_ctx_t *procs_ctx, int proc_id, uint8_t *pkt)
+{
+	int ret_code;
+	proc_frame_ctx_t *proc_frame_ctx= NULL;
+
+	ret_code= procs_recv_frame(procs_ctx, proc_id, &proc_frame_ctx);
+	if(ret_code!= STAT_SUCCESS || proc_frame_ctx== NULL)
+		return STAT_ERROR;
+	if(proc_frame_ctx->width[0]!= TS_PKT_SIZE ||
+			proc_frame_ctx->p_data[0]== NULL) {
+		proc_frame_ctx_release(&proc_frame_ctx);
+		return STAT_ERROR;
+	}
+	memcpy(pkt, proc_frame_ctx->p_data[0], TS_PKT_SIZE);
+	proc_frame_ctx_release(&proc_frame_ctx);
+	return STAT_SUCCESS;
+}
+
+/**
+ * Decode the section carried in the given (single) TS packet.
+ */
+static psi_section_ctx_t* pkt_section_dec(const uint8_t *pkt)
+{
+	uint8_t buf[TS_PKT_SIZE];
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	const uint8_t *section= &pkt[TS_PKT_PREFIX_LEN+ 1+ pkt[TS_PKT_PREFIX_LEN]];
+	size_t size= 3+ (((section[1]& 0x0F)<< 8)| section[2]);
+
+	if(TS_BUF_GET_START_INDICATOR(pkt)== 0 ||
+			section+ size> pkt+ TS_PKT_SIZE)
+		return NULL;
+	memcpy(buf, section, size);
+	if(psi_dec_section(buf, size, TS_BUF_GET_PID(pkt), NULL,
+			&psi_section_ctx)!= STAT_SUCCESS)
+		return NULL;
+	return psi_section_ctx;
+}
+
+/**
+ * Send the input PAT and check the re-written one: only the program under
+ * test is listed, with the given transport stream identifier.
+ */
+static int pat_check(procs_ctx_t *procs_ctx, int proc_id, uint8_t cc,
+		int transport_stream_id)
+{
+	int end_code= STAT_ERROR;
+	uint8_t pkt[TS_PKT_SIZE];
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	psi_pas_ctx_t *psi_pas_ctx;
+	psi_pas_prog_ctx_t *psi_pas_prog_ctx;
+	LOG_CTX_INIT(NULL);
+
+	pat_pkt_compose(pkt, cc);
+	CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	CHECK_DO(pkt_recv(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	CHECK_DO(TS_BUF_GET_PID(pkt)== 0, goto end);
+	psi_section_ctx= pkt_section_dec(pkt); // CRC is checked
+	CHECK_DO(psi_section_ctx!= NULL, goto end);
+	CHECK_DO(psi_section_ctx->table_id_extension== transport_stream_id,
+			goto end);
+	psi_pas_ctx= (psi_pas_ctx_t*)psi_section_ctx->data;
+	CHECK_DO(psi_pas_ctx!= NULL &&
+			llist_len(psi_pas_ctx->psi_pas_prog_ctx_llist)== 1, goto end);
+	psi_pas_prog_ctx= (psi_pas_prog_ctx_t*)
+			psi_pas_ctx->psi_pas_prog_ctx_llist->data;
+	CHECK_DO(psi_pas_prog_ctx->program_number== PROGRAM_NUMBER, goto end);
+	CHECK_DO(psi_pas_prog_ctx->reference_pid== PMT_PID, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	psi_section_ctx_release(&psi_section_ctx);
+	return end_code;
+}
+
+/**
+ * Send the given input PMS and check the re-written one lists the given
+ * number of elementary streams with the given version.
+ */
+static int pmt_check(procs_ctx_t *procs_ctx, int proc_id, uint8_t cc,
+		const void *psi_buf, size_t psi_buf_size, int es_num,
+		uint8_t version_number)
+{
+	int i, end_code= STAT_ERROR;
+	llist_t *n;
+	uint8_t pkt[TS_PKT_SIZE];
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	psi_pms_ctx_t *psi_pms_ctx;
+	LOG_CTX_INIT(NULL);
+
+	pkt_compose(pkt, PMT_PID, cc, psi_buf, psi_buf_size);
+	CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	CHECK_DO(pkt_recv(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	CHECK_DO(TS_BUF_GET_PID(pkt)== PMT_PID, goto end);
+	psi_section_ctx= pkt_section_dec(pkt);
+	CHECK_DO(psi_section_ctx!= NULL, goto end);
+	CHECK_DO(psi_section_ctx->table_id_extension== 12, goto end);
+	CHECK_DO(psi_section_ctx->version_number== version_number, goto end);
+	psi_pms_ctx= (psi_pms_ctx_t*)psi_section_ctx->data;
+	CHECK_DO(psi_pms_ctx!= NULL && psi_pms_ctx->pcr_pid== PCR_PID, goto end);
+	CHECK_DO(llist_len(psi_pms_ctx->psi_pms_es_ctx_llist)== es_num,
+			goto end);
+	for(n= psi_pms_ctx->psi_pms_es_ctx_llist, i= 0; n!= NULL;
+			n= n->next, i++) {
+		psi_pms_es_ctx_t *psi_pms_es_ctx= (psi_pms_es_ctx_t*)n->data;
+		CHECK_DO(psi_pms_es_ctx!= NULL &&
+				psi_pms_es_ctx->elementary_PID== ES1_PID+ i, goto end);
+	}
+
+	end_code= STAT_SUCCESS;
+end:
+	psi_section_ctx_release(&psi_section_ctx);
+	return end_code;
+}
+
+/**
+ * Send a packet of each of the given PIDs; check that only the last one is
+ * output (the others are expected to be dropped).
+ */
+static int pids_check(procs_ctx_t *procs_ctx, int proc_id, uint8_t cc,
+		const uint16_t *pid_array, int pid_num)
+{
+	int i;
+	uint8_t pkt[TS_PKT_SIZE];
+	LOG_CTX_INIT(NULL);
+
+	for(i= 0; i< pid_num; i++) {
+		pkt_compose(pkt, pid_array[i], cc, NULL, 0);
+		CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS,
+				return STAT_ERROR);
+	}
+	CHECK_DO(pkt_recv(procs_ctx, proc_id, pkt)== STAT_SUCCESS,
+			return STAT_ERROR);
+	CHECK_DO(TS_BUF_GET_PID(pkt)== pid_array[pid_num- 1],
+			return STAT_ERROR);
+	CHECK_DO(pkt[TS_PKT_PREFIX_LEN]== cc, return STAT_ERROR);
+	return STAT_SUCCESS;
+}
+
+TEST(PROGRAM_PROC_PASSTHROUGH)
+{
+	int ret_code, flag_acked= 0, proc_id= -1;
+	procs_ctx_t *procs_ctx= NULL;
+	void *psi_buf= NULL;
+	size_t psi_buf_size= 0;
+	const uint16_t pids_es1[]= {ES1_PID};
+	const uint16_t pids_dropped[]= {ES2_PID, OTHER_PMT_PID, 0x1FFF, ES1_PID};
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(NULL);
+
+	/* Open LOG module */
+	ret_code= log_module_open();
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Open PROCS module */
+	ret_code= procs_module_open(NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED, goto end);
+
+	/* Register MPEG2-TS program processor */
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_mpeg2_prog_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Get PROCS module's instance */
+	procs_ctx= procs_open(NULL, 16, NULL, NULL);
+	CHECK_DO(procs_ctx!= NULL, goto end);
+
+	/* Create passthrough program-processor (PMS version 2, one ES) */
+	ret_code= pms_enc(2, 1, LOG_CTX_GET(), &psi_buf, &psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= prog_proc_passthrough_post(procs_ctx, psi_buf, psi_buf_size,
+			TSID, LOG_CTX_GET());
+	CHECK_DO(proc_id== PMT_PID, goto end);
+
+	/* The PMS is applied in place (no task is forked) */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_GET_PMS_ACKED",
+			proc_id, &flag_acked);
+	CHECK_DO(ret_code== STAT_SUCCESS && flag_acked!= 0, goto end);
+
+	/* Re-written PAT lists only this program; PMT is re-written with its
+	 * own version numbering.
+	 */
+	CHECK_DO(pat_check(procs_ctx, proc_id, 0, TSID)== STAT_SUCCESS,
+			goto end);
+	CHECK_DO(pmt_check(procs_ctx, proc_id, 0, psi_buf, psi_buf_size, 1, 0)==
+			STAT_SUCCESS, goto end);
+
+	/* Program packets are output; other PIDs are dropped */
+	CHECK_DO(pids_check(procs_ctx, proc_id, 0, pids_es1, 1)== STAT_SUCCESS,
+			goto end);
+	CHECK_DO(pids_check(procs_ctx, proc_id, 1, pids_dropped, 4)==
+			STAT_SUCCESS, goto end);
+
+	/* Input transport stream identifier change */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_PUT_TSID", proc_id,
+			TSID+ 1);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(pat_check(procs_ctx, proc_id, 1, TSID+ 1)== STAT_SUCCESS,
+			goto end);
+
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= -1;
+
+	ret_code= procs_module_opt("PROCS_UNREGISTER_TYPE", "prog_proc");
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	CHECK(end_code== STAT_SUCCESS);
+	if(procs_ctx!= NULL && proc_id>= 0)
+		procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	if(procs_ctx!= NULL)
+		procs_close(&procs_ctx);
+	procs_module_close();
+	if(psi_buf!= NULL)
+		free(psi_buf);
+	log_module_close();
+}
+
+TEST(PROGRAM_PROC_PASSTHROUGH_PUT_PMS)
+{
+	int ret_code, flag_acked= 0, proc_id= -1;
+	procs_ctx_t *procs_ctx= NULL;
+	void *psi_buf= NULL;
+	size_t psi_buf_size= 0;
+	const uint16_t pids_es2[]= {ES2_PID};
+	const uint16_t pids_es2_dropped[]= {ES2_PID, ES1_PID};
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(NULL);
+
+	/* Open LOG module */
+	ret_code= log_module_open();
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Open PROCS module */
+	ret_code= procs_module_open(NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED, goto end);
+
+	/* Register MPEG2-TS program processor */
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_mpeg2_prog_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Get PROCS module's instance */
+	procs_ctx= procs_open(NULL, 16, NULL, NULL);
+	CHECK_DO(procs_ctx!= NULL, goto end);
+
+	/* Create passthrough program-processor (PMS version 2, one ES) */
+	ret_code= pms_enc(2, 1, LOG_CTX_GET(), &psi_buf, &psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= prog_proc_passthrough_post(procs_ctx, psi_buf, psi_buf_size,
+			TSID, LOG_CTX_GET());
+	CHECK_DO(proc_id== PMT_PID, goto end);
+	free(psi_buf);
+	psi_buf= NULL;
+
+	/* Put a new PMS version (ES2 added); it is applied in place */
+	ret_code= pms_enc(3, 2, LOG_CTX_GET(), &psi_buf, &psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_PUT_PMS", proc_id,
+			(const uint8_t*)psi_buf, psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_GET_PMS_ACKED",
+			proc_id, &flag_acked);
+	CHECK_DO(ret_code== STAT_SUCCESS && flag_acked!= 0, goto end);
+
+	/* Other settings are kept: same processor, still in passthrough mode
+	 * (transport stream identifier option is accepted) and the transport
+	 * stream identifier given at creation is used.
+	 */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_PUT_TSID", proc_id,
+			TSID);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(pat_check(procs_ctx, proc_id, 0, TSID)== STAT_SUCCESS,
+			goto end);
+
+	/* Re-written PMT lists ES2 (output version incremented); ES2 packets
+	 * are output.
+	 */
+	CHECK_DO(pmt_check(procs_ctx, proc_id, 0, psi_buf, psi_buf_size, 2, 1)==
+			STAT_SUCCESS, goto end);
+	CHECK_DO(pids_check(procs_ctx, proc_id, 0, pids_es2, 1)== STAT_SUCCESS,
+			goto end);
+	free(psi_buf);
+	psi_buf= NULL;
+
+	/* Put a new PMS version (ES2 removed): output PMT version is
+	 * incremented and ES2 packets are dropped.
+	 */
+	ret_code= pms_enc(4, 1, LOG_CTX_GET(), &psi_buf, &psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PROG_PROC_PUT_PMS", proc_id,
+			(const uint8_t*)psi_buf, psi_buf_size);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(pmt_check(procs_ctx, proc_id, 1, psi_buf, psi_buf_size, 1, 2)==
+			STAT_SUCCESS, goto end);
+	CHECK_DO(pids_check(procs_ctx, proc_id, 1, pids_es2_dropped, 2)==
+			STAT_SUCCESS, goto end);
+	CHECK_DO(pat_check(procs_ctx, proc_id, 1, TSID)== STAT_SUCCESS,
+			goto end);
+
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= -1;
+
+	ret_code= procs_module_opt("PROCS_UNREGISTER_TYPE", "prog_proc");
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	CHECK(end_code== STAT_SUCCESS);
+	if(procs_ctx!= NULL && proc_id>= 0)
+		procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	if(procs_ctx!= NULL)
+		procs_close(&procs_ctx);
+	procs_module_close();
+	if(psi_buf!= NULL)
+		free(psi_buf);
+	log_module_close();
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_prog_routes.cpp
+ * @brief Program packets routing snapshot unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/llist.h>
+#include <libstreamprocsmpeg2ts/ts.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_table.h>
+#include <libstreamprocsmpeg2ts/prog_routes.h>
+}
+
+#define TSID 0x0A0B
+#define PMT_PID_1 0x20
+#define PMT_PID_2 0x30
+
+/**
+ * Append a program to the (single section) PAT.
+ */
+static void pat_prog_add(psi_table_pat_ctx_t *psi_table_pat_ctx,
+		uint16_t program_number, uint16_t pmt_pid)
+{
+	psi_section_ctx_t *psi_section_ctx;
+	psi_pas_ctx_t *psi_pas_ctx;
+	psi_pas_prog_ctx_t *psi_pas_prog_ctx= psi_pas_prog_ctx_allocate();
+
+	if(psi_table_pat_ctx->psi_section_ctx_llist== NULL) {
+		psi_section_ctx= psi_section_ctx_allocate();
+		psi_section_ctx->table_id= PSI_TABLE_PROGRAM_ASSOCIATION_SECTION;
+		psi_section_ctx->table_id_extension= TSID;
+		psi_section_ctx->data= psi_pas_ctx_allocate();
+		llist_insert_nth(&psi_table_pat_ctx->psi_section_ctx_llist, 0,
+				psi_section_ctx);
+	}
+	psi_section_ctx= (psi_section_ctx_t*)
+			psi_table_pat_ctx->psi_section_ctx_llist->data;
+	psi_pas_ctx= (psi_pas_ctx_t*)psi_section_ctx->data;
+
+	psi_pas_prog_ctx->program_number= program_number;
+	psi_pas_prog_ctx->reference_pid= pmt_pid;
+	llist_insert_nth(&psi_pas_ctx->psi_pas_prog_ctx_llist,
+			llist_len(psi_pas_ctx->psi_pas_prog_ctx_llist), psi_pas_prog_ctx);
+}
+
+/**
+ * Append a PMS to the PMT.
+ */
+static void pmt_pms_add(psi_table_pmt_ctx_t *psi_table_pmt_ctx,
+		uint16_t program_number, uint8_t version_number, uint16_t pcr_pid,
+		const uint16_t *es_pids, int es_pids_num)
+{
+	int i;
+	psi_section_ctx_t *psi_section_ctx= psi_section_ctx_allocate();
+	psi_pms_ctx_t *psi_pms_ctx= psi_pms_ctx_allocate();
+
+	psi_section_ctx->table_id= PSI_TABLE_TS_PROGRAM_MAP_SECTION;
+	psi_section_ctx->table_id_extension= program_number;
+	psi_section_ctx->version_number= version_number;
+	psi_section_ctx->data= psi_pms_ctx;
+	psi_pms_ctx->pcr_pid= pcr_pid;
+	for(i= 0; i< es_pids_num; i++) {
+		psi_pms_es_ctx_t *psi_pms_es_ctx= psi_pms_es_ctx_allocate();
+		psi_pms_es_ctx->elementary_PID= es_pids[i];
+		llist_insert_nth(&psi_pms_ctx->psi_pms_es_ctx_llist, i,
+				psi_pms_es_ctx);
+	}
+	llist_insert_nth(&psi_table_pmt_ctx->psi_section_ctx_llist,
+			llist_len(psi_table_pmt_ctx->psi_section_ctx_llist),
+			psi_section_ctx);
+}
+
+/**
+ * Return the number of program processors the given PID is routed to; if
+ * 'pmt_pid' is non-zero, checks that the PID is routed to it.
+ */
+static int routes_pid_num(const prog_routes_t *prog_routes, uint16_t pid,
+		uint16_t pmt_pid)
+{
+	uint32_t j;
+	int found= (pmt_pid== 0);
+
+	for(j= prog_routes->pid_offset_array[pid];
+			j< prog_routes->pid_offset_array[pid+ 1]; j++) {
+		if(prog_routes->pid_prog_array[j]== pmt_pid)
+			found= 1;
+	}
+	if(!found)
+		return -1;
+	return prog_routes->pid_offset_array[pid+ 1]-
+			prog_routes->pid_offset_array[pid];
+}
+
+TEST(PROG_ROUTES_ADD_REMOVE)
+{
+	const uint16_t es_pids_1[]= {0x101, 0x102};
+	const uint16_t es_pids_2[]= {0x201, 0x102}; // 0x102 shared
+	psi_table_pat_ctx_t *psi_table_pat_ctx= psi_table_ctx_allocate();
+	psi_table_pmt_ctx_t *psi_table_pmt_ctx= psi_table_ctx_allocate();
+	prog_routes_t *prog_routes= NULL, *prog_routes_prev= NULL;
+	pthread_mutex_t mutex= PTHREAD_MUTEX_INITIALIZER;
+
+	CHECK(psi_table_pat_ctx!= NULL && psi_table_pmt_ctx!= NULL);
+
+	/* Empty PAT: nothing is routed */
+	prog_routes= prog_routes_compose(psi_table_pat_ctx, psi_table_pmt_ctx,
+			NULL);
+	CHECK(prog_routes!= NULL);
+	CHECK(prog_routes->transport_stream_id== -1);
+	CHECK(prog_routes->prog_num== 0 && prog_routes->pmt_pid_num== 0);
+	CHECK(prog_routes->pid_offset_array[TS_MAX_PID_VAL+ 1]== 0);
+	prog_routes_release(&prog_routes, NULL);
+	CHECK(prog_routes== NULL);
+
+	/* Program 1 listed in the PAT, PMS not received yet: only the PMT PID
+	 * is routed.
+	 */
+	pat_prog_add(psi_table_pat_ctx, 0, 0x10); // 'network_PID' is skipped
+	pat_prog_add(psi_table_pat_ctx, 1, PMT_PID_1);
+	prog_routes_prev= prog_routes_compose(psi_table_pat_ctx,
+			psi_table_pmt_ctx, NULL);
+	CHECK(prog_routes_prev!= NULL);
+	CHECK(prog_routes_prev->transport_stream_id== TSID);
+	CHECK(prog_routes_prev->prog_num== 1);
+	CHECK(prog_routes_prev->prog_array[0].program_number== 1);
+	CHECK(prog_routes_prev->prog_array[0].pmt_pid== PMT_PID_1);
+	CHECK(prog_routes_prev->prog_array[0].version_number== -1);
+	CHECK(prog_routes_prev->pmt_pid_num== 1 &&
+			prog_routes_prev->pmt_pid_array[0]== PMT_PID_1);
+	CHECK(routes_pid_num(prog_routes_prev, PMT_PID_1, PMT_PID_1)== 1);
+	CHECK(routes_pid_num(prog_routes_prev, 0x10, 0)== 0);
+	CHECK(routes_pid_num(prog_routes_prev, 0x101, 0)== 0);
+	CHECK(prog_routes_prev->pid_offset_array[TS_MAX_PID_VAL+ 1]== 1);
+
+	/* PMS of program 1 received: PCR and elementary streams are added */
+	pmt_pms_add(psi_table_pmt_ctx, 1, 3, 0x101, es_pids_1, 2);
+	prog_routes= prog_routes_compose(psi_table_pat_ctx, psi_table_pmt_ctx,
+			NULL);
+	CHECK(prog_routes!= NULL);
+	CHECK(!prog_routes_equal(prog_routes_prev, prog_routes));
+	CHECK(prog_routes->prog_array[0].version_number== 3);
+	CHECK(routes_pid_num(prog_routes, PMT_PID_1, PMT_PID_1)== 1);
+	CHECK(routes_pid_num(prog_routes, 0x101, PMT_PID_1)== 1); // PCR in ES
+	CHECK(routes_pid_num(prog_routes, 0x102, PMT_PID_1)== 1);
+	CHECK(prog_routes->pid_offset_array[TS_MAX_PID_VAL+ 1]== 3);
+	prog_routes_release(&prog_routes_prev, NULL);
+
+	/* Composing again the same PSI yields an equal snapshot */
+	prog_routes_prev= prog_routes;
+	prog_routes= prog_routes_compose(psi_table_pat_ctx, psi_table_pmt_ctx,
+			NULL);
+	CHECK(prog_routes!= NULL);
+	CHECK(prog_routes_equal(prog_routes_prev, prog_routes));
+	CHECK(!prog_routes_equal(NULL, prog_routes));
+	CHECK(prog_routes_equal(NULL, NULL));
+	prog_routes_release(&prog_routes_prev, NULL);
+
+	/* Program 2 added: shared elementary stream is routed to both */
+	pat_prog_add(psi_table_pat_ctx, 2, PMT_PID_2);
+	pmt_pms_add(psi_table_pmt_ctx, 2, 0, 0x201, es_pids_2, 2);
+	prog_routes_prev= prog_routes;
+	prog_routes= prog_routes_compose(psi_table_pat_ctx, psi_table_pmt_ctx,
+			NULL);
+	CHECK(prog_routes!= NULL);
+	CHECK(!prog_routes_equal(prog_routes_prev, prog_routes));
+	CHECK(prog_routes->prog_num== 2 && prog_routes->pmt_pid_num== 2);
+	CHECK(routes_pid_num(prog_routes, PMT_PID_2, PMT_PID_2)== 1);
+	CHECK(routes_pid_num(prog_routes, 0x201, PMT_PID_2)== 1);
+	CHECK(routes_pid_num(prog_routes, 0x101, PMT_PID_1)== 1);
+	CHECK(routes_pid_num(prog_routes, 0x102, PMT_PID_1)== 2);
+	CHECK(routes_pid_num(prog_routes, 0x102, PMT_PID_2)== 2);
+	prog_routes_release(&prog_routes_prev, NULL);
+
+	/* Program 1 removed from the PAT: its PIDs are no longer routed (its
+	 * PMS may still be present in the PMT).
+	 */
+	psi_table_ctx_release(&psi_table_pat_ctx);
+	psi_table_pat_ctx= psi_table_ctx_allocate();
+	pat_prog_add(psi_table_pat_ctx, 2, PMT_PID_2);
+	prog_routes_prev= prog_routes;
+	prog_routes= prog_routes_compose(psi_table_pat_ctx, psi_table_pmt_ctx,
+			NULL);
+	CHECK(prog_routes!= NULL);
+	CHECK(!prog_routes_equal(prog_routes_prev, prog_routes));
+	CHECK(prog_routes->prog_num== 1 && prog_routes->pmt_pid_num== 1);
+	CHECK(prog_routes->prog_array[0].pmt_pid== PMT_PID_2);
+	CHECK(prog_routes->pmt_pid_array[0]== PMT_PID_2);
+	CHECK(routes_pid_num(prog_routes, PMT_PID_1, 0)== 0);
+	CHECK(routes_pid_num(prog_routes, 0x101, 0)== 0);
+	CHECK(routes_pid_num(prog_routes, 0x102, PMT_PID_2)== 1);
+	CHECK(routes_pid_num(prog_routes, 0x201, PMT_PID_2)== 1);
+	CHECK(prog_routes->pid_offset_array[TS_MAX_PID_VAL+ 1]== 3);
+	prog_routes_release(&prog_routes_prev, NULL);
+
+	/* Shared (published) snapshot is freed on the last reference */
+	prog_routes->ref_cnt++;
+	prog_routes_prev= prog_routes;
+	prog_routes_release(&prog_routes_prev, &mutex);
+	CHECK(prog_routes_prev== NULL && prog_routes->ref_cnt== 1);
+	prog_routes_release(&prog_routes, &mutex);
+	CHECK(prog_routes== NULL);
+
+	psi_table_ctx_release(&psi_table_pat_ctx);
+	psi_table_ctx_release(&psi_table_pmt_ctx);
+}
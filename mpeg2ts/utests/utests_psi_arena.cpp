@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_arena.cpp
+ * @brief Arena allocated PSI sections unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/llist.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_desc.h>
+#include <libstreamprocsmpeg2ts/psi_dvb.h>
+#include <libstreamprocsmpeg2ts/psi_dec.h>
+#include <libstreamprocsmpeg2ts/psi_crc.h>
+}
+
+/**
+ * Set 'section_length' and append the CRC-32 to the raw section composed
+ * in 'buf' ('size' bytes, CRC excluded). Returns the section size.
+ */
+static size_t section_close(uint8_t *buf, size_t size)
+{
+	uint32_t crc_32;
+	size_t section_length= size- 3+ 4;
+
+	buf[1]= 0xB0| (uint8_t)(section_length>> 8);
+	buf[2]= (uint8_t)section_length;
+	crc_32= psi_crc32(buf, size);
+	buf[size++]= (uint8_t)(crc_32>> 24);
+	buf[size++]= (uint8_t)(crc_32>> 16);
+	buf[size++]= (uint8_t)(crc_32>> 8);
+	buf[size++]= (uint8_t)crc_32;
+	return size;
+}
+
+static void pms_check(const psi_section_ctx_t *psi_section_ctx)
+{
+	psi_pms_ctx_t *psi_pms_ctx= (psi_pms_ctx_t*)psi_section_ctx->data;
+	psi_pms_es_ctx_t *psi_pms_es_ctx;
+	psi_desc_ctx_t *psi_desc_ctx;
+
+	CHECK(psi_pms_ctx!= NULL);
+	if(psi_pms_ctx== NULL)
+		return;
+	CHECK(psi_pms_ctx->pcr_pid== 0x100);
+	CHECK(llist_len(psi_pms_ctx->psi_desc_ctx_llist)== 1);
+	CHECK(llist_len(psi_pms_ctx->psi_pms_es_ctx_llist)== 2);
+
+	/* Elementary streams keep the section order */
+	psi_pms_es_ctx= (psi_pms_es_ctx_t*)llist_get_nth(
+			psi_pms_ctx->psi_pms_es_ctx_llist, 0);
+	CHECK(psi_pms_es_ctx->elementary_PID== 0x100 &&
+			psi_pms_es_ctx->stream_type== 0x1B &&
+			psi_pms_es_ctx->psi_desc_ctx_llist== NULL);
+	psi_pms_es_ctx= (psi_pms_es_ctx_t*)llist_get_nth(
+			psi_pms_ctx->psi_pms_es_ctx_llist, 1);
+	CHECK(psi_pms_es_ctx->elementary_PID== 0x101 &&
+			psi_pms_es_ctx->stream_type== 0x03);
+	CHECK(llist_len(psi_pms_es_ctx->psi_desc_ctx_llist)== 2);
+	psi_desc_ctx= psi_desc_ctx_filter_tag(psi_pms_es_ctx->psi_desc_ctx_llist,
+			NULL, 0x0A);
+	CHECK(psi_desc_ctx!= NULL && psi_desc_ctx->descriptor_length== 4 &&
+			memcmp(psi_desc_ctx_get_data(psi_desc_ctx), "eng", 3)== 0);
+}
+
+TEST(PSI_ARENA_PMS)
+{
+	uint8_t buf[PSI_TABLE_MAX_SECTION_LEN];
+	size_t size= 0;
+	psi_section_ctx_t *psi_section_ctx= NULL, *psi_section_ctx_copy= NULL,
+			*psi_section_ctx_nodes= NULL;
+	psi_pms_ctx_t *psi_pms_ctx;
+	psi_pms_es_ctx_t *psi_pms_es_ctx;
+	const uint8_t pms[]= {
+		0x02, 0, 0, 0x00, 0x01, 0xC1, 0x00, 0x00, // header
+		0xE1, 0x00, 0xF0, 0x03, // PCR PID, program_info_length
+		0x52, 0x01, 0x07, // program descriptor
+		0x1B, 0xE1, 0x00, 0xF0, 0x00, // video ES
+		0x03, 0xE1, 0x01, 0xF0, 0x09, // audio ES
+		0x0A, 0x04, 'e', 'n', 'g', 0x00, // ISO 639 language descriptor
+		0x52, 0x01, 0x01 // stream identifier descriptor
+	};
+
+	memset(buf, 0xFF, sizeof(buf));
+	memcpy(buf, pms, sizeof(pms));
+	size= section_close(buf, sizeof(pms));
+
+	/* Decoded section is arena allocated */
+	CHECK(psi_dec_section(buf, size, 0x20, NULL, &psi_section_ctx)==
+			STAT_SUCCESS);
+	CHECK(psi_section_ctx!= NULL);
+	if(psi_section_ctx== NULL)
+		return;
+	CHECK(psi_section_ctx->arena_size> 0 &&
+			psi_section_ctx->arena_used<= psi_section_ctx->arena_size);
+	pms_check(psi_section_ctx);
+
+	/* Block copy is relocated: it is valid after releasing the original */
+	psi_section_ctx_copy= psi_section_ctx_dup(psi_section_ctx);
+	CHECK(psi_section_ctx_copy!= NULL && psi_section_ctx_copy->arena_size> 0);
+	psi_section_ctx_release(&psi_section_ctx);
+	CHECK(psi_section_ctx== NULL);
+	pms_check(psi_section_ctx_copy);
+
+	/* Node-wise copy can be modified */
+	psi_section_ctx_nodes= psi_section_ctx_dup_nodes(psi_section_ctx_copy);
+	CHECK(psi_section_ctx_nodes!= NULL &&
+			psi_section_ctx_nodes->arena_size== 0);
+	psi_section_ctx_release(&psi_section_ctx_copy);
+	pms_check(psi_section_ctx_nodes);
+	psi_pms_ctx= (psi_pms_ctx_t*)psi_section_ctx_nodes->data;
+	psi_pms_es_ctx= (psi_pms_es_ctx_t*)llist_remove_nth(
+			&psi_pms_ctx->psi_pms_es_ctx_llist, 0);
+	psi_pms_es_ctx_release(&psi_pms_es_ctx);
+	CHECK(llist_len(psi_pms_ctx->psi_pms_es_ctx_llist)== 1);
+	psi_section_ctx_release(&psi_section_ctx_nodes);
+
+	/* Inconsistent section layout is not arena allocated (nor decoded) */
+	buf[24]= 0x0F; // audio 'ES_info_length' out of section
+	size= section_close(buf, sizeof(pms));
+	psi_dec_section(buf, size, 0x20, NULL, &psi_section_ctx);
+	CHECK(psi_section_ctx== NULL);
+}
+
+TEST(PSI_ARENA_SDS)
+{
+	uint8_t buf[PSI_TABLE_MAX_SECTION_LEN];
+	size_t size= 0;
+	psi_section_ctx_t *psi_section_ctx= NULL, *psi_section_ctx_copy= NULL;
+	psi_dvb_sds_ctx_t *psi_dvb_sds_ctx;
+	psi_dvb_sds_prog_ctx_t *psi_dvb_sds_prog_ctx;
+	psi_desc_ctx_t *psi_desc_ctx;
+	psi_desc_dvb_service_ctx_t *psi_desc_dvb_service_ctx;
+	const uint8_t sds[]= {
+		0x42, 0, 0, 0x00, 0x01, 0xC1, 0x00, 0x00, // header
+		0x00, 0x01, 0xFF, // original_network_id, reserved
+		0x00, 0x01, 0xFC, 0x80, 0x0A, // service 1
+		0x48, 0x08, 0x01, 0x02, 'P', 'r', 0x03, 'O', 'n', 'e'
+	};
+
+	memset(buf, 0xFF, sizeof(buf));
+	memcpy(buf, sds, sizeof(sds));
+	size= section_close(buf, sizeof(sds));
+
+	CHECK(psi_dec_section(buf, size, 0x11, NULL, &psi_section_ctx)==
+			STAT_SUCCESS);
+	CHECK(psi_section_ctx!= NULL && psi_section_ctx->arena_size> 0);
+	if(psi_section_ctx== NULL)
+		return;
+
+	/* Service descriptor data is decoded on demand (out of the arena) */
+	psi_dvb_sds_ctx= (psi_dvb_sds_ctx_t*)psi_section_ctx->data;
+	psi_dvb_sds_prog_ctx= (psi_dvb_sds_prog_ctx_t*)llist_get_nth(
+			psi_dvb_sds_ctx->psi_dvb_sds_prog_ctx_llist, 0);
+	CHECK(psi_dvb_sds_prog_ctx!= NULL &&
+			psi_dvb_sds_prog_ctx->service_id== 1);
+	psi_desc_ctx= psi_desc_ctx_filter_tag(
+			psi_dvb_sds_prog_ctx->psi_desc_ctx_llist, NULL,
+			PSI_DESC_TAG_DVB_SERVICE);
+	CHECK(psi_desc_ctx!= NULL);
+	psi_desc_dvb_service_ctx= (psi_desc_dvb_service_ctx_t*)
+			psi_desc_ctx_get_data(psi_desc_ctx);
+	CHECK(psi_desc_dvb_service_ctx!= NULL &&
+			strcmp(psi_desc_dvb_service_ctx->service_name, "One")== 0);
+
+	/* The copy decodes its own descriptor data */
+	psi_section_ctx_copy= psi_section_ctx_dup(psi_section_ctx);
+	CHECK(psi_section_ctx_copy!= NULL);
+	psi_section_ctx_release(&psi_section_ctx);
+	psi_dvb_sds_ctx= (psi_dvb_sds_ctx_t*)psi_section_ctx_copy->data;
+	psi_dvb_sds_prog_ctx= (psi_dvb_sds_prog_ctx_t*)llist_get_nth(
+			psi_dvb_sds_ctx->psi_dvb_sds_prog_ctx_llist, 0);
+	psi_desc_ctx= psi_desc_ctx_filter_tag(
+			psi_dvb_sds_prog_ctx->psi_desc_ctx_llist, NULL,
+			PSI_DESC_TAG_DVB_SERVICE);
+	CHECK(psi_desc_ctx!= NULL);
+	psi_desc_dvb_service_ctx= (psi_desc_dvb_service_ctx_t*)
+			psi_desc_ctx_get_data(psi_desc_ctx);
+	CHECK(psi_desc_dvb_service_ctx!= NULL &&
+			strcmp(psi_desc_dvb_service_ctx->service_provider_name, "Pr")==
+					0);
+	psi_section_ctx_release(&psi_section_ctx_copy);
+	CHECK(psi_section_ctx_copy== NULL);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file utests_psi_crc.cpp
+ * @brief CRC-32/MPEG-2 module unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libstreamprocsmpeg2ts/psi_crc.h>
+}
+
+#define CRC_TEST_BUF_SIZE 4096
+#define CRC_TEST_ITERATIONS 1000
+
+TEST(PSI_CRC32_KERNELS)
+{
+	int i, kernel;
+	uint8_t buf[CRC_TEST_BUF_SIZE];
+	const char *check_str= "123456789";
+
+	/* CRC-32/MPEG-2 check value */
+	CHECK(psi_crc32((const uint8_t*)check_str, strlen(check_str))==
+			0x0376E6E7);
+
+	/* All the supported kernels should be bit-exact with the scalar
+	 * reference (random sizes and initial values).
+	 */
+	srand(0);
+	for(i= 0; i< CRC_TEST_BUF_SIZE; i++)
+		buf[i]= (uint8_t)rand();
+	for(i= 0; i< CRC_TEST_ITERATIONS; i++) {
+		size_t size= rand()% CRC_TEST_BUF_SIZE;
+		uint32_t crc_init= (uint32_t)rand();
+		uint32_t crc_ref= psi_crc32_update_kernel(PSI_CRC32_KERNEL_SCALAR,
+				crc_init, buf, size);
+
+		for(kernel= PSI_CRC32_KERNEL_AUTO; kernel< PSI_CRC32_KERNEL_ENUM_MAX;
+				kernel++) {
+			if(!psi_crc32_kernel_is_supported((psi_crc32_kernel_t)kernel))
+				continue;
+			CHECK(psi_crc32_update_kernel((psi_crc32_kernel_t)kernel,
+					crc_init, buf, size)== crc_ref);
+		}
+
+		/* Incremental computation */
+		CHECK(psi_crc32_update(psi_crc32(buf, size/ 2), &buf[size/ 2],
+				size- size/ 2)== psi_crc32(buf, size));
+	}
+}
+
+TEST(PSI_CRC32_PATCH)
+{
+	int i;
+	uint8_t buf[1024], buf_patched[1024];
+
+	srand(0);
+	for(i= 0; i< (int)sizeof(buf); i++)
+		buf[i]= (uint8_t)rand();
+
+	for(i= 0; i< CRC_TEST_ITERATIONS; i++) {
+		size_t size= 1+ rand()% sizeof(buf);
+		size_t offset= rand()% size;
+		size_t count= 1+ rand()% (size- offset);
+		size_t j;
+
+		memcpy(buf_patched, buf, size);
+		for(j= offset; j< offset+ count; j++)
+			buf_patched[j]= (uint8_t)rand();
+
+		CHECK(psi_crc32_patch(psi_crc32(buf, size), size, offset, &buf[offset],
+				&buf_patched[offset], count)== psi_crc32(buf_patched, size));
+	}
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_dec.cpp
+ * @brief PSI sections reassembly unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/ts.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_dec.h>
+#include <libstreamprocsmpeg2ts/psi_crc.h>
+}
+
+#define SECT_PID 0x100
+
+/**
+ * Compose a Program Association Section with 'prog_num' programs in 'buf'.
+ * Returns the section size (CRC-32 included).
+ */
+static size_t pas_compose(uint8_t *buf, uint16_t transport_stream_id,
+		int prog_num)
+{
+	int i;
+	uint32_t crc_32;
+	size_t size= 0, section_length= 5+ 4* prog_num+ 4;
+
+	buf[size++]= 0x00; // 'table_id'
+	buf[size++]= 0xB0| (uint8_t)(section_length>> 8);
+	buf[size++]= (uint8_t)section_length;
+	buf[size++]= (uint8_t)(transport_stream_id>> 8);
+	buf[size++]= (uint8_t)transport_stream_id;
+	buf[size++]= 0xC1; // version 0, 'current_next_indicator' set
+	buf[size++]= 0; // 'section_number'
+	buf[size++]= 0; // 'last_section_number'
+	for(i= 0; i< prog_num; i++) {
+		buf[size++]= 0;
+		buf[size++]= (uint8_t)(i+ 1); // 'program_number'
+		buf[size++]= 0xE1;
+		buf[size++]= (uint8_t)i; // 'program_map_PID'
+	}
+	crc_32= psi_crc32(buf, size);
+	buf[size++]= (uint8_t)(crc_32>> 24);
+	buf[size++]= (uint8_t)(crc_32>> 16);
+	buf[size++]= (uint8_t)(crc_32>> 8);
+	buf[size++]= (uint8_t)crc_32;
+	return size;
+}
+
+/**
+ * Initialize a transport packet header (payload only), and fill the
+ * payload with stuffing bytes.
+ */
+static void pkt_init(uint8_t *pkt, int flag_start, int cc)
+{
+	memset(pkt, 0xFF, TS_PKT_SIZE);
+	pkt[0]= 0x47;
+	pkt[1]= (flag_start? 0x40: 0)| (uint8_t)(SECT_PID>> 8);
+	pkt[2]= (uint8_t)SECT_PID;
+	pkt[3]= 0x10| (uint8_t)(cc& 0x0F);
+}
+
+/**
+ * Pull next section and check its transport stream identifier and size.
+ */
+static int sect_pull_check(psi_dec_sect_ctx_t *psi_dec_sect_ctx,
+		uint16_t transport_stream_id, size_t size)
+{
+	uint8_t *buf= NULL;
+	size_t count= 0;
+
+	if(psi_dec_sect_pull(psi_dec_sect_ctx, NULL, &buf, &count)!=
+			STAT_SUCCESS || buf== NULL)
+		return 0;
+	return count== size && ((buf[3]<< 8)| buf[4])== transport_stream_id;
+}
+
+TEST(PSI_DEC_SECT_MULTI_PER_PACKET)
+{
+	uint8_t *buf= NULL;
+	size_t count= 0, offset, size_a, size_b, size_c, size_d, size_d1, size_e;
+	uint8_t pkt1[TS_PKT_SIZE], pkt2[TS_PKT_SIZE];
+	uint8_t sect_a[64], sect_b[64], sect_c[64], sect_d[256], sect_e[64];
+	psi_dec_sect_ctx_t psi_dec_sect_ctx;
+
+	CHECK(psi_dec_sect_ctx_init(&psi_dec_sect_ctx)== STAT_SUCCESS);
+
+	size_a= pas_compose(sect_a, 1, 1);
+	size_b= pas_compose(sect_b, 2, 2);
+	size_c= pas_compose(sect_c, 3, 1);
+	sect_c[size_c- 1]^= 0xFF; // Corrupt CRC-32
+	size_d= pas_compose(sect_d, 4, 50); // Spans into the next packet
+	size_e= pas_compose(sect_e, 5, 3);
+
+	/* First packet: sections A, B, C (bad CRC) and the start of D */
+	pkt_init(pkt1, 1, 0);
+	offset= TS_PKT_PREFIX_LEN;
+	pkt1[offset++]= 0; // 'pointer_field'
+	memcpy(&pkt1[offset], sect_a, size_a);
+	offset+= size_a;
+	memcpy(&pkt1[offset], sect_b, size_b);
+	offset+= size_b;
+	memcpy(&pkt1[offset], sect_c, size_c);
+	offset+= size_c;
+	size_d1= TS_PKT_SIZE- offset;
+	memcpy(&pkt1[offset], sect_d, size_d1);
+
+	/* Second packet: the end of D, section E and stuffing */
+	pkt_init(pkt2, 1, 1);
+	offset= TS_PKT_PREFIX_LEN;
+	pkt2[offset++]= (uint8_t)(size_d- size_d1); // 'pointer_field'
+	memcpy(&pkt2[offset], &sect_d[size_d1], size_d- size_d1);
+	offset+= size_d- size_d1;
+	memcpy(&pkt2[offset], sect_e, size_e);
+
+	/* Nothing to pull before pushing a packet */
+	CHECK(psi_dec_sect_pull(&psi_dec_sect_ctx, NULL, &buf, &count)==
+			STAT_EAGAIN);
+
+	psi_dec_sect_push_packet(&psi_dec_sect_ctx, pkt1);
+	CHECK(psi_dec_sect_ctx.pid== SECT_PID);
+	CHECK(sect_pull_check(&psi_dec_sect_ctx, 1, size_a));
+	CHECK(sect_pull_check(&psi_dec_sect_ctx, 2, size_b));
+	CHECK(psi_dec_sect_pull(&psi_dec_sect_ctx, NULL, &buf, &count)==
+			STAT_ERROR); // Section C is discarded
+	CHECK(psi_dec_sect_pull(&psi_dec_sect_ctx, NULL, &buf, &count)==
+			STAT_EAGAIN); // Section D is not complete
+
+	psi_dec_sect_push_packet(&psi_dec_sect_ctx, pkt2);
+	CHECK(sect_pull_check(&psi_dec_sect_ctx, 4, size_d));
+	CHECK(memcmp(psi_dec_sect_ctx.buf, sect_d, size_d)== 0);
+	CHECK(sect_pull_check(&psi_dec_sect_ctx, 5, size_e));
+	CHECK(psi_dec_sect_pull(&psi_dec_sect_ctx, NULL, &buf, &count)==
+			STAT_EAGAIN); // Stuffing till the end of packet
+
+	psi_dec_sect_ctx_deinit(&psi_dec_sect_ctx);
+	CHECK(psi_dec_sect_ctx.buf== NULL);
+}
+
+TEST(PSI_DEC_SECTION_FP_NOT_APPLICABLE)
+{
+	int i;
+	uint32_t crc_32;
+	size_t size, size_next;
+	uint8_t sect[256], sect_next[256];
+	psi_dec_fp_ctx_t psi_dec_fp_ctx;
+	psi_section_ctx_t *psi_section_ctx= NULL, *psi_section_ctx_rep= NULL;
+
+	psi_dec_fp_ctx_init(&psi_dec_fp_ctx);
+
+	/* Current version 0 and next version 1 of the same section */
+	memset(sect, 0, sizeof(sect));
+	memset(sect_next, 0, sizeof(sect_next));
+	size= pas_compose(sect, 1, 2);
+	size_next= pas_compose(sect_next, 1, 2);
+	sect_next[5]= 0xC2; // version 1, 'current_next_indicator' not set
+	crc_32= psi_crc32(sect_next, size_next- 4);
+	sect_next[size_next- 4]= (uint8_t)(crc_32>> 24);
+	sect_next[size_next- 3]= (uint8_t)(crc_32>> 16);
+	sect_next[size_next- 2]= (uint8_t)(crc_32>> 8);
+	sect_next[size_next- 1]= (uint8_t)crc_32;
+
+	/* Not applicable section is skipped (neither decoded nor registered) */
+	for(i= 0; i< 2; i++) {
+		CHECK(psi_dec_section_fp(sect_next, size_next, SECT_PID,
+				&psi_dec_fp_ctx, NULL, &psi_section_ctx)== STAT_ENODATA);
+		CHECK(psi_section_ctx== NULL);
+	}
+	CHECK(psi_dec_fp_ctx.decoded_count== 0);
+	CHECK(psi_dec_fp_ctx.repetitions_count== 0);
+
+	/* Current section is decoded once, then recognized as repetition */
+	CHECK(psi_dec_section_fp(sect, size, SECT_PID, &psi_dec_fp_ctx, NULL,
+			&psi_section_ctx)== STAT_SUCCESS);
+	CHECK(psi_section_ctx!= NULL && psi_section_ctx->version_number== 0);
+	CHECK(psi_dec_section_fp(sect_next, size_next, SECT_PID,
+			&psi_dec_fp_ctx, NULL, &psi_section_ctx_rep)== STAT_ENODATA);
+	CHECK(psi_section_ctx_rep== NULL);
+	CHECK(psi_dec_section_fp(sect, size, SECT_PID, &psi_dec_fp_ctx, NULL,
+			&psi_section_ctx_rep)== STAT_SUCCESS);
+	CHECK(psi_section_ctx_rep== psi_section_ctx);
+	CHECK(psi_dec_fp_ctx.decoded_count== 1);
+	CHECK(psi_dec_fp_ctx.repetitions_count== 1);
+	psi_section_ctx_release(&psi_section_ctx_rep);
+
+	/* Not applicable section is not decoded without fingerprinting either */
+	CHECK(psi_dec_section(sect_next, size_next, SECT_PID, NULL,
+			&psi_section_ctx_rep)== STAT_ENODATA);
+	CHECK(psi_section_ctx_rep== NULL);
+
+	psi_section_ctx_release(&psi_section_ctx);
+	psi_dec_fp_ctx_deinit(&psi_dec_fp_ctx);
+}
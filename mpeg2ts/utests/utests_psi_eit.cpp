@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_eit.cpp
+ * @brief EIT streaming parser and schedule cache unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/psi_eit.h>
+}
+
+/* 2018-01-01 00:00:00 UTC (MJD 58119) */
+#define T0 1514764800
+
+/**
+ * Compose an EIT section with a single event ('start' is an offset in
+ * seconds from T0, below one day; 'duration' below one hour).
+ */
+static size_t eit_section_compose(uint8_t *buf, uint8_t table_id,
+		uint16_t service_id, uint8_t version, uint8_t section_number,
+		uint16_t event_id, int start, int duration, const char *name)
+{
+#define BCD(V) ((uint8_t)((((V)/ 10)<< 4)| ((V)% 10)))
+	size_t name_len= strlen(name), desc_len= 5+ name_len, size;
+	uint8_t *p= buf+ 14;
+
+	buf[0]= table_id;
+	buf[3]= service_id>> 8; buf[4]= service_id& 0xFF;
+	buf[5]= 0xC1| (version<< 1);
+	buf[6]= section_number;
+	buf[7]= 0x01; // last_section_number
+	memset(&buf[8], 0, 6);
+	p[0]= event_id>> 8; p[1]= event_id& 0xFF;
+	p[2]= 58119>> 8; p[3]= 58119& 0xFF;
+	p[4]= BCD(start/ 3600); p[5]= BCD(start/ 60% 60); p[6]= BCD(start% 60);
+	p[7]= 0; p[8]= BCD(duration/ 60); p[9]= BCD(duration% 60);
+	p[10]= 0x80| ((desc_len+ 2)>> 8); p[11]= (desc_len+ 2)& 0xFF; // running
+	p[12]= 0x4D; p[13]= 3+ 1+ name_len+ 1;
+	memcpy(&p[14], "eng", 3);
+	p[17]= name_len;
+	memcpy(&p[18], name, name_len);
+	p[18+ name_len]= 0; // text_length
+	p+= 12+ desc_len+ 2;
+	/* Fake CRC (used as fingerprint only) */
+	p[0]= version; p[1]= section_number; p[2]= event_id; p[3]= 0xAA;
+	size= p+ 4- buf;
+	buf[1]= 0xF0| ((size- 3)>> 8); buf[2]= (size- 3)& 0xFF;
+	return size;
+#undef BCD
+}
+
+TEST(PSI_EIT_NOW_NEXT)
+{
+	int i;
+	size_t size;
+	uint8_t buf[256];
+	psi_eit_event_t event_now, event_next;
+	psi_eit_stats_t psi_eit_stats;
+	psi_eit_ctx_t *psi_eit_ctx= psi_eit_open(0, 3600, NULL);
+	CHECK(psi_eit_ctx!= NULL);
+
+	/* Schedule: events each 10 minutes */
+	for(i= 0; i< 4; i++) {
+		size= eit_section_compose(buf, 0x50, 1, 0, i* 8, 100+ i, i* 600,
+				600, "sched");
+		CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	}
+	/* Repeated section is skipped */
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_NOTMODIFIED);
+	/* Beyond the time horizon */
+	size= eit_section_compose(buf, 0x50, 1, 0, 64, 200, 7200, 600, "far");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	/* Other transport stream */
+	size= eit_section_compose(buf, 0x4F, 1, 0, 0, 300, 0, 600, "other");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_NOTMODIFIED);
+	/* Service not fitting in the memory budget */
+	size= eit_section_compose(buf, 0x50, 2, 0, 0, 400, 0, 600, "svc2");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_NOTMODIFIED);
+
+	/* Now/next from the schedule ring */
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1, T0+ 700, &event_now,
+			&event_next)== STAT_SUCCESS);
+	CHECK(event_now.event_id== 101 && event_now.start_time== T0+ 600);
+	CHECK(event_now.duration== 600);
+	CHECK(strcmp(event_now.event_name, "sched")== 0);
+	CHECK(event_next.event_id== 102);
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 2, T0, &event_now,
+			&event_next)== STAT_ENOTFOUND);
+	CHECK(event_now.start_time== -1 && event_next.start_time== -1);
+
+	/* Present/following table takes precedence */
+	size= eit_section_compose(buf, 0x4E, 1, 3, 0, 500, 650, 60, "present");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	size= eit_section_compose(buf, 0x4E, 1, 3, 1, 501, 710, 60, "following");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1, T0+ 700, &event_now,
+			&event_next)== STAT_SUCCESS);
+	CHECK(event_now.event_id== 500 && event_next.event_id== 501);
+	CHECK(strcmp(event_next.event_name, "following")== 0);
+
+	/* New version of the following event */
+	size= eit_section_compose(buf, 0x4E, 1, 4, 1, 502, 710, 60, "changed");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1, T0+ 700, &event_now,
+			&event_next)== STAT_SUCCESS);
+	CHECK(event_next.event_id== 502);
+
+	CHECK(psi_eit_get_stats(psi_eit_ctx, &psi_eit_stats)== STAT_SUCCESS);
+	CHECK(psi_eit_stats.services_num== 1 && psi_eit_stats.services_max== 1);
+	CHECK(psi_eit_stats.sections_parsed== 8);
+	CHECK(psi_eit_stats.sections_unchanged== 1);
+	CHECK(psi_eit_stats.sections_ignored== 2);
+	CHECK(psi_eit_stats.events_dropped== 1);
+
+	psi_eit_close(&psi_eit_ctx);
+	CHECK(psi_eit_ctx== NULL);
+}
+
+TEST(PSI_EIT_RING_BOUNDS)
+{
+	int i;
+	size_t size;
+	uint8_t buf[256];
+	psi_eit_event_t event_now, event_next;
+	psi_eit_ctx_t *psi_eit_ctx= psi_eit_open(0, 24* 3600, NULL);
+	CHECK(psi_eit_ctx!= NULL);
+
+	/* Fill the ring beyond its capacity (events of one minute, in reverse
+	 * order); only the earliest events are kept.
+	 */
+	for(i= PSI_EIT_SERVICE_EVENTS_MAX+ 8- 1; i>= 0; i--) {
+		size= eit_section_compose(buf, 0x51, 1, 0, i, 1000+ i, i* 60, 60,
+				"e");
+		CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	}
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1, T0, &event_now,
+			&event_next)== STAT_SUCCESS);
+	CHECK(event_now.event_id== 1000 && event_next.event_id== 1001);
+
+	/* Finished events are evicted on the next insertion */
+	size= eit_section_compose(buf, 0x52, 1, 0, 0, 2000, 3600* 20, 60, "late");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0+ 600)== STAT_SUCCESS);
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1, T0+ 600, &event_now,
+			&event_next)== STAT_SUCCESS);
+	CHECK(event_now.event_id== 1010 && event_next.event_id== 1011);
+
+	psi_eit_close(&psi_eit_ctx);
+}
+
+TEST(PSI_EIT_HORIZON_REPARSE)
+{
+	int i;
+	size_t size;
+	uint8_t buf[256];
+	psi_eit_event_t event_now, event_next;
+	psi_eit_stats_t psi_eit_stats;
+	psi_eit_ctx_t *psi_eit_ctx= psi_eit_open(0, 3600, NULL);
+	CHECK(psi_eit_ctx!= NULL);
+
+	/* Event beyond the time horizon: the section is parsed again when
+	 * repeated, and the event is kept once within the horizon.
+	 */
+	size= eit_section_compose(buf, 0x50, 1, 0, 0, 200, 7200, 600, "far");
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0+ 60)== STAT_SUCCESS);
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1, T0+ 7300, &event_now,
+			&event_next)== STAT_ENOTFOUND);
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0+ 4000)== STAT_SUCCESS);
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0+ 4060)==
+			STAT_NOTMODIFIED);
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1, T0+ 7300, &event_now,
+			&event_next)== STAT_SUCCESS);
+	CHECK(event_now.event_id== 200);
+
+	CHECK(psi_eit_get_stats(psi_eit_ctx, &psi_eit_stats)== STAT_SUCCESS);
+	CHECK(psi_eit_stats.events_dropped== 2);
+	CHECK(psi_eit_stats.sections_unchanged== 1);
+	psi_eit_close(&psi_eit_ctx);
+
+	/* Ring full: the events dropped are kept when their sections are
+	 * parsed again once the ring has room.
+	 */
+	psi_eit_ctx= psi_eit_open(0, 24* 3600, NULL);
+	CHECK(psi_eit_ctx!= NULL);
+	for(i= 0; i< PSI_EIT_SERVICE_EVENTS_MAX+ 1; i++) {
+		size= eit_section_compose(buf, 0x51, 1, 0, i, 1000+ i, i* 60, 60,
+				"e");
+		CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0)== STAT_SUCCESS);
+	}
+	/* First events finished; the latest event section is parsed again */
+	CHECK(psi_eit_section(psi_eit_ctx, buf, size, T0+ 120)== STAT_SUCCESS);
+	CHECK(psi_eit_get_now_next(psi_eit_ctx, 1,
+			T0+ PSI_EIT_SERVICE_EVENTS_MAX* 60, &event_now,
+			&event_next)== STAT_SUCCESS);
+	CHECK(event_now.event_id== 1000+ PSI_EIT_SERVICE_EVENTS_MAX);
+	psi_eit_close(&psi_eit_ctx);
+}
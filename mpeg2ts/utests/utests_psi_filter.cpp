@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_filter.cpp
+ * @brief PSI section filters unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/psi_filter.h>
+}
+
+/* Section header: table_id= 0x02; section_length= 0x12;
+ * program_number= 0x0102; version_number= 5; current_next_indicator= 1;
+ * section_number= 0; last_section_number= 0.
+ */
+static const uint8_t pmt_header[]= {
+	0x02, 0xB0, 0x12, 0x01, 0x02, 0xC0| (5<< 1)| 1, 0x00, 0x00
+};
+
+TEST(PSI_FILTER_MATCH)
+{
+	psi_filter_t psi_filter;
+
+	/* Empty filter matches any section */
+	psi_filter_init(&psi_filter);
+	CHECK(psi_filter_match(&psi_filter, pmt_header, sizeof(pmt_header)));
+
+	/* 'table_id' and 'table_id_extension' */
+	psi_filter_set_table_id(&psi_filter, 0x02);
+	CHECK(psi_filter_match(&psi_filter, pmt_header, sizeof(pmt_header)));
+	psi_filter_set_table_id_extension(&psi_filter, 0x0102);
+	CHECK(psi_filter_match(&psi_filter, pmt_header, sizeof(pmt_header)));
+	psi_filter_set_table_id_extension(&psi_filter, 0x0103);
+	CHECK(!psi_filter_match(&psi_filter, pmt_header, sizeof(pmt_header)));
+	psi_filter_init(&psi_filter);
+	psi_filter_set_table_id(&psi_filter, 0x42);
+	CHECK(!psi_filter_match(&psi_filter, pmt_header, sizeof(pmt_header)));
+
+	/* Not-equal version mode */
+	psi_filter_init(&psi_filter);
+	psi_filter_set_table_id(&psi_filter, 0x02);
+	psi_filter_set_version_neq(&psi_filter, 5);
+	CHECK(!psi_filter_match(&psi_filter, pmt_header, sizeof(pmt_header)));
+	psi_filter_set_version_neq(&psi_filter, 4);
+	CHECK(psi_filter_match(&psi_filter, pmt_header, sizeof(pmt_header)));
+
+	/* Filter bytes beyond the section size never match */
+	psi_filter_init(&psi_filter);
+	psi_filter_set_table_id_extension(&psi_filter, 0x0102);
+	CHECK(!psi_filter_match(&psi_filter, pmt_header, 3));
+}
+
+TEST(PSI_FILTER_LIST)
+{
+	int i, filter_id= -1;
+	psi_filter_list_t psi_filter_list;
+	psi_filter_t psi_filter;
+
+	/* Empty list accepts any section */
+	psi_filter_list_init(&psi_filter_list);
+	CHECK(psi_filter_list_match(&psi_filter_list, pmt_header,
+			sizeof(pmt_header)));
+
+	psi_filter_init(&psi_filter);
+	psi_filter_set_table_id(&psi_filter, 0x42);
+	CHECK(psi_filter_list_add(&psi_filter_list, &psi_filter, &filter_id)==
+			STAT_SUCCESS && filter_id== 0);
+	CHECK(!psi_filter_list_match(&psi_filter_list, pmt_header,
+			sizeof(pmt_header)));
+
+	psi_filter_set_table_id(&psi_filter, 0x02);
+	CHECK(psi_filter_list_add(&psi_filter_list, &psi_filter, &filter_id)==
+			STAT_SUCCESS && filter_id== 1);
+	CHECK(psi_filter_list_match(&psi_filter_list, pmt_header,
+			sizeof(pmt_header)));
+
+	CHECK(psi_filter_list_delete(&psi_filter_list, 1)== STAT_SUCCESS);
+	CHECK(psi_filter_list_delete(&psi_filter_list, 1)== STAT_ENOTFOUND);
+	CHECK(!psi_filter_list_match(&psi_filter_list, pmt_header,
+			sizeof(pmt_header)));
+
+	/* List capacity */
+	for(i= 1; i< PSI_FILTER_LIST_MAX_NUM; i++)
+		CHECK(psi_filter_list_add(&psi_filter_list, &psi_filter, NULL)==
+				STAT_SUCCESS);
+	CHECK(psi_filter_list_add(&psi_filter_list, &psi_filter, NULL)==
+			STAT_ENOMEM);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_oput.cpp
+ * @brief Output PSI generator unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/psi_oput.h>
+#include <libstreamprocsmpeg2ts/stc.h>
+}
+
+/* PAT section: transport_stream_id= 1; program 1 -> PMT PID 0x100 */
+static const uint8_t pat_section[]= {
+	0x00, 0xB0, 0x0D, 0x00, 0x01, 0xC1, 0x00, 0x00,
+	0x00, 0x01, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+TEST(PSI_OPUT_REPETITION)
+{
+	int i, pat_pkts= 0;
+	size_t size= 0;
+	uint8_t cc_prev= 0xFF;
+	uint8_t buf[188* 8];
+	int64_t now_usec= stc_monotonic_usec();
+	psi_oput_stats_t psi_oput_stats;
+	psi_oput_ctx_t *psi_oput_ctx= psi_oput_open(NULL);
+	CHECK(psi_oput_ctx!= NULL);
+
+	/* Repeat PAT each 100 milliseconds */
+	CHECK(psi_oput_section_set_raw(psi_oput_ctx, pat_section,
+			sizeof(pat_section), 0, 100)== STAT_SUCCESS);
+
+	/* New section is output on first pull */
+	CHECK(psi_oput_pull(psi_oput_ctx, now_usec, buf, sizeof(buf), &size)==
+			STAT_SUCCESS);
+	CHECK(size== 188);
+	CHECK(buf[0]== 0x47 && buf[1]== 0x40 && buf[2]== 0x00 && buf[4]== 0x00);
+	CHECK(memcmp(&buf[5], pat_section, sizeof(pat_section))== 0);
+
+	/* Setting the same contents again does not re-packetize nor output */
+	CHECK(psi_oput_section_set_raw(psi_oput_ctx, pat_section,
+			sizeof(pat_section), 0, 100)== STAT_SUCCESS);
+	CHECK(psi_oput_pull(psi_oput_ctx, now_usec, buf, sizeof(buf), &size)==
+			STAT_SUCCESS);
+	CHECK(size== 0);
+
+	/* Simulate one second of pulls each 5 milliseconds */
+	for(i= 0; i< 200; i++) {
+		now_usec+= 5000;
+		CHECK(psi_oput_pull(psi_oput_ctx, now_usec, buf, sizeof(buf),
+				&size)== STAT_SUCCESS);
+		if(size== 0)
+			continue;
+		CHECK(size== 188);
+		if(cc_prev!= 0xFF)
+			CHECK((buf[3]& 0x0F)== ((cc_prev+ 1)& 0x0F));
+		cc_prev= buf[3]& 0x0F;
+		pat_pkts++;
+	}
+	CHECK(pat_pkts>= 9 && pat_pkts<= 11);
+
+	/* Explicit emission */
+	CHECK(psi_oput_section_emit(psi_oput_ctx, 0, 0x00, 0x0001, buf, 100,
+			&size)== STAT_ENOMEM);
+	CHECK(psi_oput_section_emit(psi_oput_ctx, 0, 0x00, 0x0001, buf,
+			sizeof(buf), &size)== STAT_SUCCESS);
+	CHECK(size== 188);
+
+	CHECK(psi_oput_get_stats(psi_oput_ctx, &psi_oput_stats)== STAT_SUCCESS);
+	CHECK(psi_oput_stats.sections_packetized== 1);
+
+	/* Unset */
+	CHECK(psi_oput_section_unset(psi_oput_ctx, 0, 0x00, 0x0001)==
+			STAT_SUCCESS);
+	CHECK(psi_oput_section_unset(psi_oput_ctx, 0, 0x00, 0x0001)==
+			STAT_ENOTFOUND);
+	now_usec+= 1000000;
+	CHECK(psi_oput_pull(psi_oput_ctx, now_usec, buf, sizeof(buf), &size)==
+			STAT_SUCCESS);
+	CHECK(size== 0);
+
+	psi_oput_close(&psi_oput_ctx);
+	CHECK(psi_oput_ctx== NULL);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_pms_diff.cpp
+ * @brief Program Map Section structural differences unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/llist.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_desc.h>
+}
+
+/* ISO 639 language descriptors (tag 0x0A) and a private descriptor */
+static const uint8_t desc_lang_en[]= {'e', 'n', 'g', 0x00};
+static const uint8_t desc_lang_fr[]= {'f', 'r', 'a', 0x00};
+static const uint8_t desc_priv[]= {0x01};
+
+static psi_pms_es_ctx_t* es_ctx_create(uint16_t pid, uint8_t stream_type,
+		const uint8_t *lang)
+{
+	psi_pms_es_ctx_t *psi_pms_es_ctx= psi_pms_es_ctx_allocate();
+	psi_desc_ctx_t *psi_desc_ctx;
+
+	psi_pms_es_ctx->elementary_PID= pid;
+	psi_pms_es_ctx->stream_type= stream_type;
+	if(lang!= NULL) {
+		psi_desc_ctx= psi_desc_ctx_allocate_raw(0x0A, 4, lang);
+		llist_push(&psi_pms_es_ctx->psi_desc_ctx_llist, psi_desc_ctx);
+	}
+	psi_desc_ctx= psi_desc_ctx_allocate_raw(0x52, 1, desc_priv);
+	llist_push(&psi_pms_es_ctx->psi_desc_ctx_llist, psi_desc_ctx);
+	return psi_pms_es_ctx;
+}
+
+static psi_pms_es_diff_ctx_t* es_diff_get(psi_pms_diff_ctx_t *psi_pms_diff_ctx,
+		uint16_t pid)
+{
+	llist_t *n;
+
+	for(n= psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist; n!= NULL; n= n->next) {
+		psi_pms_es_diff_ctx_t *psi_pms_es_diff_ctx=
+				(psi_pms_es_diff_ctx_t*)n->data;
+		if(psi_pms_es_diff_ctx->elementary_PID== pid)
+			return psi_pms_es_diff_ctx;
+	}
+	return NULL;
+}
+
+TEST(PSI_PMS_DIFF)
+{
+	psi_pms_ctx_t *psi_pms_ctx_prev= psi_pms_ctx_allocate();
+	psi_pms_ctx_t *psi_pms_ctx= psi_pms_ctx_allocate();
+	psi_pms_diff_ctx_t *psi_pms_diff_ctx= NULL;
+	psi_pms_es_diff_ctx_t *psi_pms_es_diff_ctx;
+
+	CHECK(psi_pms_ctx_prev!= NULL && psi_pms_ctx!= NULL);
+	psi_pms_ctx_prev->pcr_pid= psi_pms_ctx->pcr_pid= 0x100;
+
+	llist_push(&psi_pms_ctx_prev->psi_pms_es_ctx_llist,
+			es_ctx_create(0x100, 0x1B, NULL));
+	llist_push(&psi_pms_ctx_prev->psi_pms_es_ctx_llist,
+			es_ctx_create(0x101, 0x03, desc_lang_en));
+	llist_push(&psi_pms_ctx_prev->psi_pms_es_ctx_llist,
+			es_ctx_create(0x102, 0x03, desc_lang_en));
+	llist_push(&psi_pms_ctx_prev->psi_pms_es_ctx_llist,
+			es_ctx_create(0x103, 0x06, NULL));
+
+	llist_push(&psi_pms_ctx->psi_pms_es_ctx_llist,
+			es_ctx_create(0x100, 0x1B, NULL)); // unchanged
+	llist_push(&psi_pms_ctx->psi_pms_es_ctx_llist,
+			es_ctx_create(0x101, 0x0F, desc_lang_en)); // stream type changed
+	llist_push(&psi_pms_ctx->psi_pms_es_ctx_llist,
+			es_ctx_create(0x102, 0x03, desc_lang_fr)); // descriptor changed
+	llist_push(&psi_pms_ctx->psi_pms_es_ctx_llist,
+			es_ctx_create(0x104, 0x06, NULL)); // added (0x103 removed)
+
+	/* Structurally equal sections */
+	psi_pms_diff_ctx= psi_pms_ctx_diff(psi_pms_ctx_prev, psi_pms_ctx_prev);
+	CHECK(psi_pms_diff_ctx!= NULL);
+	CHECK(psi_pms_diff_ctx->flags== 0);
+	CHECK(psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist== NULL);
+	psi_pms_diff_ctx_release(&psi_pms_diff_ctx);
+	CHECK(psi_pms_diff_ctx== NULL);
+
+	/* No previous section: all entries added */
+	psi_pms_diff_ctx= psi_pms_ctx_diff(NULL, psi_pms_ctx);
+	CHECK(psi_pms_diff_ctx!= NULL);
+	CHECK(llist_len(psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist)== 4);
+	CHECK(psi_pms_diff_ctx->flags== (PSI_PMS_DIFF_PCR_PID|
+			PSI_PMS_DIFF_ES_ADDED));
+	psi_pms_diff_ctx_release(&psi_pms_diff_ctx);
+
+	/* Entries added, removed and modified */
+	psi_pms_diff_ctx= psi_pms_ctx_diff(psi_pms_ctx_prev, psi_pms_ctx);
+	CHECK(psi_pms_diff_ctx!= NULL);
+	CHECK(llist_len(psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist)== 4);
+	CHECK(es_diff_get(psi_pms_diff_ctx, 0x100)== NULL);
+
+	psi_pms_es_diff_ctx= es_diff_get(psi_pms_diff_ctx, 0x101);
+	CHECK(psi_pms_es_diff_ctx!= NULL);
+	CHECK(psi_pms_es_diff_ctx->flags== PSI_PMS_DIFF_ES_STREAM_TYPE);
+	CHECK(psi_pms_es_diff_ctx->stream_type_prev== 0x03);
+	CHECK(psi_pms_es_diff_ctx->stream_type== 0x0F);
+
+	psi_pms_es_diff_ctx= es_diff_get(psi_pms_diff_ctx, 0x102);
+	CHECK(psi_pms_es_diff_ctx!= NULL);
+	CHECK(psi_pms_es_diff_ctx->flags== PSI_PMS_DIFF_ES_DESC);
+	CHECK(psi_pms_es_diff_ctx->desc_tag_bitmap[0]== ((uint64_t)1<< 0x0A));
+
+	psi_pms_es_diff_ctx= es_diff_get(psi_pms_diff_ctx, 0x104);
+	CHECK(psi_pms_es_diff_ctx!= NULL);
+	CHECK(psi_pms_es_diff_ctx->flags== PSI_PMS_DIFF_ES_ADDED);
+
+	/* Removed entries are listed first */
+	psi_pms_es_diff_ctx= (psi_pms_es_diff_ctx_t*)
+			psi_pms_diff_ctx->psi_pms_es_diff_ctx_llist->data;
+	CHECK(psi_pms_es_diff_ctx->elementary_PID== 0x103);
+	CHECK(psi_pms_es_diff_ctx->flags== PSI_PMS_DIFF_ES_REMOVED);
+
+	CHECK((psi_pms_diff_ctx->flags& (PSI_PMS_DIFF_PCR_PID|
+			PSI_PMS_DIFF_PROGRAM_DESC))== 0);
+	psi_pms_diff_ctx_release(&psi_pms_diff_ctx);
+
+	psi_pms_ctx_release(&psi_pms_ctx_prev);
+	psi_pms_ctx_release(&psi_pms_ctx);
+}
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_proc.cpp
+ * @brief PSI demultiplexer processor unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+
+#include <libcjson/cJSON.h>
+
+#define ENABLE_DEBUG_LOGS //uncomment to trace logs
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/check_utils.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/fifo.h>
+#include <libmediaprocs/proc_if.h>
+#include <libmediaprocs/procs.h>
+#include <libmediaprocs/proc.h>
+#include <libstreamprocsmpeg2ts/ts.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_table.h>
+#include <libstreamprocsmpeg2ts/psi_dvb.h>
+#include <libstreamprocsmpeg2ts/psi_crc.h>
+#include <libstreamprocsmpeg2ts/psi_proc.h>
+}
+
+#define PAT_PID 0
+#define SDT_PID 17
+#define PMT_PID 0x100
+#define PSI_TIMEOUT_MSEC 5000
+#define EVENTS_FIFO_SIZE 16
+
+/**
+ * PSI version-change event (as queued by the notification callback).
+ */
+typedef struct psi_event_s {
+	uint16_t pid;
+	uint8_t table_id;
+	uint8_t version_number;
+} psi_event_t;
+
+/**
+ * PSI version-change notification callback: queues the event in the
+ * events FIFO given as opaque pointer.
+ */
+static void psi_notify(void *opaque, uint16_t pid, uint8_t table_id,
+		uint8_t version_number)
+{
+	psi_event_t psi_event;
+
+	psi_event.pid= pid;
+	psi_event.table_id= table_id;
+	psi_event.version_number= version_number;
+	fifo_put_dup((fifo_ctx_t*)opaque, &psi_event, sizeof(psi_event_t));
+}
+
+/**
+ * Compose a TS packet carrying the given section (the section header
+ * fields common to all the tables and the CRC are composed here).
+ */
+static void pkt_section_compose(uint8_t *pkt, uint16_t pid, int cc,
+		uint8_t table_id, uint16_t table_id_extension,
+		uint8_t version_number, const uint8_t *data, size_t data_size)
+{
+	uint32_t crc_32;
+	size_t size= 0;
+	uint8_t *buf= &pkt[TS_PKT_PREFIX_LEN+ 1];
+	const size_t section_length= 5+ data_size+ 4;
+
+	memset(pkt, 0xFF, TS_PKT_SIZE);
+	pkt[0]= 0x47;
+	pkt[1]= 0x40| (uint8_t)(pid>> 8);
+	pkt[2]= (uint8_t)pid;
+	pkt[3]= 0x10| (uint8_t)(cc& 0x0F);
+	pkt[TS_PKT_PREFIX_LEN]= 0; // 'pointer_field'
+
+	buf[size++]= table_id;
+	buf[size++]= 0xB0| (uint8_t)(section_length>> 8);
+	buf[size++]= (uint8_t)section_length;
+	buf[size++]= (uint8_t)(table_id_extension>> 8);
+	buf[size++]= (uint8_t)table_id_extension;
+	buf[size++]= 0xC1| ((version_number& 0x1F)<< 1);
+	buf[size++]= 0; // 'section_number'
+	buf[size++]= 0; // 'last_section_number'
+	memcpy(&buf[size], data, data_size);
+	size+= data_size;
+	crc_32= psi_crc32(buf, size);
+	buf[size++]= (uint8_t)(crc_32>> 24);
+	buf[size++]= (uint8_t)(crc_32>> 16);
+	buf[size++]= (uint8_t)(crc_32>> 8);
+	buf[size++]= (uint8_t)crc_32;
+}
+
+/**
+ * Compose a TS packet carrying a PAT (program 1 in PMT_PID).
+ */
+static void pkt_pas_compose(uint8_t *pkt, int cc, uint8_t version_number)
+{
+	const uint8_t data[]= {0x00, 0x01, 0xE0| (PMT_PID>> 8), PMT_PID& 0xFF};
+	pkt_section_compose(pkt, PAT_PID, cc,
+			PSI_TABLE_PROGRAM_ASSOCIATION_SECTION, 0x0A0B, version_number,
+			data, sizeof(data));
+}
+
+/**
+ * Compose a TS packet carrying a PMS (program 1) with one elementary stream.
+ */
+static void pkt_pms_compose(uint8_t *pkt, int cc, uint8_t version_number,
+		uint16_t es_pid)
+{
+	const uint8_t data[]= {
+		(uint8_t)(0xE0| (es_pid>> 8)), (uint8_t)es_pid, // 'PCR_PID'
+		0xF0, 0x00, // 'program_info_length'
+		0x02, (uint8_t)(0xE0| (es_pid>> 8)), (uint8_t)es_pid, 0xF0, 0x00
+	};
+	pkt_section_compose(pkt, PMT_PID, cc, PSI_TABLE_TS_PROGRAM_MAP_SECTION,
+			1, version_number, data, sizeof(data));
+}
+
+/**
+ * Compose a TS packet carrying a SDT (actual transport stream) listing
+ * service 1 with no descriptors.
+ */
+static void pkt_sds_compose(uint8_t *pkt, int cc, uint8_t version_number)
+{
+	const uint8_t data[]= {
+		0x00, 0x01, // 'original_network_id'
+		0xFF,
+		0x00, 0x01, // 'service_id'
+		0xFC, // EIT flags not set
+		0x80, 0x00 // running, no descriptors
+	};
+	pkt_section_compose(pkt, SDT_PID, cc,
+			PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL, 0x0A0B, version_number,
+			data, sizeof(data));
+}
+
+/**
+ * Send one packet to the PSI demultiplexer.
+ */
+static int pkt_send(procs_ctx_t *procs_ctx, int proc_id, const uint8_t *pkt)
+{
+	proc_frame_ctx_t proc_frame_ctx= {0};
+
+	proc_frame_ctx.data= (uint8_t*)pkt;
+	proc_frame_ctx.p_data[0]= pkt;
+	proc_frame_ctx.linesize[0]= TS_PKT_SIZE;
+	proc_frame_ctx.width[0]= TS_PKT_SIZE;
+	proc_frame_ctx.height[0]= 1;
+	proc_frame_ctx.proc_sample_fmt= PROC_IF_FMT_UNDEF;
+	proc_frame_ctx.pts= -1;
+	proc_frame_ctx.dts= -1;
+	proc_frame_ctx.es_id= proc_id;
+	return procs_send_frame(procs_ctx, proc_id, &proc_frame_ctx);
+}
+
+/**
+ * Wait for the PSI demultiplexer to process the given total number of
+ * sections of the given PID (either decoded or detected as repetition).
+ */
+static int pid_wait_sections(procs_ctx_t *procs_ctx, int proc_id,
+		uint16_t pid, uint64_t sections_num)
+{
+	int i;
+	psi_proc_stats_t psi_proc_stats;
+
+	for(i= 0; i< PSI_TIMEOUT_MSEC/ 10; i++) {
+		if(procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_STATS", proc_id, pid,
+				&psi_proc_stats)!= STAT_SUCCESS)
+			return 0;
+		if(psi_proc_stats.sections_decoded+ psi_proc_stats.sections_repeated
+				>= sections_num)
+			return 1;
+		usleep(10* 1000);
+	}
+	return 0;
+}
+
+/**
+ * Check that exactly one event (the given one) is queued.
+ */
+static int event_check(fifo_ctx_t *fifo_ctx_events, uint16_t pid,
+		uint8_t table_id, uint8_t version_number)
+{
+	int ret_code;
+	psi_event_t *psi_event= NULL;
+	size_t psi_event_size= 0;
+
+	if(fifo_get_buffer_level(fifo_ctx_events)!= 1)
+		return 0;
+	ret_code= fifo_get(fifo_ctx_events, (void**)&psi_event, &psi_event_size);
+	if(ret_code!= STAT_SUCCESS || psi_event== NULL)
+		return 0;
+	ret_code= (psi_event_size== sizeof(psi_event_t) && psi_event->pid== pid &&
+			psi_event->table_id== table_id &&
+			psi_event->version_number== version_number);
+	free(psi_event);
+	return ret_code;
+}
+
+/**
+ * Instantiate a PSI demultiplexer processor.
+ */
+static int demux_post(procs_ctx_t *procs_ctx, int *ref_proc_id)
+{
+	int ret_code;
+	char *rest_str= NULL;
+	cJSON *cjson_rest= NULL, *cjson_aux= NULL;
+
+	*ref_proc_id= -1;
+	ret_code= procs_opt(procs_ctx, "PROCS_POST", "psi_demux_proc", "",
+			&rest_str);
+	if(ret_code== STAT_SUCCESS && rest_str!= NULL &&
+			(cjson_rest= cJSON_Parse(rest_str))!= NULL &&
+			(cjson_aux= cJSON_GetObjectItem(cjson_rest, "proc_id"))!= NULL)
+		*ref_proc_id= (int)cjson_aux->valuedouble;
+	if(rest_str!= NULL)
+		free(rest_str);
+	if(cjson_rest!= NULL)
+		cJSON_Delete(cjson_rest);
+	return ret_code;
+}
+
+TEST(PSI_DEMUX_PROC_NOTIFY)
+{
+	int i, ret_code, proc_id= -1, cc_pat= 0, cc_pmt= 0, cc_sdt= 0;
+	uint64_t sections_pat= 0, sections_pmt= 0, sections_sdt= 0;
+	uint8_t pkt[TS_PKT_SIZE];
+	procs_ctx_t *procs_ctx= NULL;
+	fifo_ctx_t *fifo_ctx_events= NULL;
+	psi_table_ctx_t *psi_table_ctx= NULL;
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(NULL);
+
+	ret_code= log_module_open();
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_module_open(NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED, goto end);
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_demux_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	procs_ctx= procs_open(NULL, 16, NULL, NULL);
+	CHECK_DO(procs_ctx!= NULL, goto end);
+
+	/* Events queue (non-blocking, so an empty queue can be checked) */
+	fifo_ctx_events= fifo_open(EVENTS_FIFO_SIZE, sizeof(psi_event_t), 0,
+			NULL);
+	CHECK_DO(fifo_ctx_events!= NULL, goto end);
+	fifo_set_blocking_mode(fifo_ctx_events, 0);
+
+	/* PSI demultiplexer parsing the PAT, a PMT and the SDT */
+	ret_code= demux_post(procs_ctx, &proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS && proc_id>= 0, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_SET_NOTIFY", proc_id,
+			(psi_proc_notify_fxn_t)psi_notify, (void*)fifo_ctx_events);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(fifo_get_buffer_level(fifo_ctx_events)== 0, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id, PAT_PID,
+			PSI_PROC_PID_TABLE);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id, PMT_PID,
+			PSI_PROC_PID_SECTION);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id, SDT_PID,
+			PSI_PROC_PID_TABLE);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	/* Each table is repeated; only one event per new version is queued */
+	for(i= 0; i< 3; i++) {
+		pkt_pas_compose(pkt, cc_pat++, 0);
+		CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	}
+	sections_pat+= 3;
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, PAT_PID, sections_pat),
+			goto end);
+	CHECK_DO(event_check(fifo_ctx_events, PAT_PID,
+			PSI_TABLE_PROGRAM_ASSOCIATION_SECTION, 0), goto end);
+
+	for(i= 0; i< 3; i++) {
+		pkt_pms_compose(pkt, cc_pmt++, 0, 0x101);
+		CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	}
+	sections_pmt+= 3;
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, PMT_PID, sections_pmt),
+			goto end);
+	CHECK_DO(event_check(fifo_ctx_events, PMT_PID,
+			PSI_TABLE_TS_PROGRAM_MAP_SECTION, 0), goto end);
+
+	for(i= 0; i< 3; i++) {
+		pkt_sds_compose(pkt, cc_sdt++, 0);
+		CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	}
+	sections_sdt+= 3;
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, SDT_PID, sections_sdt),
+			goto end);
+	CHECK_DO(event_check(fifo_ctx_events, SDT_PID,
+			PSI_DVB_SERVICE_DESCR_SECTION_ACTUAL, 0), goto end);
+
+	/* New versions (repeated too) */
+	for(i= 0; i< 2; i++) {
+		pkt_pas_compose(pkt, cc_pat++, 1);
+		CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	}
+	sections_pat+= 2;
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, PAT_PID, sections_pat),
+			goto end);
+	CHECK_DO(event_check(fifo_ctx_events, PAT_PID,
+			PSI_TABLE_PROGRAM_ASSOCIATION_SECTION, 1), goto end);
+
+	for(i= 0; i< 2; i++) {
+		pkt_pms_compose(pkt, cc_pmt++, 1, 0x102);
+		CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	}
+	sections_pmt+= 2;
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, PMT_PID, sections_pmt),
+			goto end);
+	CHECK_DO(event_check(fifo_ctx_events, PMT_PID,
+			PSI_TABLE_TS_PROGRAM_MAP_SECTION, 1), goto end);
+
+	/* A late repetition of a notified version is not an event either */
+	pkt_sds_compose(pkt, cc_sdt++, 0);
+	CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	sections_sdt+= 1;
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, SDT_PID, sections_sdt),
+			goto end);
+	CHECK_DO(fifo_get_buffer_level(fifo_ctx_events)== 0, goto end);
+
+	/* Current version is the last one notified */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_CSTRUCT_REST",
+			proc_id, PAT_PID, &psi_table_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS && psi_table_ctx!= NULL, goto end);
+	CHECK_DO(psi_table_ctx_get_section(psi_table_ctx, 0)->version_number== 1,
+			goto end);
+
+	/* Registering again notifies once the current version of each PID */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_SET_NOTIFY", proc_id,
+			(psi_proc_notify_fxn_t)psi_notify, (void*)fifo_ctx_events);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(fifo_get_buffer_level(fifo_ctx_events)== 3, goto end);
+	fifo_empty(fifo_ctx_events);
+
+	/* Unregistered callback is not called anymore */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_SET_NOTIFY", proc_id,
+			(psi_proc_notify_fxn_t)NULL, (void*)NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	pkt_pas_compose(pkt, cc_pat++, 2);
+	CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	sections_pat+= 1;
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, PAT_PID, sections_pat),
+			goto end);
+	CHECK_DO(fifo_get_buffer_level(fifo_ctx_events)== 0, goto end);
+
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= -1;
+
+	ret_code= procs_module_opt("PROCS_UNREGISTER_TYPE", "psi_demux_proc");
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	CHECK(end_code== STAT_SUCCESS);
+	psi_table_ctx_release(&psi_table_ctx);
+	if(procs_ctx!= NULL && proc_id>= 0)
+		procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	if(procs_ctx!= NULL)
+		procs_close(&procs_ctx);
+	procs_module_close();
+	fifo_close(&fifo_ctx_events);
+	log_module_close();
+}
+
+TEST(PSI_DEMUX_PROC_PID_ADD_DELETE)
+{
+	int i, ret_code, proc_id= -1, cc_pmt= 0;
+	uint8_t pkt[TS_PKT_SIZE];
+	procs_ctx_t *procs_ctx= NULL;
+	psi_section_ctx_t *psi_section_ctx= NULL, *psi_section_ctx_aux= NULL;
+	psi_proc_stats_t psi_proc_stats;
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(NULL);
+
+	ret_code= log_module_open();
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_module_open(NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED, goto end);
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_demux_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	procs_ctx= procs_open(NULL, 16, NULL, NULL);
+	CHECK_DO(procs_ctx!= NULL, goto end);
+
+	ret_code= demux_post(procs_ctx, &proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS && proc_id>= 0, goto end);
+
+	/* Not registered PID has no context */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_CSTRUCT_REST",
+			proc_id, PMT_PID, &psi_section_ctx);
+	CHECK_DO(ret_code== STAT_ENOTFOUND && psi_section_ctx== NULL, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_STATS", proc_id,
+			PMT_PID, &psi_proc_stats);
+	CHECK_DO(ret_code== STAT_ENOTFOUND, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_DELETE", proc_id,
+			PMT_PID);
+	CHECK_DO(ret_code== STAT_ENOTFOUND, goto end);
+
+	/* Register PID: context is created (nothing parsed yet) */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id, PMT_PID,
+			PSI_PROC_PID_SECTION);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id, PMT_PID,
+			PSI_PROC_PID_SECTION);
+	CHECK_DO(ret_code== STAT_ECONFLICT, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id,
+			TS_MAX_PID_VAL+ 1, PSI_PROC_PID_SECTION);
+	CHECK_DO(ret_code== STAT_EINVAL, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_CSTRUCT_REST",
+			proc_id, PMT_PID, &psi_section_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS && psi_section_ctx== NULL, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_STATS", proc_id,
+			PMT_PID, &psi_proc_stats);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(psi_proc_stats.sections_decoded== 0 &&
+			psi_proc_stats.sections_repeated== 0, goto end);
+
+	/* Registered PID is parsed */
+	for(i= 0; i< 2; i++) {
+		pkt_pms_compose(pkt, cc_pmt++, 0, 0x101);
+		CHECK_DO(pkt_send(procs_ctx, proc_id, pkt)== STAT_SUCCESS, goto end);
+	}
+	CHECK_DO(pid_wait_sections(procs_ctx, proc_id, PMT_PID, 2), goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_CSTRUCT_REST",
+			proc_id, PMT_PID, &psi_section_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS && psi_section_ctx!= NULL, goto end);
+	CHECK_DO(psi_section_ctx->table_id== PSI_TABLE_TS_PROGRAM_MAP_SECTION &&
+			psi_section_ctx->version_number== 0, goto end);
+
+	/* Unregister PID: context is removed (references held are still valid) */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_DELETE", proc_id,
+			PMT_PID);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_DELETE", proc_id,
+			PMT_PID);
+	CHECK_DO(ret_code== STAT_ENOTFOUND, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_CSTRUCT_REST",
+			proc_id, PMT_PID, &psi_section_ctx_aux);
+	CHECK_DO(ret_code== STAT_ENOTFOUND && psi_section_ctx_aux== NULL,
+			goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_STATS", proc_id,
+			PMT_PID, &psi_proc_stats);
+	CHECK_DO(ret_code== STAT_ENOTFOUND, goto end);
+	CHECK_DO(psi_section_ctx->table_id== PSI_TABLE_TS_PROGRAM_MAP_SECTION &&
+			psi_section_ctx->version_number== 0, goto end);
+	psi_section_ctx_release(&psi_section_ctx);
+
+	/* Registering again creates a new context (no previous state kept) */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_ADD", proc_id, PMT_PID,
+			PSI_PROC_PID_SECTION);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_CSTRUCT_REST",
+			proc_id, PMT_PID, &psi_section_ctx);
+	CHECK_DO(ret_code== STAT_SUCCESS && psi_section_ctx== NULL, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_PSI_PID_GET_STATS", proc_id,
+			PMT_PID, &psi_proc_stats);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	CHECK_DO(psi_proc_stats.sections_decoded== 0 &&
+			psi_proc_stats.sections_repeated== 0, goto end);
+
+	/* Deleting the processor releases the registered PIDs */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= -1;
+
+	ret_code= procs_module_opt("PROCS_UNREGISTER_TYPE", "psi_demux_proc");
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	CHECK(end_code== STAT_SUCCESS);
+	psi_section_ctx_release(&psi_section_ctx);
+	psi_section_ctx_release(&psi_section_ctx_aux);
+	if(procs_ctx!= NULL && proc_id>= 0)
+		procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	if(procs_ctx!= NULL)
+		procs_close(&procs_ctx);
+	procs_module_close();
+	log_module_close();
+}
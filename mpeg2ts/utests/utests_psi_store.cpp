@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_store.cpp
+ * @brief Persistent last-known PSI store unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/psi_store.h>
+}
+
+TEST(PSI_STORE_SAVE_LOAD)
+{
+	int i, ret_code, rec_num= 0;
+	FILE *file;
+	const char *url= "udp://239.0.0.1:2000";
+	uint8_t pat[16], pms[32];
+	char *path= NULL;
+	char dir[]= "/tmp/utests_psi_store.XXXXXX";
+	psi_store_rec_t rec_array_in[3];
+	psi_store_rec_t *rec_array= NULL;
+
+	for(i= 0; i< (int)sizeof(pat); i++)
+		pat[i]= (uint8_t)i;
+	for(i= 0; i< (int)sizeof(pms); i++)
+		pms[i]= (uint8_t)(0xFF- i);
+	rec_array_in[0].pid= 0;
+	rec_array_in[0].buf= pat;
+	rec_array_in[0].buf_size= sizeof(pat);
+	rec_array_in[1].pid= 0x100;
+	rec_array_in[1].buf= pms;
+	rec_array_in[1].buf_size= sizeof(pms);
+	rec_array_in[2].pid= 0x11;
+	rec_array_in[2].buf= NULL;
+	rec_array_in[2].buf_size= 0;
+
+	CHECK(mkdtemp(dir)!= NULL);
+	path= psi_store_path(dir, url);
+	CHECK(path!= NULL);
+	remove(path);
+
+	/* Nothing saved yet */
+	ret_code= psi_store_load(path, url, NULL, &rec_array, &rec_num);
+	CHECK(ret_code== STAT_ENOTFOUND && rec_array== NULL && rec_num== 0);
+
+	/* Round trip */
+	ret_code= psi_store_save(path, url, rec_array_in, 3, NULL);
+	CHECK(ret_code== STAT_SUCCESS);
+	ret_code= psi_store_load(path, url, NULL, &rec_array, &rec_num);
+	CHECK(ret_code== STAT_SUCCESS && rec_array!= NULL && rec_num== 3);
+	for(i= 0; i< rec_num && rec_array!= NULL; i++) {
+		CHECK(rec_array[i].pid== rec_array_in[i].pid);
+		CHECK(rec_array[i].buf_size== rec_array_in[i].buf_size);
+		if(rec_array[i].buf_size> 0)
+			CHECK(memcmp(rec_array[i].buf, rec_array_in[i].buf,
+					rec_array[i].buf_size)== 0);
+	}
+	psi_store_recs_release(&rec_array, rec_num);
+	CHECK(rec_array== NULL);
+
+	/* File of other URL (e.g. hash collision) is not loaded */
+	ret_code= psi_store_load(path, "udp://239.0.0.2:2000", NULL, &rec_array,
+			&rec_num);
+	CHECK(ret_code== STAT_ENOTFOUND && rec_array== NULL);
+
+	/* Corrupted file is discarded */
+	file= fopen(path, "r+b");
+	CHECK(file!= NULL);
+	if(file!= NULL) {
+		fseek(file, 40, SEEK_SET);
+		fputc(0x5A, file);
+		fclose(file);
+	}
+	ret_code= psi_store_load(path, url, NULL, &rec_array, &rec_num);
+	CHECK(ret_code== STAT_EINVAL && rec_array== NULL);
+
+	remove(path);
+	free(path);
+	CHECK(rmdir(dir)== 0); // No temporary file left
+}
+
+TEST(PSI_STORE_DIR_CREATE)
+{
+	struct stat st;
+	char dir_parent[]= "/tmp/utests_psi_store.XXXXXX";
+	char dir[sizeof(dir_parent)+ 16];
+
+	CHECK(mkdtemp(dir_parent)!= NULL);
+	snprintf(dir, sizeof(dir), "%s/a/b", dir_parent);
+
+	/* Missing components are created private to the user */
+	CHECK(psi_store_dir_create(dir, NULL)== STAT_SUCCESS);
+	CHECK(stat(dir, &st)== 0 && S_ISDIR(st.st_mode) &&
+			(st.st_mode& 0777)== S_IRWXU);
+
+	/* An existing directory is made private */
+	CHECK(chmod(dir, 0755)== 0);
+	CHECK(psi_store_dir_create(dir, NULL)== STAT_SUCCESS);
+	CHECK(stat(dir, &st)== 0 && (st.st_mode& 0777)== S_IRWXU);
+
+	/* Symbolic links are refused */
+	snprintf(dir, sizeof(dir), "%s/l", dir_parent);
+	CHECK(symlink("a", dir)== 0);
+	CHECK(psi_store_dir_create(dir, NULL)== STAT_EINVAL);
+	remove(dir);
+
+	snprintf(dir, sizeof(dir), "%s/a/b", dir_parent);
+	rmdir(dir);
+	snprintf(dir, sizeof(dir), "%s/a", dir_parent);
+	rmdir(dir);
+	rmdir(dir_parent);
+}
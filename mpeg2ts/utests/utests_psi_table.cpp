@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_table.cpp
+ * @brief PSI table lookup index unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/llist.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_table.h>
+}
+
+static psi_section_ctx_t* pms_section_create(uint16_t program_number,
+		uint16_t pcr_pid, const uint16_t *es_pids, int es_pids_num)
+{
+	int i;
+	psi_section_ctx_t *psi_section_ctx= psi_section_ctx_allocate();
+	psi_pms_ctx_t *psi_pms_ctx= psi_pms_ctx_allocate();
+
+	psi_section_ctx->table_id= PSI_TABLE_TS_PROGRAM_MAP_SECTION;
+	psi_section_ctx->table_id_extension= program_number;
+	psi_section_ctx->data= psi_pms_ctx;
+	psi_pms_ctx->pcr_pid= pcr_pid;
+	for(i= 0; i< es_pids_num; i++) {
+		psi_pms_es_ctx_t *psi_pms_es_ctx= psi_pms_es_ctx_allocate();
+		psi_pms_es_ctx->elementary_PID= es_pids[i];
+		llist_insert_nth(&psi_pms_ctx->psi_pms_es_ctx_llist, i,
+				psi_pms_es_ctx);
+	}
+	return psi_section_ctx;
+}
+
+TEST(PSI_TABLE_PMT_INDEX_ES_PID)
+{
+	int i, pass;
+	const uint16_t es_pids_1[]= {0x101, 0x102};
+	const uint16_t es_pids_2[]= {0x200, 0x201, 0x102}; // 0x102 shared
+	psi_table_pmt_ctx_t *psi_table_pmt_ctx= psi_table_ctx_allocate();
+	psi_section_ctx_t *psi_section_ctx_pms_1, *psi_section_ctx_pms_2;
+
+	CHECK(psi_table_pmt_ctx!= NULL);
+
+	/* Program 1 PCR PID is carried in program 2 elementary stream 0x200 */
+	psi_section_ctx_pms_1= pms_section_create(1, 0x200, es_pids_1, 2);
+	psi_section_ctx_pms_2= pms_section_create(2, 0x200, es_pids_2, 3);
+	llist_insert_nth(&psi_table_pmt_ctx->psi_section_ctx_llist, 0,
+			psi_section_ctx_pms_1);
+	llist_insert_nth(&psi_table_pmt_ctx->psi_section_ctx_llist, 1,
+			psi_section_ctx_pms_2);
+
+	/* Lookups must be the same with (second pass) or without index */
+	for(pass= 0; pass< 2; pass++) {
+		psi_section_ctx_t *psi_section_ctx_pms= NULL;
+		psi_pms_es_ctx_t *psi_pms_es_ctx;
+
+		if(pass== 1)
+			CHECK(psi_table_ctx_index(psi_table_pmt_ctx)== STAT_SUCCESS);
+
+		CHECK(psi_table_pmt_ctx_filter_program_num(psi_table_pmt_ctx, 2)==
+				psi_section_ctx_pms_2);
+
+		psi_pms_es_ctx= psi_table_pmt_ctx_filter_es_pid(psi_table_pmt_ctx,
+				0x101, &psi_section_ctx_pms);
+		CHECK(psi_pms_es_ctx!= NULL && psi_pms_es_ctx->elementary_PID== 0x101);
+		CHECK(psi_section_ctx_pms== psi_section_ctx_pms_1);
+
+		/* First program in the table prevails */
+		psi_pms_es_ctx= psi_table_pmt_ctx_filter_es_pid(psi_table_pmt_ctx,
+				0x102, &psi_section_ctx_pms);
+		CHECK(psi_pms_es_ctx!= NULL);
+		CHECK(psi_section_ctx_pms== psi_section_ctx_pms_1);
+
+		/* An elementary stream PID prevails over a PCR PID */
+		psi_pms_es_ctx= psi_table_pmt_ctx_filter_es_pid(psi_table_pmt_ctx,
+				0x200, &psi_section_ctx_pms);
+		CHECK(psi_pms_es_ctx!= NULL && psi_pms_es_ctx->elementary_PID== 0x200);
+		CHECK(psi_section_ctx_pms== psi_section_ctx_pms_2);
+
+		for(i= 0x300; i< 0x310; i++) {
+			CHECK(psi_table_pmt_ctx_filter_es_pid(psi_table_pmt_ctx, i,
+					&psi_section_ctx_pms)== NULL);
+			CHECK(psi_section_ctx_pms== NULL);
+		}
+		CHECK(psi_table_pmt_ctx_filter_es_pid(psi_table_pmt_ctx, 0x201,
+				NULL)!= NULL);
+	}
+
+	psi_table_ctx_release(&psi_table_pmt_ctx);
+	CHECK(psi_table_pmt_ctx== NULL);
+}
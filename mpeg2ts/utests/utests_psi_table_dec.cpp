@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_table_dec.cpp
+ * @brief PSI table assembly unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/llist.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_table.h>
+#include <libstreamprocsmpeg2ts/psi_table_dec.h>
+}
+
+static psi_section_ctx_t* section_create(uint8_t table_id,
+		uint16_t table_id_extension, uint8_t version_number,
+		uint8_t section_number, uint8_t last_section_number)
+{
+	psi_section_ctx_t *psi_section_ctx= psi_section_ctx_allocate();
+
+	psi_section_ctx->table_id= table_id;
+	psi_section_ctx->table_id_extension= table_id_extension;
+	psi_section_ctx->version_number= version_number;
+	psi_section_ctx->current_next_indicator= 1;
+	psi_section_ctx->section_number= section_number;
+	psi_section_ctx->last_section_number= last_section_number;
+	return psi_section_ctx;
+}
+
+/**
+ * Put a new section into the map; returns the status code.
+ */
+static int section_put(psi_table_dec_map_t *psi_table_dec_map,
+		uint16_t table_id_extension, uint8_t version_number,
+		uint8_t section_number, uint8_t last_section_number,
+		psi_table_ctx_t **ref_psi_table_ctx)
+{
+	psi_section_ctx_t *psi_section_ctx= section_create(0x42,
+			table_id_extension, version_number, section_number,
+			last_section_number);
+
+	return psi_table_dec_map_put_section(psi_table_dec_map, NULL,
+			&psi_section_ctx, ref_psi_table_ctx);
+}
+
+/**
+ * Check the table has the given identification, and its sections are
+ * ordered by section number.
+ */
+static int table_check(psi_table_ctx_t *psi_table_ctx,
+		uint16_t table_id_extension, uint8_t version_number, int sections_num)
+{
+	int i= 0;
+	llist_t *n;
+
+	if(psi_table_ctx== NULL)
+		return 0;
+	for(n= psi_table_ctx->psi_section_ctx_llist; n!= NULL; n= n->next, i++) {
+		psi_section_ctx_t *psi_section_ctx= (psi_section_ctx_t*)n->data;
+		if(psi_section_ctx->table_id_extension!= table_id_extension ||
+				psi_section_ctx->version_number!= version_number ||
+				psi_section_ctx->section_number!= i)
+			return 0;
+	}
+	return i== sections_num;
+}
+
+TEST(PSI_TABLE_DEC_MAP_INTERLEAVED)
+{
+	int i;
+	psi_table_dec_map_t psi_table_dec_map;
+	psi_table_ctx_t *psi_table_ctx= NULL;
+
+	psi_table_dec_map_init(&psi_table_dec_map);
+
+	/* Two sub-tables (extensions 1 and 2) interleaved, sections out of
+	 * order and repeated.
+	 */
+	CHECK(section_put(&psi_table_dec_map, 1, 0, 2, 2, &psi_table_ctx)==
+			STAT_EAGAIN);
+	CHECK(section_put(&psi_table_dec_map, 2, 5, 1, 1, &psi_table_ctx)==
+			STAT_EAGAIN);
+	CHECK(section_put(&psi_table_dec_map, 1, 0, 0, 2, &psi_table_ctx)==
+			STAT_EAGAIN);
+	CHECK(section_put(&psi_table_dec_map, 1, 0, 2, 2, &psi_table_ctx)==
+			STAT_EAGAIN); // Repeated
+	CHECK(section_put(&psi_table_dec_map, 2, 5, 0, 1, &psi_table_ctx)==
+			STAT_SUCCESS);
+	CHECK(table_check(psi_table_ctx, 2, 5, 2));
+	psi_table_ctx_release(&psi_table_ctx);
+	CHECK(section_put(&psi_table_dec_map, 1, 0, 1, 2, &psi_table_ctx)==
+			STAT_SUCCESS);
+	CHECK(table_check(psi_table_ctx, 1, 0, 3));
+	psi_table_ctx_release(&psi_table_ctx);
+
+	/* A new version interleaved with the repetition of the previous one;
+	 * when the new version is completed the previous one is discarded.
+	 */
+	CHECK(section_put(&psi_table_dec_map, 1, 1, 1, 1, &psi_table_ctx)==
+			STAT_EAGAIN);
+	CHECK(section_put(&psi_table_dec_map, 1, 0, 0, 2, &psi_table_ctx)==
+			STAT_EAGAIN);
+	CHECK(section_put(&psi_table_dec_map, 1, 1, 0, 1, &psi_table_ctx)==
+			STAT_SUCCESS);
+	CHECK(table_check(psi_table_ctx, 1, 1, 2));
+	psi_table_ctx_release(&psi_table_ctx);
+	for(i= 0; i< PSI_TABLE_DEC_MAP_SIZE; i++)
+		CHECK(psi_table_dec_map.psi_table_dec_ctx_array[i].received_count==
+				0);
+
+	/* Map full: the least recently updated table is discarded */
+	for(i= 0; i< PSI_TABLE_DEC_MAP_SIZE+ 1; i++)
+		CHECK(section_put(&psi_table_dec_map, 10+ i, 0, 0, 1,
+				&psi_table_ctx)== STAT_EAGAIN);
+	CHECK(section_put(&psi_table_dec_map, 10, 0, 1, 1, &psi_table_ctx)==
+			STAT_EAGAIN); // First table was discarded
+	CHECK(section_put(&psi_table_dec_map, 10+ PSI_TABLE_DEC_MAP_SIZE, 0, 1,
+			1, &psi_table_ctx)== STAT_SUCCESS);
+	CHECK(table_check(psi_table_ctx, 10+ PSI_TABLE_DEC_MAP_SIZE, 0, 2));
+	psi_table_ctx_release(&psi_table_ctx);
+
+	psi_table_dec_map_deinit(&psi_table_dec_map);
+	for(i= 0; i< PSI_TABLE_DEC_MAP_SIZE; i++)
+		CHECK(psi_table_dec_map.psi_table_dec_ctx_array[i].received_count==
+				0);
+}
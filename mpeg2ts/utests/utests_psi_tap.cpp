@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_psi_tap.cpp
+ * @brief PSI section tap processor unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+
+#include <libcjson/cJSON.h>
+
+#define ENABLE_DEBUG_LOGS //uncomment to trace logs
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/check_utils.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/fifo.h>
+#include <libmediaprocs/proc_if.h>
+#include <libmediaprocs/procs.h>
+#include <libmediaprocs/proc.h>
+#include <libstreamprocsmpeg2ts/ts.h>
+#include <libstreamprocsmpeg2ts/psi_crc.h>
+#include <libstreamprocsmpeg2ts/psi_proc.h>
+}
+
+#define TAP_PID 0x100
+#define TAP_SIZE 2
+#define TAP_NAME "/utests-psi-tap"
+#define TAP_TIMEOUT_MSEC 5000
+
+/**
+ * Compose a TS packet carrying a Program Association Section with the given
+ * transport stream identifier.
+ */
+static void pkt_pas_compose(uint8_t *pkt, uint16_t transport_stream_id,
+		int cc)
+{
+	uint32_t crc_32;
+	size_t size= 0;
+	uint8_t *buf= &pkt[TS_PKT_PREFIX_LEN+ 1];
+	const size_t section_length= 5+ 4+ 4;
+
+	memset(pkt, 0xFF, TS_PKT_SIZE);
+	pkt[0]= 0x47;
+	pkt[1]= 0x40| (uint8_t)(TAP_PID>> 8);
+	pkt[2]= (uint8_t)TAP_PID;
+	pkt[3]= 0x10| (uint8_t)(cc& 0x0F);
+	pkt[TS_PKT_PREFIX_LEN]= 0; // 'pointer_field'
+
+	buf[size++]= 0x00; // 'table_id'
+	buf[size++]= 0xB0| (uint8_t)(section_length>> 8);
+	buf[size++]= (uint8_t)section_length;
+	buf[size++]= (uint8_t)(transport_stream_id>> 8);
+	buf[size++]= (uint8_t)transport_stream_id;
+	buf[size++]= 0xC1; // version 0, 'current_next_indicator' set
+	buf[size++]= 0; // 'section_number'
+	buf[size++]= 0; // 'last_section_number'
+	buf[size++]= 0;
+	buf[size++]= 1; // 'program_number'
+	buf[size++]= 0xE1;
+	buf[size++]= 0x00; // 'program_map_PID'
+	crc_32= psi_crc32(buf, size);
+	buf[size++]= (uint8_t)(crc_32>> 24);
+	buf[size++]= (uint8_t)(crc_32>> 16);
+	buf[size++]= (uint8_t)(crc_32>> 8);
+	buf[size++]= (uint8_t)crc_32;
+}
+
+/**
+ * Instantiate a tap processor; returns the status code of the POST.
+ */
+static int tap_post(procs_ctx_t *procs_ctx, const char *settings,
+		int *ref_proc_id)
+{
+	int ret_code;
+	char *rest_str= NULL;
+	cJSON *cjson_rest= NULL, *cjson_aux= NULL;
+
+	*ref_proc_id= -1;
+	ret_code= procs_opt(procs_ctx, "PROCS_POST", "psi_tap_proc", settings,
+			&rest_str);
+	if(ret_code== STAT_SUCCESS && rest_str!= NULL &&
+			(cjson_rest= cJSON_Parse(rest_str))!= NULL &&
+			(cjson_aux= cJSON_GetObjectItem(cjson_rest, "proc_id"))!= NULL)
+		*ref_proc_id= (int)cjson_aux->valuedouble;
+	if(rest_str!= NULL)
+		free(rest_str);
+	if(cjson_rest!= NULL)
+		cJSON_Delete(cjson_rest);
+	return ret_code;
+}
+
+/**
+ * Wait for the tap to write the given number of sections.
+ */
+static int tap_wait_tapped(procs_ctx_t *procs_ctx, int proc_id,
+		uint64_t sections_tapped,
+		psi_proc_tap_stats_t *psi_proc_tap_stats)
+{
+	int i;
+
+	for(i= 0; i< TAP_TIMEOUT_MSEC/ 10; i++) {
+		if(procs_opt(procs_ctx, "PROCS_ID_PSI_TAP_GET_STATS", proc_id,
+				psi_proc_tap_stats)!= STAT_SUCCESS)
+			return 0;
+		if(psi_proc_tap_stats->sections_tapped>= sections_tapped)
+			return 1;
+		usleep(10* 1000);
+	}
+	return 0;
+}
+
+/**
+ * Get next section from the tap consumer FIFO and check its transport
+ * stream identifier.
+ */
+static int tap_get_check(fifo_ctx_t *fifo_ctx, uint16_t transport_stream_id)
+{
+	int ret_code;
+	uint8_t *sect= NULL;
+	size_t sect_size= 0;
+
+	if(fifo_get(fifo_ctx, (void**)&sect, &sect_size)!= STAT_SUCCESS ||
+			sect== NULL)
+		return 0;
+	ret_code= sect_size>= 8 && ((sect[3]<< 8)| sect[4])==
+			transport_stream_id;
+	free(sect);
+	return ret_code;
+}
+
+TEST(PSI_TAP_POST_DELETE)
+{
+	int ret_code, proc_id= -1;
+	procs_ctx_t *procs_ctx= NULL;
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(NULL);
+
+	ret_code= log_module_open();
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_module_open(NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED, goto end);
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_tap_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	procs_ctx= procs_open(NULL, 4, NULL, NULL);
+	CHECK_DO(procs_ctx!= NULL, goto end);
+
+	/* A tap name is mandatory */
+	ret_code= tap_post(procs_ctx, "forced_proc_id=1", &proc_id);
+	CHECK_DO(ret_code!= STAT_SUCCESS, goto end);
+
+	/* Taps are created with the given Id.; the Id. can not be duplicated */
+	ret_code= tap_post(procs_ctx,
+			"forced_proc_id=1&tap_name="TAP_NAME, &proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS && proc_id== 1, goto end);
+	ret_code= tap_post(procs_ctx,
+			"forced_proc_id=1&tap_name="TAP_NAME"-dup", &proc_id);
+	CHECK_DO(ret_code!= STAT_SUCCESS, goto end);
+
+	/* Deleting the tap releases its Id. */
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", 1);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", 1);
+	CHECK_DO(ret_code!= STAT_SUCCESS, goto end);
+	ret_code= tap_post(procs_ctx,
+			"forced_proc_id=1&tap_name="TAP_NAME, &proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS && proc_id== 1, goto end);
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", 1);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	ret_code= procs_module_opt("PROCS_UNREGISTER_TYPE", "psi_tap_proc");
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	CHECK(end_code== STAT_SUCCESS);
+	if(procs_ctx!= NULL)
+		procs_close(&procs_ctx);
+	procs_module_close();
+	log_module_close();
+}
+
+TEST(PSI_TAP_DROP_OLDEST)
+{
+	int i, ret_code, proc_id= -1;
+	procs_ctx_t *procs_ctx= NULL;
+	fifo_ctx_t *fifo_ctx= NULL;
+	uint8_t pkt[TS_PKT_SIZE];
+	psi_proc_tap_stats_t psi_proc_tap_stats= {0};
+	void *elem= NULL;
+	size_t elem_size= 0;
+	int end_code= STAT_ERROR;
+	LOG_CTX_INIT(NULL);
+
+	ret_code= log_module_open();
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	ret_code= procs_module_open(NULL);
+	CHECK_DO(ret_code== STAT_SUCCESS || ret_code== STAT_NOTMODIFIED, goto end);
+	ret_code= procs_module_opt("PROCS_REGISTER_TYPE", &proc_if_psi_tap_proc);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	procs_ctx= procs_open(NULL, 4, NULL, NULL);
+	CHECK_DO(procs_ctx!= NULL, goto end);
+
+	ret_code= tap_post(procs_ctx,
+			"forced_proc_id=0&tap_size=2&tap_name="TAP_NAME, &proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS && proc_id== 0, goto end);
+
+	/* Consumer maps the tap FIFO (nobody reads it while the tap is fed) */
+	fifo_ctx= fifo_shm_exec_open(TAP_SIZE, PSI_PROC_TAP_CHUNK_SIZE,
+			FIFO_O_NONBLOCK, TAP_NAME);
+	CHECK_DO(fifo_ctx!= NULL, goto end);
+
+	/* Feed one more section than the FIFO can hold */
+	for(i= 0; i< TAP_SIZE+ 1; i++) {
+		proc_frame_ctx_t proc_frame_ctx= {0};
+
+		pkt_pas_compose(pkt, (uint16_t)(i+ 1), i);
+		proc_frame_ctx.data= pkt;
+		proc_frame_ctx.p_data[0]= pkt;
+		proc_frame_ctx.linesize[0]= TS_PKT_SIZE;
+		proc_frame_ctx.width[0]= TS_PKT_SIZE;
+		proc_frame_ctx.height[0]= 1;
+		proc_frame_ctx.proc_sample_fmt= PROC_IF_FMT_UNDEF;
+		proc_frame_ctx.pts= -1;
+		proc_frame_ctx.dts= -1;
+		proc_frame_ctx.es_id= TAP_PID;
+		ret_code= procs_send_frame(procs_ctx, proc_id, &proc_frame_ctx);
+		CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	}
+	CHECK_DO(tap_wait_tapped(procs_ctx, proc_id, TAP_SIZE+ 1,
+			&psi_proc_tap_stats)!= 0, goto end);
+
+	/* The oldest section was dropped; the newest ones are kept in order */
+	CHECK_DO(psi_proc_tap_stats.sections_tapped== TAP_SIZE+ 1, goto end);
+	CHECK_DO(psi_proc_tap_stats.sections_overwritten== 1, goto end);
+	CHECK_DO(psi_proc_tap_stats.sections_filtered== 0, goto end);
+	CHECK_DO(tap_get_check(fifo_ctx, 2)!= 0, goto end);
+	CHECK_DO(tap_get_check(fifo_ctx, 3)!= 0, goto end);
+	CHECK_DO(fifo_get(fifo_ctx, &elem, &elem_size)!= STAT_SUCCESS,
+			goto end);
+
+	ret_code= procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+	proc_id= -1;
+
+	ret_code= procs_module_opt("PROCS_UNREGISTER_TYPE", "psi_tap_proc");
+	CHECK_DO(ret_code== STAT_SUCCESS, goto end);
+
+	end_code= STAT_SUCCESS;
+end:
+	CHECK(end_code== STAT_SUCCESS);
+	if(elem!= NULL)
+		free(elem);
+	fifo_shm_exec_close(&fifo_ctx);
+	if(procs_ctx!= NULL && proc_id>= 0)
+		procs_opt(procs_ctx, "PROCS_ID_DELETE", proc_id);
+	if(procs_ctx!= NULL)
+		procs_close(&procs_ctx);
+	procs_module_close();
+	log_module_close();
+}
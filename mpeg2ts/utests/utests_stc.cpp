@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_stc.cpp
+ * @brief System Time Clock (STC) estimator unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/stc.h>
+}
+
+/* PCR period [usecs] and encoder clock drift [ppm] of the synthetic
+ * sequences.
+ */
+#define PCR_PERIOD_USEC 40000
+#define PCR_DRIFT_PPM 50.0
+
+/**
+ * PCR of the synthetic sequence at the given (ideal) local time,
+ * wrapped to the PCR range.
+ */
+static int64_t pcr_at(int64_t pcr_0, int64_t usec)
+{
+	double slope= ((double)STC_CLOCK_FREQ/ 1000000.0)*
+			(1.0+ PCR_DRIFT_PPM/ 1e6);
+	return (pcr_0+ (int64_t)(slope* (double)usec))% STC_PCR_WRAP;
+}
+
+/**
+ * Distance between two PCR values in the wrapped range [27MHz units].
+ */
+static int64_t pcr_dist(int64_t pcr1, int64_t pcr2)
+{
+	int64_t diff= (pcr1- pcr2)% STC_PCR_WRAP;
+
+	if(diff< 0)
+		diff+= STC_PCR_WRAP;
+	if(diff>= STC_PCR_WRAP/ 2)
+		diff-= STC_PCR_WRAP;
+	return diff< 0? -diff: diff;
+}
+
+TEST(STC_FIT_DRIFT)
+{
+	int i;
+	int64_t usec= 0, stc= 0;
+	const int64_t t_0= 1000000, pcr_0= 12345;
+	stc_ctx_t *stc_ctx= NULL;
+	stc_stats_ctx_t stc_stats_ctx;
+
+	stc_ctx= stc_open(NULL);
+	CHECK(stc_ctx!= NULL);
+	if(stc_ctx== NULL)
+		return;
+
+	/* Not locked before receiving samples */
+	CHECK(stc_get(stc_ctx, t_0, &stc)== STAT_ENODATA);
+
+	/* Jitter free sequence: the fit recovers the drift */
+	for(i= 0; i< 256; i++) {
+		usec= (int64_t)i* PCR_PERIOD_USEC;
+		CHECK(stc_put_pcr(stc_ctx, pcr_at(pcr_0, usec), t_0+ usec, 0)==
+				STAT_SUCCESS);
+	}
+	CHECK(stc_get_stats(stc_ctx, &stc_stats_ctx)== STAT_SUCCESS);
+	CHECK(stc_stats_ctx.flag_locked!= 0);
+	CHECK_CLOSE(PCR_DRIFT_PPM, stc_stats_ctx.drift_ppm, 1.0);
+	CHECK(stc_stats_ctx.samples_count== 256);
+	CHECK(stc_stats_ctx.outliers_count== 0);
+
+	/* Extrapolation (100 msecs after the last sample) */
+	usec+= 100000;
+	CHECK(stc_get(stc_ctx, t_0+ usec, &stc)== STAT_SUCCESS);
+	CHECK(pcr_dist(stc, pcr_at(pcr_0, usec))< 27); // < 1 usec
+
+	/* Jittered sequence (+/-200 usecs) and one outlier (+5 msecs) */
+	stc_reset(stc_ctx);
+	srand(0);
+	for(i= 0; i< 256; i++) {
+		int64_t jitter= (rand()% 401)- 200;
+
+		usec= (int64_t)i* PCR_PERIOD_USEC;
+		if(i== 200)
+			jitter= 5000;
+		stc_put_pcr(stc_ctx, pcr_at(pcr_0, usec), t_0+ usec+ jitter, 0);
+	}
+	CHECK(stc_get_stats(stc_ctx, &stc_stats_ctx)== STAT_SUCCESS);
+	CHECK(stc_stats_ctx.flag_locked!= 0);
+	CHECK(stc_stats_ctx.outliers_count>= 1);
+	CHECK(stc_stats_ctx.discontinuities_count== 0);
+	CHECK_CLOSE(PCR_DRIFT_PPM, stc_stats_ctx.drift_ppm, 30.0);
+	CHECK(stc_get(stc_ctx, t_0+ usec, &stc)== STAT_SUCCESS);
+	CHECK(pcr_dist(stc, pcr_at(pcr_0, usec))< 27000); // < 1 msec
+
+	/* Signaled discontinuity: estimator restarts (unlocked) */
+	CHECK(stc_put_pcr(stc_ctx, 0, t_0+ usec+ PCR_PERIOD_USEC, 1)==
+			STAT_SUCCESS);
+	CHECK(stc_get_stats(stc_ctx, &stc_stats_ctx)== STAT_SUCCESS);
+	CHECK(stc_stats_ctx.flag_locked== 0);
+	CHECK(stc_stats_ctx.discontinuities_count== 1);
+
+	stc_close(&stc_ctx);
+	CHECK(stc_ctx== NULL);
+}
+
+TEST(STC_PCR_WRAP)
+{
+	int i, wrapped= 0;
+	int64_t usec= 0, pcr, pcr_prev= -1, stc= 0;
+	const int64_t t_0= 1000000;
+	// Two seconds before the 33-bit base wrap-around
+	const int64_t pcr_0= STC_PCR_WRAP- (int64_t)2* STC_CLOCK_FREQ;
+	stc_ctx_t *stc_ctx= NULL;
+	stc_stats_ctx_t stc_stats_ctx;
+
+	stc_ctx= stc_open(NULL);
+	CHECK(stc_ctx!= NULL);
+	if(stc_ctx== NULL)
+		return;
+
+	for(i= 0; i< 200; i++) {
+		usec= (int64_t)i* PCR_PERIOD_USEC;
+		pcr= pcr_at(pcr_0, usec);
+		if(pcr_prev>= 0 && pcr< pcr_prev)
+			wrapped= 1;
+		pcr_prev= pcr;
+		CHECK(stc_put_pcr(stc_ctx, pcr, t_0+ usec, 0)== STAT_SUCCESS);
+
+		/* STC is continuous across the wrap point, and wrapped itself */
+		if(i>= 4) {
+			int64_t usec_next= usec+ PCR_PERIOD_USEC/ 2;
+
+			CHECK(stc_get(stc_ctx, t_0+ usec_next, &stc)== STAT_SUCCESS);
+			CHECK(stc>= 0 && stc< STC_PCR_WRAP);
+			CHECK(pcr_dist(stc, pcr_at(pcr_0, usec_next))< 27);
+		}
+	}
+	CHECK(wrapped!= 0);
+
+	CHECK(stc_get_stats(stc_ctx, &stc_stats_ctx)== STAT_SUCCESS);
+	CHECK(stc_stats_ctx.flag_locked!= 0);
+	CHECK(stc_stats_ctx.discontinuities_count== 0);
+	CHECK(stc_stats_ctx.outliers_count== 0);
+	CHECK_CLOSE(PCR_DRIFT_PPM, stc_stats_ctx.drift_ppm, 1.0);
+
+	/* Past the wrap point the STC is small again */
+	CHECK(stc_get(stc_ctx, t_0+ usec, &stc)== STAT_SUCCESS);
+	CHECK(stc< (int64_t)10* STC_CLOCK_FREQ);
+
+	stc_close(&stc_ctx);
+}
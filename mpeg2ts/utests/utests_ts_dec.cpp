@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_ts_dec.cpp
+ * @brief MPEG2-TS packet decoding unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/stat_codes.h>
+#include <libstreamprocsmpeg2ts/ts.h>
+#include <libstreamprocsmpeg2ts/ts_dec.h>
+}
+
+#define ES_PID 0x100
+
+/**
+ * Write a PES time-stamp field (5 bytes) with the given 4-bit prefix.
+ */
+static void pes_ts_compose(uint8_t *buf, uint8_t prefix, int64_t ts)
+{
+	buf[0]= (prefix<< 4)| ((ts>> 29)& 0x0E)| 0x01;
+	buf[1]= (ts>> 22)& 0xFF;
+	buf[2]= ((ts>> 14)& 0xFE)| 0x01;
+	buf[3]= (ts>> 7)& 0xFF;
+	buf[4]= ((ts<< 1)& 0xFE)| 0x01;
+}
+
+/**
+ * Compose a TS packet starting a video PES with the given 'PTS_DTS_flags'
+ * and 'PES_header_data_length'; an adaptation field of 'af_len' bytes
+ * ('adaptation_field_length' included) is inserted if non-zero.
+ * Returns the offset of the PES header in the packet.
+ */
+static int pes_pkt_compose(uint8_t *pkt, uint8_t pts_dts_flags,
+		uint8_t header_data_length, int af_len, int64_t pts, int64_t dts)
+{
+	int pes_offset= TS_PKT_PREFIX_LEN+ af_len;
+	uint8_t *pes= &pkt[pes_offset];
+
+	memset(pkt, 0xFF, TS_PKT_SIZE);
+	pkt[0]= 0x47;
+	pkt[1]= 0x40| (ES_PID>> 8); // 'payload_unit_start_indicator' set
+	pkt[2]= ES_PID& 0xFF;
+	pkt[3]= (af_len> 0? 0x30: 0x10);
+	if(af_len> 0) {
+		pkt[4]= af_len- 1;
+		if(af_len> 1)
+			pkt[5]= 0x00;
+	}
+	if(pes_offset+ 9> TS_PKT_SIZE)
+		return pes_offset;
+
+	pes[0]= 0x00; pes[1]= 0x00; pes[2]= 0x01;
+	pes[3]= 0xE0; // video stream
+	pes[4]= pes[5]= 0x00;
+	pes[6]= 0x80;
+	pes[7]= pts_dts_flags<< 6;
+	pes[8]= header_data_length;
+	if(pts_dts_flags== 0x02 && pes_offset+ 9+ 5<= TS_PKT_SIZE)
+		pes_ts_compose(&pes[9], 0x2, pts);
+	if(pts_dts_flags== 0x03 && pes_offset+ 9+ 5<= TS_PKT_SIZE)
+		pes_ts_compose(&pes[9], 0x3, pts);
+	if(pts_dts_flags== 0x03 && pes_offset+ 9+ 10<= TS_PKT_SIZE)
+		pes_ts_compose(&pes[14], 0x1, dts);
+	return pes_offset;
+}
+
+TEST(TS_DEC_PES_PEEK_TIMESTAMPS)
+{
+	uint8_t pkt[TS_PKT_SIZE];
+	int64_t pts, dts;
+	const int64_t pts_in= 0x1DEADBEEFLL, dts_in= 0x1DEADBEEFLL- 3600;
+
+	/* PTS only: DTS equals PTS */
+	pes_pkt_compose(pkt, 0x02, 5, 0, pts_in, 0);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_SUCCESS);
+	CHECK(pts== pts_in);
+	CHECK(dts== pts_in);
+
+	/* PTS and DTS */
+	pes_pkt_compose(pkt, 0x03, 10, 0, pts_in, dts_in);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_SUCCESS);
+	CHECK(pts== pts_in);
+	CHECK(dts== dts_in);
+
+	/* 'PES_header_data_length' larger than the time-stamp fields (stuffing)
+	 * is legal.
+	 */
+	pes_pkt_compose(pkt, 0x03, 16, 0, pts_in, dts_in);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_SUCCESS);
+	CHECK(pts== pts_in);
+	CHECK(dts== dts_in);
+
+	/* No time-stamps */
+	pes_pkt_compose(pkt, 0x00, 0, 0, 0, 0);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_ENOTFOUND);
+	CHECK(pts== TS_TIMESTAMP_INVALID);
+	CHECK(dts== TS_TIMESTAMP_INVALID);
+
+	/* 'PES_header_data_length' too short for the PTS */
+	pes_pkt_compose(pkt, 0x02, 4, 0, pts_in, 0);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_ENOTFOUND);
+	CHECK(pts== TS_TIMESTAMP_INVALID);
+	CHECK(dts== TS_TIMESTAMP_INVALID);
+
+	/* 'PES_header_data_length' too short for the DTS: the DTS is not
+	 * silently replaced by the PTS.
+	 */
+	pes_pkt_compose(pkt, 0x03, 5, 0, pts_in, dts_in);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_ENOTFOUND);
+	CHECK(pts== TS_TIMESTAMP_INVALID);
+	CHECK(dts== TS_TIMESTAMP_INVALID);
+
+	/* DTS does not fit in the packet (PTS does) */
+	pes_pkt_compose(pkt, 0x03, 10, TS_PKT_SIZE- TS_PKT_PREFIX_LEN- 9- 5,
+			pts_in, dts_in);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_ENOTFOUND);
+	CHECK(pts== TS_TIMESTAMP_INVALID);
+	CHECK(dts== TS_TIMESTAMP_INVALID);
+
+	/* ... while the PTS only still fits */
+	pes_pkt_compose(pkt, 0x02, 5, TS_PKT_SIZE- TS_PKT_PREFIX_LEN- 9- 5,
+			pts_in, 0);
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_SUCCESS);
+	CHECK(pts== pts_in);
+	CHECK(dts== pts_in);
+
+	/* Not a PES start */
+	pes_pkt_compose(pkt, 0x02, 5, 0, pts_in, 0);
+	pkt[1]&= ~0x40;
+	CHECK(ts_dec_pes_peek_timestamps(pkt, &pts, &dts)== STAT_ENOTFOUND);
+}
+
+/**
+ * Compose a TS packet of ES_PID with the given continuity counter; the
+ * adaptation field control is set from 'af_only' (adaptation field only,
+ * no payload) and 'discontinuity' (adaptation field with the
+ * 'discontinuity_indicator' set, followed by the payload).
+ */
+static void cc_pkt_compose(uint8_t *pkt, uint8_t cc, int af_only,
+		int discontinuity, uint8_t payload_byte)
+{
+	memset(pkt, 0xFF, TS_PKT_SIZE);
+	pkt[0]= 0x47;
+	pkt[1]= ES_PID>> 8;
+	pkt[2]= ES_PID& 0xFF;
+	pkt[3]= (cc& 0x0F)| 0x10;
+	pkt[TS_PKT_PREFIX_LEN]= payload_byte;
+	if(af_only) {
+		pkt[3]= (cc& 0x0F)| 0x20;
+		pkt[4]= TS_PKT_SIZE- TS_PKT_PREFIX_LEN- 1;
+		pkt[5]= 0x00;
+	} else if(discontinuity) {
+		pkt[3]= (cc& 0x0F)| 0x30;
+		pkt[4]= 1;
+		pkt[5]= 0x80; // 'discontinuity_indicator'
+		pkt[6]= payload_byte;
+	}
+}
+
+TEST(TS_DEC_CC_CHECK_PACKET)
+{
+	uint8_t pkt[TS_PKT_SIZE];
+	ts_dec_cc_ctx_t ts_dec_cc_ctx;
+
+	ts_dec_cc_ctx_init(&ts_dec_cc_ctx);
+	CHECK(ts_dec_cc_ctx.duplicates_count== 0);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 0);
+
+	/* First packet: continuity counter is not known yet */
+	cc_pkt_compose(pkt, 3, 0, 0, 0xA0);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 0);
+
+	/* Continuous packet */
+	cc_pkt_compose(pkt, 4, 0, 0, 0xA1);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 0);
+
+	/* An exact duplicate is dropped once... */
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_ENODATA);
+	CHECK(ts_dec_cc_ctx.duplicates_count== 1);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 0);
+
+	/* ... a second duplicate is not a legal duplicate: it is accepted and
+	 * accounted as a continuity error.
+	 */
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.duplicates_count== 1);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 1);
+
+	/* Same continuity counter with a different payload is not a
+	 * duplicate.
+	 */
+	cc_pkt_compose(pkt, 5, 0, 0, 0xA2);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	cc_pkt_compose(pkt, 5, 0, 0, 0xA3);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.duplicates_count== 1);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 2);
+
+	/* Continuity counter jump */
+	cc_pkt_compose(pkt, 9, 0, 0, 0xA4);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 3);
+
+	/* Adaptation field only packets do not advance the continuity
+	 * counter...
+	 */
+	cc_pkt_compose(pkt, 9, 1, 0, 0);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.duplicates_count== 1);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 3);
+	cc_pkt_compose(pkt, 10, 0, 0, 0xA5);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 3);
+
+	/* ... and are an error if they do */
+	cc_pkt_compose(pkt, 11, 1, 0, 0);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 4);
+
+	/* The 'discontinuity_indicator' resets the continuity counter */
+	cc_pkt_compose(pkt, 2, 0, 1, 0xA6);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 4);
+	cc_pkt_compose(pkt, 3, 0, 0, 0xA7);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 4);
+
+	/* Null packets are not checked */
+	cc_pkt_compose(pkt, 0, 0, 0, 0xA8);
+	pkt[1]= 0x1F; pkt[2]= 0xFF;
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_check_packet(&ts_dec_cc_ctx, pkt, NULL)== STAT_SUCCESS);
+	CHECK(ts_dec_cc_ctx.duplicates_count== 1);
+	CHECK(ts_dec_cc_ctx.cc_errors_count== 4);
+
+	/* A NULL context accepts every packet */
+	CHECK(ts_dec_cc_check_packet(NULL, pkt, NULL)== STAT_SUCCESS);
+}
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2015, 2016, 2017, 2018 Rafael Antoniello
+ *
+ * This file is part of StreamProcessors.
+ *
+ * StreamProcessors is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StreamProcessors is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StreamProcessors.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file utests_ts_remap.cpp
+ * @brief PID re-mapping and filtering module/processor unit-testing
+ * @author Rafael Antoniello
+ */
+
+#include <UnitTest++/UnitTest++.h>
+
+extern "C" {
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libmediaprocsutils/log.h>
+#include <libmediaprocsutils/stat_codes.h>
+#include <libmediaprocsutils/check_utils.h>
+#include <libmediaprocsutils/llist.h>
+#include <libstreamprocsmpeg2ts/ts.h>
+#include <libstreamprocsmpeg2ts/psi.h>
+#include <libstreamprocsmpeg2ts/psi_dec.h>
+#include <libstreamprocsmpeg2ts/psi_crc.h>
+#include <libstreamprocsmpeg2ts/ts_remap.h>
+}
+
+#define PMT_PID 0x50
+#define ES1_PID 0x100 // Also PCR PID
+#define ES2_PID 0x101
+
+/* PMS: program number 1, PCR PID 0x100; ES 0x100 (MPEG2 video) and ES 0x101
+ * (MPEG2 audio). CRC is computed in 'ts_remap_pms_pkt()'.
+ */
+static const uint8_t pms_section[]= {
+	0x02, 0xB0, 0x17, 0x00, 0x01, 0xC1, 0x00, 0x00,
+	0xE1, 0x00, 0xF0, 0x00,
+	0x02, 0xE1, 0x00, 0xF0, 0x00,
+	0x04, 0xE1, 0x01, 0xF0, 0x00,
+	0x00, 0x00, 0x00, 0x00
+};
+
+/**
+ * Compose a (payload only) TS packet.
+ */
+static void ts_remap_pkt(uint8_t *pkt, uint16_t pid, int pusi, uint8_t cc)
+{
+	memset(pkt, 0xFF, TS_PKT_SIZE);
+	pkt[0]= 0x47;
+	pkt[1]= (pusi? 0x40: 0x00)| ((pid>> 8)& 0x1F);
+	pkt[2]= pid& 0xFF;
+	pkt[3]= 0x10| (cc& 0x0F);
+}
+
+/**
+ * Compose the TS packet carrying the test PMS (section CRC is updated).
+ */
+static void ts_remap_pms_pkt(uint8_t *pkt, uint8_t cc, uint8_t **ref_section)
+{
+	uint32_t crc;
+	uint8_t *section= &pkt[TS_PKT_PREFIX_LEN+ 1];
+
+	ts_remap_pkt(pkt, PMT_PID, 1, cc);
+	pkt[TS_PKT_PREFIX_LEN]= 0; // 'pointer_field'
+	memcpy(section, pms_section, sizeof(pms_section));
+	crc= psi_crc32(section, sizeof(pms_section)- 4);
+	section[sizeof(pms_section)- 4]= (uint8_t)(crc>> 24);
+	section[sizeof(pms_section)- 3]= (uint8_t)(crc>> 16);
+	section[sizeof(pms_section)- 2]= (uint8_t)(crc>> 8);
+	section[sizeof(pms_section)- 1]= (uint8_t)crc;
+	if(ref_section!= NULL)
+		*ref_section= section;
+}
+
+/**
+ * Decode the section carried in the given (single) TS packet.
+ */
+static psi_section_ctx_t* ts_remap_pkt_section(const uint8_t *pkt)
+{
+	uint8_t buf[TS_PKT_SIZE];
+	psi_section_ctx_t *psi_section_ctx= NULL;
+	const uint8_t *section= &pkt[TS_PKT_PREFIX_LEN+ 1+ pkt[TS_PKT_PREFIX_LEN]];
+	size_t size= 3+ (((section[1]& 0x0F)<< 8)| section[2]);
+
+	memcpy(buf, section, size);
+	if(psi_dec_section(buf, size, TS_BUF_GET_PID(pkt), NULL,
+			&psi_section_ctx)!= STAT_SUCCESS)
+		return NULL;
+	return psi_section_ctx;
+}
+
+TEST(TS_REMAP_PIDS)
+{
+	int i;
+	size_t oput_size= 0;
+	const uint8_t *oput= NULL;
+	uint8_t pkt[TS_PKT_SIZE];
+	const uint8_t cc_in[]= {5, 6, 7, 9, 9, 10};
+	const uint8_t cc_out[]= {5, 6, 7, 9, 9, 10};
+	ts_remap_ctx_t *ts_remap_ctx= ts_remap_open(NULL);
+	CHECK(ts_remap_ctx!= NULL);
+	if(ts_remap_ctx== NULL)
+		return;
+
+	/* All PIDs are initially dropped */
+	CHECK(ts_remap_get_pid(ts_remap_ctx, ES1_PID)== TS_REMAP_PID_DROP);
+	ts_remap_pkt(pkt, ES1_PID, 0, 0);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput_size== 0);
+
+	CHECK(ts_remap_set_pid(ts_remap_ctx, ES1_PID, 0x200)== STAT_SUCCESS);
+	CHECK(ts_remap_get_pid(ts_remap_ctx, ES1_PID)== 0x200);
+
+	/* PID is re-written in place; input increments (discontinuities and
+	 * duplicated packets) are kept.
+	 */
+	for(i= 0; i< (int)sizeof(cc_in); i++) {
+		ts_remap_pkt(pkt, ES1_PID, i== 0, cc_in[i]);
+		CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+				STAT_SUCCESS);
+		CHECK(oput== pkt && oput_size== TS_PKT_SIZE);
+		CHECK(TS_BUF_GET_PID(pkt)== 0x200);
+		CHECK((TS_BUF_GET_START_INDICATOR(pkt)!= 0)== (i== 0));
+		CHECK(TS_BUF_GET_CC(pkt)== cc_out[i]);
+	}
+
+	/* Unmapped PID is dropped */
+	ts_remap_pkt(pkt, ES2_PID, 0, 0);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput_size== 0);
+
+	/* Another input PID substituting the first one in the same output PID:
+	 * output continuity counter follows the output PID sequence.
+	 */
+	CHECK(ts_remap_set_pid(ts_remap_ctx, ES1_PID, TS_REMAP_PID_DROP)==
+			STAT_SUCCESS);
+	CHECK(ts_remap_set_pid(ts_remap_ctx, ES2_PID, 0x200)== STAT_SUCCESS);
+	for(i= 0; i< 3; i++) {
+		ts_remap_pkt(pkt, ES2_PID, 0, (uint8_t)(12+ i));
+		CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+				STAT_SUCCESS);
+		CHECK(oput_size== TS_PKT_SIZE && TS_BUF_GET_PID(pkt)== 0x200);
+		CHECK(TS_BUF_GET_CC(pkt)== ((11+ i)& 0x0F));
+	}
+
+	ts_remap_close(&ts_remap_ctx);
+	CHECK(ts_remap_ctx== NULL);
+}
+
+TEST(TS_REMAP_PSI)
+{
+	size_t oput_size= 0;
+	const uint8_t *oput= NULL;
+	uint8_t pkt[TS_PKT_SIZE], pat_pkt[TS_PKT_SIZE];
+	uint8_t *section= NULL;
+	psi_section_ctx_t *psi_section_ctx_pms= NULL, *psi_section_ctx= NULL;
+	psi_pas_prog_ctx_t *psi_pas_prog_ctx;
+	psi_pms_ctx_t *psi_pms_ctx;
+	psi_pms_es_ctx_t *psi_pms_es_ctx;
+	ts_remap_ctx_t *ts_remap_ctx= ts_remap_open(NULL);
+	CHECK(ts_remap_ctx!= NULL);
+	if(ts_remap_ctx== NULL)
+		return;
+
+	/* Decode input PMS */
+	ts_remap_pms_pkt(pkt, 0, &section);
+	CHECK(psi_dec_section(section, sizeof(pms_section), PMT_PID, NULL,
+			&psi_section_ctx_pms)== STAT_SUCCESS);
+	CHECK(psi_section_ctx_pms!= NULL);
+	if(psi_section_ctx_pms== NULL)
+		goto end;
+	psi_section_ctx_pms->version_number= 9; // Not kept on output
+
+	/* PMT PID should be mapped to re-write PSI */
+	CHECK(ts_remap_set_pms(ts_remap_ctx, PMT_PID, psi_section_ctx_pms, 7)==
+			STAT_EINVAL);
+
+	/* Re-map PMT PID and ES1 (also PCR); ES2 is dropped */
+	CHECK(ts_remap_set_pid(ts_remap_ctx, PMT_PID, 0x60)== STAT_SUCCESS);
+	CHECK(ts_remap_set_pid(ts_remap_ctx, ES1_PID, 0x200)== STAT_SUCCESS);
+	CHECK(ts_remap_set_pms(ts_remap_ctx, PMT_PID, psi_section_ctx_pms, 7)==
+			STAT_SUCCESS);
+
+	/* Input PAT is substituted by the single program PAT */
+	ts_remap_pkt(pkt, 0, 1, 3);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput!= NULL && oput_size== TS_PKT_SIZE);
+	if(oput== NULL || oput_size!= TS_PKT_SIZE)
+		goto end;
+	memcpy(pat_pkt, oput, TS_PKT_SIZE);
+	CHECK(TS_BUF_GET_PID(pat_pkt)== 0);
+	psi_section_ctx= ts_remap_pkt_section(pat_pkt); // CRC is checked
+	CHECK(psi_section_ctx!= NULL);
+	if(psi_section_ctx!= NULL) {
+		psi_pas_ctx_t *psi_pas_ctx= (psi_pas_ctx_t*)psi_section_ctx->data;
+		CHECK(psi_section_ctx->table_id_extension== 7);
+		CHECK(llist_len(psi_pas_ctx->psi_pas_prog_ctx_llist)== 1);
+		psi_pas_prog_ctx= (psi_pas_prog_ctx_t*)llist_get_nth(
+				psi_pas_ctx->psi_pas_prog_ctx_llist, 0);
+		CHECK(psi_pas_prog_ctx->program_number== 1);
+		CHECK(psi_pas_prog_ctx->reference_pid== 0x60);
+		psi_section_ctx_release(&psi_section_ctx);
+	}
+
+	/* Re-written PAT is output from the cache (only CC changes) */
+	ts_remap_pkt(pkt, 0, 1, 4);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput_size== TS_PKT_SIZE);
+	CHECK(TS_BUF_GET_CC(oput)== ((TS_BUF_GET_CC(pat_pkt)+ 1)& 0x0F));
+	CHECK(memcmp(&oput[TS_PKT_PREFIX_LEN], &pat_pkt[TS_PKT_PREFIX_LEN],
+			TS_PKT_SIZE- TS_PKT_PREFIX_LEN)== 0);
+
+	/* Input PMT is substituted: PIDs translated, ES2 removed */
+	ts_remap_pms_pkt(pkt, 1, NULL);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput!= NULL && oput_size== TS_PKT_SIZE);
+	if(oput== NULL || oput_size!= TS_PKT_SIZE)
+		goto end;
+	CHECK(TS_BUF_GET_PID(oput)== 0x60);
+	psi_section_ctx= ts_remap_pkt_section(oput);
+	CHECK(psi_section_ctx!= NULL);
+	if(psi_section_ctx!= NULL) {
+		psi_pms_ctx= (psi_pms_ctx_t*)psi_section_ctx->data;
+		CHECK(psi_section_ctx->table_id_extension== 1);
+		CHECK(psi_pms_ctx->pcr_pid== 0x200);
+		CHECK(llist_len(psi_pms_ctx->psi_pms_es_ctx_llist)== 1);
+		psi_pms_es_ctx= (psi_pms_es_ctx_t*)llist_get_nth(
+				psi_pms_ctx->psi_pms_es_ctx_llist, 0);
+		CHECK(psi_pms_es_ctx->elementary_PID== 0x200);
+		CHECK(psi_pms_es_ctx->stream_type== 0x02);
+		CHECK(psi_section_ctx->version_number== 0);
+		psi_section_ctx_release(&psi_section_ctx);
+	}
+
+	/* Output PMT version is kept if contents do not change... */
+	CHECK(ts_remap_set_pms(ts_remap_ctx, PMT_PID, psi_section_ctx_pms, 7)==
+			STAT_SUCCESS);
+	ts_remap_pms_pkt(pkt, 2, NULL);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput!= NULL && oput_size== TS_PKT_SIZE);
+	if(oput== NULL || oput_size!= TS_PKT_SIZE)
+		goto end;
+	psi_section_ctx= ts_remap_pkt_section(oput);
+	CHECK(psi_section_ctx!= NULL);
+	if(psi_section_ctx!= NULL) {
+		CHECK(psi_section_ctx->version_number== 0);
+		psi_section_ctx_release(&psi_section_ctx);
+	}
+
+	/* ... and incremented if the PID map changes the contents (ES2 is
+	 * added); PAT version is kept.
+	 */
+	CHECK(ts_remap_set_pid(ts_remap_ctx, ES2_PID, 0x201)== STAT_SUCCESS);
+	CHECK(ts_remap_set_pms(ts_remap_ctx, PMT_PID, psi_section_ctx_pms, 7)==
+			STAT_SUCCESS);
+	ts_remap_pms_pkt(pkt, 3, NULL);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput!= NULL && oput_size== TS_PKT_SIZE);
+	if(oput== NULL || oput_size!= TS_PKT_SIZE)
+		goto end;
+	psi_section_ctx= ts_remap_pkt_section(oput);
+	CHECK(psi_section_ctx!= NULL);
+	if(psi_section_ctx!= NULL) {
+		psi_pms_ctx= (psi_pms_ctx_t*)psi_section_ctx->data;
+		CHECK(psi_section_ctx->version_number== 1);
+		CHECK(llist_len(psi_pms_ctx->psi_pms_es_ctx_llist)== 2);
+		psi_section_ctx_release(&psi_section_ctx);
+	}
+	ts_remap_pkt(pkt, 0, 1, 5);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput_size== TS_PKT_SIZE);
+	CHECK(memcmp(&oput[TS_PKT_PREFIX_LEN], &pat_pkt[TS_PKT_PREFIX_LEN],
+			TS_PKT_SIZE- TS_PKT_PREFIX_LEN)== 0);
+
+	/* Input PSI continuation packets are dropped */
+	ts_remap_pkt(pkt, PMT_PID, 0, 4);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput_size== 0);
+
+	/* Unset PSI re-writing: input PMT is re-mapped as any other PID */
+	CHECK(ts_remap_set_pms(ts_remap_ctx, PMT_PID, NULL, 0)== STAT_SUCCESS);
+	ts_remap_pms_pkt(pkt, 5, NULL);
+	CHECK(ts_remap_packet(ts_remap_ctx, pkt, &oput, &oput_size)==
+			STAT_SUCCESS);
+	CHECK(oput== pkt && oput_size== TS_PKT_SIZE);
+	CHECK(TS_BUF_GET_PID(pkt)== 0x60);
+
+end:
+	psi_section_ctx_release(&psi_section_ctx_pms);
+	ts_remap_close(&ts_remap_ctx);
+}